@@ -35,6 +35,7 @@
 #include "Core/Program/Program.h"
 #include "Core/Program/ShaderVar.h"
 #include "Utils/Logger.h"
+#include "Utils/Metrics.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Scripting/ndarray.h"
 
@@ -258,6 +259,8 @@ ref<UnorderedAccessView> Buffer::getUAV()
 void Buffer::setBlob(const void* pData, size_t offset, size_t size)
 {
     FALCOR_CHECK(offset + size <= mSize, "'offset' ({}) and 'size' ({}) don't fit the buffer size {}.", offset, size, mSize);
+    FALCOR_METRIC_COUNT("buffer.uploads", 1);
+    FALCOR_METRIC_COUNT("buffer.upload_bytes", size);
 
     if (mMemoryType == MemoryType::Upload)
     {
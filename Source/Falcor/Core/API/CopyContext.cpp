@@ -137,9 +137,13 @@ void CopyContext::waitForFalcor(cudaStream_t stream)
 }
 #endif
 
-CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(
+    const Texture* pTexture,
+    uint32_t subresourceIndex,
+    ref<Buffer> pStagingBuffer
+)
 {
-    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
+    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex, std::move(pStagingBuffer));
 }
 
 std::vector<uint8_t> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
@@ -317,30 +321,64 @@ void CopyContext::updateTextureSubresources(
     }
 }
 
+namespace
+{
+struct ReadbackFootprint
+{
+    uint32_t actualRowSize;
+    uint32_t rowSize;
+    uint64_t rowCount;
+    uint32_t depth;
+
+    uint64_t getSize() const { return depth * rowCount * rowSize; }
+};
+
+ReadbackFootprint getReadbackFootprint(Device* pDevice, const Texture* pTexture, uint32_t subresourceIndex)
+{
+    gfx::FormatInfo formatInfo;
+    gfx::gfxGetFormatInfo(pTexture->getGfxTextureResource()->getDesc()->format, &formatInfo);
+
+    ReadbackFootprint footprint;
+    auto mipLevel = pTexture->getSubresourceMipLevel(subresourceIndex);
+    footprint.actualRowSize =
+        uint32_t((pTexture->getWidth(mipLevel) + formatInfo.blockWidth - 1) / formatInfo.blockWidth * formatInfo.blockSizeInBytes);
+    size_t rowAlignment = 1;
+    pDevice->getGfxDevice()->getTextureRowAlignment(&rowAlignment);
+    footprint.rowSize = align_to(static_cast<uint32_t>(rowAlignment), footprint.actualRowSize);
+    footprint.rowCount = (pTexture->getHeight(mipLevel) + formatInfo.blockHeight - 1) / formatInfo.blockHeight;
+    footprint.depth = pTexture->getDepth(mipLevel);
+    return footprint;
+}
+} // namespace
+
+uint64_t CopyContext::ReadTextureTask::getStagingBufferSize(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+{
+    return getReadbackFootprint(pCtx->mpDevice, pTexture, subresourceIndex).getSize();
+}
+
 CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     CopyContext* pCtx,
     const Texture* pTexture,
-    uint32_t subresourceIndex
+    uint32_t subresourceIndex,
+    ref<Buffer> pStagingBuffer
 )
 {
     SharedPtr pThis = SharedPtr(new ReadTextureTask);
     pThis->mpContext = pCtx;
     // Get footprint
     gfx::ITextureResource* srcTexture = pTexture->getGfxTextureResource();
-    gfx::FormatInfo formatInfo;
-    gfx::gfxGetFormatInfo(srcTexture->getDesc()->format, &formatInfo);
-
     auto mipLevel = pTexture->getSubresourceMipLevel(subresourceIndex);
-    pThis->mActualRowSize =
-        uint32_t((pTexture->getWidth(mipLevel) + formatInfo.blockWidth - 1) / formatInfo.blockWidth * formatInfo.blockSizeInBytes);
-    size_t rowAlignment = 1;
-    pCtx->mpDevice->getGfxDevice()->getTextureRowAlignment(&rowAlignment);
-    pThis->mRowSize = align_to(static_cast<uint32_t>(rowAlignment), pThis->mActualRowSize);
-    uint64_t rowCount = (pTexture->getHeight(mipLevel) + formatInfo.blockHeight - 1) / formatInfo.blockHeight;
-    uint64_t size = pTexture->getDepth(mipLevel) * rowCount * pThis->mRowSize;
-
-    // Create buffer
-    pThis->mpBuffer = pCtx->getDevice()->createBuffer(size, ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
+    const ReadbackFootprint footprint = getReadbackFootprint(pCtx->mpDevice, pTexture, subresourceIndex);
+    pThis->mActualRowSize = footprint.actualRowSize;
+    pThis->mRowSize = footprint.rowSize;
+    uint64_t rowCount = footprint.rowCount;
+    uint64_t size = footprint.getSize();
+
+    // Create buffer, unless the given one is large enough
+    if (pStagingBuffer && pStagingBuffer->getSize() >= size && pStagingBuffer->getMemoryType() == MemoryType::ReadBack)
+        pThis->mpBuffer = std::move(pStagingBuffer);
+    else
+        pThis->mpBuffer = pCtx->getDevice()->createBuffer(size, ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
 
     // Copy from texture to buffer
     pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
@@ -376,6 +414,11 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     return pThis;
 }
 
+bool CopyContext::ReadTextureTask::isReady() const
+{
+    return mpFence->getCurrentValue() >= mpFence->getSignaledValue();
+}
+
 void CopyContext::ReadTextureTask::getData(void* pData, size_t size) const
 {
     FALCOR_ASSERT(size == size_t(mRowCount) * mActualRowSize * mDepth);
@@ -53,7 +53,28 @@ public:
     {
     public:
         using SharedPtr = std::shared_ptr<ReadTextureTask>;
-        static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+
+        /**
+         * Create a task reading back a texture subresource.
+         * @param[in] pCtx Copy context.
+         * @param[in] pTexture Texture to read.
+         * @param[in] subresourceIndex Subresource to read.
+         * @param[in] pStagingBuffer Optional readback buffer to reuse. A new buffer is allocated if it is null or too small.
+         */
+        static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, ref<Buffer> pStagingBuffer = nullptr);
+
+        /// Get the size of the readback buffer needed for a texture subresource.
+        static uint64_t getStagingBufferSize(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+
+        /// Check if the GPU has finished the copy, getData() does not block if this returns true.
+        bool isReady() const;
+
+        /// Get the size of the data returned by getData().
+        size_t getDataSize() const { return size_t(mRowCount) * mActualRowSize * mDepth; }
+
+        /// Get the readback buffer. It can be reused for another task once the data has been read.
+        const ref<Buffer>& getStagingBuffer() const { return mpBuffer; }
+
         void getData(void* pData, size_t size) const;
         std::vector<uint8_t> getData() const;
 
@@ -221,8 +242,13 @@ public:
 
     /**
      * Read texture data Asynchronously
+     * @param[in] pStagingBuffer Optional readback buffer to reuse, see ReadTextureTask::create().
      */
-    ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+    ReadTextureTask::SharedPtr asyncReadTextureSubresource(
+        const Texture* pTexture,
+        uint32_t subresourceIndex,
+        ref<Buffer> pStagingBuffer = nullptr
+    );
 
     /**
      * Get the low-level context data
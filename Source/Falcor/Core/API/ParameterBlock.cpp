@@ -32,6 +32,7 @@
 #include "Core/Error.h"
 #include "Core/Program/ProgramVersion.h"
 #include "Utils/Logger.h"
+#include "Utils/Metrics.h"
 
 namespace Falcor
 {
@@ -441,6 +442,7 @@ void ParameterBlock::setBuffer(std::string_view name, const ref<Buffer>& pBuffer
 
 void ParameterBlock::setBuffer(const BindLocation& bindLoc, const ref<Buffer>& pBuffer)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLoc);
     if (isUavType(bindLoc.getType()))
     {
@@ -507,6 +509,7 @@ void ParameterBlock::setTexture(std::string_view name, const ref<Texture>& pText
 
 void ParameterBlock::setTexture(const BindLocation& bindLocation, const ref<Texture>& pTexture)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLocation);
     if (isUavType(bindLocation.getType()))
     {
@@ -568,6 +571,7 @@ ref<Texture> ParameterBlock::getTexture(const BindLocation& bindLocation) const
 
 void ParameterBlock::setSrv(const BindLocation& bindLocation, const ref<ShaderResourceView>& pSrv)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     if (isSrvType(bindLocation.getType()))
     {
         gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLocation);
@@ -600,6 +604,7 @@ ref<ShaderResourceView> ParameterBlock::getSrv(const BindLocation& bindLocation)
 
 void ParameterBlock::setUav(const BindLocation& bindLocation, const ref<UnorderedAccessView>& pUav)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     if (isUavType(bindLocation.getType()))
     {
         gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLocation);
@@ -632,6 +637,7 @@ ref<UnorderedAccessView> ParameterBlock::getUav(const BindLocation& bindLocation
 
 void ParameterBlock::setAccelerationStructure(const BindLocation& bindLocation, const ref<RtAccelerationStructure>& pAccl)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     if (isAccelerationStructureType(bindLocation.getType()))
     {
         gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLocation);
@@ -671,6 +677,7 @@ void ParameterBlock::setSampler(std::string_view name, const ref<Sampler>& pSamp
 
 void ParameterBlock::setSampler(const BindLocation& bindLocation, const ref<Sampler>& pSampler)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     if (isSamplerType(bindLocation.getType()))
     {
         gfx::ShaderOffset gfxOffset = getGFXShaderOffset(bindLocation);
@@ -716,6 +723,7 @@ void ParameterBlock::setParameterBlock(std::string_view name, const ref<Paramete
 
 void ParameterBlock::setParameterBlock(const BindLocation& bindLocation, const ref<ParameterBlock>& pBlock)
 {
+    FALCOR_METRIC_COUNT("parameter_block.bindings", 1);
     if (isParameterBlockType(bindLocation.getType()))
     {
         auto gfxOffset = getGFXShaderOffset(bindLocation);
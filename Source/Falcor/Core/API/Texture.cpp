@@ -38,6 +38,7 @@
 #include "Utils/Threading.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/ImageIO.h"
+#include "Utils/Image/MipGenerator.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Scripting/ndarray.h"
 #include "Core/Pass/FullScreenPass.h"
@@ -367,7 +368,8 @@ ref<Texture> Texture::createFromFile(
     bool generateMipLevels,
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
-    Bitmap::ImportFlags importFlags
+    Bitmap::ImportFlags importFlags,
+    float alphaCutoff
 )
 {
     if (!std::filesystem::exists(path))
@@ -399,15 +401,26 @@ ref<Texture> Texture::createFromFile(
                 texFormat = linearToSrgbFormat(texFormat);
             }
 
-            pTex = pDevice->createTexture2D(
-                pBitmap->getWidth(),
-                pBitmap->getHeight(),
-                texFormat,
-                1,
-                generateMipLevels ? Texture::kMaxPossible : 1,
-                pBitmap->getData(),
-                bindFlags
-            );
+            if (generateMipLevels && MipGenerator::isSupported(texFormat))
+            {
+                // Generate the mip chain on the CPU, so that loader threads can prepare it and the texture is uploaded in one go.
+                MipGenerator::Options mipOptions;
+                mipOptions.preserveAlphaCoverage = is_set(importFlags, Bitmap::ImportFlags::PreserveAlphaCoverage);
+                mipOptions.alphaCutoff = alphaCutoff;
+                pTex = MipGenerator::createTexture(pDevice, *pBitmap, texFormat, bindFlags, mipOptions);
+            }
+            else
+            {
+                pTex = pDevice->createTexture2D(
+                    pBitmap->getWidth(),
+                    pBitmap->getHeight(),
+                    texFormat,
+                    1,
+                    generateMipLevels ? Texture::kMaxPossible : 1,
+                    pBitmap->getData(),
+                    bindFlags
+                );
+            }
         }
     }
 
@@ -415,6 +428,7 @@ ref<Texture> Texture::createFromFile(
     {
         pTex->setSourcePath(path);
         pTex->mImportFlags = importFlags;
+        pTex->mAlphaCutoff = alphaCutoff;
 
         // Log debug info.
         std::string str = fmt::format(
@@ -635,7 +649,7 @@ void Texture::captureToFile(
     auto func = [=]() { Bitmap::saveImage(path, width, height, format, exportFlags, resourceFormat, true, (void*)textureData.data()); };
 
     if (async)
-        Threading::dispatchTask(func);
+        Threading::dispatchTask(func, Threading::Priority::Low);
     else
         func();
 }
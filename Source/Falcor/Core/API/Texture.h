@@ -184,6 +184,7 @@ public:
      * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
      * @param[in] bindFlags The bind flags to create the texture with.
      * @param[in] importFlags Optional flags for the file import.
+     * @param[in] alphaCutoff Alpha test threshold used with Bitmap::ImportFlags::PreserveAlphaCoverage.
      * @return A new texture, or nullptr if the texture failed to load.
      */
     static ref<Texture> createFromFile(
@@ -192,7 +193,8 @@ public:
         bool generateMipLevels,
         bool loadAsSrgb,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
-        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
+        float alphaCutoff = 0.5f
     );
 
     gfx::ITextureResource* getGfxTextureResource() const { return mGfxTextureResource; }
@@ -310,11 +312,26 @@ public:
      */
     const std::filesystem::path& getSourcePath() const { return mSourcePath; }
 
+    /**
+     * In case the texture was loaded from a file, set the import flags used.
+     */
+    void setImportFlags(Bitmap::ImportFlags importFlags) { mImportFlags = importFlags; }
+
     /**
      * In case the texture was loaded from a file, get the import flags used.
      */
     Bitmap::ImportFlags getImportFlags() const { return mImportFlags; }
 
+    /**
+     * In case the texture was loaded from a file, set the alpha test threshold used for preserving the alpha coverage of the mips.
+     */
+    void setAlphaCutoff(float alphaCutoff) { mAlphaCutoff = alphaCutoff; }
+
+    /**
+     * In case the texture was loaded from a file, get the alpha test threshold used for preserving the alpha coverage of the mips.
+     */
+    float getAlphaCutoff() const { return mAlphaCutoff; }
+
     /**
      * Returns the total number of texels across all mip levels and array slices.
      */
@@ -339,6 +356,7 @@ protected:
     bool mReleaseRtvsAfterGenMips = true;
     std::filesystem::path mSourcePath;
     Bitmap::ImportFlags mImportFlags = Bitmap::ImportFlags::None; ///< Flags used for import if loaded from file.
+    float mAlphaCutoff = 0.5f;                                    ///< Alpha test threshold used for import if loaded from file.
 
     ResourceFormat mFormat = ResourceFormat::Unknown;
     uint32_t mWidth = 0;
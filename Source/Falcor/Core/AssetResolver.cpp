@@ -29,9 +29,59 @@
 #include "Core/Platform/OS.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
+#include <algorithm>
+#include <cctype>
+#include <map>
+
 namespace Falcor
 {
 
+namespace
+{
+/// Get the key of a path relative to a search path in the directory index.
+std::string getIndexKey(const std::filesystem::path& path)
+{
+    std::string key = path.lexically_normal().generic_string();
+    while (!key.empty() && key.back() == '/')
+        key.pop_back();
+#if FALCOR_WINDOWS
+    // The Windows file system is case-insensitive.
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+    return key;
+}
+
+/// Get the key of a path lookup in the resolution cache. Keys are "<category>:<absolute path>".
+std::string getCacheKey(const std::filesystem::path& absolute, AssetCategory category)
+{
+    return std::to_string(uint32_t(category)) + ':' + absolute.lexically_normal().string();
+}
+
+std::shared_ptr<const std::unordered_set<std::string>> createDirectoryIndex(const std::filesystem::path& root, size_t maxFileCount)
+{
+    auto pIndex = std::make_shared<std::unordered_set<std::string>>();
+    const auto options = std::filesystem::directory_options::follow_directory_symlink |
+                         std::filesystem::directory_options::skip_permission_denied;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, options, ec); !ec && it != std::filesystem::end(it);
+         it.increment(ec))
+    {
+        if (pIndex->size() >= maxFileCount)
+        {
+            logWarning("Search path '{}' contains more than {} files, not indexing it.", root, maxFileCount);
+            return nullptr;
+        }
+        pIndex->insert(getIndexKey(it->path().lexically_relative(root)));
+    }
+    if (ec)
+    {
+        logWarning("Failed to index search path '{}': {}", root, ec.message());
+        return nullptr;
+    }
+    return pIndex;
+}
+} // namespace
+
 AssetResolver::AssetResolver()
 {
     mSearchContexts.resize(size_t(AssetCategory::Count));
@@ -41,21 +91,78 @@ std::filesystem::path AssetResolver::resolvePath(const std::filesystem::path& pa
 {
     FALCOR_CHECK(category < AssetCategory::Count, "Invalid asset category.");
 
-    // If this is an existing absolute path, or a relative path to the working directory, return it.
     std::filesystem::path absolute = std::filesystem::absolute(path);
+
+    std::filesystem::path resolved;
+    uint32_t missingCount = 0;
+    std::string cacheKey;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(mCache.mutex);
+        mCache.stats.lookups++;
+        if (mCache.enabled)
+        {
+            cacheKey = getCacheKey(absolute, category);
+            if (auto it = mCache.entries.find(cacheKey); it != mCache.entries.end())
+            {
+                mCache.stats.hits++;
+                mCache.stats.negativeHits += it->second.resolved.empty() ? 1 : 0;
+                mCache.stats.probesAvoided += it->second.probes;
+                resolved = it->second.resolved;
+                missingCount = it->second.missingCount;
+                cached = true;
+            }
+        }
+    }
+
+    if (!cached)
+    {
+        // Resolve without holding the lock. Concurrent lookups of the same path may both probe the file system.
+        ProbeCount count;
+        resolved = resolvePathUncached(path, absolute, category, count);
+        missingCount = resolved.empty() ? count.candidates : count.candidates - 1;
+
+        {
+            std::lock_guard<std::mutex> lock(mCache.mutex);
+            mCache.stats.probes += count.probes;
+            mCache.stats.probesAvoided += count.avoided;
+            if (mCache.enabled && !cacheKey.empty() && (!resolved.empty() || mCache.cacheNegativeResults))
+                mCache.entries[cacheKey] = {resolved, count.probes + count.avoided, missingCount};
+        }
+
+        if (resolved.empty())
+            logWarning("Failed to resolve path '{}' for asset type '{}'.", path, category);
+    }
+
+    if (mResolveCallback)
+        mResolveCallback(resolved, getCandidatePaths(path, absolute, category, missingCount));
+
+    return resolved;
+}
+
+std::filesystem::path AssetResolver::resolvePathUncached(
+    const std::filesystem::path& path,
+    const std::filesystem::path& absolute,
+    AssetCategory category,
+    ProbeCount& count
+) const
+{
+    // If this is an existing absolute path, or a relative path to the working directory, return it.
+    count.probes++;
+    count.candidates++;
     if (std::filesystem::exists(absolute))
+    {
+        count.probes++;
         return std::filesystem::canonical(absolute);
+    }
 
     // Otherwise, try to resolve using search paths.
     // First try resolving for the specified asset category.
-    std::filesystem::path resolved = mSearchContexts[size_t(category)].resolvePath(path);
+    std::filesystem::path resolved = mSearchContexts[size_t(category)].resolvePath(path, count);
 
     // If not resolved, try resolving for the Any asset category.
     if (category != AssetCategory::Any && resolved.empty())
-        resolved = mSearchContexts[size_t(AssetCategory::Any)].resolvePath(path);
-
-    if (resolved.empty())
-        logWarning("Failed to resolve path '{}' for asset type '{}'.", path, category);
+        resolved = mSearchContexts[size_t(AssetCategory::Any)].resolvePath(path, count);
 
     return resolved;
 }
@@ -74,12 +181,11 @@ std::vector<std::filesystem::path> AssetResolver::resolvePathPattern(
     // If this is an existing absolute path, or a relative path to the working directory, search it.
     std::filesystem::path absolute = std::filesystem::absolute(path);
     std::vector<std::filesystem::path> resolved = globFilesInDirectory(absolute, regex, firstMatchOnly);
-    if (!resolved.empty())
-        return resolved;
 
     // Otherwise, try to resolve using search paths.
     // First try resolving for the specified asset category.
-    resolved = mSearchContexts[size_t(category)].resolvePathPattern(path, regex, firstMatchOnly);
+    if (resolved.empty())
+        resolved = mSearchContexts[size_t(category)].resolvePathPattern(path, regex, firstMatchOnly);
 
     // If not resolved, try resolving for the Any asset category.
     if (category != AssetCategory::Any && resolved.empty())
@@ -88,14 +194,118 @@ std::vector<std::filesystem::path> AssetResolver::resolvePathPattern(
     if (resolved.empty())
         logWarning("Failed to resolve path pattern '{}/{}' for asset type '{}'.", path, pattern, category);
 
+    if (mResolveCallback)
+    {
+        for (const auto& resolvedPath : resolved)
+            mResolveCallback(resolvedPath, {});
+    }
+
     return resolved;
 }
 
+std::vector<std::filesystem::path> AssetResolver::getCandidatePaths(
+    const std::filesystem::path& path,
+    const std::filesystem::path& absolute,
+    AssetCategory category,
+    uint32_t count
+) const
+{
+    std::vector<std::filesystem::path> candidates;
+    candidates.reserve(count);
+    if (candidates.size() < count)
+        candidates.push_back(absolute.lexically_normal());
+
+    auto addSearchPaths = [&](const SearchContext& context)
+    {
+        for (size_t i = 0; i < context.searchPaths.size() && candidates.size() < count; i++)
+            candidates.push_back((context.searchPaths[i].path / path).lexically_normal());
+    };
+    addSearchPaths(mSearchContexts[size_t(category)]);
+    if (category != AssetCategory::Any)
+        addSearchPaths(mSearchContexts[size_t(AssetCategory::Any)]);
+
+    FALCOR_ASSERT(candidates.size() == count);
+    return candidates;
+}
+
 void AssetResolver::addSearchPath(const std::filesystem::path& path, SearchPathPriority priority, AssetCategory category)
 {
     FALCOR_CHECK(path.is_absolute(), "Search path must be absolute.");
     FALCOR_CHECK(category < AssetCategory::Count, "Invalid asset category.");
     mSearchContexts[size_t(category)].addSearchPath(path, priority);
+    invalidateCache();
+}
+
+void AssetResolver::setCacheEnabled(bool enabled, bool cacheNegativeResults)
+{
+    std::lock_guard<std::mutex> lock(mCache.mutex);
+    mCache.enabled = enabled;
+    mCache.cacheNegativeResults = cacheNegativeResults;
+    mCache.entries.clear();
+}
+
+bool AssetResolver::isCacheEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mCache.mutex);
+    return mCache.enabled;
+}
+
+void AssetResolver::invalidateCache()
+{
+    std::lock_guard<std::mutex> lock(mCache.mutex);
+    mCache.entries.clear();
+}
+
+void AssetResolver::invalidateCache(const std::filesystem::path& path)
+{
+    const std::filesystem::path absolute = std::filesystem::absolute(path).lexically_normal();
+    const std::string absoluteString = absolute.string();
+    std::error_code ec;
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(absolute, ec);
+
+    {
+        // Negative entries are always removed, as they may have been looked up relative to a search path.
+        std::lock_guard<std::mutex> lock(mCache.mutex);
+        for (auto it = mCache.entries.begin(); it != mCache.entries.end();)
+        {
+            std::string_view keyPath = std::string_view(it->first).substr(it->first.find(':') + 1);
+            bool match = it->second.resolved.empty() || keyPath == absoluteString || (!ec && it->second.resolved == canonical);
+            it = match ? mCache.entries.erase(it) : std::next(it);
+        }
+    }
+
+    for (auto& context : mSearchContexts)
+    {
+        for (auto& searchPath : context.searchPaths)
+        {
+            std::filesystem::path relative = absolute.lexically_relative(searchPath.path);
+            if (!relative.empty() && *relative.begin() != "..")
+                searchPath.pIndex = nullptr;
+        }
+    }
+}
+
+void AssetResolver::indexSearchPaths(size_t maxFileCount)
+{
+    // Search paths may be used by multiple categories, index each of them once.
+    std::map<std::filesystem::path, std::shared_ptr<const DirectoryIndex>> indices;
+    for (auto& context : mSearchContexts)
+    {
+        for (auto& searchPath : context.searchPaths)
+        {
+            auto it = indices.find(searchPath.path);
+            if (it == indices.end())
+                it = indices.emplace(searchPath.path, createDirectoryIndex(searchPath.path, maxFileCount)).first;
+            searchPath.pIndex = it->second;
+        }
+    }
+    invalidateCache();
+}
+
+AssetResolver::CacheStats AssetResolver::getCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(mCache.mutex);
+    return mCache.stats;
 }
 
 AssetResolver& AssetResolver::getDefaultResolver()
@@ -104,13 +314,36 @@ AssetResolver& AssetResolver::getDefaultResolver()
     return defaultResolver;
 }
 
-std::filesystem::path AssetResolver::SearchContext::resolvePath(const std::filesystem::path& path) const
+std::filesystem::path AssetResolver::SearchContext::resolvePath(const std::filesystem::path& path, ProbeCount& count) const
 {
+    // Absolute paths and paths leaving the search path can't be looked up in the index.
+    const std::string indexKey = getIndexKey(path);
+    const bool isIndexable =
+        !path.is_absolute() && !indexKey.empty() && indexKey != "." && indexKey != ".." && indexKey.rfind("../", 0) != 0;
+
     for (const auto& searchPath : searchPaths)
     {
-        std::filesystem::path absolutePath = searchPath / path;
-        if (std::filesystem::exists(absolutePath))
-            return std::filesystem::canonical(absolutePath);
+        std::filesystem::path absolutePath = searchPath.path / path;
+        count.candidates++;
+        if (searchPath.pIndex && isIndexable)
+        {
+            count.avoided++;
+            if (searchPath.pIndex->count(indexKey) == 0)
+                continue;
+        }
+        else
+        {
+            count.probes++;
+            if (!std::filesystem::exists(absolutePath))
+                continue;
+        }
+
+        // Skip stale index entries of files that have been removed.
+        count.probes++;
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::canonical(absolutePath, ec);
+        if (!ec)
+            return canonical;
     }
 
     return {};
@@ -124,7 +357,7 @@ std::vector<std::filesystem::path> AssetResolver::SearchContext::resolvePathPatt
 {
     for (const auto& searchPath : searchPaths)
     {
-        std::filesystem::path absolutePath = searchPath / path;
+        std::filesystem::path absolutePath = searchPath.path / path;
         std::vector<std::filesystem::path> resolved = globFilesInDirectory(absolutePath, regex, firstMatchOnly);
         if (!resolved.empty())
             return resolved;
@@ -135,21 +368,38 @@ std::vector<std::filesystem::path> AssetResolver::SearchContext::resolvePathPatt
 void AssetResolver::SearchContext::addSearchPath(const std::filesystem::path& path, SearchPathPriority priority)
 {
     FALCOR_ASSERT(path.is_absolute());
-    auto it = std::find_if(searchPaths.begin(), searchPaths.end(), [&path](const std::filesystem::path& p) { return isSamePath(path, p); });
+    auto it = std::find_if(searchPaths.begin(), searchPaths.end(), [&path](const SearchPath& p) { return isSamePath(path, p.path); });
     if (it != searchPaths.end())
         searchPaths.erase(it);
     switch (priority)
     {
     case SearchPathPriority::First:
-        searchPaths.insert(searchPaths.begin(), path);
+        searchPaths.insert(searchPaths.begin(), SearchPath{path});
         return;
     case SearchPathPriority::Last:
-        searchPaths.push_back(path);
+        searchPaths.push_back(SearchPath{path});
         return;
     }
     FALCOR_THROW("Invalid search path priority.");
 }
 
+AssetResolver::Cache::Cache(const Cache& other)
+{
+    *this = other;
+}
+
+AssetResolver::Cache& AssetResolver::Cache::operator=(const Cache& other)
+{
+    if (this == &other)
+        return *this;
+    std::scoped_lock lock(mutex, other.mutex);
+    enabled = other.enabled;
+    cacheNegativeResults = other.cacheNegativeResults;
+    entries = other.entries;
+    stats = other.stats;
+    return *this;
+}
+
 FALCOR_SCRIPT_BINDING(AssetResolver)
 {
     using namespace pybind11::literals;
@@ -176,6 +426,26 @@ FALCOR_SCRIPT_BINDING(AssetResolver)
         "category"_a = AssetCategory::Any
     );
 
+    assetResolver.def("set_cache_enabled", &AssetResolver::setCacheEnabled, "enabled"_a, "cache_negative_results"_a = true);
+    assetResolver.def_property_readonly("cache_enabled", &AssetResolver::isCacheEnabled);
+    assetResolver.def("invalidate_cache", pybind11::overload_cast<>(&AssetResolver::invalidateCache));
+    assetResolver.def("invalidate_cache", pybind11::overload_cast<const std::filesystem::path&>(&AssetResolver::invalidateCache), "path"_a);
+    assetResolver.def("index_search_paths", &AssetResolver::indexSearchPaths, "max_file_count"_a = size_t(1) << 20);
+    assetResolver.def_property_readonly(
+        "cache_stats",
+        [](const AssetResolver& self)
+        {
+            AssetResolver::CacheStats stats = self.getCacheStats();
+            pybind11::dict d;
+            d["lookups"] = stats.lookups;
+            d["hits"] = stats.hits;
+            d["negative_hits"] = stats.negativeHits;
+            d["probes"] = stats.probes;
+            d["probes_avoided"] = stats.probesAvoided;
+            return d;
+        }
+    );
+
     assetResolver.def_property_readonly_static("default_resolver", [](pybind11::object) { return AssetResolver::getDefaultResolver(); });
 }
 
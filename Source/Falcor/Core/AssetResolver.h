@@ -30,8 +30,13 @@
 #include "Macros.h"
 #include "Enum.h"
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace Falcor
@@ -84,10 +89,33 @@ FALCOR_ENUM_REGISTER(SearchPathPriority);
  * search paths. When resolving a path, the resolver will first try to resolve the path
  * for the specified category, and if that fails, it will try to resolve it for the \c AssetCategory::Any category.
  * If no asset category is specified, the \c AssetCategory::Any category is used by default.
+ *
+ * Resolving a path can take many file system probes (one per search path), which is slow on network file systems
+ * when importing scenes that reference many assets. To reduce the number of probes, the resolver can cache
+ * resolved paths (including paths that could not be resolved) and index the files in the search paths.
  */
 class FALCOR_API AssetResolver
 {
 public:
+    /// Statistics of the path resolution cache and search path indices.
+    struct CacheStats
+    {
+        uint64_t lookups = 0;       ///< Number of resolvePath() calls.
+        uint64_t hits = 0;          ///< Number of lookups answered from the cache.
+        uint64_t negativeHits = 0;  ///< Number of cache hits for paths that could not be resolved.
+        uint64_t probes = 0;        ///< Number of file system probes.
+        uint64_t probesAvoided = 0; ///< Number of file system probes avoided by cache hits and search path indices.
+    };
+
+    /**
+     * Callback invoked for path lookups.
+     * @param resolvedPath The resolved path, or an empty path if the path could not be resolved.
+     * @param missingPaths Candidate paths that were tried before the resolved path, or all candidate paths if the path
+     * could not be resolved. None of these exist, creating one of them changes the result of the lookup.
+     */
+    using ResolveCallback =
+        std::function<void(const std::filesystem::path& resolvedPath, const std::vector<std::filesystem::path>& missingPaths)>;
+
     /// Default constructor.
     AssetResolver();
 
@@ -96,6 +124,7 @@ public:
      * If \c path is absolute or relative to the working directory and exists, it is returned in its canonical form.
      * If \c path is relative and resolves to some \c <searchpath>/<path> it is returned.
      * If the path cannot be resolved, an empty path is returned.
+     * If the cache is enabled, the result is cached and a warning for an unresolved path is only logged once.
      * @param path Path to resolve.
      * @param category Asset category.
      * @return The resolved path, or an empty path if the path could not be resolved.
@@ -127,6 +156,7 @@ public:
      * The path needs to be absolute and exist.
      * An optional priority can be specified, which determines whether the path is added to the beginning or end of the search path list.
      * If the search path already exists, it is moved to the specified priority.
+     * Adding a search path clears the resolution cache.
      * @param path Path to add.
      * @param priority Search path priority.
      * @param category Asset category.
@@ -137,16 +167,76 @@ public:
         AssetCategory category = AssetCategory::Any
     );
 
+    /**
+     * Enable or disable caching of resolved paths.
+     * When enabled, resolvePath() results are cached by absolute path and category, so repeated lookups don't probe the
+     * file system. Files that are created or removed after they have been resolved are not detected, use invalidateCache()
+     * in that case. Enabling or disabling the cache clears it. The cache is disabled by default.
+     * @param enabled Enable the cache.
+     * @param cacheNegativeResults Also cache paths that could not be resolved.
+     */
+    void setCacheEnabled(bool enabled, bool cacheNegativeResults = true);
+
+    bool isCacheEnabled() const;
+
+    /// Remove all entries from the resolution cache.
+    void invalidateCache();
+
+    /**
+     * Remove the cache entries requested with or resolved to a path, and drop the indices of the search paths containing it.
+     * Call this after a file has been created, moved or removed.
+     * @param path Path of the file.
+     */
+    void invalidateCache(const std::filesystem::path& path);
+
+    /**
+     * Index the files in the current search paths.
+     * Lookups in an indexed search path check the index instead of probing the file system.
+     * Search paths added later are not indexed. Files added to an indexed search path are only found after
+     * re-indexing or invalidating the path.
+     * @param maxFileCount Maximum number of files and directories per search path. Larger search paths are not indexed.
+     */
+    void indexSearchPaths(size_t maxFileCount = 1 << 20);
+
+    /// Get the cache statistics.
+    CacheStats getCacheStats() const;
+
+    /**
+     * Set a callback that is invoked for every resolvePath() lookup, including failed lookups and cached results, and for
+     * every path returned by resolvePathPattern(). This is used to track the files an asset depends on, and the files whose
+     * creation would change how it is resolved. Candidate paths of resolvePathPattern() are not reported.
+     * The callback may be invoked concurrently from multiple threads. Copies of the resolver invoke the same callback.
+     * @param callback Callback, or nullptr to remove it.
+     */
+    void setResolveCallback(ResolveCallback callback) { mResolveCallback = std::move(callback); }
+
     /// Return the global default asset resolver.
     static AssetResolver& getDefaultResolver();
 
 private:
+    /// Number of file system probes done and avoided by a lookup.
+    struct ProbeCount
+    {
+        uint32_t probes = 0;
+        uint32_t avoided = 0;
+        uint32_t candidates = 0; ///< Number of candidate paths tried, including the resolved one.
+    };
+
+    /// Relative paths of all files and directories in a search path.
+    using DirectoryIndex = std::unordered_set<std::string>;
+
+    struct SearchPath
+    {
+        std::filesystem::path path;
+        std::shared_ptr<const DirectoryIndex> pIndex; ///< Index of the search path, or nullptr if not indexed.
+    };
+
     struct SearchContext
     {
         /// List of search paths. Resolving is done by searching these paths in order.
-        std::vector<std::filesystem::path> searchPaths;
+        std::vector<SearchPath> searchPaths;
 
-        std::filesystem::path resolvePath(const std::filesystem::path& path) const;
+        std::filesystem::path resolvePath(const std::filesystem::path& path, ProbeCount& count) const;
 
         std::vector<std::filesystem::path> resolvePathPattern(
             const std::filesystem::path& path,
@@ -157,6 +247,44 @@ private:
         void addSearchPath(const std::filesystem::path& path, SearchPathPriority priority);
     };
 
+    struct CacheEntry
+    {
+        std::filesystem::path resolved; ///< Resolved path, or empty if the path could not be resolved.
+        uint32_t probes = 0;            ///< Number of file system probes the lookup took.
+        uint32_t missingCount = 0;      ///< Number of candidate paths that were tried and don't exist.
+    };
+
+    /// Resolution cache. Copies of a resolver get a copy of the cache, as their search paths may diverge.
+    struct Cache
+    {
+        Cache() = default;
+        Cache(const Cache& other);
+        Cache& operator=(const Cache& other);
+
+        mutable std::mutex mutex;
+        bool enabled = false;
+        bool cacheNegativeResults = true;
+        std::unordered_map<std::string, CacheEntry> entries; ///< Entries by category and absolute path.
+        CacheStats stats;
+    };
+
+    std::filesystem::path resolvePathUncached(
+        const std::filesystem::path& path,
+        const std::filesystem::path& absolute,
+        AssetCategory category,
+        ProbeCount& count
+    ) const;
+
+    /// Get the first \c count candidate paths of a lookup, in the order resolvePathUncached() tries them.
+    std::vector<std::filesystem::path> getCandidatePaths(
+        const std::filesystem::path& path,
+        const std::filesystem::path& absolute,
+        AssetCategory category,
+        uint32_t count
+    ) const;
+
     std::vector<SearchContext> mSearchContexts;
+    mutable Cache mCache;
+    ResolveCallback mResolveCallback;
 };
 } // namespace Falcor
@@ -43,6 +43,7 @@
 #define _GNU_SOURCE // needed for dladdr()
 #endif
 #include <dlfcn.h>
+#include <time.h>
 
 #include <mutex>
 
@@ -163,6 +164,11 @@ void terminateProcess(size_t processID)
     FALCOR_UNIMPLEMENTED();
 }
 
+uint32_t getCurrentProcessId()
+{
+    return (uint32_t)getpid();
+}
+
 void monitorFileUpdates(const std::filesystem::path& path, const std::function<void()>& callback)
 {
     (void)path;
@@ -588,4 +594,22 @@ size_t getPeakRSS()
     FALCOR_UNIMPLEMENTED();
     return 0;
 }
+
+static double getClockTime(clockid_t clockID)
+{
+    timespec ts;
+    if (clock_gettime(clockID, &ts) != 0)
+        return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double getProcessCpuTime()
+{
+    return getClockTime(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+double getThreadCpuTime()
+{
+    return getClockTime(CLOCK_THREAD_CPUTIME_ID);
+}
 } // namespace Falcor
@@ -31,10 +31,12 @@
 #include "Utils/StringFormatters.h"
 #include <backward/backward.hpp> // TODO: Replace with C++20 <stacktrace> when available.
 #include <zlib.h>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <mutex>
 #include <regex>
+#include <thread>
 
 namespace Falcor
 {
@@ -278,6 +280,45 @@ std::string readFile(const std::filesystem::path& path)
     return std::string((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
 }
 
+void writeFileAtomic(const std::filesystem::path& path, const std::function<void(const std::filesystem::path& tempPath)>& write)
+{
+    // The counter makes the name unique for nested and repeated writes from the same thread.
+    static std::atomic<uint64_t> counter{0};
+    std::filesystem::path tempPath = path;
+    tempPath += fmt::format(
+        ".{}.{}.{}.tmp", getCurrentProcessId(), std::hash<std::thread::id>{}(std::this_thread::get_id()), counter.fetch_add(1)
+    );
+
+    try
+    {
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path());
+        write(tempPath);
+        std::filesystem::rename(tempPath, path);
+    }
+    catch (...)
+    {
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        throw;
+    }
+}
+
+void writeFileAtomic(const std::filesystem::path& path, const void* pData, size_t size)
+{
+    writeFileAtomic(
+        path,
+        [&](const std::filesystem::path& tempPath)
+        {
+            std::ofstream ofs(tempPath, std::ios::binary);
+            ofs.write(static_cast<const char*>(pData), size);
+            ofs.close();
+            if (!ofs)
+                FALCOR_THROW("Failed to write to file '{}'.", tempPath);
+        }
+    );
+}
+
 std::string decompressFile(const std::filesystem::path& path)
 {
     std::string compressed = readFile(path);
@@ -293,6 +293,11 @@ FALCOR_API bool isProcessRunning(size_t processID);
  */
 FALCOR_API void terminateProcess(size_t processID);
 
+/**
+ * Get the ID of the current process.
+ */
+FALCOR_API uint32_t getCurrentProcessId();
+
 /**
  * Get the full path to the Falcor project directory.
  * Note: This is only useful during development.
@@ -456,6 +461,16 @@ FALCOR_API uint64_t getCurrentRSS();
  */
 FALCOR_API uint64_t getPeakRSS();
 
+/**
+ * Returns the CPU time in seconds consumed by all threads of the current process (user and kernel time).
+ */
+FALCOR_API double getProcessCpuTime();
+
+/**
+ * Returns the CPU time in seconds consumed by the calling thread (user and kernel time).
+ */
+FALCOR_API double getThreadCpuTime();
+
 /**
  * Returns index of most significant set bit, or 0 if no bits were set.
  */
@@ -479,6 +494,25 @@ FALCOR_API uint32_t popcount(uint32_t a);
  */
 FALCOR_API std::string readFile(const std::filesystem::path& path);
 
+/**
+ * Write a file atomically, so that other threads and processes never see a partially written file.
+ * The content is written to a temporary file next to the destination, which is then renamed to the destination.
+ * The temporary file name is unique across threads and processes. The parent directory is created if needed.
+ * Throws an exception if the file cannot be written, in which case the temporary file is removed.
+ * @param[in] path File path.
+ * @param[in] write Function writing the content to the temporary file path passed to it. Throws on failure.
+ */
+FALCOR_API void writeFileAtomic(const std::filesystem::path& path, const std::function<void(const std::filesystem::path& tempPath)>& write);
+
+/**
+ * Write data to a file atomically, see writeFileAtomic() above.
+ * Throws an exception if the file cannot be written.
+ * @param[in] path File path.
+ * @param[in] pData Data to write.
+ * @param[in] size Size of the data in bytes.
+ */
+FALCOR_API void writeFileAtomic(const std::filesystem::path& path, const void* pData, size_t size);
+
 /**
  * Read and decompress the contents of a .gz file into a string.
  * Throws an exception if the file cannot be read/decompressed.
@@ -735,6 +735,11 @@ void terminateProcess(size_t processID)
     CloseHandle((HANDLE)processID);
 }
 
+uint32_t getCurrentProcessId()
+{
+    return (uint32_t)GetCurrentProcessId();
+}
+
 static std::unordered_map<std::wstring, std::pair<std::thread, bool> > fileThreads;
 
 static void checkFileModifiedStatus(const std::filesystem::path& path, const std::function<void()>& callback)
@@ -1018,4 +1023,31 @@ size_t getPeakRSS()
         return memoryCounter.PeakWorkingSetSize;
     return 0;
 }
+
+/// Returns the sum of kernel and user time in seconds, given in 100 ns units.
+static double fileTimesToSeconds(const FILETIME& kernelTime, const FILETIME& userTime)
+{
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    return (kernel.QuadPart + user.QuadPart) * 1e-7;
+}
+
+double getProcessCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return fileTimesToSeconds(kernelTime, userTime);
+    return 0.0;
+}
+
+double getThreadCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return fileTimesToSeconds(kernelTime, userTime);
+    return 0.0;
+}
 } // namespace Falcor
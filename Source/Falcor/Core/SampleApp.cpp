@@ -36,6 +36,7 @@
 #include "Core/Platform/ProgressBar.h"
 #include "Utils/Threading.h"
 #include "Utils/Logger.h"
+#include "Utils/Metrics.h"
 #include "Utils/Scripting/Console.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
@@ -510,6 +511,10 @@ void SampleApp::renderFrame()
 #if FALCOR_ENABLE_PROFILER
     mpDevice->getProfiler()->endFrame(pRenderContext);
 #endif
+#if FALCOR_ENABLE_METRICS
+    if (MetricsRegistry::isEnabled())
+        MetricsRegistry::instance().sampleFrame(mFrameRate.getFrameCount());
+#endif
 
     if (mCaptureScreen)
         captureScreen(mpTargetFBO->getColorTexture(0).get());
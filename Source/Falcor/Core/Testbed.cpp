@@ -31,6 +31,7 @@
 #include "Core/Program/ProgramManager.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Threading.h"
+#include "Utils/Metrics.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/ProfilerUI.h"
 #include "Utils/UI/Gui.h"
@@ -123,6 +124,10 @@ void Testbed::frame()
 #if FALCOR_ENABLE_PROFILER
     mpDevice->getProfiler()->endFrame(pRenderContext);
 #endif
+#if FALCOR_ENABLE_METRICS
+    if (MetricsRegistry::isEnabled())
+        MetricsRegistry::instance().sampleFrame(mFrameRate.getFrameCount());
+#endif
 
     // Copy framebuffer to swapchain image.
     if (mpSwapchain)
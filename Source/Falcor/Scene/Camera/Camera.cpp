@@ -260,6 +260,18 @@ namespace Falcor
         return !isInside;
     }
 
+    std::array<float4, 6> Camera::getFrustumPlanes() const
+    {
+        calculateCameraParameters();
+
+        std::array<float4, 6> planes;
+        for (int plane = 0; plane < 6; plane++)
+        {
+            planes[plane] = float4(mFrustumPlanes[plane].xyz, -mFrustumPlanes[plane].negW);
+        }
+        return planes;
+    }
+
     void Camera::bindShaderData(const ShaderVar& var) const
     {
         calculateCameraParameters();
@@ -35,6 +35,7 @@
 #include "Utils/SampleGenerators/CPUSampleGenerator.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Animation/Animatable.h"
+#include <array>
 #include <string>
 
 namespace Falcor
@@ -247,6 +248,13 @@ namespace Falcor
         */
         bool isObjectCulled(const AABB& box) const;
 
+        /** Get the world-space frustum planes.
+            Each plane is stored as (n, w) and a point p is on the inside of the plane if dot(n, p) + w > 0.
+            The planes are not normalized.
+            \return Array of the six frustum planes.
+        */
+        std::array<float4, 6> getFrustumPlanes() const;
+
         /** Set the camera into a shader var
         */
         void bindShaderData(const ShaderVar& var) const;
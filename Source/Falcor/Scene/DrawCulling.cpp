@@ -0,0 +1,50 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "DrawCulling.h"
+#include "Core/Error.h"
+
+namespace Falcor
+{
+    uint64_t compactDrawArgs(const std::vector<uint32_t>& args, uint32_t argStride, const std::vector<uint8_t>& isVisible, std::vector<uint32_t>& culledArgs)
+    {
+        FALCOR_CHECK(argStride > 0 && args.size() % argStride == 0, "'args' must hold a whole number of draws.");
+
+        culledArgs.clear();
+        uint64_t triangleCount = 0;
+        for (size_t i = 0; i < args.size(); i += argStride)
+        {
+            const uint32_t* pArgs = args.data() + i;
+            const uint32_t instanceID = pArgs[argStride - 1];
+            FALCOR_CHECK(instanceID < isVisible.size(), "Instance ID {} is out of range.", instanceID);
+            if (!isVisible[instanceID]) continue;
+            culledArgs.insert(culledArgs.end(), pArgs, pArgs + argStride);
+            triangleCount += pArgs[0] / 3;
+        }
+        return triangleCount;
+    }
+}
@@ -0,0 +1,446 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "InstanceBVH.h"
+#include "Core/Error.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaxBinCount = 64;
+
+        struct Bin
+        {
+            AABB bounds;
+            uint32_t count = 0;
+        };
+
+        /** Returns true if the box is fully outside one of the frustum planes.
+            Sets 'inside' to true if the box is fully inside all planes.
+        */
+        bool isOutside(const InstanceBVH::Frustum& frustum, const AABB& box, bool& inside)
+        {
+            inside = true;
+            for (const float4& plane : frustum)
+            {
+                const float3 n = plane.xyz();
+                float3 pVertex, nVertex;
+                for (int i = 0; i < 3; i++)
+                {
+                    pVertex[i] = n[i] >= 0.f ? box.maxPoint[i] : box.minPoint[i];
+                    nVertex[i] = n[i] >= 0.f ? box.minPoint[i] : box.maxPoint[i];
+                }
+                if (dot(n, pVertex) + plane.w <= 0.f) return true;
+                if (dot(n, nVertex) + plane.w <= 0.f) inside = false;
+            }
+            return false;
+        }
+
+        /** Closed interval overlap test. Boxes that only touch are considered overlapping.
+        */
+        bool overlaps(const AABB& a, const AABB& b)
+        {
+            return all(a.minPoint <= b.maxPoint) && all(a.maxPoint >= b.minPoint);
+        }
+
+        /** Slab test. NaNs from 0 * inf in degenerate cases compare false and leave the interval unchanged.
+        */
+        bool intersectRay(const float3& origin, const float3& invDir, float tMin, float tMax, const AABB& box, float& tEntry)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                float t0 = (box.minPoint[i] - origin[i]) * invDir[i];
+                float t1 = (box.maxPoint[i] - origin[i]) * invDir[i];
+                if (t0 > t1) std::swap(t0, t1);
+                tMin = t0 > tMin ? t0 : tMin;
+                tMax = t1 < tMax ? t1 : tMax;
+                if (tMin > tMax) return false;
+            }
+            tEntry = tMin;
+            return true;
+        }
+    }
+
+    void InstanceBVH::clear()
+    {
+        mStats = {};
+        mItemCount = 0;
+        mNodes.clear();
+        mItemIndices.clear();
+        mItemBounds.clear();
+    }
+
+    void InstanceBVH::build(const std::vector<AABB>& bounds)
+    {
+        FALCOR_CHECK(bounds.size() <= std::numeric_limits<uint32_t>::max(), "Too many items ({}).", bounds.size());
+        FALCOR_CHECK(mOptions.binCount >= 2 && mOptions.binCount <= kMaxBinCount, "'binCount' must be in the range [2, {}].", kMaxBinCount);
+        FALCOR_CHECK(mOptions.maxLeafSize > 0, "'maxLeafSize' must be larger than zero.");
+
+        clear();
+        mItemCount = (uint32_t)bounds.size();
+        mItemBounds = bounds;
+
+        // Collect items with valid bounds.
+        std::vector<float3> centroids(bounds.size());
+        mItemIndices.reserve(bounds.size());
+        for (uint32_t i = 0; i < mItemCount; i++)
+        {
+            if (!bounds[i].valid()) continue;
+            centroids[i] = bounds[i].center();
+            mItemIndices.push_back(i);
+        }
+
+        if (mItemIndices.empty()) return;
+
+        // A binary tree with at least one item per leaf has at most 2n - 1 nodes.
+        mNodes.reserve(2 * mItemIndices.size() - 1);
+        mNodes.emplace_back();
+
+        struct StackEntry
+        {
+            uint32_t nodeIndex;
+            uint32_t begin;
+            uint32_t end;
+            uint32_t depth;
+        };
+        std::vector<StackEntry> stack;
+        stack.push_back({ 0, 0, (uint32_t)mItemIndices.size(), 1 });
+
+        while (!stack.empty())
+        {
+            const StackEntry entry = stack.back();
+            stack.pop_back();
+
+            AABB nodeBounds;
+            AABB centroidBounds;
+            for (uint32_t i = entry.begin; i < entry.end; i++)
+            {
+                uint32_t itemIndex = mItemIndices[i];
+                nodeBounds |= bounds[itemIndex];
+                centroidBounds.include(centroids[itemIndex]);
+            }
+
+            mStats.maxDepth = std::max(mStats.maxDepth, entry.depth);
+
+            const uint32_t count = entry.end - entry.begin;
+            uint32_t mid = count > mOptions.maxLeafSize ? partition(entry.begin, entry.end, centroidBounds, centroids) : entry.begin;
+
+            // Note: 'mNodes' may reallocate below, so index it instead of holding a reference.
+            mNodes[entry.nodeIndex].bounds = nodeBounds;
+            if (mid == entry.begin || mid == entry.end)
+            {
+                mNodes[entry.nodeIndex].offset = entry.begin;
+                mNodes[entry.nodeIndex].count = count;
+                mStats.leafCount++;
+                continue;
+            }
+
+            uint32_t leftIndex = (uint32_t)mNodes.size();
+            mNodes[entry.nodeIndex].offset = leftIndex;
+            mNodes[entry.nodeIndex].count = 0;
+            mNodes.emplace_back();
+            mNodes.emplace_back();
+
+            stack.push_back({ leftIndex + 1, mid, entry.end, entry.depth + 1 });
+            stack.push_back({ leftIndex, entry.begin, mid, entry.depth + 1 });
+        }
+
+        mStats.itemCount = (uint32_t)mItemIndices.size();
+        mStats.nodeCount = (uint32_t)mNodes.size();
+    }
+
+    uint32_t InstanceBVH::partition(uint32_t begin, uint32_t end, const AABB& centroidBounds, const std::vector<float3>& centroids)
+    {
+        const uint32_t count = end - begin;
+        const uint32_t binCount = mOptions.binCount;
+        const float3 extent = centroidBounds.extent();
+
+        float bestCost = std::numeric_limits<float>::infinity();
+        int bestAxis = -1;
+        uint32_t bestBin = 0;
+
+        Bin bins[kMaxBinCount];
+        float rightArea[kMaxBinCount];
+        uint32_t rightCount[kMaxBinCount];
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (extent[axis] <= 0.f) continue;
+
+            for (uint32_t b = 0; b < binCount; b++) bins[b] = {};
+
+            const float scale = binCount / extent[axis];
+            for (uint32_t i = begin; i < end; i++)
+            {
+                uint32_t itemIndex = mItemIndices[i];
+                uint32_t b = std::min(binCount - 1, (uint32_t)((centroids[itemIndex][axis] - centroidBounds.minPoint[axis]) * scale));
+                bins[b].bounds |= mItemBounds[itemIndex];
+                bins[b].count++;
+            }
+
+            // Sweep from the right to compute the cost of the right partitions.
+            AABB accBounds;
+            uint32_t accCount = 0;
+            for (uint32_t b = binCount - 1; b > 0; b--)
+            {
+                accBounds |= bins[b].bounds;
+                accCount += bins[b].count;
+                rightArea[b] = accCount > 0 ? accBounds.area() : 0.f;
+                rightCount[b] = accCount;
+            }
+
+            // Sweep from the left and evaluate the SAH cost of splitting before bin b.
+            accBounds = AABB();
+            accCount = 0;
+            for (uint32_t b = 1; b < binCount; b++)
+            {
+                accBounds |= bins[b - 1].bounds;
+                accCount += bins[b - 1].count;
+                if (accCount == 0 || rightCount[b] == 0) continue;
+
+                float cost = accCount * accBounds.area() + rightCount[b] * rightArea[b];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        // All centroids coincide. Split in the middle so the leaf size limit is still respected.
+        if (bestAxis < 0) return begin + count / 2;
+
+        const float scale = binCount / extent[bestAxis];
+        const float minPoint = centroidBounds.minPoint[bestAxis];
+        auto mid_it = std::partition(mItemIndices.begin() + begin, mItemIndices.begin() + end, [&](uint32_t itemIndex)
+        {
+            uint32_t b = std::min(binCount - 1, (uint32_t)((centroids[itemIndex][bestAxis] - minPoint) * scale));
+            return b < bestBin;
+        });
+
+        return (uint32_t)(mid_it - mItemIndices.begin());
+    }
+
+    void InstanceBVH::refit(const std::vector<AABB>& bounds)
+    {
+        FALCOR_CHECK(bounds.size() == mItemCount, "Item count changed from {} to {}; the BVH must be rebuilt.", mItemCount, bounds.size());
+
+        // Items with invalid bounds at build time are not in the hierarchy. Rebuild if the set of valid items changed.
+        size_t validCount = std::count_if(bounds.begin(), bounds.end(), [](const AABB& aabb) { return aabb.valid(); });
+        bool sameItems = validCount == mItemIndices.size() &&
+            std::all_of(mItemIndices.begin(), mItemIndices.end(), [&](uint32_t itemIndex) { return bounds[itemIndex].valid(); });
+        if (!sameItems)
+        {
+            build(bounds);
+            return;
+        }
+
+        mItemBounds = bounds;
+
+        // Children are always stored after their parent, so a reverse sweep updates children before parents.
+        for (size_t i = mNodes.size(); i-- > 0;)
+        {
+            Node& node = mNodes[i];
+            node.bounds = AABB();
+            if (node.isLeaf())
+            {
+                for (uint32_t j = node.offset; j < node.offset + node.count; j++) node.bounds |= bounds[mItemIndices[j]];
+            }
+            else
+            {
+                node.bounds = mNodes[node.offset].bounds | mNodes[node.offset + 1].bounds;
+            }
+        }
+    }
+
+    void InstanceBVH::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& result) const
+    {
+        result.clear();
+        if (mNodes.empty()) return;
+
+        // Nodes fully inside the frustum are flagged so their subtrees skip the plane tests.
+        std::vector<std::pair<uint32_t, bool>> stack;
+        stack.push_back({ 0, false });
+
+        while (!stack.empty())
+        {
+            auto [nodeIndex, parentInside] = stack.back();
+            stack.pop_back();
+            const Node& node = mNodes[nodeIndex];
+
+            bool inside = parentInside;
+            if (!inside && isOutside(frustum, node.bounds, inside)) continue;
+
+            if (node.isLeaf())
+            {
+                for (uint32_t j = node.offset; j < node.offset + node.count; j++)
+                {
+                    uint32_t itemIndex = mItemIndices[j];
+                    bool itemInside;
+                    if (inside || !isOutside(frustum, mItemBounds[itemIndex], itemInside)) result.push_back(itemIndex);
+                }
+            }
+            else
+            {
+                stack.push_back({ node.offset + 1, inside });
+                stack.push_back({ node.offset, inside });
+            }
+        }
+    }
+
+    void InstanceBVH::queryAABB(const AABB& aabb, std::vector<uint32_t>& result) const
+    {
+        result.clear();
+        if (mNodes.empty() || !aabb.valid()) return;
+
+        std::vector<uint32_t> stack;
+        stack.push_back(0);
+
+        while (!stack.empty())
+        {
+            const Node& node = mNodes[stack.back()];
+            stack.pop_back();
+
+            if (!overlaps(node.bounds, aabb)) continue;
+
+            if (node.isLeaf())
+            {
+                for (uint32_t j = node.offset; j < node.offset + node.count; j++)
+                {
+                    uint32_t itemIndex = mItemIndices[j];
+                    if (overlaps(mItemBounds[itemIndex], aabb)) result.push_back(itemIndex);
+                }
+            }
+            else
+            {
+                stack.push_back(node.offset + 1);
+                stack.push_back(node.offset);
+            }
+        }
+    }
+
+    void InstanceBVH::queryRay(const Ray& ray, std::vector<RayHit>& result) const
+    {
+        result.clear();
+        if (mNodes.empty()) return;
+
+        const float3 invDir = 1.f / ray.dir;
+
+        std::vector<uint32_t> stack;
+        stack.push_back(0);
+
+        while (!stack.empty())
+        {
+            const Node& node = mNodes[stack.back()];
+            stack.pop_back();
+
+            float t;
+            if (!intersectRay(ray.origin, invDir, ray.tMin, ray.tMax, node.bounds, t)) continue;
+
+            if (node.isLeaf())
+            {
+                for (uint32_t j = node.offset; j < node.offset + node.count; j++)
+                {
+                    uint32_t itemIndex = mItemIndices[j];
+                    if (intersectRay(ray.origin, invDir, ray.tMin, ray.tMax, mItemBounds[itemIndex], t)) result.push_back({ itemIndex, t });
+                }
+            }
+            else
+            {
+                stack.push_back(node.offset + 1);
+                stack.push_back(node.offset);
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](const RayHit& a, const RayHit& b) { return a.t < b.t || (a.t == b.t && a.itemIndex < b.itemIndex); });
+    }
+
+    bool InstanceBVH::queryClosest(const Ray& ray, RayHit& hit) const
+    {
+        if (mNodes.empty()) return false;
+
+        const float3 invDir = 1.f / ray.dir;
+        float tMax = ray.tMax;
+        bool found = false;
+
+        std::vector<std::pair<uint32_t, float>> stack;
+        float tRoot;
+        if (!intersectRay(ray.origin, invDir, ray.tMin, tMax, mNodes[0].bounds, tRoot)) return false;
+        stack.push_back({ 0, tRoot });
+
+        while (!stack.empty())
+        {
+            auto [nodeIndex, tNode] = stack.back();
+            stack.pop_back();
+            if (tNode > tMax) continue;
+
+            const Node& node = mNodes[nodeIndex];
+            if (node.isLeaf())
+            {
+                for (uint32_t j = node.offset; j < node.offset + node.count; j++)
+                {
+                    uint32_t itemIndex = mItemIndices[j];
+                    float t;
+                    if (!intersectRay(ray.origin, invDir, ray.tMin, tMax, mItemBounds[itemIndex], t)) continue;
+                    if (!found || t < hit.t || (t == hit.t && itemIndex < hit.itemIndex))
+                    {
+                        hit = { itemIndex, t };
+                        tMax = t;
+                        found = true;
+                    }
+                }
+            }
+            else
+            {
+                // Visit the nearer child first so that the far child can be pruned more often.
+                float t0, t1;
+                bool hit0 = intersectRay(ray.origin, invDir, ray.tMin, tMax, mNodes[node.offset].bounds, t0);
+                bool hit1 = intersectRay(ray.origin, invDir, ray.tMin, tMax, mNodes[node.offset + 1].bounds, t1);
+                if (hit0 && hit1)
+                {
+                    if (t0 <= t1)
+                    {
+                        stack.push_back({ node.offset + 1, t1 });
+                        stack.push_back({ node.offset, t0 });
+                    }
+                    else
+                    {
+                        stack.push_back({ node.offset, t0 });
+                        stack.push_back({ node.offset + 1, t1 });
+                    }
+                }
+                else if (hit0) stack.push_back({ node.offset, t0 });
+                else if (hit1) stack.push_back({ node.offset + 1, t1 });
+            }
+        }
+
+        return found;
+    }
+}
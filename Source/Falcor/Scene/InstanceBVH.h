@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Ray.h"
+#include "Utils/Math/Vector.h"
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU-side bounding volume hierarchy over a set of world-space AABBs.
+
+        The scene uses this to accelerate spatial queries over geometry instances
+        (frustum culling, ray picking and AABB overlap tests) without looping over
+        every instance. Items are referred to by their index in the list of bounds
+        passed to build(). Invalid (empty) bounds are excluded from the hierarchy.
+
+        The BVH is built top-down using a binned SAH. When items move but the set
+        of items is unchanged, refit() updates the node bounds without changing
+        the topology, which is much cheaper than a full rebuild.
+    */
+    class FALCOR_API InstanceBVH
+    {
+    public:
+        /** Build configuration options.
+        */
+        struct Options
+        {
+            uint32_t binCount = 16;         ///< Number of bins per axis used for the SAH evaluation.
+            uint32_t maxLeafSize = 4;       ///< Maximum number of items per leaf node.
+        };
+
+        /** Frustum given by six planes stored as (n, w). A point p is inside a plane if dot(n, p) + w > 0.
+        */
+        using Frustum = std::array<float4, 6>;
+
+        /** Result of a ray query.
+        */
+        struct RayHit
+        {
+            uint32_t itemIndex;             ///< Index of the item that was hit.
+            float t;                        ///< Ray distance to the entry point of the item's bounding box.
+        };
+
+        /** Build statistics.
+        */
+        struct Stats
+        {
+            uint32_t itemCount = 0;         ///< Number of items in the hierarchy.
+            uint32_t nodeCount = 0;         ///< Total number of nodes.
+            uint32_t leafCount = 0;         ///< Number of leaf nodes.
+            uint32_t maxDepth = 0;          ///< Maximum depth of the hierarchy.
+        };
+
+        InstanceBVH() = default;
+        InstanceBVH(const Options& options) : mOptions(options) {}
+
+        /** Build the hierarchy from scratch.
+            \param[in] bounds World-space bounds of all items. Items with invalid bounds are skipped.
+        */
+        void build(const std::vector<AABB>& bounds);
+
+        /** Update the node bounds after items have moved, keeping the topology unchanged.
+            The list of bounds must have the same size as the list used for the last build.
+            If items became valid or invalid since the last build, the hierarchy is rebuilt instead.
+            \param[in] bounds Updated world-space bounds of all items.
+        */
+        void refit(const std::vector<AABB>& bounds);
+
+        /** Remove all items.
+        */
+        void clear();
+
+        /** Find all items whose bounds are not fully outside the frustum.
+            \param[in] frustum Frustum planes.
+            \param[out] result Indices of the items inside or intersecting the frustum. The list is cleared first.
+        */
+        void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& result) const;
+
+        /** Find all items whose bounds overlap the given AABB.
+            \param[in] aabb Query box.
+            \param[out] result Indices of the overlapping items. The list is cleared first.
+        */
+        void queryAABB(const AABB& aabb, std::vector<uint32_t>& result) const;
+
+        /** Find all items whose bounds are intersected by a ray.
+            \param[in] ray Query ray. Only hits within [tMin, tMax] are reported.
+            \param[out] result Items hit, sorted by increasing distance. The list is cleared first.
+        */
+        void queryRay(const Ray& ray, std::vector<RayHit>& result) const;
+
+        /** Find the item whose bounds are intersected closest to the ray origin.
+            \param[in] ray Query ray.
+            \param[out] hit The closest hit, if any.
+            \return True if an item was hit.
+        */
+        bool queryClosest(const Ray& ray, RayHit& hit) const;
+
+        /** Get the bounds of the full hierarchy.
+        */
+        AABB getBounds() const { return mNodes.empty() ? AABB() : mNodes[0].bounds; }
+
+        /** Get the number of items the hierarchy was built for (including items with invalid bounds).
+        */
+        uint32_t getItemCount() const { return mItemCount; }
+
+        const Stats& getStats() const { return mStats; }
+        const Options& getOptions() const { return mOptions; }
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            uint32_t offset = 0;            ///< Index of the first child node for internal nodes, or offset into the item index list for leaves.
+            uint32_t count = 0;             ///< Number of items for leaves, zero for internal nodes.
+
+            bool isLeaf() const { return count > 0; }
+        };
+
+        /** Partition the items in the range [begin, end) using the binned SAH.
+            \return Index of the first item in the right partition.
+        */
+        uint32_t partition(uint32_t begin, uint32_t end, const AABB& centroidBounds, const std::vector<float3>& centroids);
+
+        Options mOptions;
+        Stats mStats;
+        uint32_t mItemCount = 0;
+        std::vector<Node> mNodes;           ///< Nodes. The root is at index 0, siblings are adjacent and children are always stored after their parent.
+        std::vector<uint32_t> mItemIndices; ///< Item indices referenced by the leaves.
+        std::vector<AABB> mItemBounds;      ///< Bounds of all items, indexed by item index.
+    };
+}
@@ -0,0 +1,230 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AlbedoLUTCache.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Cache file version. Bump this whenever the stored data or the way the tables are computed changes.
+        const uint32_t kVersion = 2;
+        const uint32_t kMagic = 0x5455414c; // "LAUT"
+
+        /// Cache directory (subdirectory in the application data directory).
+        const std::string kDirectory = "NVIDIA/Falcor/AlbedoLUTCache";
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t size; ///< Number of entries.
+            uint32_t reserved;
+        };
+
+        /// Reference file storing the content hash of a BRDF file, see computeKey().
+        struct ReferenceFile
+        {
+            static constexpr uint32_t kMagic = 0x46455241; // "AREF"
+
+            uint32_t magic = kMagic;
+            uint32_t version = kVersion;
+            XXH3::Hash128 contentHash;
+        };
+
+        struct FileStamp
+        {
+            uint64_t size = 0;
+            int64_t lastWriteTime = 0;
+
+            bool operator==(const FileStamp& other) const { return size == other.size && lastWriteTime == other.lastWriteTime; }
+        };
+
+        std::optional<FileStamp> getFileStamp(const std::filesystem::path& path)
+        {
+            std::error_code ec;
+            FileStamp stamp;
+            stamp.size = std::filesystem::file_size(path, ec);
+            if (ec) return {};
+            stamp.lastWriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+            if (ec) return {};
+            return stamp;
+        }
+
+        /** Get the content hash of a BRDF file. The hash is looked up in a reference file named after the path, size and
+            last write time of the BRDF file, and computed and stored in a new reference file if there is none.
+        */
+        std::optional<XXH3::Hash128> getContentHash(const std::filesystem::path& path)
+        {
+            const auto stamp = getFileStamp(path);
+            if (!stamp) return {};
+
+            std::error_code ec;
+            XXH3 xxh3;
+            xxh3.update(kVersion);
+            xxh3.update(std::filesystem::absolute(path, ec).lexically_normal().string());
+            xxh3.update(stamp->size);
+            xxh3.update(stamp->lastWriteTime);
+            const std::filesystem::path refPath = getAppDataDirectory() / kDirectory / (XXH3::toString(xxh3.digest128()) + ".ref");
+
+            {
+                std::ifstream fs(refPath, std::ios_base::binary);
+                ReferenceFile file;
+                fs.read(reinterpret_cast<char*>(&file), sizeof(file));
+                if (fs.good() && file.magic == ReferenceFile::kMagic && file.version == kVersion) return file.contentHash;
+            }
+
+            ReferenceFile file;
+            try
+            {
+                file.contentHash = XXH3::hashFile(path);
+            }
+            catch (const std::exception&)
+            {
+                return {};
+            }
+
+            // Only store the hash if the file didn't change while it was hashed.
+            if (getFileStamp(path) == stamp)
+            {
+                try
+                {
+                    writeFileAtomic(refPath, &file, sizeof(file));
+                }
+                catch (const std::exception& e)
+                {
+                    logDebug("Albedo LUT cache can't store '{}': {}", refPath, e.what());
+                }
+            }
+            return file.contentHash;
+        }
+
+        std::filesystem::path getCacheFilePath(const AlbedoLUTCache::Key& key, const std::string& extension)
+        {
+            return getAppDataDirectory() / kDirectory / (XXH3::toString(key) + extension);
+        }
+
+        template<typename T>
+        std::vector<T> readCacheFile(const std::filesystem::path& path, size_t size)
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs.good())
+                return {};
+
+            FileHeader header = {};
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!fs.good() || header.magic != kMagic || header.version != kVersion || header.size != size)
+            {
+                logWarning("Ignoring invalid albedo LUT cache file '{}'.", path);
+                return {};
+            }
+
+            std::vector<T> data(size);
+            fs.read(reinterpret_cast<char*>(data.data()), size * sizeof(T));
+            if (!fs.good())
+            {
+                logWarning("Albedo LUT cache file '{}' is truncated.", path);
+                return {};
+            }
+
+            return data;
+        }
+
+        template<typename T>
+        bool writeCacheFile(const std::filesystem::path& path, const std::vector<T>& data)
+        {
+            std::vector<uint8_t> fileData(sizeof(FileHeader) + data.size() * sizeof(T));
+            FileHeader header = {kMagic, kVersion, (uint32_t)data.size(), 0};
+            std::memcpy(fileData.data(), &header, sizeof(header));
+            std::memcpy(fileData.data() + sizeof(header), data.data(), data.size() * sizeof(T));
+
+            try
+            {
+                writeFileAtomic(path, fileData.data(), fileData.size());
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write albedo LUT cache file '{}': {}", path, e.what());
+                return false;
+            }
+            return true;
+        }
+    }
+
+    std::optional<AlbedoLUTCache::Key> AlbedoLUTCache::computeKey(const std::filesystem::path& path)
+    {
+        // The file hash is the same as the tree hash of the data, so files and data in memory have the same keys.
+        const auto contentHash = getContentHash(path);
+        if (!contentHash)
+            return {};
+
+        XXH3 xxh3;
+        xxh3.update(kVersion);
+        xxh3.update(contentHash->low);
+        xxh3.update(contentHash->high);
+        return xxh3.digest128();
+    }
+
+    AlbedoLUTCache::Key AlbedoLUTCache::computeKey(const void* pData, size_t size)
+    {
+        XXH3 xxh3;
+        xxh3.update(kVersion);
+        const XXH3::Hash128 contentHash = XXH3::hashTree128(pData, size);
+        xxh3.update(contentHash.low);
+        xxh3.update(contentHash.high);
+        return xxh3.digest128();
+    }
+
+    std::filesystem::path AlbedoLUTCache::getCachePath(const Key& key)
+    {
+        return getCacheFilePath(key, ".lut");
+    }
+
+    std::vector<float4> AlbedoLUTCache::load(const Key& key, size_t size)
+    {
+        return readCacheFile<float4>(getCachePath(key), size);
+    }
+
+    bool AlbedoLUTCache::store(const Key& key, const std::vector<float4>& lut)
+    {
+        return writeCacheFile(getCachePath(key), lut);
+    }
+
+    std::vector<float3> AlbedoLUTCache::loadData(const Key& key, size_t size)
+    {
+        return readCacheFile<float3>(getCacheFilePath(key, ".brdf"), size);
+    }
+
+    bool AlbedoLUTCache::storeData(const Key& key, const std::vector<float3>& data)
+    {
+        return writeCacheFile(getCacheFilePath(key, ".brdf"), data);
+    }
+}
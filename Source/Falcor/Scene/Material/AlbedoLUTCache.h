@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Disk cache for the albedo lookup tables of measured materials (MERL, RGL).
+
+        Computing an albedo lookup table requires integrating the BRDF, which is expensive.
+        The tables are stored in a compact binary format in the application data directory, along with
+        BRDF data that has been converted from the format of the source file (see MERLFile).
+        Entries are keyed by a hash of the BRDF data, so edited BRDF files never hit stale entries.
+        Content hashes of BRDF files are stored in small reference files named after the path, size and
+        last write time of the file, so unchanged files are only hashed once. All functions are thread-safe.
+    */
+    class FALCOR_API AlbedoLUTCache
+    {
+    public:
+        using Key = XXH3::Hash128;
+
+        /** Compute the cache key for a BRDF file.
+            \param[in] path Path to the BRDF file.
+            \return The key, or an empty optional if the file can't be read.
+        */
+        static std::optional<Key> computeKey(const std::filesystem::path& path);
+
+        /** Compute the cache key for BRDF data in memory.
+            \param[in] pData BRDF data.
+            \param[in] size Size of the data in bytes.
+            \return The key.
+        */
+        static Key computeKey(const void* pData, size_t size);
+
+        /** Get the path of the cache file for the given key.
+        */
+        static std::filesystem::path getCachePath(const Key& key);
+
+        /** Load an albedo lookup table from the cache.
+            \param[in] key Cache key.
+            \param[in] size Expected number of entries in the table.
+            \return The table, or an empty vector if there is no valid cache entry.
+        */
+        static std::vector<float4> load(const Key& key, size_t size);
+
+        /** Store an albedo lookup table in the cache.
+            Failing to write the cache file is not an error, the table is recomputed next time.
+            \param[in] key Cache key.
+            \param[in] lut The table.
+            \return True if the table was stored.
+        */
+        static bool store(const Key& key, const std::vector<float4>& lut);
+
+        /** Load converted BRDF data from the cache.
+            \param[in] key Cache key.
+            \param[in] size Expected number of samples.
+            \return The data, or an empty vector if there is no valid cache entry.
+        */
+        static std::vector<float3> loadData(const Key& key, size_t size);
+
+        /** Store converted BRDF data in the cache.
+            Failing to write the cache file is not an error, the data is converted again next time.
+            \param[in] key Cache key.
+            \param[in] data BRDF samples.
+            \return True if the data was stored.
+        */
+        static bool storeData(const Key& key, const std::vector<float3>& data);
+    };
+}
@@ -611,6 +611,29 @@ namespace Falcor
         return true;
     }
 
+    size_t BasicMaterial::getHash() const
+    {
+        // Hash the same fields as operator==().
+        size_t hash = getBaseHash();
+        hashCombine(hash, mData.flags);
+        hashCombine(hash, mData.displacementScale);
+        hashCombine(hash, mData.displacementOffset);
+        hashCombine(hash, (float4)mData.baseColor);
+        hashCombine(hash, (float4)mData.specular);
+        hashCombine(hash, mData.emissive);
+        hashCombine(hash, mData.emissiveFactor);
+        hashCombine(hash, (float)mData.diffuseTransmission);
+        hashCombine(hash, (float)mData.specularTransmission);
+        hashCombine(hash, (float3)mData.transmission);
+        hashCombine(hash, (float3)mData.volumeAbsorption);
+        hashCombine(hash, (float)mData.volumeAnisotropy);
+        hashCombine(hash, (float3)mData.volumeScattering);
+        hashCombine(hash, mpDefaultSampler->getDesc());
+        hashCombine(hash, mpDisplacementMinSampler->getDesc());
+        hashCombine(hash, mpDisplacementMaxSampler->getDesc());
+        return hash;
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
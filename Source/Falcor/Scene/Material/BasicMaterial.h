@@ -65,6 +65,7 @@ namespace Falcor
             \return true if all materials properties *except* the name are identical.
         */
         bool isEqual(const ref<Material>& pOther) const override;
+        size_t getHash() const override;
 
         /** Set the alpha mode.
         */
@@ -31,6 +31,10 @@
 #include "Scene/Material/MERLMaterial.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -41,6 +45,7 @@ namespace Falcor
         const size_t kBRDFSamplingResThetaH = 90;
         const size_t kBRDFSamplingResThetaD = 90;
         const size_t kBRDFSamplingResPhiD = 360;
+        const size_t kBRDFSampleCount = kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2;
 
         // Scale factors for the RGB channels of the measured data.
         const double kRedScale = 1.0 / 1500.0;
@@ -48,6 +53,84 @@ namespace Falcor
         const double kBlueScale = 1.66 / 1500.0;
 
         const uint32_t kAlbedoLUTSize = MERLMaterialData::kAlbedoLUTSize;
+
+        // Size of the integration grid over the hemisphere used by the CPU integrator.
+        // There is one sample at the center of each grid cell.
+        const uint32_t kCPUGridSize = 512;
+
+        // CPU implementations of the helpers in MERLCommon.slang.
+
+        float3 rotateVector(const float3 v, const float3 axis, const float angle)
+        {
+            float c = std::cos(angle);
+            float s = std::sin(angle);
+            float tmp = dot(v, axis) * (1.f - c);
+            float3 w = cross(axis, v);
+            return v * c + axis * tmp + w * s;
+        }
+
+        uint32_t getThetaHIndex(float thetaH)
+        {
+            if (thetaH <= 0.f) return 0;
+            int idx = (int)(std::sqrt(thetaH * (float)M_2_PI) * kBRDFSamplingResThetaH);
+            return (uint32_t)std::min(idx, (int)kBRDFSamplingResThetaH - 1);
+        }
+
+        uint32_t getThetaDIndex(float thetaD)
+        {
+            int idx = (int)(thetaD * (float)M_2_PI * kBRDFSamplingResThetaD);
+            return (uint32_t)std::clamp(idx, 0, (int)kBRDFSamplingResThetaD - 1);
+        }
+
+        uint32_t getPhiDIndex(float phiD)
+        {
+            if (phiD < 0.f) phiD += (float)M_PI;
+            int idx = (int)(phiD * (float)M_1_PI * (kBRDFSamplingResPhiD / 2));
+            return (uint32_t)std::clamp(idx, 0, (int)kBRDFSamplingResPhiD / 2 - 1);
+        }
+
+        /** Evaluate the MERL BRDF in the local frame. Returns f(wi, wo) * wo.z.
+        */
+        float3 evalMERL(const std::vector<float3>& data, const float3 wi, const float3 wo)
+        {
+            float3 h = normalize(wi + wo);
+            float thetaH = std::acos(std::clamp(h.z, -1.f, 1.f));
+            float phiH = std::atan2(h.y, h.x);
+
+            float3 temp = rotateVector(wi, float3(0.f, 0.f, 1.f), -phiH);
+            float3 diff = rotateVector(temp, float3(0.f, 1.f, 0.f), -thetaH);
+            float thetaD = std::acos(std::clamp(diff.z, -1.f, 1.f));
+            float phiD = std::atan2(diff.y, diff.x);
+
+            size_t idx = (getThetaDIndex(thetaD) + getThetaHIndex(thetaH) * kBRDFSamplingResThetaD) * (kBRDFSamplingResPhiD / 2) + getPhiDIndex(phiD);
+            return data[idx] * wo.z;
+        }
+
+        /** Cosine-weighted hemisphere sampling using Shirley's concentric mapping, see MathHelpers.slang.
+        */
+        float3 sampleCosineHemisphereConcentric(float2 u, float& pdf)
+        {
+            u = 2.f * u - 1.f;
+            float2 d = u;
+            if (u.x != 0.f || u.y != 0.f)
+            {
+                float phi, r;
+                if (std::abs(u.x) > std::abs(u.y))
+                {
+                    r = u.x;
+                    phi = (u.y / u.x) * (float)M_PI_4;
+                }
+                else
+                {
+                    r = u.y;
+                    phi = (float)M_PI_2 - (u.x / u.y) * (float)M_PI_4;
+                }
+                d = r * float2(std::cos(phi), std::sin(phi));
+            }
+            float z = std::sqrt(std::max(0.f, 1.f - dot(d, d)));
+            pdf = z * (float)M_1_PI;
+            return float3(d, z);
+        }
     }
 
     MERLFile::MERLFile(const std::filesystem::path& path)
@@ -61,7 +144,42 @@ namespace Falcor
         mDesc = {};
         mData.clear();
         mAlbedoLUT.clear();
+        mCacheKey.reset();
+
+        mDesc.path = path;
+        mDesc.name = path.stem().string();
+
+        // Key the caches by the content of the BRDF file. Unchanged files are not hashed again (see AlbedoLUTCache::computeKey()),
+        // and the converted data is loaded from the cache instead of converting the file.
+        const auto fileKey = AlbedoLUTCache::computeKey(path);
+        if (fileKey)
+            mData = AlbedoLUTCache::loadData(*fileKey, kBRDFSampleCount);
+
+        if (mData.empty())
+        {
+            if (!readBRDF(path))
+            {
+                mDesc = {};
+                return false;
+            }
+            if (fileKey)
+                AlbedoLUTCache::storeData(*fileKey, mData);
+        }
+
+        // Key the albedo LUT cache by the converted data if the file couldn't be hashed.
+        mCacheKey = fileKey ? fileKey : AlbedoLUTCache::computeKey(mData.data(), mData.size() * sizeof(float3));
+
+        // Load JSON sidecar file if it exists.
+        const auto jsonPath = std::filesystem::path(path).replace_extension("json");
+        if (!DiffuseSpecularUtils::loadJSONData(jsonPath, mDesc.extraData))
+            logWarning("MERLFile: Failed to load associated JSON data for BRDF '{}'.", mDesc.name);
 
+        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
+        return true;
+    }
+
+    bool MERLFile::readBRDF(const std::filesystem::path& path)
+    {
         std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
         if (!ifs.good())
         {
@@ -74,7 +192,7 @@ namespace Falcor
         ifs.read(reinterpret_cast<char*>(dims), sizeof(int) * 3);
 
         size_t n = (size_t)dims[0] * dims[1] * dims[2];
-        if (n != kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2)
+        if (n != kBRDFSampleCount)
         {
             logWarning("MERLFile: Dimensions don't match in file '{}'.", path);
             return false;
@@ -89,17 +207,7 @@ namespace Falcor
             return false;
         }
 
-        mDesc.path = path;
-        mDesc.name = path.stem().string();
-
         prepareData(dims, data);
-
-        // Load JSON sidecar file if it exists.
-        const auto jsonPath = std::filesystem::path(path).replace_extension("json");
-        if (!DiffuseSpecularUtils::loadJSONData(jsonPath, mDesc.extraData))
-            logWarning("MERLFile: Failed to load associated JSON data for BRDF '{}'.", mDesc.name);
-
-        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
         return true;
     }
 
@@ -147,10 +255,18 @@ namespace Falcor
         if (!mAlbedoLUT.empty())
             return mAlbedoLUT;
 
-        FALCOR_CHECK(!mDesc.path.empty(), "No BRDF loaded");
-        const auto texPath = mDesc.path.replace_extension("dds");
+        FALCOR_CHECK(!mDesc.path.empty() && mCacheKey, "No BRDF loaded");
 
-        // Try loading cached albedo lookup table.
+        // Try loading the albedo lookup table from the cache.
+        mAlbedoLUT = AlbedoLUTCache::load(*mCacheKey, kAlbedoLUTSize);
+        if (!mAlbedoLUT.empty())
+        {
+            logInfo("Loaded albedo LUT for MERL BRDF '{}' from cache.", mDesc.name);
+            return mAlbedoLUT;
+        }
+
+        // Try loading a precomputed albedo lookup table stored next to the BRDF file.
+        const auto texPath = std::filesystem::path(mDesc.path).replace_extension("dds");
         if (std::filesystem::is_regular_file(texPath))
         {
             const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
@@ -163,26 +279,77 @@ namespace Falcor
                 std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
 
                 logInfo("Loaded albedo LUT from '{}'.", texPath.string());
+                AlbedoLUTCache::store(*mCacheKey, mAlbedoLUT);
                 return mAlbedoLUT;
             }
         }
 
         // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+        if (pDevice)
+            computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+        else
+            mAlbedoLUT = computeAlbedoLUTCPU(kAlbedoLUTSize);
         FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
 
-        // Cache lookup table as texture on disk.
-        {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
-            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
-
-            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
-            logInfo("Saved albedo LUT to '{}'.", texPath);
-        }
+        // Cache lookup table on disk.
+        if (AlbedoLUTCache::store(*mCacheKey, mAlbedoLUT))
+            logInfo("Saved albedo LUT for MERL BRDF '{}' to '{}'.", mDesc.name, AlbedoLUTCache::getCachePath(*mCacheKey));
 
         return mAlbedoLUT;
     }
 
+    std::vector<float4> MERLFile::computeAlbedoLUTCPU(const size_t binCount) const
+    {
+        FALCOR_CHECK(!mData.empty(), "No BRDF loaded");
+        logInfo("MERLFile: Computing albedo LUT for MERL BRDF '{}' on the CPU...", mDesc.name);
+
+        // Integrate each row of the integration grid of each bin in parallel.
+        // The row sums are reduced afterwards in a fixed order, so the result is deterministic.
+        std::vector<float3> rowSums(binCount * kCPUGridSize);
+        auto range = NumericRange<size_t>(0, rowSums.size());
+        std::for_each(
+            std::execution::par,
+            range.begin(),
+            range.end(),
+            [&](size_t i)
+            {
+                const size_t bin = i / kCPUGridSize;
+                const uint32_t y = (uint32_t)(i % kCPUGridSize);
+
+                // Same incident directions as computeAlbedoLUT().
+                float cosTheta = std::clamp((float)(bin + 1) / binCount, 0.f, 1.f);
+                float sinTheta = std::sqrt(1.f - cosTheta * cosTheta);
+                float3 wi = float3(sinTheta, 0.f, cosTheta);
+
+                float3 sum(0.f);
+                for (uint32_t x = 0; x < kCPUGridSize; x++)
+                {
+                    float2 u = (float2((float)x, (float)y) + 0.5f) / (float)kCPUGridSize;
+                    float pdf = 0.f;
+                    float3 wo = sampleCosineHemisphereConcentric(u, pdf);
+                    if (pdf > 0.f)
+                        sum += evalMERL(mData, wi, wo) / pdf;
+                }
+                rowSums[i] = sum;
+            }
+        );
+
+        std::vector<float4> lut(binCount);
+        for (size_t bin = 0; bin < binCount; bin++)
+        {
+            double sum[3] = {};
+            for (uint32_t y = 0; y < kCPUGridSize; y++)
+            {
+                const float3& rowSum = rowSums[bin * kCPUGridSize + y];
+                for (int c = 0; c < 3; c++)
+                    sum[c] += rowSum[c];
+            }
+            const double scale = 1.0 / (double(kCPUGridSize) * kCPUGridSize);
+            lut[bin] = float4((float)(sum[0] * scale), (float)(sum[1] * scale), (float)(sum[2] * scale), 1.f);
+        }
+        return lut;
+    }
+
     void MERLFile::computeAlbedoLUT(ref<Device> pDevice, const size_t binCount)
     {
         logInfo("MERLFile: Computing albedo LUT for MERL BRDF '{}'...", mDesc.name);
@@ -29,9 +29,11 @@
 #include "Core/API/fwd.h"
 #include "Core/API/Formats.h"
 #include "Utils/Math/Vector.h"
+#include "Scene/Material/AlbedoLUTCache.h"
 #include "Scene/Material/DiffuseSpecularData.slang"
 #include <filesystem>
 #include <memory>
+#include <optional>
 
 namespace Falcor
 {
@@ -66,21 +68,31 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
         /** Prepare an albedo lookup table.
-            The table is loaded from disk or recomputed if needed.
-            \param[in] pDevice The device.
+            The table is loaded from the albedo LUT cache (see AlbedoLUTCache) or recomputed if needed.
+            \param[in] pDevice The device used to compute the table, or nullptr to compute it on the CPU.
             \return Albedo lookup table that can be used with `kAlbedoLUTFormat`.
         */
         const std::vector<float4>& prepareAlbedoLUT(ref<Device> pDevice);
 
+        /** Compute an albedo lookup table on the CPU using all available cores.
+            This integrates the BRDF the same way as BSDFIntegrator but doesn't need a device,
+            which allows producing lookup tables offline in batch.
+            \param[in] binCount Number of table entries. Entry i is the albedo at cos(theta) = (i + 1) / binCount.
+            \return Albedo lookup table.
+        */
+        std::vector<float4> computeAlbedoLUTCPU(const size_t binCount) const;
+
         const Desc& getDesc() const { return mDesc; }
         const std::vector<float3>& getData() const { return mData; }
 
     private:
+        bool readBRDF(const std::filesystem::path& path);
         void prepareData(const int dims[3], const std::vector<double>& data);
         void computeAlbedoLUT(ref<Device> pDevice, const size_t binCount);
 
         Desc mDesc;                     ///< BRDF description and sampling parameters.
         std::vector<float3> mData;      ///< BRDF data in RGB float format.
         std::vector<float4> mAlbedoLUT; ///< Precomputed albedo lookup table.
+        std::optional<AlbedoLUTCache::Key> mCacheKey; ///< Cache key computed from the BRDF file, see AlbedoLUTCache.
     };
 }
@@ -32,6 +32,7 @@
 #include "GlobalState.h"
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/MeasuredBRDFRegistry.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
 
 namespace Falcor
@@ -41,39 +42,66 @@ namespace Falcor
         static_assert((sizeof(MaterialHeader) + sizeof(MERLMaterialData)) <= sizeof(MaterialDataBlob), "MERLMaterialData is too large");
 
         const char kShaderFile[] = "Rendering/Materials/MERLMaterial.slang";
+
+        ref<Buffer> createBRDFBuffer(const ref<Device>& pDevice, const MERLFile& merlFile)
+        {
+            const auto& brdf = merlFile.getData();
+            FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
+            return pDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+        }
     }
 
+    struct MERLMaterial::SharedData : MeasuredBRDFRegistry::Data
+    {
+        MERLFile::Desc desc;
+        ref<Buffer> pBRDFData;
+        ref<Texture> pAlbedoLUT;
+
+        uint64_t getMemoryInBytes() const override { return pBRDFData->getSize() + pAlbedoLUT->getTextureSizeInBytes(); }
+    };
+
     MERLMaterial::MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
         : Material(pDevice, name, MaterialType::MERL)
     {
         FALCOR_CHECK(!path.empty(), "Missing path.");
 
-        MERLFile merlFile(path);
-        init(merlFile);
+        // Load the BRDF, unless another material already uses it.
+        mpSharedData = MeasuredBRDFRegistry::acquire<SharedData>(mpDevice.get(), "MERL", {path}, [&]()
+        {
+            MERLFile merlFile(path);
+
+            auto pSharedData = std::make_shared<SharedData>();
+            pSharedData->desc = merlFile.getDesc();
+            pSharedData->pBRDFData = createBRDFBuffer(mpDevice, merlFile);
+
+            // Create albedo LUT texture.
+            auto lut = merlFile.prepareAlbedoLUT(mpDevice);
+            FALCOR_CHECK(!lut.empty() && sizeof(lut[0]) == sizeof(float4), "Expected albedo LUT in float4 format.");
+            static_assert(MERLFile::kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
+            pSharedData->pAlbedoLUT = mpDevice->createTexture2D((uint32_t)lut.size(), 1, MERLFile::kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
 
-        // Create albedo LUT texture.
-        auto lut = merlFile.prepareAlbedoLUT(mpDevice);
-        FALCOR_CHECK(!lut.empty() && sizeof(lut[0]) == sizeof(float4), "Expected albedo LUT in float4 format.");
-        static_assert(MERLFile::kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        mpAlbedoLUT = mpDevice->createTexture2D((uint32_t)lut.size(), 1, MERLFile::kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
+            return pSharedData;
+        });
+        FALCOR_ASSERT(mpSharedData);
+
+        const auto& desc = mpSharedData->desc;
+        init(desc.path, desc.name, desc.extraData, mpSharedData->pBRDFData);
+        mpAlbedoLUT = mpSharedData->pAlbedoLUT;
     }
 
     MERLMaterial::MERLMaterial(ref<Device> pDevice, const MERLFile& merlFile)
         : Material(pDevice, "", MaterialType::MERL)
     {
-        init(merlFile);
+        const auto& desc = merlFile.getDesc();
+        init(desc.path, desc.name, desc.extraData, createBRDFBuffer(mpDevice, merlFile));
     }
 
-    void MERLMaterial::init(const MERLFile& merlFile)
+    void MERLMaterial::init(const std::filesystem::path& path, const std::string& brdfName, const DiffuseSpecularData& extraData, const ref<Buffer>& pBRDFData)
     {
-        mPath = merlFile.getDesc().path;
-        mBRDFName = merlFile.getDesc().name;
-        mData.extraData = merlFile.getDesc().extraData;
-
-        // Create GPU buffer.
-        const auto& brdf = merlFile.getData();
-        FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
-        mpBRDFData = mpDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+        mPath = path;
+        mBRDFName = brdfName;
+        mData.extraData = extraData;
+        mpBRDFData = pBRDFData;
 
         // Create sampler for albedo LUT.
         Sampler::Desc desc;
@@ -141,6 +169,13 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        hashCombine(hash, std::filesystem::hash_value(mPath));
+        return hash;
+    }
+
     ProgramDesc::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -28,6 +28,7 @@
 #pragma once
 #include "Material.h"
 #include "MERLMaterialData.slang"
+#include <memory>
 
 namespace Falcor
 {
@@ -52,6 +53,7 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        size_t getHash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -59,7 +61,9 @@ namespace Falcor
         size_t getMaxBufferCount() const override { return 1; }
 
     protected:
-        void init(const MERLFile& merlFile);
+        struct SharedData;
+
+        void init(const std::filesystem::path& path, const std::string& brdfName, const DiffuseSpecularData& extraData, const ref<Buffer>& pBRDFData);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
@@ -68,5 +72,6 @@ namespace Falcor
         ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 array.
         ref<Texture> mpAlbedoLUT;           ///< Precomputed albedo lookup table.
         ref<Sampler> mpLUTSampler;          ///< Sampler for accessing the LUT texture.
+        std::shared_ptr<SharedData> mpSharedData; ///< BRDF data shared with other materials using the same BRDF (see MeasuredBRDFRegistry).
     };
 }
@@ -33,6 +33,7 @@
 #include "GlobalState.h"
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/MeasuredBRDFRegistry.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
 #include <fstream>
 
@@ -46,6 +47,17 @@ namespace Falcor
         const char kShaderFile[] = "Rendering/Materials/MERLMixMaterial.slang";
     }
 
+    struct MERLMixMaterial::SharedData : MeasuredBRDFRegistry::Data
+    {
+        std::vector<BRDFDesc> brdfs;
+        uint32_t byteStride = 0;        ///< Byte stride between the BRDFs in the data buffer.
+        uint32_t extraDataOffset = 0;   ///< Byte offset of the DiffuseSpecularData array in the data buffer.
+        ref<Buffer> pBRDFData;
+        ref<Texture> pAlbedoLUT;
+
+        uint64_t getMemoryInBytes() const override { return pBRDFData->getSize() + pAlbedoLUT->getTextureSizeInBytes(); }
+    };
+
     MERLMixMaterial::MERLMixMaterial(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths)
         : Material(pDevice, name, MaterialType::MERLMix)
     {
@@ -55,56 +67,70 @@ namespace Falcor
         mTextureSlotInfo[(uint32_t)TextureSlot::Normal] = { "normal", TextureChannelFlags::RGB, false };
         mTextureSlotInfo[(uint32_t)TextureSlot::Index] = { "index", TextureChannelFlags::Red, false };
 
-        // Load all BRDFs.
-        mBRDFs.resize(paths.size());
-        std::vector<DiffuseSpecularData> extraData(paths.size());
-        std::vector<float4> albedoLut;
-        BufferAllocator buffer(128, 0 /* raw buffer */, 128, ResourceBindFlags::ShaderResource);
-        MERLFile merlFile;
-
-        for (size_t i = 0; i < paths.size(); i++)
+        // Load all BRDFs, unless another material already uses the same list of BRDFs.
+        mpSharedData = MeasuredBRDFRegistry::acquire<SharedData>(mpDevice.get(), "MERLMix", paths, [&]()
         {
-            if (!merlFile.loadBRDF(paths[i]))
-                FALCOR_THROW("MERLMixMaterial: Failed to load BRDF from '{}'.", paths[i]);
-
-            auto& desc = mBRDFs[i];
-            desc.path = merlFile.getDesc().path;
-            desc.name = merlFile.getDesc().name;
-            extraData[i] = merlFile.getDesc().extraData;
-
-            // Copy BRDF samples into shared data buffer.
-            const auto& brdf = merlFile.getData();
-            FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
-            desc.byteSize = brdf.size() * sizeof(brdf[0]);
-            desc.byteOffset = buffer.allocate(desc.byteSize);
-            buffer.setBlob(brdf.data(), desc.byteOffset, desc.byteSize);
-
-            // Copy albedo LUT into shared table.
-            const auto& lut = merlFile.prepareAlbedoLUT(mpDevice);
-            FALCOR_CHECK(lut.size() == MERLMixMaterialData::kAlbedoLUTSize, "MERLMixMaterial: Unexpected albedo LUT size.");
-            albedoLut.insert(albedoLut.end(), lut.begin(), lut.end());
-        }
+            auto pSharedData = std::make_shared<SharedData>();
+            auto& brdfs = pSharedData->brdfs;
+            brdfs.resize(paths.size());
+            std::vector<DiffuseSpecularData> extraData(paths.size());
+            std::vector<float4> albedoLut;
+            BufferAllocator buffer(128, 0 /* raw buffer */, 128, ResourceBindFlags::ShaderResource);
+            MERLFile merlFile;
+
+            for (size_t i = 0; i < paths.size(); i++)
+            {
+                if (!merlFile.loadBRDF(paths[i]))
+                    FALCOR_THROW("MERLMixMaterial: Failed to load BRDF from '{}'.", paths[i]);
+
+                auto& desc = brdfs[i];
+                desc.path = merlFile.getDesc().path;
+                desc.name = merlFile.getDesc().name;
+                extraData[i] = merlFile.getDesc().extraData;
+
+                // Copy BRDF samples into shared data buffer.
+                const auto& brdf = merlFile.getData();
+                FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
+                desc.byteSize = brdf.size() * sizeof(brdf[0]);
+                desc.byteOffset = buffer.allocate(desc.byteSize);
+                buffer.setBlob(brdf.data(), desc.byteOffset, desc.byteSize);
+
+                // Copy albedo LUT into shared table.
+                const auto& lut = merlFile.prepareAlbedoLUT(mpDevice);
+                FALCOR_CHECK(lut.size() == MERLMixMaterialData::kAlbedoLUTSize, "MERLMixMaterial: Unexpected albedo LUT size.");
+                albedoLut.insert(albedoLut.end(), lut.begin(), lut.end());
+            }
 
-        mData.brdfCount = static_cast<uint32_t>(mBRDFs.size());
-        mData.byteStride = mBRDFs.size() > 1 ? mBRDFs[1].byteOffset : 0;
-        for (size_t i = 0; i < mBRDFs.size(); i++)
-        {
-            FALCOR_CHECK(mBRDFs[i].byteOffset == i * mData.byteStride, "MERLMixMaterial: Unexpected stride.");
-        }
+            pSharedData->byteStride = brdfs.size() > 1 ? (uint32_t)brdfs[1].byteOffset : 0;
+            for (size_t i = 0; i < brdfs.size(); i++)
+            {
+                FALCOR_CHECK(brdfs[i].byteOffset == i * pSharedData->byteStride, "MERLMixMaterial: Unexpected stride.");
+            }
 
-        // Upload extra data for sampling.
-        {
-            mData.extraDataStride = (uint32_t)sizeof(DiffuseSpecularData);
-            size_t byteSize = extraData.size() * mData.extraDataStride;
-            mData.extraDataOffset = buffer.allocate(byteSize);
-            buffer.setBlob(extraData.data(), mData.extraDataOffset, byteSize);
-        }
+            // Upload extra data for sampling.
+            {
+                size_t byteSize = extraData.size() * sizeof(DiffuseSpecularData);
+                pSharedData->extraDataOffset = (uint32_t)buffer.allocate(byteSize);
+                buffer.setBlob(extraData.data(), pSharedData->extraDataOffset, byteSize);
+            }
+
+            // Create GPU data buffer.
+            pSharedData->pBRDFData = buffer.getGPUBuffer(mpDevice);
+
+            // Create albedo LUT as 2D texture parameterization over (cosTehta, brdfIndex).
+            pSharedData->pAlbedoLUT = mpDevice->createTexture2D(MERLMixMaterialData::kAlbedoLUTSize, (uint32_t)brdfs.size(), MERLFile::kAlbedoLUTFormat, 1, 1, albedoLut.data(), ResourceBindFlags::ShaderResource);
 
-        // Create GPU data buffer.
-        mpBRDFData = buffer.getGPUBuffer(mpDevice);
+            return pSharedData;
+        });
+        FALCOR_ASSERT(mpSharedData);
 
-        // Create albedo LUT as 2D texture parameterization over (cosTehta, brdfIndex).
-        mpAlbedoLUT = mpDevice->createTexture2D(MERLMixMaterialData::kAlbedoLUTSize, mData.brdfCount, MERLFile::kAlbedoLUTFormat, 1, 1, albedoLut.data(), ResourceBindFlags::ShaderResource);
+        mBRDFs = mpSharedData->brdfs;
+        mData.brdfCount = static_cast<uint32_t>(mBRDFs.size());
+        mData.byteStride = mpSharedData->byteStride;
+        mData.extraDataStride = (uint32_t)sizeof(DiffuseSpecularData);
+        mData.extraDataOffset = mpSharedData->extraDataOffset;
+        mpBRDFData = mpSharedData->pBRDFData;
+        mpAlbedoLUT = mpSharedData->pAlbedoLUT;
 
         // Create sampler for albedo LUT.
         {
@@ -235,6 +261,19 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMixMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        hashCombine(hash, mBRDFs.size());
+        for (const auto& brdf : mBRDFs)
+        {
+            hashCombine(hash, brdf.name);
+            hashCombine(hash, std::filesystem::hash_value(brdf.path));
+        }
+        hashCombine(hash, mpDefaultSampler->getDesc());
+        return hash;
+    }
+
     ProgramDesc::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
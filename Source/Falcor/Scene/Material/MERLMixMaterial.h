@@ -28,6 +28,7 @@
 #pragma once
 #include "Material.h"
 #include "MERLMixMaterialData.slang"
+#include <memory>
 
 namespace Falcor
 {
@@ -54,6 +55,7 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        size_t getHash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -67,6 +69,8 @@ namespace Falcor
         ref<Texture> getNormalMap() const { return getTexture(TextureSlot::Normal); }
 
     protected:
+        struct SharedData;
+
         void updateNormalMapType();
         void updateIndexMapType();
 
@@ -91,5 +95,6 @@ namespace Falcor
         ref<Sampler> mpLUTSampler;          ///< Sampler for accessing the LUT texture.
         ref<Sampler> mpIndexSampler;        ///< Sampler for accessing the index map.
         ref<Sampler> mpDefaultSampler;
+        std::shared_ptr<SharedData> mpSharedData; ///< BRDF data shared with other materials using the same BRDFs (see MeasuredBRDFRegistry).
     };
 }
@@ -168,7 +168,7 @@ namespace Falcor
     bool Material::hasTextureSlotData(const TextureSlot slot) const
     {
         FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
-        return mTextureSlotData[(size_t)slot].pTexture != nullptr;
+        return mTextureSlotData[(size_t)slot].hasData();
     }
 
     bool Material::setTexture(const TextureSlot slot, const ref<Texture>& pTexture)
@@ -179,10 +179,11 @@ namespace Falcor
             return false;
         }
 
-        if (pTexture == getTexture(slot)) return false;
+        if (pTexture == getTexture(slot) && getVirtualTexture(slot) == VirtualTextureManager::kInvalidID) return false;
 
         FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
         mTextureSlotData[(size_t)slot].pTexture = pTexture;
+        mTextureSlotData[(size_t)slot].virtualTextureID = VirtualTextureManager::kInvalidID;
 
         markUpdates(UpdateFlags::ResourcesChanged);
         if (slot == TextureSlot::Emissive)
@@ -199,6 +200,32 @@ namespace Falcor
         return mTextureSlotData[(size_t)slot].pTexture;
     }
 
+    bool Material::setVirtualTexture(const TextureSlot slot, uint32_t virtualTextureID)
+    {
+        if (!hasTextureSlot(slot) || slot == TextureSlot::Displacement || slot == TextureSlot::Emissive)
+        {
+            logWarning("Material '{}' does not support virtual textures in texture slot '{}'. Ignoring call to setVirtualTexture().", getName(), to_string(slot));
+            return false;
+        }
+
+        auto& slotData = mTextureSlotData[(size_t)slot];
+        if (slotData.virtualTextureID == virtualTextureID && !slotData.pTexture) return false;
+
+        slotData.pTexture = nullptr;
+        slotData.virtualTextureID = virtualTextureID;
+
+        markUpdates(UpdateFlags::ResourcesChanged);
+        return true;
+    }
+
+    uint32_t Material::getVirtualTexture(const TextureSlot slot) const
+    {
+        if (!hasTextureSlot(slot)) return VirtualTextureManager::kInvalidID;
+
+        FALCOR_ASSERT((size_t)slot < mTextureSlotInfo.size());
+        return mTextureSlotData[(size_t)slot].virtualTextureID;
+    }
+
     bool Material::loadTexture(TextureSlot slot, const std::filesystem::path& path, bool useSrgb)
     {
         if (!hasTextureSlot(slot))
@@ -280,7 +307,18 @@ namespace Falcor
     void Material::updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle)
     {
         auto pTexture = getTexture(slot);
-        updateTextureHandle(pOwner, pTexture, handle);
+        uint32_t virtualTextureID = getVirtualTexture(slot);
+        if (!pTexture && virtualTextureID != VirtualTextureManager::kInvalidID)
+        {
+            TextureHandle prevHandle = handle;
+            handle = TextureHandle();
+            handle.setVirtualTextureID(virtualTextureID);
+            if (handle != prevHandle) mUpdates |= Material::UpdateFlags::DataChanged;
+        }
+        else
+        {
+            updateTextureHandle(pOwner, pTexture, handle);
+        }
 
         // The base color texture potentially contains the alpha mask in it's alpha channel.
         // Set it as the alpha texture handle in the material header.
@@ -291,6 +329,18 @@ namespace Falcor
         }
     }
 
+    void Material::replaceTexture(const Texture* pOldTexture, const ref<Texture>& pNewTexture)
+    {
+        // Swap in a different version of the same texture (e.g. with evicted mips).
+        // Unlike setTexture() this doesn't reset any state derived from the texture contents.
+        for (auto& slotData : mTextureSlotData)
+        {
+            if (slotData.pTexture.get() != pOldTexture) continue;
+            slotData.pTexture = pNewTexture;
+            markUpdates(UpdateFlags::ResourcesChanged);
+        }
+    }
+
     void Material::updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler)
     {
         const uint32_t samplerID = pOwner->addTextureSampler(pSampler);
@@ -328,6 +378,49 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getBaseHash() const
+    {
+        // Hash the same data as isBaseEqual(). The name is not included.
+        size_t hash = 0;
+        hashCombine(hash, mHeader.packedData);
+        hashCombine(hash, mTextureTransform.getTranslation());
+        hashCombine(hash, mTextureTransform.getScaling());
+        hashCombine(hash, mTextureTransform.getRotation());
+
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            hashCombine(hash, hasTextureSlot(slot));
+            if (hasTextureSlot(slot))
+            {
+                hashCombine(hash, mTextureSlotInfo[i].name);
+                hashCombine(hash, mTextureSlotInfo[i].mask);
+                hashCombine(hash, mTextureSlotInfo[i].srgb);
+                hashCombine(hash, mTextureSlotData[i].pTexture.get());
+                hashCombine(hash, mTextureSlotData[i].virtualTextureID);
+            }
+        }
+
+        return hash;
+    }
+
+    void Material::hashCombine(size_t& hash, const Sampler::Desc& desc)
+    {
+        hashCombine(hash, desc.magFilter);
+        hashCombine(hash, desc.minFilter);
+        hashCombine(hash, desc.mipFilter);
+        hashCombine(hash, desc.maxAnisotropy);
+        hashCombine(hash, desc.maxLod);
+        hashCombine(hash, desc.minLod);
+        hashCombine(hash, desc.lodBias);
+        hashCombine(hash, desc.comparisonFunc);
+        hashCombine(hash, desc.reductionMode);
+        hashCombine(hash, desc.addressModeU);
+        hashCombine(hash, desc.addressModeV);
+        hashCombine(hash, desc.addressModeW);
+        hashCombine(hash, desc.borderColor);
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
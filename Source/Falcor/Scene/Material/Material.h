@@ -38,6 +38,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/VirtualTextureManager.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -101,9 +102,10 @@ namespace Falcor
         struct TextureSlotData
         {
             ref<Texture>  pTexture;                           ///< Texture bound to texture slot.
+            uint32_t virtualTextureID = VirtualTextureManager::kInvalidID; ///< Virtual texture bound to texture slot. Only used if no texture is bound.
 
-            bool hasData() const { return pTexture != nullptr; }
-            bool operator==(const TextureSlotData& rhs) const { return pTexture == rhs.pTexture; }
+            bool hasData() const { return pTexture != nullptr || virtualTextureID != VirtualTextureManager::kInvalidID; }
+            bool operator==(const TextureSlotData& rhs) const { return pTexture == rhs.pTexture && virtualTextureID == rhs.virtualTextureID; }
             bool operator!=(const TextureSlotData& rhs) const { return !((*this) == rhs); }
         };
 
@@ -163,6 +165,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties compared by isEqual().
+            Materials that compare equal are guaranteed to have the same hash. The hash is only stable within a run,
+            as it includes the texture pointers.
+            \return Hash value.
+        */
+        virtual size_t getHash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -257,6 +266,21 @@ namespace Falcor
         */
         virtual ref<Texture> getTexture(const TextureSlot slot) const;
 
+        /** Bind a virtual texture to one of the available texture slots.
+            Virtual textures are streamed by the VirtualTextureManager of the material system. Any texture bound to the slot is cleared.
+            The displacement and emissive slots don't support virtual textures.
+            \param[in] slot The texture slot.
+            \param[in] virtualTextureID Virtual texture ID returned by VirtualTextureManager::addTexture().
+            \return True if the texture slot was changed, false otherwise.
+        */
+        virtual bool setVirtualTexture(const TextureSlot slot, uint32_t virtualTextureID);
+
+        /** Get the virtual texture bound to a texture slot.
+            \param[in] slot The texture slot.
+            \return Virtual texture ID, or VirtualTextureManager::kInvalidID if none is bound.
+        */
+        uint32_t getVirtualTexture(const TextureSlot slot) const;
+
         /** Optimize texture usage for the given texture slot.
             This function may replace constant textures by uniform material parameters etc.
             \param[in] slot The texture slot.
@@ -353,7 +377,19 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const ref<Texture>& pTexture, TextureHandle& handle);
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
+        void replaceTexture(const Texture* pOldTexture, const ref<Texture>& pNewTexture);
         bool isBaseEqual(const Material& other) const;
+        size_t getBaseHash() const;
+
+        /** Combine a value into a hash. Floating-point values equal to zero hash the same regardless of sign.
+        */
+        template<typename T>
+        static void hashCombine(size_t& hash, const T& value)
+        {
+            hash ^= std::hash<T>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+
+        static void hashCombine(size_t& hash, const Sampler::Desc& desc);
 
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
@@ -30,8 +30,14 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/NumericRange.h"
 #include "MaterialTypeRegistry.h"
+#include "MeasuredBRDFRegistry.h"
+#include <algorithm>
+#include <cstring>
+#include <execution>
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -48,6 +54,10 @@ namespace Falcor
         const size_t kMaxTextureCount = 1ull << TextureHandle::kTextureIDBits;
         const size_t kMaxBufferCountPerMaterial = 1; // This is a conservative estimation of how many buffer descriptors to allocate per material. Most materials don't use any auxiliary data buffers.
 
+        const size_t kStagingSegmentSize = 1 << 20; // Size in bytes of a segment of the material data staging buffer.
+        const uint32_t kStagingSegmentCount = Device::kInFlightFrameCount; // Number of staging segments.
+        const uint32_t kMaxUploadRangeGap = 4; // Max number of unchanged materials between dirty materials that are merged into a single upload range.
+
         // Helper to check if a material is a standard material using the SpecGloss shading model.
         // We keep track of these as an optimization because most scenes do not use this shading model.
         bool isSpecGloss(const ref<Material>& pMaterial)
@@ -66,7 +76,9 @@ namespace Falcor
         FALCOR_ASSERT(kMaxSamplerCount <= mpDevice->getLimits().maxShaderVisibleSamplers);
 
         mpFence = mpDevice->createFence();
+        mStagingFenceValues.resize(kStagingSegmentCount, 0);
         mpTextureManager = std::make_unique<TextureManager>(mpDevice, kMaxTextureCount);
+        mpVirtualTextureManager = std::make_unique<VirtualTextureManager>(mpDevice);
 
         // Create a default texture sampler.
         Sampler::Desc desc;
@@ -81,10 +93,13 @@ namespace Falcor
             const auto& pMaterial = mMaterials[materialID];
             if (auto materialGroup = widget.group(label))
             {
-                if (pMaterial->renderUI(materialGroup)) uploadMaterial(materialID);
+                if (pMaterial->renderUI(materialGroup)) mDirtyMaterialIDs.push_back(materialID);
             }
         };
 
+        widget.text(fmt::format("Uploaded {} materials in {} ranges ({}) last update, {} total",
+            mUploadStats.materialCount, mUploadStats.rangeCount, formatByteSize(mUploadStats.bytesUploaded), formatByteSize(mUploadStats.totalBytesUploaded)));
+
         widget.checkbox("Sort by name", mSortMaterialsByName);
         if (mSortMaterialsByName)
         {
@@ -336,20 +351,30 @@ namespace Falcor
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
-        // Find unique set of materials.
+        // Compute material hashes in parallel.
+        std::vector<size_t> hashes(mMaterials.size());
+        NumericRange<size_t> range(0, mMaterials.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { hashes[i] = mMaterials[i]->getHash(); });
+
+        // Find unique set of materials. Only unique materials with the same hash need to be compared.
+        // The candidates are stored in order, so the first matching unique material is picked as before.
+        std::unordered_map<size_t, std::vector<uint32_t>> uniqueByHash;
+        uniqueByHash.reserve(mMaterials.size());
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& candidates = uniqueByHash[hashes[id.get()]];
+            auto it = std::find_if(candidates.begin(), candidates.end(), [&](uint32_t index) { return uniqueMaterials[index]->isEqual(pMaterial); });
+            if (it == candidates.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                candidates.push_back((uint32_t)uniqueMaterials.size());
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[*it]->getName());
+                idMap[id.get()] = MaterialID{ *it };
             }
         }
 
@@ -387,26 +412,52 @@ namespace Falcor
 
         if (textures.empty()) return;
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
+        // Use the results of the CPU analysis done by the texture cache while loading where available.
+        // Only the remaining textures are analyzed on the GPU, which avoids the GPU readback if all textures were analyzed on load.
+        const TextureCache& textureCache = mpTextureManager->getTextureCache();
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<ref<Texture>> gpuTextures;
+        std::vector<size_t> gpuIndices;
 
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (auto result = textureCache.getAnalysisResult(*textures[i]))
+            {
+                results[i] = *result;
+            }
+            else
+            {
+                gpuTextures.push_back(textures[i]);
+                gpuIndices.push_back(i);
+            }
+        }
+
+        logInfo("Analyzing {} material textures ({} analyzed on load).", textures.size(), textures.size() - gpuTextures.size());
 
-        TextureAnalyzer analyzer(mpDevice);
-        auto pResults = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        analyzer.analyze(pRenderContext, textures, pResults);
-
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->submit(false);
-        pRenderContext->signal(mpFence.get());
-
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->wait();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+        if (!gpuTextures.empty())
+        {
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
+
+            TextureAnalyzer analyzer(mpDevice);
+            auto pResults = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            analyzer.analyze(pRenderContext, gpuTextures, pResults);
+
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->submit(false);
+            pRenderContext->signal(mpFence.get());
+
+            // Wait for results to become available.
+            mpFence->wait();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+            for (size_t i = 0; i < gpuIndices.size(); i++) results[gpuIndices[i]] = gpuResults[i];
+            pResultsStaging->unmap();
+        }
+
+        // Optimize the materials.
         Material::TextureOptimizationStats stats = {};
 
         for (size_t i = 0; i < textures.size(); i++)
@@ -414,8 +465,6 @@ namespace Falcor
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
@@ -433,6 +482,14 @@ namespace Falcor
 
     Material::UpdateFlags MaterialSystem::update(bool forceUpdate)
     {
+        // Virtual textures are compiled out of the shaders until the first one is added.
+        // Enabling them changes the defines, so the parameter block needs to be re-created.
+        if (bool virtualTexturesEnabled = mpVirtualTextureManager->getTextureCount() > 0; virtualTexturesEnabled != mVirtualTexturesEnabled)
+        {
+            mVirtualTexturesEnabled = virtualTexturesEnabled;
+            mMaterialsChanged = true;
+        }
+
         // If materials were added/removed since last update, we update all metadata
         // and trigger re-creation of the parameter block and update of all materials.
         if (forceUpdate || mMaterialsChanged)
@@ -445,6 +502,9 @@ namespace Falcor
             forceUpdate = true;
         }
 
+        // Enforce the texture memory budget before updating the materials, as it may replace textures.
+        updateTextureResidency();
+
         // Update all materials.
         // Do either a full update of all materials with deferred texture loading, or an update of just the dynamic materials.
         // We track per-material update flags along with the combined update flags across all materials.
@@ -496,15 +556,15 @@ namespace Falcor
         }
 
         // Upload all modified materials.
-        if (forceUpdate || is_set(updateFlags, Material::UpdateFlags::DataChanged))
+        // On a forced update, the data of all materials is compared to the data already on the GPU, so that only
+        // materials that actually changed are uploaded. All data is uploaded if the GPU buffer holds no valid data.
+        mUploadStats.materialCount = 0;
+        mUploadStats.rangeCount = 0;
+        mUploadStats.bytesUploaded = 0;
+        mUploadStats.fullUpload = false;
+        if (forceUpdate || is_set(updateFlags, Material::UpdateFlags::DataChanged) || !mDirtyMaterialIDs.empty())
         {
-            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
-            {
-                if (forceUpdate || is_set(mMaterialsUpdateFlags[materialID], Material::UpdateFlags::DataChanged))
-                {
-                    uploadMaterial(materialID);
-                }
-            }
+            uploadMaterials(forceUpdate);
         }
 
         auto blockVar = mpMaterialsBlock->getRootVar();
@@ -528,6 +588,13 @@ namespace Falcor
                 blockVar["udimIndirection"]);
         }
 
+        // Stream in virtual texture tiles requested in previous frames.
+        if (mVirtualTexturesEnabled)
+        {
+            bool resourcesChanged = mpVirtualTextureManager->update(mpDevice->getRenderContext());
+            if (forceUpdate || resourcesChanged) mpVirtualTextureManager->bindShaderData(blockVar["virtualTextures"]);
+        }
+
         // Update buffers.
         if (forceUpdate || mBuffersChanged)
         {
@@ -613,6 +680,28 @@ namespace Falcor
         FALCOR_CHECK(mMaterialTypes.find(MaterialType::Unknown) == mMaterialTypes.end(), "Unknown material type found. Make sure all material types are registered.");
     }
 
+    void MaterialSystem::markMaterialUsed(const MaterialID materialID)
+    {
+        const auto& pMaterial = getMaterial(materialID);
+        for (uint32_t slot = 0; slot < (uint32_t)Material::TextureSlot::Count; slot++)
+        {
+            if (auto pTexture = pMaterial->getTexture((Material::TextureSlot)slot)) mpTextureManager->markTextureUsed(pTexture.get());
+        }
+    }
+
+    void MaterialSystem::updateTextureResidency()
+    {
+        auto replacements = mpTextureManager->updateResidency();
+        if (replacements.empty()) return;
+
+        // Switch all materials over to the replaced textures, so that the old textures are released.
+        // The texture handles are unchanged, so only the texture bindings need to be updated.
+        for (const auto& replacement : replacements)
+        {
+            for (const auto& pMaterial : mMaterials) pMaterial->replaceTexture(replacement.pOldTexture.get(), replacement.pNewTexture);
+        }
+    }
+
     MaterialSystem::MaterialStats MaterialSystem::getStats() const
     {
         FALCOR_CHECK(!mMaterialsChanged, "Materials have changed. Call update() first.");
@@ -636,6 +725,17 @@ namespace Falcor
         s.textureTexelChannelCount = textureStats.textureTexelChannelCount;
         s.textureMemoryInBytes = textureStats.textureMemoryInBytes;
 
+        const auto virtualTextureStats = mpVirtualTextureManager->getStats();
+        s.virtualTextureCount = virtualTextureStats.textureCount;
+        s.virtualTextureResidentTileCount = virtualTextureStats.residentTileCount;
+        s.virtualTextureMemoryInBytes = virtualTextureStats.atlasMemoryInBytes + virtualTextureStats.pageTableMemoryInBytes;
+
+        const auto measuredBRDFStats = MeasuredBRDFRegistry::getStats(mpDevice.get());
+        s.measuredBRDFCount = measuredBRDFStats.brdfCount;
+        s.measuredBRDFReferenceCount = measuredBRDFStats.referenceCount;
+        s.measuredBRDFMemoryInBytes = measuredBRDFStats.memoryInBytes;
+        s.measuredBRDFMemorySavedInBytes = measuredBRDFStats.memorySavedInBytes;
+
         return s;
     }
 
@@ -652,6 +752,7 @@ namespace Falcor
         defines.add("MATERIAL_SYSTEM_BUFFER_DESC_COUNT", std::to_string(mBufferDescCount));
         defines.add("MATERIAL_SYSTEM_TEXTURE_3D_DESC_COUNT", std::to_string(mTexture3DDescCount));
         defines.add("MATERIAL_SYSTEM_UDIM_INDIRECTION_ENABLED", mpTextureManager->getUdimIndirectionCount() > 0 ? "1" : "0");
+        defines.add("MATERIAL_SYSTEM_VIRTUAL_TEXTURES_ENABLED", mVirtualTexturesEnabled ? "1" : "0");
         defines.add("MATERIAL_SYSTEM_HAS_SPEC_GLOSS_MATERIALS", mHasSpecGlossStandardMaterial ? "1" : "0");
         defines.add("FALCOR_MATERIAL_INSTANCE_SIZE", std::to_string(materialInstanceByteSize));
 
@@ -739,11 +840,27 @@ namespace Falcor
 
         auto blockVar = mpMaterialsBlock->getRootVar();
 
-        // Create materials data buffer.
+        // Create materials data buffer. The buffer grows geometrically and the data of the existing materials is copied
+        // to the new buffer, so that adding materials only uploads the new ones.
         if (!mMaterials.empty() && (!mpMaterialDataBuffer || mpMaterialDataBuffer->getElementCount() < mMaterials.size()))
         {
-            mpMaterialDataBuffer = mpDevice->createStructuredBuffer(blockVar[kMaterialDataName], (uint32_t)mMaterials.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            uint32_t elementCount = (uint32_t)mMaterials.size();
+            if (mpMaterialDataBuffer) elementCount = std::max(elementCount, 2 * mpMaterialDataBuffer->getElementCount());
+
+            auto pPrevBuffer = mpMaterialDataBuffer;
+            mpMaterialDataBuffer = mpDevice->createStructuredBuffer(blockVar[kMaterialDataName], elementCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
             mpMaterialDataBuffer->setName("MaterialSystem::mpMaterialDataBuffer");
+
+            if (pPrevBuffer && !mMaterialDataBlobs.empty())
+            {
+                const uint32_t validCount = std::min((uint32_t)mMaterialDataBlobs.size(), pPrevBuffer->getElementCount());
+                mMaterialDataBlobs.resize(validCount);
+                mpDevice->getRenderContext()->copyBufferRegion(mpMaterialDataBuffer.get(), 0, pPrevBuffer.get(), 0, validCount * sizeof(MaterialDataBlob));
+            }
+            else
+            {
+                mMaterialDataBlobs.clear();
+            }
         }
 
         // Bind resources to parameter block.
@@ -751,15 +868,146 @@ namespace Falcor
         blockVar["materialCount"] = getMaterialCount();
     }
 
-    void MaterialSystem::uploadMaterial(const uint32_t materialID)
+    void MaterialSystem::uploadMaterials(bool checkAll)
     {
-        FALCOR_ASSERT(materialID < mMaterials.size());
-        const auto& pMaterial = mMaterials[materialID];
-        FALCOR_ASSERT(pMaterial);
+        const uint32_t materialCount = (uint32_t)mMaterials.size();
+        if (materialCount == 0)
+        {
+            mDirtyMaterialIDs.clear();
+            return;
+        }
+        FALCOR_ASSERT(mpMaterialDataBuffer && mpMaterialDataBuffer->getElementCount() >= materialCount);
+
+        // The GPU buffer holds no valid data after it was created.
+        if (mMaterialDataBlobs.empty())
+        {
+            // Gather the data of all materials and upload it in one go.
+            mMaterialDataBlobs.resize(materialCount);
+            NumericRange<uint32_t> range(0, materialCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i) { mMaterialDataBlobs[i] = mMaterials[i]->getDataBlob(); });
+            mpMaterialDataBuffer->setBlob(mMaterialDataBlobs.data(), 0, materialCount * sizeof(MaterialDataBlob));
+
+            mUploadStats.materialCount = materialCount;
+            mUploadStats.rangeCount = 1;
+            mUploadStats.bytesUploaded = materialCount * sizeof(MaterialDataBlob);
+            mUploadStats.fullUpload = true;
+            mUploadStats.totalBytesUploaded += mUploadStats.bytesUploaded;
+            mDirtyMaterialIDs.clear();
+            return;
+        }
+
+        // Mark materials whose data differs from the data on the GPU as dirty.
+        // Materials added since the last upload are always dirty.
+        const uint32_t prevCount = std::min(materialCount, (uint32_t)mMaterialDataBlobs.size());
+        mMaterialDataBlobs.resize(materialCount);
+        std::vector<uint8_t> dirty(materialCount, 0);
+        auto checkMaterial = [&](uint32_t i)
+        {
+            MaterialDataBlob blob = mMaterials[i]->getDataBlob();
+            if (i >= prevCount || std::memcmp(&blob, &mMaterialDataBlobs[i], sizeof(MaterialDataBlob)) != 0)
+            {
+                mMaterialDataBlobs[i] = blob;
+                dirty[i] = 1;
+            }
+        };
+
+        if (checkAll)
+        {
+            NumericRange<uint32_t> range(0, materialCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), checkMaterial);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < materialCount; ++i)
+            {
+                if (is_set(mMaterialsUpdateFlags[i], Material::UpdateFlags::DataChanged)) checkMaterial(i);
+            }
+            for (uint32_t i : mDirtyMaterialIDs)
+            {
+                if (i < materialCount && !dirty[i]) checkMaterial(i);
+            }
+            for (uint32_t i = prevCount; i < materialCount; ++i)
+            {
+                if (!dirty[i]) checkMaterial(i);
+            }
+        }
+        mDirtyMaterialIDs.clear();
 
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
-        FALCOR_ASSERT(mpMaterialDataBuffer);
-        mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
+        // Coalesce dirty materials into ranges and copy them via the staging buffer.
+        uint32_t beginID = 0;
+        while (beginID < materialCount)
+        {
+            if (!dirty[beginID])
+            {
+                beginID++;
+                continue;
+            }
+
+            // Extend the range over small gaps of unchanged materials, as one larger copy is cheaper than several small ones.
+            uint32_t endID = beginID + 1;
+            for (uint32_t i = endID; i < materialCount && i <= endID + kMaxUploadRangeGap; ++i)
+            {
+                if (dirty[i]) endID = i + 1;
+            }
+
+            stageMaterialData(beginID, endID);
+            mUploadStats.materialCount += endID - beginID;
+            mUploadStats.rangeCount++;
+            mUploadStats.bytesUploaded += (endID - beginID) * sizeof(MaterialDataBlob);
+            beginID = endID;
+        }
+        flushStagingSegment();
+
+        mUploadStats.totalBytesUploaded += mUploadStats.bytesUploaded;
+    }
+
+    void MaterialSystem::stageMaterialData(uint32_t beginID, uint32_t endID)
+    {
+        if (!mpStagingBuffer)
+        {
+            mpStagingBuffer = mpDevice->createBuffer(kStagingSegmentSize * kStagingSegmentCount, ResourceBindFlags::None, MemoryType::Upload, nullptr);
+            mpStagingBuffer->setName("MaterialSystem::mpStagingBuffer");
+        }
+
+        // The staging buffer is kept mapped for the lifetime of the material system.
+        uint8_t* pStagingData = static_cast<uint8_t*>(mpStagingBuffer->map());
+
+        while (beginID < endID)
+        {
+            const uint32_t capacity = (uint32_t)((kStagingSegmentSize - mStagingOffset) / sizeof(MaterialDataBlob));
+            if (capacity == 0)
+            {
+                flushStagingSegment();
+                continue;
+            }
+
+            const uint32_t count = std::min(endID - beginID, capacity);
+            const size_t srcOffset = mStagingSegment * kStagingSegmentSize + mStagingOffset;
+            const size_t byteSize = count * sizeof(MaterialDataBlob);
+            std::memcpy(pStagingData + srcOffset, &mMaterialDataBlobs[beginID], byteSize);
+            mpDevice->getRenderContext()->copyBufferRegion(mpMaterialDataBuffer.get(), beginID * sizeof(MaterialDataBlob), mpStagingBuffer.get(), srcOffset, byteSize);
+
+            mStagingOffset += byteSize;
+            beginID += count;
+        }
+    }
+
+    void MaterialSystem::flushStagingSegment()
+    {
+        if (mStagingOffset == 0) return;
+
+        // The copies are submitted with the rest of the frame, after which the render context fence reaches its next signaled value.
+        // Move on to the next segment.
+        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        Fence* pFence = pRenderContext->getLowLevelData()->getFence().get();
+        mStagingFenceValues[mStagingSegment] = pFence->getSignaledValue() + 1;
+        mStagingSegment = (mStagingSegment + 1) % kStagingSegmentCount;
+        mStagingOffset = 0;
+
+        // Wait for the copies from the next segment to finish before it is overwritten. This only stalls if more than one segment
+        // is uploaded per frame. If all segments were filled in the current frame, its copies have to be submitted first.
+        const uint64_t fenceValue = mStagingFenceValues[mStagingSegment];
+        if (fenceValue > pFence->getSignaledValue()) pRenderContext->submit(false);
+        pFence->wait(fenceValue);
     }
 }
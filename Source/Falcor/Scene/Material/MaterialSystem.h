@@ -35,6 +35,7 @@
 #include "Core/Program/DefineList.h"
 #include "Core/Program/Program.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Image/VirtualTextureManager.h"
 #include "Utils/UI/Gui.h"
 #include <memory>
 #include <vector>
@@ -68,6 +69,24 @@ namespace Falcor
             uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
             uint64_t textureTexelChannelCount = 0;      ///< Total number of texel channels in all textures.
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
+            uint64_t virtualTextureCount = 0;           ///< Number of virtual textures.
+            uint64_t virtualTextureResidentTileCount = 0; ///< Number of virtual texture tiles resident on the GPU.
+            uint64_t virtualTextureMemoryInBytes = 0;   ///< Total memory in bytes used by the virtual texture atlases and page table.
+            uint64_t measuredBRDFCount = 0;             ///< Number of measured BRDF data sets loaded on the device (see MeasuredBRDFRegistry). This is process-wide, not per scene.
+            uint64_t measuredBRDFReferenceCount = 0;    ///< Number of materials referencing the measured BRDF data sets.
+            uint64_t measuredBRDFMemoryInBytes = 0;     ///< Total memory in bytes used by the measured BRDF data sets.
+            uint64_t measuredBRDFMemorySavedInBytes = 0; ///< Memory in bytes saved by sharing measured BRDF data between materials.
+        };
+
+        /** Material data upload counters.
+        */
+        struct UploadStats
+        {
+            uint64_t materialCount = 0;                 ///< Number of materials uploaded in the last update.
+            uint64_t rangeCount = 0;                    ///< Number of contiguous material ID ranges uploaded in the last update.
+            uint64_t bytesUploaded = 0;                 ///< Number of bytes uploaded in the last update.
+            bool fullUpload = false;                    ///< True if all material data was uploaded in the last update.
+            uint64_t totalBytesUploaded = 0;            ///< Total number of bytes uploaded since creation.
         };
 
         /** Constructor. Throws an exception if creation failed.
@@ -246,22 +265,40 @@ namespace Falcor
         */
         MaterialStats getStats() const;
 
+        /** Get the material data upload counters of the last update.
+        */
+        const UploadStats& getUploadStats() const { return mUploadStats; }
+
         /** Get texture manager. This holds all textures.
         */
         TextureManager& getTextureManager() { return *mpTextureManager; }
 
+        /** Get virtual texture manager. This holds all virtual textures, see Material::setVirtualTexture().
+        */
+        VirtualTextureManager& getVirtualTextureManager() { return *mpVirtualTextureManager; }
+
+        /** Mark the textures of a material as used in the current frame.
+            This feeds the texture residency tracking, see TextureManager::setResidencyOptions().
+            \param[in] materialID The material ID.
+        */
+        void markMaterialUsed(const MaterialID materialID);
+
 
     private:
         void updateMetadata();
         void updateUI();
         void createParameterBlock();
-        void uploadMaterial(const uint32_t materialID);
+        void uploadMaterials(bool checkAll);
+        void stageMaterialData(uint32_t beginID, uint32_t endID);
+        void flushStagingSegment();
+        void updateTextureResidency();
 
         ref<Device> mpDevice;
 
         std::vector<ref<Material>> mMaterials;                      ///< List of all materials.
         std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
         std::unique_ptr<TextureManager> mpTextureManager;           ///< Texture manager holding all material textures.
+        std::unique_ptr<VirtualTextureManager> mpVirtualTextureManager; ///< Virtual texture manager streaming tiles of virtual textures.
         ProgramDesc::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
         std::map<MaterialType, TypeConformanceList> mTypeConformances; ///< Type conformances for each material type in use.
 
@@ -282,13 +319,21 @@ namespace Falcor
         bool mBuffersChanged = false;                               ///< Flag indicating if buffers were added/removed since last update.
         bool mTextures3DChanged = false;                            ///< Flag indicating if 3D textures were added/removed since last update.
         bool mMaterialsChanged = false;                             ///< Flag indicating if materials were added/removed since last update. Per-material updates are tracked by each material's update flags.
+        bool mVirtualTexturesEnabled = false;                       ///< Flag indicating if virtual textures are bound to the parameter block.
 
         Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
 
         // GPU resources
         ref<Fence> mpFence;
         ref<ParameterBlock> mpMaterialsBlock;                       ///< Parameter block for binding all material resources.
-        ref<Buffer> mpMaterialDataBuffer;                           ///< GPU buffer holding all material data.
+        ref<Buffer> mpMaterialDataBuffer;                           ///< GPU buffer holding all material data. May have room for more materials.
+        ref<Buffer> mpStagingBuffer;                                ///< Persistently mapped upload buffer for incremental material data uploads. Split into segments that are reused in round-robin order.
+        std::vector<uint64_t> mStagingFenceValues;                  ///< Render context fence value to wait for before reusing each staging segment.
+        uint32_t mStagingSegment = 0;                               ///< Staging segment currently written to.
+        size_t mStagingOffset = 0;                                  ///< Offset in bytes in the current staging segment.
+        std::vector<MaterialDataBlob> mMaterialDataBlobs;           ///< Copy of the material data in the GPU buffer. Empty if the GPU buffer holds no valid data.
+        std::vector<uint32_t> mDirtyMaterialIDs;                    ///< Materials that need to be uploaded in addition to the ones reporting data changes.
+        UploadStats mUploadStats;
         ref<Sampler> mpDefaultTextureSampler;                       ///< Default texture sampler to use for all materials.
         std::vector<ref<Sampler>> mTextureSamplers;                 ///< Texture sampler states. These are indexed by ID in the materials.
         std::vector<ref<Buffer>> mBuffers;                          ///< Buffers used by the materials. These are indexed by ID in the materials.
@@ -50,7 +50,20 @@ namespace Falcor
             return;
         }
 
-        bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
+        const auto& slotInfo = pMaterial->getTextureSlotInfo(slot);
+        bool srgb = mUseSrgb && slotInfo.srgb;
+
+        // The alpha channel of the base color is used for alpha testing. Keep the alpha test coverage of the mips
+        // constant, so that alpha tested geometry doesn't thin out with distance. Whether the material is alpha tested
+        // depends on the texture, which is not loaded yet. The mips of textures without texels failing the alpha test
+        // are left unchanged, see MipGenerator::Options.
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None;
+        float alphaCutoff = 0.5f;
+        if (slot == Material::TextureSlot::BaseColor && slotInfo.hasChannel(TextureChannelFlags::Alpha))
+        {
+            importFlags |= Bitmap::ImportFlags::PreserveAlphaCoverage;
+            alphaCutoff = pMaterial->getAlphaThreshold();
+        }
 
         // Request texture to be loaded.
         auto handle = mTextureManager.loadTexture(
@@ -59,10 +72,11 @@ namespace Falcor
             srgb,
             ResourceBindFlags::ShaderResource,
             true /*async*/,
-            Bitmap::ImportFlags::None,
+            importFlags,
             nullptr /*search dirs*/,
             nullptr /*load count*/,
-            pMaterial.get()
+            pMaterial.get(),
+            alphaCutoff
         );
 
         // Store assignment to material for later.
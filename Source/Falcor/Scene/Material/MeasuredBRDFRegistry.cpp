@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeasuredBRDFRegistry.h"
+#include "Utils/SharedCache.h"
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Key = std::pair<Device*, std::string>;
+
+        /** Build the cache key. Paths are made canonical so that different spellings of the same path share data.
+            The modification times are included so that edited files are not shared with data loaded before the edit.
+        */
+        Key makeKey(Device* pDevice, std::string_view type, const std::vector<std::filesystem::path>& paths)
+        {
+            std::string key(type);
+            for (const auto& path : paths)
+            {
+                std::error_code pathError, timeError;
+                auto canonicalPath = std::filesystem::weakly_canonical(path, pathError);
+                auto writeTime = std::filesystem::last_write_time(path, timeError);
+                key += '\n';
+                key += (pathError ? path : canonicalPath).string();
+                key += '|';
+                key += std::to_string(timeError ? 0 : writeTime.time_since_epoch().count());
+            }
+            return {pDevice, std::move(key)};
+        }
+
+        struct Registry
+        {
+            SharedCache<MeasuredBRDFRegistry::Data, Key> cache;
+
+            // Live data objects for statistics. This is kept separately from the cache, because the cache is
+            // locked while data is created, and creating data may query statistics (e.g. by updating a scene).
+            std::mutex mutex;
+            std::vector<std::weak_ptr<MeasuredBRDFRegistry::Data>> entries;
+        };
+
+        Registry& getRegistry()
+        {
+            static Registry sRegistry;
+            return sRegistry;
+        }
+    }
+
+    std::shared_ptr<MeasuredBRDFRegistry::Data> MeasuredBRDFRegistry::acquireData(Device* pDevice, std::string_view type, const std::vector<std::filesystem::path>& paths, const std::function<std::shared_ptr<Data>()>& init)
+    {
+        Registry& registry = getRegistry();
+        // Note: Entries for which `init` failed hold an expired pointer. SharedCache retries loading them on the next acquire.
+        return registry.cache.acquire(makeKey(pDevice, type, paths), [&]()
+        {
+            auto pData = init();
+            if (pData)
+            {
+                pData->mpDevice = pDevice;
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.entries.erase(std::remove_if(registry.entries.begin(), registry.entries.end(), [](const auto& entry) { return entry.expired(); }), registry.entries.end());
+                registry.entries.push_back(pData);
+            }
+            return pData;
+        });
+    }
+
+    MeasuredBRDFRegistry::Stats MeasuredBRDFRegistry::getStats(Device* pDevice)
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        Stats stats;
+        for (const auto& entry : registry.entries)
+        {
+            // The use count includes the reference held while computing the stats.
+            auto pData = entry.lock();
+            if (!pData || pData->mpDevice != pDevice) continue;
+
+            const uint64_t referenceCount = (uint64_t)pData.use_count() - 1;
+            const uint64_t memoryInBytes = pData->getMemoryInBytes();
+            stats.brdfCount++;
+            stats.referenceCount += referenceCount;
+            stats.memoryInBytes += memoryInBytes;
+            stats.memorySavedInBytes += (referenceCount > 1 ? referenceCount - 1 : 0) * memoryInBytes;
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Process-wide registry of measured BRDF data (MERL, MERLMix, RGL).
+
+        Measured materials store their decoded measurement tables and GPU resources in a data
+        object acquired from the registry. Materials referencing the same BRDF files on the same
+        device share a single data object, instead of each loading and uploading their own copy.
+
+        The registry is built on SharedCache and only holds weak references, so the data is released
+        when the last material using it is destroyed. Entries are keyed by the device, the material
+        type and the canonical paths and modification times of the BRDF files, so edited files are
+        loaded again once the old data is released.
+    */
+    class FALCOR_API MeasuredBRDFRegistry
+    {
+    public:
+        /** Base class for shared BRDF data.
+        */
+        struct Data
+        {
+            virtual ~Data() = default;
+
+            /** Get the GPU memory used by the data in bytes.
+            */
+            virtual uint64_t getMemoryInBytes() const = 0;
+
+        private:
+            Device* mpDevice = nullptr;
+            friend class MeasuredBRDFRegistry;
+        };
+
+        struct Stats
+        {
+            uint64_t brdfCount = 0;             ///< Number of loaded BRDF data objects.
+            uint64_t referenceCount = 0;        ///< Number of references to the data objects held by materials.
+            uint64_t memoryInBytes = 0;         ///< GPU memory used by the data objects in bytes.
+            uint64_t memorySavedInBytes = 0;    ///< GPU memory saved by sharing in bytes, compared to one copy per reference.
+        };
+
+        /** Acquire shared BRDF data.
+            If there is no live data object for the given key, a new one is created by calling `init`.
+            \param[in] pDevice The device the GPU resources are created on.
+            \param[in] type Material type, used to distinguish data loaded from the same files by different materials.
+            \param[in] paths Paths to the BRDF files the data is loaded from.
+            \param[in] init Function creating the data object. It may return nullptr on error.
+            \return The shared data object, or nullptr if `init` failed.
+        */
+        template<typename T>
+        static std::shared_ptr<T> acquire(Device* pDevice, std::string_view type, const std::vector<std::filesystem::path>& paths, const std::function<std::shared_ptr<T>()>& init)
+        {
+            static_assert(std::is_base_of_v<Data, T>, "T must derive from MeasuredBRDFRegistry::Data");
+            return std::static_pointer_cast<T>(acquireData(pDevice, type, paths, [&]() -> std::shared_ptr<Data> { return init(); }));
+        }
+
+        /** Get statistics for the live data objects on a device.
+        */
+        static Stats getStats(Device* pDevice);
+
+    private:
+        static std::shared_ptr<Data> acquireData(Device* pDevice, std::string_view type, const std::vector<std::filesystem::path>& paths, const std::function<std::shared_ptr<Data>()>& init);
+    };
+}
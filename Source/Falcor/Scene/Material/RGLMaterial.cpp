@@ -28,6 +28,8 @@
 #include "RGLMaterial.h"
 #include "RGLFile.h"
 #include "RGLCommon.h"
+#include "AlbedoLUTCache.h"
+#include "MeasuredBRDFRegistry.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/Image/ImageIO.h"
@@ -35,6 +37,7 @@
 #include "GlobalState.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
 #include <fstream>
+#include <mutex>
 
 namespace Falcor
 {
@@ -50,16 +53,40 @@ namespace Falcor
         const std::string kLoadFile = "load";
     }
 
+    struct RGLMaterial::SharedData : MeasuredBRDFRegistry::Data
+    {
+        std::string name;
+        std::string description;
+        RGLMaterialData data;               ///< Material parameters. Only the table sizes are set.
+        ref<Buffer> pThetaBuf;
+        ref<Buffer> pPhiBuf;
+        ref<Buffer> pSigmaBuf;
+        ref<Buffer> pNDFBuf;
+        ref<Buffer> pVNDFBuf;
+        ref<Buffer> pLumiBuf;
+        ref<Buffer> pRGBBuf;
+        ref<Buffer> pVNDFMarginalBuf;
+        ref<Buffer> pLumiMarginalBuf;
+        ref<Buffer> pVNDFConditionalBuf;
+        ref<Buffer> pLumiConditionalBuf;
+
+        std::mutex albedoLUTMutex;
+        ref<Texture> pAlbedoLUT;            ///< Albedo lookup table. Prepared by the first material using the data.
+
+        uint64_t getMemoryInBytes() const override
+        {
+            uint64_t size = 0;
+            for (const auto& pBuffer : { pThetaBuf, pPhiBuf, pSigmaBuf, pNDFBuf, pVNDFBuf, pLumiBuf, pRGBBuf, pVNDFMarginalBuf, pLumiMarginalBuf, pVNDFConditionalBuf, pLumiConditionalBuf })
+                size += pBuffer->getSize();
+            return size + (pAlbedoLUT ? pAlbedoLUT->getTextureSizeInBytes() : 0);
+        }
+    };
+
     RGLMaterial::RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
         : Material(pDevice, name, MaterialType::RGL)
     {
         FALCOR_CHECK(!path.empty(), "Missing path.");
 
-        if (!loadBRDF(path))
-        {
-            FALCOR_THROW("RGLMaterial() - Failed to load BRDF from '{}'.", path);
-        }
-
         // Create resources for albedo lookup table.
         Sampler::Desc desc;
         desc.setFilterMode(TextureFilteringMode::Linear, TextureFilteringMode::Point, TextureFilteringMode::Point);
@@ -67,7 +94,11 @@ namespace Falcor
         desc.setMaxAnisotropy(1);
         mpSampler = mpDevice->createSampler(desc);
 
-        prepareAlbedoLUT(mpDevice->getRenderContext());
+        // Load the BRDF. This also prepares the albedo lookup table.
+        if (!loadBRDF(path))
+        {
+            FALCOR_THROW("RGLMaterial() - Failed to load BRDF from '{}'.", path);
+        }
     }
 
     bool RGLMaterial::renderUI(Gui::Widgets& widget)
@@ -90,8 +121,9 @@ namespace Falcor
             {
                 // If a BRDF was already loaded and we're just updating data,
                 // then buffer handles are already assigned.
-                // Replace the buffer contents instead of adding a new buffer.
-                if (mBRDFUploaded)
+                // Replace the buffer contents instead of adding a new buffer,
+                // unless the buffers are shared with other materials.
+                if (mBRDFUploaded && mReplaceBuffers)
                 {
                     pOwner->replaceBuffer(handle, buf);
                 }
@@ -135,6 +167,13 @@ namespace Falcor
         return true;
     }
 
+    size_t RGLMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        hashCombine(hash, std::filesystem::hash_value(mPath));
+        return hash;
+    }
+
     ProgramDesc::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -147,123 +186,185 @@ namespace Falcor
 
     bool RGLMaterial::loadBRDF(const std::filesystem::path& path)
     {
-        std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
-        if (!ifs.good())
+        // Load the BRDF, unless another material already uses it.
+        auto pSharedData = MeasuredBRDFRegistry::acquire<SharedData>(mpDevice.get(), "RGL", {path}, [&]() -> std::shared_ptr<SharedData>
         {
-            logWarning("RGLMaterial::loadBRDF() - Failed to open file '{}'.", path);
-            return false;
-        }
+            std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+            if (!ifs.good())
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to open file '{}'.", path);
+                return nullptr;
+            }
 
-        std::unique_ptr<RGLFile> file;
-        try
-        {
-            file.reset(new RGLFile(ifs));
-        }
-        catch(const RuntimeError& e)
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to parse RGL file '{}': {}.", path, e.what());
-            return false;
-        }
+            std::unique_ptr<RGLFile> file;
+            try
+            {
+                file.reset(new RGLFile(ifs));
+            }
+            catch(const RuntimeError& e)
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to parse RGL file '{}': {}.", path, e.what());
+                return nullptr;
+            }
 
-        if (!ifs.good())
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to load BRDF data from file '{}': Read error.", path);
-            return false;
-        }
+            if (!ifs.good())
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to load BRDF data from file '{}': Read error.", path);
+                return nullptr;
+            }
 
-        auto theta = file->data().thetaI;
-        auto phi   = file->data().phiI;
-        auto sigma = file->data().sigma;
-        auto ndf   = file->data().ndf;
-        auto vndf  = file->data().vndf;
-        auto lumi  = file->data().luminance;
-        auto rgb   = file->data().rgb;
-
-        const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
-        if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution
-            || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution
-            || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to process BRDF data: Measurement resolution too large.", path);
-            return false;
-        }
+            auto theta = file->data().thetaI;
+            auto phi   = file->data().phiI;
+            auto sigma = file->data().sigma;
+            auto ndf   = file->data().ndf;
+            auto vndf  = file->data().vndf;
+            auto lumi  = file->data().luminance;
+            auto rgb   = file->data().rgb;
+
+            const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
+            if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution
+                || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution
+                || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to process BRDF data: Measurement resolution too large.", path);
+                return nullptr;
+            }
+
+            auto pSharedData = std::make_shared<SharedData>();
+            pSharedData->name = std::filesystem::path(path).stem().string();
+            pSharedData->description = file->data().description;
+
+            RGLMaterialData& data = pSharedData->data;
+            data.phiSize = uint(phi->shape[0]);
+            data.thetaSize = uint(theta->shape[0]);
+            data.sigmaSize = uint2(sigma->shape[1], sigma->shape[0]);
+            data.  ndfSize = uint2(ndf  ->shape[1], ndf  ->shape[0]);
+            data. vndfSize = uint2(vndf ->shape[3], vndf ->shape[2]);
+            data. lumiSize = uint2(lumi ->shape[3], lumi ->shape[2]);
+
+            uint4 vndfSize = uint4(data.phiSize, data.thetaSize, data.vndfSize.x, data.vndfSize.y);
+            uint4 lumiSize = uint4(data.phiSize, data.thetaSize, data.lumiSize.x, data.lumiSize.y);
+            auto prod3 = [&](uint4 v) { return v.x * v.y * v.z; };
+            auto prod4 = [&](uint4 v) { return v.x * v.y * v.z * v.w; };
+
+            SamplableDistribution4D vndfDist(reinterpret_cast<float*>(vndf->data.get()), vndfSize);
+            SamplableDistribution4D lumiDist(reinterpret_cast<float*>(lumi->data.get()), lumiSize);
+
+            pSharedData->pVNDFMarginalBuf    = mpDevice->createBuffer(prod3(vndfSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getMarginal());
+            pSharedData->pLumiMarginalBuf    = mpDevice->createBuffer(prod3(lumiSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getMarginal());
+            pSharedData->pVNDFConditionalBuf = mpDevice->createBuffer(prod4(vndfSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getConditional());
+            pSharedData->pLumiConditionalBuf = mpDevice->createBuffer(prod4(lumiSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getConditional());
+
+            pSharedData->pThetaBuf = mpDevice->createBuffer(theta->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, theta->data.get());
+            pSharedData->pPhiBuf   = mpDevice->createBuffer(phi  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, phi  ->data.get());
+            pSharedData->pSigmaBuf = mpDevice->createBuffer(sigma->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, sigma->data.get());
+            pSharedData->pNDFBuf   = mpDevice->createBuffer(ndf  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, ndf  ->data.get());
+            pSharedData->pVNDFBuf  = mpDevice->createBuffer(vndf ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getPDF());
+            pSharedData->pLumiBuf  = mpDevice->createBuffer(lumi ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getPDF());
+            pSharedData->pRGBBuf   = mpDevice->createBuffer(rgb  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, rgb  ->data.get());
+
+            logInfo("Loaded RGL BRDF '{}': {}.", pSharedData->name, pSharedData->description);
+
+            return pSharedData;
+        });
+
+        if (!pSharedData) return false;
+
+        // The uploaded buffers can only be replaced in the material system if no other material uses them.
+        mReplaceBuffers = mpSharedData && mpSharedData.use_count() == 1;
+        mpSharedData = pSharedData;
 
         mPath = path;
-        mBRDFName = std::filesystem::path(path).stem().string();
-        mBRDFDescription = file->data().description;
-
-        mData.phiSize = uint(phi->shape[0]);
-        mData.thetaSize = uint(theta->shape[0]);
-        mData.sigmaSize = uint2(sigma->shape[1], sigma->shape[0]);
-        mData.  ndfSize = uint2(ndf  ->shape[1], ndf  ->shape[0]);
-        mData. vndfSize = uint2(vndf ->shape[3], vndf ->shape[2]);
-        mData. lumiSize = uint2(lumi ->shape[3], lumi ->shape[2]);
-
-        uint4 vndfSize = uint4(mData.phiSize, mData.thetaSize, mData.vndfSize.x, mData.vndfSize.y);
-        uint4 lumiSize = uint4(mData.phiSize, mData.thetaSize, mData.lumiSize.x, mData.lumiSize.y);
-        auto prod3 = [&](uint4 v) { return v.x * v.y * v.z; };
-        auto prod4 = [&](uint4 v) { return v.x * v.y * v.z * v.w; };
-
-        SamplableDistribution4D vndfDist(reinterpret_cast<float*>(vndf->data.get()), vndfSize);
-        SamplableDistribution4D lumiDist(reinterpret_cast<float*>(lumi->data.get()), lumiSize);
-
-        mpVNDFMarginalBuf    = mpDevice->createBuffer(prod3(vndfSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getMarginal());
-        mpLumiMarginalBuf    = mpDevice->createBuffer(prod3(lumiSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getMarginal());
-        mpVNDFConditionalBuf = mpDevice->createBuffer(prod4(vndfSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getConditional());
-        mpLumiConditionalBuf = mpDevice->createBuffer(prod4(lumiSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getConditional());
-
-        mpThetaBuf = mpDevice->createBuffer(theta->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, theta->data.get());
-        mpPhiBuf   = mpDevice->createBuffer(phi  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, phi  ->data.get());
-        mpSigmaBuf = mpDevice->createBuffer(sigma->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, sigma->data.get());
-        mpNDFBuf   = mpDevice->createBuffer(ndf  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, ndf  ->data.get());
-        mpVNDFBuf  = mpDevice->createBuffer(vndf ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getPDF());
-        mpLumiBuf  = mpDevice->createBuffer(lumi ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getPDF());
-        mpRGBBuf   = mpDevice->createBuffer(rgb  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, rgb  ->data.get());
+        mBRDFName = pSharedData->name;
+        mBRDFDescription = pSharedData->description;
+
+        mData.phiSize = pSharedData->data.phiSize;
+        mData.thetaSize = pSharedData->data.thetaSize;
+        mData.sigmaSize = pSharedData->data.sigmaSize;
+        mData.ndfSize = pSharedData->data.ndfSize;
+        mData.vndfSize = pSharedData->data.vndfSize;
+        mData.lumiSize = pSharedData->data.lumiSize;
+
+        mpVNDFMarginalBuf = pSharedData->pVNDFMarginalBuf;
+        mpLumiMarginalBuf = pSharedData->pLumiMarginalBuf;
+        mpVNDFConditionalBuf = pSharedData->pVNDFConditionalBuf;
+        mpLumiConditionalBuf = pSharedData->pLumiConditionalBuf;
+        mpThetaBuf = pSharedData->pThetaBuf;
+        mpPhiBuf = pSharedData->pPhiBuf;
+        mpSigmaBuf = pSharedData->pSigmaBuf;
+        mpNDFBuf = pSharedData->pNDFBuf;
+        mpVNDFBuf = pSharedData->pVNDFBuf;
+        mpLumiBuf = pSharedData->pLumiBuf;
+        mpRGBBuf = pSharedData->pRGBBuf;
 
-        markUpdates(Material::UpdateFlags::ResourcesChanged);
+        prepareAlbedoLUT(mpDevice->getRenderContext());
 
-        logInfo("Loaded RGL BRDF '{}': {}.", mBRDFName, mBRDFDescription);
+        markUpdates(Material::UpdateFlags::ResourcesChanged);
 
         return true;
     }
 
     void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext) // TODO
     {
-        const auto texPath = mPath.replace_extension("dds");
+        // The lookup table is shared with other materials using the same BRDF. Only the first one prepares it.
+        FALCOR_ASSERT(mpSharedData);
+        std::lock_guard<std::mutex> lock(mpSharedData->albedoLUTMutex);
+        if (mpSharedData->pAlbedoLUT)
+        {
+            mpAlbedoLUT = mpSharedData->pAlbedoLUT;
+            return;
+        }
+
+        auto createLUT = [&](const std::vector<float4>& data)
+        {
+            static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
+            mpAlbedoLUT = mpDevice->createTexture2D(kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, data.data(), ResourceBindFlags::ShaderResource);
+            mpSharedData->pAlbedoLUT = mpAlbedoLUT;
+        };
+
+        // Try loading albedo lookup table from the cache.
+        const auto cacheKey = AlbedoLUTCache::computeKey(mPath);
+        if (cacheKey)
+        {
+            if (auto data = AlbedoLUTCache::load(*cacheKey, kAlbedoLUTSize); !data.empty())
+            {
+                createLUT(data);
+                logInfo("Loaded albedo LUT for RGL BRDF '{}' from cache.", mBRDFName);
+                return;
+            }
+        }
 
-        // Try loading albedo lookup table.
+        // Try loading a precomputed albedo lookup table stored next to the BRDF file.
+        const auto texPath = std::filesystem::path(mPath).replace_extension("dds");
         if (std::filesystem::is_regular_file(texPath))
         {
             // Load 1D texture in non-SRGB format, no mips.
             // If successful, verify dimensions/format/etc. match the expectations.
-            mpAlbedoLUT = Texture::createFromFile(mpDevice, texPath.string(), false, false, ResourceBindFlags::ShaderResource);
+            const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
 
-            if (mpAlbedoLUT)
+            if (albedoLut && albedoLut->getFormat() == kAlbedoLUTFormat &&
+                albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
             {
-                if (mpAlbedoLUT->getFormat() == kAlbedoLUTFormat &&
-                    mpAlbedoLUT->getWidth() == kAlbedoLUTSize &&
-                    mpAlbedoLUT->getHeight() == 1 && mpAlbedoLUT->getDepth() == 1 &&
-                    mpAlbedoLUT->getMipCount() == 1 && mpAlbedoLUT->getArraySize() == 1)
-                {
-                    logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                    return;
-                }
+                const float4* pData = reinterpret_cast<const float4*>(albedoLut->getData());
+                std::vector<float4> data(pData, pData + kAlbedoLUTSize);
+                createLUT(data);
+                if (cacheKey) AlbedoLUTCache::store(*cacheKey, data);
+
+                logInfo("Loaded albedo LUT from '{}'.", texPath.string());
+                return;
             }
         }
 
         // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pRenderContext);
+        auto data = computeAlbedoLUT(pRenderContext);
+        createLUT(data);
 
-        // Cache lookup table in texture on disk.
-        // TODO: Capture texture to DDS is not yet supported. Calling ImageIO directly for now.
-        //mpAlbedoLUT->captureToFile(0, 0, texPath.string(), Bitmap::FileFormat::DdsFile, Bitmap::ExportFlags::Uncompressed);
-        FALCOR_ASSERT(mpAlbedoLUT);
-        ImageIO::saveToDDS(pRenderContext, texPath.string(), mpAlbedoLUT, ImageIO::CompressionMode::None, false);
-
-        logInfo("Saved albedo LUT to '{}'.", texPath.string());
+        // Cache lookup table on disk.
+        if (cacheKey && AlbedoLUTCache::store(*cacheKey, data))
+            logInfo("Saved albedo LUT for RGL BRDF '{}' to '{}'.", mBRDFName, AlbedoLUTCache::getCachePath(*cacheKey));
     }
 
-    void RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
+    std::vector<float4> RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
     {
         logInfo("Computing albedo LUT for RGL BRDF '{}'...", mBRDFName);
 
@@ -291,12 +392,9 @@ namespace Falcor
         auto albedos = integrator.integrateIsotropic(pRenderContext, materialID, cosThetas);
 
         // Copy result into format needed for texture creation.
-        static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        std::vector<float4> initData(kAlbedoLUTSize, float4(0.f));
-        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) initData[i] = float4(albedos[i], 1.f);
-
-        // Create albedo LUT texture.
-        mpAlbedoLUT = mpDevice->createTexture2D(kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, initData.data(), ResourceBindFlags::ShaderResource);
+        std::vector<float4> data(kAlbedoLUTSize, float4(0.f));
+        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) data[i] = float4(albedos[i], 1.f);
+        return data;
     }
 
     FALCOR_SCRIPT_BINDING(RGLMaterial)
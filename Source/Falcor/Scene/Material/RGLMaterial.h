@@ -29,6 +29,7 @@
 #include "Material.h"
 #include "RGLMaterialData.slang"
 #include <filesystem>
+#include <memory>
 
 namespace Falcor
 {
@@ -50,6 +51,7 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        size_t getHash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -59,15 +61,18 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
     protected:
+        struct SharedData;
+
         void prepareData(const int dims[3], const std::vector<double>& data);
         void prepareAlbedoLUT(RenderContext* pRenderContext);
-        void computeAlbedoLUT(RenderContext* pRenderContext);
+        std::vector<float4> computeAlbedoLUT(RenderContext* pRenderContext);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
         std::string mBRDFDescription;       ///< Description of the BRDF given in the BRDF file.
 
         bool mBRDFUploaded = false;         ///< True if BRDF data buffers have been uploaded to the material system.
+        bool mReplaceBuffers = false;       ///< True if the uploaded buffers are not used by other materials and can be replaced on reload.
         RGLMaterialData mData;              ///< Material parameters.
         ref<Buffer> mpThetaBuf;
         ref<Buffer> mpPhiBuf;
@@ -84,5 +89,6 @@ namespace Falcor
         ref<Sampler> mpSampler;             ///< Sampler for accessing BRDF textures.
 
         ref<ComputePass> mBRDFTesting;
+        std::shared_ptr<SharedData> mpSharedData; ///< BRDF data shared with other materials using the same BRDF (see MeasuredBRDFRegistry).
     };
 }
@@ -0,0 +1,483 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshOptimizer.h"
+#include "Core/Error.h"
+#include "Utils/Math/AABB.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace Falcor
+{
+    namespace MeshOptimizer
+    {
+        namespace
+        {
+            const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+            // Parameters of Forsyth's vertex cache optimization.
+            // See https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+            const uint32_t kCacheSize = 32;
+            const float kCacheDecayPower = 1.5f;
+            const float kLastTriScore = 0.75f;
+            const float kValenceBoostScale = 2.f;
+            const float kValenceBoostPower = 0.5f;
+            const uint32_t kMaxValenceTableSize = 64;
+
+            // Meshlet normal cone parameters.
+            const float kNoConeCutoff = 2.f;
+            const float kMinConeDot = 0.1f;
+
+            class VertexScoreTable
+            {
+            public:
+                VertexScoreTable()
+                {
+                    for (uint32_t i = 0; i < kCacheSize; i++)
+                    {
+                        // The vertices of the last triangle get a fixed score, so that the same triangle isn't favored
+                        // depending on the order in which its vertices were added.
+                        mCacheScore[i] = i < 3 ? kLastTriScore : std::pow(1.f - (i - 3) / float(kCacheSize - 3), kCacheDecayPower);
+                    }
+                    for (uint32_t i = 0; i < kMaxValenceTableSize; i++)
+                    {
+                        mValenceScore[i] = valenceScore(i);
+                    }
+                }
+
+                float getScore(uint32_t cachePos, uint32_t remainingTriangleCount) const
+                {
+                    // Vertices without any remaining triangles are never selected.
+                    if (remainingTriangleCount == 0) return -1.f;
+                    float score = cachePos < kCacheSize ? mCacheScore[cachePos] : 0.f;
+                    score += remainingTriangleCount < kMaxValenceTableSize ? mValenceScore[remainingTriangleCount] : valenceScore(remainingTriangleCount);
+                    return score;
+                }
+
+            private:
+                static float valenceScore(uint32_t remainingTriangleCount)
+                {
+                    // Boost vertices with few triangles left, so that lone triangles get drawn before they become expensive to revisit.
+                    return remainingTriangleCount == 0 ? 0.f : kValenceBoostScale * std::pow(float(remainingTriangleCount), -kValenceBoostPower);
+                }
+
+                std::array<float, kCacheSize> mCacheScore;
+                std::array<float, kMaxValenceTableSize> mValenceScore;
+            };
+
+            const VertexScoreTable& getVertexScoreTable()
+            {
+                static const VertexScoreTable table;
+                return table;
+            }
+
+            /** Forsyth's vertex cache optimization of a triangle list in place.
+                All indices must be less than vertexCount.
+            */
+            void optimizeVertexCacheImpl(uint32_t* indices, uint32_t triangleCount, uint32_t vertexCount)
+            {
+                if (triangleCount == 0) return;
+                const auto& scoreTable = getVertexScoreTable();
+
+                // Build vertex to triangle adjacency. The active triangles of vertex v are
+                // stored in adjacency[offsets[v] .. offsets[v] + remaining[v]).
+                std::vector<uint32_t> remaining(vertexCount, 0);
+                for (uint32_t i = 0; i < triangleCount * 3; i++) remaining[indices[i]]++;
+
+                std::vector<uint32_t> offsets(vertexCount, 0);
+                for (uint32_t v = 1; v < vertexCount; v++) offsets[v] = offsets[v - 1] + remaining[v - 1];
+
+                std::vector<uint32_t> adjacency(triangleCount * 3);
+                {
+                    std::vector<uint32_t> fill = offsets;
+                    for (uint32_t i = 0; i < triangleCount * 3; i++) adjacency[fill[indices[i]]++] = i / 3;
+                }
+
+                std::vector<uint32_t> cachePos(vertexCount, kInvalidIndex);
+                std::vector<float> vertexScores(vertexCount);
+                for (uint32_t v = 0; v < vertexCount; v++) vertexScores[v] = scoreTable.getScore(kInvalidIndex, remaining[v]);
+
+                auto triangleScore = [&](uint32_t t)
+                {
+                    return vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                };
+
+                std::vector<float> triangleScores(triangleCount);
+                std::vector<uint8_t> emitted(triangleCount, 0);
+                uint32_t bestTriangle = 0;
+                for (uint32_t t = 0; t < triangleCount; t++)
+                {
+                    triangleScores[t] = triangleScore(t);
+                    if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = t;
+                }
+
+                std::vector<uint32_t> output(triangleCount * 3);
+                std::array<uint32_t, kCacheSize + 3> cache;
+                std::array<uint32_t, kCacheSize + 3> newCache;
+                uint32_t cacheCount = 0;
+                uint32_t scanCursor = 0;
+
+                for (uint32_t outTriangle = 0; outTriangle < triangleCount; outTriangle++)
+                {
+                    // If no triangle is connected to the cache, continue with the next triangle in input order.
+                    if (bestTriangle == kInvalidIndex)
+                    {
+                        while (emitted[scanCursor]) scanCursor++;
+                        bestTriangle = scanCursor;
+                    }
+
+                    const uint32_t* triangle = indices + bestTriangle * 3;
+                    std::copy(triangle, triangle + 3, output.begin() + outTriangle * 3);
+                    emitted[bestTriangle] = 1;
+
+                    // Remove the triangle from the adjacency of its vertices.
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        const uint32_t v = triangle[i];
+                        uint32_t* pBegin = adjacency.data() + offsets[v];
+                        uint32_t* pEnd = pBegin + remaining[v];
+                        uint32_t* pTri = std::find(pBegin, pEnd, bestTriangle);
+                        FALCOR_ASSERT(pTri != pEnd);
+                        std::swap(*pTri, *(pEnd - 1));
+                        remaining[v]--;
+                    }
+
+                    // Move the triangle's vertices to the front of the LRU cache.
+                    uint32_t newCacheCount = 0;
+                    for (uint32_t i = 0; i < 3; i++) newCache[newCacheCount++] = triangle[i];
+                    for (uint32_t i = 0; i < cacheCount; i++)
+                    {
+                        const uint32_t v = cache[i];
+                        if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheCount++] = v;
+                    }
+
+                    // Update the scores of all vertices in the cache, including the ones that were just evicted.
+                    for (uint32_t i = 0; i < newCacheCount; i++)
+                    {
+                        const uint32_t v = newCache[i];
+                        cachePos[v] = i < kCacheSize ? i : kInvalidIndex;
+                        vertexScores[v] = scoreTable.getScore(cachePos[v], remaining[v]);
+                    }
+
+                    // Update the scores of the affected triangles and pick the best one.
+                    bestTriangle = kInvalidIndex;
+                    float bestScore = -std::numeric_limits<float>::infinity();
+                    for (uint32_t i = 0; i < newCacheCount; i++)
+                    {
+                        const uint32_t v = newCache[i];
+                        for (uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; j++)
+                        {
+                            const uint32_t t = adjacency[j];
+                            triangleScores[t] = triangleScore(t);
+                            if (triangleScores[t] > bestScore || (triangleScores[t] == bestScore && t < bestTriangle))
+                            {
+                                bestScore = triangleScores[t];
+                                bestTriangle = t;
+                            }
+                        }
+                    }
+
+                    cacheCount = std::min(newCacheCount, kCacheSize);
+                    std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+                }
+
+                std::copy(output.begin(), output.end(), indices);
+            }
+
+            /** Spreads the lower 10 bits of x to every third bit.
+            */
+            uint32_t expandBits(uint32_t x)
+            {
+                x &= 0x3ff;
+                x = (x | (x << 16)) & 0x030000ff;
+                x = (x | (x << 8)) & 0x0300f00f;
+                x = (x | (x << 4)) & 0x030c30c3;
+                x = (x | (x << 2)) & 0x09249249;
+                return x;
+            }
+
+            /** Converts a scaled coordinate to a 10-bit integer. Values are clamped to [0,1023], NaNs map to zero.
+            */
+            uint32_t quantize(float x)
+            {
+                return x > 0.f ? (uint32_t)std::min(x, 1023.f) : 0;
+            }
+
+            void checkIndices(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+            {
+                FALCOR_CHECK(indices.size() % 3 == 0, "Index count ({}) is not a multiple of three.", indices.size());
+                FALCOR_CHECK(std::all_of(indices.begin(), indices.end(), [vertexCount](uint32_t i) { return i < vertexCount; }), "Index out of range.");
+            }
+
+            /** Computes the bounding sphere and normal cone of a meshlet.
+                The cone follows the approach of meshoptimizer: the axis is the average triangle normal,
+                and the apex is placed such that the cone contains the planes of all triangles.
+            */
+            void computeMeshletBounds(MeshletDesc& meshlet, const uint32_t* pIndices, const std::vector<float3>& positions)
+            {
+                const uint32_t triangleCount = meshlet.getTriangleCount();
+
+                AABB bounds;
+                for (uint32_t i = 0; i < triangleCount * 3; i++) bounds.include(positions[pIndices[i]]);
+                const float3 center = bounds.center();
+                float radiusSq = 0.f;
+                for (uint32_t i = 0; i < triangleCount * 3; i++) radiusSq = std::max(radiusSq, dot(positions[pIndices[i]] - center, positions[pIndices[i]] - center));
+                meshlet.boundsCenter = center;
+                meshlet.boundsRadius = std::sqrt(radiusSq);
+
+                // Default to a cone that never culls.
+                meshlet.coneApex = center;
+                meshlet.coneAxis = float3(0.f, 0.f, 1.f);
+                meshlet.coneCutoff = kNoConeCutoff;
+
+                auto triangleNormal = [&](uint32_t t)
+                {
+                    const float3 p0 = positions[pIndices[t * 3]];
+                    const float3 n = cross(positions[pIndices[t * 3 + 1]] - p0, positions[pIndices[t * 3 + 2]] - p0);
+                    const float len = length(n);
+                    // Degenerate triangles are never visible and don't constrain the cone.
+                    return len > 0.f ? n / len : float3(0.f);
+                };
+
+                float3 axis(0.f);
+                for (uint32_t t = 0; t < triangleCount; t++) axis += triangleNormal(t);
+                const float axisLength = length(axis);
+                if (axisLength == 0.f) return;
+                axis /= axisLength;
+
+                float minDot = 1.f;
+                for (uint32_t t = 0; t < triangleCount; t++)
+                {
+                    const float3 n = triangleNormal(t);
+                    if (any(n != float3(0.f))) minDot = std::min(minDot, dot(axis, n));
+                }
+                // Cones wider than a half-space can't be used for culling.
+                if (minDot <= kMinConeDot) return;
+
+                // Place the apex so that every triangle plane passes in front of it.
+                float maxT = 0.f;
+                for (uint32_t t = 0; t < triangleCount; t++)
+                {
+                    const float3 n = triangleNormal(t);
+                    if (any(n != float3(0.f))) maxT = std::max(maxT, dot(center - positions[pIndices[t * 3]], n) / dot(axis, n));
+                }
+
+                meshlet.coneApex = center - axis * maxT;
+                meshlet.coneAxis = axis;
+                meshlet.coneCutoff = std::sqrt(std::max(0.f, 1.f - minDot * minDot));
+            }
+        }
+
+        void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+        {
+            checkIndices(indices, vertexCount);
+            optimizeVertexCacheImpl(indices.data(), (uint32_t)(indices.size() / 3), vertexCount);
+        }
+
+        void sortTrianglesMorton(std::vector<uint32_t>& indices, const std::vector<float3>& positions)
+        {
+            checkIndices(indices, (uint32_t)positions.size());
+            const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+            if (triangleCount < 2) return;
+
+            std::vector<float3> centroids(triangleCount);
+            AABB bounds;
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                centroids[t] = (positions[indices[t * 3 + 0]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.f;
+                // Non-finite centroids are left out of the bounds, so that they don't affect the quantization of the other triangles.
+                if (all(isfinite(centroids[t]))) bounds.include(centroids[t]);
+            }
+
+            // Quantize the centroids to 10 bits per axis. Flat extents map to zero.
+            const float3 extent = bounds.extent();
+            const float3 scale = float3(
+                extent.x > 0.f ? 1023.f / extent.x : 0.f,
+                extent.y > 0.f ? 1023.f / extent.y : 0.f,
+                extent.z > 0.f ? 1023.f / extent.z : 0.f);
+
+            // Sort by code and triangle index, so that the order is deterministic.
+            std::vector<std::pair<uint32_t, uint32_t>> keys(triangleCount);
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                const float3 p = (centroids[t] - bounds.minPoint) * scale;
+                const uint32_t code = (expandBits(quantize(p.x)) << 2) | (expandBits(quantize(p.y)) << 1) | expandBits(quantize(p.z));
+                keys[t] = { code, t };
+            }
+            std::sort(keys.begin(), keys.end());
+
+            std::vector<uint32_t> sorted(indices.size());
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                std::copy_n(indices.begin() + keys[t].second * 3, 3, sorted.begin() + t * 3);
+            }
+            indices = std::move(sorted);
+        }
+
+        std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+        {
+            checkIndices(indices, vertexCount);
+
+            std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+            uint32_t nextVertex = 0;
+            for (uint32_t& index : indices)
+            {
+                if (remap[index] == kInvalidIndex) remap[index] = nextVertex++;
+                index = remap[index];
+            }
+
+            // Keep unreferenced vertices at the end so that the vertex count is unchanged.
+            for (uint32_t& newIndex : remap)
+            {
+                if (newIndex == kInvalidIndex) newIndex = nextVertex++;
+            }
+            FALCOR_ASSERT(nextVertex == vertexCount);
+
+            return remap;
+        }
+
+        std::vector<uint32_t> optimizeLocality(std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t clusterTriangleCount)
+        {
+            FALCOR_CHECK(clusterTriangleCount > 0, "Cluster triangle count must be larger than zero.");
+            const uint32_t vertexCount = (uint32_t)positions.size();
+
+            sortTrianglesMorton(indices, positions);
+
+            // Optimize each cluster for the vertex cache separately to keep the spatial order between clusters.
+            // The cluster vertices are compacted to local indices to keep the cost proportional to the cluster size.
+            const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+            std::vector<uint32_t> localIndices;
+            std::vector<uint32_t> clusterVertices;
+            std::vector<uint32_t> localVertexIDs(vertexCount, kInvalidIndex);
+
+            for (uint32_t firstTriangle = 0; firstTriangle < triangleCount; firstTriangle += clusterTriangleCount)
+            {
+                const uint32_t clusterSize = std::min(clusterTriangleCount, triangleCount - firstTriangle);
+                uint32_t* pClusterIndices = indices.data() + firstTriangle * 3;
+
+                localIndices.clear();
+                clusterVertices.clear();
+                for (uint32_t i = 0; i < clusterSize * 3; i++)
+                {
+                    const uint32_t v = pClusterIndices[i];
+                    if (localVertexIDs[v] == kInvalidIndex)
+                    {
+                        localVertexIDs[v] = (uint32_t)clusterVertices.size();
+                        clusterVertices.push_back(v);
+                    }
+                    localIndices.push_back(localVertexIDs[v]);
+                }
+
+                optimizeVertexCacheImpl(localIndices.data(), clusterSize, (uint32_t)clusterVertices.size());
+
+                for (uint32_t i = 0; i < clusterSize * 3; i++) pClusterIndices[i] = clusterVertices[localIndices[i]];
+                for (uint32_t v : clusterVertices) localVertexIDs[v] = kInvalidIndex;
+            }
+
+            return optimizeVertexFetch(indices, vertexCount);
+        }
+
+        uint64_t countVertexCacheMisses(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            checkIndices(indices, vertexCount);
+
+            // A vertex is in the FIFO cache if fewer than cacheSize vertices were inserted after it.
+            std::vector<uint32_t> timestamps(vertexCount, 0);
+            uint32_t time = cacheSize + 1;
+            uint64_t misses = 0;
+            for (uint32_t index : indices)
+            {
+                if (time - timestamps[index] > cacheSize)
+                {
+                    timestamps[index] = time++;
+                    misses++;
+                }
+            }
+            return misses;
+        }
+
+        Meshlets buildMeshlets(const std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t maxVertexCount, uint32_t maxTriangleCount)
+        {
+            FALCOR_CHECK(maxVertexCount >= 3 && maxVertexCount <= 256, "Meshlet vertex count must be between 3 and 256.");
+            FALCOR_CHECK(maxTriangleCount >= 1 && maxTriangleCount <= 65535, "Meshlet triangle count must be between 1 and 65535.");
+            checkIndices(indices, (uint32_t)positions.size());
+
+            Meshlets result;
+            const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+            std::vector<uint32_t> localVertexIDs(positions.size(), kInvalidIndex);
+
+            auto finishMeshlet = [&](MeshletDesc& meshlet)
+            {
+                computeMeshletBounds(meshlet, indices.data() + meshlet.firstTriangle * 3, positions);
+                for (uint32_t i = 0; i < meshlet.getVertexCount(); i++) localVertexIDs[result.vertices[meshlet.vertexOffset + i]] = kInvalidIndex;
+                result.meshlets.push_back(meshlet);
+            };
+
+            MeshletDesc meshlet = {};
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                const uint32_t* pTri = indices.data() + t * 3;
+                uint32_t newVertexCount = 0;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    // Count duplicate indices within the triangle only once.
+                    if (localVertexIDs[pTri[i]] == kInvalidIndex && (i == 0 || pTri[i] != pTri[0]) && (i < 2 || pTri[2] != pTri[1])) newVertexCount++;
+                }
+
+                if (meshlet.getVertexCount() + newVertexCount > maxVertexCount || meshlet.getTriangleCount() + 1 > maxTriangleCount)
+                {
+                    finishMeshlet(meshlet);
+                    meshlet = {};
+                    meshlet.firstTriangle = t;
+                    meshlet.vertexOffset = (uint32_t)result.vertices.size();
+                    meshlet.triangleOffset = (uint32_t)result.triangles.size();
+                }
+
+                uint32_t packed = 0;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    uint32_t& localID = localVertexIDs[pTri[i]];
+                    if (localID == kInvalidIndex)
+                    {
+                        localID = meshlet.getVertexCount();
+                        result.vertices.push_back(pTri[i]);
+                        meshlet.counts++;
+                    }
+                    packed |= localID << (i * 8);
+                }
+                result.triangles.push_back(packed);
+                meshlet.counts += 1u << 16;
+            }
+            if (meshlet.getTriangleCount() > 0) finishMeshlet(meshlet);
+
+            return result;
+        }
+    }
+}
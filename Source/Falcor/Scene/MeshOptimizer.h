@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "SceneTypes.slang"
+#include "Utils/Math/Vector.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU utilities for reordering indexed triangle meshes for better memory locality.
+
+        All functions operate on triangle list indices. The vertex order within each
+        triangle is preserved so the triangle winding is unchanged. The results only
+        depend on the input data, which makes them suitable for cached scene data.
+    */
+    namespace MeshOptimizer
+    {
+        /** Default number of triangles per spatial cluster, see optimizeLocality().
+        */
+        constexpr uint32_t kDefaultClusterTriangleCount = 256;
+
+        /** Default meshlet size limits, see buildMeshlets().
+            These match the common limits of mesh shader implementations.
+        */
+        constexpr uint32_t kDefaultMeshletMaxVertexCount = 64;
+        constexpr uint32_t kDefaultMeshletMaxTriangleCount = 124;
+
+        /** Reorders triangles to improve the post-transform vertex cache hit rate.
+            This uses Tom Forsyth's linear-speed vertex cache optimization, which does not
+            depend on the exact cache size of the hardware.
+            \param[in,out] indices Triangle list indices.
+            \param[in] vertexCount Number of vertices. All indices must be less than this.
+        */
+        FALCOR_API void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Sorts triangles in Morton order of their centroids.
+            \param[in,out] indices Triangle list indices.
+            \param[in] positions Vertex positions.
+        */
+        FALCOR_API void sortTrianglesMorton(std::vector<uint32_t>& indices, const std::vector<float3>& positions);
+
+        /** Computes a vertex order in which vertices appear in the order they are first referenced.
+            Unreferenced vertices are moved to the end. The indices are remapped to the new order.
+            \param[in,out] indices Triangle list indices.
+            \param[in] vertexCount Number of vertices. All indices must be less than this.
+            \return Remapping table, where element i holds the new location of vertex i.
+        */
+        FALCOR_API std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Runs all locality optimizations on a mesh.
+            Triangles are first sorted in Morton order and split into spatially coherent clusters
+            of consecutive triangles, which benefits acceleration structure builds and traversal.
+            The triangles within each cluster are then reordered for the vertex cache, and finally
+            the vertices are reordered for fetch locality.
+            \param[in,out] indices Triangle list indices.
+            \param[in] positions Vertex positions.
+            \param[in] clusterTriangleCount Number of triangles per cluster.
+            \return Vertex remapping table, see optimizeVertexFetch().
+        */
+        FALCOR_API std::vector<uint32_t> optimizeLocality(std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t clusterTriangleCount = kDefaultClusterTriangleCount);
+
+        /** Counts the vertex cache misses of a FIFO cache for a triangle list.
+            Dividing by the triangle count gives the average cache miss ratio (ACMR).
+            \param[in] indices Triangle list indices.
+            \param[in] vertexCount Number of vertices. All indices must be less than this.
+            \param[in] cacheSize Number of entries in the simulated cache.
+            \return Number of cache misses.
+        */
+        FALCOR_API uint64_t countVertexCacheMisses(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 32);
+
+        /** Meshlets of a single mesh, see buildMeshlets().
+        */
+        struct Meshlets
+        {
+            std::vector<MeshletDesc> meshlets;      ///< Meshlet descriptors. The offsets are relative to the lists below and the mesh ID is zero.
+            std::vector<uint32_t> vertices;         ///< Vertex indices of all meshlets.
+            std::vector<uint32_t> triangles;        ///< Triangles of all meshlets, packed as three 8-bit indices into the meshlet's vertices.
+        };
+
+        /** Splits a mesh into meshlets with bounding spheres and normal cones.
+            Triangles are assigned greedily in index buffer order, so each meshlet covers a range of
+            consecutive triangles. Running optimizeLocality() beforehand results in tighter meshlets.
+            \param[in] indices Triangle list indices.
+            \param[in] positions Vertex positions.
+            \param[in] maxVertexCount Max number of unique vertices per meshlet, at most 256.
+            \param[in] maxTriangleCount Max number of triangles per meshlet, at most 65535.
+            \return Meshlets covering all triangles of the mesh.
+        */
+        FALCOR_API Meshlets buildMeshlets(const std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t maxVertexCount = kDefaultMeshletMaxVertexCount, uint32_t maxTriangleCount = kDefaultMeshletMaxTriangleCount);
+    }
+}
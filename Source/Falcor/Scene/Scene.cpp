@@ -29,6 +29,7 @@
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
 #include "Importer.h"
+#include "DrawCulling.h"
 #include "Scene/Material/SerializedMaterialParams.h"
 #include "Curves/CurveConfig.h"
 #include "SDFs/SDFGrid.h"
@@ -48,6 +49,7 @@
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Metrics.h"
 
 #include <fstream>
 #include <numeric>
@@ -58,6 +60,7 @@
 namespace Falcor
 {
     static_assert(sizeof(MeshDesc) % 16 == 0, "MeshDesc size should be a multiple of 16");
+    static_assert(sizeof(MeshletDesc) == 64, "MeshletDesc size should be 64");
     static_assert(sizeof(GeometryInstanceData) == 32, "GeometryInstanceData size should be 32");
     static_assert(sizeof(PackedStaticVertexData) % 16 == 0, "PackedStaticVertexData size should be a multiple of 16");
 
@@ -70,6 +73,9 @@ namespace Falcor
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
+        const std::string kMeshletBufferName = "meshlets";
+        const std::string kMeshletVertexBufferName = "meshletVertices";
+        const std::string kMeshletTriangleBufferName = "meshletTriangles";
         const std::string kIndexBufferName = "indexData";
         const std::string kVertexBufferName = "vertices";
         const std::string kPrevVertexBufferName = "prevVertices";
@@ -109,6 +115,10 @@ namespace Falcor
         const std::string kSelectViewpoint = "selectViewpoint";
 
         const std::string kMeshIOShaderFilename = "Scene/MeshIO.cs.slang";
+        const std::string kCullDrawArgsShaderFilename = "Scene/CullDrawArgs.cs.slang";
+
+        // Index of the visible triangle count in the draw culling counter buffer. The draw counts are stored first.
+        const uint32_t kDrawCullTriangleCountIndex = 4;
         const std::string kMeshLoaderRequiredBufferNames[] =
         {
             "triangleIndices",
@@ -192,6 +202,7 @@ namespace Falcor
         mMeshBBs = std::move(sceneData.meshBBs);
         mMeshIdToInstanceIds = std::move(sceneData.meshIdToInstanceIds);
         mMeshGroups = std::move(sceneData.meshGroups);
+        mMeshlets = std::move(sceneData.meshlets);
 
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
         mHas16BitIndices = sceneData.has16BitIndices;
@@ -225,6 +236,7 @@ namespace Falcor
 
         // Create vertex array objects for meshes and curves.
         createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
+        createMeshletBuffers(sceneData.meshletVertices, sceneData.meshletTriangles);
         createCurveVao(mCurveIndexData, mCurveStaticData);
         createMeshUVTiles(mMeshDesc, sceneData.meshIndexData, sceneData.meshStaticData);
 
@@ -367,13 +379,36 @@ namespace Falcor
 
         pVars->setParameterBlock(kParameterBlockName, mpSceneBlock);
 
+        if (mDrawCullMode == DrawCullMode::GPU) readDrawCullStatsGPU(pRenderContext);
+        if (mDrawCullMode != DrawCullMode::None && mDrawCullDirty) updateDrawCulling(pRenderContext);
+
         auto pCurrentRS = pState->getRasterizerState();
         bool isIndexed = hasIndexBuffer();
 
-        for (const auto& draw : mDrawArgs)
+        for (size_t i = 0; i < mDrawArgs.size(); i++)
         {
+            const auto& draw = mDrawArgs[i];
             FALCOR_ASSERT(draw.count > 0);
 
+            // Select the draw arguments. With GPU culling the draw count is read from the counter buffer.
+            const Buffer* pArgBuffer = draw.pBuffer.get();
+            uint32_t drawCount = draw.count;
+            const Buffer* pCountBuffer = nullptr;
+            uint64_t countBufferOffset = 0;
+
+            if (mDrawCullMode == DrawCullMode::CPU)
+            {
+                if (draw.culledCount == 0) continue;
+                pArgBuffer = draw.pCulledBuffer.get();
+                drawCount = draw.culledCount;
+            }
+            else if (mDrawCullMode == DrawCullMode::GPU)
+            {
+                pArgBuffer = draw.pCulledBuffer.get();
+                pCountBuffer = mGpuDrawCull.pCounterBuffer.get();
+                countBufferOffset = i * sizeof(uint32_t);
+            }
+
             // Set state.
             pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao);
 
@@ -383,11 +418,11 @@ namespace Falcor
             // Draw the primitives.
             if (isIndexed)
             {
-                pRenderContext->drawIndexedIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pRenderContext->drawIndexedIndirect(pState, pVars, drawCount, pArgBuffer, 0, pCountBuffer, countBufferOffset);
             }
             else
             {
-                pRenderContext->drawIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pRenderContext->drawIndirect(pState, pVars, drawCount, pArgBuffer, 0, pCountBuffer, countBufferOffset);
             }
         }
 
@@ -507,6 +542,19 @@ namespace Falcor
         mpMeshVao16Bit = Vao::create(Vao::Topology::TriangleList, pLayout, pVBs, pIB, ResourceFormat::R16Uint);
     }
 
+    void Scene::createMeshletBuffers(const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles)
+    {
+        if (mMeshlets.empty()) return;
+
+        // The meshlet data is static, so the buffers are initialized once here.
+        mpMeshletsBuffer = mpDevice->createStructuredBuffer(sizeof(MeshletDesc), (uint32_t)mMeshlets.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, mMeshlets.data(), false);
+        mpMeshletsBuffer->setName("Scene::mpMeshletsBuffer");
+        mpMeshletVerticesBuffer = mpDevice->createStructuredBuffer(sizeof(uint32_t), (uint32_t)meshletVertices.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, meshletVertices.data(), false);
+        mpMeshletVerticesBuffer->setName("Scene::mpMeshletVerticesBuffer");
+        mpMeshletTrianglesBuffer = mpDevice->createStructuredBuffer(sizeof(uint32_t), (uint32_t)meshletTriangles.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, meshletTriangles.data(), false);
+        mpMeshletTrianglesBuffer->setName("Scene::mpMeshletTrianglesBuffer");
+    }
+
     void Scene::createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData)
     {
         if (indexData.empty() || staticData.empty()) return;
@@ -829,6 +877,10 @@ namespace Falcor
         var[kMeshBufferName] = mpMeshesBuffer;
         var[kCurveBufferName] = mpCurvesBuffer;
         var[kGeometryInstanceBufferName] = mpGeometryInstancesBuffer;
+        var["meshletCount"] = getMeshletCount();
+        var[kMeshletBufferName] = mpMeshletsBuffer;
+        var[kMeshletVertexBufferName] = mpMeshletVerticesBuffer;
+        var[kMeshletTriangleBufferName] = mpMeshletTrianglesBuffer;
 
         FALCOR_ASSERT(mpAnimationController);
         mpAnimationController->bindBuffers();
@@ -870,23 +922,28 @@ namespace Falcor
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
         mSceneBB = AABB();
+        mGeometryInstanceBBs.resize(mGeometryInstanceData.size());
 
-        for (const auto& inst : mGeometryInstanceData)
+        for (size_t i = 0; i < mGeometryInstanceData.size(); i++)
         {
+            const auto& inst = mGeometryInstanceData[i];
             const float4x4& transform = globalMatrices[inst.globalMatrixID];
+            AABB& instanceBB = mGeometryInstanceBBs[i];
+            instanceBB = AABB();
+
             switch (inst.getType())
             {
             case GeometryType::TriangleMesh:
             case GeometryType::DisplacedTriangleMesh:
             {
                 const AABB& meshBB = mMeshBBs[inst.geometryID];
-                mSceneBB |= meshBB.transform(transform);
+                instanceBB = meshBB.transform(transform);
                 break;
             }
             case GeometryType::Curve:
             {
                 const AABB& curveBB = mCurveBBs[inst.geometryID];
-                mSceneBB |= curveBB.transform(transform);
+                instanceBB = curveBB.transform(transform);
                 break;
             }
             case GeometryType::SDFGrid:
@@ -897,10 +954,12 @@ namespace Falcor
                 transform3x3[2] = abs(transform3x3[2]);
                 float3 center = transform.getCol(3).xyz();
                 float3 halfExtent = transformVector(transform3x3, float3(0.5f));
-                mSceneBB |= AABB(center - halfExtent, center + halfExtent);
+                instanceBB = AABB(center - halfExtent, center + halfExtent);
                 break;
             }
             }
+
+            mSceneBB |= instanceBB;
         }
 
         for (const auto& aabb : mCustomPrimitiveAABBs)
@@ -912,6 +971,13 @@ namespace Falcor
         {
             mSceneBB |= pGridVolume->getBounds();
         }
+
+        mGpuDrawCull.instanceBoundsDirty = true;
+        mDrawCullDirty = true;
+
+        // Refit the instance BVH if the set of instances is unchanged, otherwise rebuild it.
+        if (mInstanceBVH.getItemCount() == mGeometryInstanceBBs.size() && !mGeometryInstanceBBs.empty()) mInstanceBVH.refit(mGeometryInstanceBBs);
+        else mInstanceBVH.build(mGeometryInstanceBBs);
     }
 
     void Scene::updateGeometryInstances(bool forceUpdate)
@@ -1432,14 +1498,20 @@ namespace Falcor
 
         s.geometryMemoryInBytes += mpGeometryInstancesBuffer ? mpGeometryInstancesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpMeshesBuffer ? mpMeshesBuffer->getSize() : 0;
+
+        s.meshletCount = getMeshletCount();
+        s.meshletMemoryInBytes = 0;
+        s.meshletMemoryInBytes += mpMeshletsBuffer ? mpMeshletsBuffer->getSize() : 0;
+        s.meshletMemoryInBytes += mpMeshletVerticesBuffer ? mpMeshletVerticesBuffer->getSize() : 0;
+        s.meshletMemoryInBytes += mpMeshletTrianglesBuffer ? mpMeshletTrianglesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpCurvesBuffer ? mpCurvesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpCustomPrimitivesBuffer ? mpCustomPrimitivesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpRtAABBBuffer ? mpRtAABBBuffer->getSize() : 0;
 
         for (const auto& draw : mDrawArgs)
         {
-            FALCOR_ASSERT(draw.pBuffer);
-            s.geometryMemoryInBytes += draw.pBuffer->getSize();
+            FALCOR_ASSERT(draw.pBuffer && draw.pCulledBuffer);
+            s.geometryMemoryInBytes += draw.pBuffer->getSize() + draw.pCulledBuffer->getSize();
         }
 
         s.animationMemoryInBytes += getAnimationController()->getMemoryUsageInBytes();
@@ -1770,6 +1842,22 @@ namespace Falcor
         return flags;
     }
 
+    void Scene::updateTextureUsage()
+    {
+        // Mark the materials of all instances in the view frustum as used, so that their textures are kept resident.
+        // This requires a frustum query every frame, so it is only done when a texture memory budget is set.
+        if (mpMaterials->getTextureManager().getResidencyOptions().memoryBudgetInBytes == 0 || mCameras.empty()) return;
+
+        std::vector<bool> isMaterialUsed(mpMaterials->getMaterialCount(), false);
+        for (uint32_t instanceID : cullGeometryInstances(*mCameras[mSelectedCamera]))
+        {
+            const uint32_t materialID = mGeometryInstanceData[instanceID].materialID;
+            if (isMaterialUsed[materialID]) continue;
+            isMaterialUsed[materialID] = true;
+            mpMaterials->markMaterialUsed(MaterialID{ materialID });
+        }
+    }
+
     Scene::UpdateFlags Scene::updateMaterials(bool forceUpdate)
     {
         // Update material system.
@@ -1867,6 +1955,7 @@ namespace Falcor
 
         // Perform updates that may affect the scene defines.
         updateGeometryTypes();
+        updateTextureUsage();
         mUpdates |= updateMaterials(false);
 
         // Update scene defines.
@@ -1912,6 +2001,7 @@ namespace Falcor
         }
 
         mUpdates |= updateSelectedCamera(false);
+        if (is_set(mUpdates, UpdateFlags::CameraMoved | UpdateFlags::CameraPropertiesChanged | UpdateFlags::CameraSwitched)) mDrawCullDirty = true;
         mUpdates |= updateLights(false);
         mUpdates |= updateGridVolumes(false);
         mUpdates |= updateEnvMap(false);
@@ -1923,6 +2013,7 @@ namespace Falcor
         {
             invalidateTlasCache();
             updateGeometryInstances(false);
+            updateBounds();
         }
 
         // Update existing BLASes if skinned animation and/or procedural primitives moved.
@@ -2092,6 +2183,20 @@ namespace Falcor
             renderSettingsGroup.slider("Diffuse albedo multiplier", mRenderSettings.diffuseAlbedoMultiplier);
         }
 
+        if (auto drawCullGroup = widget.group("Draw Culling"))
+        {
+            DrawCullMode drawCullMode = mDrawCullMode;
+            if (drawCullGroup.dropdown("Mode", drawCullMode)) setDrawCullMode(drawCullMode);
+            drawCullGroup.tooltip("Culls mesh instances against the selected camera's frustum before rasterization.\n"
+                "CPU culling uses the instance BVH and uploads compacted draw arguments. GPU culling compacts the draw arguments in a compute pass.", true);
+
+            const auto& s = mDrawCullStats;
+            std::ostringstream oss;
+            oss << "Instances culled: " << s.culledInstanceCount << " / " << s.instanceCount << std::endl
+                << "Triangles culled: " << s.culledTriangleCount << " / " << s.triangleCount << std::endl;
+            drawCullGroup.text(oss.str());
+        }
+
         if (mSDFGridConfig.implementation != SDFGrid::Type::None)
         {
             if (auto sdfGridConfigGroup = widget.group("SDF Grid Settings"))
@@ -2190,6 +2295,8 @@ namespace Falcor
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
+                << "  Meshlet count: " << s.meshletCount << std::endl
+                << "  Meshlet data memory: " << formatByteSize(s.meshletMemoryInBytes) << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
                 << "  Curve instance count: " << s.curveInstanceCount << std::endl
                 << "  Unique curve segment count: " << s.uniqueCurveSegmentCount << std::endl
@@ -2235,6 +2342,13 @@ namespace Falcor
                 << "  Texture memory: " << formatByteSize(s.materials.textureMemoryInBytes) << std::endl
                 << "  Bytes/texel (average): " << std::fixed << std::setprecision(2) << bytesPerTexel << std::endl
                 << "  Channels/texel (average): " << std::fixed << std::setprecision(2) << channelsPerTexel << std::endl
+                << "  Virtual texture count: " << s.materials.virtualTextureCount << std::endl
+                << "  Virtual texture resident tiles: " << s.materials.virtualTextureResidentTileCount << std::endl
+                << "  Virtual texture memory: " << formatByteSize(s.materials.virtualTextureMemoryInBytes) << std::endl
+                << "  Measured BRDF count (shared): " << s.materials.measuredBRDFCount << std::endl
+                << "  Measured BRDF references: " << s.materials.measuredBRDFReferenceCount << std::endl
+                << "  Measured BRDF memory: " << formatByteSize(s.materials.measuredBRDFMemoryInBytes) << std::endl
+                << "  Measured BRDF memory (saved by sharing): " << formatByteSize(s.materials.measuredBRDFMemorySavedInBytes) << std::endl
                 << std::endl;
 
             // Analytic light stats.
@@ -2568,6 +2682,27 @@ namespace Falcor
         return instanceIDs;
     }
 
+    std::vector<uint32_t> Scene::cullGeometryInstances(const Camera& camera) const
+    {
+        std::vector<uint32_t> instanceIDs;
+        mInstanceBVH.queryFrustum(camera.getFrustumPlanes(), instanceIDs);
+        return instanceIDs;
+    }
+
+    std::vector<uint32_t> Scene::findGeometryInstancesInAABB(const AABB& aabb) const
+    {
+        std::vector<uint32_t> instanceIDs;
+        mInstanceBVH.queryAABB(aabb, instanceIDs);
+        return instanceIDs;
+    }
+
+    std::optional<uint32_t> Scene::pickGeometryInstance(const Ray& ray) const
+    {
+        InstanceBVH::RayHit hit;
+        if (mInstanceBVH.queryClosest(ray, hit)) return hit.itemIndex;
+        return std::nullopt;
+    }
+
     ref<Material> Scene::getGeometryMaterial(GlobalGeometryID geometryID) const
     {
         GlobalGeometryID::IntType geometryIdx = geometryID.get();
@@ -2724,20 +2859,34 @@ namespace Falcor
         // TODO: Update the draw args if a mesh undergoes animation that flips the winding.
 
         mDrawArgs.clear();
+        mDrawCullDirty = true;
 
         // Helper to create the draw-indirect buffer.
+        // The culled buffer has the same size and receives the compacted arguments when draw-list culling is enabled.
         auto createDrawBuffer = [this](const auto& drawMeshes, bool ccw, ResourceFormat ibFormat = ResourceFormat::Unknown)
         {
             if (drawMeshes.size() > 0)
             {
+                const size_t byteSize = sizeof(drawMeshes[0]) * drawMeshes.size();
+
                 DrawArgs draw;
-                draw.pBuffer = mpDevice->createBuffer(sizeof(drawMeshes[0]) * drawMeshes.size(), ResourceBindFlags::IndirectArg, MemoryType::DeviceLocal, drawMeshes.data());
+                draw.pBuffer = mpDevice->createBuffer(byteSize, ResourceBindFlags::IndirectArg | ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, drawMeshes.data());
                 draw.pBuffer->setName("Scene draw buffer");
+                draw.pCulledBuffer = mpDevice->createBuffer(byteSize, ResourceBindFlags::IndirectArg | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr);
+                draw.pCulledBuffer->setName("Scene culled draw buffer");
                 FALCOR_ASSERT(drawMeshes.size() <= std::numeric_limits<uint32_t>::max());
                 draw.count = (uint32_t)drawMeshes.size();
                 draw.ccw = ccw;
                 draw.ibFormat = ibFormat;
-                mDrawArgs.push_back(draw);
+
+                // Keep a CPU copy for culling. The vertex/index count is the first word of both argument types.
+                static_assert(sizeof(drawMeshes[0]) % sizeof(uint32_t) == 0);
+                draw.argStride = (uint32_t)(sizeof(drawMeshes[0]) / sizeof(uint32_t));
+                const uint32_t* pArgs = reinterpret_cast<const uint32_t*>(drawMeshes.data());
+                draw.args.assign(pArgs, pArgs + draw.count * draw.argStride);
+                for (const auto& drawMesh : drawMeshes) draw.triangleCount += *reinterpret_cast<const uint32_t*>(&drawMesh) / 3;
+
+                mDrawArgs.push_back(std::move(draw));
             }
         };
 
@@ -2795,6 +2944,142 @@ namespace Falcor
         }
     }
 
+    void Scene::setDrawCullMode(DrawCullMode mode)
+    {
+        if (mode == mDrawCullMode) return;
+        mDrawCullMode = mode;
+        mDrawCullDirty = true;
+        mDrawCullStats = {};
+    }
+
+    void Scene::updateDrawCulling(RenderContext* pRenderContext)
+    {
+        FALCOR_PROFILE(pRenderContext, "updateDrawCulling");
+
+        FALCOR_ASSERT(mDrawArgs.size() <= kDrawCullTriangleCountIndex);
+
+        mDrawCullStats.instanceCount = 0;
+        mDrawCullStats.triangleCount = 0;
+        for (const auto& draw : mDrawArgs)
+        {
+            mDrawCullStats.instanceCount += draw.count;
+            mDrawCullStats.triangleCount += draw.triangleCount;
+        }
+
+        if (mDrawCullMode == DrawCullMode::CPU) cullDrawListCPU();
+        else if (mDrawCullMode == DrawCullMode::GPU) cullDrawListGPU(pRenderContext);
+
+        mDrawCullDirty = false;
+    }
+
+    void Scene::cullDrawListCPU()
+    {
+        // Mark the instances that are at least partially inside the frustum.
+        std::vector<uint32_t> visibleInstanceIDs = cullGeometryInstances(*mCameras[mSelectedCamera]);
+        std::vector<uint8_t> isVisible(mGeometryInstanceData.size(), 0);
+        for (uint32_t instanceID : visibleInstanceIDs) isVisible[instanceID] = 1;
+
+        uint32_t visibleInstanceCount = 0;
+        uint64_t visibleTriangleCount = 0;
+        std::vector<uint32_t> culledArgs;
+
+        for (auto& draw : mDrawArgs)
+        {
+            visibleTriangleCount += compactDrawArgs(draw.args, draw.argStride, isVisible, culledArgs);
+            draw.culledCount = (uint32_t)(culledArgs.size() / draw.argStride);
+            visibleInstanceCount += draw.culledCount;
+            if (draw.culledCount > 0) draw.pCulledBuffer->setBlob(culledArgs.data(), 0, culledArgs.size() * sizeof(uint32_t));
+        }
+
+        mDrawCullStats.culledInstanceCount = mDrawCullStats.instanceCount - visibleInstanceCount;
+        mDrawCullStats.culledTriangleCount = mDrawCullStats.triangleCount - visibleTriangleCount;
+    }
+
+    void Scene::readDrawCullStatsGPU(RenderContext* pRenderContext)
+    {
+        // Read back the statistics of the latest culling pass that has completed on the GPU, without waiting.
+        // The draw count itself stays on the GPU, so the statistics are allowed to lag behind.
+        auto& gpu = mGpuDrawCull;
+        const uint64_t completedValue = pRenderContext->getLowLevelData()->getFence()->getCurrentValue();
+        size_t latest = gpu.readbackFenceValues.size();
+        for (size_t i = 0; i < gpu.readbackFenceValues.size(); i++)
+        {
+            if (gpu.readbackFenceValues[i] == 0 || gpu.readbackFenceValues[i] > completedValue) continue;
+            if (latest == gpu.readbackFenceValues.size() || gpu.readbackFenceValues[i] > gpu.readbackFenceValues[latest]) latest = i;
+        }
+        if (latest == gpu.readbackFenceValues.size()) return;
+
+        const uint32_t* pCounters = static_cast<const uint32_t*>(gpu.pReadbackBuffers[latest]->map());
+        uint32_t visibleInstanceCount = 0;
+        for (size_t i = 0; i < mDrawArgs.size(); i++) visibleInstanceCount += pCounters[i];
+        mDrawCullStats.culledInstanceCount = mDrawCullStats.instanceCount - std::min(visibleInstanceCount, mDrawCullStats.instanceCount);
+        mDrawCullStats.culledTriangleCount = mDrawCullStats.triangleCount - std::min((uint64_t)pCounters[kDrawCullTriangleCountIndex], mDrawCullStats.triangleCount);
+        gpu.pReadbackBuffers[latest]->unmap();
+
+        // Older readbacks are complete as well and no longer needed.
+        for (auto& value : gpu.readbackFenceValues)
+        {
+            if (value <= gpu.readbackFenceValues[latest]) value = 0;
+        }
+    }
+
+    void Scene::cullDrawListGPU(RenderContext* pRenderContext)
+    {
+        auto& gpu = mGpuDrawCull;
+
+        if (!gpu.pPass)
+        {
+            gpu.pPass = ComputePass::create(mpDevice, kCullDrawArgsShaderFilename, "main");
+            const size_t counterSize = (kDrawCullTriangleCountIndex + 1) * sizeof(uint32_t);
+            gpu.pCounterBuffer = mpDevice->createBuffer(counterSize, ResourceBindFlags::IndirectArg | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr);
+            gpu.pCounterBuffer->setName("Scene draw cull counters");
+            for (auto& pReadbackBuffer : gpu.pReadbackBuffers) pReadbackBuffer = mpDevice->createBuffer(counterSize, ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
+        }
+
+        if (gpu.instanceBoundsDirty || !gpu.pInstanceBoundsBuffer)
+        {
+            static_assert(sizeof(AABB) == 24, "AABB size should be 24 bytes to match the GPU layout");
+            const uint32_t instanceCount = std::max(1u, (uint32_t)mGeometryInstanceBBs.size());
+            if (!gpu.pInstanceBoundsBuffer || gpu.pInstanceBoundsBuffer->getElementCount() < instanceCount)
+            {
+                gpu.pInstanceBoundsBuffer = mpDevice->createStructuredBuffer(sizeof(AABB), instanceCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+                gpu.pInstanceBoundsBuffer->setName("Scene instance bounds");
+            }
+            if (!mGeometryInstanceBBs.empty()) gpu.pInstanceBoundsBuffer->setBlob(mGeometryInstanceBBs.data(), 0, mGeometryInstanceBBs.size() * sizeof(AABB));
+            gpu.instanceBoundsDirty = false;
+        }
+
+        pRenderContext->clearUAV(gpu.pCounterBuffer->getUAV().get(), uint4(0));
+
+        const auto frustumPlanes = mCameras[mSelectedCamera]->getFrustumPlanes();
+        auto var = gpu.pPass->getRootVar();
+        for (uint32_t i = 0; i < frustumPlanes.size(); i++) var["CB"]["gFrustumPlanes"][i] = frustumPlanes[i];
+        var["CB"]["gTriangleCountIndex"] = kDrawCullTriangleCountIndex;
+        var["gInstanceBounds"] = gpu.pInstanceBoundsBuffer;
+        var["gCounters"] = gpu.pCounterBuffer;
+
+        for (size_t i = 0; i < mDrawArgs.size(); i++)
+        {
+            const auto& draw = mDrawArgs[i];
+            var["CB"]["gDrawCount"] = draw.count;
+            var["CB"]["gArgStride"] = draw.argStride;
+            var["CB"]["gCountIndex"] = (uint32_t)i;
+            var["gDrawArgs"] = draw.pBuffer;
+            var["gCulledDrawArgs"] = draw.pCulledBuffer;
+            gpu.pPass->execute(pRenderContext, draw.count, 1);
+        }
+
+        // Copy the counters to a free readback buffer. The copy is submitted with the rest of the frame, after which
+        // the render context fence reaches its next signaled value. If all buffers are in flight the statistics are skipped.
+        auto it = std::find(gpu.readbackFenceValues.begin(), gpu.readbackFenceValues.end(), 0);
+        if (it != gpu.readbackFenceValues.end())
+        {
+            const size_t i = it - gpu.readbackFenceValues.begin();
+            pRenderContext->copyBufferRegion(gpu.pReadbackBuffers[i].get(), 0, gpu.pCounterBuffer.get(), 0, gpu.pCounterBuffer->getSize());
+            *it = pRenderContext->getLowLevelData()->getFence()->getSignaledValue() + 1;
+        }
+    }
+
     void Scene::initGeomDesc(RenderContext* pRenderContext)
     {
         // This function initializes all geometry descs to prepare for BLAS build.
@@ -3375,6 +3660,7 @@ namespace Falcor
                         }
 
                         pRenderContext->buildAccelerationStructure(asDesc, 1, &postbuildInfoDesc);
+                        FALCOR_METRIC_COUNT("scene.blas_builds", 1);
                     }
 
                     // Read back the calculated final size requirements for each BLAS.
@@ -3505,11 +3791,13 @@ namespace Falcor
                     // Set source address to destination address to update in place.
                     asDesc.source = asDesc.dest;
                     asDesc.inputs.flags |= RtAccelerationStructureBuildFlags::PerformUpdate;
+                    FALCOR_METRIC_COUNT("scene.blas_refits", 1);
                 }
                 else
                 {
                     // We'll rebuild in place. The BLAS should not be compacted, check that size matches prebuild info.
                     FALCOR_ASSERT(blas.blasByteSize == blas.prebuildInfo.resultDataMaxSize);
+                    FALCOR_METRIC_COUNT("scene.blas_builds", 1);
                 }
                 pRenderContext->buildAccelerationStructure(asDesc, 0, nullptr);
             }
@@ -3817,6 +4105,11 @@ namespace Falcor
         if ((inputs.flags & RtAccelerationStructureBuildFlags::PerformUpdate) != RtAccelerationStructureBuildFlags::None)
         {
             asDesc.source = asDesc.dest;
+            FALCOR_METRIC_COUNT("scene.tlas_updates", 1);
+        }
+        else
+        {
+            FALCOR_METRIC_COUNT("scene.tlas_builds", 1);
         }
 
         // Create TLAS
@@ -4110,6 +4403,16 @@ namespace Falcor
         updateForInverseRendering(mpDevice->getRenderContext(), false, true);
     }
 
+    inline pybind11::dict toPython(const Scene::DrawCullStats& stats)
+    {
+        pybind11::dict d;
+        d["instance_count"] = stats.instanceCount;
+        d["culled_instance_count"] = stats.culledInstanceCount;
+        d["triangle_count"] = stats.triangleCount;
+        d["culled_triangle_count"] = stats.culledTriangleCount;
+        return d;
+    }
+
     inline pybind11::dict toPython(const Scene::SceneStats& stats)
     {
         pybind11::dict d;
@@ -4127,6 +4430,8 @@ namespace Falcor
         d["vertexMemoryInBytes"] = stats.vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = stats.geometryMemoryInBytes;
         d["animationMemoryInBytes"] = stats.animationMemoryInBytes;
+        d["meshletCount"] = stats.meshletCount;
+        d["meshletMemoryInBytes"] = stats.meshletMemoryInBytes;
 
         // Curve stats
         d["curveCount"] = stats.curveCount;
@@ -4156,6 +4461,11 @@ namespace Falcor
         d["textureTexelCount"] = stats.materials.textureTexelCount;
         d["textureTexelChannelCount"] = stats.materials.textureTexelChannelCount;
         d["textureMemoryInBytes"] = stats.materials.textureMemoryInBytes;
+        d["virtualTextureCount"] = stats.materials.virtualTextureCount;
+        d["virtualTextureMemoryInBytes"] = stats.materials.virtualTextureMemoryInBytes;
+        d["measuredBRDFCount"] = stats.materials.measuredBRDFCount;
+        d["measuredBRDFMemoryInBytes"] = stats.materials.measuredBRDFMemoryInBytes;
+        d["measuredBRDFMemorySavedInBytes"] = stats.materials.measuredBRDFMemorySavedInBytes;
 
         // Raytracing stats
         d["blasGroupCount"] = stats.blasGroupCount;
@@ -4296,6 +4606,8 @@ namespace Falcor
         FALCOR_SCRIPT_BINDING_DEPENDENCY(EnvMap)
         FALCOR_SCRIPT_BINDING_DEPENDENCY(SDFGrid)
 
+        pybind11::falcor_enum<Scene::DrawCullMode>(m, "DrawCullMode");
+
         // RenderSettings
         pybind11::class_<Scene::RenderSettings> renderSettings(m, "SceneRenderSettings");
         renderSettings.def_readwrite("useEnvLight", &Scene::RenderSettings::useEnvLight);
@@ -4352,6 +4664,17 @@ namespace Falcor
             pScene->setCameraBounds(AABB(minPoint, maxPoint));
             }, "minPoint"_a, "maxPoint"_a);
         scene.def("getGeometryUVTiles", &Scene::getGeometryUVTiles, "geometryID"_a);
+        scene.def("get_geometry_instance_bounds", [](const Scene* pScene, uint32_t instanceID) {
+            FALCOR_CHECK(instanceID < pScene->getGeometryInstanceCount(), "'instance_id' ({}) is out of range.", instanceID);
+            return pScene->getGeometryInstanceBounds(instanceID);
+            }, "instance_id"_a);
+        scene.def("cull_geometry_instances", &Scene::cullGeometryInstances, "camera"_a);
+        scene.def("find_geometry_instances_in_aabb", &Scene::findGeometryInstancesInAABB, "aabb"_a);
+        scene.def_property("draw_cull_mode", &Scene::getDrawCullMode, &Scene::setDrawCullMode);
+        scene.def_property_readonly("draw_cull_stats", [](const Scene* pScene) { return toPython(pScene->getDrawCullStats()); });
+        scene.def("pick_geometry_instance", [](const Scene* pScene, const float3& origin, const float3& dir) {
+            return pScene->pickGeometryInstance(Ray(origin, dir));
+            }, "origin"_a, "dir"_a);
         scene.def_property_readonly("memory_usage", &Scene::getMemoryUsageInBytes);
 
         // Materials
@@ -42,8 +42,10 @@
 #include "Volume/GridVolume.h"
 #include "Volume/Grid.h"
 #include "SDFs/SDFGrid.h"
+#include "InstanceBVH.h"
 
 #include "Core/Macros.h"
+#include "Core/Enum.h"
 #include "Core/Object.h"
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
@@ -51,9 +53,11 @@
 #include "Utils/Math/Rectangle.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
+#include "Utils/Math/Ray.h"
 #include "Utils/UI/Gui.h"
 #include "Utils/Settings/Settings.h"
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -339,6 +343,10 @@ namespace Falcor
             std::vector<PackedStaticVertexData> meshStaticData;     ///< Vertex attributes for all meshes in packed format.
             std::vector<SkinningVertexData> meshSkinningData;       ///< Additional vertex attributes for skinned meshes.
 
+            std::vector<MeshletDesc> meshlets;                      ///< List of meshlet descriptors, ordered by mesh ID. Only generated with SceneBuilder::Flags::GenerateMeshlets.
+            std::vector<uint32_t> meshletVertices;                  ///< Vertex indices of all meshlets, relative to the vbOffset of their mesh.
+            std::vector<uint32_t> meshletTriangles;                 ///< Triangles of all meshlets, packed as three 8-bit indices into the meshlet's vertices.
+
             // Curve data
             std::vector<CurveDesc> curveDesc;                       ///< List of curve descriptors.
             std::vector<AABB> curveBBs;                             ///< List of curve bounding boxes in object space. Each curve consists of many segments, each with its own AABB. The bounding boxes here are the unions of those.
@@ -376,6 +384,8 @@ namespace Falcor
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
+            uint64_t meshletCount = 0;                  ///< Number of meshlets.
+            uint64_t meshletMemoryInBytes = 0;          ///< Total memory in bytes used by the meshlet buffers.
 
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
@@ -438,8 +448,8 @@ namespace Falcor
             */
             uint64_t getTotalMemory() const
             {
-                return indexMemoryInBytes + vertexMemoryInBytes + geometryMemoryInBytes + animationMemoryInBytes +
-                    curveIndexMemoryInBytes + curveVertexMemoryInBytes + sdfGridMemoryInBytes + materials.materialMemoryInBytes + materials.textureMemoryInBytes +
+                return indexMemoryInBytes + vertexMemoryInBytes + geometryMemoryInBytes + animationMemoryInBytes + meshletMemoryInBytes +
+                    curveIndexMemoryInBytes + curveVertexMemoryInBytes + sdfGridMemoryInBytes + materials.materialMemoryInBytes + materials.textureMemoryInBytes + materials.virtualTextureMemoryInBytes +
                     blasMemoryInBytes + blasScratchMemoryInBytes + tlasMemoryInBytes + tlasScratchMemoryInBytes +
                     lightsMemoryInBytes + envMapMemoryInBytes + emissiveMemoryInBytes +
                     gridVolumeMemoryInBytes + gridMemoryInBytes;
@@ -721,6 +731,15 @@ namespace Falcor
         */
         const MeshDesc& getMesh(MeshID meshID) const { return mMeshDesc[meshID.get()]; }
 
+        /** Get the number of meshlets.
+            Meshlets are only generated when the scene is built with SceneBuilder::Flags::GenerateMeshlets.
+        */
+        uint32_t getMeshletCount() const { return (uint32_t)mMeshlets.size(); }
+
+        /** Get the list of meshlets, ordered by mesh ID.
+        */
+        const std::vector<MeshletDesc>& getMeshlets() const { return mMeshlets; }
+
         /** Get mesh vertex and index data.
             \param[in] meshID Mesh ID.
             \param[in] buffers Map of buffers containing mesh data: "triangleIndices", "positions", and "texcrds" are required.
@@ -902,6 +921,36 @@ namespace Falcor
         */
         const AABB& getCurveBounds(uint32_t curveID) const { return mCurveBBs[curveID]; }
 
+        /** Get a geometry instance's bounds in world space.
+            \param[in] instanceID Global geometry instance ID.
+        */
+        const AABB& getGeometryInstanceBounds(uint32_t instanceID) const { return mGeometryInstanceBBs[instanceID]; }
+
+        /** Get the CPU-side BVH over the world-space bounds of all geometry instances.
+            Item indices in the BVH are global geometry instance IDs. The BVH is refitted when geometry instances move,
+            and rebuilt when the set of instances with valid bounds changes.
+        */
+        const InstanceBVH& getInstanceBVH() const { return mInstanceBVH; }
+
+        /** Find all geometry instances whose world-space bounds intersect the view frustum of a camera.
+            \param[in] camera Camera to cull against.
+            \return List of global geometry instance IDs.
+        */
+        std::vector<uint32_t> cullGeometryInstances(const Camera& camera) const;
+
+        /** Find all geometry instances whose world-space bounds overlap a box.
+            \param[in] aabb World-space query box.
+            \return List of global geometry instance IDs.
+        */
+        std::vector<uint32_t> findGeometryInstancesInAABB(const AABB& aabb) const;
+
+        /** Find the geometry instance whose world-space bounds are hit closest to the ray origin.
+            Note that this tests the bounding boxes only, not the actual geometry.
+            \param[in] ray World-space ray.
+            \return Global geometry instance ID, or std::nullopt if no instance was hit.
+        */
+        std::optional<uint32_t> pickGeometryInstance(const Ray& ray) const;
+
         /** Get a list of all lights in the scene.
         */
         const std::vector<ref<Light>>& getLights() const { return mLights; };
@@ -981,6 +1030,48 @@ namespace Falcor
         */
         void updateForInverseRendering(RenderContext* pRenderContext, bool isMaterialChanged, bool isMeshChanged);
 
+        /** Draw-list culling mode used by rasterize().
+        */
+        enum class DrawCullMode : uint32_t
+        {
+            None = 0,       ///< Draw all mesh instances.
+            CPU = 1,        ///< Cull instances against the selected camera's frustum on the CPU using the instance BVH and upload compacted draw arguments.
+            GPU = 2,        ///< Cull and compact the draw arguments in a compute pass. The draw count stays on the GPU and is consumed by the indirect draw.
+        };
+
+        FALCOR_ENUM_INFO(DrawCullMode, {
+            { DrawCullMode::None, "None" },
+            { DrawCullMode::CPU, "CPU" },
+            { DrawCullMode::GPU, "GPU" },
+        });
+
+        /** Draw-list culling statistics.
+        */
+        struct DrawCullStats
+        {
+            uint32_t instanceCount = 0;             ///< Number of mesh instances in the draw list.
+            uint32_t culledInstanceCount = 0;       ///< Number of mesh instances culled.
+            uint64_t triangleCount = 0;             ///< Number of triangles in the draw list.
+            uint64_t culledTriangleCount = 0;       ///< Number of triangles culled.
+        };
+
+        /** Set the draw-list culling mode used by rasterize().
+            Culling is performed lazily in rasterize() against the frustum of the selected camera, and only
+            when the camera or the instance bounds have changed since the last culling pass. All draws issued
+            by rasterize() use the same culled lists, so passes that render the scene from other viewpoints
+            (e.g. shadow maps) should use DrawCullMode::None.
+        */
+        void setDrawCullMode(DrawCullMode mode);
+
+        /** Get the draw-list culling mode used by rasterize().
+        */
+        DrawCullMode getDrawCullMode() const { return mDrawCullMode; }
+
+        /** Get the draw-list culling statistics.
+            With DrawCullMode::GPU the statistics are read back asynchronously without stalling and lag a few frames behind.
+        */
+        const DrawCullStats& getDrawCullStats() const { return mDrawCullStats; }
+
         /** Render the scene using the rasterizer.
             Note the rasterizer state bound to 'pState' is ignored.
             \param[in] pRenderContext Render context.
@@ -1131,6 +1222,7 @@ namespace Falcor
 
         void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<SkinningVertexData>& skinningData);
         void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
+        void createMeshletBuffers(const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles);
         void createMeshUVTiles(const std::vector<MeshDesc>& meshDesc, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData);
 
         void updateSceneDefines();
@@ -1171,6 +1263,10 @@ namespace Falcor
         /** Create the draw list for rasterization.
         */
         void createDrawList();
+        void updateDrawCulling(RenderContext* pRenderContext);
+        void cullDrawListCPU();
+        void cullDrawListGPU(RenderContext* pRenderContext);
+        void readDrawCullStatsGPU(RenderContext* pRenderContext);
 
         /** Initialize geometry descs for each BLAS.
         */
@@ -1223,6 +1319,7 @@ namespace Falcor
         UpdateFlags updateGridVolumes(bool forceUpdate);
         UpdateFlags updateEnvMap(bool forceUpdate);
         UpdateFlags updateMaterials(bool forceUpdate);
+        void updateTextureUsage();
         UpdateFlags updateGeometry(RenderContext* pRenderContext, bool forceUpdate);
         UpdateFlags updateProceduralPrimitives(bool forceUpdate);
         UpdateFlags updateRaytracingAABBData(bool forceUpdate);
@@ -1256,6 +1353,12 @@ namespace Falcor
             uint32_t count = 0;             ///< Number of draws.
             bool ccw = true;                ///< True if counterclockwise triangle winding.
             ResourceFormat ibFormat = ResourceFormat::Unknown;  ///< Index buffer format.
+
+            std::vector<uint32_t> args;     ///< CPU copy of the draw-indirect arguments, used for culling.
+            uint32_t argStride = 0;         ///< Size of a single draw in words.
+            uint64_t triangleCount = 0;     ///< Total number of triangles drawn.
+            ref<Buffer> pCulledBuffer;      ///< Buffer holding the compacted draw-indirect arguments after culling.
+            uint32_t culledCount = 0;       ///< Number of draws in the compacted buffer (CPU culling only).
         };
 
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
@@ -1271,8 +1374,23 @@ namespace Falcor
         ref<Vao> mpCurveVao;                                        ///< Vertex array object for the global curve vertex/index buffers.
         std::vector<DrawArgs> mDrawArgs;                            ///< List of draw arguments for rasterizing the meshes in the scene.
 
+        // Draw-list culling
+        DrawCullMode mDrawCullMode = DrawCullMode::None;            ///< Draw-list culling mode used by rasterize().
+        DrawCullStats mDrawCullStats;                               ///< Draw-list culling statistics.
+        bool mDrawCullDirty = true;                                 ///< True if the culled draw lists need to be recomputed.
+        struct
+        {
+            ref<ComputePass> pPass;                                 ///< Compute pass for culling and compacting the draw arguments.
+            ref<Buffer> pInstanceBoundsBuffer;                      ///< GPU buffer of world-space geometry instance bounds.
+            bool instanceBoundsDirty = true;                        ///< True if the instance bounds need to be uploaded.
+            ref<Buffer> pCounterBuffer;                             ///< GPU buffer holding the draw counts followed by the visible triangle count.
+            std::array<ref<Buffer>, 3> pReadbackBuffers;            ///< Ring of CPU-mappable copies of the counter buffer for statistics.
+            std::array<uint64_t, 3> readbackFenceValues = {};       ///< Render context fence value at which each readback is complete, or 0 if the buffer is free.
+        } mGpuDrawCull;
+
         // Triangle meshes
         std::vector<MeshDesc> mMeshDesc;                            ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
+        std::vector<MeshletDesc> mMeshlets;                         ///< Copy of meshlet data GPU buffer (mpMeshletsBuffer).
         std::vector<std::vector<Rectangle>> mMeshUVTiles;           ///< Bounding tiles for the mesh UVs
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
         std::vector<std::string> mMeshNames;                        ///< Mesh names, indxed by mesh ID
@@ -1338,6 +1456,8 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        std::vector<AABB> mGeometryInstanceBBs;                     ///< Bounding boxes for geometry instances in world space.
+        InstanceBVH mInstanceBVH;                                   ///< CPU-side BVH over the geometry instance bounding boxes.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
@@ -1351,6 +1471,9 @@ namespace Falcor
         // Scene block resources
         ref<Buffer> mpGeometryInstancesBuffer;
         ref<Buffer> mpMeshesBuffer;
+        ref<Buffer> mpMeshletsBuffer;
+        ref<Buffer> mpMeshletVerticesBuffer;
+        ref<Buffer> mpMeshletTrianglesBuffer;
         ref<Buffer> mpCurvesBuffer;
         ref<Buffer> mpCustomPrimitivesBuffer;
         ref<Buffer> mpLightsBuffer;
@@ -1462,4 +1585,5 @@ namespace Falcor
     };
 
     FALCOR_ENUM_CLASS_OPERATORS(Scene::UpdateFlags);
+    FALCOR_ENUM_REGISTER(Scene::DrawCullMode);
 }
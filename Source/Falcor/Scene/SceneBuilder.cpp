@@ -28,20 +28,25 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshOptimizer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/TaskManager.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Metrics.h"
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
 #include <execution>
+#include <thread>
 
 namespace Falcor
 {
@@ -201,6 +206,137 @@ namespace Falcor
             return sha1.finalize();
 
         }
+
+        TextureCache::Options getTextureCacheOptions(SceneBuilder::Flags buildFlags)
+        {
+            TextureCache::Options options;
+            options.enabled = is_set(buildFlags, SceneBuilder::Flags::UseCache) || is_set(buildFlags, SceneBuilder::Flags::RebuildCache);
+            options.compress = is_set(buildFlags, SceneBuilder::Flags::CompressCachedTextures);
+            return options;
+        }
+
+        // CPU time spent on other threads on behalf of the build stage running on the current thread.
+        thread_local std::atomic<uint64_t>* tpStageWorkerCpuTimeNs = nullptr;
+
+        /** Runs func(i) for all i in [0, count) in parallel.
+            CPU time spent on worker threads is attributed to the calling build stage (if any).
+            Exceptions must not escape func, check for errors before the loop instead.
+        */
+        template<typename Func>
+        void parallelFor(uint32_t count, const Func& func)
+        {
+            auto pWorkerCpuTimeNs = tpStageWorkerCpuTimeNs;
+            const auto callerThreadID = std::this_thread::get_id();
+
+            NumericRange<uint32_t> range(0, count);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+            {
+                if (!pWorkerCpuTimeNs || std::this_thread::get_id() == callerThreadID) return func(i);
+                const double startCpuTime = getThreadCpuTime();
+                func(i);
+                pWorkerCpuTimeNs->fetch_add((uint64_t)((getThreadCpuTime() - startCpuTime) * 1e9));
+            });
+        }
+
+        /** Runs the scene build stages as a dependency graph on a TaskManager.
+            A stage is started as soon as all its dependencies have finished.
+            Stages must not use the render context, as they run on worker threads.
+            The wall and CPU time of each stage are added to a time report.
+        */
+        class BuildStageGraph
+        {
+        public:
+            using StageID = uint32_t;
+
+            StageID addStage(const std::string& name, std::function<void()> func, const std::vector<StageID>& dependencies = {})
+            {
+                const StageID id = (StageID)mStages.size();
+                Stage& stage = mStages.emplace_back();
+                stage.name = name;
+                stage.func = std::move(func);
+                stage.pendingCount = (uint32_t)dependencies.size();
+                for (StageID dependency : dependencies)
+                {
+                    FALCOR_ASSERT(dependency < id);
+                    mStages[dependency].dependents.push_back(id);
+                }
+                return id;
+            }
+
+            void run(TimeReport& timeReport)
+            {
+                TaskManager taskManager(true);
+                for (StageID id = 0; id < mStages.size(); id++)
+                {
+                    if (mStages[id].pendingCount == 0) schedule(taskManager, id);
+                }
+                taskManager.finish(nullptr);
+
+                if (mException) std::rethrow_exception(mException);
+                for (const auto& stage : mStages)
+                {
+                    FALCOR_ASSERT(stage.finished);
+                    timeReport.addMeasurement(stage.name, stage.wallTime, stage.cpuTime);
+                }
+            }
+
+        private:
+            struct Stage
+            {
+                std::string name;
+                std::function<void()> func;
+                std::vector<StageID> dependents;
+                uint32_t pendingCount = 0;
+                bool finished = false;
+                double wallTime = 0.0;
+                double cpuTime = 0.0;
+            };
+
+            void schedule(TaskManager& taskManager, StageID id)
+            {
+                taskManager.addTask([this, &taskManager, id]() { execute(taskManager, id); });
+            }
+
+            void execute(TaskManager& taskManager, StageID id)
+            {
+                Stage& stage = mStages[id];
+
+                std::atomic<uint64_t> workerCpuTimeNs = 0;
+                tpStageWorkerCpuTimeNs = &workerCpuTimeNs;
+                const auto startTime = CpuTimer::getCurrentTimePoint();
+                const double startCpuTime = getThreadCpuTime();
+
+                bool succeeded = true;
+                try
+                {
+                    stage.func();
+                }
+                catch (...)
+                {
+                    // Dependent stages are not scheduled, run() rethrows the exception once all running stages are done.
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    if (!mException) mException = std::current_exception();
+                    succeeded = false;
+                }
+
+                tpStageWorkerCpuTimeNs = nullptr;
+                stage.wallTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+                stage.cpuTime = getThreadCpuTime() - startCpuTime + workerCpuTimeNs * 1e-9;
+                if (!succeeded) return;
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                stage.finished = true;
+                for (StageID dependent : stage.dependents)
+                {
+                    FALCOR_ASSERT(mStages[dependent].pendingCount > 0);
+                    if (--mStages[dependent].pendingCount == 0) schedule(taskManager, dependent);
+                }
+            }
+
+            std::vector<Stage> mStages;
+            std::mutex mMutex;
+            std::exception_ptr mException;
+        };
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const Settings& settings, Flags flags)
@@ -209,7 +345,17 @@ namespace Falcor
         , mFlags(flags)
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
+        // Importers resolve the same textures and include files many times and assets don't change during a scene import.
+        mAssetResolver.setCacheEnabled(true);
+        // Record all resolved files, and the missing files that would change how paths resolve, for validating the scene cache.
+        mAssetResolver.setResolveCallback([this](const std::filesystem::path& resolvedPath, const std::vector<std::filesystem::path>& missingPaths)
+        {
+            std::lock_guard<std::mutex> lock(mDependenciesMutex);
+            if (!resolvedPath.empty()) mDependencies.insert(resolvedPath);
+            mMissingDependencies.insert(missingPaths.begin(), missingPaths.end());
+        });
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+        mSceneData.pMaterials->getTextureManager().setTextureCacheOptions(getTextureCacheOptions(flags));
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -222,6 +368,7 @@ namespace Falcor
         }
 
         // Compute scene cache key based on absolute scene path and build flags.
+        // The cache is only used if none of the files the scene was built from have changed, see SceneCache::hasValidCache().
         mSceneCacheKey = computeSceneCacheKey(resolvedPath, flags);
 
         // Determine if scene cache should be written after import.
@@ -234,7 +381,8 @@ namespace Falcor
         {
             try
             {
-                mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey));
+                mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey, getTextureCacheOptions(flags)));
+                FALCOR_METRIC_COUNT("scene_cache.hits", 1);
                 return;
             }
             catch (const std::exception& e)
@@ -243,6 +391,9 @@ namespace Falcor
             }
         }
 
+        if (useCache)
+            FALCOR_METRIC_COUNT("scene_cache.misses", 1);
+
         import(path);
     }
 
@@ -319,6 +470,13 @@ namespace Falcor
         mAssetResolverStack.pop_back();
     }
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        // Called from the asset resolver, which may be used from multiple threads.
+        std::lock_guard<std::mutex> lock(mDependenciesMutex);
+        mDependencies.insert(path);
+    }
+
     ref<Scene> SceneBuilder::getScene()
     {
         if (mpScene) return mpScene;
@@ -341,30 +499,49 @@ namespace Falcor
         }
 
         // Post-process the scene data.
+        // The geometry processing stages run as a dependency graph. Stages touching disjoint data run concurrently,
+        // e.g. curves and volumes overlap with the mesh processing chain.
         TimeReport timeReport;
+        TimeReport stageReport;
+
+        BuildStageGraph stages;
 
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
-        prepareDisplacementMaps();
-
-        prepareSceneGraph();
-        prepareMeshes();
-        removeUnusedMeshes();
-        flattenStaticMeshInstances();
-        pretransformStaticMeshes();
-        unifyTriangleWinding();
-        optimizeSceneGraph();
-        calculateMeshBoundingBoxes();
-        createMeshGroups();
-        optimizeGeometry();
-        sortMeshes();
-        createGlobalBuffers();
-        createCurveGlobalBuffers();
-        collectVolumeGrids();
-        removeDuplicateSDFGrids();
+        auto displacement = stages.addStage("prepareDisplacementMaps", [this] { prepareDisplacementMaps(); });
+
+        // Mesh processing chain.
+        auto sceneGraph = stages.addStage("prepareSceneGraph", [this] { prepareSceneGraph(); });
+        auto meshes = stages.addStage("prepareMeshes", [this] { prepareMeshes(); }, { sceneGraph });
+        auto unusedMeshes = stages.addStage("removeUnusedMeshes", [this] { removeUnusedMeshes(); }, { meshes });
+        auto flatten = stages.addStage("flattenStaticMeshInstances", [this] { flattenStaticMeshInstances(); }, { unusedMeshes });
+        auto pretransform = stages.addStage("pretransformStaticMeshes", [this] { pretransformStaticMeshes(); }, { flatten });
+        // Scene graph optimization runs concurrently with the per-mesh stages, they write disjoint mesh data.
+        auto optimizeGraph = stages.addStage("optimizeSceneGraph", [this] { optimizeSceneGraph(); }, { pretransform });
+        auto winding = stages.addStage("unifyTriangleWinding", [this] { unifyTriangleWinding(); }, { pretransform });
+        auto locality = stages.addStage("optimizeMeshLocality", [this] { optimizeMeshLocality(); }, { winding });
+        auto bounds = stages.addStage("calculateMeshBoundingBoxes", [this] { calculateMeshBoundingBoxes(); }, { locality });
+        // Mesh groups depend on the displacement state of the materials prior to optimization.
+        auto meshGroups = stages.addStage("createMeshGroups", [this] { createMeshGroups(); }, { optimizeGraph, bounds, displacement });
+        auto optimizeGeom = stages.addStage("optimizeGeometry", [this] { optimizeGeometry(); }, { meshGroups });
+        auto sort = stages.addStage("sortMeshes", [this] { sortMeshes(); }, { optimizeGeom });
+        auto meshlets = stages.addStage("createMeshlets", [this] { createMeshlets(); }, { sort });
+        auto globalBuffers = stages.addStage("createGlobalBuffers", [this] { createGlobalBuffers(); }, { meshlets });
+
+        // Stages independent of the mesh processing.
+        auto curveBuffers = stages.addStage("createCurveGlobalBuffers", [this] { createCurveGlobalBuffers(); });
+        stages.addStage("collectVolumeGrids", [this] { collectVolumeGrids(); });
+        // Removing duplicate SDF grids updates the grid references in the scene graph and the scene data,
+        // it runs once all other geometry stages are done.
+        stages.addStage("removeDuplicateSDFGrids", [this] { removeDuplicateSDFGrids(); }, { globalBuffers, curveBuffers });
+
+        stages.run(stageReport);
+        stageReport.printToLog();
 
         timeReport.measure("Post processing geometry");
 
+        // The material stages run serially after the geometry stages. Material optimization uses the render context,
+        // and removing duplicates remaps the material IDs of all geometry.
         optimizeMaterials();
         removeDuplicateMaterials();
         quantizeTexCoords();
@@ -390,7 +567,9 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            std::vector<std::filesystem::path> dependencies(mDependencies.begin(), mDependencies.end());
+            std::vector<std::filesystem::path> missingDependencies(mMissingDependencies.begin(), mMissingDependencies.end());
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies, missingDependencies);
             timeReport.measure("Writing cache");
         }
 
@@ -1653,7 +1832,8 @@ namespace Falcor
         NodeID identityNodeID = addNode(Node{ "Identity", float4x4::identity(), float4x4::identity() });
         auto& identityNode = mSceneGraph[identityNodeID.get()];
 
-        size_t transformedMeshCount = 0;
+        // The vertices are transformed in parallel after the scene graph has been updated.
+        std::vector<std::pair<MeshID, float4x4>> meshTransforms;
         for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
         {
             auto& mesh = mMeshes[meshID.get()];
@@ -1687,22 +1867,7 @@ namespace Falcor
             {
                 FALCOR_ASSERT(!mesh.staticData.empty());
                 FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
-
-                float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
-                float3x3 transform3x3 = float3x3(transform);
-
-                for (auto& v : mesh.staticData)
-                {
-                    v.position = transformPoint(transform, v.position);
-                    v.normal = normalize(transformVector(invTranspose3x3, v.normal));
-                    v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
-                    // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
-                    // Leaving that out for now for consistency with the shader code that needs the same fix.
-
-                    v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
-                }
-
-                transformedMeshCount++;
+                meshTransforms.emplace_back(meshID, transform);
             }
 
             // Unlink mesh from its previous transform node.
@@ -1719,7 +1884,25 @@ namespace Falcor
             mesh.instances.insert(identityNodeID);
         }
 
-        if (transformedMeshCount > 0) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshCount);
+        parallelFor((uint32_t)meshTransforms.size(), [&](uint32_t i)
+        {
+            const auto& [meshID, transform] = meshTransforms[i];
+            float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
+            float3x3 transform3x3 = float3x3(transform);
+
+            for (auto& v : mMeshes[meshID.get()].staticData)
+            {
+                v.position = transformPoint(transform, v.position);
+                v.normal = normalize(transformVector(invTranspose3x3, v.normal));
+                v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
+                // TODO: We should flip the sign of v.tangent.w if the transform flips the winding.
+                // Leaving that out for now for consistency with the shader code that needs the same fix.
+
+                v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
+            }
+        });
+
+        if (!meshTransforms.empty()) logInfo("Pre-transformed {} static meshes to world space.", meshTransforms.size());
     }
 
     void SceneBuilder::flipTriangleWinding(MeshSpec& mesh)
@@ -1787,27 +1970,94 @@ namespace Falcor
         // Note that this pass needs to run *after* pre-transformation of static meshes to world space,
         // as those transforms may flip the winding.
 
-        size_t flippedMeshCount = 0;
+        // Collect meshes that are not already front face counter-clockwise.
+        std::vector<uint32_t> flippedMeshIDs;
         for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
         {
-            auto& mesh = mMeshes[meshID];
-
-            // Skip meshes that are already front face counter-clockwise.
+            const auto& mesh = mMeshes[meshID];
             if (mesh.isFrontFaceCW == false) continue;
 
+            // flipTriangleWinding() throws for non-indexed meshes. Check this up front as exceptions can't escape the parallel loop.
+            if (mesh.indexCount == 0) FALCOR_THROW("SceneBuilder::flipTriangleWinding() is not implemented for non-indexed meshes");
+            flippedMeshIDs.push_back(meshID);
+        }
+
+        parallelFor((uint32_t)flippedMeshIDs.size(), [&](uint32_t i)
+        {
+            auto& mesh = mMeshes[flippedMeshIDs[i]];
             flipTriangleWinding(mesh);
             FALCOR_ASSERT(!mesh.isFrontFaceCW);
+        });
+
+        if (!flippedMeshIDs.empty()) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshIDs.size(), mMeshes.size());
+    }
+
+    void SceneBuilder::optimizeMeshLocality()
+    {
+        // This function reorders the triangles and vertices of static indexed meshes for better memory locality.
+        // Triangles are clustered in Morton order for coherent BVH builds and traversal, and reordered within
+        // each cluster for the post-transform vertex cache. Vertices are then stored in the order they are used.
+        // The result only depends on the mesh data, so it is safe to store in the scene cache.
+        //
+        // Dynamic meshes are skipped, as skinning data and vertex animation caches refer to the original vertex order.
 
-            flippedMeshCount++;
+        if (!is_set(mFlags, Flags::OptimizeMeshLocality)) return;
+
+        std::vector<uint32_t> meshIDs;
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        {
+            const auto& mesh = mMeshes[meshID];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isDynamic()) continue;
+            FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
+            meshIDs.push_back(meshID);
         }
 
-        if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount, mMeshes.size());
+        std::atomic<uint64_t> missesBefore = 0;
+        std::atomic<uint64_t> missesAfter = 0;
+        std::atomic<uint64_t> triangleCount = 0;
+
+        parallelFor((uint32_t)meshIDs.size(), [&](uint32_t i)
+        {
+            auto& mesh = mMeshes[meshIDs[i]];
+
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t j = 0; j < mesh.indexCount; j++) indices[j] = mesh.getIndex(j);
+
+            std::vector<float3> positions(mesh.vertexCount);
+            for (uint32_t j = 0; j < mesh.vertexCount; j++) positions[j] = mesh.staticData[j].position;
+
+            missesBefore += MeshOptimizer::countVertexCacheMisses(indices, mesh.vertexCount);
+            std::vector<uint32_t> remap = MeshOptimizer::optimizeLocality(indices, positions);
+            missesAfter += MeshOptimizer::countVertexCacheMisses(indices, mesh.vertexCount);
+            triangleCount += mesh.indexCount / 3;
+
+            std::vector<StaticVertexData> staticData(mesh.vertexCount);
+            for (uint32_t j = 0; j < mesh.vertexCount; j++) staticData[remap[j]] = mesh.staticData[j];
+            mesh.staticData = std::move(staticData);
+
+            if (mesh.use16BitIndices)
+            {
+                uint16_t* pIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+                for (uint32_t j = 0; j < mesh.indexCount; j++) pIndices[j] = (uint16_t)indices[j];
+            }
+            else
+            {
+                mesh.indexData = std::move(indices);
+            }
+        });
+
+        if (triangleCount > 0)
+        {
+            logInfo("Optimized mesh locality for {} out of {} meshes. Vertex cache miss ratio changed from {:.3f} to {:.3f}.",
+                meshIDs.size(), mMeshes.size(), double(missesBefore) / triangleCount, double(missesAfter) / triangleCount);
+        }
     }
 
     void SceneBuilder::calculateMeshBoundingBoxes()
     {
-        for (auto& mesh : mMeshes)
+        parallelFor((uint32_t)mMeshes.size(), [&](uint32_t meshID)
         {
+            auto& mesh = mMeshes[meshID];
             FALCOR_ASSERT(!mesh.staticData.empty());
             FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
 
@@ -1818,7 +2068,7 @@ namespace Falcor
             }
 
             mesh.boundingBox = meshBB;
-        }
+        });
     }
 
     void SceneBuilder::createMeshGroups()
@@ -2383,11 +2633,51 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::createMeshlets()
+    {
+        // This function splits static indexed triangle meshes into meshlets for cluster culling.
+        // Meshlets are built per mesh in parallel and concatenated in mesh order in createGlobalBuffers(),
+        // so the result is deterministic and can be stored in the scene cache.
+        //
+        // Dynamic meshes are skipped, as their bounds change at runtime.
+
+        if (!is_set(mFlags, Flags::GenerateMeshlets)) return;
+
+        std::vector<uint32_t> meshIDs;
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        {
+            const auto& mesh = mMeshes[meshID];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isDynamic()) continue;
+            meshIDs.push_back(meshID);
+        }
+
+        parallelFor((uint32_t)meshIDs.size(), [&](uint32_t i)
+        {
+            auto& mesh = mMeshes[meshIDs[i]];
+
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t j = 0; j < mesh.indexCount; j++) indices[j] = mesh.getIndex(j);
+
+            std::vector<float3> positions(mesh.vertexCount);
+            for (uint32_t j = 0; j < mesh.vertexCount; j++) positions[j] = mesh.staticData[j].position;
+
+            MeshOptimizer::Meshlets meshlets = MeshOptimizer::buildMeshlets(indices, positions);
+            mesh.meshlets = std::move(meshlets.meshlets);
+            mesh.meshletVertices = std::move(meshlets.vertices);
+            mesh.meshletTriangles = std::move(meshlets.triangles);
+        });
+
+        size_t meshletCount = 0;
+        for (uint32_t meshID : meshIDs) meshletCount += mMeshes[meshID].meshlets.size();
+        logInfo("Generated {} meshlets for {} out of {} meshes.", meshletCount, meshIDs.size(), mMeshes.size());
+    }
+
     void SceneBuilder::createGlobalBuffers()
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
         FALCOR_ASSERT(mSceneData.meshStaticData.empty());
         FALCOR_ASSERT(mSceneData.meshSkinningData.empty());
+        FALCOR_ASSERT(mSceneData.meshlets.empty());
 
         const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
 
@@ -2395,19 +2685,27 @@ namespace Falcor
         size_t totalIndexDataCount = 0;
         size_t totalStaticVertexCount = 0;
         size_t totalSkinningVertexCount = 0;
+        size_t totalMeshletCount = 0;
+        size_t totalMeshletVertexCount = 0;
+        size_t totalMeshletTriangleCount = 0;
 
         for (const auto& mesh : mMeshes)
         {
             totalIndexDataCount += mesh.indexData.size();
             totalStaticVertexCount += mesh.staticData.size();
             totalSkinningVertexCount += mesh.skinningData.size();
+            totalMeshletCount += mesh.meshlets.size();
+            totalMeshletVertexCount += mesh.meshletVertices.size();
+            totalMeshletTriangleCount += mesh.meshletTriangles.size();
             mSceneData.prevVertexCount += mesh.prevVertexCount;
         }
 
         // Check the range. We currently use 32-bit offsets.
         if (totalIndexDataCount > std::numeric_limits<uint32_t>::max() ||
             totalStaticVertexCount > std::numeric_limits<uint32_t>::max() ||
-            totalSkinningVertexCount > std::numeric_limits<uint32_t>::max())
+            totalSkinningVertexCount > std::numeric_limits<uint32_t>::max() ||
+            totalMeshletVertexCount > std::numeric_limits<uint32_t>::max() ||
+            totalMeshletTriangleCount > std::numeric_limits<uint32_t>::max())
         {
             FALCOR_THROW("Trying to build a scene that exceeds supported mesh data size.");
         }
@@ -2415,10 +2713,14 @@ namespace Falcor
         mSceneData.meshIndexData.reserve(totalIndexDataCount);
         mSceneData.meshStaticData.reserve(totalStaticVertexCount);
         mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
+        mSceneData.meshlets.reserve(totalMeshletCount);
+        mSceneData.meshletVertices.reserve(totalMeshletVertexCount);
+        mSceneData.meshletTriangles.reserve(totalMeshletTriangleCount);
 
         // Copy all vertex and index data into the global buffers.
-        for (auto& mesh : mMeshes)
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
         {
+            auto& mesh = mMeshes[meshID];
             mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
             mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
@@ -2445,10 +2747,26 @@ namespace Falcor
                 }
             }
 
+            // Insert the meshlets and patch their offsets to the global arrays.
+            const uint32_t meshletVertexOffset = (uint32_t)mSceneData.meshletVertices.size();
+            const uint32_t meshletTriangleOffset = (uint32_t)mSceneData.meshletTriangles.size();
+            for (MeshletDesc meshlet : mesh.meshlets)
+            {
+                meshlet.meshID = meshID;
+                meshlet.vertexOffset += meshletVertexOffset;
+                meshlet.triangleOffset += meshletTriangleOffset;
+                mSceneData.meshlets.push_back(meshlet);
+            }
+            mSceneData.meshletVertices.insert(mSceneData.meshletVertices.end(), mesh.meshletVertices.begin(), mesh.meshletVertices.end());
+            mSceneData.meshletTriangles.insert(mSceneData.meshletTriangles.end(), mesh.meshletTriangles.begin(), mesh.meshletTriangles.end());
+
             // Free the mesh local data.
             mesh.indexData.clear();
             mesh.staticData.clear();
             mesh.skinningData.clear();
+            mesh.meshlets.clear();
+            mesh.meshletVertices.clear();
+            mesh.meshletTriangles.clear();
         }
 
         // Initialize offsets for prev vertex data for vertex-animated meshes
@@ -2939,6 +3257,9 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("OptimizeMeshLocality", SceneBuilder::Flags::OptimizeMeshLocality);
+        flags.value("GenerateMeshlets", SceneBuilder::Flags::GenerateMeshlets);
+        flags.value("CompressCachedTextures", SceneBuilder::Flags::CompressCachedTextures);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2970,6 +3291,7 @@ namespace Falcor
         sceneBuilder.def("addLight", &SceneBuilder::addLight, "light"_a);
         sceneBuilder.def("getLight", &SceneBuilder::getLight, "name"_a);
         sceneBuilder.def("loadLightProfile", &SceneBuilder::loadLightProfile, "filename"_a, "normalize"_a = true);
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
         sceneBuilder.def("addCamera", &SceneBuilder::addCamera, "camera"_a);
         sceneBuilder.def("addAnimation", &SceneBuilder::addAnimation, "animation"_a);
         sceneBuilder.def("createAnimation", &SceneBuilder::createAnimation, "animatable"_a, "name"_a, "duration"_a);
@@ -47,6 +47,8 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -77,8 +79,11 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            OptimizeMeshLocality            = 0x20000,  ///< Reorder triangles and vertices of static meshes for vertex cache efficiency and spatial locality. This increases load time but is cached by the scene cache.
+            GenerateMeshlets                = 0x40000,  ///< Split static triangle meshes into meshlets with bounding spheres and normal cones for cluster culling. Combine with OptimizeMeshLocality for tighter meshlets.
+            CompressCachedTextures          = 0x80000,  ///< Block compress 8-bit textures stored in the texture cache (BC4/BC5/BC7). This is lossy and only has an effect together with UseCache.
 
-            UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
+            UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation and pre-mipped textures on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
 
             Default = None
@@ -367,6 +372,13 @@ namespace Falcor
         /// Pop the state of the asset resolver from the stack.
         void popAssetResolver();
 
+        /** Add a file the scene depends on. The scene cache is invalidated when any of these files change.
+            All paths resolved with the asset resolver are added automatically. Importers that read files without the
+            asset resolver need to add them explicitly.
+            \param[in] path Absolute path of the file.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Get the scene. Make sure to add all the objects before calling this function
             \return nullptr if something went wrong, otherwise a new Scene object
         */
@@ -712,6 +724,11 @@ namespace Falcor
             std::vector<StaticVertexData> staticData;
             std::vector<SkinningVertexData> skinningData;
 
+            // Meshlets, see createMeshlets(). The offsets and mesh ID are assigned in createGlobalBuffers().
+            std::vector<MeshletDesc> meshlets;
+            std::vector<uint32_t> meshletVertices;
+            std::vector<uint32_t> meshletTriangles;
+
             uint32_t getTriangleCount() const
             {
                 FALCOR_ASSERT(topology == Vao::Topology::TriangleList);
@@ -773,6 +790,9 @@ namespace Falcor
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        std::set<std::filesystem::path> mDependencies; ///< Files the scene depends on, written to the scene cache.
+        std::set<std::filesystem::path> mMissingDependencies; ///< Files that must not exist for the scene cache to be valid.
+        std::mutex mDependenciesMutex;
 
         SceneGraph mSceneGraph;
 
@@ -816,10 +836,12 @@ namespace Falcor
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
         void unifyTriangleWinding();
+        void optimizeMeshLocality();
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
         void sortMeshes();
+        void createMeshlets();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
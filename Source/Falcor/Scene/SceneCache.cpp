@@ -30,11 +30,17 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
 #include <lz4_stream/lz4_stream.h>
 
+#include <algorithm>
+#include <execution>
 #include <fstream>
+#include <random>
+#include <sstream>
 
 namespace Falcor
 {
@@ -43,7 +49,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 31;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -51,17 +57,55 @@ namespace Falcor
 
         const size_t kBlockSize = 1 * 1024 * 1024;
 
+        /** File extension of the dependency manifest stored next to the cache file.
+        */
+        const std::string kManifestExtension = ".manifest";
+
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            uint64_t cacheId{};     ///< Random ID of the cache file, stored in both the cache file and its dependency manifest.
 
             bool isValid() const
             {
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        int64_t getLastWriteTime(const std::filesystem::path& path, std::error_code& ec)
+        {
+            return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        }
+
+        Header createHeader(uint64_t cacheId)
+        {
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            header.cacheId = cacheId;
+            return header;
+        }
+
+        uint64_t createCacheId()
+        {
+            std::random_device rd;
+            return (uint64_t(rd()) << 32) | rd();
+        }
+
+        bool hashFile(const std::filesystem::path& path, XXH3::Hash128& hash)
+        {
+            try
+            {
+                hash = XXH3::hashFile(path);
+                return true;
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+        }
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -197,43 +241,100 @@ namespace Falcor
         auto cachePath = getCachePath(key);
         if (!std::filesystem::exists(cachePath)) return false;
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) return false;
-
         // Verify header.
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        {
+            std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!fs || !header.isValid()) return false;
+        }
+
+        // Read the dependency manifest that was written with the cache file.
+        auto manifestPath = getManifestPath(key);
+        auto manifest = readManifestFile(manifestPath, header.cacheId);
+        if (!manifest)
+        {
+            logInfo("Scene cache '{}' has no valid dependency manifest.", cachePath);
+            return false;
+        }
+
+        // Verify that the files the scene was built from are unchanged.
+        std::filesystem::path changedPath;
+        bool updated = false;
+        if (!validateDependencies(*manifest, &changedPath, &updated))
+        {
+            logInfo("Scene cache '{}' is out of date, '{}' has changed.", cachePath, changedPath);
+            return false;
+        }
+
+        // Store the updated last write times of touched files.
+        if (updated)
+        {
+            try
+            {
+                writeManifestFile(manifestPath, header.cacheId, *manifest);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to update the dependency manifest of scene cache '{}': {}", cachePath, e.what());
+            }
+        }
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies, const std::vector<std::filesystem::path>& missingDependencies)
     {
         auto cachePath = getCachePath(key);
+        auto manifestPath = getManifestPath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
         // Create directories if not existing.
         std::filesystem::create_directories(cachePath.parent_path());
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
+        // Write the cache file and then its dependency manifest. Both are replaced atomically and tied together by the cache ID,
+        // so readers never see a partially written file or a manifest that belongs to another version of the cache.
+        const Header header = createHeader(createCacheId());
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeFileAtomic(cachePath, [&](const std::filesystem::path& tempPath)
+        {
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            if (!fs.is_open()) FALCOR_THROW("Failed to create scene cache file '{}'.", tempPath);
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
+            // Write header (uncompressed).
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            // Write cache (compressed).
+            {
+                lz4_stream::basic_ostream<kBlockSize> zs(fs);
+                OutputStream stream(zs);
+                writeSceneData(stream, sceneData);
+            }
+            if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", tempPath);
+        });
+
+        auto manifest = createDependencyManifest(dependencies, missingDependencies);
+        writeManifestFile(manifestPath, header.cacheId, manifest);
+
+        // Compute the baseline hashes in the background. Validation only checks file sizes and last write times,
+        // the hashes allow touched but unchanged files to be recognized later.
+        Threading::dispatchTask([manifestPath, cacheId = header.cacheId, manifest]() mutable
+        {
+            try
+            {
+                if (!hashDependencies(manifest)) return;
+                // Skip the update if the cache has been replaced in the meantime.
+                if (!readManifestFile(manifestPath, cacheId)) return;
+                writeManifestFile(manifestPath, cacheId, manifest);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to store dependency hashes in '{}': {}", manifestPath, e.what());
+            }
+        }, Threading::Priority::Low);
     }
 
-    Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
+    Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key, const TextureCache::Options& textureCacheOptions)
     {
         auto cachePath = getCachePath(key);
 
@@ -251,7 +352,7 @@ namespace Falcor
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
+        auto sceneData = readSceneData(stream, pDevice, textureCacheOptions);
         if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
         return sceneData;
     }
@@ -261,6 +362,210 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::getManifestPath(const Key& key)
+    {
+        return getAppDataDirectory() / kDirectory / (SHA1::toString(key) + kManifestExtension);
+    }
+
+    // Dependencies
+
+    SceneCache::DependencyManifest SceneCache::createDependencyManifest(const std::vector<std::filesystem::path>& paths, const std::vector<std::filesystem::path>& missingPaths)
+    {
+        DependencyManifest manifest;
+        for (const auto& path : paths)
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file(path, ec)) continue;
+            Dependency dependency;
+            dependency.path = path;
+            dependency.size = std::filesystem::file_size(path, ec);
+            if (!ec) dependency.lastWriteTime = getLastWriteTime(path, ec);
+            if (ec) continue;
+            manifest.push_back(std::move(dependency));
+        }
+
+        for (const auto& path : missingPaths)
+        {
+            std::error_code ec;
+            if (std::filesystem::exists(path, ec) || ec) continue;
+            Dependency dependency;
+            dependency.path = path;
+            dependency.exists = false;
+            manifest.push_back(std::move(dependency));
+        }
+
+        std::sort(manifest.begin(), manifest.end(), [](const Dependency& a, const Dependency& b) { return a.path < b.path; });
+        auto last = std::unique(manifest.begin(), manifest.end(), [](const Dependency& a, const Dependency& b) { return a.path == b.path; });
+        manifest.erase(last, manifest.end());
+
+        return manifest;
+    }
+
+    bool SceneCache::validateDependencies(DependencyManifest& manifest, std::filesystem::path* pChangedPath, bool* pUpdated)
+    {
+        if (pUpdated) *pUpdated = false;
+        auto reportChanged = [pChangedPath](const Dependency& dependency)
+        {
+            if (pChangedPath) *pChangedPath = dependency.path;
+            return false;
+        };
+
+        // Run the cheap checks first and collect the files that need to be hashed.
+        struct HashRequest
+        {
+            Dependency* pDependency;
+            int64_t lastWriteTime;
+            XXH3::Hash128 hash;
+            bool valid = false;
+        };
+        std::vector<HashRequest> requests;
+
+        for (auto& dependency : manifest)
+        {
+            std::error_code ec;
+            if (!dependency.exists)
+            {
+                if (std::filesystem::exists(dependency.path, ec) || ec) return reportChanged(dependency);
+                continue;
+            }
+
+            uint64_t size = std::filesystem::file_size(dependency.path, ec);
+            if (ec || size != dependency.size) return reportChanged(dependency);
+            int64_t lastWriteTime = getLastWriteTime(dependency.path, ec);
+            if (ec) return reportChanged(dependency);
+
+            // Unchanged.
+            if (lastWriteTime == dependency.lastWriteTime) continue;
+
+            // Touched. Without a hash of the original content the file has to be considered changed.
+            if (!dependency.hashed) return reportChanged(dependency);
+            requests.push_back({ &dependency, lastWriteTime });
+        }
+
+        // Hash the files in parallel, scenes often reference many large textures.
+        std::for_each(std::execution::par, requests.begin(), requests.end(), [](HashRequest& request)
+        {
+            request.valid = hashFile(request.pDependency->path, request.hash);
+        });
+
+        for (const auto& request : requests)
+        {
+            Dependency& dependency = *request.pDependency;
+            if (!request.valid || request.hash != dependency.hash) return reportChanged(dependency);
+        }
+
+        for (const auto& request : requests) request.pDependency->lastWriteTime = request.lastWriteTime;
+        if (pUpdated) *pUpdated = !requests.empty();
+        return true;
+    }
+
+    bool SceneCache::hashDependencies(DependencyManifest& manifest)
+    {
+        std::vector<Dependency*> dependencies;
+        for (auto& dependency : manifest)
+        {
+            if (dependency.exists && !dependency.hashed) dependencies.push_back(&dependency);
+        }
+
+        auto isUnchanged = [](const Dependency& dependency)
+        {
+            std::error_code ec;
+            if (std::filesystem::file_size(dependency.path, ec) != dependency.size || ec) return false;
+            return getLastWriteTime(dependency.path, ec) == dependency.lastWriteTime && !ec;
+        };
+
+        // Only store hashes of files that are unchanged since the manifest was created, before and after hashing.
+        std::for_each(std::execution::par, dependencies.begin(), dependencies.end(), [&](Dependency* pDependency)
+        {
+            XXH3::Hash128 hash;
+            if (isUnchanged(*pDependency) && hashFile(pDependency->path, hash) && isUnchanged(*pDependency))
+            {
+                pDependency->hash = hash;
+                pDependency->hashed = true;
+            }
+        });
+
+        return std::any_of(dependencies.begin(), dependencies.end(), [](const Dependency* pDependency) { return pDependency->hashed; });
+    }
+
+    void SceneCache::writeDependencyManifest(OutputStream& stream, const DependencyManifest& manifest)
+    {
+        stream.write((uint64_t)manifest.size());
+        for (const auto& dependency : manifest)
+        {
+            stream.write(dependency.path);
+            stream.write(dependency.exists);
+            stream.write(dependency.size);
+            stream.write(dependency.lastWriteTime);
+            stream.write(dependency.hashed);
+            stream.write(dependency.hash);
+        }
+    }
+
+    SceneCache::DependencyManifest SceneCache::readDependencyManifest(InputStream& stream, uint64_t sizeInBytes)
+    {
+        // The manifest is read from a file that may be damaged, so counts and lengths are checked against its size before allocating.
+        const uint64_t kMinDependencySize = sizeof(uint64_t) + sizeof(bool) + sizeof(uint64_t) + sizeof(int64_t) + sizeof(bool) + sizeof(XXH3::Hash128);
+        uint64_t count = stream.read<uint64_t>();
+        if (count > sizeInBytes / kMinDependencySize) FALCOR_THROW("Invalid dependency count {}.", count);
+
+        DependencyManifest manifest(count);
+        for (auto& dependency : manifest)
+        {
+            uint64_t len = stream.read<uint64_t>();
+            if (len > sizeInBytes) FALCOR_THROW("Invalid path length {}.", len);
+            std::string path(len, '\0');
+            stream.read(path.data(), len);
+            dependency.path = path;
+            stream.read(dependency.exists);
+            stream.read(dependency.size);
+            stream.read(dependency.lastWriteTime);
+            stream.read(dependency.hashed);
+            stream.read(dependency.hash);
+        }
+        return manifest;
+    }
+
+    void SceneCache::writeManifestFile(const std::filesystem::path& path, uint64_t cacheId, const DependencyManifest& manifest)
+    {
+        std::ostringstream ss(std::ios_base::binary);
+        const Header header = createHeader(cacheId);
+        ss.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        OutputStream stream(ss);
+        writeDependencyManifest(stream, manifest);
+
+        // Replace the file atomically, so that concurrent readers see either the old or the new manifest.
+        const std::string data = ss.str();
+        writeFileAtomic(path, data.data(), data.size());
+    }
+
+    std::optional<SceneCache::DependencyManifest> SceneCache::readManifestFile(const std::filesystem::path& path, uint64_t cacheId)
+    {
+        std::ifstream fs(path.c_str(), std::ios_base::binary);
+        if (!fs.is_open()) return {};
+
+        std::error_code ec;
+        const uint64_t sizeInBytes = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+
+        Header header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs || !header.isValid() || header.cacheId != cacheId) return {};
+
+        try
+        {
+            InputStream stream(fs);
+            auto manifest = readDependencyManifest(stream, sizeInBytes);
+            if (!fs) return {};
+            return manifest;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to read dependency manifest '{}': {}", path, e.what());
+            return {};
+        }
+    }
+
     // SceneData
 
     void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
@@ -350,6 +655,9 @@ namespace Falcor
         stream.write(sceneData.meshIndexData);
         stream.write(sceneData.meshStaticData);
         stream.write(sceneData.meshSkinningData);
+        stream.write(sceneData.meshlets);
+        stream.write(sceneData.meshletVertices);
+        stream.write(sceneData.meshletTriangles);
 
         writeMarker(stream, "Curves");
         stream.write(sceneData.curveDesc);
@@ -376,10 +684,11 @@ namespace Falcor
         writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice, const TextureCache::Options& textureCacheOptions)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+        sceneData.pMaterials->getTextureManager().setTextureCacheOptions(textureCacheOptions);
 
         readMarker(stream, "Path");
         stream.read(sceneData.path);
@@ -471,6 +780,9 @@ namespace Falcor
         stream.read(sceneData.meshIndexData);
         stream.read(sceneData.meshStaticData);
         stream.read(sceneData.meshSkinningData);
+        stream.read(sceneData.meshlets);
+        stream.read(sceneData.meshletVertices);
+        stream.read(sceneData.meshletTriangles);
 
         readMarker(stream, "Curves");
         stream.read(sceneData.curveDesc);
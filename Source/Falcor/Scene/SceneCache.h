@@ -42,6 +42,7 @@
 #include "Utils/CryptoUtils.h"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -50,39 +51,104 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        A manifest of the files the scene was built from is stored next to the cache file. A cache is only valid if none of
+        these files have changed since the cache was written.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** Input file of a scene cache.
+            Paths that were probed while resolving assets but didn't exist are recorded with 'exists' set to false.
+            Creating one of them would change how the scene resolves its assets, so they must still not exist.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;
+            bool exists = true;             ///< True if the file must exist and be unchanged, false if it must not exist.
+            uint64_t size = 0;              ///< File size in bytes.
+            int64_t lastWriteTime = 0;      ///< Last write time in file clock ticks.
+            bool hashed = false;            ///< True if the content hash has been computed, see hashDependencies().
+            XXH3::Hash128 hash;             ///< Hash of the file content.
+        };
+
+        using DependencyManifest = std::vector<Dependency>;
+
         /** Check if there is a valid scene cache for a given cache key.
+            The dependency manifest of the cache is validated, see validateDependencies(). Updates to the manifest
+            made by the validation are written back to the manifest file, which is replaced atomically.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
         static bool hasValidCache(const Key& key);
 
         /** Write a scene cache.
+            The cache file and its dependency manifest are replaced atomically. The dependencies are hashed in a background task,
+            see hashDependencies().
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Files the scene was built from. Paths that are not regular files are ignored.
+            \param[in] missingDependencies Files that must not exist. Paths that exist are ignored.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies = {}, const std::vector<std::filesystem::path>& missingDependencies = {});
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
             \param[in] key Cache key.
+            \param[in] textureCacheOptions Options of the texture cache used for loading material textures.
             \return Returns the loaded scene data.
         */
-        static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
+        static Scene::SceneData readCache(ref<Device> pDevice, const Key& key, const TextureCache::Options& textureCacheOptions = {});
+
+        /** Create a dependency manifest by recording the size and last write time of a list of files.
+            The files are not hashed, this is deferred to hashDependencies().
+            \param[in] paths Paths of the files. Paths that are not regular files are ignored.
+            \param[in] missingPaths Paths of files that must not exist. Paths that exist are ignored.
+            \return Returns the manifest, sorted by path.
+        */
+        static DependencyManifest createDependencyManifest(const std::vector<std::filesystem::path>& paths, const std::vector<std::filesystem::path>& missingPaths = {});
+
+        /** Check that none of the files in a dependency manifest have changed, and that none of the missing files exist.
+            Files with the recorded size and last write time are assumed to be unchanged, so they are not read. The content of
+            files with a different last write time is hashed and compared with the hash computed by hashDependencies(), so that
+            touching a file doesn't invalidate the cache. Touched files that have not been hashed yet are considered changed.
+            The last write times of touched but unchanged files are stored in the manifest, so that they are not hashed again.
+            \param[in,out] manifest Dependency manifest.
+            \param[out] pChangedPath Optional path of the first changed or created file.
+            \param[out] pUpdated Optional flag set to true if the manifest was updated.
+            \return Returns true if all files are unchanged.
+        */
+        static bool validateDependencies(DependencyManifest& manifest, std::filesystem::path* pChangedPath = nullptr, bool* pUpdated = nullptr);
+
+        /** Compute the content hashes of the files in a dependency manifest that have not been hashed yet.
+            Files that have changed since the manifest was created are not hashed, so validation considers them changed.
+            \param[in,out] manifest Dependency manifest.
+            \return Returns true if any hash was computed.
+        */
+        static bool hashDependencies(DependencyManifest& manifest);
 
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getManifestPath(const Key& key);
+
+        static void writeDependencyManifest(OutputStream& stream, const DependencyManifest& manifest);
+        static DependencyManifest readDependencyManifest(InputStream& stream, uint64_t sizeInBytes);
+
+        /** Write a dependency manifest file atomically. Throws an exception if the file cannot be written.
+        */
+        static void writeManifestFile(const std::filesystem::path& path, uint64_t cacheId, const DependencyManifest& manifest);
+
+        /** Read a dependency manifest file.
+            \return Returns the manifest, or an empty optional if the file is missing, damaged or belongs to another cache file.
+        */
+        static std::optional<DependencyManifest> readManifestFile(const std::filesystem::path& path, uint64_t cacheId);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice, const TextureCache::Options& textureCacheOptions);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
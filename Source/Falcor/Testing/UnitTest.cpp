@@ -30,6 +30,7 @@
 #include "Core/Platform/OS.h"
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
+#include "Core/API/GpuTimer.h"
 #include "Core/Program/ProgramManager.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Threading.h"
@@ -38,15 +39,20 @@
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/Vector.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <fmt/format.h>
 #include <fmt/color.h>
+#include <nlohmann/json.hpp>
 #include <pugixml.hpp>
 #include <BS_thread_pool_light.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <regex>
+#include <thread>
 #include <cstdint>
 
 namespace Falcor
@@ -76,6 +82,7 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::vector<BenchmarkResult> benchmarks;
 };
 
 static std::vector<TestDesc>& getTestRegistry()
@@ -211,7 +218,108 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+inline nlohmann::json toJson(const BenchmarkStats& stats)
+{
+    return {
+        {"min", stats.min},
+        {"max", stats.max},
+        {"mean", stats.mean},
+        {"median", stats.median},
+        {"stdDev", stats.stdDev},
+    };
+}
+
+/**
+ * Write a benchmark report in JSON format. The report can be used as a baseline for later runs.
+ * @param[in] path File path.
+ * @param[in] results List of benchmark results.
+ */
+inline void writeBenchmarkReport(const std::filesystem::path& path, const std::vector<BenchmarkResult>& results)
+{
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const auto& result : results)
+    {
+        nlohmann::json j = {
+            {"name", result.name},
+            {"warmup", result.warmup},
+            {"iterations", result.iterations},
+            {"cpu", toJson(result.cpu)},
+        };
+        if (result.gpu)
+            j["gpu"] = toJson(*result.gpu);
+        if (result.itemCount > 0)
+        {
+            j["itemCount"] = result.itemCount;
+            j["itemsPerSecond"] = result.getTime() > 0.0 ? result.itemCount * 1000.0 / result.getTime() : 0.0;
+        }
+        if (result.baseline)
+        {
+            j["baseline"] = *result.baseline;
+            j["change"] = *result.baseline > 0.0 ? result.getTime() / *result.baseline - 1.0 : 0.0;
+        }
+        benchmarks.push_back(std::move(j));
+    }
+
+    nlohmann::json report = {
+        {"version", getLongVersionString()},
+        {"benchmarks", std::move(benchmarks)},
+    };
+
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs)
+        FALCOR_THROW("Failed to open benchmark report '{}' for writing.", path);
+    ofs << report.dump(4) << std::endl;
+}
+
+/**
+ * Read the baseline times from a benchmark report written by writeBenchmarkReport().
+ * @param[in] path File path.
+ * @return Map of benchmark names to times in ms.
+ */
+inline std::map<std::string, double> readBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs)
+        FALCOR_THROW("Failed to open benchmark baseline '{}'.", path);
+
+    std::map<std::string, double> baseline;
+    try
+    {
+        nlohmann::json report = nlohmann::json::parse(ifs);
+        for (const auto& j : report.at("benchmarks"))
+        {
+            const auto& stats = j.contains("gpu") ? j["gpu"] : j.at("cpu");
+            baseline[j.at("name").get<std::string>()] = stats.at("median").get<double>();
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        FALCOR_THROW("Failed to parse benchmark baseline '{}': {}", path, e.what());
+    }
+    return baseline;
+}
+
+/// Get the benchmark config for a test. Command line overrides take precedence over the per-test settings.
+inline BenchmarkConfig getBenchmarkConfig(const Test& test, const RunOptions& options, const std::map<std::string, double>* pBaseline)
+{
+    BenchmarkConfig config;
+    config.name = fmt::format("{}:{}", test.suiteName, test.name);
+    config.warmup = options.benchmarkWarmup.value_or(test.benchmarkWarmup.value_or(config.warmup));
+    config.iterations = std::max(1u, options.benchmarkIterations.value_or(test.benchmarkIterations.value_or(config.iterations)));
+    config.regressionThreshold = options.benchmarkRegressionThreshold;
+    config.pBaseline = pBaseline;
+    return config;
+}
+
+/// Select either the benchmarks or the regular tests.
+inline std::vector<Test> selectBenchmarks(std::vector<Test> tests, bool benchmark)
+{
+    auto isExcluded = [benchmark](const Test& test) { return (test.tags.count("benchmark") == 1) != benchmark; };
+    tests.erase(std::remove_if(tests.begin(), tests.end(), isExcluded), tests.end());
+    return tests;
+}
+
+inline TestResult runTest(const Test& test, DevicePool& devicePool, const BenchmarkConfig& benchmarkConfig)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
@@ -224,6 +332,8 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
 
     CPUUnitTestContext cpuCtx;
     GPUUnitTestContext gpuCtx(pDevice);
+    cpuCtx.setBenchmarkConfig(benchmarkConfig);
+    gpuCtx.setBenchmarkConfig(benchmarkConfig);
 
     auto startTime = std::chrono::steady_clock::now();
 
@@ -261,6 +371,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     }
 
     result.messages = test.cpuFunc ? cpuCtx.getFailureMessages() : gpuCtx.getFailureMessages();
+    result.benchmarks = test.cpuFunc ? cpuCtx.getBenchmarkResults() : gpuCtx.getBenchmarkResults();
 
     if (!result.messages.empty())
         result.status = TestResult::Status::Failed;
@@ -301,6 +412,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
     tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = selectBenchmarks(std::move(tests), options.benchmark);
 
     std::vector<TestResult> results(tests.size());
 
@@ -311,7 +423,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
     {
         threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
+            [&abort, &options, &tests, &results, &devicePool, testIndex]()
             {
                 if (abort)
                     return;
@@ -322,7 +434,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
                 reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+                result = runTest(test, devicePool, getBenchmarkConfig(test, options, nullptr));
 
                 std::string statusTag;
                 switch (result.status)
@@ -393,6 +505,11 @@ inline int32_t runTestsSerial(const RunOptions& options)
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
     tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = selectBenchmarks(std::move(tests), options.benchmark);
+
+    std::map<std::string, double> baseline;
+    if (options.benchmark && !options.benchmarkBaselinePath.empty())
+        baseline = readBenchmarkBaseline(options.benchmarkBaselinePath);
 
     // Split tests into suites.
     std::map<std::string, std::vector<Test>> suites;
@@ -430,7 +547,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, getBenchmarkConfig(test, options, &baseline));
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -474,6 +591,14 @@ inline int32_t runTestsSerial(const RunOptions& options)
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
 
+    if (options.benchmark && !options.benchmarkReportPath.empty())
+    {
+        std::vector<BenchmarkResult> benchmarks;
+        for (const auto& [test, result] : report)
+            benchmarks.insert(benchmarks.end(), result.benchmarks.begin(), result.benchmarks.end());
+        writeBenchmarkReport(options.benchmarkReportPath, benchmarks);
+    }
+
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)",
         testCount,
@@ -507,7 +632,8 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    // Benchmarks are always run serially to avoid interference between measurements.
+    int32_t failureCount = options.parallel > 1 && !options.benchmark ? runTestsParallel(options) : runTestsSerial(options);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -528,6 +654,8 @@ std::vector<Test> enumerateTests()
         test.name = desc.name;
         test.tags = desc.options.tags;
         test.skipMessage = desc.options.skipMessage;
+        test.benchmarkWarmup = desc.options.benchmarkWarmup;
+        test.benchmarkIterations = desc.options.benchmarkIterations;
         test.deviceType = Device::Type::Default;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
@@ -643,6 +771,110 @@ void UnitTestContext::reportFailure(const std::string& message)
         debugBreak();
 }
 
+void UnitTestContext::measure(
+    const std::string& name,
+    const std::function<void()>& setup,
+    const std::function<void()>& func,
+    uint64_t itemCount
+)
+{
+    const BenchmarkConfig& config = mBenchmarkConfig;
+
+    for (uint32_t i = 0; i < config.warmup; ++i)
+    {
+        if (setup)
+            setup();
+        func();
+    }
+
+    std::vector<double> times(config.iterations);
+    for (double& time : times)
+    {
+        if (setup)
+            setup();
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        func();
+        time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.warmup = config.warmup;
+    result.iterations = config.iterations;
+    result.itemCount = itemCount;
+    result.cpu = BenchmarkStats::compute(std::move(times));
+    addBenchmarkResult(std::move(result));
+}
+
+void UnitTestContext::addBenchmarkResult(BenchmarkResult result)
+{
+    const BenchmarkConfig& config = mBenchmarkConfig;
+    if (!config.name.empty())
+        result.name = fmt::format("{}/{}", config.name, result.name);
+
+    const double time = result.getTime();
+    std::string line = fmt::format("[  BENCH   ] {}: {:.3f} ms", result.name, time);
+    if (result.gpu)
+        line += fmt::format(" GPU, {:.3f} ms CPU", result.cpu.median);
+    line += fmt::format(" (min {:.3f}, max {:.3f}, stddev {:.3f})", result.cpu.min, result.cpu.max, result.cpu.stdDev);
+    if (result.itemCount > 0 && time > 0.0)
+        line += fmt::format(", {:.4g} items/s", result.itemCount * 1000.0 / time);
+
+    bool regressed = false;
+    if (config.pBaseline)
+    {
+        auto it = config.pBaseline->find(result.name);
+        if (it != config.pBaseline->end() && it->second > 0.0)
+        {
+            result.baseline = it->second;
+            double change = time / it->second - 1.0;
+            line += fmt::format(", {:+.1f}% vs. baseline", change * 100.0);
+            regressed = change > config.regressionThreshold;
+        }
+    }
+    reportLine("{}", line);
+
+    if (regressed)
+    {
+        reportFailure(fmt::format(
+            "Benchmark '{}' regressed: {:.3f} ms vs. {:.3f} ms baseline (threshold {:.1f}%).",
+            result.name,
+            time,
+            *result.baseline,
+            config.regressionThreshold * 100.0
+        ));
+    }
+
+    mBenchmarkResults.push_back(std::move(result));
+}
+
+BenchmarkStats BenchmarkStats::compute(std::vector<double> times)
+{
+    BenchmarkStats stats;
+    if (times.empty())
+        return stats;
+
+    std::sort(times.begin(), times.end());
+    const size_t n = times.size();
+    stats.min = times.front();
+    stats.max = times.back();
+    stats.median = n % 2 == 1 ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+
+    double sum = 0.0;
+    for (double time : times)
+        sum += time;
+    stats.mean = sum / n;
+
+    double sumSq = 0.0;
+    for (double time : times)
+        sumSq += (time - stats.mean) * (time - stats.mean);
+    stats.stdDev = n > 1 ? std::sqrt(sumSq / (n - 1)) : 0.0;
+
+    return stats;
+}
+
+void useCharPointer(const volatile char*) {}
+
 ///////////////////////////////////////////////////////////////////////////
 
 void GPUUnitTestContext::createProgram(
@@ -724,6 +956,46 @@ void GPUUnitTestContext::runProgram(const uint3& dimensions)
     mpDevice->getRenderContext()->dispatch(mpState.get(), mpVars.get(), groups);
 }
 
+void GPUUnitTestContext::measureGPU(const std::string& name, const std::function<void(RenderContext*)>& func, uint64_t itemCount)
+{
+    const BenchmarkConfig& config = getBenchmarkConfig();
+    RenderContext* pRenderContext = getRenderContext();
+    ref<GpuTimer> pTimer = GpuTimer::create(mpDevice);
+
+    // Wait for previously submitted work so that it doesn't end up in the measurement.
+    pRenderContext->submit(true);
+
+    auto runIteration = [&](double& cpuTime, double& gpuTime)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        pTimer->begin();
+        func(pRenderContext);
+        pTimer->end();
+        pTimer->resolve();
+        pRenderContext->submit(true);
+        cpuTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        gpuTime = pTimer->getElapsedTime();
+    };
+
+    double cpuTime, gpuTime;
+    for (uint32_t i = 0; i < config.warmup; ++i)
+        runIteration(cpuTime, gpuTime);
+
+    std::vector<double> cpuTimes(config.iterations);
+    std::vector<double> gpuTimes(config.iterations);
+    for (uint32_t i = 0; i < config.iterations; ++i)
+        runIteration(cpuTimes[i], gpuTimes[i]);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.warmup = config.warmup;
+    result.iterations = config.iterations;
+    result.itemCount = itemCount;
+    result.cpu = BenchmarkStats::compute(std::move(cpuTimes));
+    result.gpu = BenchmarkStats::compute(std::move(gpuTimes));
+    addBenchmarkResult(std::move(result));
+}
+
 } // namespace unittest
 
 /**
@@ -798,4 +1070,41 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_TEST(TestBenchmarkStats)
+{
+    auto stats = unittest::BenchmarkStats::compute({4.0, 1.0, 3.0, 2.0});
+    EXPECT_EQ(stats.min, 1.0);
+    EXPECT_EQ(stats.max, 4.0);
+    EXPECT_EQ(stats.mean, 2.5);
+    EXPECT_EQ(stats.median, 2.5);
+    EXPECT_LT(std::abs(stats.stdDev - 1.2909944), 1e-6);
+
+    // Setup and measured functions are called for the warmup and timed iterations.
+    std::map<std::string, double> baseline = {{"Test:Bench/fast", 1e6}};
+    unittest::BenchmarkConfig config;
+    config.name = "Test:Bench";
+    config.warmup = 1;
+    config.iterations = 3;
+    config.pBaseline = &baseline;
+
+    CPUUnitTestContext benchCtx;
+    benchCtx.setBenchmarkConfig(config);
+    uint32_t setupCount = 0;
+    uint32_t runCount = 0;
+    benchCtx.measure("fast", [&]() { setupCount++; }, [&]() { runCount++; });
+    EXPECT_EQ(setupCount, 4);
+    EXPECT_EQ(runCount, 4);
+    EXPECT(benchCtx.getFailureMessages().empty());
+    benchCtx.measure("slow", [&]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }, 10);
+
+    const auto& results = benchCtx.getBenchmarkResults();
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results[0].name, "Test:Bench/fast");
+    EXPECT_EQ(results[0].iterations, 3);
+    EXPECT(results[0].baseline.has_value());
+    EXPECT(!results[1].baseline.has_value());
+    EXPECT_EQ(results[1].itemCount, 10);
+    EXPECT_GE(results[1].cpu.min, 1.0);
+}
+
 } // namespace Falcor
@@ -40,6 +40,7 @@
 #include <filesystem>
 #include <functional>
 #include <map>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -93,6 +94,13 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+
+    bool benchmark = false;                      ///< Run benchmarks instead of tests.
+    std::optional<uint32_t> benchmarkWarmup;     ///< Override the number of warmup iterations of all benchmarks.
+    std::optional<uint32_t> benchmarkIterations; ///< Override the number of timed iterations of all benchmarks.
+    std::filesystem::path benchmarkReportPath;   ///< Write the benchmark results to this JSON file.
+    std::filesystem::path benchmarkBaselinePath; ///< Compare the benchmark results against this JSON file (written by a previous run).
+    double benchmarkRegressionThreshold = 0.1;   ///< Relative slowdown over the baseline that is reported as a failure.
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
@@ -110,6 +118,8 @@ struct Test
     std::set<std::string> tags;
     std::string skipMessage;
     Device::Type deviceType;
+    std::optional<uint32_t> benchmarkWarmup;
+    std::optional<uint32_t> benchmarkIterations;
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
@@ -127,6 +137,44 @@ FALCOR_API std::vector<Test> filterTests(
     Device::Type deviceType
 );
 
+/// Statistics over the iterations of a benchmark measurement. All times are in ms.
+struct BenchmarkStats
+{
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double stdDev = 0.0;
+
+    FALCOR_API static BenchmarkStats compute(std::vector<double> times);
+};
+
+struct BenchmarkResult
+{
+    std::string name; ///< Full name "<suite>:<test>/<measurement>".
+    uint32_t warmup = 0;
+    uint32_t iterations = 0;
+    uint64_t itemCount = 0;            ///< Number of items processed per iteration (0 if unknown).
+    BenchmarkStats cpu;                ///< CPU wall clock time.
+    std::optional<BenchmarkStats> gpu; ///< GPU time (only for GPU measurements).
+    std::optional<double> baseline;    ///< Baseline time in ms (if a baseline was given).
+
+    /// Returns the time used for comparisons, i.e. the median GPU time for GPU measurements and the median CPU time otherwise.
+    double getTime() const { return gpu ? gpu->median : cpu.median; }
+};
+
+struct BenchmarkConfig
+{
+    std::string name; ///< Test name "<suite>:<test>", used as prefix for the measurement names.
+    uint32_t warmup = 2;
+    uint32_t iterations = 10;
+    double regressionThreshold = 0.1;
+    const std::map<std::string, double>* pBaseline = nullptr; ///< Baseline times in ms by measurement name.
+};
+
+/// Opaque function used to keep benchmarked values alive, see doNotOptimize().
+FALCOR_API void useCharPointer(const volatile char* p);
+
 class FALCOR_API UnitTestContext
 {
 public:
@@ -144,10 +192,35 @@ public:
 
     std::vector<std::string> getFailureMessages() const { return mFailureMessages; }
 
+    /**
+     * Measure the CPU time of a function.
+     * The function is run for the configured number of warmup iterations, followed by the timed iterations.
+     * The result is reported and compared against the baseline. A regression over the threshold is reported as a failure.
+     * @param[in] name Measurement name, unique within the test.
+     * @param[in] func Function to measure.
+     * @param[in] itemCount Number of items processed per call, used to report the throughput (optional).
+     */
+    void measure(const std::string& name, const std::function<void()>& func, uint64_t itemCount = 0) { measure(name, {}, func, itemCount); }
+
+    /**
+     * Measure the CPU time of a function, calling a setup function before each iteration.
+     * The time spent in the setup function is not included in the measurement.
+     */
+    void measure(const std::string& name, const std::function<void()>& setup, const std::function<void()>& func, uint64_t itemCount = 0);
+
+    void setBenchmarkConfig(BenchmarkConfig config) { mBenchmarkConfig = std::move(config); }
+    const BenchmarkConfig& getBenchmarkConfig() const { return mBenchmarkConfig; }
+    const std::vector<BenchmarkResult>& getBenchmarkResults() const { return mBenchmarkResults; }
+
     int mNumFailures = 0;
 
+protected:
+    void addBenchmarkResult(BenchmarkResult result);
+
 private:
     std::vector<std::string> mFailureMessages;
+    BenchmarkConfig mBenchmarkConfig;
+    std::vector<BenchmarkResult> mBenchmarkResults;
 };
 
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
@@ -268,6 +341,15 @@ public:
      */
     ProgramVars* getVars() const { return mpVars.get(); }
 
+    /**
+     * Measure the CPU and GPU time of a function recording GPU work, see UnitTestContext::measure().
+     * Each iteration is submitted and waited for. The GPU time is measured with a GPU timer around the recorded work.
+     * @param[in] name Measurement name, unique within the test.
+     * @param[in] func Function recording the GPU work to measure.
+     * @param[in] itemCount Number of items processed per call, used to report the throughput (optional).
+     */
+    void measureGPU(const std::string& name, const std::function<void(RenderContext*)>& func, uint64_t itemCount = 0);
+
 private:
     // Internal state
     ref<Device> mpDevice;
@@ -310,11 +392,23 @@ struct DeviceTypes
     std::set<Device::Type> deviceTypes;
 };
 
+struct BenchmarkWarmup
+{
+    uint32_t count;
+};
+
+struct BenchmarkIterations
+{
+    uint32_t count;
+};
+
 struct Options
 {
     std::set<std::string> tags;
     std::string skipMessage;
     std::set<Device::Type> deviceTypes;
+    std::optional<uint32_t> benchmarkWarmup;
+    std::optional<uint32_t> benchmarkIterations;
 };
 
 inline void applyArg(Options& options, Tags&& arg)
@@ -332,6 +426,16 @@ inline void applyArg(Options& options, DeviceTypes&& arg)
     options.deviceTypes.insert(arg.deviceTypes.begin(), arg.deviceTypes.end());
 }
 
+inline void applyArg(Options& options, BenchmarkWarmup&& arg)
+{
+    options.benchmarkWarmup = arg.count;
+}
+
+inline void applyArg(Options& options, BenchmarkIterations&& arg)
+{
+    options.benchmarkIterations = arg.count;
+}
+
 inline void applyArg(Options& options, Device::Type deviceType)
 {
     options.deviceTypes.insert(deviceType);
@@ -534,6 +638,15 @@ using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
 
+/**
+ * Prevent the compiler from optimizing away the computation of a value in a benchmark.
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    unittest::useCharPointer(&reinterpret_cast<const volatile char&>(value));
+}
+
 /**
  * Macro to define a CPU unit test. The optional arguments include:
  *
@@ -609,6 +722,25 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterGPUTest##name;                                                    \
     static void GPUUnitTest##name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macros to define benchmarks. Benchmarks are CPU/GPU tests tagged with "benchmark", they take the same optional
+ * arguments as CPU_TEST/GPU_TEST and additionally:
+ *
+ * - BENCHMARK_WARMUP(n): Number of untimed warmup iterations (default 2).
+ * - BENCHMARK_ITERATIONS(n): Number of timed iterations (default 10).
+ *
+ * Benchmarks are only run when FalcorTest is run with --benchmark. Each benchmark records one or more
+ * measurements using ctx.measure() (CPU time) or ctx.measureGPU() (CPU and GPU time):
+ *
+ * CPU_BENCHMARK(Bench1, BENCHMARK_ITERATIONS(100))
+ * {
+ *     std::vector<float> data = ...; // Not measured.
+ *     ctx.measure("sort", [&]() { std::vector<float> copy = data; std::sort(copy.begin(), copy.end()); }, data.size());
+ * }
+ */
+#define CPU_BENCHMARK(name, ...) CPU_TEST(name, TAGS("benchmark"), ##__VA_ARGS__)
+#define GPU_BENCHMARK(name, ...) GPU_TEST(name, TAGS("benchmark"), ##__VA_ARGS__)
+
 // clang-format off
 
 /// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
@@ -617,6 +749,10 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
 #define SKIP(msg) ::Falcor::unittest::Skip{msg}
 /// Used as an argument of GPU_TEST to mark a test to only run for certain devices.
 #define DEVICE_TYPES(...) ::Falcor::unittest::DeviceTypes{__VA_ARGS__}
+/// Used as an argument of CPU_BENCHMARK/GPU_BENCHMARK to set the number of warmup iterations.
+#define BENCHMARK_WARMUP(n) ::Falcor::unittest::BenchmarkWarmup{n}
+/// Used as an argument of CPU_BENCHMARK/GPU_BENCHMARK to set the number of timed iterations.
+#define BENCHMARK_ITERATIONS(n) ::Falcor::unittest::BenchmarkIterations{n}
 
 // clang-format on
 
@@ -0,0 +1,444 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BatchScheduler.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+namespace Falcor
+{
+namespace
+{
+const std::vector<std::string> kJobKeys = {
+    "name", "scene", "graph", "graphName", "camera", "resolution", "framerate", "frames", "outputs", "outputDirectory", "baseFilename",
+};
+const std::vector<std::string> kOptionKeys = {"reorder", "maxResidentScenes", "maxResidentGraphs", "stopOnError"};
+
+std::string getSceneKey(const BatchJob& job)
+{
+    return job.scene.lexically_normal().generic_string();
+}
+
+std::string getGraphKey(const BatchJob& job)
+{
+    return job.graph.lexically_normal().generic_string() + "#" + job.graphName;
+}
+
+uint64_t getSizeKey(const BatchJob& job)
+{
+    return (uint64_t(job.width) << 32) | job.height;
+}
+
+bool isSamePath(const std::filesystem::path& a, const std::filesystem::path& b)
+{
+    return a.lexically_normal() == b.lexically_normal();
+}
+
+/// Split items into groups with the same key. The groups are ordered by first appearance, the items keep their order.
+template<typename Key, typename GetKey>
+std::vector<std::vector<size_t>> groupBy(const std::vector<size_t>& items, GetKey getKey)
+{
+    std::vector<std::vector<size_t>> groups;
+    std::map<Key, size_t> groupIndices;
+    for (size_t item : items)
+    {
+        auto [it, inserted] = groupIndices.try_emplace(getKey(item), groups.size());
+        if (inserted)
+            groups.emplace_back();
+        groups[it->second].push_back(item);
+    }
+    return groups;
+}
+
+void checkKeys(const nlohmann::json& j, const std::vector<std::string>& keys, const std::string& what)
+{
+    for (const auto& [key, value] : j.items())
+    {
+        if (std::find(keys.begin(), keys.end(), key) == keys.end())
+            FALCOR_THROW("Unknown {} key '{}'.", what, key);
+    }
+}
+
+BatchJob parseJob(const nlohmann::json& j, size_t index, const std::filesystem::path& directory)
+{
+    if (!j.is_object())
+        FALCOR_THROW("Job {} is not an object.", index);
+    checkKeys(j, kJobKeys, "job");
+
+    BatchJob job;
+    job.name = j.value("name", fmt::format("job{}", index));
+    job.scene = j.value("scene", std::string());
+    if (!j.contains("graph"))
+        FALCOR_THROW("Job '{}' has no graph.", job.name);
+    job.graph = directory / j["graph"].get<std::string>();
+    job.graphName = j.value("graphName", std::string());
+    job.camera = j.value("camera", std::string());
+    if (j.contains("resolution"))
+    {
+        auto resolution = j["resolution"].get<std::vector<uint32_t>>();
+        if (resolution.size() != 2 || resolution[0] == 0 || resolution[1] == 0)
+            FALCOR_THROW("Job '{}' has an invalid resolution.", job.name);
+        job.width = resolution[0];
+        job.height = resolution[1];
+    }
+    job.framerate = j.value("framerate", job.framerate);
+    if (job.framerate == 0)
+        FALCOR_THROW("Job '{}' has an invalid framerate.", job.name);
+    if (j.contains("frames"))
+        job.captureFrames = j["frames"].get<std::vector<uint64_t>>();
+    for (size_t i = 0; i < job.captureFrames.size(); i++)
+    {
+        if (job.captureFrames[i] == 0 || (i > 0 && job.captureFrames[i] <= job.captureFrames[i - 1]))
+            FALCOR_THROW("Job '{}' frames must be positive and strictly increasing.", job.name);
+    }
+    job.outputs = j.value("outputs", std::vector<std::string>());
+    job.outputDirectory = directory / j.value("outputDirectory", std::string("."));
+    job.baseFilename = j.value("baseFilename", std::string());
+    return job;
+}
+} // namespace
+
+std::vector<BatchJob> BatchScheduler::loadJobs(const std::filesystem::path& path, Options& options)
+{
+    std::ifstream ifs(path);
+    if (!ifs)
+        FALCOR_THROW("Failed to open batch job file '{}'.", path);
+
+    const std::filesystem::path directory = std::filesystem::absolute(path).parent_path();
+    std::vector<BatchJob> jobs;
+    try
+    {
+        nlohmann::json j = nlohmann::json::parse(ifs, nullptr /*callback*/, true /*allow exceptions*/, true /*ignore comments*/);
+        if (j.is_object())
+        {
+            nlohmann::json jobList = j.value("jobs", nlohmann::json::array());
+            j.erase("jobs");
+            checkKeys(j, kOptionKeys, "option");
+            options.reorder = j.value("reorder", options.reorder);
+            options.maxResidentScenes = j.value("maxResidentScenes", options.maxResidentScenes);
+            options.maxResidentGraphs = j.value("maxResidentGraphs", options.maxResidentGraphs);
+            options.stopOnError = j.value("stopOnError", options.stopOnError);
+            j = std::move(jobList);
+        }
+        if (!j.is_array())
+            FALCOR_THROW("Expected a list of jobs.");
+        for (size_t i = 0; i < j.size(); i++)
+            jobs.push_back(parseJob(j[i], i, directory));
+    }
+    catch (const std::exception& e)
+    {
+        FALCOR_THROW("Failed to load batch job file '{}': {}", path, e.what());
+    }
+    return jobs;
+}
+
+std::vector<size_t> BatchScheduler::schedule(const std::vector<BatchJob>& jobs) const
+{
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++)
+        order[i] = i;
+    if (!mOptions.reorder)
+        return order;
+
+    auto sceneGroups = groupBy<std::string>(order, [&](size_t i) { return getSceneKey(jobs[i]); });
+
+    // Start with the scene that is already active, if any.
+    if (!mScenes.empty())
+    {
+        auto it = std::find_if(
+            sceneGroups.begin(),
+            sceneGroups.end(),
+            [&](const auto& group) { return isSamePath(jobs[group[0]].scene, mScenes.front().path); }
+        );
+        if (it != sceneGroups.end())
+            std::rotate(sceneGroups.begin(), it, it + 1);
+    }
+
+    order.clear();
+    std::string lastGraph = mGraphs.empty() ? "" : mGraphs.front().path.generic_string() + "#" + mGraphs.front().name;
+    for (const auto& sceneGroup : sceneGroups)
+    {
+        // Start with the graph used by the previous job to avoid switching graphs between scenes.
+        auto graphGroups = groupBy<std::string>(sceneGroup, [&](size_t i) { return getGraphKey(jobs[i]); });
+        auto it = std::find_if(
+            graphGroups.begin(), graphGroups.end(), [&](const auto& group) { return getGraphKey(jobs[group[0]]) == lastGraph; }
+        );
+        if (it != graphGroups.end())
+            std::rotate(graphGroups.begin(), it, it + 1);
+
+        for (const auto& graphGroup : graphGroups)
+        {
+            // Group by frame buffer size, resizing reallocates the graph resources.
+            for (const auto& sizeGroup : groupBy<uint64_t>(graphGroup, [&](size_t i) { return getSizeKey(jobs[i]); }))
+                order.insert(order.end(), sizeGroup.begin(), sizeGroup.end());
+        }
+        lastGraph = getGraphKey(jobs[order.back()]);
+    }
+    return order;
+}
+
+std::vector<BatchScheduler::JobResult> BatchScheduler::run(BatchRenderer& renderer, const std::vector<BatchJob>& jobs)
+{
+    std::vector<JobResult> results;
+    results.reserve(jobs.size());
+    const auto batchStartTime = CpuTimer::getCurrentTimePoint();
+    bool failed = false;
+
+    for (size_t index : schedule(jobs))
+    {
+        const BatchJob& job = jobs[index];
+        JobResult result;
+        result.name = job.name;
+        result.index = index;
+        mStats.jobCount++;
+
+        if (failed && mOptions.stopOnError)
+        {
+            result.skipped = true;
+            result.error = "Skipped after an earlier job failed.";
+            mStats.failedCount++;
+            results.push_back(std::move(result));
+            continue;
+        }
+
+        auto measure = [](double& timeMs, auto func)
+        {
+            const auto startTime = CpuTimer::getCurrentTimePoint();
+            func();
+            timeMs += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        };
+
+        const auto startTime = CpuTimer::getCurrentTimePoint();
+        bool inJob = false;
+        try
+        {
+            measure(
+                result.sceneLoadTimeMs,
+                [&]()
+                {
+                    result.sceneReused = makeSceneResident(renderer, job.scene);
+                    renderer.setActiveScene(job.scene);
+                }
+            );
+            measure(
+                result.graphLoadTimeMs,
+                [&]()
+                {
+                    result.graphReused = makeGraphResident(renderer, job.graph, job.graphName);
+                    renderer.setActiveGraph(job.graph, job.graphName);
+                }
+            );
+
+            renderer.beginJob(job);
+            inJob = true;
+
+            // Render up to each capture frame, starting at frame 1.
+            uint64_t frame = 0;
+            for (uint64_t captureFrame : job.captureFrames)
+            {
+                measure(
+                    result.renderTimeMs,
+                    [&]()
+                    {
+                        while (frame < captureFrame)
+                        {
+                            renderer.renderFrame(job, ++frame);
+                            result.frameCount++;
+                        }
+                    }
+                );
+                measure(result.captureTimeMs, [&]() { renderer.captureFrame(job, captureFrame); });
+                result.captureCount++;
+            }
+
+            inJob = false;
+            measure(result.captureTimeMs, [&]() { renderer.endJob(job); });
+            result.success = true;
+        }
+        catch (const std::exception& e)
+        {
+            result.error = e.what();
+            failed = true;
+            mStats.failedCount++;
+            if (inJob)
+            {
+                try
+                {
+                    renderer.endJob(job);
+                }
+                catch (const std::exception& e2)
+                {
+                    logWarning("Failed to end batch job '{}': {}", job.name, e2.what());
+                }
+            }
+        }
+        result.totalTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        if (result.success)
+        {
+            logInfo(
+                "Batch job '{}' finished in {:.2f} s (scene {:.2f} s{}, graph {:.2f} s{}, {} frames {:.2f} s, capture {:.2f} s).",
+                job.name,
+                result.totalTimeMs * 1e-3,
+                result.sceneLoadTimeMs * 1e-3,
+                result.sceneReused ? " reused" : "",
+                result.graphLoadTimeMs * 1e-3,
+                result.graphReused ? " reused" : "",
+                result.frameCount,
+                result.renderTimeMs * 1e-3,
+                result.captureTimeMs * 1e-3
+            );
+        }
+        else
+        {
+            logError("Batch job '{}' failed: {}", job.name, result.error);
+        }
+        results.push_back(std::move(result));
+    }
+
+    mStats.totalTimeMs += CpuTimer::calcDuration(batchStartTime, CpuTimer::getCurrentTimePoint());
+    logInfo(
+        "Batch finished: {} jobs, {} failed, {} scene loads ({} reused), {} graph loads ({} reused).",
+        mStats.jobCount,
+        mStats.failedCount,
+        mStats.sceneLoadCount,
+        mStats.sceneReuseCount,
+        mStats.graphLoadCount,
+        mStats.graphReuseCount
+    );
+    return results;
+}
+
+void BatchScheduler::releaseAll(BatchRenderer& renderer)
+{
+    for (const auto& graph : mGraphs)
+        renderer.unloadGraph(graph.path, graph.name);
+    mGraphs.clear();
+    for (const auto& scene : mScenes)
+        renderer.unloadScene(scene.path);
+    mScenes.clear();
+}
+
+void BatchScheduler::writeReport(const std::filesystem::path& path, const std::vector<JobResult>& results) const
+{
+    nlohmann::json jobs = nlohmann::json::array();
+    for (const auto& result : results)
+    {
+        jobs.push_back({
+            {"name", result.name},
+            {"index", result.index},
+            {"success", result.success},
+            {"skipped", result.skipped},
+            {"error", result.error},
+            {"sceneReused", result.sceneReused},
+            {"graphReused", result.graphReused},
+            {"frameCount", result.frameCount},
+            {"captureCount", result.captureCount},
+            {"sceneLoadTimeMs", result.sceneLoadTimeMs},
+            {"graphLoadTimeMs", result.graphLoadTimeMs},
+            {"renderTimeMs", result.renderTimeMs},
+            {"captureTimeMs", result.captureTimeMs},
+            {"totalTimeMs", result.totalTimeMs},
+        });
+    }
+
+    nlohmann::json j = {
+        {"jobs", jobs},
+        {"stats",
+         {
+             {"jobCount", mStats.jobCount},
+             {"failedCount", mStats.failedCount},
+             {"sceneLoadCount", mStats.sceneLoadCount},
+             {"sceneReuseCount", mStats.sceneReuseCount},
+             {"graphLoadCount", mStats.graphLoadCount},
+             {"graphReuseCount", mStats.graphReuseCount},
+             {"totalTimeMs", mStats.totalTimeMs},
+         }},
+    };
+
+    std::ofstream ofs(path);
+    ofs << j.dump(4) << std::endl;
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write batch report '{}'.", path);
+}
+
+bool BatchScheduler::makeSceneResident(BatchRenderer& renderer, const std::filesystem::path& path)
+{
+    if (path.empty())
+        return false;
+
+    auto it = std::find_if(mScenes.begin(), mScenes.end(), [&](const Resident& r) { return isSamePath(r.path, path); });
+    if (it != mScenes.end())
+    {
+        mScenes.splice(mScenes.begin(), mScenes, it);
+        mStats.sceneReuseCount++;
+        return true;
+    }
+
+    // Evict the least recently used scenes before loading, to not hold more than the limit in memory.
+    while (!mScenes.empty() && mScenes.size() >= std::max(1u, mOptions.maxResidentScenes))
+    {
+        Resident evicted = std::move(mScenes.back());
+        mScenes.pop_back();
+        renderer.unloadScene(evicted.path);
+    }
+
+    renderer.loadScene(path);
+    mScenes.push_front({path.lexically_normal(), {}});
+    mStats.sceneLoadCount++;
+    return false;
+}
+
+bool BatchScheduler::makeGraphResident(BatchRenderer& renderer, const std::filesystem::path& path, const std::string& name)
+{
+    auto it = std::find_if(mGraphs.begin(), mGraphs.end(), [&](const Resident& r) { return isSamePath(r.path, path) && r.name == name; });
+    if (it != mGraphs.end())
+    {
+        mGraphs.splice(mGraphs.begin(), mGraphs, it);
+        mStats.graphReuseCount++;
+        return true;
+    }
+
+    while (!mGraphs.empty() && mGraphs.size() >= std::max(1u, mOptions.maxResidentGraphs))
+    {
+        Resident evicted = std::move(mGraphs.back());
+        mGraphs.pop_back();
+        renderer.unloadGraph(evicted.path, evicted.name);
+    }
+
+    renderer.loadGraph(path, name);
+    mGraphs.push_front({path.lexically_normal(), name});
+    mStats.graphLoadCount++;
+    return false;
+}
+} // namespace Falcor
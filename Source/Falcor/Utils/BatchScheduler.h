@@ -0,0 +1,195 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Description of a batch rendering job.
+ * A job renders a scene with a render graph for a number of frames and captures the graph outputs at given frames.
+ */
+struct BatchJob
+{
+    std::string name;                          ///< Job name, used for reporting and as default base filename.
+    std::filesystem::path scene;               ///< Scene file. Empty to render without a scene.
+    std::filesystem::path graph;               ///< Render graph script.
+    std::string graphName;                     ///< Name of the graph in the script. Empty to use the first graph.
+    std::string camera;                        ///< Camera name. Empty to use the active camera of the scene.
+    uint32_t width = 0;                        ///< Frame buffer width. Zero keeps the current size.
+    uint32_t height = 0;                       ///< Frame buffer height. Zero keeps the current size.
+    uint32_t framerate = 60;                   ///< Clock framerate.
+    std::vector<uint64_t> captureFrames = {1}; ///< Frames at which the outputs are captured, in increasing order.
+    std::vector<std::string> outputs;          ///< Graph outputs to capture. Empty captures all marked outputs.
+    std::filesystem::path outputDirectory = ".";
+    std::string baseFilename; ///< Base filename of the captured images. Empty to use the job name.
+};
+
+/**
+ * Interface of the renderer executing batch jobs.
+ *
+ * The scheduler decides which scenes and graphs stay loaded between jobs, the renderer owns the actual objects.
+ * Scenes and graphs are identified by the paths (and graph name) given in the jobs. All functions may throw, which
+ * fails the current job.
+ */
+class FALCOR_API BatchRenderer
+{
+public:
+    virtual ~BatchRenderer() = default;
+
+    /// Load a scene and keep it resident until unloadScene() is called.
+    virtual void loadScene(const std::filesystem::path& path) = 0;
+    virtual void unloadScene(const std::filesystem::path& path) = 0;
+    /// Make a resident scene active. An empty path renders without a scene.
+    virtual void setActiveScene(const std::filesystem::path& path) = 0;
+
+    /// Load a render graph and keep it resident until unloadGraph() is called.
+    virtual void loadGraph(const std::filesystem::path& path, const std::string& name) = 0;
+    virtual void unloadGraph(const std::filesystem::path& path, const std::string& name) = 0;
+    /// Make a resident graph active.
+    virtual void setActiveGraph(const std::filesystem::path& path, const std::string& name) = 0;
+
+    /// Prepare for rendering a job (frame buffer size, clock, camera, outputs). The scene and graph are already active.
+    virtual void beginJob(const BatchJob& job) = 0;
+    virtual void renderFrame(const BatchJob& job, uint64_t frame) = 0;
+    virtual void captureFrame(const BatchJob& job, uint64_t frame) = 0;
+    /// Finish a job. Blocks until all captured images have been written.
+    virtual void endJob(const BatchJob& job) = 0;
+};
+
+/**
+ * Scheduler for batch rendering jobs.
+ *
+ * Jobs are reordered so that jobs using the same scene run back to back, and within a scene, jobs using the same graph
+ * and frame buffer size run back to back. The relative order of jobs is otherwise kept. Scenes and graphs are kept
+ * resident between jobs, up to a limit, and evicted in least recently used order.
+ *
+ * The resident set persists across calls to run(), call releaseAll() before destroying the renderer.
+ */
+class FALCOR_API BatchScheduler
+{
+public:
+    struct Options
+    {
+        bool reorder = true;            ///< Reorder jobs to maximize scene and graph reuse.
+        uint32_t maxResidentScenes = 1; ///< Max number of scenes kept loaded. Scenes are large, by default only the current one is kept.
+        uint32_t maxResidentGraphs = 8; ///< Max number of render graphs kept loaded.
+        bool stopOnError = false;       ///< Skip the remaining jobs after a job failed.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    struct JobResult
+    {
+        std::string name;
+        size_t index = 0; ///< Index of the job in the job list.
+        bool success = false;
+        bool skipped = false; ///< True if the job was not run because an earlier job failed.
+        std::string error;
+        bool sceneReused = false;  ///< True if the scene was already loaded.
+        bool graphReused = false;  ///< True if the graph was already loaded.
+        uint64_t frameCount = 0;   ///< Number of frames rendered.
+        uint64_t captureCount = 0; ///< Number of frames captured.
+        double sceneLoadTimeMs = 0.0;
+        double graphLoadTimeMs = 0.0;
+        double renderTimeMs = 0.0;  ///< Time spent rendering frames.
+        double captureTimeMs = 0.0; ///< Time spent capturing frames and waiting for the images to be written.
+        double totalTimeMs = 0.0;
+    };
+
+    struct Stats
+    {
+        uint64_t jobCount = 0;
+        uint64_t failedCount = 0;
+        uint64_t sceneLoadCount = 0;
+        uint64_t sceneReuseCount = 0;
+        uint64_t graphLoadCount = 0;
+        uint64_t graphReuseCount = 0;
+        double totalTimeMs = 0.0;
+    };
+
+    BatchScheduler(const Options& options = Options()) : mOptions(options) {}
+
+    /**
+     * Load jobs from a JSON file.
+     * The file contains a list of jobs, or an object with a "jobs" list and optional scheduler options
+     * ("reorder", "maxResidentScenes", "maxResidentGraphs", "stopOnError"). Relative graph and output paths are relative
+     * to the file, scene paths are resolved by the renderer.
+     * @param[in] path File path.
+     * @param[in,out] options Scheduler options, overridden by the options in the file.
+     * @return List of jobs. Throws on error.
+     */
+    static std::vector<BatchJob> loadJobs(const std::filesystem::path& path, Options& options);
+
+    /**
+     * Compute the order in which jobs are run.
+     * @return List of job indices.
+     */
+    std::vector<size_t> schedule(const std::vector<BatchJob>& jobs) const;
+
+    /**
+     * Run a list of jobs.
+     * @return Job results in execution order.
+     */
+    std::vector<JobResult> run(BatchRenderer& renderer, const std::vector<BatchJob>& jobs);
+
+    /**
+     * Unload all resident scenes and graphs.
+     */
+    void releaseAll(BatchRenderer& renderer);
+
+    /**
+     * Write job results and statistics to a JSON file.
+     */
+    void writeReport(const std::filesystem::path& path, const std::vector<JobResult>& results) const;
+
+    const Stats& getStats() const { return mStats; }
+    const Options& getOptions() const { return mOptions; }
+
+private:
+    struct Resident
+    {
+        std::filesystem::path path;
+        std::string name;
+    };
+
+    bool makeSceneResident(BatchRenderer& renderer, const std::filesystem::path& path);
+    bool makeGraphResident(BatchRenderer& renderer, const std::filesystem::path& path, const std::string& name);
+
+    Options mOptions;
+    Stats mStats;
+    std::list<Resident> mScenes; ///< Resident scenes, most recently used first.
+    std::list<Resident> mGraphs; ///< Resident graphs, most recently used first.
+};
+} // namespace Falcor
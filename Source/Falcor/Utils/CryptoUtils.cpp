@@ -26,111 +26,42 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "CryptoUtils.h"
+#include "Core/Error.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/NumericRange.h"
+#include "Utils/StringFormatters.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <execution>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
-namespace Falcor
-{
-SHA1::SHA1() : mIndex(0), mBits(0)
-{
-    mState[0] = 0x67452301;
-    mState[1] = 0xefcdab89;
-    mState[2] = 0x98badcfe;
-    mState[3] = 0x10325476;
-    mState[4] = 0xc3d2e1f0;
-}
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_CRYPTO_X86 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#define FALCOR_SHA_TARGET
+#else
+#include <cpuid.h>
+#define FALCOR_SHA_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define FALCOR_CRYPTO_ARM 1
+#include <arm_neon.h>
+#endif
 
-void SHA1::update(uint8_t byte)
-{
-    addByte(byte);
-    mBits += 8;
-}
-
-void SHA1::update(const void* data, size_t len)
-{
-    if (!data)
-        return;
-
-    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
-
-    // Fill up buffer if not full.
-    while (len > 0 && mIndex != 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-
-    // Process full blocks.
-    while (len >= sizeof(mBuf))
-    {
-        processBlock(ptr);
-        ptr += sizeof(mBuf);
-        len -= sizeof(mBuf);
-        mBits += sizeof(mBuf) * 8;
-    }
-
-    // Process remaining bytes.
-    while (len > 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-}
-
-SHA1::MD SHA1::finalize()
-{
-    // Finalize with 0x80, some zero padding and the length in bits.
-    addByte(0x80);
-    while (mIndex % 64 != 56)
-    {
-        addByte(0);
-    }
-    for (int i = 7; i >= 0; --i)
-    {
-        addByte(mBits >> i * 8);
-    }
-
-    MD md;
-    for (int i = 0; i < 5; i++)
-    {
-        for (int j = 3; j >= 0; j--)
-        {
-            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
-        }
-    }
-
-    return md;
-}
-
-SHA1::MD SHA1::compute(const void* data, size_t len)
+namespace Falcor
 {
-    SHA1 sha1;
-    sha1.update(data, len);
-    return sha1.finalize();
-}
-
-std::string SHA1::toString(const SHA1::MD& sha1)
+namespace
 {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') << std::setw(2);
-    for (auto c : sha1)
-        ss << (int)c;
-    return ss.str();
-}
+std::atomic<bool> gSHA1HardwareAccelerationEnabled{true};
 
-void SHA1::addByte(uint8_t byte)
+void processBlockPortable(uint32_t state[5], const uint8_t* ptr)
 {
-    mBuf[mIndex++] = byte;
 
-    if (mIndex >= sizeof(mBuf))
-    {
-        mIndex = 0;
-        processBlock(mBuf);
-    }
-}
-
-void SHA1::processBlock(const uint8_t* ptr)
-{
     auto rol32 = [](uint32_t x, uint32_t n) { return (x << n) | (x >> (32 - n)); };
 
     auto makeWord = [](const uint8_t* p)
@@ -141,11 +72,11 @@ void SHA1::processBlock(const uint8_t* ptr)
     const uint32_t c2 = 0x8f1bbcdc;
     const uint32_t c3 = 0xca62c1d6;
 
-    uint32_t a = mState[0];
-    uint32_t b = mState[1];
-    uint32_t c = mState[2];
-    uint32_t d = mState[3];
-    uint32_t e = mState[4];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
 
     uint32_t w[16];
 
@@ -251,10 +182,941 @@ void SHA1::processBlock(const uint8_t* ptr)
 #undef SHA1_ROUND_3
 #undef SHA1_ROUND_4
 
-    mState[0] += a;
-    mState[1] += b;
-    mState[2] += c;
-    mState[3] += d;
-    mState[4] += e;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+#if FALCOR_CRYPTO_X86
+bool checkSHA1HardwareSupport()
+{
+    // SHA instructions are reported in CPUID leaf 7 (EBX bit 29). The implementation also uses SSSE3 and SSE4.1.
+#if FALCOR_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuidex(info, 7, 0);
+    bool sha = (info[1] & (1 << 29)) != 0;
+    __cpuid(info, 1);
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    bool sha = (ebx & (1u << 29)) != 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    bool ssse3 = (ecx & (1u << 9)) != 0;
+    bool sse41 = (ecx & (1u << 19)) != 0;
+#endif
+    return sha && ssse3 && sse41;
+}
+
+FALCOR_SHA_TARGET void processBlocksHardware(uint32_t state[5], const uint8_t* ptr, size_t blockCount)
+{
+    // Reverses the byte order of the message words.
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+    __m128i e1;
+    __m128i msg0, msg1, msg2, msg3;
+
+// Four rounds, also computing the message schedule for the following rounds.
+// clang-format off
+#define SHA1_NI_ROUNDS(ea, eb, m0, m1, m2, m3, f) \
+    ea = _mm_sha1nexte_epu32(ea, m0); eb = abcd; m1 = _mm_sha1msg2_epu32(m1, m0); \
+    abcd = _mm_sha1rnds4_epu32(abcd, ea, f); m3 = _mm_sha1msg1_epu32(m3, m0); m2 = _mm_xor_si128(m2, m0);
+    // clang-format on
+
+    for (size_t i = 0; i < blockCount; i++, ptr += 64)
+    {
+        const __m128i abcdSave = abcd;
+        const __m128i e0Save = e0;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0)), mask);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16)), mask);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 32)), mask);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 48)), mask);
+
+        // Rounds 0-11.
+        e0 = _mm_add_epi32(e0, msg0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        // Rounds 12-79.
+        SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 0);
+        SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 0);
+        SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 1);
+        SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 1);
+        SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 1);
+        SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 1);
+        SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 1);
+        SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 2);
+        SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 2);
+        SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 2);
+        SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 2);
+        SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 2);
+        SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 3);
+        SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 3);
+        SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 3);
+        SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 3);
+        SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 3);
+
+        e0 = _mm_sha1nexte_epu32(e0, e0Save);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+#undef SHA1_NI_ROUNDS
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+#elif FALCOR_CRYPTO_ARM
+bool checkSHA1HardwareSupport()
+{
+    // The cryptographic extension is enabled at compile time.
+    return true;
+}
+
+void processBlocksHardware(uint32_t state[5], const uint8_t* ptr, size_t blockCount)
+{
+    const uint32x4_t k[4] = {vdupq_n_u32(0x5a827999), vdupq_n_u32(0x6ed9eba1), vdupq_n_u32(0x8f1bbcdc), vdupq_n_u32(0xca62c1d6)};
+
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32_t e0 = state[4];
+
+    for (size_t i = 0; i < blockCount; i++, ptr += 64)
+    {
+        const uint32x4_t abcdSave = abcd;
+        const uint32_t e0Save = e0;
+
+        uint32x4_t msg[4];
+        for (int j = 0; j < 4; j++)
+            msg[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(ptr + 16 * j)));
+
+        uint32x4_t tmp[2] = {vaddq_u32(msg[0], k[0]), vaddq_u32(msg[1], k[0])};
+        uint32_t e[2] = {e0, 0};
+
+        // Four rounds per step. The message schedule runs two steps ahead of the rounds.
+        for (int g = 0; g < 20; g++)
+        {
+            e[(g + 1) % 2] = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+            if (g < 5)
+                abcd = vsha1cq_u32(abcd, e[g % 2], tmp[g % 2]);
+            else if (g < 10 || g >= 15)
+                abcd = vsha1pq_u32(abcd, e[g % 2], tmp[g % 2]);
+            else
+                abcd = vsha1mq_u32(abcd, e[g % 2], tmp[g % 2]);
+
+            if (g < 18)
+                tmp[g % 2] = vaddq_u32(msg[(g + 2) % 4], k[(g + 2) / 5]);
+            if (g >= 1 && g < 17)
+                msg[(g + 3) % 4] = vsha1su1q_u32(msg[(g + 3) % 4], msg[(g + 2) % 4]);
+            if (g < 16)
+                msg[g % 4] = vsha1su0q_u32(msg[g % 4], msg[(g + 1) % 4], msg[(g + 2) % 4]);
+        }
+
+        e0 = e[0] + e0Save;
+        abcd = vaddq_u32(abcd, abcdSave);
+    }
+
+    vst1q_u32(state, abcd);
+    state[4] = e0;
+}
+#else
+bool checkSHA1HardwareSupport()
+{
+    return false;
+}
+
+void processBlocksHardware(uint32_t state[5], const uint8_t* ptr, size_t blockCount)
+{
+    FALCOR_UNREACHABLE();
+}
+#endif
+
+// XXH3 constants, see the xxHash reference implementation.
+constexpr uint32_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint32_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint32_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t kStripeLen = 64;
+constexpr size_t kSecretConsumeRate = 8;
+constexpr size_t kSecretSizeMin = 136;
+constexpr size_t kSecretLastAccStart = 7;
+constexpr size_t kSecretMergeAccsStart = 11;
+constexpr size_t kMidSizeMax = 240;
+constexpr size_t kMidSizeStartOffset = 3;
+constexpr size_t kMidSizeLastOffset = 17;
+
+// clang-format off
+alignas(64) const uint8_t kSecret[192] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+// clang-format on
+
+// Falcor only supports little endian platforms.
+inline uint32_t readLE32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t readLE64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t swap32(uint32_t x)
+{
+    return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+}
+
+inline uint64_t swap64(uint64_t x)
+{
+    return (uint64_t(swap32(uint32_t(x))) << 32) | swap32(uint32_t(x >> 32));
+}
+
+inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline XXH3::Hash128 mul64to128(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return {uint64_t(product), uint64_t(product >> 64)};
+#elif defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return {low, high};
+#else
+    uint64_t loLo = (a & 0xffffffff) * (b & 0xffffffff);
+    uint64_t hiLo = (a >> 32) * (b & 0xffffffff);
+    uint64_t loHi = (a & 0xffffffff) * (b >> 32);
+    uint64_t hiHi = (a >> 32) * (b >> 32);
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    return {(cross << 32) | (loLo & 0xffffffff), (hiLo >> 32) + (cross >> 32) + hiHi};
+#endif
+}
+
+inline uint64_t mul128Fold64(uint64_t a, uint64_t b)
+{
+    XXH3::Hash128 product = mul64to128(a, b);
+    return product.low ^ product.high;
+}
+
+inline uint64_t xxh64Avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= kPrimeMx1;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t rrmxmx(uint64_t h, uint64_t len)
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= kPrimeMx2;
+    h ^= (h >> 35) + len;
+    h *= kPrimeMx2;
+    return h ^ (h >> 28);
+}
+
+inline uint64_t mix16B(const uint8_t* input, const uint8_t* secret, uint64_t seed)
+{
+    return mul128Fold64(readLE64(input) ^ (readLE64(secret) + seed), readLE64(input + 8) ^ (readLE64(secret + 8) - seed));
+}
+
+inline XXH3::Hash128 mix32B(XXH3::Hash128 acc, const uint8_t* input1, const uint8_t* input2, const uint8_t* secret, uint64_t seed)
+{
+    acc.low += mix16B(input1, secret, seed);
+    acc.low ^= readLE64(input2) + readLE64(input2 + 8);
+    acc.high += mix16B(input2, secret + 16, seed);
+    acc.high ^= readLE64(input1) + readLE64(input1 + 8);
+    return acc;
+}
+
+uint64_t hashShort64(const uint8_t* input, size_t len, uint64_t seed)
+{
+    const uint8_t* secret = kSecret;
+
+    if (len <= 16)
+    {
+        if (len > 8)
+        {
+            uint64_t bitflip1 = (readLE64(secret + 24) ^ readLE64(secret + 32)) + seed;
+            uint64_t bitflip2 = (readLE64(secret + 40) ^ readLE64(secret + 48)) - seed;
+            uint64_t inputLo = readLE64(input) ^ bitflip1;
+            uint64_t inputHi = readLE64(input + len - 8) ^ bitflip2;
+            uint64_t acc = len + swap64(inputLo) + inputHi + mul128Fold64(inputLo, inputHi);
+            return avalanche(acc);
+        }
+        if (len >= 4)
+        {
+            seed ^= uint64_t(swap32(uint32_t(seed))) << 32;
+            uint32_t input1 = readLE32(input);
+            uint32_t input2 = readLE32(input + len - 4);
+            uint64_t bitflip = (readLE64(secret + 8) ^ readLE64(secret + 16)) - seed;
+            uint64_t input64 = input2 + (uint64_t(input1) << 32);
+            return rrmxmx(input64 ^ bitflip, len);
+        }
+        if (len > 0)
+        {
+            uint32_t combined = (uint32_t(input[0]) << 16) | (uint32_t(input[len >> 1]) << 24) | uint32_t(input[len - 1]) |
+                                (uint32_t(len) << 8);
+            uint64_t bitflip = (readLE32(secret) ^ readLE32(secret + 4)) + seed;
+            return xxh64Avalanche(uint64_t(combined) ^ bitflip);
+        }
+        return xxh64Avalanche(seed ^ (readLE64(secret + 56) ^ readLE64(secret + 64)));
+    }
+
+    uint64_t acc = len * kPrime64_1;
+    if (len <= 128)
+    {
+        if (len > 32)
+        {
+            if (len > 64)
+            {
+                if (len > 96)
+                {
+                    acc += mix16B(input + 48, secret + 96, seed);
+                    acc += mix16B(input + len - 64, secret + 112, seed);
+                }
+                acc += mix16B(input + 32, secret + 64, seed);
+                acc += mix16B(input + len - 48, secret + 80, seed);
+            }
+            acc += mix16B(input + 16, secret + 32, seed);
+            acc += mix16B(input + len - 32, secret + 48, seed);
+        }
+        acc += mix16B(input, secret, seed);
+        acc += mix16B(input + len - 16, secret + 16, seed);
+        return avalanche(acc);
+    }
+
+    // 129-240 bytes.
+    const size_t roundCount = len / 16;
+    for (size_t i = 0; i < 8; i++)
+        acc += mix16B(input + 16 * i, secret + 16 * i, seed);
+    uint64_t accEnd = mix16B(input + len - 16, secret + kSecretSizeMin - kMidSizeLastOffset, seed);
+    acc = avalanche(acc);
+    for (size_t i = 8; i < roundCount; i++)
+        accEnd += mix16B(input + 16 * i, secret + 16 * (i - 8) + kMidSizeStartOffset, seed);
+    return avalanche(acc + accEnd);
+}
+
+XXH3::Hash128 hashShort128(const uint8_t* input, size_t len, uint64_t seed)
+{
+    const uint8_t* secret = kSecret;
+
+    if (len <= 16)
+    {
+        if (len > 8)
+        {
+            uint64_t bitflipLo = (readLE64(secret + 32) ^ readLE64(secret + 40)) - seed;
+            uint64_t bitflipHi = (readLE64(secret + 48) ^ readLE64(secret + 56)) + seed;
+            uint64_t inputLo = readLE64(input);
+            uint64_t inputHi = readLE64(input + len - 8);
+            XXH3::Hash128 m128 = mul64to128(inputLo ^ inputHi ^ bitflipLo, kPrime64_1);
+            m128.low += uint64_t(len - 1) << 54;
+            inputHi ^= bitflipHi;
+            m128.high += inputHi + uint64_t(uint32_t(inputHi)) * (kPrime32_2 - 1);
+            m128.low ^= swap64(m128.high);
+            XXH3::Hash128 h128 = mul64to128(m128.low, kPrime64_2);
+            h128.high += m128.high * kPrime64_2;
+            return {avalanche(h128.low), avalanche(h128.high)};
+        }
+        if (len >= 4)
+        {
+            seed ^= uint64_t(swap32(uint32_t(seed))) << 32;
+            uint32_t inputLo = readLE32(input);
+            uint32_t inputHi = readLE32(input + len - 4);
+            uint64_t input64 = inputLo + (uint64_t(inputHi) << 32);
+            uint64_t bitflip = (readLE64(secret + 16) ^ readLE64(secret + 24)) + seed;
+            XXH3::Hash128 m128 = mul64to128(input64 ^ bitflip, kPrime64_1 + (uint64_t(len) << 2));
+            m128.high += m128.low << 1;
+            m128.low ^= m128.high >> 3;
+            m128.low ^= m128.low >> 35;
+            m128.low *= kPrimeMx2;
+            m128.low ^= m128.low >> 28;
+            m128.high = avalanche(m128.high);
+            return m128;
+        }
+        if (len > 0)
+        {
+            uint32_t combinedLo = (uint32_t(input[0]) << 16) | (uint32_t(input[len >> 1]) << 24) | uint32_t(input[len - 1]) |
+                                  (uint32_t(len) << 8);
+            uint32_t combinedHi = rotl32(swap32(combinedLo), 13);
+            uint64_t bitflipLo = (readLE32(secret) ^ readLE32(secret + 4)) + seed;
+            uint64_t bitflipHi = (readLE32(secret + 8) ^ readLE32(secret + 12)) - seed;
+            return {xxh64Avalanche(uint64_t(combinedLo) ^ bitflipLo), xxh64Avalanche(uint64_t(combinedHi) ^ bitflipHi)};
+        }
+        uint64_t bitflipLo = readLE64(secret + 64) ^ readLE64(secret + 72);
+        uint64_t bitflipHi = readLE64(secret + 80) ^ readLE64(secret + 88);
+        return {xxh64Avalanche(seed ^ bitflipLo), xxh64Avalanche(seed ^ bitflipHi)};
+    }
+
+    XXH3::Hash128 acc{len * kPrime64_1, 0};
+    if (len <= 128)
+    {
+        if (len > 32)
+        {
+            if (len > 64)
+            {
+                if (len > 96)
+                    acc = mix32B(acc, input + 48, input + len - 64, secret + 96, seed);
+                acc = mix32B(acc, input + 32, input + len - 48, secret + 64, seed);
+            }
+            acc = mix32B(acc, input + 16, input + len - 32, secret + 32, seed);
+        }
+        acc = mix32B(acc, input, input + len - 16, secret, seed);
+    }
+    else
+    {
+        // 129-240 bytes.
+        for (size_t i = 32; i < 160; i += 32)
+            acc = mix32B(acc, input + i - 32, input + i - 16, secret + i - 32, seed);
+        acc.low = avalanche(acc.low);
+        acc.high = avalanche(acc.high);
+        for (size_t i = 160; i <= len; i += 32)
+            acc = mix32B(acc, input + i - 32, input + i - 16, secret + kMidSizeStartOffset + i - 160, seed);
+        acc = mix32B(acc, input + len - 16, input + len - 32, secret + kSecretSizeMin - kMidSizeLastOffset - 16, 0 - seed);
+    }
+
+    uint64_t low = acc.low + acc.high;
+    uint64_t high = acc.low * kPrime64_1 + acc.high * kPrime64_4 + (len - seed) * kPrime64_2;
+    return {avalanche(low), 0 - avalanche(high)};
+}
+
+/// Accumulates one 64 byte stripe into the eight 64-bit accumulators.
+inline void accumulate512(uint64_t* acc, const uint8_t* input, const uint8_t* secret)
+{
+#if FALCOR_CRYPTO_X86
+    // SSE2 is always available on x86-64.
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    for (size_t i = 0; i < 4; i++)
+    {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+        __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        __m128i dataKey = _mm_xor_si128(data, key);
+        __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i sum = _mm_add_epi64(xacc[i], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+        xacc[i] = _mm_add_epi64(product, sum);
+    }
+#else
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint64_t data = readLE64(input + 8 * i);
+        uint64_t dataKey = data ^ readLE64(secret + 8 * i);
+        acc[i ^ 1] += data;
+        acc[i] += (dataKey & 0xffffffff) * (dataKey >> 32);
+    }
+#endif
+}
+
+inline void accumulate(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    for (size_t i = 0; i < stripeCount; i++)
+        accumulate512(acc, input + i * kStripeLen, secret + i * kSecretConsumeRate);
+}
+
+inline void scramble(uint64_t* acc, const uint8_t* secret)
+{
+#if FALCOR_CRYPTO_X86
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    const __m128i prime = _mm_set1_epi32((int)kPrime32_1);
+    for (size_t i = 0; i < 4; i++)
+    {
+        __m128i data = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+        __m128i dataKey = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+        __m128i productLo = _mm_mul_epu32(dataKey, prime);
+        __m128i productHi = _mm_mul_epu32(_mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        xacc[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+    }
+#else
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= readLE64(secret + 8 * i);
+        acc[i] = a * kPrime32_1;
+    }
+#endif
+}
+
+inline void initAcc(uint64_t* acc)
+{
+    acc[0] = kPrime32_3;
+    acc[1] = kPrime64_1;
+    acc[2] = kPrime64_2;
+    acc[3] = kPrime64_3;
+    acc[4] = kPrime64_4;
+    acc[5] = kPrime32_2;
+    acc[6] = kPrime64_5;
+    acc[7] = kPrime32_1;
+}
+
+/// Derives the secret for a seed. For seed 0 this is the default secret.
+void initSecret(uint8_t* secret, uint64_t seed)
+{
+    for (size_t i = 0; i < sizeof(kSecret); i += 16)
+    {
+        uint64_t lo = readLE64(kSecret + i) + seed;
+        uint64_t hi = readLE64(kSecret + i + 8) - seed;
+        std::memcpy(secret + i, &lo, sizeof(lo));
+        std::memcpy(secret + i + 8, &hi, sizeof(hi));
+    }
+}
+
+inline uint64_t mergeAccs(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; i++)
+        result += mul128Fold64(acc[2 * i] ^ readLE64(secret + 16 * i), acc[2 * i + 1] ^ readLE64(secret + 16 * i + 8));
+    return avalanche(result);
+}
+
+/// Processes inputs larger than 240 bytes. Returns the accumulators to be merged.
+void hashLong(uint64_t* acc, const uint8_t* input, size_t len, const uint8_t* secret, size_t secretSize)
+{
+    const size_t stripesPerBlock = (secretSize - kStripeLen) / kSecretConsumeRate;
+    const size_t blockLen = kStripeLen * stripesPerBlock;
+    const size_t blockCount = (len - 1) / blockLen;
+
+    initAcc(acc);
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        accumulate(acc, input + i * blockLen, secret, stripesPerBlock);
+        scramble(acc, secret + secretSize - kStripeLen);
+    }
+
+    // Last partial block and last stripe.
+    const size_t stripeCount = ((len - 1) - blockLen * blockCount) / kStripeLen;
+    accumulate(acc, input + blockCount * blockLen, secret, stripeCount);
+    accumulate512(acc, input + len - kStripeLen, secret + secretSize - kStripeLen - kSecretLastAccStart);
+}
+
+inline uint64_t mergeAccs64(const uint64_t* acc, const uint8_t* secret, uint64_t len)
+{
+    return mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1);
+}
+
+inline XXH3::Hash128 mergeAccs128(const uint64_t* acc, const uint8_t* secret, size_t secretSize, uint64_t len)
+{
+    return {
+        mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1),
+        mergeAccs(acc, secret + secretSize - 64 - kSecretMergeAccsStart, ~(len * kPrime64_2)),
+    };
+}
+
+/**
+ * Processes stripes for streaming, stripes can span multiple blocks.
+ * Returns a pointer past the processed input.
+ */
+const uint8_t* consumeStripes(
+    uint64_t* acc,
+    size_t& stripesSoFar,
+    const uint8_t* input,
+    size_t stripeCount,
+    const uint8_t* secret,
+    size_t secretSize
+)
+{
+    const size_t stripesPerBlock = (secretSize - kStripeLen) / kSecretConsumeRate;
+    const uint8_t* initialSecret = secret + stripesSoFar * kSecretConsumeRate;
+
+    if (stripeCount >= stripesPerBlock - stripesSoFar)
+    {
+        size_t stripesThisIter = stripesPerBlock - stripesSoFar;
+        do
+        {
+            accumulate(acc, input, initialSecret, stripesThisIter);
+            scramble(acc, secret + secretSize - kStripeLen);
+            input += stripesThisIter * kStripeLen;
+            stripeCount -= stripesThisIter;
+            stripesThisIter = stripesPerBlock;
+            initialSecret = secret;
+        } while (stripeCount >= stripesPerBlock);
+        stripesSoFar = 0;
+    }
+
+    if (stripeCount > 0)
+    {
+        accumulate(acc, input, initialSecret, stripeCount);
+        input += stripeCount * kStripeLen;
+        stripesSoFar += stripeCount;
+    }
+
+    return input;
+}
+} // namespace
+
+SHA1::SHA1() : mIndex(0), mBits(0)
+{
+    mState[0] = 0x67452301;
+    mState[1] = 0xefcdab89;
+    mState[2] = 0x98badcfe;
+    mState[3] = 0x10325476;
+    mState[4] = 0xc3d2e1f0;
+}
+
+void SHA1::update(uint8_t byte)
+{
+    addByte(byte);
+    mBits += 8;
+}
+
+void SHA1::update(const void* data, size_t len)
+{
+    if (!data || len == 0)
+        return;
+
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+    mBits += uint64_t(len) * 8;
+
+    // Fill up buffer if not empty.
+    if (mIndex != 0)
+    {
+        size_t count = std::min(len, sizeof(mBuf) - mIndex);
+        std::memcpy(mBuf + mIndex, ptr, count);
+        mIndex += (uint32_t)count;
+        ptr += count;
+        len -= count;
+        if (mIndex < sizeof(mBuf))
+            return;
+        processBlocks(mBuf, 1);
+        mIndex = 0;
+    }
+
+    // Process full blocks.
+    size_t blockCount = len / sizeof(mBuf);
+    if (blockCount > 0)
+    {
+        processBlocks(ptr, blockCount);
+        ptr += blockCount * sizeof(mBuf);
+        len -= blockCount * sizeof(mBuf);
+    }
+
+    // Buffer remaining bytes.
+    std::memcpy(mBuf, ptr, len);
+    mIndex = (uint32_t)len;
+}
+
+SHA1::MD SHA1::finalize()
+{
+    // Finalize with 0x80, some zero padding and the length in bits.
+    addByte(0x80);
+    while (mIndex % 64 != 56)
+    {
+        addByte(0);
+    }
+    for (int i = 7; i >= 0; --i)
+    {
+        addByte(mBits >> i * 8);
+    }
+
+    MD md;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
+        }
+    }
+
+    return md;
+}
+
+SHA1::MD SHA1::compute(const void* data, size_t len)
+{
+    SHA1 sha1;
+    sha1.update(data, len);
+    return sha1.finalize();
+}
+
+std::string SHA1::toString(const SHA1::MD& sha1)
+{
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (auto c : sha1)
+        ss << std::setw(2) << (int)c;
+    return ss.str();
+}
+
+void SHA1::addByte(uint8_t byte)
+{
+    mBuf[mIndex++] = byte;
+
+    if (mIndex >= sizeof(mBuf))
+    {
+        mIndex = 0;
+        processBlocks(mBuf, 1);
+    }
+}
+
+bool SHA1::isHardwareAccelerationSupported()
+{
+    static const bool supported = checkSHA1HardwareSupport();
+    return supported;
+}
+
+void SHA1::setHardwareAccelerationEnabled(bool enabled)
+{
+    gSHA1HardwareAccelerationEnabled = enabled;
+}
+
+bool SHA1::isHardwareAccelerationEnabled()
+{
+    return gSHA1HardwareAccelerationEnabled && isHardwareAccelerationSupported();
+}
+
+void SHA1::processBlocks(const uint8_t* ptr, size_t blockCount)
+{
+    if (isHardwareAccelerationEnabled())
+    {
+        processBlocksHardware(mState, ptr, blockCount);
+        return;
+    }
+
+    for (size_t i = 0; i < blockCount; i++)
+        processBlockPortable(mState, ptr + i * 64);
+}
+
+XXH3::XXH3(uint64_t seed) : mSeed(seed)
+{
+    initAcc(mAcc);
+    initSecret(mSecret, seed);
+}
+
+void XXH3::update(const void* data, size_t len)
+{
+    if (!data || len == 0)
+        return;
+
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = input + len;
+    mTotalLen += len;
+
+    // Small input: just fill the buffer.
+    if (len <= kBufferSize - mBufferedSize)
+    {
+        std::memcpy(mBuffer + mBufferedSize, input, len);
+        mBufferedSize += len;
+        return;
+    }
+
+    // Complete and consume the buffer.
+    if (mBufferedSize > 0)
+    {
+        const size_t loadSize = kBufferSize - mBufferedSize;
+        std::memcpy(mBuffer + mBufferedSize, input, loadSize);
+        input += loadSize;
+        consumeStripes(mAcc, mStripesSoFar, mBuffer, kBufferSize / kStripeLen, mSecret, kSecretSize);
+        mBufferedSize = 0;
+    }
+
+    // Consume the input directly, keeping at least one byte for the digest.
+    // The last stripe is copied to the end of the buffer as the digest may need it.
+    if (size_t(end - input) > kBufferSize)
+    {
+        const size_t stripeCount = size_t(end - 1 - input) / kStripeLen;
+        input = consumeStripes(mAcc, mStripesSoFar, input, stripeCount, mSecret, kSecretSize);
+        std::memcpy(mBuffer + kBufferSize - kStripeLen, input - kStripeLen, kStripeLen);
+    }
+
+    std::memcpy(mBuffer, input, size_t(end - input));
+    mBufferedSize = size_t(end - input);
+}
+
+void XXH3::digestLong(uint64_t acc[8]) const
+{
+    // Digest on a copy of the accumulators, so that more data can be added afterwards.
+    std::memcpy(acc, mAcc, sizeof(mAcc));
+
+    uint8_t lastStripe[kStripeLen];
+    const uint8_t* lastStripePtr;
+    if (mBufferedSize >= kStripeLen)
+    {
+        const size_t stripeCount = (mBufferedSize - 1) / kStripeLen;
+        size_t stripesSoFar = mStripesSoFar;
+        consumeStripes(acc, stripesSoFar, mBuffer, stripeCount, mSecret, kSecretSize);
+        lastStripePtr = mBuffer + mBufferedSize - kStripeLen;
+    }
+    else
+    {
+        // The last stripe overlaps the previously consumed data at the end of the buffer.
+        const size_t catchupSize = kStripeLen - mBufferedSize;
+        std::memcpy(lastStripe, mBuffer + kBufferSize - catchupSize, catchupSize);
+        std::memcpy(lastStripe + catchupSize, mBuffer, mBufferedSize);
+        lastStripePtr = lastStripe;
+    }
+
+    accumulate512(acc, lastStripePtr, mSecret + kSecretSize - kStripeLen - kSecretLastAccStart);
+}
+
+uint64_t XXH3::digest64() const
+{
+    if (mTotalLen > kMidSizeMax)
+    {
+        alignas(64) uint64_t acc[8];
+        digestLong(acc);
+        return mergeAccs64(acc, mSecret, mTotalLen);
+    }
+    return hashShort64(mBuffer, mBufferedSize, mSeed);
+}
+
+XXH3::Hash128 XXH3::digest128() const
+{
+    if (mTotalLen > kMidSizeMax)
+    {
+        alignas(64) uint64_t acc[8];
+        digestLong(acc);
+        return mergeAccs128(acc, mSecret, kSecretSize, mTotalLen);
+    }
+    return hashShort128(mBuffer, mBufferedSize, mSeed);
+}
+
+uint64_t XXH3::hash64(const void* data, size_t len, uint64_t seed)
+{
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    if (len <= kMidSizeMax)
+        return hashShort64(input, len, seed);
+
+    alignas(64) uint64_t acc[8];
+    if (seed == 0)
+    {
+        hashLong(acc, input, len, kSecret, sizeof(kSecret));
+        return mergeAccs64(acc, kSecret, len);
+    }
+    alignas(64) uint8_t secret[kSecretSize];
+    initSecret(secret, seed);
+    hashLong(acc, input, len, secret, kSecretSize);
+    return mergeAccs64(acc, secret, len);
+}
+
+XXH3::Hash128 XXH3::hash128(const void* data, size_t len, uint64_t seed)
+{
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    if (len <= kMidSizeMax)
+        return hashShort128(input, len, seed);
+
+    alignas(64) uint64_t acc[8];
+    if (seed == 0)
+    {
+        hashLong(acc, input, len, kSecret, sizeof(kSecret));
+        return mergeAccs128(acc, kSecret, sizeof(kSecret), len);
+    }
+    alignas(64) uint8_t secret[kSecretSize];
+    initSecret(secret, seed);
+    hashLong(acc, input, len, secret, kSecretSize);
+    return mergeAccs128(acc, secret, kSecretSize, len);
+}
+
+XXH3::Hash128 XXH3::hashTree128(const void* data, size_t len, size_t chunkSize, uint64_t seed)
+{
+    FALCOR_CHECK(chunkSize > 0, "Chunk size must be larger than zero.");
+
+    if (len <= chunkSize)
+        return hash128(data, len, seed);
+
+    // Hash the chunks in parallel.
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    const size_t chunkCount = (len + chunkSize - 1) / chunkSize;
+    std::vector<Hash128> chunkHashes(chunkCount);
+    NumericRange<size_t> chunks(0, chunkCount);
+    std::for_each(
+        std::execution::par,
+        chunks.begin(),
+        chunks.end(),
+        [&](size_t i)
+        {
+            const size_t offset = i * chunkSize;
+            chunkHashes[i] = hash128(input + offset, std::min(chunkSize, len - offset), seed);
+        }
+    );
+
+    // Combine the chunk hashes. The total length and chunk size are included to separate the tree hash from a plain hash.
+    XXH3 xxh3(seed);
+    for (const auto& hash : chunkHashes)
+    {
+        xxh3.update(hash.low);
+        xxh3.update(hash.high);
+    }
+    xxh3.update(uint64_t(len));
+    xxh3.update(uint64_t(chunkSize));
+    return xxh3.digest128();
+}
+
+XXH3::Hash128 XXH3::hashFile(const std::filesystem::path& path, size_t chunkSize)
+{
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        FALCOR_THROW("Failed to get size of file '{}'.", path);
+    if (size == 0)
+        return hash128(nullptr, 0);
+
+    MemoryMappedFile file;
+    if (!file.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan))
+        FALCOR_THROW("Failed to open file '{}' for hashing.", path);
+    return hashTree128(file.getData(), file.getSize(), chunkSize);
+}
+
+std::string XXH3::toString(const Hash128& hash)
+{
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << hash.high << std::setw(16) << hash.low;
+    return ss.str();
 }
 } // namespace Falcor
@@ -28,7 +28,9 @@
 #pragma once
 #include "Core/Macros.h"
 #include <array>
+#include <filesystem>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <cstdlib>
 
@@ -36,6 +38,7 @@ namespace Falcor
 {
 /**
  * Helper to compute SHA-1 hash.
+ * Uses the SHA instructions of the CPU if available (SHA-NI on x86-64, cryptographic extension on ARMv8).
  */
 class FALCOR_API SHA1
 {
@@ -91,13 +94,141 @@ public:
      */
     static std::string toString(const MD& sha1);
 
+    /// Returns true if the CPU supports the SHA instructions.
+    static bool isHardwareAccelerationSupported();
+
+    /**
+     * Enable or disable the use of the SHA instructions. Enabled by default if supported.
+     * Only useful for testing and benchmarking.
+     */
+    static void setHardwareAccelerationEnabled(bool enabled);
+
+    static bool isHardwareAccelerationEnabled();
+
 private:
     void addByte(uint8_t x);
-    void processBlock(const uint8_t* ptr);
+    void processBlocks(const uint8_t* ptr, size_t blockCount);
 
     uint32_t mIndex;
     uint64_t mBits;
     uint32_t mState[5];
     uint8_t mBuf[64];
 };
+
+/**
+ * Fast non-cryptographic hash for hash tables, deduplication and content fingerprints.
+ * Implements the 64-bit and 128-bit XXH3 hashes, the results match the xxHash reference implementation (version 0.8).
+ * Don't use this where collisions can be created deliberately, use SHA1 instead.
+ *
+ * Data can be hashed in one go with hash64()/hash128(), or streamed with update() and digest64()/digest128().
+ * Large data can be hashed in parallel with hashTree128(), which hashes fixed size chunks and combines the chunk hashes.
+ */
+class FALCOR_API XXH3
+{
+public:
+    struct Hash128
+    {
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+        bool operator!=(const Hash128& other) const { return !(*this == other); }
+        bool operator<(const Hash128& other) const { return high != other.high ? high < other.high : low < other.low; }
+    };
+
+    /// Default chunk size for tree hashing.
+    static constexpr size_t kDefaultChunkSize = 4 * 1024 * 1024;
+
+    /**
+     * Create a hash state for streaming.
+     * @param[in] seed Seed value.
+     */
+    explicit XXH3(uint64_t seed = 0);
+
+    /**
+     * Update hash by adding the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     */
+    void update(const void* data, size_t len);
+
+    /**
+     * Update hash by adding one value of fundamental type T.
+     * @param[in] Value to hash.
+     */
+    template<typename T, std::enable_if_t<std::is_fundamental<T>::value, bool> = true>
+    void update(const T& value)
+    {
+        update(&value, sizeof(value));
+    }
+
+    /**
+     * Update hash by adding the given string view.
+     */
+    void update(const std::string_view str) { update(str.data(), str.size()); }
+
+    /**
+     * Return the 64-bit hash of the data added so far. More data can be added afterwards.
+     */
+    uint64_t digest64() const;
+
+    /**
+     * Return the 128-bit hash of the data added so far. More data can be added afterwards.
+     */
+    Hash128 digest128() const;
+
+    /**
+     * Compute 64-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     */
+    static uint64_t hash64(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     */
+    static Hash128 hash128(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit tree hash over the given data.
+     * The data is split into chunks that are hashed in parallel, the result is the hash of the chunk hashes.
+     * Data that fits into a single chunk has the same hash as with hash128(). Otherwise the result depends on the chunk size.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] chunkSize Chunk size in bytes.
+     * @param[in] seed Seed value.
+     */
+    static Hash128 hashTree128(const void* data, size_t len, size_t chunkSize = kDefaultChunkSize, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit tree hash over the content of a file, see hashTree128(). The file is memory mapped.
+     * Throws if the file cannot be read.
+     * @param[in] path File path.
+     * @param[in] chunkSize Chunk size in bytes.
+     */
+    static Hash128 hashFile(const std::filesystem::path& path, size_t chunkSize = kDefaultChunkSize);
+
+    /**
+     * Convert 128-bit hash to 32-character string in hexadecimal notation (canonical big endian representation).
+     */
+    static std::string toString(const Hash128& hash);
+
+private:
+    static constexpr size_t kSecretSize = 192;
+    static constexpr size_t kBufferSize = 256;
+
+    void digestLong(uint64_t acc[8]) const;
+
+    alignas(64) uint64_t mAcc[8];
+    alignas(64) uint8_t mSecret[kSecretSize];
+    alignas(64) uint8_t mBuffer[kBufferSize];
+    uint64_t mSeed;
+    uint64_t mTotalLen = 0;
+    size_t mBufferedSize = 0;
+    size_t mStripesSoFar = 0;
+};
 }; // namespace Falcor
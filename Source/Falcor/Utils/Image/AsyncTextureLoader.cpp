@@ -28,6 +28,7 @@
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
 #include "Utils/Threading.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -36,14 +37,13 @@ namespace
 constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
 }
 
-AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
-{
-    runWorkers(threadCount);
-}
+AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount, std::shared_ptr<TextureCache> pTextureCache)
+    : mpDevice(pDevice), mpTextureCache(std::move(pTextureCache)), mMaxConcurrentLoads(std::max<size_t>(1, threadCount))
+{}
 
 AsyncTextureLoader::~AsyncTextureLoader()
 {
-    terminateWorkers();
+    waitForRequests();
 
     mpDevice->wait();
 }
@@ -56,10 +56,16 @@ std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
     LoadCallback callback
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    std::future<ref<Texture>> future;
+    std::vector<std::shared_ptr<LoadRequest>> requests;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, 0.5f, callback});
+        future = mLoadRequestQueue.back().promise.get_future();
+        requests = takeRequests();
+    }
+    dispatchRequests(std::move(requests));
+    return future;
 }
 
 std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
@@ -68,81 +74,76 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
     Bitmap::ImportFlags importFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    float alphaCutoff
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    std::future<ref<Texture>> future;
+    std::vector<std::shared_ptr<LoadRequest>> requests;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff, callback});
+        future = mLoadRequestQueue.back().promise.get_future();
+        requests = takeRequests();
+    }
+    dispatchRequests(std::move(requests));
+    return future;
 }
 
-void AsyncTextureLoader::runWorkers(size_t threadCount)
+std::vector<std::shared_ptr<AsyncTextureLoader::LoadRequest>> AsyncTextureLoader::takeRequests()
 {
-    // Create a barrier to synchronize worker threads before issuing a global flush.
-    mFlushBarrier = std::make_shared<Barrier>(
-        threadCount,
-        [&]()
-        {
-            mpDevice->wait();
-            mFlushPending = false;
-            mUploadCounter = 0;
-        }
-    );
-
-    for (size_t i = 0; i < threadCount; ++i)
+    std::vector<std::shared_ptr<LoadRequest>> requests;
+    while (!mFlushPending && mRunningCount < mMaxConcurrentLoads && !mLoadRequestQueue.empty())
     {
-        mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
+        requests.push_back(std::make_shared<LoadRequest>(std::move(mLoadRequestQueue.front())));
+        mLoadRequestQueue.pop();
+        mRunningCount++;
     }
+    return requests;
 }
 
-void AsyncTextureLoader::runWorker()
+void AsyncTextureLoader::dispatchRequests(std::vector<std::shared_ptr<LoadRequest>> requests)
 {
-    // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
-    // To avoid the upload heap growing too large, we synchronize the threads and
-    // issue a global GPU flush at regular intervals.
+    // Dispatch outside of the critical section, the scheduler runs tasks inline when it is not started.
+    for (auto& pRequest : requests)
+        Threading::dispatchTask([this, pRequest]() { executeRequest(*pRequest); }, Threading::Priority::Low);
+}
 
-    while (true)
+void AsyncTextureLoader::executeRequest(LoadRequest& request)
+{
+    // Load the textures (this part is running in parallel).
+    // Exceptions are forwarded to the future, the bookkeeping below must run in any case.
+    ref<Texture> pTexture;
+    try
     {
-        // Wait on condition until more work is ready.
-        std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
-
-        // Sync thread if a flush is pending.
-        if (mFlushPending)
+        if (request.paths.size() == 1 && mpTextureCache)
         {
-            lock.unlock();
-            mFlushBarrier->wait();
-            mCondition.notify_one();
-            continue;
+            pTexture = mpTextureCache->loadFromFile(
+                mpDevice,
+                request.paths[0],
+                request.generateMipLevels,
+                request.loadAsSRGB,
+                request.bindFlags,
+                request.importFlags,
+                request.alphaCutoff
+            );
         }
-
-        // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
-            break;
-
-        // Go back waiting if queue is currently empty.
-        if (mLoadRequestQueue.empty())
-            continue;
-
-        // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
-        mLoadRequestQueue.pop();
-
-        lock.unlock();
-
-        // Load the textures (this part is running in parallel).
-        ref<Texture> pTexture;
-        if (request.paths.size() == 1)
+        else if (request.paths.size() == 1)
         {
             pTexture = Texture::createFromFile(
-                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
+                mpDevice,
+                request.paths[0],
+                request.generateMipLevels,
+                request.loadAsSRGB,
+                request.bindFlags,
+                request.importFlags,
+                request.alphaCutoff
             );
         }
         else
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
+            pTexture =
+                Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
         }
 
         request.promise.set_value(pTexture);
@@ -151,31 +152,50 @@ void AsyncTextureLoader::runWorker()
         {
             request.callback(pTexture);
         }
-
-        lock.lock();
-
-        // Issue a global flush if necessary.
-        // TODO: It would be better to check the size of the upload heap instead.
-        if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
+    }
+    catch (...)
+    {
+        try
         {
-            mFlushPending = true;
-            mCondition.notify_all();
+            request.promise.set_exception(std::current_exception());
         }
-
-        mCondition.notify_one();
+        catch (const std::future_error&)
+        {
+            // The promise was already satisfied, the callback threw.
+        }
+        pTexture = nullptr;
     }
-}
 
-void AsyncTextureLoader::terminateWorkers()
-{
+    // To avoid the upload heap growing too large, we stop starting new loads and issue a global GPU flush
+    // at regular intervals. The last running load performs the flush.
+    // TODO: It would be better to check the size of the upload heap instead.
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
+        mFlushPending = true;
+
+    if (mFlushPending && mRunningCount == 1)
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mTerminate = true;
+        // Stay counted as running while flushing, so the destructor waits for the flush.
+        lock.unlock();
+        mpDevice->wait();
+        lock.lock();
+        mFlushPending = false;
+        mUploadCounter = 0;
     }
 
+    // Take the next requests in the same critical section, so the running count only drops to zero once all work is done.
+    mRunningCount--;
+    auto requests = takeRequests();
     mCondition.notify_all();
+    lock.unlock();
 
-    for (auto& thread : mThreads)
-        thread.join();
+    dispatchRequests(std::move(requests));
+}
+
+void AsyncTextureLoader::waitForRequests()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTerminate = true;
+    mCondition.wait(lock, [&]() { return mRunningCount == 0 && mLoadRequestQueue.empty(); });
 }
 } // namespace Falcor
@@ -30,6 +30,7 @@
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include "TextureCache.h"
 #include <condition_variable>
 #include <filesystem>
 #include <functional>
@@ -42,10 +43,9 @@
 
 namespace Falcor
 {
-class Barrier;
-
 /**
- * Utility class to load textures asynchronously using multiple worker threads.
+ * Utility class to load textures asynchronously.
+ * Loads are executed as low priority tasks on the global scheduler (see Threading).
  */
 class FALCOR_API AsyncTextureLoader
 {
@@ -54,13 +54,18 @@ public:
 
     /**
      * Constructor.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] threadCount Max number of textures loaded concurrently.
+     * @param[in] pTextureCache Optional texture cache to load single-file textures through.
      */
-    AsyncTextureLoader(ref<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
+    AsyncTextureLoader(
+        ref<Device> pDevice,
+        size_t threadCount = std::thread::hardware_concurrency(),
+        std::shared_ptr<TextureCache> pTextureCache = nullptr
+    );
 
     /**
      * Destructor.
-     * Blocks until all threads have terminated.
+     * Blocks until all pending requests have finished.
      */
     ~AsyncTextureLoader();
 
@@ -89,6 +94,7 @@ public:
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] callback Function called after the texture load has finished.
+     * @param[in] alphaCutoff Alpha test threshold used with Bitmap::ImportFlags::PreserveAlphaCoverage.
      * @return A future to a new texture, or nullptr if the texture failed to load.
      */
     std::future<ref<Texture>> loadFromFile(
@@ -97,14 +103,11 @@ public:
         bool loadAsSRGB,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        float alphaCutoff = 0.5f
     );
 
 private:
-    void runWorkers(size_t threadCount);
-    void runWorker();
-    void terminateWorkers();
-
     struct LoadRequest
     {
         std::vector<std::filesystem::path> paths;
@@ -112,21 +115,31 @@ private:
         bool loadAsSRGB;
         ResourceBindFlags bindFlags;
         Bitmap::ImportFlags importFlags;
+        float alphaCutoff;
         LoadCallback callback;
         std::promise<ref<Texture>> promise;
     };
 
+    /// Take pending requests while below the concurrency limit and no flush is pending. Must be called in the critical section.
+    std::vector<std::shared_ptr<LoadRequest>> takeRequests();
+    /// Dispatch requests to the scheduler. Must be called outside the critical section.
+    void dispatchRequests(std::vector<std::shared_ptr<LoadRequest>> requests);
+    void executeRequest(LoadRequest& request);
+    void waitForRequests();
+
     ref<Device> mpDevice;
+    std::shared_ptr<TextureCache> mpTextureCache;
+
+    size_t mMaxConcurrentLoads;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
-    std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
-    std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
-    std::vector<std::thread> mThreads;      ///< Worker threads.
+    std::mutex mMutex;                  ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable mCondition; ///< Condition variable to wait for pending requests.
 
     // Internal state. Do not access outside of critical section.
     std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
 
-    bool mTerminate = false;     ///< Flag to terminate worker threads.
+    size_t mRunningCount = 0;    ///< Number of requests currently executing.
+    bool mTerminate = false;     ///< Flag to skip flushes while shutting down.
     bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
     uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads.
 };
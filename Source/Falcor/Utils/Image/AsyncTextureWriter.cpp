@@ -0,0 +1,301 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncTextureWriter.h"
+#include "Core/Error.h"
+#include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+
+namespace Falcor
+{
+AsyncTextureWriter::AsyncTextureWriter(ref<Device> pDevice, const Options& options) : mpDevice(pDevice), mOptions(options)
+{
+    mOptions.maxFramesInFlight = std::max(1u, mOptions.maxFramesInFlight);
+    mOptions.maxConcurrentEncodes = std::max(1u, mOptions.maxConcurrentEncodes);
+}
+
+AsyncTextureWriter::~AsyncTextureWriter()
+{
+    flush();
+}
+
+void AsyncTextureWriter::write(
+    RenderContext* pRenderContext,
+    const ref<Texture>& pTexture,
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    const std::filesystem::path& path,
+    Bitmap::FileFormat fileFormat,
+    Bitmap::ExportFlags exportFlags,
+    uint64_t frameID
+)
+{
+    FALCOR_CHECK(pTexture && pTexture->getType() == Resource::Type::Texture2D, "AsyncTextureWriter only supports 2D textures.");
+    FALCOR_CHECK(fileFormat != Bitmap::FileFormat::DdsFile, "AsyncTextureWriter does not support saving to DDS.");
+
+    poll();
+
+    // Handle the special case where we have an HDR texture with less then 3 channels (see Texture::captureToFile()).
+    ref<Texture> pSrc = pTexture;
+    uint32_t subresource = pTexture->getSubresourceIndex(arraySlice, mipLevel);
+    const ResourceFormat srcFormat = pTexture->getFormat();
+    if (getFormatType(srcFormat) == FormatType::Float && getFormatChannelCount(srcFormat) < 3)
+    {
+        pSrc = mpDevice->createTexture2D(
+            pTexture->getWidth(mipLevel),
+            pTexture->getHeight(mipLevel),
+            ResourceFormat::RGBA32Float,
+            1,
+            1,
+            nullptr,
+            ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
+        );
+        pRenderContext->blit(pTexture->getSRV(mipLevel, 1, arraySlice, 1), pSrc->getRTV(0, 0, 1));
+        subresource = 0;
+    }
+
+    auto pImage = std::make_shared<Image>();
+    pImage->frameID = frameID;
+    pImage->path = path;
+    pImage->fileFormat = fileFormat;
+    pImage->exportFlags = exportFlags;
+    pImage->format = pSrc->getFormat();
+    pImage->width = pTexture->getWidth(mipLevel);
+    pImage->height = pTexture->getHeight(mipLevel);
+
+    const uint64_t stagingSize = CopyContext::ReadTextureTask::getStagingBufferSize(pRenderContext, pSrc.get(), subresource);
+    pImage->byteCount = stagingSize;
+
+    // Apply back-pressure before adding more work.
+    const auto stallStartTime = CpuTimer::getCurrentTimePoint();
+    const bool isNewFrame = mPendingReadbacks.empty() || mPendingReadbacks.back()->frameID != frameID;
+    // Limit the number of frames with outstanding readbacks, this waits for the GPU.
+    while (isNewFrame && getFramesInReadback() >= mOptions.maxFramesInFlight)
+        completeReadback();
+    // Limit the amount of data in flight, this waits for the encoders (and the disk).
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mPendingBytes == 0 || mPendingBytes + stagingSize <= mOptions.maxPendingBytes)
+                break;
+            if (mPendingReadbacks.empty())
+            {
+                mCondition.wait(lock);
+                continue;
+            }
+        }
+        completeReadback();
+    }
+    const double stallTimeMs = CpuTimer::calcDuration(stallStartTime, CpuTimer::getCurrentTimePoint());
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto [it, inserted] = mFrames.try_emplace(frameID);
+        FrameRecord& frame = it->second;
+        if (inserted)
+        {
+            frame.stats.frameID = frameID;
+            frame.startTime = stallStartTime;
+        }
+        frame.stats.imageCount++;
+        frame.stats.byteCount += stagingSize;
+        frame.stats.stallTimeMs += stallTimeMs;
+        frame.pendingCount++;
+        mTotals.stallTimeMs += stallTimeMs;
+        mPendingImageCount++;
+        mPendingBytes += stagingSize;
+    }
+
+    // Record the copy into a pooled readback buffer. The GPU is not waited on here.
+    ref<Buffer> pStagingBuffer = takeStagingBuffer(stagingSize);
+    const bool isNewBuffer = pStagingBuffer == nullptr;
+    pImage->pReadback = pRenderContext->asyncReadTextureSubresource(pSrc.get(), subresource, std::move(pStagingBuffer));
+    if (isNewBuffer)
+    {
+        mStagingBufferCount++;
+        mStagingMemoryInBytes += pImage->pReadback->getStagingBuffer()->getSize();
+    }
+    mPendingReadbacks.push_back(std::move(pImage));
+}
+
+void AsyncTextureWriter::poll()
+{
+    while (!mPendingReadbacks.empty() && mPendingReadbacks.front()->pReadback->isReady())
+        completeReadback();
+}
+
+void AsyncTextureWriter::flush()
+{
+    while (!mPendingReadbacks.empty())
+        completeReadback();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [&]() { return mPendingImageCount == 0; });
+}
+
+AsyncTextureWriter::Stats AsyncTextureWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mTotals;
+    stats.pendingImageCount = mPendingImageCount;
+    stats.pendingBytes = mPendingBytes;
+    stats.stagingBufferCount = mStagingBufferCount;
+    stats.stagingMemoryInBytes = mStagingMemoryInBytes;
+    stats.recentFrames.assign(mRecentFrames.begin(), mRecentFrames.end());
+    return stats;
+}
+
+uint32_t AsyncTextureWriter::getFramesInReadback() const
+{
+    uint32_t count = 0;
+    for (size_t i = 0; i < mPendingReadbacks.size(); i++)
+    {
+        if (i == 0 || mPendingReadbacks[i]->frameID != mPendingReadbacks[i - 1]->frameID)
+            count++;
+    }
+    return count;
+}
+
+ref<Buffer> AsyncTextureWriter::takeStagingBuffer(uint64_t size)
+{
+    // Use the smallest free buffer that fits. Buffers are only allocated when none fits, so the pool
+    // grows to the peak number of readbacks in flight.
+    auto best = mFreeStagingBuffers.end();
+    for (auto it = mFreeStagingBuffers.begin(); it != mFreeStagingBuffers.end(); ++it)
+    {
+        if ((*it)->getSize() >= size && (best == mFreeStagingBuffers.end() || (*it)->getSize() < (*best)->getSize()))
+            best = it;
+    }
+    if (best == mFreeStagingBuffers.end())
+        return nullptr;
+    ref<Buffer> pBuffer = std::move(*best);
+    mFreeStagingBuffers.erase(best);
+    return pBuffer;
+}
+
+void AsyncTextureWriter::completeReadback()
+{
+    FALCOR_ASSERT(!mPendingReadbacks.empty());
+    std::shared_ptr<Image> pImage = std::move(mPendingReadbacks.front());
+    mPendingReadbacks.pop_front();
+
+    // This blocks if the GPU has not finished the copy yet.
+    pImage->data = pImage->pReadback->getData();
+
+    // Return the readback buffer to the pool.
+    mFreeStagingBuffers.push_back(pImage->pReadback->getStagingBuffer());
+    pImage->pReadback.reset();
+
+    std::vector<std::shared_ptr<Image>> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        FrameRecord& frame = mFrames.at(pImage->frameID);
+        frame.stats.readbackLatencyMs = CpuTimer::calcDuration(frame.startTime, CpuTimer::getCurrentTimePoint());
+        mEncodeQueue.push_back(std::move(pImage));
+        jobs = takeEncodeJobs();
+    }
+    dispatchEncodeJobs(std::move(jobs));
+}
+
+std::vector<std::shared_ptr<AsyncTextureWriter::Image>> AsyncTextureWriter::takeEncodeJobs()
+{
+    std::vector<std::shared_ptr<Image>> jobs;
+    while (mRunningEncodeCount < mOptions.maxConcurrentEncodes && !mEncodeQueue.empty())
+    {
+        jobs.push_back(std::move(mEncodeQueue.front()));
+        mEncodeQueue.pop_front();
+        mRunningEncodeCount++;
+    }
+    return jobs;
+}
+
+void AsyncTextureWriter::dispatchEncodeJobs(std::vector<std::shared_ptr<Image>> images)
+{
+    // Dispatch outside of the critical section, the scheduler runs tasks inline when it is not started.
+    for (auto& pImage : images)
+        Threading::dispatchTask([this, pImage]() { encode(*pImage); }, Threading::Priority::Low);
+}
+
+void AsyncTextureWriter::encode(Image& image)
+{
+    bool succeeded = true;
+    try
+    {
+        Bitmap::saveImage(
+            image.path, image.width, image.height, image.fileFormat, image.exportFlags, image.format, true, (void*)image.data.data()
+        );
+    }
+    catch (const std::exception& e)
+    {
+        logError("Failed to write image '{}': {}", image.path, e.what());
+        succeeded = false;
+    }
+    image.data = {};
+
+    std::vector<std::shared_ptr<Image>> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunningEncodeCount--;
+        mPendingImageCount--;
+        mPendingBytes -= image.byteCount;
+        if (succeeded)
+        {
+            mTotals.imageCount++;
+            mTotals.byteCount += image.byteCount;
+        }
+        else
+        {
+            mTotals.failedCount++;
+        }
+
+        auto it = mFrames.find(image.frameID);
+        FALCOR_ASSERT(it != mFrames.end());
+        if (--it->second.pendingCount == 0)
+        {
+            // All images of the frame are written. Note that images of a frame may be written in several batches
+            // if the frame ID is reused, each batch is reported separately.
+            FrameStats stats = it->second.stats;
+            stats.totalLatencyMs = CpuTimer::calcDuration(it->second.startTime, CpuTimer::getCurrentTimePoint());
+            mFrames.erase(it);
+
+            mTotals.frameCount++;
+            mTotals.maxTotalLatencyMs = std::max(mTotals.maxTotalLatencyMs, stats.totalLatencyMs);
+            mRecentFrames.push_back(stats);
+            while (mRecentFrames.size() > mOptions.maxStatsFrameCount)
+                mRecentFrames.pop_front();
+        }
+
+        jobs = takeEncodeJobs();
+        mCondition.notify_all();
+    }
+    dispatchEncodeJobs(std::move(jobs));
+}
+} // namespace Falcor
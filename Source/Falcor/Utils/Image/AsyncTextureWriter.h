@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/CopyContext.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Utility class to write textures to image files without stalling the GPU.
+ *
+ * Textures are copied into readback buffers taken from a pool, and the copies are only waited on once the GPU has
+ * finished them (checked with poll() or when the number of frames in flight exceeds the limit). The image data is then
+ * encoded and written as low priority tasks on the global scheduler (see Threading), with a limit on the number of
+ * concurrent encodes. When the amount of data waiting for readback or encoding exceeds the limit, write() blocks until
+ * enough images have been written, which bounds the memory use when the disk can't keep up.
+ *
+ * Images are grouped by frame ID for the latency statistics. All functions except getStats() must be called from the
+ * thread owning the render context.
+ */
+class FALCOR_API AsyncTextureWriter
+{
+public:
+    struct Options
+    {
+        uint32_t maxFramesInFlight = 3;           ///< Max number of frames with outstanding GPU readbacks.
+        uint32_t maxConcurrentEncodes = 4;        ///< Max number of images encoded concurrently.
+        uint64_t maxPendingBytes = 1024ull << 20; ///< Max bytes waiting for readback or encoding before write() blocks.
+        uint32_t maxStatsFrameCount = 256;        ///< Number of recent frames kept in the statistics.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    /// Statistics for a frame whose images have all been written.
+    struct FrameStats
+    {
+        uint64_t frameID = 0;
+        uint32_t imageCount = 0;
+        uint64_t byteCount = 0;
+        double stallTimeMs = 0.0;       ///< Time write() blocked due to back-pressure.
+        double readbackLatencyMs = 0.0; ///< Time from the first write() until all image data was read back.
+        double totalLatencyMs = 0.0;    ///< Time from the first write() until all images were written.
+    };
+
+    struct Stats
+    {
+        uint64_t frameCount = 0;        ///< Number of frames completely written.
+        uint64_t imageCount = 0;        ///< Number of images written.
+        uint64_t failedCount = 0;       ///< Number of images that failed to be written.
+        uint64_t byteCount = 0;         ///< Number of bytes of image data written.
+        double stallTimeMs = 0.0;       ///< Total time write() blocked due to back-pressure.
+        double maxTotalLatencyMs = 0.0; ///< Max frame latency from the first write() until all images were written.
+        uint32_t pendingImageCount = 0; ///< Number of images waiting for readback or encoding.
+        uint64_t pendingBytes = 0;      ///< Number of bytes waiting for readback or encoding.
+        uint32_t stagingBufferCount = 0;
+        uint64_t stagingMemoryInBytes = 0;
+        std::vector<FrameStats> recentFrames; ///< Most recent completed frames, oldest first.
+    };
+
+    AsyncTextureWriter(ref<Device> pDevice, const Options& options = Options());
+
+    /**
+     * Destructor. Blocks until all images have been written.
+     */
+    ~AsyncTextureWriter();
+
+    /**
+     * Request writing a 2D texture subresource to an image file.
+     * @param[in] pRenderContext Render context used to record the copy.
+     * @param[in] pTexture Texture to write. The texture can be modified or released right after this call.
+     * @param[in] mipLevel Mip level.
+     * @param[in] arraySlice Array slice.
+     * @param[in] path File path.
+     * @param[in] fileFormat File format, DDS is not supported.
+     * @param[in] exportFlags Export flags.
+     * @param[in] frameID Frame the image belongs to, used for the statistics.
+     */
+    void write(
+        RenderContext* pRenderContext,
+        const ref<Texture>& pTexture,
+        uint32_t mipLevel,
+        uint32_t arraySlice,
+        const std::filesystem::path& path,
+        Bitmap::FileFormat fileFormat,
+        Bitmap::ExportFlags exportFlags,
+        uint64_t frameID
+    );
+
+    /**
+     * Start encoding images whose readback has finished. This never blocks and should be called once per frame.
+     */
+    void poll();
+
+    /**
+     * Block until all images have been written.
+     */
+    void flush();
+
+    Stats getStats() const;
+
+    const Options& getOptions() const { return mOptions; }
+
+private:
+    struct Image
+    {
+        uint64_t frameID = 0;
+        std::filesystem::path path;
+        Bitmap::FileFormat fileFormat;
+        Bitmap::ExportFlags exportFlags;
+        ResourceFormat format;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t byteCount = 0;
+        CopyContext::ReadTextureTask::SharedPtr pReadback;
+        std::vector<uint8_t> data;
+    };
+
+    struct FrameRecord
+    {
+        FrameStats stats;
+        uint32_t pendingCount = 0;
+        CpuTimer::TimePoint startTime;
+    };
+
+    uint32_t getFramesInReadback() const;
+    ref<Buffer> takeStagingBuffer(uint64_t size);
+    void completeReadback();
+    /// Take encode jobs while below the concurrency limit. Must be called in the critical section.
+    std::vector<std::shared_ptr<Image>> takeEncodeJobs();
+    /// Dispatch encode jobs to the scheduler. Must be called outside the critical section.
+    void dispatchEncodeJobs(std::vector<std::shared_ptr<Image>> images);
+    void encode(Image& image);
+
+    ref<Device> mpDevice;
+    Options mOptions;
+
+    // State owned by the render thread.
+    std::deque<std::shared_ptr<Image>> mPendingReadbacks; ///< Images waiting for readback, in submission order.
+    std::vector<ref<Buffer>> mFreeStagingBuffers;         ///< Readback buffers ready for reuse.
+    uint32_t mStagingBufferCount = 0;
+    uint64_t mStagingMemoryInBytes = 0;
+
+    // State shared with the encode tasks. Do not access outside of critical section.
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::shared_ptr<Image>> mEncodeQueue;
+    uint32_t mRunningEncodeCount = 0;
+    uint32_t mPendingImageCount = 0;
+    uint64_t mPendingBytes = 0;
+    std::map<uint64_t, FrameRecord> mFrames;
+    std::deque<FrameStats> mRecentFrames;
+    Stats mTotals; ///< Accumulated statistics, without the pending and recent frame fields.
+};
+} // namespace Falcor
@@ -26,12 +26,14 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "ImageDecoder.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Math/ScalarMath.h"
 #include "Utils/Math/Float16.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/StringUtils.h"
 
 #if FALCOR_WINDOWS
@@ -42,6 +44,9 @@
 #endif
 #include <FreeImage.h>
 
+#include <algorithm>
+#include <execution>
+
 namespace Falcor
 {
 static bool isRGB32fSupported()
@@ -68,17 +73,33 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
 static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
     std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
+    const uint16_t* pSrc = reinterpret_cast<const uint16_t*>(pData);
+
+    // Convert the rows in parallel, each with a single batch conversion.
+    NumericRange<uint32_t> rows(0, height);
+    std::for_each(
+        std::execution::par,
+        rows.begin(),
+        rows.end(),
+        [&](uint32_t y)
         {
-            *pDst++ = float(*pSrc++);
+            const uint16_t* pSrcRow = pSrc + size_t(y) * width * channelCount;
+            float* pDst = newData.data() + size_t(y) * width * 4;
+            if (channelCount == 4)
+            {
+                math::float16ToFloat32(pSrcRow, pDst, size_t(width) * 4);
+                return;
+            }
+
+            std::vector<float> row(size_t(width) * channelCount);
+            math::float16ToFloat32(pSrcRow, row.data(), row.size());
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < channelCount; ++c)
+                    pDst[x * 4 + c] = row[x * channelCount + c];
+            }
         }
-        pDst += (4 - channelCount);
-    }
+    );
 
     return newData;
 }
@@ -214,22 +235,33 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
-    for (uint32_t y = 0; y < height; y++)
-    {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
-
-        for (uint32_t x = 0; x < width; x++)
+    // Convert the rows in parallel, each with a single batch conversion.
+    // A "dummy" alpha of 1.0 is added if the source format doesn't have alpha.
+    NumericRange<uint32_t> rows(0, height);
+    std::for_each(
+        std::execution::par,
+        rows.begin(),
+        rows.end(),
+        [&](uint32_t y)
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            const float* src_row = (const float*)(src_bits + size_t(y) * src_pitch);
+            uint16_t* dst_row = (uint16_t*)(dst_bits + size_t(y) * dst_pitch);
+            if (type == FIT_RGBAF)
+            {
+                math::float32ToFloat16(src_row, dst_row, size_t(width) * 4);
+                return;
+            }
+
+            std::vector<float> row(size_t(width) * 4, 1.f);
+            for (uint32_t x = 0; x < width; x++)
+            {
+                row[x * 4 + 0] = src_row[x * 3 + 0];
+                row[x * 4 + 1] = src_row[x * 3 + 1];
+                row[x * 4 + 2] = src_row[x * 3 + 2];
+            }
+            math::float32ToFloat16(row.data(), dst_row, row.size());
         }
-        src_bits += src_pitch;
-        dst_bits += dst_pitch;
-    }
+    );
     return pNew;
 }
 Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData)
@@ -245,6 +277,10 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         return nullptr;
     }
 
+    // Use a fast decoder if there is one for this file.
+    if (auto pBitmap = ImageDecoder::decode(path, isTopDown, importFlags))
+        return pBitmap;
+
     FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
 
     fifFormat = FreeImage_GetFileType(path.string().c_str(), 0);
@@ -341,15 +377,34 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         return nullptr;
     }
 
-    // Convert the image to RGBX image
+    // Expand 24-bit images to RGBX directly into the bitmap, instead of converting to a 32-bit image first.
     if (bpp == 24)
     {
-        bpp = 32;
-        auto pNew = FreeImage_ConvertTo32Bits(pDib);
+        UniqueConstPtr pBmp = UniqueConstPtr(new Bitmap(width, height, format));
+        NumericRange<uint32_t> rows(0, height);
+        std::for_each(
+            std::execution::par,
+            rows.begin(),
+            rows.end(),
+            [&](uint32_t y)
+            {
+                // FreeImage stores the bottom row first.
+                const BYTE* pSrc = FreeImage_GetScanLine(pDib, isTopDown ? height - 1 - y : y);
+                uint8_t* pDst = pBmp->getData() + y * pBmp->getRowPitch();
+                for (uint32_t x = 0; x < width; x++, pSrc += 3, pDst += 4)
+                {
+                    pDst[FI_RGBA_RED] = pSrc[FI_RGBA_RED];
+                    pDst[FI_RGBA_GREEN] = pSrc[FI_RGBA_GREEN];
+                    pDst[FI_RGBA_BLUE] = pSrc[FI_RGBA_BLUE];
+                    pDst[FI_RGBA_ALPHA] = 255;
+                }
+            }
+        );
         FreeImage_Unload(pDib);
-        pDib = pNew;
+        return pBmp;
     }
-    else if ((bpp == 96 || bpp == 128) && is_set(importFlags, ImportFlags::ConvertToFloat16))
+
+    if ((bpp == 96 || bpp == 128) && is_set(importFlags, ImportFlags::ConvertToFloat16))
     {
         bpp = 64;
         format = ResourceFormat::RGBA16Float;
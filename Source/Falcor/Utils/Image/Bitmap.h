@@ -53,7 +53,8 @@ public:
     enum class ImportFlags : uint32_t
     {
         None = 0u,                  ///< Default.
-        ConvertToFloat16 = 1u << 0, ///< Convert HDR images to 16-bit float per channel on import.
+        ConvertToFloat16 = 1u << 0,      ///< Convert HDR images to 16-bit float per channel on import.
+        PreserveAlphaCoverage = 1u << 1, ///< Preserve the alpha test coverage in generated mips, see MipGenerator::Options.
     };
 
     enum class FileFormat
@@ -157,6 +158,8 @@ public:
     static FileFormat getFormatFromFileExtension(const std::string& ext);
 
 protected:
+    friend class ImageDecoder;
+
     Bitmap() = default;
     Bitmap(uint32_t width, uint32_t height, ResourceFormat format);
     Bitmap(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData);
@@ -0,0 +1,481 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageDecoder.h"
+#include "Core/Error.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfThreading.h>
+#include <ImathBox.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+std::atomic<bool> gEnabled{true};
+
+const uint8_t kPngSignature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+enum PngColorType : uint8_t
+{
+    Gray = 0,
+    RGB = 2,
+    Palette = 3,
+    GrayAlpha = 4,
+    RGBA = 6,
+};
+
+uint32_t readBE32(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+bool isChunk(const uint8_t* pType, const char* name)
+{
+    return std::memcmp(pType, name, 4) == 0;
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    const int p = int(a) + int(b) - int(c);
+    const int pa = std::abs(p - int(a));
+    const int pb = std::abs(p - int(b));
+    const int pc = std::abs(p - int(c));
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+/**
+ * Reverse the PNG row filters in place.
+ * @param[in,out] pData Rows, each prefixed by its filter type.
+ * @param[in] height Number of rows.
+ * @param[in] rowBytes Row size in bytes, excluding the filter type.
+ * @param[in] bpp Bytes per pixel, rounded up to one.
+ * @return False if a row uses an invalid filter type.
+ */
+bool unfilterRows(uint8_t* pData, uint32_t height, size_t rowBytes, size_t bpp)
+{
+    // The row above the first row is defined to be zero.
+    std::vector<uint8_t> zeroRow(rowBytes, 0);
+    const uint8_t* pPrev = zeroRow.data();
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint8_t* pRow = pData + y * (rowBytes + 1);
+        const uint8_t filter = pRow[0];
+        uint8_t* p = pRow + 1;
+
+        switch (filter)
+        {
+        case 0: // None
+            break;
+        case 1: // Sub
+            for (size_t i = bpp; i < rowBytes; i++)
+                p[i] += p[i - bpp];
+            break;
+        case 2: // Up
+            for (size_t i = 0; i < rowBytes; i++)
+                p[i] += pPrev[i];
+            break;
+        case 3: // Average
+            for (size_t i = 0; i < bpp; i++)
+                p[i] += pPrev[i] >> 1;
+            for (size_t i = bpp; i < rowBytes; i++)
+                p[i] += (uint32_t(p[i - bpp]) + pPrev[i]) >> 1;
+            break;
+        case 4: // Paeth
+            for (size_t i = 0; i < bpp; i++)
+                p[i] += pPrev[i];
+            for (size_t i = bpp; i < rowBytes; i++)
+                p[i] += paeth(p[i - bpp], pPrev[i], pPrev[i - bpp]);
+            break;
+        default:
+            return false;
+        }
+        pPrev = p;
+    }
+    return true;
+}
+
+/// Swap the rows of a bitmap to flip it vertically.
+void flipRows(Bitmap& bitmap)
+{
+    const uint32_t height = bitmap.getHeight();
+    const size_t rowPitch = bitmap.getRowPitch();
+    NumericRange<uint32_t> rows(0, height / 2);
+    std::for_each(
+        std::execution::par,
+        rows.begin(),
+        rows.end(),
+        [&](uint32_t y)
+        {
+            uint8_t* pTop = bitmap.getData() + y * rowPitch;
+            uint8_t* pBottom = bitmap.getData() + (height - 1 - y) * rowPitch;
+            std::swap_ranges(pTop, pTop + rowPitch, pBottom);
+        }
+    );
+}
+
+void initExrThreadPool()
+{
+    static std::once_flag flag;
+    std::call_once(flag, []() { Imf::setGlobalThreadCount((int)std::max(1u, std::thread::hardware_concurrency())); });
+}
+} // namespace
+
+void ImageDecoder::setEnabled(bool enabled)
+{
+    gEnabled = enabled;
+}
+
+bool ImageDecoder::isEnabled()
+{
+    return gEnabled;
+}
+
+Bitmap::UniqueConstPtr ImageDecoder::decode(const std::filesystem::path& path, bool isTopDown, Bitmap::ImportFlags importFlags)
+{
+    if (!isEnabled())
+        return nullptr;
+
+    if (hasExtension(path, "png"))
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            return nullptr;
+        return decodePNG(file.getData(), file.getSize(), isTopDown);
+    }
+    if (hasExtension(path, "exr"))
+        return decodeEXR(path, isTopDown, importFlags);
+
+    return nullptr;
+}
+
+Bitmap::UniqueConstPtr ImageDecoder::decodePNG(const void* pData, size_t size, bool isTopDown)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(pData);
+    const uint8_t* pEnd = p + size;
+    if (size < sizeof(kPngSignature) || std::memcmp(p, kPngSignature, sizeof(kPngSignature)) != 0)
+        return nullptr;
+    p += sizeof(kPngSignature);
+
+    // Parse the chunks. The image data may be split into several IDAT chunks, which are inflated in sequence without joining them.
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t bitDepth = 0;
+    uint8_t colorType = 0;
+    std::vector<std::pair<const uint8_t*, uint32_t>> dataChunks;
+    while (true)
+    {
+        if (pEnd - p < 12)
+            return nullptr;
+        const uint32_t length = readBE32(p);
+        const uint8_t* pType = p + 4;
+        const uint8_t* pChunk = p + 8;
+        if (length > size_t(pEnd - pChunk) - 4)
+            return nullptr;
+
+        if (isChunk(pType, "IHDR"))
+        {
+            if (length != 13)
+                return nullptr;
+            width = readBE32(pChunk);
+            height = readBE32(pChunk + 4);
+            bitDepth = pChunk[8];
+            colorType = pChunk[9];
+            const uint8_t compression = pChunk[10];
+            const uint8_t filterMethod = pChunk[11];
+            const uint8_t interlace = pChunk[12];
+            if (compression != 0 || filterMethod != 0 || interlace != 0)
+                return nullptr;
+        }
+        else if (isChunk(pType, "IDAT"))
+        {
+            dataChunks.emplace_back(pChunk, length);
+        }
+        else if (isChunk(pType, "tRNS"))
+        {
+            // FreeImage turns color keys into an alpha channel.
+            return nullptr;
+        }
+        else if (isChunk(pType, "gAMA"))
+        {
+            // FreeImage gamma corrects images for a display gamma of 2.2, unless the correction is negligible.
+            if (length != 4)
+                return nullptr;
+            const double gamma = readBE32(pChunk) / 100000.0;
+            if (std::abs(gamma * 2.2 - 1.0) > 0.04)
+                return nullptr;
+        }
+        else if (isChunk(pType, "IEND"))
+        {
+            break;
+        }
+        p = pChunk + length + 4;
+    }
+
+    // Select the bitmap format matching the FreeImage import.
+    ResourceFormat format = ResourceFormat::Unknown;
+    uint32_t channelCount = 0;
+    switch (colorType)
+    {
+    case PngColorType::Gray:
+        format = bitDepth == 16 ? ResourceFormat::R16Unorm : ResourceFormat::R8Unorm;
+        channelCount = 1;
+        break;
+    case PngColorType::GrayAlpha:
+        format = ResourceFormat::BGRA8Unorm;
+        channelCount = 2;
+        break;
+    case PngColorType::RGB:
+        format = ResourceFormat::BGRX8Unorm;
+        channelCount = 3;
+        break;
+    case PngColorType::RGBA:
+        format = ResourceFormat::BGRA8Unorm;
+        channelCount = 4;
+        break;
+    default:
+        return nullptr;
+    }
+    if (bitDepth != 8 && !(bitDepth == 16 && colorType == PngColorType::Gray))
+        return nullptr;
+
+    if (width == 0 || height == 0 || dataChunks.empty())
+        return nullptr;
+    if (uint64_t(width) * height * getFormatBytesPerBlock(format) > std::numeric_limits<uint32_t>::max())
+        return nullptr;
+
+    const size_t bpp = channelCount * bitDepth / 8;
+    const size_t rowBytes = size_t(width) * bpp;
+    std::vector<uint8_t> rows(size_t(height) * (rowBytes + 1));
+
+    // Inflate the image data.
+    z_stream zs = {};
+    if (inflateInit(&zs) != Z_OK)
+        return nullptr;
+    zs.next_out = rows.data();
+    zs.avail_out = (uInt)rows.size();
+    int ret = Z_OK;
+    for (const auto& [pChunk, length] : dataChunks)
+    {
+        zs.next_in = const_cast<Bytef*>(pChunk);
+        zs.avail_in = length;
+        while (zs.avail_in > 0 && ret == Z_OK)
+            ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK)
+            break;
+    }
+    inflateEnd(&zs);
+    if (ret != Z_STREAM_END || zs.avail_out != 0)
+    {
+        logDebug("Invalid PNG image data (zlib error {}).", ret);
+        return nullptr;
+    }
+
+    // Reversing the filters is sequential, as each row depends on the previous one.
+    if (!unfilterRows(rows.data(), height, rowBytes, bpp))
+    {
+        logDebug("Invalid PNG filter type.");
+        return nullptr;
+    }
+
+    // Convert the rows to the bitmap format in parallel.
+    Bitmap::UniquePtr pBitmap(new Bitmap(width, height, format));
+    const size_t rowPitch = pBitmap->getRowPitch();
+    NumericRange<uint32_t> rowRange(0, height);
+    std::for_each(
+        std::execution::par,
+        rowRange.begin(),
+        rowRange.end(),
+        [&](uint32_t y)
+        {
+            const uint8_t* pSrc = rows.data() + y * (rowBytes + 1) + 1;
+            uint8_t* pDst = pBitmap->getData() + (isTopDown ? y : height - 1 - y) * rowPitch;
+            switch (colorType)
+            {
+            case PngColorType::Gray:
+                if (bitDepth == 8)
+                {
+                    std::memcpy(pDst, pSrc, rowBytes);
+                }
+                else
+                {
+                    // 16-bit values are stored in big endian order.
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        pDst[2 * x + 0] = pSrc[2 * x + 1];
+                        pDst[2 * x + 1] = pSrc[2 * x + 0];
+                    }
+                }
+                break;
+            case PngColorType::GrayAlpha:
+                for (uint32_t x = 0; x < width; x++, pSrc += 2, pDst += 4)
+                {
+                    pDst[0] = pDst[1] = pDst[2] = pSrc[0];
+                    pDst[3] = pSrc[1];
+                }
+                break;
+            case PngColorType::RGB:
+                for (uint32_t x = 0; x < width; x++, pSrc += 3, pDst += 4)
+                {
+                    pDst[0] = pSrc[2];
+                    pDst[1] = pSrc[1];
+                    pDst[2] = pSrc[0];
+                    pDst[3] = 255;
+                }
+                break;
+            case PngColorType::RGBA:
+                for (uint32_t x = 0; x < width; x++, pSrc += 4, pDst += 4)
+                {
+                    pDst[0] = pSrc[2];
+                    pDst[1] = pSrc[1];
+                    pDst[2] = pSrc[0];
+                    pDst[3] = pSrc[3];
+                }
+                break;
+            }
+        }
+    );
+
+    return pBitmap;
+}
+
+Bitmap::UniqueConstPtr ImageDecoder::decodeEXR(const std::filesystem::path& path, bool isTopDown, Bitmap::ImportFlags importFlags)
+{
+    try
+    {
+        initExrThreadPool();
+
+        // Opens the first part of multi-part files. Tiled files are handled transparently.
+        Imf::InputFile file(path.string().c_str(), Imf::globalThreadCount());
+        const Imf::Header& header = file.header();
+        const Imath::Box2i& dataWindow = header.dataWindow();
+        const int64_t width = int64_t(dataWindow.max.x) - dataWindow.min.x + 1;
+        const int64_t height = int64_t(dataWindow.max.y) - dataWindow.min.y + 1;
+        if (width <= 0 || height <= 0)
+            return nullptr;
+
+        // Only handle RGB(A) images with full resolution half or float channels.
+        const char* kChannelNames[] = {"R", "G", "B", "A"};
+        bool allHalf = true;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            const Imf::Channel* pChannel = header.channels().findChannel(kChannelNames[i]);
+            if (!pChannel)
+            {
+                if (i < 3)
+                    return nullptr;
+                continue;
+            }
+            if (pChannel->xSampling != 1 || pChannel->ySampling != 1 || pChannel->type == Imf::UINT)
+                return nullptr;
+            allHalf = allHalf && pChannel->type == Imf::HALF;
+        }
+
+        const bool convertToHalf = is_set(importFlags, Bitmap::ImportFlags::ConvertToFloat16);
+        const ResourceFormat format = convertToHalf ? ResourceFormat::RGBA16Float : ResourceFormat::RGBA32Float;
+        if (uint64_t(width) * height * getFormatBytesPerBlock(format) > std::numeric_limits<uint32_t>::max())
+            return nullptr;
+
+        Bitmap::UniquePtr pBitmap(new Bitmap((uint32_t)width, (uint32_t)height, format));
+
+        // Half channels are read directly into a half bitmap. Float channels that need to be converted to half are read
+        // into a temporary buffer and converted with the same rounding as the FreeImage path.
+        const bool readHalf = convertToHalf && allHalf;
+        std::vector<float> floatData;
+        char* pBase = reinterpret_cast<char*>(pBitmap->getData());
+        if (convertToHalf && !allHalf)
+        {
+            floatData.resize(size_t(width) * height * 4);
+            pBase = reinterpret_cast<char*>(floatData.data());
+        }
+
+        const size_t channelSize = readHalf ? sizeof(uint16_t) : sizeof(float);
+        const size_t texelSize = 4 * channelSize;
+        const size_t rowPitch = texelSize * width;
+
+        // The frame buffer is addressed in data window coordinates. Missing alpha is filled with one.
+        char* pOrigin = pBase - dataWindow.min.x * int64_t(texelSize) - dataWindow.min.y * int64_t(rowPitch);
+        Imf::FrameBuffer frameBuffer;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            frameBuffer.insert(
+                kChannelNames[i],
+                Imf::Slice(readHalf ? Imf::HALF : Imf::FLOAT, pOrigin + i * channelSize, texelSize, rowPitch, 1, 1, i == 3 ? 1.0 : 0.0)
+            );
+        }
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(dataWindow.min.y, dataWindow.max.y);
+
+        if (!floatData.empty())
+        {
+            NumericRange<uint32_t> rows(0, (uint32_t)height);
+            std::for_each(
+                std::execution::par,
+                rows.begin(),
+                rows.end(),
+                [&](uint32_t y)
+                {
+                    const size_t offset = size_t(y) * width * 4;
+                    math::float32ToFloat16(floatData.data() + offset, reinterpret_cast<uint16_t*>(pBitmap->getData()) + offset, width * 4);
+                }
+            );
+        }
+
+        if (!isTopDown)
+            flipRows(*pBitmap);
+
+        return pBitmap;
+    }
+    catch (const std::exception& e)
+    {
+        logDebug("Can't decode '{}' with the fast EXR decoder: {}", path, e.what());
+        return nullptr;
+    }
+}
+} // namespace Falcor
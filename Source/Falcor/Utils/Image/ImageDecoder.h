@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include <cstddef>
+#include <filesystem>
+
+namespace Falcor
+{
+/**
+ * Fast image decoders for the most common asset formats.
+ *
+ * The decoders write directly into the final bitmap layout, without the intermediate copies and format
+ * conversions of the FreeImage path. They produce the same bitmap format and data as FreeImage, and only
+ * handle the variants for which this holds. All other files are left to FreeImage.
+ *
+ * - PNG: 8-bit grayscale, grayscale with alpha, RGB and RGBA, and 16-bit grayscale, non-interlaced.
+ *   Rows are converted to the bitmap format in parallel.
+ * - EXR: RGB(A) images with half or float channels, including tiled and multi-part files (first part only).
+ *   Chunks are decompressed in parallel on the OpenEXR thread pool.
+ */
+class FALCOR_API ImageDecoder
+{
+public:
+    /**
+     * Enable or disable the fast decoders. If disabled, Bitmap::createFromFile() uses FreeImage for all files.
+     */
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    /**
+     * Decode an image file if there is a fast decoder for it.
+     * @param[in] path File path.
+     * @param[in] isTopDown If true, the top-left pixel is the first pixel in the buffer, otherwise the bottom-left pixel is first.
+     * @param[in] importFlags Import flags.
+     * @return The bitmap, or nullptr if the file is not handled by a fast decoder or failed to decode.
+     */
+    static Bitmap::UniqueConstPtr decode(const std::filesystem::path& path, bool isTopDown, Bitmap::ImportFlags importFlags);
+
+    /**
+     * Decode a PNG image from memory.
+     * @return The bitmap, or nullptr if the image uses unsupported features or is invalid.
+     */
+    static Bitmap::UniqueConstPtr decodePNG(const void* pData, size_t size, bool isTopDown);
+
+    /**
+     * Decode an OpenEXR image file.
+     * @return The bitmap, or nullptr if the image uses unsupported features or is invalid.
+     */
+    static Bitmap::UniqueConstPtr decodeEXR(const std::filesystem::path& path, bool isTopDown, Bitmap::ImportFlags importFlags);
+};
+} // namespace Falcor
@@ -330,6 +330,20 @@ void setImage(
         fillAlphaChannel(surface);
 }
 
+// Sets the surface from image data of the given dimensions.
+void setSurface(const void* pData, nvtt::Surface& surface, const ExportData& image, uint32_t width, uint32_t height, uint32_t depth)
+{
+    FormatType type = getFormatType(image.format);
+    if (type == FormatType::Sint || type == FormatType::Snorm)
+        setImage<int8_t>(pData, surface, image, width, height, depth);
+    else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
+        setImage<uint8_t>(pData, surface, image, width, height, depth);
+    else if (type == FormatType::Float && getNumChannelBits(image.format, 0) == 16)
+        setImage<float16_t>(pData, surface, image, width, height, depth);
+    else if (type == FormatType::Float && getNumChannelBits(image.format, 0) == 32)
+        setImage<float>(pData, surface, image, width, height, depth);
+}
+
 // Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
 void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips)
 {
@@ -577,7 +591,7 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
 }
 
-ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb, ResourceBindFlags bindFlags)
 {
     ImportData data;
     try
@@ -595,16 +609,20 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     switch (data.type)
     {
     case Resource::Type::Texture1D:
-        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
         break;
     case Resource::Type::Texture2D:
-        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
         break;
     case Resource::Type::TextureCube:
-        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTextureCube(
+            data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data(), bindFlags
+        );
         break;
     case Resource::Type::Texture3D:
-        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture3D(
+            data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data(), bindFlags
+        );
         break;
     default:
         logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
@@ -695,6 +713,66 @@ void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap,
     }
 }
 
+void ImageIO::saveToDDS(
+    const std::filesystem::path& path,
+    ResourceFormat format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipCount,
+    const void* pData,
+    CompressionMode mode
+)
+{
+    if (!hasExtension(path, "dds"))
+    {
+        logWarning("Saving DDS image to '{}' which does not have 'dds' file extension.", path);
+    }
+
+    try
+    {
+        FALCOR_CHECK(!isCompressedFormat(format), "Block compressed image data is not supported.");
+        FALCOR_CHECK(mipCount > 0 && mipCount <= nvtt::countMipmaps(width, height, 1), "Invalid mip count {}.", mipCount);
+
+        ExportData image;
+        image.type = nvtt::TextureType::TextureType_2D;
+        image.width = width;
+        image.height = height;
+        image.depth = 1;
+        image.format = format;
+        image.faceCount = 1;
+        image.mipLevels = mipCount;
+
+        if (getFormatChannelCount(image.format) == 2 && mode != CompressionMode::BC5)
+        {
+            FALCOR_THROW("Only BC5 compression is supported for two channel images.");
+        }
+        if (mode != CompressionMode::None && (width % 4 != 0 || height % 4 != 0))
+        {
+            FALCOR_THROW("Block compressed images must have dimensions that are a multiple of 4.");
+        }
+
+        // The mips are stored one after the other, the surface of each mip is set up with the mip dimensions.
+        const uint8_t* pMipData = static_cast<const uint8_t*>(pData);
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            ExportData mipImage = image;
+            mipImage.width = std::max(1u, width >> mip);
+            mipImage.height = std::max(1u, height >> mip);
+
+            nvtt::Surface surface;
+            setSurface(pMipData, surface, mipImage, mipImage.width, mipImage.height, 1);
+            image.images.push_back(surface);
+            pMipData += size_t(mipImage.width) * mipImage.height * getFormatBytesPerBlock(format);
+        }
+
+        exportDDS(path, image, mode, false);
+    }
+    catch (const RuntimeError& e)
+    {
+        FALCOR_THROW("Failed to save DDS image to '{}': {}", path, e.what());
+    }
+}
+
 void ImageIO::saveToDDS(
     CopyContext* pContext,
     const std::filesystem::path& path,
@@ -86,9 +86,15 @@ public:
      * @param[in] path Path of file to load.
      * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
      * changed.
+     * @param[in] bindFlags The bind flags to create the texture with.
      * @return Texture object containing image data if loading was successful. Otherwise, nullptr.
      */
-    static ref<Texture> loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb);
+    static ref<Texture> loadTextureFromDDS(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
 
     /**
      * Saves a bitmap to a DDS file.
@@ -105,6 +111,27 @@ public:
         bool generateMips = false
     );
 
+    /**
+     * Saves a 2D image with a precomputed mip chain to a DDS file.
+     * Throws an exception if path is invalid or the image cannot be saved.
+     * @param[in] path Path to save to.
+     * @param[in] format Format of the image data. Block compressed formats are not supported.
+     * @param[in] width Width of the base level.
+     * @param[in] height Height of the base level.
+     * @param[in] mipCount Number of mip levels.
+     * @param[in] pData Tightly packed data of all mip levels, starting with the base level.
+     * @param[in] mode Block compression mode. Compression requires the base level dimensions to be a multiple of 4.
+     */
+    static void saveToDDS(
+        const std::filesystem::path& path,
+        ResourceFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipCount,
+        const void* pData,
+        CompressionMode mode = CompressionMode::None
+    );
+
     /**
      * Saves a Texture to a DDS file. All mips and array images are saved.
      * Throws an exception if the path is invalid or the image cannot be saved.
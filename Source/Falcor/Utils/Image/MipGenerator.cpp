@@ -0,0 +1,636 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MipGenerator.h"
+#include "Core/Error.h"
+#include "Core/API/Device.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define FALCOR_MIP_GENERATOR_SSE2 0
+#endif
+
+namespace Falcor
+{
+namespace
+{
+/// Number of rows processed per parallel work item.
+const uint32_t kRowsPerBlock = 16;
+
+/// Number of buckets in the sRGB encoding table. Must be small enough for each bucket to contain at most one rounding threshold.
+const uint32_t kSrgbBucketCount = 4096;
+
+struct SrgbTables
+{
+    std::array<float, 256> decode;             ///< Linear value of each 8-bit sRGB value.
+    std::array<float, 256> threshold;          ///< Smallest linear value encoding to i + 1, or infinity for the last entry.
+    std::array<uint8_t, kSrgbBucketCount> base; ///< Encoded value of the lower end of each bucket.
+
+    SrgbTables()
+    {
+        auto srgbToLinear = [](double c) { return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4); };
+
+        for (uint32_t i = 0; i < 256; i++)
+            decode[i] = (float)srgbToLinear(i / 255.0);
+
+        // Values round up to i + 1 from the midpoint between i and i + 1 onwards.
+        for (uint32_t i = 0; i < 255; i++)
+            threshold[i] = (float)srgbToLinear((i + 0.5) / 255.0);
+        threshold[255] = std::numeric_limits<float>::infinity();
+
+        uint32_t code = 0;
+        for (uint32_t b = 0; b < kSrgbBucketCount; b++)
+        {
+            const float bucketStart = (float)b / kSrgbBucketCount;
+            while (threshold[code] <= bucketStart)
+                code++;
+            base[b] = (uint8_t)code;
+            FALCOR_ASSERT(code == 255 || threshold[code + 1] >= (float)(b + 1) / kSrgbBucketCount);
+        }
+    }
+
+    uint8_t encode(float value, uint32_t bucket) const
+    {
+        const uint8_t code = base[bucket];
+        return code + (value >= threshold[code] ? 1 : 0);
+    }
+
+    uint8_t encode(float value) const
+    {
+        value = value > 0.f ? std::min(value, 1.f) : 0.f; // Maps NaN to zero.
+        return encode(value, std::min((uint32_t)(value * kSrgbBucketCount), kSrgbBucketCount - 1));
+    }
+};
+
+const SrgbTables& getSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+enum class ChannelType
+{
+    Unorm8,
+    Float16,
+    Float32,
+};
+
+struct FormatLayout
+{
+    ChannelType type;
+    uint32_t channelCount; ///< Number of stored channels.
+    bool isBgr;            ///< Red and blue channels are swapped.
+    bool hasAlpha;         ///< The fourth channel holds alpha. If false, it is padding.
+    bool isSrgb;
+};
+
+FormatLayout getFormatLayout(ResourceFormat format)
+{
+    switch (format)
+    {
+    case ResourceFormat::R8Unorm:
+        return {ChannelType::Unorm8, 1, false, false, false};
+    case ResourceFormat::RG8Unorm:
+        return {ChannelType::Unorm8, 2, false, false, false};
+    case ResourceFormat::RGBA8Unorm:
+        return {ChannelType::Unorm8, 4, false, true, false};
+    case ResourceFormat::RGBA8UnormSrgb:
+        return {ChannelType::Unorm8, 4, false, true, true};
+    case ResourceFormat::BGRA8Unorm:
+        return {ChannelType::Unorm8, 4, true, true, false};
+    case ResourceFormat::BGRA8UnormSrgb:
+        return {ChannelType::Unorm8, 4, true, true, true};
+    case ResourceFormat::BGRX8Unorm:
+        return {ChannelType::Unorm8, 4, true, false, false};
+    case ResourceFormat::BGRX8UnormSrgb:
+        return {ChannelType::Unorm8, 4, true, false, true};
+    case ResourceFormat::R16Float:
+        return {ChannelType::Float16, 1, false, false, false};
+    case ResourceFormat::RG16Float:
+        return {ChannelType::Float16, 2, false, false, false};
+    case ResourceFormat::RGBA16Float:
+        return {ChannelType::Float16, 4, false, true, false};
+    case ResourceFormat::R32Float:
+        return {ChannelType::Float32, 1, false, false, false};
+    case ResourceFormat::RG32Float:
+        return {ChannelType::Float32, 2, false, false, false};
+    case ResourceFormat::RGB32Float:
+        return {ChannelType::Float32, 3, false, false, false};
+    case ResourceFormat::RGBA32Float:
+        return {ChannelType::Float32, 4, false, true, false};
+    default:
+        FALCOR_THROW("MipGenerator does not support format '{}'.", to_string(format));
+    }
+}
+
+size_t getTexelSize(const FormatLayout& layout)
+{
+    switch (layout.type)
+    {
+    case ChannelType::Unorm8:
+        return layout.channelCount;
+    case ChannelType::Float16:
+        return layout.channelCount * 2;
+    default:
+        return layout.channelCount * 4;
+    }
+}
+
+/// Call func(y) for all rows, processing blocks of rows in parallel.
+template<typename Func>
+void forEachRow(uint32_t height, Func func)
+{
+    NumericRange<uint32_t> blocks(0, (height + kRowsPerBlock - 1) / kRowsPerBlock);
+    std::for_each(
+        std::execution::par,
+        blocks.begin(),
+        blocks.end(),
+        [&](uint32_t block)
+        {
+            const uint32_t end = std::min(height, (block + 1) * kRowsPerBlock);
+            for (uint32_t y = block * kRowsPerBlock; y < end; y++)
+                func(y);
+        }
+    );
+}
+
+/// Spread a row of interleaved channels into RGBA texels. Missing color channels are zero, missing alpha is one.
+void expandRow(const float* pSrc, const FormatLayout& layout, float4* pDst, uint32_t width)
+{
+    const uint32_t n = layout.channelCount;
+    for (uint32_t x = 0; x < width; x++, pSrc += n)
+    {
+        float4 texel(0.f, 0.f, 0.f, 1.f);
+        for (uint32_t c = 0; c < std::min(n, 3u); c++)
+            texel[c] = pSrc[c];
+        if (layout.hasAlpha)
+            texel.w = pSrc[3];
+        if (layout.isBgr)
+            std::swap(texel.x, texel.z);
+        pDst[x] = texel;
+    }
+}
+
+/// Pack a row of RGBA texels into interleaved channels. Padding channels are set to one.
+void packRow(const float4* pSrc, const FormatLayout& layout, float* pDst, uint32_t width, float alphaScale)
+{
+    const uint32_t n = layout.channelCount;
+    for (uint32_t x = 0; x < width; x++, pDst += n)
+    {
+        float4 texel = pSrc[x];
+        if (layout.isBgr)
+            std::swap(texel.x, texel.z);
+        for (uint32_t c = 0; c < std::min(n, 3u); c++)
+            pDst[c] = texel[c];
+        if (n == 4)
+            pDst[3] = !layout.hasAlpha ? 1.f : alphaScale == 1.f ? texel.w : std::min(texel.w * alphaScale, 1.f);
+    }
+}
+
+uint8_t encodeUnorm8(float value)
+{
+    value = value > 0.f ? std::min(value, 1.f) : 0.f; // Maps NaN to zero.
+    return (uint8_t)(value * 255.f + 0.5f);
+}
+
+void encodeImage(const MipGenerator::Image& image, ResourceFormat format, void* pDst, float alphaScale)
+{
+    const FormatLayout layout = getFormatLayout(format);
+    const size_t rowSize = getTexelSize(layout) * image.width;
+    const uint32_t channelCount = layout.channelCount;
+
+    forEachRow(
+        image.height,
+        [&](uint32_t y)
+        {
+            std::vector<float> row(size_t(image.width) * channelCount);
+            packRow(&image.texels[size_t(y) * image.width], layout, row.data(), image.width, alphaScale);
+            uint8_t* pRow = static_cast<uint8_t*>(pDst) + y * rowSize;
+
+            switch (layout.type)
+            {
+            case ChannelType::Unorm8:
+                if (layout.isSrgb)
+                {
+                    // Encode all channels as sRGB, then fix up the linear alpha channel.
+                    MipGenerator::linearToSrgb(row.data(), pRow, row.size());
+                    for (uint32_t x = 0; x < image.width; x++)
+                        pRow[x * 4 + 3] = encodeUnorm8(row[x * 4 + 3]);
+                }
+                else
+                {
+                    for (size_t i = 0; i < row.size(); i++)
+                        pRow[i] = encodeUnorm8(row[i]);
+                }
+                break;
+            case ChannelType::Float16:
+                math::float32ToFloat16(row.data(), reinterpret_cast<uint16_t*>(pRow), row.size());
+                break;
+            case ChannelType::Float32:
+                std::memcpy(pRow, row.data(), rowSize);
+                break;
+            }
+        }
+    );
+}
+
+/// Filter taps for one destination texel.
+struct FilterTaps
+{
+    uint32_t first = 0; ///< First source texel.
+    std::vector<float> weights;
+};
+
+double besselI0(double x)
+{
+    // Power series, converges quickly for the small arguments used here.
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+double kaiser(double x, const MipGenerator::Options& options)
+{
+    const double t = x / options.kaiserWidth;
+    if (std::abs(t) >= 1.0)
+        return 0.0;
+    const double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+    return sinc * besselI0(options.kaiserAlpha * std::sqrt(1.0 - t * t)) / besselI0(options.kaiserAlpha);
+}
+
+/// Compute the filter taps for resampling a dimension. Texels outside the image are clamped to the edge.
+std::vector<FilterTaps> computeFilterTaps(uint32_t srcSize, uint32_t dstSize, const MipGenerator::Options& options)
+{
+    const double scale = (double)srcSize / dstSize;
+    std::vector<FilterTaps> taps(dstSize);
+    std::vector<double> weights;
+
+    for (uint32_t i = 0; i < dstSize; i++)
+    {
+        // Accumulate the weights of the source texels in the footprint of the destination texel.
+        uint32_t first = 0;
+        if (options.filter == MipGenerator::Filter::Box)
+        {
+            // Weight each source texel by its overlap with the footprint of the destination texel.
+            const double begin = i * scale;
+            const double end = (i + 1) * scale;
+            first = (uint32_t)begin;
+            const uint32_t last = std::min(srcSize, (uint32_t)std::ceil(end)) - 1;
+            weights.assign(last - first + 1, 0.0);
+            for (uint32_t j = first; j <= last; j++)
+                weights[j - first] = std::min(end, j + 1.0) - std::max(begin, (double)j);
+        }
+        else
+        {
+            const double center = (i + 0.5) * scale;
+            const double radius = options.kaiserWidth * scale;
+            const int64_t begin = (int64_t)std::floor(center - radius);
+            const int64_t end = (int64_t)std::ceil(center + radius);
+            first = (uint32_t)std::clamp<int64_t>(begin, 0, srcSize - 1);
+            const uint32_t last = (uint32_t)std::clamp<int64_t>(end, 0, srcSize - 1);
+            weights.assign(last - first + 1, 0.0);
+            for (int64_t j = begin; j <= end; j++)
+            {
+                const uint32_t index = (uint32_t)std::clamp<int64_t>(j, first, last);
+                weights[index - first] += kaiser((j + 0.5 - center) / scale, options);
+            }
+        }
+
+        double sum = 0.0;
+        for (double w : weights)
+            sum += w;
+        FALCOR_ASSERT(sum != 0.0);
+
+        size_t begin = 0;
+        size_t end = weights.size();
+        while (begin + 1 < end && weights[begin] == 0.0)
+            begin++;
+        while (end > begin + 1 && weights[end - 1] == 0.0)
+            end--;
+
+        taps[i].first = first + (uint32_t)begin;
+        taps[i].weights.reserve(end - begin);
+        for (size_t j = begin; j < end; j++)
+            taps[i].weights.push_back((float)(weights[j] / sum));
+    }
+    return taps;
+}
+} // namespace
+
+bool MipGenerator::isSupported(ResourceFormat format)
+{
+    switch (format)
+    {
+    case ResourceFormat::R8Unorm:
+    case ResourceFormat::RG8Unorm:
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::RGBA8UnormSrgb:
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+    case ResourceFormat::R16Float:
+    case ResourceFormat::RG16Float:
+    case ResourceFormat::RGBA16Float:
+    case ResourceFormat::R32Float:
+    case ResourceFormat::RG32Float:
+    case ResourceFormat::RGB32Float:
+    case ResourceFormat::RGBA32Float:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t MipGenerator::getMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t mipCount = 1;
+    while ((std::max(width, height) >> mipCount) > 0)
+        mipCount++;
+    return mipCount;
+}
+
+MipGenerator::Image MipGenerator::decode(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
+{
+    const FormatLayout layout = getFormatLayout(format);
+    const size_t rowSize = getTexelSize(layout) * width;
+    const uint32_t channelCount = layout.channelCount;
+
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.texels.resize(size_t(width) * height);
+
+    forEachRow(
+        height,
+        [&](uint32_t y)
+        {
+            const uint8_t* pRow = static_cast<const uint8_t*>(pData) + y * rowSize;
+            std::vector<float> row(size_t(width) * channelCount);
+
+            switch (layout.type)
+            {
+            case ChannelType::Unorm8:
+                if (layout.isSrgb)
+                {
+                    // Decode all channels as sRGB, then fix up the linear alpha channel.
+                    srgbToLinear(pRow, row.data(), row.size());
+                    for (uint32_t x = 0; x < width; x++)
+                        row[x * 4 + 3] = pRow[x * 4 + 3] / 255.f;
+                }
+                else
+                {
+                    for (size_t i = 0; i < row.size(); i++)
+                        row[i] = pRow[i] / 255.f;
+                }
+                break;
+            case ChannelType::Float16:
+                math::float16ToFloat32(reinterpret_cast<const uint16_t*>(pRow), row.data(), row.size());
+                break;
+            case ChannelType::Float32:
+                std::memcpy(row.data(), pRow, rowSize);
+                break;
+            }
+
+            expandRow(row.data(), layout, &image.texels[size_t(y) * width], width);
+        }
+    );
+
+    return image;
+}
+
+void MipGenerator::encode(const Image& image, ResourceFormat format, void* pDst)
+{
+    encodeImage(image, format, pDst, 1.f);
+}
+
+MipGenerator::Image MipGenerator::downsample(const Image& src, const Options& options)
+{
+    FALCOR_CHECK(src.width > 0 && src.height > 0, "Image is empty.");
+
+    Image dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.texels.resize(size_t(dst.width) * dst.height);
+
+    // The taps only depend on the dimensions, so they are shared by all rows and columns and by both axes of square levels.
+    const auto tapsX = computeFilterTaps(src.width, dst.width, options);
+    std::vector<FilterTaps> tapsNonSquareY;
+    if (src.height != src.width)
+        tapsNonSquareY = computeFilterTaps(src.height, dst.height, options);
+    const auto& tapsY = src.height == src.width ? tapsX : tapsNonSquareY;
+
+    // Filter horizontally, then vertically.
+    Image tmp;
+    tmp.width = dst.width;
+    tmp.height = src.height;
+    tmp.texels.resize(size_t(tmp.width) * tmp.height);
+
+    forEachRow(
+        tmp.height,
+        [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < tmp.width; x++)
+            {
+                const auto& taps = tapsX[x];
+                float4 sum(0.f);
+                for (size_t i = 0; i < taps.weights.size(); i++)
+                    sum += taps.weights[i] * src.at(taps.first + (uint32_t)i, y);
+                tmp.at(x, y) = sum;
+            }
+        }
+    );
+
+    forEachRow(
+        dst.height,
+        [&](uint32_t y)
+        {
+            const auto& taps = tapsY[y];
+            for (uint32_t x = 0; x < dst.width; x++)
+            {
+                float4 sum(0.f);
+                for (size_t i = 0; i < taps.weights.size(); i++)
+                    sum += taps.weights[i] * tmp.at(x, taps.first + (uint32_t)i);
+                dst.at(x, y) = sum;
+            }
+        }
+    );
+
+    return dst;
+}
+
+float MipGenerator::computeAlphaCoverage(const Image& image, float alphaCutoff, float alphaScale)
+{
+    if (image.texels.empty())
+        return 0.f;
+
+    size_t count = 0;
+    for (const auto& texel : image.texels)
+    {
+        if (std::min(texel.w * alphaScale, 1.f) >= alphaCutoff)
+            count++;
+    }
+    return (float)count / image.texels.size();
+}
+
+std::vector<uint8_t> MipGenerator::generateMipChain(
+    ResourceFormat format,
+    uint32_t width,
+    uint32_t height,
+    const void* pData,
+    uint32_t mipCount,
+    const Options& options
+)
+{
+    FALCOR_CHECK(isSupported(format), "MipGenerator does not support format '{}'.", to_string(format));
+    FALCOR_CHECK(width > 0 && height > 0, "Image is empty.");
+    FALCOR_CHECK(mipCount > 0 && mipCount <= getMipCount(width, height), "Invalid mip count {}.", mipCount);
+
+    const FormatLayout layout = getFormatLayout(format);
+    const size_t texelSize = getTexelSize(layout);
+
+    size_t totalSize = 0;
+    for (uint32_t mip = 0; mip < mipCount; mip++)
+        totalSize += texelSize * std::max(1u, width >> mip) * std::max(1u, height >> mip);
+
+    // The base level is copied as is.
+    std::vector<uint8_t> data(totalSize);
+    std::memcpy(data.data(), pData, texelSize * width * height);
+    if (mipCount == 1)
+        return data;
+
+    Image image = decode(format, width, height, pData);
+    // The coverage is only preserved if some texels fail the alpha test. Otherwise alpha testing is disabled for the texture
+    // (see BasicMaterial::optimizeTexture()), and the mips are left as they are.
+    const float targetCoverage = options.preserveAlphaCoverage && layout.hasAlpha ? computeAlphaCoverage(image, options.alphaCutoff) : 1.f;
+    const bool preserveCoverage = targetCoverage < 1.f;
+
+    size_t offset = texelSize * width * height;
+    for (uint32_t mip = 1; mip < mipCount; mip++)
+    {
+        // Filter from the unscaled previous level, so that the alpha scaling doesn't accumulate.
+        image = downsample(image, options);
+
+        float alphaScale = 1.f;
+        if (preserveCoverage)
+        {
+            // Find the alpha scale matching the coverage of the base level with a bisection search.
+            float lo = 0.f;
+            float hi = 4.f;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const float mid = 0.5f * (lo + hi);
+                if (computeAlphaCoverage(image, options.alphaCutoff, mid) < targetCoverage)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            alphaScale = hi;
+        }
+
+        encodeImage(image, format, data.data() + offset, alphaScale);
+        offset += texelSize * image.width * image.height;
+    }
+    FALCOR_ASSERT(offset == totalSize);
+
+    return data;
+}
+
+ref<Texture> MipGenerator::createTexture(
+    ref<Device> pDevice,
+    const Bitmap& bitmap,
+    ResourceFormat format,
+    ResourceBindFlags bindFlags,
+    const Options& options
+)
+{
+    FALCOR_CHECK(
+        getFormatBytesPerBlock(format) == getFormatBytesPerBlock(bitmap.getFormat()),
+        "Texture format '{}' doesn't match bitmap format '{}'.",
+        to_string(format),
+        to_string(bitmap.getFormat())
+    );
+
+    const uint32_t mipCount = getMipCount(bitmap.getWidth(), bitmap.getHeight());
+    std::vector<uint8_t> data = generateMipChain(format, bitmap.getWidth(), bitmap.getHeight(), bitmap.getData(), mipCount, options);
+    return pDevice->createTexture2D(bitmap.getWidth(), bitmap.getHeight(), format, 1, mipCount, data.data(), bindFlags);
+}
+
+void MipGenerator::srgbToLinear(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const auto& decode = getSrgbTables().decode;
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = decode[pSrc[i]];
+}
+
+void MipGenerator::linearToSrgb(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const SrgbTables& tables = getSrgbTables();
+    size_t i = 0;
+
+#if FALCOR_MIP_GENERATOR_SSE2
+    // Clamp and compute the table buckets with SIMD, then resolve the final value with one threshold test.
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 bucketScale = _mm_set1_ps((float)kSrgbBucketCount);
+    const __m128i maxBucket = _mm_set1_epi32(kSrgbBucketCount - 1);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + i), zero), one); // Maps NaN to zero.
+        __m128i bucket = _mm_cvttps_epi32(_mm_mul_ps(value, bucketScale));
+        bucket = _mm_sub_epi32(bucket, _mm_and_si128(_mm_cmpgt_epi32(bucket, maxBucket), _mm_set1_epi32(1)));
+
+        alignas(16) float values[4];
+        alignas(16) uint32_t buckets[4];
+        _mm_store_ps(values, value);
+        _mm_store_si128(reinterpret_cast<__m128i*>(buckets), bucket);
+        for (size_t j = 0; j < 4; j++)
+            pDst[i + j] = tables.encode(values[j], buckets[j]);
+    }
+#endif
+
+    for (; i < count; i++)
+        pDst[i] = tables.encode(pSrc[i]);
+}
+} // namespace Falcor
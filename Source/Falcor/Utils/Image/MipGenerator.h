@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Formats.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU mip chain generation and pixel format conversion.
+ *
+ * Images are converted to a linear RGBA float working format, filtered down to the full mip chain and
+ * converted back to the source format. All stages process blocks of rows in parallel, so a texture
+ * including all its mip levels can be prepared on a background thread and uploaded at once, without
+ * a mip generation pass on the GPU.
+ *
+ * Supported formats are 8-bit unorm (R, RG, RGBA, BGRA, BGRX, including sRGB), 16-bit float (R, RG, RGBA)
+ * and 32-bit float (R, RG, RGB, RGBA). Data in sRGB formats is filtered in linear space.
+ */
+class FALCOR_API MipGenerator
+{
+public:
+    enum class Filter
+    {
+        Box,    ///< Box filter.
+        Kaiser, ///< Kaiser-windowed sinc filter. Produces sharper mips with less aliasing than the box filter.
+    };
+
+    struct Options
+    {
+        Filter filter = Filter::Box;
+        float kaiserWidth = 3.f;            ///< Kaiser filter radius in destination texels.
+        float kaiserAlpha = 4.f;            ///< Kaiser window shape parameter.
+        bool preserveAlphaCoverage = false; ///< Scale the alpha of each mip level to keep the fraction of texels passing the alpha test constant.
+                                            ///< Images where all texels pass the alpha test are not changed.
+        float alphaCutoff = 0.5f;           ///< Alpha test threshold used for preserving the alpha coverage.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    /// Image in linear RGBA float format.
+    struct Image
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float4> texels;
+
+        float4& at(uint32_t x, uint32_t y) { return texels[size_t(y) * width + x]; }
+        const float4& at(uint32_t x, uint32_t y) const { return texels[size_t(y) * width + x]; }
+    };
+
+    /**
+     * Check if a format is supported.
+     */
+    static bool isSupported(ResourceFormat format);
+
+    /**
+     * Get the number of mip levels in a full mip chain.
+     */
+    static uint32_t getMipCount(uint32_t width, uint32_t height);
+
+    /**
+     * Convert tightly packed pixel data to a linear RGBA float image.
+     * Missing color channels are set to zero and missing alpha to one.
+     */
+    static Image decode(ResourceFormat format, uint32_t width, uint32_t height, const void* pData);
+
+    /**
+     * Convert a linear RGBA float image to tightly packed pixel data.
+     * @param[in] image Source image.
+     * @param[in] format Destination format.
+     * @param[out] pDst Destination with room for the image in the destination format.
+     */
+    static void encode(const Image& image, ResourceFormat format, void* pDst);
+
+    /**
+     * Compute the next mip level of an image. The dimensions are halved and rounded down.
+     */
+    static Image downsample(const Image& src, const Options& options = Options());
+
+    /**
+     * Compute the fraction of texels with an alpha value at or above the cutoff.
+     */
+    static float computeAlphaCoverage(const Image& image, float alphaCutoff, float alphaScale = 1.f);
+
+    /**
+     * Generate a mip chain.
+     * @param[in] format Pixel format.
+     * @param[in] width Width of the base level.
+     * @param[in] height Height of the base level.
+     * @param[in] pData Tightly packed base level data.
+     * @param[in] mipCount Number of mip levels to generate, including the base level.
+     * @param[in] options Filter options.
+     * @return Tightly packed data of all mip levels, starting with a copy of the base level.
+     */
+    static std::vector<uint8_t> generateMipChain(
+        ResourceFormat format,
+        uint32_t width,
+        uint32_t height,
+        const void* pData,
+        uint32_t mipCount,
+        const Options& options = Options()
+    );
+
+    /**
+     * Create a texture with a full mip chain generated on the CPU.
+     * @param[in] pDevice GPU device.
+     * @param[in] bitmap Source image.
+     * @param[in] format Texture format. Must have the same layout as the bitmap format, but may be the sRGB variant of it.
+     * @param[in] bindFlags Texture bind flags.
+     * @param[in] options Filter options.
+     * @return The texture.
+     */
+    static ref<Texture> createTexture(
+        ref<Device> pDevice,
+        const Bitmap& bitmap,
+        ResourceFormat format,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
+        const Options& options = Options()
+    );
+
+    /**
+     * Convert 8-bit sRGB encoded values to linear floats.
+     */
+    static void srgbToLinear(const uint8_t* pSrc, float* pDst, size_t count);
+
+    /**
+     * Convert linear floats to 8-bit sRGB encoded values, rounded to the nearest value.
+     * Uses SIMD instructions where available.
+     */
+    static void linearToSrgb(const float* pSrc, uint8_t* pDst, size_t count);
+};
+} // namespace Falcor
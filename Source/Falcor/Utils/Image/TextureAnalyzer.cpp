@@ -26,7 +26,23 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureAnalyzer.h"
+#include "MipGenerator.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <execution>
+#include <optional>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_TEXTURE_ANALYZER_SSE2 1
+#include <emmintrin.h>
+#else
+#define FALCOR_TEXTURE_ANALYZER_SSE2 0
+#endif
 
 namespace Falcor
 {
@@ -39,6 +55,217 @@ static_assert((uint32_t)TextureChannelFlags::Blue == 0x4);
 static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
 const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+/// Number of rows processed per task by the CPU analyzer.
+const uint32_t kRowsPerBlock = 16;
+
+/// Texel layout of the formats supported by the CPU analyzer.
+struct CPULayout
+{
+    enum class Type
+    {
+        Unorm8,
+        Float16,
+        Float32,
+    };
+
+    Type type;
+    uint32_t channelCount;      ///< Number of channels stored per texel.
+    std::array<int, 4> swizzle; ///< Stored channel for each of RGBA, or -1 if the channel is missing.
+    bool isSrgb = false;
+};
+
+std::optional<CPULayout> getCPULayout(ResourceFormat format)
+{
+    using Type = CPULayout::Type;
+    switch (format)
+    {
+    case ResourceFormat::R8Unorm:
+        return CPULayout{Type::Unorm8, 1, {0, -1, -1, -1}};
+    case ResourceFormat::RG8Unorm:
+        return CPULayout{Type::Unorm8, 2, {0, 1, -1, -1}};
+    case ResourceFormat::RGBA8Unorm:
+        return CPULayout{Type::Unorm8, 4, {0, 1, 2, 3}};
+    case ResourceFormat::RGBA8UnormSrgb:
+        return CPULayout{Type::Unorm8, 4, {0, 1, 2, 3}, true};
+    case ResourceFormat::BGRA8Unorm:
+        return CPULayout{Type::Unorm8, 4, {2, 1, 0, 3}};
+    case ResourceFormat::BGRA8UnormSrgb:
+        return CPULayout{Type::Unorm8, 4, {2, 1, 0, 3}, true};
+    case ResourceFormat::BGRX8Unorm:
+        return CPULayout{Type::Unorm8, 4, {2, 1, 0, -1}};
+    case ResourceFormat::BGRX8UnormSrgb:
+        return CPULayout{Type::Unorm8, 4, {2, 1, 0, -1}, true};
+    case ResourceFormat::R16Float:
+        return CPULayout{Type::Float16, 1, {0, -1, -1, -1}};
+    case ResourceFormat::RG16Float:
+        return CPULayout{Type::Float16, 2, {0, 1, -1, -1}};
+    case ResourceFormat::RGBA16Float:
+        return CPULayout{Type::Float16, 4, {0, 1, 2, 3}};
+    case ResourceFormat::R32Float:
+        return CPULayout{Type::Float32, 1, {0, -1, -1, -1}};
+    case ResourceFormat::RG32Float:
+        return CPULayout{Type::Float32, 2, {0, 1, -1, -1}};
+    case ResourceFormat::RGB32Float:
+        return CPULayout{Type::Float32, 3, {0, 1, 2, -1}};
+    case ResourceFormat::RGBA32Float:
+        return CPULayout{Type::Float32, 4, {0, 1, 2, 3}};
+    default:
+        return {};
+    }
+}
+
+/// Analysis state of a stored channel of float data.
+/// Follows the shader: NaNs don't affect min/max, and min/max are clamped to zero.
+struct FloatChannelStats
+{
+    float minValue = FLT_MAX;
+    float maxValue = 0.f;
+    uint32_t range = 0;
+    bool varying = false;
+
+    void add(float value, float ref)
+    {
+        varying |= value != ref;
+        range |= value > 0.f ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos : 0;
+        range |= value < 0.f ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg : 0;
+        range |= std::isinf(value) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf : 0;
+        range |= std::isnan(value) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN : 0;
+        if (value < minValue)
+            minValue = value;
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    void merge(const FloatChannelStats& other)
+    {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        range |= other.range;
+        varying |= other.varying;
+    }
+};
+
+/// Analysis state of a stored channel of 8-bit data.
+struct ByteChannelStats
+{
+    uint8_t minValue = 255;
+    uint8_t maxValue = 0;
+    bool varying = false;
+
+    void merge(const ByteChannelStats& other)
+    {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        varying |= other.varying;
+    }
+};
+
+/// Analyze 'count' floats of interleaved texels with 'channelCount' channels.
+void analyzeFloats(const float* pData, size_t count, uint32_t channelCount, const float* pRef, FloatChannelStats* pStats)
+{
+    size_t i = 0;
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+    // Process whole texels with 4-wide vectors. With 3 channels, 3 vectors hold 4 texels.
+    const uint32_t vectorCount = channelCount == 3 ? 3 : 1;
+    const size_t step = 4 * vectorCount;
+    if (count >= step)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 inf = _mm_set1_ps(INFINITY);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+        __m128 ref[3], minValue[3], maxValue[3], varying[3], pos[3], neg[3], isInf[3], isNaN[3];
+        for (uint32_t k = 0; k < vectorCount; k++)
+        {
+            float refLanes[4];
+            for (uint32_t l = 0; l < 4; l++)
+                refLanes[l] = pRef[(4 * k + l) % channelCount];
+            ref[k] = _mm_loadu_ps(refLanes);
+            minValue[k] = _mm_set1_ps(FLT_MAX);
+            maxValue[k] = varying[k] = pos[k] = neg[k] = isInf[k] = isNaN[k] = zero;
+        }
+
+        for (; i + step <= count; i += step)
+        {
+            for (uint32_t k = 0; k < vectorCount; k++)
+            {
+                __m128 v = _mm_loadu_ps(pData + i + 4 * k);
+                varying[k] = _mm_or_ps(varying[k], _mm_cmpneq_ps(v, ref[k]));
+                pos[k] = _mm_or_ps(pos[k], _mm_cmpgt_ps(v, zero));
+                neg[k] = _mm_or_ps(neg[k], _mm_cmplt_ps(v, zero));
+                isInf[k] = _mm_or_ps(isInf[k], _mm_cmpeq_ps(_mm_and_ps(v, absMask), inf));
+                isNaN[k] = _mm_or_ps(isNaN[k], _mm_cmpunord_ps(v, v));
+                // The min/max instructions return the second operand if the first is NaN, so NaNs are skipped.
+                minValue[k] = _mm_min_ps(v, minValue[k]);
+                maxValue[k] = _mm_max_ps(v, maxValue[k]);
+            }
+        }
+
+        // Fold the vector lanes into the channels.
+        for (uint32_t k = 0; k < vectorCount; k++)
+        {
+            float minLanes[4], maxLanes[4];
+            _mm_storeu_ps(minLanes, minValue[k]);
+            _mm_storeu_ps(maxLanes, maxValue[k]);
+            const int varyingBits = _mm_movemask_ps(varying[k]);
+            const int posBits = _mm_movemask_ps(pos[k]);
+            const int negBits = _mm_movemask_ps(neg[k]);
+            const int infBits = _mm_movemask_ps(isInf[k]);
+            const int nanBits = _mm_movemask_ps(isNaN[k]);
+            for (uint32_t l = 0; l < 4; l++)
+            {
+                FloatChannelStats lane;
+                lane.minValue = minLanes[l];
+                lane.maxValue = maxLanes[l];
+                lane.varying = (varyingBits >> l) & 1;
+                lane.range |= ((posBits >> l) & 1) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos : 0;
+                lane.range |= ((negBits >> l) & 1) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg : 0;
+                lane.range |= ((infBits >> l) & 1) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf : 0;
+                lane.range |= ((nanBits >> l) & 1) ? (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN : 0;
+                pStats[(4 * k + l) % channelCount].merge(lane);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++)
+        pStats[i % channelCount].add(pData[i], pRef[i % channelCount]);
+}
+
+/// Analyze 'count' bytes of interleaved texels with 'channelCount' channels. The channel count must be 1, 2 or 4.
+void analyzeBytes(const uint8_t* pData, size_t count, uint32_t channelCount, const uint8_t* pRef, ByteChannelStats* pStats)
+{
+    size_t i = 0;
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+    if (count >= 16)
+    {
+        uint8_t refLanes[16];
+        for (uint32_t l = 0; l < 16; l++)
+            refLanes[l] = pRef[l % channelCount];
+        const __m128i ref = _mm_loadu_si128(reinterpret_cast<const __m128i*>(refLanes));
+        __m128i minValue = _mm_set1_epi8(-1);
+        __m128i maxValue = _mm_setzero_si128();
+        __m128i diff = _mm_setzero_si128();
+
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+            minValue = _mm_min_epu8(minValue, v);
+            maxValue = _mm_max_epu8(maxValue, v);
+            diff = _mm_or_si128(diff, _mm_xor_si128(v, ref));
+        }
+
+        uint8_t minLanes[16], maxLanes[16], diffLanes[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minLanes), minValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxLanes), maxValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(diffLanes), diff);
+        for (uint32_t l = 0; l < 16; l++)
+            pStats[l % channelCount].merge({minLanes[l], maxLanes[l], diffLanes[l] != 0});
+    }
+#endif
+    for (; i < count; i++)
+        pStats[i % channelCount].merge({pData[i], pData[i], pData[i] != pRef[i % channelCount]});
+}
 } // namespace
 
 // Verify that the result struct matches the size expected by the shader.
@@ -126,6 +353,138 @@ void TextureAnalyzer::clear(RenderContext* pRenderContext, ref<Buffer> pResult,
     mpClearPass->execute(pRenderContext, uint3(resultCount, 1, 1));
 }
 
+bool TextureAnalyzer::isCPUSupported(ResourceFormat format)
+{
+    return getCPULayout(format).has_value();
+}
+
+TextureAnalyzer::Result TextureAnalyzer::analyzeCPU(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
+{
+    auto layout = getCPULayout(format);
+    FALCOR_CHECK(layout, "Format {} is not supported by the CPU texture analyzer.", to_string(format));
+    FALCOR_CHECK(width > 0 && height > 0 && pData, "Image is empty.");
+
+    const uint32_t channelCount = layout->channelCount;
+    const size_t rowSize = size_t(width) * channelCount; // Values per row.
+    const uint32_t blockCount = (height + kRowsPerBlock - 1) / kRowsPerBlock;
+
+    // Per-channel stats in linear float format, in the order of the stored channels.
+    std::array<FloatChannelStats, 4> stats;
+    std::array<float, 4> ref = {};
+
+    if (layout->type == CPULayout::Type::Unorm8)
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        std::vector<std::array<ByteChannelStats, 4>> blockStats(blockCount);
+        NumericRange<uint32_t> blocks(0, blockCount);
+        std::for_each(
+            std::execution::par,
+            blocks.begin(),
+            blocks.end(),
+            [&](uint32_t block)
+            {
+                const uint32_t y0 = block * kRowsPerBlock;
+                const uint32_t y1 = std::min(y0 + kRowsPerBlock, height);
+                analyzeBytes(pBytes + y0 * rowSize, (y1 - y0) * rowSize, channelCount, pBytes, blockStats[block].data());
+            }
+        );
+
+        // Convert to linear values. The conversion is monotonic, so min/max are preserved.
+        std::array<float, 256> unorm, srgb;
+        std::array<uint8_t, 256> codes;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            unorm[i] = i / 255.f;
+            codes[i] = (uint8_t)i;
+        }
+        MipGenerator::srgbToLinear(codes.data(), srgb.data(), 256);
+
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            ByteChannelStats byteStats;
+            for (const auto& s : blockStats)
+                byteStats.merge(s[c]);
+
+            // The alpha channel is always linear.
+            const bool isAlpha = layout->swizzle[3] == (int)c;
+            const auto& decode = layout->isSrgb && !isAlpha ? srgb : unorm;
+            ref[c] = decode[pBytes[c]];
+            stats[c].minValue = decode[byteStats.minValue];
+            stats[c].maxValue = decode[byteStats.maxValue];
+            stats[c].range = byteStats.maxValue > 0 ? (uint32_t)Result::RangeFlags::Pos : 0;
+            stats[c].varying = byteStats.varying;
+        }
+    }
+    else
+    {
+        // Float data. Half values are converted row by row.
+        const bool isHalf = layout->type == CPULayout::Type::Float16;
+        if (isHalf)
+            math::float16ToFloat32(static_cast<const uint16_t*>(pData), ref.data(), channelCount);
+        else
+            std::copy_n(static_cast<const float*>(pData), channelCount, ref.data());
+
+        std::vector<std::array<FloatChannelStats, 4>> blockStats(blockCount);
+        NumericRange<uint32_t> blocks(0, blockCount);
+        std::for_each(
+            std::execution::par,
+            blocks.begin(),
+            blocks.end(),
+            [&](uint32_t block)
+            {
+                const uint32_t y0 = block * kRowsPerBlock;
+                const uint32_t y1 = std::min(y0 + kRowsPerBlock, height);
+                if (isHalf)
+                {
+                    const uint16_t* pHalfs = static_cast<const uint16_t*>(pData);
+                    std::vector<float> row(rowSize);
+                    for (uint32_t y = y0; y < y1; y++)
+                    {
+                        math::float16ToFloat32(pHalfs + y * rowSize, row.data(), rowSize);
+                        analyzeFloats(row.data(), rowSize, channelCount, ref.data(), blockStats[block].data());
+                    }
+                }
+                else
+                {
+                    const float* pFloats = static_cast<const float*>(pData);
+                    analyzeFloats(pFloats + y0 * rowSize, (y1 - y0) * rowSize, channelCount, ref.data(), blockStats[block].data());
+                }
+            }
+        );
+
+        for (const auto& s : blockStats)
+        {
+            for (uint32_t c = 0; c < channelCount; c++)
+                stats[c].merge(s[c]);
+        }
+    }
+
+    // Assemble the result in RGBA order. Missing channels read as zero, except for alpha which reads as one.
+    Result result = {};
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        const int stored = layout->swizzle[c];
+        FloatChannelStats channel;
+        if (stored >= 0)
+        {
+            channel = stats[stored];
+            result.value[c] = ref[stored];
+        }
+        else
+        {
+            result.value[c] = c == 3 ? 1.f : 0.f;
+            channel.add(result.value[c], result.value[c]);
+        }
+
+        result.mask |= (channel.varying ? 1u : 0u) << c;
+        result.mask |= channel.range << (4 + 4 * c);
+        result.minValue[c] = std::max(channel.minValue, 0.f);
+        result.maxValue[c] = channel.maxValue;
+    }
+
+    return result;
+}
+
 void TextureAnalyzer::checkFormatSupport(const ref<Texture> pInput, uint32_t mipLevel, uint32_t arraySlice) const
 {
     // Validate that input is supported.
@@ -131,6 +131,26 @@ public:
      */
     void analyze(RenderContext* pRenderContext, const std::vector<ref<Texture>>& inputs, ref<Buffer> pResult, bool clearResult = true);
 
+    /**
+     * Check if a format is supported by analyzeCPU().
+     */
+    static bool isCPUSupported(ResourceFormat format);
+
+    /**
+     * Analyze an image on the CPU.
+     * The result is equivalent to analyze() for a texture of the same format created from the image, but doesn't require
+     * the texture to be on the GPU. The only difference is that NaNs never affect the min/max values, whereas the GPU
+     * result depends on how NaNs are distributed across waves.
+     * Supported formats are 8-bit unorm (R, RG, RGBA, BGRA, BGRX, including sRGB), 16-bit float (R, RG, RGBA) and
+     * 32-bit float (R, RG, RGB, RGBA). Throws an exception if the format is not supported.
+     * @param[in] format Image format. For sRGB formats, the color channels are converted to linear values.
+     * @param[in] width Image width.
+     * @param[in] height Image height.
+     * @param[in] pData Tightly packed image data.
+     * @return The analysis result.
+     */
+    static Result analyzeCPU(ResourceFormat format, uint32_t width, uint32_t height, const void* pData);
+
     /**
      * Helper function to clear the results buffer.
      * @param[in] pRenderContext The context.
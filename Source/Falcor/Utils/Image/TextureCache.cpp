@@ -0,0 +1,510 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "ImageIO.h"
+#include "MipGenerator.h"
+#include "Core/API/Device.h"
+#include "Core/API/Formats.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/Metrics.h"
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+/// Cache file version. Bump this whenever the stored data changes.
+const uint32_t kVersion = 3;
+
+/// Texture cache directory (subdirectory in the application data directory).
+const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+const bool kTopDown = true; // Matches Texture::createFromFile().
+
+/// Texture analysis file stored next to the cached texture.
+struct AnalysisFile
+{
+    static constexpr uint32_t kMagic = 0x41584554; // "TEXA"
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t magic = kMagic;
+    uint32_t version = kVersion;
+    TextureAnalyzer::Result result = {};
+};
+
+/// Reference file storing the content hash of a source file, see computeKey().
+struct ReferenceFile
+{
+    static constexpr uint32_t kMagic = 0x46455254; // "TREF"
+
+    uint32_t magic = kMagic;
+    uint32_t version = kVersion;
+    XXH3::Hash128 contentHash;
+};
+
+std::filesystem::path getCacheDirectory(const TextureCache::Options& options)
+{
+    return options.directory.empty() ? getAppDataDirectory() / kDirectory : options.directory;
+}
+
+struct FileStamp
+{
+    uint64_t size = 0;
+    int64_t lastWriteTime = 0;
+
+    bool operator==(const FileStamp& other) const { return size == other.size && lastWriteTime == other.lastWriteTime; }
+};
+
+std::optional<FileStamp> getFileStamp(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return {};
+    stamp.lastWriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec)
+        return {};
+    return stamp;
+}
+
+/// Get the content hash of a source file. The hash is looked up in a reference file named after the path, size and
+/// last write time of the source file, and computed and stored in a new reference file if there is none.
+std::optional<XXH3::Hash128> getContentHash(const std::filesystem::path& path, const std::filesystem::path& directory)
+{
+    const auto stamp = getFileStamp(path);
+    if (!stamp)
+        return {};
+
+    std::filesystem::path refPath;
+    if (!directory.empty())
+    {
+        std::error_code ec;
+        XXH3 xxh3;
+        xxh3.update(kVersion);
+        xxh3.update(std::filesystem::absolute(path, ec).lexically_normal().string());
+        xxh3.update(stamp->size);
+        xxh3.update(stamp->lastWriteTime);
+        refPath = directory / (XXH3::toString(xxh3.digest128()) + ".ref");
+
+        std::ifstream fs(refPath, std::ios_base::binary);
+        ReferenceFile file;
+        fs.read(reinterpret_cast<char*>(&file), sizeof(file));
+        if (fs.good() && file.magic == ReferenceFile::kMagic && file.version == kVersion)
+            return file.contentHash;
+    }
+
+    ReferenceFile file;
+    try
+    {
+        file.contentHash = XXH3::hashFile(path);
+    }
+    catch (const std::exception&)
+    {
+        return {};
+    }
+
+    // Only store the hash if the file didn't change while it was hashed.
+    if (!refPath.empty() && getFileStamp(path) == stamp)
+    {
+        try
+        {
+            writeFileAtomic(refPath, &file, sizeof(file));
+        }
+        catch (const std::exception& e)
+        {
+            logDebug("Texture cache can't store '{}': {}", refPath, e.what());
+        }
+    }
+    return file.contentHash;
+}
+
+MipGenerator::Options getMipOptions(Bitmap::ImportFlags importFlags, float alphaCutoff)
+{
+    MipGenerator::Options options;
+    options.preserveAlphaCoverage = is_set(importFlags, Bitmap::ImportFlags::PreserveAlphaCoverage);
+    options.alphaCutoff = alphaCutoff;
+    return options;
+}
+
+std::filesystem::path getAnalysisPath(const std::filesystem::path& cachePath)
+{
+    std::filesystem::path path = cachePath;
+    return path.replace_extension(".analysis");
+}
+
+std::string getAnalysisKey(const std::filesystem::path& path, bool isSrgb, Bitmap::ImportFlags importFlags)
+{
+    return fmt::format("{}|{}|{}", path.string(), isSrgb ? 1 : 0, (uint32_t)importFlags);
+}
+
+std::optional<TextureAnalyzer::Result> readAnalysisFile(const std::filesystem::path& path)
+{
+    std::ifstream fs(path, std::ios_base::binary);
+    AnalysisFile file;
+    fs.read(reinterpret_cast<char*>(&file), sizeof(file));
+    if (!fs.good() || file.magic != AnalysisFile::kMagic || file.version != AnalysisFile::kVersion)
+        return {};
+    return file.result;
+}
+
+bool writeAnalysisFile(const std::filesystem::path& path, const TextureAnalyzer::Result& result)
+{
+    AnalysisFile file;
+    file.result = result;
+    try
+    {
+        writeFileAtomic(path, &file, sizeof(file));
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    return true;
+}
+
+ImageIO::CompressionMode getCompressionMode(const Bitmap& bitmap)
+{
+    // Block compression requires the base resolution to be a multiple of the block size.
+    // The DDS export would otherwise crop the image.
+    if (bitmap.getWidth() % 4 != 0 || bitmap.getHeight() % 4 != 0)
+        return ImageIO::CompressionMode::None;
+
+    // Only compress 8-bit LDR data, HDR data would need BC6 which doesn't preserve negative or large values well.
+    ResourceFormat format = bitmap.getFormat();
+    FormatType type = getFormatType(format);
+    if ((type != FormatType::Unorm && type != FormatType::UnormSrgb) || getNumChannelBits(format, 0) != 8)
+        return ImageIO::CompressionMode::None;
+
+    switch (getFormatChannelCount(format))
+    {
+    case 1:
+        return ImageIO::CompressionMode::BC4;
+    case 2:
+        return ImageIO::CompressionMode::BC5;
+    default:
+        return ImageIO::CompressionMode::BC7;
+    }
+}
+} // namespace
+
+TextureCache::TextureCache(const Options& options) : mOptions(options) {}
+
+void TextureCache::setOptions(const Options& options)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOptions = options;
+}
+
+TextureCache::Options TextureCache::getOptions() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOptions;
+}
+
+ref<Texture> TextureCache::loadFromFile(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags,
+    float alphaCutoff
+)
+{
+    FALCOR_METRIC_SCOPED_TIMER("texture.load_ms");
+    const Options options = getOptions();
+
+    // DDS files are already stored in their final layout, so there is nothing to gain from caching them.
+    // They are not analyzed either, as they are typically block compressed.
+    if (hasExtension(path, "dds") || !std::filesystem::exists(path) || (!options.enabled && !options.analyze))
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff);
+
+    if (!options.enabled)
+    {
+        // Decode the image here rather than in Texture::createFromFile(), so that it can be analyzed.
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+        if (!pBitmap)
+            return nullptr;
+
+        ref<Texture> pTex = createTexture(pDevice, path, *pBitmap, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff);
+        if (auto result = analyze(*pBitmap, loadAsSrgb); result && pTex)
+            storeAnalysisResult(path, isSrgbFormat(pTex->getFormat()), importFlags, *result);
+        return pTex;
+    }
+
+    auto key = computeKey(path, generateMipLevels, loadAsSrgb, options.compress, importFlags, alphaCutoff, getCacheDirectory(options));
+    if (!key)
+    {
+        mSkippedCount++;
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff);
+    }
+
+    const std::filesystem::path cachePath = getCachePath(*key);
+    std::optional<TextureAnalyzer::Result> analysisResult;
+
+    // Write the cache file if it doesn't exist yet.
+    bool isHit = std::filesystem::exists(cachePath);
+    if (!isHit)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+        if (!pBitmap)
+            return nullptr;
+
+        if (options.analyze)
+            analysisResult = analyze(*pBitmap, loadAsSrgb);
+
+        // Texture formats without CPU mip generation can't be cached, as the cached mips would differ from Texture::createFromFile().
+        const ResourceFormat texFormat = loadAsSrgb ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+        if (generateMipLevels && !MipGenerator::isSupported(texFormat))
+        {
+            mSkippedCount++;
+            ref<Texture> pTex = createTexture(pDevice, path, *pBitmap, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff);
+            if (analysisResult && pTex)
+                storeAnalysisResult(path, isSrgbFormat(pTex->getFormat()), importFlags, *analysisResult);
+            return pTex;
+        }
+
+        // Generate the mip chain on the CPU, equivalent to Texture::createFromFile().
+        const uint32_t width = pBitmap->getWidth();
+        const uint32_t height = pBitmap->getHeight();
+        const uint32_t mipCount = generateMipLevels ? MipGenerator::getMipCount(width, height) : 1;
+        const MipGenerator::Options mipOptions = getMipOptions(importFlags, alphaCutoff);
+        std::vector<uint8_t> mipData;
+        if (generateMipLevels)
+            mipData = MipGenerator::generateMipChain(texFormat, width, height, pBitmap->getData(), mipCount, mipOptions);
+        const void* pData = generateMipLevels ? mipData.data() : pBitmap->getData();
+
+        const ImageIO::CompressionMode mode = options.compress ? getCompressionMode(*pBitmap) : ImageIO::CompressionMode::None;
+        if (writeCacheFile(cachePath, texFormat, width, height, mipCount, pData, mode))
+        {
+            mMissCount++;
+            FALCOR_METRIC_COUNT("texture_cache.misses", 1);
+            if (analysisResult && writeAnalysisFile(getAnalysisPath(cachePath), *analysisResult))
+                mBytesWritten += sizeof(AnalysisFile);
+        }
+        else
+        {
+            mSkippedCount++;
+        }
+
+        // Create the texture from the data in memory. Block compressed data only exists in the cache file, so these textures
+        // are loaded from it below, so that all loads of the texture use the same data.
+        if (mode == ImageIO::CompressionMode::None || !std::filesystem::exists(cachePath))
+        {
+            ref<Texture> pTex = pDevice->createTexture2D(width, height, texFormat, 1, mipCount, pData, bindFlags);
+            if (pTex)
+            {
+                pTex->setSourcePath(path);
+                pTex->setImportFlags(importFlags);
+                pTex->setAlphaCutoff(alphaCutoff);
+                if (analysisResult)
+                    storeAnalysisResult(path, isSrgbFormat(pTex->getFormat()), importFlags, *analysisResult);
+            }
+            return pTex;
+        }
+    }
+    else if (options.analyze)
+    {
+        // Cache files written without analysis have no analysis file. These textures are analyzed on the GPU instead.
+        analysisResult = readAnalysisFile(getAnalysisPath(cachePath));
+        if (analysisResult)
+            mBytesRead += sizeof(AnalysisFile);
+    }
+
+    ref<Texture> pTex = ImageIO::loadTextureFromDDS(pDevice, cachePath, loadAsSrgb, bindFlags);
+    if (!pTex)
+    {
+        // The cache file is unreadable, remove it so that it is recreated next time.
+        logWarning("Failed to load cached texture '{}' for '{}'. Removing the cache file.", cachePath, path);
+        std::error_code ec;
+        std::filesystem::remove(cachePath, ec);
+        mSkippedCount++;
+        return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSrgb, bindFlags, importFlags, alphaCutoff);
+    }
+
+    if (isHit)
+    {
+        mHitCount++;
+        FALCOR_METRIC_COUNT("texture_cache.hits", 1);
+    }
+    std::error_code ec;
+    mBytesRead += std::filesystem::file_size(cachePath, ec);
+
+    pTex->setSourcePath(path);
+    pTex->setImportFlags(importFlags);
+    pTex->setAlphaCutoff(alphaCutoff);
+    if (analysisResult)
+        storeAnalysisResult(path, isSrgbFormat(pTex->getFormat()), importFlags, *analysisResult);
+    logDebug("Loaded texture '{}' from texture cache '{}'.", path, cachePath);
+
+    return pTex;
+}
+
+std::optional<TextureCache::Key> TextureCache::computeKey(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    bool compress,
+    Bitmap::ImportFlags importFlags,
+    float alphaCutoff,
+    const std::filesystem::path& directory
+)
+{
+    auto contentHash = getContentHash(path, directory);
+    if (!contentHash)
+        return {};
+
+    XXH3 xxh3;
+    xxh3.update(kVersion);
+    xxh3.update(contentHash->low);
+    xxh3.update(contentHash->high);
+    xxh3.update(generateMipLevels);
+    xxh3.update(loadAsSrgb);
+    xxh3.update(compress);
+    xxh3.update((uint32_t)importFlags);
+    if (is_set(importFlags, Bitmap::ImportFlags::PreserveAlphaCoverage))
+        xxh3.update(alphaCutoff);
+    return xxh3.digest128();
+}
+
+std::filesystem::path TextureCache::getCachePath(const Key& key) const
+{
+    return getCacheDirectory(getOptions()) / (XXH3::toString(key) + ".dds");
+}
+
+TextureCache::Stats TextureCache::getStats() const
+{
+    Stats stats;
+    stats.hitCount = mHitCount;
+    stats.missCount = mMissCount;
+    stats.skippedCount = mSkippedCount;
+    stats.bytesRead = mBytesRead;
+    stats.bytesWritten = mBytesWritten;
+    {
+        std::lock_guard<std::mutex> lock(mAnalysisMutex);
+        stats.analyzedCount = mAnalysisResults.size();
+    }
+    return stats;
+}
+
+std::optional<TextureAnalyzer::Result> TextureCache::getAnalysisResult(const Texture& texture) const
+{
+    if (texture.getSourcePath().empty())
+        return {};
+
+    const std::string key = getAnalysisKey(texture.getSourcePath(), isSrgbFormat(texture.getFormat()), texture.getImportFlags());
+    std::lock_guard<std::mutex> lock(mAnalysisMutex);
+    auto it = mAnalysisResults.find(key);
+    if (it == mAnalysisResults.end())
+        return {};
+    return it->second;
+}
+
+ref<Texture> TextureCache::createTexture(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    const Bitmap& bitmap,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags,
+    float alphaCutoff
+)
+{
+    // Equivalent to Texture::createFromFile().
+    ResourceFormat texFormat = loadAsSrgb ? linearToSrgbFormat(bitmap.getFormat()) : bitmap.getFormat();
+    ref<Texture> pTex;
+    if (generateMipLevels && MipGenerator::isSupported(texFormat))
+    {
+        pTex = MipGenerator::createTexture(pDevice, bitmap, texFormat, bindFlags, getMipOptions(importFlags, alphaCutoff));
+    }
+    else
+    {
+        pTex = pDevice->createTexture2D(
+            bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(), bindFlags
+        );
+    }
+    if (pTex)
+    {
+        pTex->setSourcePath(path);
+        pTex->setImportFlags(importFlags);
+        pTex->setAlphaCutoff(alphaCutoff);
+    }
+    return pTex;
+}
+
+std::optional<TextureAnalyzer::Result> TextureCache::analyze(const Bitmap& bitmap, bool loadAsSrgb) const
+{
+    // Analyze the data as it will be stored in the texture, so that sRGB data is converted to linear.
+    ResourceFormat texFormat = loadAsSrgb ? linearToSrgbFormat(bitmap.getFormat()) : bitmap.getFormat();
+    if (!TextureAnalyzer::isCPUSupported(texFormat) || bitmap.getRowPitch() != bitmap.getWidth() * getFormatBytesPerBlock(texFormat))
+        return {};
+    return TextureAnalyzer::analyzeCPU(texFormat, bitmap.getWidth(), bitmap.getHeight(), bitmap.getData());
+}
+
+void TextureCache::storeAnalysisResult(
+    const std::filesystem::path& path,
+    bool isSrgb,
+    Bitmap::ImportFlags importFlags,
+    const TextureAnalyzer::Result& result
+)
+{
+    std::lock_guard<std::mutex> lock(mAnalysisMutex);
+    mAnalysisResults[getAnalysisKey(path, isSrgb, importFlags)] = result;
+}
+
+bool TextureCache::writeCacheFile(
+    const std::filesystem::path& cachePath,
+    ResourceFormat format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipCount,
+    const void* pData,
+    ImageIO::CompressionMode mode
+)
+{
+    try
+    {
+        writeFileAtomic(
+            cachePath,
+            [&](const std::filesystem::path& tempPath) { ImageIO::saveToDDS(tempPath, format, width, height, mipCount, pData, mode); }
+        );
+    }
+    catch (const std::exception& e)
+    {
+        logDebug("Texture cache can't store '{}': {}", cachePath, e.what());
+        return false;
+    }
+
+    std::error_code ec;
+    mBytesWritten += std::filesystem::file_size(cachePath, ec);
+    return true;
+}
+} // namespace Falcor
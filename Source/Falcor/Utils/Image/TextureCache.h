@@ -0,0 +1,177 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "TextureAnalyzer.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Resource.h"
+#include "Core/API/Texture.h"
+#include "Utils/CryptoUtils.h"
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace Falcor
+{
+/**
+ * Persistent on-disk cache of derived textures.
+ *
+ * On a cache miss, the source image is decoded, the mip chain is generated on the CPU and the
+ * result is optionally block compressed and stored as a DDS file. Later loads with the same
+ * source file and load options read the DDS file straight into the texture upload, which skips
+ * image decoding and mip generation entirely.
+ *
+ * Textures are also analyzed on the CPU while they are decoded (see TextureAnalyzer::analyzeCPU()).
+ * The results are kept in memory and stored next to the cached textures, so material optimization
+ * doesn't need to analyze the textures on the GPU.
+ *
+ * Cache entries are keyed by a hash of the source file contents and the load options, so edited
+ * source files never hit stale entries. Content hashes are stored in small reference files named
+ * after the path, size and last write time of the source file, so unchanged source files are only
+ * hashed once. All operations are thread-safe.
+ */
+class FALCOR_API TextureCache
+{
+public:
+    using Key = XXH3::Hash128;
+
+    struct Options
+    {
+        bool enabled = false;            ///< Enable the cache. If disabled, textures are loaded directly from the source files.
+        bool compress = false;           ///< Block compress 8-bit textures (BC4/BC5/BC7). This is lossy.
+        std::filesystem::path directory; ///< Cache directory, or empty to use a directory in the application data directory.
+        bool analyze = true;             ///< Analyze textures on the CPU while loading. This also applies if the cache is disabled.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;      ///< Number of textures loaded from the cache.
+        uint64_t missCount = 0;     ///< Number of textures written to the cache.
+        uint64_t skippedCount = 0;  ///< Number of textures that could not be cached and were loaded directly.
+        uint64_t bytesRead = 0;     ///< Total size of cache files read.
+        uint64_t bytesWritten = 0;  ///< Total size of cache files written.
+        uint64_t analyzedCount = 0; ///< Number of textures analyzed on the CPU or loaded with analysis results from the cache.
+    };
+
+    TextureCache(const Options& options = Options());
+
+    void setOptions(const Options& options);
+    Options getOptions() const;
+
+    /**
+     * Load a texture from file through the cache.
+     * DDS source files and textures that can't be stored in the cache are loaded directly.
+     * The arguments match Texture::createFromFile().
+     * @return A new texture, or nullptr if the texture failed to load.
+     */
+    ref<Texture> loadFromFile(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
+        float alphaCutoff = 0.5f
+    );
+
+    /**
+     * Compute the cache key for a source file and the options that affect the cached data.
+     * @param[in] directory Cache directory used to look up and store the content hash of the source file.
+     *                      If empty, the source file is always hashed.
+     * @return The cache key, or an empty optional if the file can't be read.
+     */
+    static std::optional<Key> computeKey(
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        bool compress,
+        Bitmap::ImportFlags importFlags,
+        float alphaCutoff,
+        const std::filesystem::path& directory = {}
+    );
+
+    /**
+     * Get the path of the cache file for a given key.
+     */
+    std::filesystem::path getCachePath(const Key& key) const;
+
+    Stats getStats() const;
+
+    /**
+     * Get the result of the CPU analysis of a texture loaded through the cache.
+     * @param[in] texture Texture. Results are looked up by the source path, import flags and sRGB-ness of the texture.
+     * @return The analysis result, or an empty optional if the texture was not analyzed.
+     */
+    std::optional<TextureAnalyzer::Result> getAnalysisResult(const Texture& texture) const;
+
+private:
+    bool writeCacheFile(
+        const std::filesystem::path& cachePath,
+        ResourceFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipCount,
+        const void* pData,
+        ImageIO::CompressionMode mode
+    );
+
+    ref<Texture> createTexture(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        const Bitmap& bitmap,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags,
+        Bitmap::ImportFlags importFlags,
+        float alphaCutoff
+    );
+
+    std::optional<TextureAnalyzer::Result> analyze(const Bitmap& bitmap, bool loadAsSrgb) const;
+    void storeAnalysisResult(const std::filesystem::path& path, bool isSrgb, Bitmap::ImportFlags importFlags, const TextureAnalyzer::Result& result);
+
+    mutable std::mutex mMutex;
+    Options mOptions;
+
+    std::atomic<uint64_t> mHitCount{0};
+    std::atomic<uint64_t> mMissCount{0};
+    std::atomic<uint64_t> mSkippedCount{0};
+    std::atomic<uint64_t> mBytesRead{0};
+    std::atomic<uint64_t> mBytesWritten{0};
+
+    mutable std::mutex mAnalysisMutex;
+    std::unordered_map<std::string, TextureAnalyzer::Result> mAnalysisResults; ///< CPU analysis results, see getAnalysisKey().
+};
+} // namespace Falcor
@@ -28,8 +28,11 @@
 #include "TextureManager.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Logger.h"
+#include "Utils/Metrics.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
 
 #include <execution>
 
@@ -43,10 +46,42 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::CpuTextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+/**
+ * Returns the memory in bytes of a single mip level of a 2D texture, ignoring allocation padding.
+ */
+uint64_t getMipSizeInBytes(const Texture& texture, uint32_t mipLevel)
+{
+    const ResourceFormat format = texture.getFormat();
+    uint64_t widthInBlocks = div_round_up(texture.getWidth(mipLevel), getFormatWidthCompressionRatio(format));
+    uint64_t heightInBlocks = div_round_up(texture.getHeight(mipLevel), getFormatHeightCompressionRatio(format));
+    return widthInBlocks * heightInBlocks * getFormatBytesPerBlock(format);
+}
+
+/**
+ * Checks whether the finest mips of a texture can be evicted so that the given mip level becomes the new base level.
+ */
+bool canEvictMips(const Texture& texture, uint32_t newBaseMip, uint32_t minDimension)
+{
+    if (newBaseMip >= texture.getMipCount())
+        return false;
+
+    const uint32_t width = texture.getWidth(newBaseMip);
+    const uint32_t height = texture.getHeight(newBaseMip);
+    if (width < minDimension || height < minDimension)
+        return false;
+
+    // Block compressed textures require the base level to be a multiple of the block size.
+    const ResourceFormat format = texture.getFormat();
+    return width % getFormatWidthCompressionRatio(format) == 0 && height % getFormatHeightCompressionRatio(format) == 0;
+}
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
-    : mpDevice(pDevice), mAsyncTextureLoader(pDevice, threadCount), mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
+    : mpDevice(pDevice)
+    , mpTextureCache(std::make_shared<TextureCache>())
+    , mAsyncTextureLoader(pDevice, threadCount, mpTextureCache)
+    , mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
 {}
 
 TextureManager::~TextureManager() {}
@@ -84,7 +119,12 @@ TextureManager::CpuTextureHandle TextureManager::addTexture(const ref<Texture>&
             bool hasMips = pTexture->getMipCount() > 1;
             bool isSrgb = isSrgbFormat(pTexture->getFormat());
             TextureKey textureKey(
-                {pTexture->getSourcePath().string()}, hasMips, isSrgb, pTexture->getBindFlags(), pTexture->getImportFlags()
+                {pTexture->getSourcePath().string()},
+                hasMips,
+                isSrgb,
+                pTexture->getBindFlags(),
+                pTexture->getImportFlags(),
+                pTexture->getAlphaCutoff()
             );
 
             if (mKeyToHandle.find(textureKey) == mKeyToHandle.end())
@@ -113,7 +153,8 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
     bool async,
     Bitmap::ImportFlags importFlags,
     const AssetResolver* assetResolver,
-    size_t* loadedTextureCount
+    size_t* loadedTextureCount,
+    float alphaCutoff
 )
 {
     std::string filename = path.filename().string();
@@ -125,7 +166,9 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
 
     auto pos = filename.find("<UDIM>");
     if (pos == std::string::npos)
-        return loadTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount);
+        return loadTexture(
+            path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount, nullptr, alphaCutoff
+        );
 
     std::filesystem::path dirpath = path.parent_path();
     filename.replace(pos, 6, "[1-9][0-9][0-9][0-9]");
@@ -168,7 +211,9 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
         maxIndex = std::max<size_t>(maxIndex, udim);
         udimIndices.push_back(udim);
         // Do not pass on assetResolver as paths are already resolved, nor loadedTextureCount as we've already set it above.
-        handles.push_back(loadTexture(it, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags));
+        handles.push_back(
+            loadTexture(it, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, nullptr, nullptr, nullptr, alphaCutoff)
+        );
 
         FALCOR_CHECK(udim >= 1001, "Texture {} is not a valid UDIM texture, as it violates the valid UDIM range of 1001-9999", it);
     }
@@ -194,13 +239,15 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
     Bitmap::ImportFlags importFlags,
     const AssetResolver* assetResolver,
     size_t* loadedTextureCount,
-    const Object* owner
+    const Object* owner,
+    float alphaCutoff
 )
 {
     if (path.string().find("<UDIM>") != std::string::npos)
     {
-        CpuTextureHandle handle =
-            loadUdimTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount);
+        CpuTextureHandle handle = loadUdimTexture(
+            path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount, alphaCutoff
+        );
 
         std::lock_guard<std::mutex> lock(mMutex);
         registerOwner(handle, owner);
@@ -260,15 +307,18 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
     }
 
     std::unique_lock<std::mutex> lock(mMutex);
-    const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+    const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags, importFlags, alphaCutoff);
 
     if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
     {
         // Texture is already managed. Return its handle.
         handle = it->second;
+        FALCOR_METRIC_COUNT("texture.dedup_hits", 1);
     }
     else
     {
+        FALCOR_METRIC_COUNT("texture.loads", 1);
+
         if (mUseDeferredLoading)
         {
             // Add new texture desc.
@@ -319,7 +369,7 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         }
         else
         {
-            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback);
+            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback, alphaCutoff);
         }
 #else
         // Load texture from main thread.
@@ -330,7 +380,8 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         }
         else
         {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+            pTexture =
+                mpTextureCache->loadFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, alphaCutoff);
         }
 
         // Add new texture desc.
@@ -420,8 +471,14 @@ void TextureManager::endDeferredLoading()
             auto& desc = getDesc(job.handle);
             if (job.key.fullPaths.size() == 1)
             {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
+                desc.pTexture = mpTextureCache->loadFromFile(
+                    mpDevice,
+                    job.key.fullPaths[0],
+                    job.key.generateMipLevels,
+                    job.key.loadAsSRGB,
+                    job.key.bindFlags,
+                    job.key.importFlags,
+                    job.key.alphaCutoff
                 );
                 logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
             }
@@ -500,6 +557,7 @@ void TextureManager::removeNonUdimTexture(const CpuTextureHandle& handle)
 
     // Clear texture desc.
     desc = {};
+    mResidency[handle.getID()] = {};
 
     // Return handle to the free list.
     mFreeList.push_back(handle);
@@ -642,9 +700,298 @@ TextureManager::Stats TextureManager::getStats() const
         if (isCompressedFormat(t.pTexture->getFormat()))
             s.textureCompressedCount++;
     }
+    s.textureCache = mpTextureCache->getStats();
+
+    s.textureMemoryBudgetInBytes = mResidencyOptions.memoryBudgetInBytes;
+    for (const auto& r : mResidency)
+    {
+        if (r.evictedMipCount == 0)
+            continue;
+        s.texturePartiallyResidentCount++;
+        s.textureNonResidentMemoryInBytes += r.fullSizeInBytes - std::min(r.sizeInBytes, r.fullSizeInBytes);
+    }
+    s.textureEvictionCount = mEvictionCount;
+    s.textureEvictedMipCount = mEvictedMipCount;
+    s.textureEvictedBytes = mEvictedBytes;
+    s.textureReloadCount = mReloadCount;
+    s.textureReloadedBytes = mReloadedBytes;
     return s;
 }
 
+void TextureManager::setResidencyOptions(const ResidencyOptions& options)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResidencyOptions = options;
+}
+
+TextureManager::ResidencyOptions TextureManager::getResidencyOptions() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResidencyOptions;
+}
+
+void TextureManager::markTextureUsed(const CpuTextureHandle& handle)
+{
+    if (!handle)
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (handle.isUdim())
+    {
+        size_t rangeStart = handle.getID();
+        FALCOR_CHECK(rangeStart < mUdimIndirectionSize.size(), "Handle is out of range.");
+        for (size_t i = rangeStart; i < rangeStart + mUdimIndirectionSize[rangeStart]; ++i)
+        {
+            if (mUdimIndirection[i] >= 0)
+                mResidency[mUdimIndirection[i]].lastUsedFrame = mResidencyFrame;
+        }
+    }
+    else
+    {
+        FALCOR_CHECK(handle.getID() < mResidency.size(), "Invalid texture handle.");
+        mResidency[handle.getID()].lastUsedFrame = mResidencyFrame;
+    }
+}
+
+void TextureManager::markTextureUsed(const Texture* pTexture)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto it = mTextureToHandle.find(pTexture); it != mTextureToHandle.end())
+        mResidency[it->second.getID()].lastUsedFrame = mResidencyFrame;
+}
+
+std::vector<TextureManager::TextureReplacement> TextureManager::updateResidency()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<TextureReplacement> replacements;
+
+    // Textures marked as used since the last update have their last used frame set to the current frame.
+    const uint64_t frame = mResidencyFrame++;
+    const uint64_t budget = mResidencyOptions.memoryBudgetInBytes;
+
+    // Swap in the textures that finished re-streaming. Reloads of textures that have been removed or replaced meanwhile are dropped.
+    for (CompletedReload& reload : mCompletedReloads)
+    {
+        const uint32_t id = reload.handle.getID();
+        Residency& r = mResidency[id];
+        if (!r.reloadPending || mTextureDescs[id].pTexture != reload.pEvictedTexture)
+            continue;
+        r.reloadPending = false;
+
+        if (!reload.pTexture)
+        {
+            logWarning("TextureManager: Failed to re-stream texture '{}'. Keeping evicted mips.", reload.pEvictedTexture->getSourcePath());
+            r.reloadFailed = true;
+            continue;
+        }
+
+        replaceTexture(reload.handle, reload.pTexture, replacements);
+        r.evictedMipCount = 0;
+        mReloadCount++;
+        mReloadedBytes += r.sizeInBytes;
+    }
+    mCompletedReloads.clear();
+
+    // Early out if there is no budget and all textures are fully resident.
+    auto isEvicted = [](const Residency& r) { return r.evictedMipCount > 0; };
+    if (budget == 0 && std::none_of(mResidency.begin(), mResidency.end(), isEvicted))
+        return replacements;
+
+    // Only textures that can be re-streamed from their source files are evicted.
+    std::vector<const TextureKey*> keys(mTextureDescs.size(), nullptr);
+    for (const auto& [key, handle] : mKeyToHandle)
+        keys[handle.getID()] = &key;
+
+    auto isResident = [&](uint32_t id) { return mTextureDescs[id].state == TextureState::Loaded && mTextureDescs[id].pTexture; };
+
+    // Textures being re-streamed are accounted for with their full size.
+    uint64_t residentBytes = 0;
+    for (uint32_t id = 0; id < mTextureDescs.size(); id++)
+    {
+        if (isResident(id))
+        {
+            const uint64_t size = getResidentSize(CpuTextureHandle{id});
+            residentBytes += mResidency[id].reloadPending ? std::max(size, mResidency[id].fullSizeInBytes) : size;
+        }
+    }
+
+    // Evict the finest mips of the least recently used textures until the budget is met.
+    // Larger textures are evicted first among textures that were last used in the same frame.
+    if (budget > 0 && residentBytes > budget)
+    {
+        std::vector<uint32_t> candidates;
+        for (uint32_t id = 0; id < mTextureDescs.size(); id++)
+        {
+            if (isResident(id) && keys[id] && !mResidency[id].reloadPending && mTextureDescs[id].pTexture->getMipCount() > 1)
+                candidates.push_back(id);
+        }
+        std::sort(
+            candidates.begin(),
+            candidates.end(),
+            [&](uint32_t a, uint32_t b)
+            {
+                const Residency& ra = mResidency[a];
+                const Residency& rb = mResidency[b];
+                if (ra.lastUsedFrame != rb.lastUsedFrame)
+                    return ra.lastUsedFrame < rb.lastUsedFrame;
+                if (ra.sizeInBytes != rb.sizeInBytes)
+                    return ra.sizeInBytes > rb.sizeInBytes;
+                return a < b;
+            }
+        );
+
+        for (uint32_t id : candidates)
+        {
+            if (residentBytes <= budget)
+                break;
+
+            // Find the number of mips to evict from this texture, based on the estimated mip sizes.
+            const CpuTextureHandle handle{id};
+            const Texture& texture = *mTextureDescs[id].pTexture;
+            uint32_t evictCount = 0;
+            uint64_t estimatedBytes = 0;
+            while (residentBytes - std::min(estimatedBytes, residentBytes) > budget &&
+                   canEvictMips(texture, evictCount + 1, mResidencyOptions.minResidentDimension))
+            {
+                estimatedBytes += getMipSizeInBytes(texture, evictCount);
+                evictCount++;
+            }
+            if (evictCount == 0)
+                continue;
+
+            ref<Texture> pTexture = evictMips(handle, evictCount);
+            if (!pTexture)
+                continue;
+
+            Residency& r = mResidency[id];
+            const uint64_t prevSize = r.sizeInBytes;
+            if (r.evictedMipCount == 0)
+                r.fullSizeInBytes = prevSize;
+            replaceTexture(handle, pTexture, replacements);
+            r.evictedMipCount += evictCount;
+
+            const uint64_t freedBytes = prevSize - std::min(r.sizeInBytes, prevSize);
+            residentBytes -= freedBytes;
+            mEvictionCount++;
+            mEvictedMipCount += evictCount;
+            mEvictedBytes += freedBytes;
+        }
+
+        if (residentBytes > budget)
+            logDebug("TextureManager: Texture memory ({} bytes) exceeds budget ({} bytes) after eviction.", residentBytes, budget);
+    }
+
+    // Re-stream evicted textures that are in use, as long as they fit in the budget.
+    // Without a budget, all evicted textures are re-streamed.
+    uint32_t reloadCount = 0;
+    for (uint32_t id = 0; id < mTextureDescs.size() && reloadCount < mResidencyOptions.maxReloadsPerUpdate; id++)
+    {
+        Residency& r = mResidency[id];
+        if (r.evictedMipCount == 0 || r.reloadFailed || r.reloadPending || !isResident(id) || !keys[id])
+            continue;
+        if (budget > 0 && r.lastUsedFrame != frame)
+            continue;
+
+        const uint64_t extraBytes = r.fullSizeInBytes - std::min(r.sizeInBytes, r.fullSizeInBytes);
+        if (budget > 0 && residentBytes + extraBytes > budget)
+            continue;
+
+        reloadTexture(CpuTextureHandle{id}, *keys[id]);
+        residentBytes += extraBytes;
+        reloadCount++;
+    }
+
+    return replacements;
+}
+
+uint64_t TextureManager::getResidentSize(const CpuTextureHandle& handle)
+{
+    Residency& r = mResidency[handle.getID()];
+    const Texture* pTexture = getDesc(handle).pTexture.get();
+    if (r.pSizedTexture != pTexture)
+    {
+        r.pSizedTexture = pTexture;
+        r.sizeInBytes = pTexture ? pTexture->getTextureSizeInBytes() : 0;
+    }
+    return r.sizeInBytes;
+}
+
+ref<Texture> TextureManager::evictMips(const CpuTextureHandle& handle, uint32_t mipCount)
+{
+    const ref<Texture>& pSrc = getDesc(handle).pTexture;
+    FALCOR_ASSERT(pSrc && mipCount < pSrc->getMipCount());
+
+    ref<Texture> pDst = mpDevice->createTexture2D(
+        pSrc->getWidth(mipCount), pSrc->getHeight(mipCount), pSrc->getFormat(), 1, pSrc->getMipCount() - mipCount, nullptr, pSrc->getBindFlags()
+    );
+    if (!pDst)
+        return nullptr;
+
+    pDst->setName(pSrc->getName());
+    pDst->setSourcePath(pSrc->getSourcePath());
+    pDst->setImportFlags(pSrc->getImportFlags());
+    pDst->setAlphaCutoff(pSrc->getAlphaCutoff());
+
+    // Copy the remaining mips on the GPU.
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    for (uint32_t mip = 0; mip < pDst->getMipCount(); mip++)
+        pRenderContext->copySubresource(pDst.get(), pDst->getSubresourceIndex(0, mip), pSrc.get(), pSrc->getSubresourceIndex(0, mip + mipCount));
+
+    return pDst;
+}
+
+void TextureManager::reloadTexture(const CpuTextureHandle& handle, const TextureKey& key)
+{
+    mResidency[handle.getID()].reloadPending = true;
+    CompletedReload reload{handle, getDesc(handle).pTexture, nullptr};
+
+#ifndef DISABLE_ASYNC_TEXTURE_LOADER
+    mLoadRequestsInProgress++;
+
+    // Function called by the async texture loader when loading finishes.
+    // It's called by a worker thread so needs to acquire the mutex before changing any state.
+    auto callback = [=](ref<Texture> pTexture) mutable
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        reload.pTexture = pTexture;
+        mCompletedReloads.push_back(std::move(reload));
+
+        mLoadRequestsInProgress--;
+        mCondition.notify_all();
+    };
+
+    if (key.fullPaths.size() == 1)
+        mAsyncTextureLoader.loadFromFile(
+            key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags, callback, key.alphaCutoff
+        );
+    else
+        mAsyncTextureLoader.loadMippedFromFiles(key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags, callback);
+#else
+    // Load texture from main thread.
+    if (key.fullPaths.size() == 1)
+        reload.pTexture = mpTextureCache->loadFromFile(
+            mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags, key.alphaCutoff
+        );
+    else
+        reload.pTexture = Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    mCompletedReloads.push_back(std::move(reload));
+#endif
+}
+
+void TextureManager::replaceTexture(const CpuTextureHandle& handle, const ref<Texture>& pTexture, std::vector<TextureReplacement>& replacements)
+{
+    auto& desc = getDesc(handle);
+    replacements.push_back({desc.pTexture, pTexture});
+
+    mTextureToHandle.erase(desc.pTexture.get());
+    mTextureToHandle[pTexture.get()] = handle;
+    desc.pTexture = pTexture;
+
+    Residency& r = mResidency[handle.getID()];
+    r.pSizedTexture = pTexture.get();
+    r.sizeInBytes = pTexture->getTextureSizeInBytes();
+}
+
 TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     CpuTextureHandle handle;
@@ -655,6 +1002,7 @@ TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc
         handle = mFreeList.back();
         mFreeList.pop_back();
         getDesc(handle) = desc;
+        mResidency[handle.getID()] = {};
     }
     else
     {
@@ -664,6 +1012,7 @@ TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc
         }
         handle = CpuTextureHandle{static_cast<uint32_t>(mTextureDescs.size())};
         mTextureDescs.emplace_back(desc);
+        mResidency.emplace_back();
     }
 
     return handle;
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureCache.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -72,7 +73,43 @@ public:
         uint64_t textureCompressedCount = 0;   ///< Number of unique compressed textures.
         uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
         uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
-        uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures. This only includes resident mips.
+        TextureCache::Stats textureCache;      ///< Stats of the persistent texture cache.
+
+        uint64_t textureMemoryBudgetInBytes = 0;      ///< Texture memory budget in bytes, or zero if unlimited.
+        uint64_t texturePartiallyResidentCount = 0;   ///< Number of textures with evicted mips.
+        uint64_t textureNonResidentMemoryInBytes = 0; ///< Memory in bytes the evicted mips would use if they were resident.
+        uint64_t textureEvictionCount = 0;            ///< Total number of times mips were evicted from a texture.
+        uint64_t textureEvictedMipCount = 0;          ///< Total number of mip levels evicted.
+        uint64_t textureEvictedBytes = 0;             ///< Total memory in bytes freed by evictions.
+        uint64_t textureReloadCount = 0;              ///< Total number of textures re-streamed after eviction.
+        uint64_t textureReloadedBytes = 0;            ///< Total memory in bytes of re-streamed textures.
+    };
+
+    /**
+     * Options for limiting the memory used by managed textures.
+     *
+     * When the resident textures exceed the budget, updateResidency() evicts the finest mips of the
+     * least recently used textures. Evicted textures are re-streamed from their source files when they
+     * are marked as used again and there is room in the budget. Re-streaming is asynchronous and the
+     * textures are swapped in by a later call to updateResidency().
+     */
+    struct ResidencyOptions
+    {
+        uint64_t memoryBudgetInBytes = 0;   ///< Texture memory budget in bytes, or zero for no limit.
+        uint32_t minResidentDimension = 64; ///< Mips are not evicted if the resulting resolution would fall below this in either dimension.
+        uint32_t maxReloadsPerUpdate = 4;   ///< Max number of textures whose re-streaming is started per call to updateResidency().
+    };
+
+    /**
+     * Texture that has been replaced by updateResidency().
+     * The handle of the texture stays the same, but objects holding a reference to the old texture
+     * need to switch to the new one for the memory to be released.
+     */
+    struct TextureReplacement
+    {
+        ref<Texture> pOldTexture;
+        ref<Texture> pNewTexture;
     };
 
     /**
@@ -142,7 +179,7 @@ public:
      * Constructor.
      * @param[in] pDevice GPU device.
      * @param[in] maxTextureCount Maximum number of textures that can be simultaneously managed.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] threadCount Max number of textures loaded concurrently.
      */
     TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount = std::thread::hardware_concurrency());
 
@@ -169,6 +206,8 @@ public:
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] assetResolver Optional asset resolver for resolving file paths.
      * @param[out] loadedTextureCount Optionally can provided the number of actually loaded textures (2+ can happen with UDIMs)
+     * @param[in] owner Optional object using the texture, see ResidencyOptions.
+     * @param[in] alphaCutoff Alpha test threshold used with Bitmap::ImportFlags::PreserveAlphaCoverage.
      * @return Unique handle to the texture, or an invalid handle if the texture can't be found.
      */
     CpuTextureHandle loadTexture(
@@ -180,7 +219,8 @@ public:
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
         const AssetResolver* assetResolver = nullptr,
         size_t* loadedTextureCount = nullptr,
-        const Object* owner = nullptr
+        const Object* owner = nullptr,
+        float alphaCutoff = 0.5f
     );
 
     /**
@@ -279,6 +319,51 @@ public:
      */
     Stats getStats() const;
 
+    /**
+     * Set the options of the persistent texture cache used when loading textures from single files.
+     * The cache is disabled by default.
+     */
+    void setTextureCacheOptions(const TextureCache::Options& options) { mpTextureCache->setOptions(options); }
+
+    /**
+     * Get the persistent texture cache.
+     */
+    TextureCache& getTextureCache() const { return *mpTextureCache; }
+
+    /**
+     * Set the texture residency options. The new budget is applied on the next call to updateResidency().
+     */
+    void setResidencyOptions(const ResidencyOptions& options);
+
+    /**
+     * Get the texture residency options.
+     */
+    ResidencyOptions getResidencyOptions() const;
+
+    /**
+     * Mark a texture as used in the current frame.
+     * Used textures are evicted last. If the texture has evicted mips, they are re-streamed on the
+     * next call to updateResidency() if the budget allows.
+     * @param[in] handle Texture handle. For UDIM textures all tiles are marked as used.
+     */
+    void markTextureUsed(const CpuTextureHandle& handle);
+
+    /**
+     * Mark a texture as used in the current frame. Textures that are not managed are ignored.
+     * @param[in] pTexture The texture resource.
+     */
+    void markTextureUsed(const Texture* pTexture);
+
+    /**
+     * Enforce the texture memory budget and re-stream evicted textures that have been marked as used.
+     * This should be called once per frame from the main thread. Re-streamed textures are loaded by the
+     * async texture loader and swapped in by the first call after they have finished loading, see
+     * waitForAllTexturesLoading(). Textures that change are returned so that the caller can update all
+     * references to them. Texture handles are not affected.
+     * @return List of replaced textures.
+     */
+    std::vector<TextureReplacement> updateResidency();
+
 private:
     size_t getUdimRange(size_t requiredSize);
     void freeUdimRange(size_t rangeStart);
@@ -300,7 +385,8 @@ private:
         bool async = true,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
         const AssetResolver* assetResolver = nullptr,
-        size_t* loadedTextureCount = nullptr
+        size_t* loadedTextureCount = nullptr,
+        float alphaCutoff = 0.5f
     );
 
     /**
@@ -313,15 +399,22 @@ private:
         bool loadAsSRGB;
         ResourceBindFlags bindFlags;
         Bitmap::ImportFlags importFlags;
+        float alphaCutoff; ///< Alpha test threshold, only used with Bitmap::ImportFlags::PreserveAlphaCoverage.
 
         TextureKey(
             const std::vector<std::filesystem::path>& paths,
             bool mips,
             bool srgb,
             ResourceBindFlags flags,
-            Bitmap::ImportFlags importFlags
+            Bitmap::ImportFlags importFlags,
+            float alphaCutoff
         )
-            : fullPaths(paths), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags), importFlags(importFlags)
+            : fullPaths(paths)
+            , generateMipLevels(mips)
+            , loadAsSRGB(srgb)
+            , bindFlags(flags)
+            , importFlags(importFlags)
+            , alphaCutoff(is_set(importFlags, Bitmap::ImportFlags::PreserveAlphaCoverage) ? alphaCutoff : 0.5f)
         {}
 
         bool operator<(const TextureKey& rhs) const
@@ -334,11 +427,38 @@ private:
                 return loadAsSRGB < rhs.loadAsSRGB;
             else if (importFlags != rhs.importFlags)
                 return importFlags < rhs.importFlags;
+            else if (alphaCutoff != rhs.alphaCutoff)
+                return alphaCutoff < rhs.alphaCutoff;
             else
                 return bindFlags < rhs.bindFlags;
         }
     };
 
+    /// Residency state of a managed texture.
+    struct Residency
+    {
+        uint64_t lastUsedFrame = 0;             ///< Frame in which the texture was last marked as used.
+        uint32_t evictedMipCount = 0;           ///< Number of mip levels evicted from the texture.
+        uint64_t fullSizeInBytes = 0;           ///< Memory in bytes of the texture with all mips resident.
+        const Texture* pSizedTexture = nullptr; ///< Texture that sizeInBytes refers to.
+        uint64_t sizeInBytes = 0;               ///< Memory in bytes of the texture currently held by the desc.
+        bool reloadFailed = false;              ///< True if re-streaming the texture failed. It is not attempted again.
+        bool reloadPending = false;             ///< True while the texture is being re-streamed. It is not evicted meanwhile.
+    };
+
+    /// Re-streamed texture waiting to be swapped in by updateResidency().
+    struct CompletedReload
+    {
+        CpuTextureHandle handle;
+        ref<Texture> pEvictedTexture; ///< Texture the reload was started for. The reload is discarded if the handle changed texture.
+        ref<Texture> pTexture;        ///< Re-streamed texture, or nullptr if loading failed.
+    };
+
+    uint64_t getResidentSize(const CpuTextureHandle& handle);
+    ref<Texture> evictMips(const CpuTextureHandle& handle, uint32_t mipCount);
+    void reloadTexture(const CpuTextureHandle& handle, const TextureKey& key);
+    void replaceTexture(const CpuTextureHandle& handle, const ref<Texture>& pTexture, std::vector<TextureReplacement>& replacements);
+
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
@@ -370,6 +490,17 @@ private:
 
     bool mUseDeferredLoading = false;
 
+    ResidencyOptions mResidencyOptions;
+    std::vector<Residency> mResidency; ///< Residency state, indexed by handle ID.
+    uint64_t mResidencyFrame = 1;      ///< Current frame for usage tracking, advanced in updateResidency().
+    uint64_t mEvictionCount = 0;
+    uint64_t mEvictedMipCount = 0;
+    uint64_t mEvictedBytes = 0;
+    uint64_t mReloadCount = 0;
+    uint64_t mReloadedBytes = 0;
+    std::vector<CompletedReload> mCompletedReloads; ///< Reloads finished by the async texture loader. Must outlive the loader.
+
+    std::shared_ptr<TextureCache> mpTextureCache; ///< Persistent cache of derived textures. Shared with the async texture loader.
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
 
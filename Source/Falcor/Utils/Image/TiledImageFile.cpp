@@ -0,0 +1,279 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TiledImageFile.h"
+#include "Bitmap.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMagic = 0x454c4954; // "TILE"
+const uint32_t kVersion = 1;
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t tileSize;
+    uint32_t border;
+    uint32_t format;
+};
+
+float srgbToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+}
+
+/// RGBA image with float channels, used for mip generation.
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> texels;
+
+    float* at(uint32_t x, uint32_t y) { return texels.data() + 4 * (size_t(y) * width + x); }
+    const float* at(uint32_t x, uint32_t y) const { return texels.data() + 4 * (size_t(y) * width + x); }
+};
+
+Image loadImage(const Bitmap& bitmap, bool isSrgb)
+{
+    std::array<float, 256> decode;
+    for (uint32_t i = 0; i < 256; i++)
+        decode[i] = isSrgb ? srgbToLinear(i / 255.f) : i / 255.f;
+
+    const ResourceFormat format = bitmap.getFormat();
+    const bool isBgr = format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRX8Unorm ||
+                       format == ResourceFormat::BGRA8UnormSrgb || format == ResourceFormat::BGRX8UnormSrgb;
+    const bool hasAlpha = format != ResourceFormat::BGRX8Unorm && format != ResourceFormat::BGRX8UnormSrgb;
+
+    Image image;
+    image.width = bitmap.getWidth();
+    image.height = bitmap.getHeight();
+    image.texels.resize(size_t(image.width) * image.height * 4);
+    for (uint32_t y = 0; y < image.height; y++)
+    {
+        const uint8_t* pSrc = bitmap.getData() + size_t(y) * bitmap.getRowPitch();
+        for (uint32_t x = 0; x < image.width; x++, pSrc += 4)
+        {
+            float* pDst = image.at(x, y);
+            pDst[0] = decode[pSrc[isBgr ? 2 : 0]];
+            pDst[1] = decode[pSrc[1]];
+            pDst[2] = decode[pSrc[isBgr ? 0 : 2]];
+            pDst[3] = hasAlpha ? pSrc[3] / 255.f : 1.f; // Alpha is always linear.
+        }
+    }
+    return image;
+}
+
+/// Downsample by a factor of two with a box filter. Odd dimensions are handled by clamping.
+Image downsample(const Image& src)
+{
+    Image dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.texels.resize(size_t(dst.width) * dst.height * 4);
+    for (uint32_t y = 0; y < dst.height; y++)
+    {
+        const uint32_t y0 = std::min(2 * y, src.height - 1);
+        const uint32_t y1 = std::min(2 * y + 1, src.height - 1);
+        for (uint32_t x = 0; x < dst.width; x++)
+        {
+            const uint32_t x0 = std::min(2 * x, src.width - 1);
+            const uint32_t x1 = std::min(2 * x + 1, src.width - 1);
+            for (uint32_t c = 0; c < 4; c++)
+                dst.at(x, y)[c] = 0.25f * (src.at(x0, y0)[c] + src.at(x1, y0)[c] + src.at(x0, y1)[c] + src.at(x1, y1)[c]);
+        }
+    }
+    return dst;
+}
+
+uint8_t encode(float value, bool isSrgb)
+{
+    value = std::clamp(value, 0.f, 1.f);
+    if (isSrgb)
+        value = linearToSrgb(value);
+    return uint8_t(value * 255.f + 0.5f);
+}
+} // namespace
+
+uint32_t TiledImageFile::Desc::getTileIndex(uint32_t mip, uint32_t x, uint32_t y) const
+{
+    uint32_t index = 0;
+    for (uint32_t m = 0; m < mip; m++)
+        index += getTileCountX(m) * getTileCountY(m);
+    return index + y * getTileCountX(mip) + x;
+}
+
+uint32_t TiledImageFile::computeMipCount(uint32_t width, uint32_t height, uint32_t tileSize)
+{
+    uint32_t mipCount = 1;
+    while (std::max(width >> (mipCount - 1), height >> (mipCount - 1)) > tileSize)
+        mipCount++;
+    return mipCount;
+}
+
+bool TiledImageFile::isSupported(const Bitmap& bitmap)
+{
+    switch (bitmap.getFormat())
+    {
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::RGBA8UnormSrgb:
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void TiledImageFile::writeFromBitmap(const std::filesystem::path& path, const Bitmap& bitmap, uint32_t tileSize, uint32_t border, bool isSrgb)
+{
+    FALCOR_CHECK(isSupported(bitmap), "Unsupported bitmap format '{}'.", to_string(bitmap.getFormat()));
+    FALCOR_CHECK(tileSize > 0 && border < tileSize, "Invalid tile size.");
+
+    Desc desc;
+    desc.width = bitmap.getWidth();
+    desc.height = bitmap.getHeight();
+    desc.mipCount = computeMipCount(desc.width, desc.height, tileSize);
+    desc.tileSize = tileSize;
+    desc.border = border;
+    desc.format = isSrgb ? ResourceFormat::RGBA8UnormSrgb : ResourceFormat::RGBA8Unorm;
+
+    std::ofstream fs(path, std::ios_base::binary);
+    if (!fs.good())
+        FALCOR_THROW("Failed to create tiled image file '{}'.", path);
+
+    FileHeader header = {kMagic, kVersion, desc.width, desc.height, desc.mipCount, desc.tileSize, desc.border, (uint32_t)desc.format};
+    fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const uint32_t paddedSize = desc.getPaddedTileSize();
+    std::vector<uint8_t> tile(desc.getTileSizeInBytes());
+
+    Image image = loadImage(bitmap, isSrgb);
+    for (uint32_t mip = 0; mip < desc.mipCount; mip++)
+    {
+        if (mip > 0)
+            image = downsample(image);
+        FALCOR_ASSERT(image.width == desc.getMipWidth(mip) && image.height == desc.getMipHeight(mip));
+
+        for (uint32_t ty = 0; ty < desc.getTileCountY(mip); ty++)
+        {
+            for (uint32_t tx = 0; tx < desc.getTileCountX(mip); tx++)
+            {
+                // Fill the padded tile, fetching texels outside the image with wrap addressing.
+                uint8_t* pDst = tile.data();
+                for (uint32_t y = 0; y < paddedSize; y++)
+                {
+                    int64_t sy = int64_t(ty) * tileSize + y - border;
+                    sy = ((sy % image.height) + image.height) % image.height;
+                    for (uint32_t x = 0; x < paddedSize; x++, pDst += 4)
+                    {
+                        int64_t sx = int64_t(tx) * tileSize + x - border;
+                        sx = ((sx % image.width) + image.width) % image.width;
+                        const float* pSrc = image.at((uint32_t)sx, (uint32_t)sy);
+                        pDst[0] = encode(pSrc[0], isSrgb);
+                        pDst[1] = encode(pSrc[1], isSrgb);
+                        pDst[2] = encode(pSrc[2], isSrgb);
+                        pDst[3] = encode(pSrc[3], false);
+                    }
+                }
+                fs.write(reinterpret_cast<const char*>(tile.data()), tile.size());
+            }
+        }
+    }
+
+    if (fs.bad())
+        FALCOR_THROW("Failed to write tiled image file '{}'.", path);
+}
+
+std::unique_ptr<TiledImageFile> TiledImageFile::open(const std::filesystem::path& path)
+{
+    std::unique_ptr<TiledImageFile> pFile(new TiledImageFile());
+    pFile->mStream.open(path, std::ios_base::binary);
+    if (!pFile->mStream.good())
+        return nullptr;
+
+    FileHeader header = {};
+    pFile->mStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!pFile->mStream.good() || header.magic != kMagic || header.version != kVersion || header.tileSize == 0)
+    {
+        logWarning("Invalid tiled image file '{}'.", path);
+        return nullptr;
+    }
+
+    Desc& desc = pFile->mDesc;
+    desc.width = header.width;
+    desc.height = header.height;
+    desc.mipCount = header.mipCount;
+    desc.tileSize = header.tileSize;
+    desc.border = header.border;
+    desc.format = (ResourceFormat)header.format;
+    pFile->mDataOffset = sizeof(header);
+
+    // Validate the file size against the header.
+    std::error_code ec;
+    const uint64_t expectedSize = pFile->mDataOffset + uint64_t(desc.getTileCount()) * desc.getTileSizeInBytes();
+    if (desc.mipCount != computeMipCount(desc.width, desc.height, desc.tileSize) || std::filesystem::file_size(path, ec) != expectedSize)
+    {
+        logWarning("Tiled image file '{}' is truncated or corrupt.", path);
+        return nullptr;
+    }
+
+    return pFile;
+}
+
+bool TiledImageFile::readTile(uint32_t mip, uint32_t x, uint32_t y, void* pDst) const
+{
+    if (mip >= mDesc.mipCount || x >= mDesc.getTileCountX(mip) || y >= mDesc.getTileCountY(mip))
+        return false;
+
+    const size_t tileBytes = mDesc.getTileSizeInBytes();
+    const size_t offset = mDataOffset + size_t(mDesc.getTileIndex(mip, x, y)) * tileBytes;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStream.clear();
+    mStream.seekg(offset);
+    mStream.read(reinterpret_cast<char*>(pDst), tileBytes);
+    return mStream.good();
+}
+} // namespace Falcor
@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+class Bitmap;
+
+/**
+ * Image file storing a mip chain as fixed-size tiles for random access.
+ *
+ * Each tile holds tileSize x tileSize texels surrounded by a border of texels from the neighboring
+ * tiles (with wrap addressing), so that tiles can be filtered independently once placed in an atlas.
+ * Tiles are stored uncompressed in mip-major, row-major order, which allows reading any tile with a
+ * single seek. The mip chain ends with the first mip level that fits into a single tile.
+ */
+class FALCOR_API TiledImageFile
+{
+public:
+    struct Desc
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 0; ///< Number of stored mip levels. The last level fits into a single tile.
+        uint32_t tileSize = 0; ///< Tile size in texels, excluding the border.
+        uint32_t border = 0;   ///< Border size in texels.
+        ResourceFormat format = ResourceFormat::Unknown;
+
+        uint32_t getMipWidth(uint32_t mip) const { return std::max(1u, width >> mip); }
+        uint32_t getMipHeight(uint32_t mip) const { return std::max(1u, height >> mip); }
+        uint32_t getTileCountX(uint32_t mip) const { return (getMipWidth(mip) + tileSize - 1) / tileSize; }
+        uint32_t getTileCountY(uint32_t mip) const { return (getMipHeight(mip) + tileSize - 1) / tileSize; }
+        uint32_t getPaddedTileSize() const { return tileSize + 2 * border; }
+        size_t getTileSizeInBytes() const { return size_t(getPaddedTileSize()) * getPaddedTileSize() * getFormatBytesPerBlock(format); }
+
+        /// Get the linear index of a tile. Tiles of all mips are indexed consecutively, starting at the finest mip.
+        uint32_t getTileIndex(uint32_t mip, uint32_t x, uint32_t y) const;
+
+        /// Get the total number of tiles in all mips.
+        uint32_t getTileCount() const { return getTileIndex(mipCount, 0, 0); }
+    };
+
+    /**
+     * Compute the number of mip levels stored for an image of the given size.
+     */
+    static uint32_t computeMipCount(uint32_t width, uint32_t height, uint32_t tileSize);
+
+    /**
+     * Write a tiled image file from a bitmap.
+     * The mip chain is generated with a box filter. Only 8-bit RGBA and BGRA formats are supported,
+     * the tiles are always stored as RGBA.
+     * @param[in] path File path.
+     * @param[in] bitmap Source image.
+     * @param[in] tileSize Tile size in texels, excluding the border.
+     * @param[in] border Border size in texels.
+     * @param[in] isSrgb Filter the mips in linear space and mark the data as sRGB.
+     */
+    static void writeFromBitmap(const std::filesystem::path& path, const Bitmap& bitmap, uint32_t tileSize, uint32_t border, bool isSrgb);
+
+    /**
+     * Check if a bitmap can be stored with writeFromBitmap().
+     */
+    static bool isSupported(const Bitmap& bitmap);
+
+    /**
+     * Open a tiled image file for reading.
+     * @return The file, or nullptr if the file can't be opened or is invalid.
+     */
+    static std::unique_ptr<TiledImageFile> open(const std::filesystem::path& path);
+
+    const Desc& getDesc() const { return mDesc; }
+
+    /**
+     * Read a tile. This function is thread-safe.
+     * @param[in] mip Mip level.
+     * @param[in] x Tile x coordinate.
+     * @param[in] y Tile y coordinate.
+     * @param[out] pDst Destination with room for Desc::getTileSizeInBytes() bytes.
+     * @return True if successful.
+     */
+    bool readTile(uint32_t mip, uint32_t x, uint32_t y, void* pDst) const;
+
+private:
+    TiledImageFile() = default;
+
+    Desc mDesc;
+    size_t mDataOffset = 0;
+    mutable std::ifstream mStream;
+    mutable std::mutex mMutex;
+};
+} // namespace Falcor
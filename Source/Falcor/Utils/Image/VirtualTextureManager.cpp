@@ -0,0 +1,510 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VirtualTextureManager.h"
+#include "Bitmap.h"
+#include "TextureCache.h"
+#include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+namespace Falcor
+{
+namespace
+{
+/// Tiled image file version. Bump this whenever the stored data changes.
+const uint32_t kVersion = 1;
+
+/// Virtual texture cache directory (subdirectory in the application data directory).
+const std::string kDirectory = "NVIDIA/Falcor/VirtualTextureCache";
+
+const uint32_t kMaxAtlasDimension = 16384;
+} // namespace
+
+VirtualTextureManager::VirtualTextureManager(ref<Device> pDevice, const Options& options)
+    : mpDevice(pDevice), mOptions(options), mScheduler(options.maxRequestAge)
+{
+    FALCOR_CHECK(mOptions.tileSize > 0 && mOptions.border < mOptions.tileSize, "Invalid virtual texture tile size.");
+    FALCOR_CHECK(
+        mOptions.atlasSlotCount > 0 && mOptions.atlasSlotCount <= kVirtualTexturePageSlotMask + 1,
+        "Virtual texture atlas slot count must be in the range [1, {}].",
+        kVirtualTexturePageSlotMask + 1
+    );
+
+    mSlotsPerRow = (uint32_t)std::ceil(std::sqrt((double)mOptions.atlasSlotCount));
+    FALCOR_CHECK(
+        mSlotsPerRow * (mOptions.tileSize + 2 * mOptions.border) <= kMaxAtlasDimension,
+        "Virtual texture atlas with {} slots exceeds the max texture size.",
+        mOptions.atlasSlotCount
+    );
+
+    Sampler::Desc samplerDesc;
+    samplerDesc.setFilterMode(TextureFilteringMode::Linear, TextureFilteringMode::Linear, TextureFilteringMode::Point);
+    samplerDesc.setAddressingMode(TextureAddressingMode::Clamp, TextureAddressingMode::Clamp, TextureAddressingMode::Clamp);
+    mpAtlasSampler = mpDevice->createSampler(samplerDesc);
+}
+
+uint32_t VirtualTextureManager::addTexture(const std::filesystem::path& path, bool loadAsSrgb)
+{
+    const std::filesystem::path tiledPath = getTiledImagePath(path, loadAsSrgb);
+    if (tiledPath.empty())
+    {
+        logWarning("Failed to read virtual texture '{}'.", path);
+        return kInvalidID;
+    }
+
+    // Create the tiled image file if it doesn't exist yet.
+    if (!std::filesystem::exists(tiledPath))
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true);
+        if (!pBitmap)
+            return kInvalidID;
+        if (!TiledImageFile::isSupported(*pBitmap))
+        {
+            logWarning("Virtual texture '{}' has unsupported format '{}'.", path, to_string(pBitmap->getFormat()));
+            return kInvalidID;
+        }
+
+        try
+        {
+            writeFileAtomic(
+                tiledPath,
+                [&](const std::filesystem::path& tempPath)
+                { TiledImageFile::writeFromBitmap(tempPath, *pBitmap, mOptions.tileSize, mOptions.border, loadAsSrgb); }
+            );
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to create tiled image file for virtual texture '{}': {}", path, e.what());
+            return kInvalidID;
+        }
+    }
+
+    auto pFile = TiledImageFile::open(tiledPath);
+    if (!pFile)
+        return kInvalidID;
+
+    const auto& fileDesc = pFile->getDesc();
+    FALCOR_ASSERT(fileDesc.tileSize == mOptions.tileSize && fileDesc.border == mOptions.border);
+    if (fileDesc.mipCount > kVirtualTextureMaxMipCount)
+    {
+        logWarning("Virtual texture '{}' has more than {} mip levels.", path, kVirtualTextureMaxMipCount);
+        return kInvalidID;
+    }
+
+    // Read the coarsest mip level up front, it stays resident.
+    std::vector<uint8_t> tailData(fileDesc.getTileSizeInBytes());
+    if (!pFile->readTile(fileDesc.mipCount - 1, 0, 0, tailData.data()))
+    {
+        logWarning("Failed to read tiled image file '{}'.", tiledPath);
+        return kInvalidID;
+    }
+
+    const uint32_t textureID = (uint32_t)mTextures.size();
+    const size_t pageTableSize = mPageTable.size();
+    const bool texturesChanged = mTexturesChanged;
+    TextureData& texture = mTextures.emplace_back();
+    texture.path = path;
+    texture.desc.width = fileDesc.width;
+    texture.desc.height = fileDesc.height;
+    texture.desc.mipCount = fileDesc.mipCount;
+    texture.desc.pageTableOffset = (uint32_t)mPageTable.size();
+    texture.desc.atlasIndex = loadAsSrgb ? 1 : 0;
+    for (uint32_t mip = 0; mip < kVirtualTextureMaxMipCount; mip++)
+        texture.desc.mipPageOffsets[mip] = fileDesc.getTileIndex(std::min(mip, fileDesc.mipCount), 0, 0);
+    texture.pFile = std::move(pFile);
+
+    mPageTable.resize(mPageTable.size() + fileDesc.getTileCount(), 0);
+    mTexturesChanged = true;
+
+    VirtualTileKey tailKey = {textureID, fileDesc.mipCount - 1, 0, 0};
+    if (!loadTile(mpDevice->getRenderContext(), tailKey, tailData.data(), true))
+    {
+        // Unregister the texture. Allocation failures leave the tile cache and page table entries unchanged.
+        mTextures.pop_back();
+        mPageTable.resize(pageTableSize);
+        mTexturesChanged = texturesChanged;
+        FALCOR_THROW("Virtual texture atlas is full. Increase the atlas slot count.");
+    }
+
+    logDebug("Added virtual texture '{}' ({}x{}, {} mips) from '{}'.", path, fileDesc.width, fileDesc.height, fileDesc.mipCount, tiledPath);
+    return textureID;
+}
+
+const VirtualTextureDesc& VirtualTextureManager::getTextureDesc(uint32_t textureID) const
+{
+    FALCOR_CHECK(textureID < mTextures.size(), "Invalid virtual texture ID {}.", textureID);
+    return mTextures[textureID].desc;
+}
+
+bool VirtualTextureManager::update(RenderContext* pRenderContext)
+{
+    FALCOR_ASSERT(pRenderContext);
+    mFrame++;
+
+    bool resourcesChanged = false;
+    if (mTexturesChanged)
+    {
+        createResources();
+        mTexturesChanged = false;
+        resourcesChanged = true;
+    }
+
+    if (mTextures.empty())
+        return resourcesChanged;
+
+    readFeedback(pRenderContext);
+
+    // Nothing to do until the pending feedback readback completes, unless there are tiles left to load.
+    if (mFeedbackPending && mScheduler.getPendingCount() == 0 && mDirtyPageBegin == mDirtyPageEnd)
+        return resourcesChanged;
+
+    // Load the highest priority tiles. The tiles are read from disk in parallel.
+    auto keys = mScheduler.pop(mOptions.maxTileUploadsPerFrame, mFrame);
+    std::vector<std::vector<uint8_t>> tileData(keys.size());
+    NumericRange<size_t> keyRange(0, keys.size());
+    std::for_each(
+        std::execution::par,
+        keyRange.begin(),
+        keyRange.end(),
+        [&](size_t i)
+        {
+            const auto& file = *mTextures[keys[i].textureID].pFile;
+            tileData[i].resize(file.getDesc().getTileSizeInBytes());
+            if (!file.readTile(keys[i].mip, keys[i].x, keys[i].y, tileData[i].data()))
+                tileData[i].clear();
+        }
+    );
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (tileData[i].empty())
+        {
+            logWarning("Failed to read tile (mip {}, {}, {}) of virtual texture '{}'.", keys[i].mip, keys[i].x, keys[i].y, mTextures[keys[i].textureID].path);
+            continue;
+        }
+        // Allocation fails if all slots are in use in this frame. The tile is requested again by the feedback if still needed.
+        loadTile(pRenderContext, keys[i], tileData[i].data(), false);
+    }
+
+    // Upload the modified page table range.
+    if (mDirtyPageBegin < mDirtyPageEnd)
+    {
+        mpPageTableBuffer->setBlob(
+            mPageTable.data() + mDirtyPageBegin, mDirtyPageBegin * sizeof(uint32_t), (mDirtyPageEnd - mDirtyPageBegin) * sizeof(uint32_t)
+        );
+        mDirtyPageBegin = mDirtyPageEnd = 0;
+    }
+
+    // Copy the feedback written since the last readback and reset it. The copy is submitted with the rest of the frame,
+    // after which the render context fence reaches its next signaled value. The readback is processed once it is reached.
+    if (!mFeedbackPending)
+    {
+        pRenderContext->copyBufferRegion(mpFeedbackReadbackBuffer.get(), 0, mpFeedbackBuffer.get(), 0, mpFeedbackBuffer->getSize());
+        pRenderContext->clearUAV(mpFeedbackBuffer->getUAV().get(), uint4(0));
+        mFeedbackFenceValue = pRenderContext->getLowLevelData()->getFence()->getSignaledValue() + 1;
+        mFeedbackPending = true;
+    }
+
+    return resourcesChanged;
+}
+
+void VirtualTextureManager::bindShaderData(const ShaderVar& var) const
+{
+    FALCOR_CHECK(mpDescBuffer && !mTexturesChanged, "Virtual texture resources are not ready. Call update() first.");
+
+    var["textureDescs"] = mpDescBuffer;
+    var["pageTable"] = mpPageTableBuffer;
+    var["feedback"] = mpFeedbackBuffer;
+
+    // Atlases are created on demand. Bind the existing one to both slots if only one is in use.
+    const ref<Texture>& pLinearAtlas = mAtlases[0].pTexture ? mAtlases[0].pTexture : mAtlases[1].pTexture;
+    const ref<Texture>& pSrgbAtlas = mAtlases[1].pTexture ? mAtlases[1].pTexture : mAtlases[0].pTexture;
+    var["linearAtlas"] = pLinearAtlas;
+    var["srgbAtlas"] = pSrgbAtlas;
+    var["atlasSampler"] = mpAtlasSampler;
+
+    var["tileSize"] = mOptions.tileSize;
+    var["border"] = mOptions.border;
+    var["slotsPerRow"] = mSlotsPerRow;
+}
+
+VirtualTextureManager::Stats VirtualTextureManager::getStats() const
+{
+    Stats stats;
+    stats.textureCount = (uint32_t)mTextures.size();
+    stats.pendingRequestCount = (uint32_t)mScheduler.getPendingCount();
+    stats.requestedTileCount = mRequestedTileCount;
+    stats.uploadedTileCount = mUploadedTileCount;
+    for (const auto& atlas : mAtlases)
+    {
+        if (!atlas.pTexture)
+            continue;
+        stats.residentTileCount += atlas.pCache->getUsedSlotCount();
+        stats.evictedTileCount += atlas.pCache->getStats().evictionCount;
+        stats.atlasMemoryInBytes += atlas.pTexture->getTextureSizeInBytes();
+    }
+    for (const auto& pBuffer : {mpDescBuffer, mpPageTableBuffer, mpFeedbackBuffer, mpFeedbackReadbackBuffer})
+        stats.pageTableMemoryInBytes += pBuffer ? pBuffer->getSize() : 0;
+    return stats;
+}
+
+std::filesystem::path VirtualTextureManager::getTiledImagePath(const std::filesystem::path& path, bool loadAsSrgb) const
+{
+    std::filesystem::path directory = mOptions.cacheDirectory;
+    if (directory.empty())
+        directory = getAppDataDirectory() / kDirectory;
+
+    auto sourceKey = TextureCache::computeKey(path, true, loadAsSrgb, false, Bitmap::ImportFlags::None, 0.5f, directory);
+    if (!sourceKey)
+        return {};
+
+    SHA1 sha1;
+    sha1.update(kVersion);
+    sha1.update(mOptions.tileSize);
+    sha1.update(mOptions.border);
+    sha1.update(sourceKey->low);
+    sha1.update(sourceKey->high);
+    return directory / (SHA1::toString(sha1.finalize()) + ".tiles");
+}
+
+VirtualTextureManager::Atlas& VirtualTextureManager::getAtlas(uint32_t atlasIndex)
+{
+    FALCOR_ASSERT(atlasIndex < 2);
+    Atlas& atlas = mAtlases[atlasIndex];
+    if (!atlas.pTexture)
+    {
+        const uint32_t size = mSlotsPerRow * (mOptions.tileSize + 2 * mOptions.border);
+        const ResourceFormat format = atlasIndex == 0 ? ResourceFormat::RGBA8Unorm : ResourceFormat::RGBA8UnormSrgb;
+        atlas.pTexture = mpDevice->createTexture2D(size, size, format, 1, 1, nullptr, ResourceBindFlags::ShaderResource);
+        atlas.pTexture->setName(atlasIndex == 0 ? "VirtualTextureManager::linearAtlas" : "VirtualTextureManager::srgbAtlas");
+        atlas.pCache = std::make_unique<VirtualTextureTileCache>(mOptions.atlasSlotCount);
+    }
+    return atlas;
+}
+
+VirtualTileKey VirtualTextureManager::getTileKey(uint32_t pageIndex) const
+{
+    // Find the texture owning the page. Page table ranges are allocated in texture order.
+    auto it = std::upper_bound(
+        mTextures.begin(),
+        mTextures.end(),
+        pageIndex,
+        [](uint32_t index, const TextureData& texture) { return index < texture.desc.pageTableOffset; }
+    );
+    FALCOR_ASSERT(it != mTextures.begin());
+    --it;
+
+    const auto& fileDesc = it->pFile->getDesc();
+    VirtualTileKey key;
+    key.textureID = (uint32_t)(it - mTextures.begin());
+    uint32_t index = pageIndex - it->desc.pageTableOffset;
+    while (key.mip + 1 < fileDesc.mipCount && index >= fileDesc.getTileCountX(key.mip) * fileDesc.getTileCountY(key.mip))
+    {
+        index -= fileDesc.getTileCountX(key.mip) * fileDesc.getTileCountY(key.mip);
+        key.mip++;
+    }
+    key.x = index % fileDesc.getTileCountX(key.mip);
+    key.y = index / fileDesc.getTileCountX(key.mip);
+    return key;
+}
+
+uint32_t VirtualTextureManager::getPageIndex(const VirtualTileKey& key) const
+{
+    const auto& texture = mTextures[key.textureID];
+    return texture.desc.pageTableOffset + texture.desc.mipPageOffsets[key.mip] + key.y * texture.pFile->getDesc().getTileCountX(key.mip) +
+           key.x;
+}
+
+VirtualTileKey VirtualTextureManager::getParentKey(const VirtualTileKey& key) const
+{
+    // Tiles at the right and bottom edges can map past the parent mip level if the mip dimensions are odd.
+    const auto& fileDesc = mTextures[key.textureID].pFile->getDesc();
+    FALCOR_ASSERT(key.mip + 1 < fileDesc.mipCount);
+    VirtualTileKey parent = key;
+    parent.mip++;
+    parent.x = std::min(key.x / 2, fileDesc.getTileCountX(parent.mip) - 1);
+    parent.y = std::min(key.y / 2, fileDesc.getTileCountY(parent.mip) - 1);
+    return parent;
+}
+
+template<typename F>
+void VirtualTextureManager::forEachCoveredPage(const VirtualTileKey& key, F func) const
+{
+    // A tile covers the tiles whose parent chain leads to it, see getParentKey(). Repeatedly halving and clamping
+    // is the same as shifting once and clamping to the tile count of the mip level.
+    const auto& texture = mTextures[key.textureID];
+    const auto& fileDesc = texture.pFile->getDesc();
+    const bool lastX = key.x + 1 == fileDesc.getTileCountX(key.mip);
+    const bool lastY = key.y + 1 == fileDesc.getTileCountY(key.mip);
+    for (uint32_t mip = key.mip + 1; mip-- > 0;)
+    {
+        const uint32_t shift = key.mip - mip;
+        const uint32_t countX = fileDesc.getTileCountX(mip);
+        const uint32_t countY = fileDesc.getTileCountY(mip);
+        const uint32_t endX = lastX ? countX : std::min((key.x + 1) << shift, countX);
+        const uint32_t endY = lastY ? countY : std::min((key.y + 1) << shift, countY);
+        const uint32_t mipOffset = texture.desc.pageTableOffset + texture.desc.mipPageOffsets[mip];
+        for (uint32_t y = key.y << shift; y < endY; y++)
+        {
+            for (uint32_t x = key.x << shift; x < endX; x++)
+                func(mipOffset + y * countX + x);
+        }
+    }
+}
+
+void VirtualTextureManager::readFeedback(RenderContext* pRenderContext)
+{
+    if (!mFeedbackPending || pRenderContext->getLowLevelData()->getFence()->getCurrentValue() < mFeedbackFenceValue)
+        return;
+
+    mRequestedTileCount = 0;
+    const uint32_t* pBits = static_cast<const uint32_t*>(mpFeedbackReadbackBuffer->map());
+    const uint32_t wordCount = (uint32_t)(mpFeedbackReadbackBuffer->getSize() / sizeof(uint32_t));
+    for (uint32_t word = 0; word < wordCount; word++)
+    {
+        if (pBits[word] == 0)
+            continue;
+        for (uint32_t bit = 0; bit < 32; bit++)
+        {
+            const uint32_t pageIndex = word * 32 + bit;
+            if ((pBits[word] & (1u << bit)) == 0 || pageIndex >= mPageTable.size())
+                continue;
+
+            mRequestedTileCount++;
+            VirtualTileKey key = getTileKey(pageIndex);
+            const auto& texture = mTextures[key.textureID];
+            auto& cache = *mAtlases[texture.desc.atlasIndex].pCache;
+            if (cache.touch(key, mFrame))
+                continue;
+
+            // Coarser mips are loaded first, so that the fallback improves progressively.
+            mScheduler.request(key, mFrame, (float)key.mip);
+
+            // Keep the resident parent tiles alive, they are used as fallback until the tile is loaded.
+            while (key.mip + 1 < texture.desc.mipCount)
+            {
+                key = getParentKey(key);
+                if (cache.touch(key, mFrame))
+                    break;
+            }
+        }
+    }
+    mpFeedbackReadbackBuffer->unmap();
+    mFeedbackPending = false;
+}
+
+void VirtualTextureManager::setPageEntry(uint32_t pageIndex, uint32_t entry)
+{
+    mPageTable[pageIndex] = entry;
+    if (mDirtyPageBegin == mDirtyPageEnd)
+    {
+        mDirtyPageBegin = pageIndex;
+        mDirtyPageEnd = pageIndex + 1;
+    }
+    else
+    {
+        mDirtyPageBegin = std::min(mDirtyPageBegin, pageIndex);
+        mDirtyPageEnd = std::max(mDirtyPageEnd, pageIndex + 1);
+    }
+}
+
+bool VirtualTextureManager::loadTile(RenderContext* pRenderContext, const VirtualTileKey& key, const void* pData, bool pinned)
+{
+    Atlas& atlas = getAtlas(mTextures[key.textureID].desc.atlasIndex);
+    auto allocation = atlas.pCache->allocate(key, mFrame, pinned);
+    if (!allocation)
+        return false;
+
+    // Pages that fell back to the evicted tile fall back to its parent instead. The last mip level is pinned and never evicted.
+    if (allocation->evicted)
+    {
+        const VirtualTileKey& evicted = *allocation->evicted;
+        const uint32_t evictedEntry = mPageTable[getPageIndex(evicted)];
+        const uint32_t parentEntry = mPageTable[getPageIndex(getParentKey(evicted))];
+        forEachCoveredPage(evicted, [&](uint32_t pageIndex) {
+            if (mPageTable[pageIndex] == evictedEntry)
+                setPageEntry(pageIndex, parentEntry);
+        });
+    }
+
+    const uint32_t paddedSize = mOptions.tileSize + 2 * mOptions.border;
+    const uint3 offset((allocation->slot % mSlotsPerRow) * paddedSize, (allocation->slot / mSlotsPerRow) * paddedSize, 0);
+    pRenderContext->updateSubresourceData(atlas.pTexture.get(), 0, pData, offset, uint3(paddedSize, paddedSize, 1));
+
+    // Pages covered by the tile that fall back to a coarser tile use the new tile instead.
+    const uint32_t entry = kVirtualTexturePageResident | (key.mip << kVirtualTexturePageMipShift) | allocation->slot;
+    forEachCoveredPage(key, [&](uint32_t pageIndex) {
+        const uint32_t current = mPageTable[pageIndex];
+        const uint32_t currentMip = (current >> kVirtualTexturePageMipShift) & kVirtualTexturePageMipMask;
+        if ((current & kVirtualTexturePageResident) == 0 || currentMip > key.mip)
+            setPageEntry(pageIndex, entry);
+    });
+    mUploadedTileCount++;
+    return true;
+}
+
+void VirtualTextureManager::createResources()
+{
+    std::vector<VirtualTextureDesc> descs;
+    descs.reserve(mTextures.size());
+    for (const auto& texture : mTextures)
+        descs.push_back(texture.desc);
+
+    const uint32_t textureCount = std::max(1u, (uint32_t)descs.size());
+    const uint32_t pageCount = std::max(1u, (uint32_t)mPageTable.size());
+    const uint32_t feedbackSize = ((pageCount + 31) / 32) * sizeof(uint32_t);
+
+    mpDescBuffer = mpDevice->createStructuredBuffer(
+        sizeof(VirtualTextureDesc), textureCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false
+    );
+    if (!descs.empty())
+        mpDescBuffer->setBlob(descs.data(), 0, descs.size() * sizeof(VirtualTextureDesc));
+    mpDescBuffer->setName("VirtualTextureManager::textureDescs");
+
+    mpPageTableBuffer = mpDevice->createStructuredBuffer(
+        sizeof(uint32_t), pageCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false
+    );
+    if (!mPageTable.empty())
+        mpPageTableBuffer->setBlob(mPageTable.data(), 0, mPageTable.size() * sizeof(uint32_t));
+    mpPageTableBuffer->setName("VirtualTextureManager::pageTable");
+    mDirtyPageBegin = mDirtyPageEnd = 0;
+
+    // Feedback from before the re-creation refers to the old buffers and is dropped.
+    mpFeedbackBuffer = mpDevice->createBuffer(feedbackSize, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+    mpFeedbackBuffer->setName("VirtualTextureManager::feedback");
+    mpFeedbackReadbackBuffer = mpDevice->createBuffer(feedbackSize, ResourceBindFlags::None, MemoryType::ReadBack);
+    mFeedbackPending = false;
+    mpDevice->getRenderContext()->clearUAV(mpFeedbackBuffer->getUAV().get(), uint4(0));
+}
+} // namespace Falcor
@@ -0,0 +1,178 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "TiledImageFile.h"
+#include "VirtualTextureTileCache.h"
+#include "VirtualTextureData.slang"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Buffer.h"
+#include "Core/API/Sampler.h"
+#include "Core/API/Texture.h"
+#include "Core/Program/ShaderVar.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+class RenderContext;
+
+/**
+ * Manager for virtual textures.
+ *
+ * Virtual textures are stored as tiled image files in an on-disk cache (see TiledImageFile). Only the
+ * tiles requested by the shaders are kept resident in a physical tile atlas on the GPU. Each frame,
+ * the feedback written by VirtualTextureSystem::sampleLevel() is read back, missing tiles are scheduled
+ * and up to a fixed number of tiles are loaded in priority order (coarse mips first). When the atlas is
+ * full, the least recently used tiles are evicted. The coarsest mip level of each texture is always
+ * resident, so lookups always find a tile to fall back to. The page table entry of each tile points to
+ * the finest resident tile covering it, so that shaders find the fallback with a single lookup.
+ *
+ * The feedback readback is asynchronous and doesn't stall, so tiles appear with a latency of at least
+ * one frame.
+ */
+class FALCOR_API VirtualTextureManager
+{
+public:
+    static constexpr uint32_t kInvalidID = uint32_t(-1);
+
+    struct Options
+    {
+        uint32_t tileSize = 128;                 ///< Tile size in texels, excluding the border.
+        uint32_t border = 1;                     ///< Tile border in texels. Needed for bilinear filtering across tiles.
+        uint32_t atlasSlotCount = 1024;          ///< Number of tiles in each physical atlas.
+        uint32_t maxTileUploadsPerFrame = 64;    ///< Max number of tiles loaded per update() call.
+        uint32_t maxRequestAge = 8;              ///< Number of frames after which unserviced tile requests are dropped.
+        std::filesystem::path cacheDirectory;    ///< Directory for the tiled image files, or empty to use the application data directory.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    struct Stats
+    {
+        uint32_t textureCount = 0;         ///< Number of virtual textures.
+        uint32_t residentTileCount = 0;    ///< Number of tiles resident in the atlases.
+        uint32_t pendingRequestCount = 0;  ///< Number of tile requests waiting to be serviced.
+        uint32_t requestedTileCount = 0;   ///< Number of tiles requested in the last feedback readback.
+        uint64_t uploadedTileCount = 0;    ///< Total number of tiles uploaded.
+        uint64_t evictedTileCount = 0;     ///< Total number of tiles evicted.
+        uint64_t atlasMemoryInBytes = 0;   ///< Memory used by the atlases.
+        uint64_t pageTableMemoryInBytes = 0; ///< Memory used by the page table and feedback buffers.
+    };
+
+    VirtualTextureManager(ref<Device> pDevice, const Options& options = Options());
+
+    /**
+     * Add a virtual texture.
+     * The tiled image file is created in the cache directory on first use. Only 8-bit RGBA/BGRA images are supported.
+     * @param[in] path Image file path.
+     * @param[in] loadAsSrgb Load the texture as sRGB.
+     * @return Virtual texture ID, or kInvalidID if the image can't be loaded.
+     */
+    uint32_t addTexture(const std::filesystem::path& path, bool loadAsSrgb);
+
+    uint32_t getTextureCount() const { return (uint32_t)mTextures.size(); }
+
+    /**
+     * Get the description of a virtual texture.
+     */
+    const VirtualTextureDesc& getTextureDesc(uint32_t textureID) const;
+
+    /**
+     * Process the shader feedback and stream in requested tiles. Call once per frame before rendering.
+     * @param[in] pRenderContext Render context.
+     * @return True if GPU resources were re-created and need to be bound again.
+     */
+    bool update(RenderContext* pRenderContext);
+
+    /**
+     * Bind the virtual texture system to a shader var of type VirtualTextureSystem.
+     */
+    void bindShaderData(const ShaderVar& var) const;
+
+    Stats getStats() const;
+
+    const Options& getOptions() const { return mOptions; }
+
+private:
+    struct TextureData
+    {
+        std::filesystem::path path;
+        std::unique_ptr<TiledImageFile> pFile;
+        VirtualTextureDesc desc;
+    };
+
+    struct Atlas
+    {
+        ref<Texture> pTexture;
+        std::unique_ptr<VirtualTextureTileCache> pCache;
+    };
+
+    std::filesystem::path getTiledImagePath(const std::filesystem::path& path, bool loadAsSrgb) const;
+    Atlas& getAtlas(uint32_t atlasIndex);
+    VirtualTileKey getTileKey(uint32_t pageIndex) const;
+    uint32_t getPageIndex(const VirtualTileKey& key) const;
+    VirtualTileKey getParentKey(const VirtualTileKey& key) const;
+    void readFeedback(RenderContext* pRenderContext);
+    void setPageEntry(uint32_t pageIndex, uint32_t entry);
+    /// Call a function for the page table index of a tile and of all the tiles of finer mip levels it covers.
+    template<typename F>
+    void forEachCoveredPage(const VirtualTileKey& key, F func) const;
+    bool loadTile(RenderContext* pRenderContext, const VirtualTileKey& key, const void* pData, bool pinned);
+    void createResources();
+
+    ref<Device> mpDevice;
+    Options mOptions;
+    uint32_t mSlotsPerRow = 0;
+
+    std::vector<TextureData> mTextures;
+    std::vector<uint32_t> mPageTable;   ///< Page table entries for all textures, see kVirtualTexturePageResident.
+    uint32_t mDirtyPageBegin = 0;       ///< First page table entry that needs to be uploaded.
+    uint32_t mDirtyPageEnd = 0;         ///< One past the last page table entry that needs to be uploaded.
+    bool mTexturesChanged = false;
+
+    Atlas mAtlases[2];
+    VirtualTextureTileScheduler mScheduler;
+    uint64_t mFrame = 0;
+
+    // GPU resources
+    ref<Buffer> mpDescBuffer;
+    ref<Buffer> mpPageTableBuffer;
+    ref<Buffer> mpFeedbackBuffer;
+    ref<Buffer> mpFeedbackReadbackBuffer;
+    uint64_t mFeedbackFenceValue = 0; ///< Render context fence value at which the feedback readback is complete.
+    bool mFeedbackPending = false;
+    ref<Sampler> mpAtlasSampler;
+
+    // Stats
+    uint32_t mRequestedTileCount = 0;
+    uint64_t mUploadedTileCount = 0;
+};
+} // namespace Falcor
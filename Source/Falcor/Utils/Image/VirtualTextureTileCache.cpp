@@ -0,0 +1,244 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VirtualTextureTileCache.h"
+#include "Core/Error.h"
+#include <algorithm>
+
+namespace Falcor
+{
+VirtualTextureTileCache::VirtualTextureTileCache(uint32_t slotCount)
+{
+    FALCOR_CHECK(slotCount > 0, "Tile cache needs at least one slot.");
+    mSlots.resize(slotCount);
+
+    // Hand out slots in increasing order.
+    mFreeSlots.resize(slotCount);
+    for (uint32_t i = 0; i < slotCount; i++)
+        mFreeSlots[i] = slotCount - 1 - i;
+}
+
+uint32_t VirtualTextureTileCache::find(const VirtualTileKey& key) const
+{
+    auto it = mKeyToSlot.find(key.pack());
+    return it != mKeyToSlot.end() ? it->second : kInvalidSlot;
+}
+
+bool VirtualTextureTileCache::touch(const VirtualTileKey& key, uint64_t frame)
+{
+    auto it = mKeyToSlot.find(key.pack());
+    if (it == mKeyToSlot.end())
+        return false;
+
+    Slot& slot = mSlots[it->second];
+    slot.lastUsedFrame = std::max(slot.lastUsedFrame, frame);
+    if (!slot.pinned)
+    {
+        unlink(it->second);
+        pushBack(it->second);
+    }
+    return true;
+}
+
+std::optional<VirtualTextureTileCache::Allocation> VirtualTextureTileCache::allocate(const VirtualTileKey& key, uint64_t frame, bool pinned)
+{
+    const uint64_t packedKey = key.pack();
+    if (auto it = mKeyToSlot.find(packedKey); it != mKeyToSlot.end())
+    {
+        const uint32_t index = it->second;
+        if (pinned && !mSlots[index].pinned)
+        {
+            unlink(index);
+            mSlots[index].pinned = true;
+        }
+        touch(key, frame);
+        return Allocation{index, {}};
+    }
+
+    Allocation allocation;
+    if (!mFreeSlots.empty())
+    {
+        allocation.slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        // Evict the least recently used tile, unless it is in use in this frame.
+        if (mHead == kNull || mSlots[mHead].lastUsedFrame >= frame)
+        {
+            mStats.failedCount++;
+            return {};
+        }
+        allocation.slot = mHead;
+        allocation.evicted = VirtualTileKey::unpack(mSlots[mHead].key);
+        mKeyToSlot.erase(mSlots[mHead].key);
+        unlink(mHead);
+        mStats.evictionCount++;
+    }
+
+    Slot& slot = mSlots[allocation.slot];
+    slot = {};
+    slot.key = packedKey;
+    slot.lastUsedFrame = frame;
+    slot.pinned = pinned;
+    if (!pinned)
+        pushBack(allocation.slot);
+    mKeyToSlot[packedKey] = allocation.slot;
+    mStats.allocationCount++;
+
+    return allocation;
+}
+
+bool VirtualTextureTileCache::remove(const VirtualTileKey& key)
+{
+    auto it = mKeyToSlot.find(key.pack());
+    if (it == mKeyToSlot.end())
+        return false;
+
+    const uint32_t index = it->second;
+    mKeyToSlot.erase(it);
+    release(index);
+    return true;
+}
+
+uint32_t VirtualTextureTileCache::removeTexture(uint32_t textureID)
+{
+    uint32_t count = 0;
+    for (auto it = mKeyToSlot.begin(); it != mKeyToSlot.end();)
+    {
+        if (VirtualTileKey::unpack(it->first).textureID == textureID)
+        {
+            release(it->second);
+            it = mKeyToSlot.erase(it);
+            count++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return count;
+}
+
+void VirtualTextureTileCache::unlink(uint32_t index)
+{
+    Slot& slot = mSlots[index];
+    if (slot.prev != kNull)
+        mSlots[slot.prev].next = slot.next;
+    else if (mHead == index)
+        mHead = slot.next;
+    if (slot.next != kNull)
+        mSlots[slot.next].prev = slot.prev;
+    else if (mTail == index)
+        mTail = slot.prev;
+    slot.prev = slot.next = kNull;
+}
+
+void VirtualTextureTileCache::pushBack(uint32_t index)
+{
+    Slot& slot = mSlots[index];
+    slot.prev = mTail;
+    slot.next = kNull;
+    if (mTail != kNull)
+        mSlots[mTail].next = index;
+    mTail = index;
+    if (mHead == kNull)
+        mHead = index;
+}
+
+void VirtualTextureTileCache::release(uint32_t index)
+{
+    if (!mSlots[index].pinned)
+        unlink(index);
+    mSlots[index] = {};
+    mFreeSlots.push_back(index);
+}
+
+void VirtualTextureTileScheduler::request(const VirtualTileKey& key, uint64_t frame, float priority)
+{
+    auto [it, inserted] = mRequests.try_emplace(key.pack(), Request{key, priority, frame});
+    if (!inserted)
+    {
+        it->second.priority = std::max(it->second.priority, priority);
+        it->second.frame = std::max(it->second.frame, frame);
+    }
+}
+
+std::vector<VirtualTileKey> VirtualTextureTileScheduler::pop(uint32_t maxCount, uint64_t frame)
+{
+    // Drop expired requests and gather the rest.
+    std::vector<Request> requests;
+    requests.reserve(mRequests.size());
+    for (auto it = mRequests.begin(); it != mRequests.end();)
+    {
+        if (it->second.frame + mMaxRequestAge < frame)
+        {
+            it = mRequests.erase(it);
+        }
+        else
+        {
+            requests.push_back(it->second);
+            ++it;
+        }
+    }
+
+    // Order by priority, then by recency. The key is used as a tie breaker to make the order deterministic.
+    const size_t count = std::min<size_t>(maxCount, requests.size());
+    std::partial_sort(
+        requests.begin(),
+        requests.begin() + count,
+        requests.end(),
+        [](const Request& a, const Request& b)
+        {
+            if (a.priority != b.priority)
+                return a.priority > b.priority;
+            if (a.frame != b.frame)
+                return a.frame > b.frame;
+            return a.key.pack() < b.key.pack();
+        }
+    );
+
+    std::vector<VirtualTileKey> keys(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        keys[i] = requests[i].key;
+        mRequests.erase(keys[i].pack());
+    }
+    return keys;
+}
+
+void VirtualTextureTileScheduler::cancelTexture(uint32_t textureID)
+{
+    for (auto it = mRequests.begin(); it != mRequests.end();)
+    {
+        if (it->second.key.textureID == textureID)
+            it = mRequests.erase(it);
+        else
+            ++it;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,215 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Identifies a tile of a virtual texture.
+ */
+struct VirtualTileKey
+{
+    uint32_t textureID = 0; ///< Virtual texture ID.
+    uint32_t mip = 0;       ///< Mip level.
+    uint32_t x = 0;         ///< Tile x coordinate in the mip level.
+    uint32_t y = 0;         ///< Tile y coordinate in the mip level.
+
+    /// Pack the key into a single integer. Limited to 2^24 textures, 2^8 mips and 2^16 tiles per dimension.
+    uint64_t pack() const { return (uint64_t(textureID) << 40) | (uint64_t(mip) << 32) | (uint64_t(y) << 16) | uint64_t(x); }
+
+    static VirtualTileKey unpack(uint64_t packed)
+    {
+        return {uint32_t(packed >> 40), uint32_t(packed >> 32) & 0xff, uint32_t(packed) & 0xffff, uint32_t(packed >> 16) & 0xffff};
+    }
+
+    bool operator==(const VirtualTileKey& rhs) const { return pack() == rhs.pack(); }
+    bool operator!=(const VirtualTileKey& rhs) const { return pack() != rhs.pack(); }
+};
+
+/**
+ * Cache of tiles resident in a physical tile atlas.
+ *
+ * The cache maps tile keys to a fixed number of atlas slots and evicts the least recently used tiles
+ * when it runs out of free slots. Tiles used in the current frame are never evicted, which prevents
+ * thrashing when the working set is larger than the atlas. Pinned tiles are never evicted.
+ *
+ * This class only manages the slot assignment, it does not hold any tile data or GPU resources.
+ */
+class FALCOR_API VirtualTextureTileCache
+{
+public:
+    static constexpr uint32_t kInvalidSlot = uint32_t(-1);
+
+    struct Allocation
+    {
+        uint32_t slot = kInvalidSlot;          ///< Allocated atlas slot.
+        std::optional<VirtualTileKey> evicted; ///< Tile that was evicted to free the slot, if any.
+    };
+
+    struct Stats
+    {
+        uint64_t allocationCount = 0; ///< Total number of tiles allocated.
+        uint64_t evictionCount = 0;   ///< Total number of tiles evicted to make room for new tiles.
+        uint64_t failedCount = 0;     ///< Total number of allocations that failed because all slots were in use.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] slotCount Number of slots in the atlas.
+     */
+    explicit VirtualTextureTileCache(uint32_t slotCount);
+
+    uint32_t getSlotCount() const { return (uint32_t)mSlots.size(); }
+
+    /**
+     * Get the number of slots holding a tile.
+     */
+    uint32_t getUsedSlotCount() const { return (uint32_t)mKeyToSlot.size(); }
+
+    /**
+     * Find the slot of a resident tile.
+     * @return Slot index, or kInvalidSlot if the tile is not resident.
+     */
+    uint32_t find(const VirtualTileKey& key) const;
+
+    /**
+     * Mark a tile as used in the given frame.
+     * @return True if the tile is resident.
+     */
+    bool touch(const VirtualTileKey& key, uint64_t frame);
+
+    /**
+     * Allocate a slot for a tile.
+     * If the tile is already resident, its slot is returned. Otherwise a free slot is used, or the least
+     * recently used tile that was not used in the given frame is evicted.
+     * @param[in] key Tile key.
+     * @param[in] frame Current frame.
+     * @param[in] pinned Pin the tile so that it is never evicted.
+     * @return The allocation, or an empty optional if all slots are pinned or in use in this frame.
+     */
+    std::optional<Allocation> allocate(const VirtualTileKey& key, uint64_t frame, bool pinned = false);
+
+    /**
+     * Remove a tile from the cache, including pinned tiles.
+     * @return True if the tile was resident.
+     */
+    bool remove(const VirtualTileKey& key);
+
+    /**
+     * Remove all tiles of a texture from the cache, including pinned tiles.
+     * @return Number of tiles removed.
+     */
+    uint32_t removeTexture(uint32_t textureID);
+
+    const Stats& getStats() const { return mStats; }
+
+private:
+    static constexpr uint32_t kNull = kInvalidSlot;
+
+    struct Slot
+    {
+        uint64_t key = 0;
+        uint64_t lastUsedFrame = 0;
+        bool pinned = false;
+        uint32_t prev = kNull; ///< Previous slot in the LRU list (towards least recently used).
+        uint32_t next = kNull; ///< Next slot in the LRU list (towards most recently used).
+    };
+
+    void unlink(uint32_t slot);
+    void pushBack(uint32_t slot);
+    void release(uint32_t slot);
+
+    std::vector<Slot> mSlots;
+    std::vector<uint32_t> mFreeSlots;
+    std::unordered_map<uint64_t, uint32_t> mKeyToSlot;
+    uint32_t mHead = kNull; ///< Least recently used unpinned slot.
+    uint32_t mTail = kNull; ///< Most recently used unpinned slot.
+    Stats mStats;
+};
+
+/**
+ * Scheduler for virtual texture tile requests.
+ *
+ * Requests are de-duplicated and handed out in priority order. Among requests with the same priority,
+ * the most recently requested tiles come first. Requests that have not been renewed for a number of
+ * frames are dropped, as the tiles are likely no longer visible.
+ */
+class FALCOR_API VirtualTextureTileScheduler
+{
+public:
+    struct Request
+    {
+        VirtualTileKey key;
+        float priority = 0.f;
+        uint64_t frame = 0;
+    };
+
+    /**
+     * Constructor.
+     * @param[in] maxRequestAge Number of frames after which requests that have not been renewed are dropped.
+     */
+    explicit VirtualTextureTileScheduler(uint32_t maxRequestAge = 8) : mMaxRequestAge(maxRequestAge) {}
+
+    /**
+     * Add or renew a tile request. The priority of an existing request is raised if the new priority is higher.
+     * @param[in] key Tile key.
+     * @param[in] frame Current frame.
+     * @param[in] priority Request priority, higher is more important.
+     */
+    void request(const VirtualTileKey& key, uint64_t frame, float priority);
+
+    /**
+     * Remove up to the given number of requests in priority order. Expired requests are dropped first.
+     * @param[in] maxCount Max number of requests to return.
+     * @param[in] frame Current frame.
+     * @return List of tile keys, highest priority first.
+     */
+    std::vector<VirtualTileKey> pop(uint32_t maxCount, uint64_t frame);
+
+    /**
+     * Cancel all requests for a texture.
+     */
+    void cancelTexture(uint32_t textureID);
+
+    /**
+     * Get the number of pending requests.
+     */
+    size_t getPendingCount() const { return mRequests.size(); }
+
+    void clear() { mRequests.clear(); }
+
+private:
+    uint32_t mMaxRequestAge;
+    std::unordered_map<uint64_t, Request> mRequests;
+};
+} // namespace Falcor
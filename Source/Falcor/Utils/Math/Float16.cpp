@@ -34,6 +34,13 @@
 
 #include "Float16.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_FLOAT16_SSE2 1
+#include <emmintrin.h>
+#else
+#define FALCOR_FLOAT16_SSE2 0
+#endif
+
 namespace Falcor
 {
 namespace math
@@ -261,5 +268,94 @@ float float16ToFloat32(uint16_t value)
     return result.f;
 }
 
+void float32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+
+#if FALCOR_FLOAT16_SSE2
+    // Normalized results, zeros, overflow and infinities are handled with SIMD. Groups containing
+    // denormalized results or NaNs fall back to the scalar code to reproduce its rounding exactly.
+    const __m128i absMask = _mm_set1_epi32(0x7fffffff);
+    const __m128i signMask = _mm_set1_epi32(0x8000);
+    const __m128i zeroMax = _mm_set1_epi32(0x33000000);      // Magnitudes below this convert to zero.
+    const __m128i normalMin = _mm_set1_epi32(0x38800000);    // Smallest magnitude converting to a normalized half.
+    const __m128i overflowMax = _mm_set1_epi32(0x477fffff);  // Magnitudes above this convert to infinity.
+    const __m128i infinityBits = _mm_set1_epi32(0x7f800000);
+    const __m128i halfInfinity = _mm_set1_epi32(0x7c00);
+    const __m128i bias = _mm_set1_epi32(0x1000 - ((127 - 15) << 23)); // Adjust the exponent and round "0.5" up.
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m128i absBits = _mm_and_si128(bits, absMask);
+
+        __m128i isZero = _mm_cmplt_epi32(absBits, zeroMax);
+        __m128i isDenormal = _mm_andnot_si128(isZero, _mm_cmplt_epi32(absBits, normalMin));
+        __m128i isNaN = _mm_cmpgt_epi32(absBits, infinityBits);
+        if (_mm_movemask_epi8(_mm_or_si128(isDenormal, isNaN)) != 0)
+        {
+            for (size_t j = i; j < i + 4; j++)
+                pDst[j] = float32ToFloat16(pSrc[j]);
+            continue;
+        }
+
+        __m128i isOverflow = _mm_cmpgt_epi32(absBits, overflowMax);
+        __m128i result = _mm_srli_epi32(_mm_add_epi32(absBits, bias), 13);
+        result = _mm_andnot_si128(isZero, result);
+        result = _mm_or_si128(_mm_andnot_si128(isOverflow, result), _mm_and_si128(isOverflow, halfInfinity));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi32(bits, 16), signMask));
+
+        // Gather the low 16 bits of each lane.
+        result = _mm_shufflelo_epi16(result, _MM_SHUFFLE(3, 3, 2, 0));
+        result = _mm_shufflehi_epi16(result, _MM_SHUFFLE(3, 3, 2, 0));
+        result = _mm_shuffle_epi32(result, _MM_SHUFFLE(3, 3, 2, 0));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + i), result);
+    }
+#endif
+
+    for (; i < count; i++)
+        pDst[i] = float32ToFloat16(pSrc[i]);
+}
+
+void float16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+
+#if FALCOR_FLOAT16_SSE2
+    // Groups containing denormalized values fall back to the scalar code.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i magnitudeMask = _mm_set1_epi32(0x7fff);
+    const __m128i exponentMask = _mm_set1_epi32(0x7c00);
+    const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + i)), zero);
+        __m128i magnitude = _mm_and_si128(value, magnitudeMask);
+        __m128i exponent = _mm_and_si128(value, exponentMask);
+
+        __m128i isZero = _mm_cmpeq_epi32(magnitude, zero);
+        __m128i isDenormal = _mm_andnot_si128(isZero, _mm_cmpeq_epi32(exponent, zero));
+        if (_mm_movemask_epi8(isDenormal) != 0)
+        {
+            for (size_t j = i; j < i + 4; j++)
+                pDst[j] = float16ToFloat32(pSrc[j]);
+            continue;
+        }
+
+        // Infinities and NaNs need the exponent rebiased a second time to reach the max exponent.
+        __m128i isSpecial = _mm_cmpeq_epi32(exponent, exponentMask);
+        __m128i result = _mm_add_epi32(_mm_slli_epi32(magnitude, 13), rebias);
+        result = _mm_add_epi32(result, _mm_and_si128(isSpecial, rebias));
+        result = _mm_andnot_si128(isZero, result);
+        result = _mm_or_si128(result, _mm_slli_epi32(_mm_andnot_si128(magnitudeMask, value), 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), result);
+    }
+#endif
+
+    for (; i < count; i++)
+        pDst[i] = float16ToFloat32(pSrc[i]);
+}
+
 } // namespace math
 } // namespace Falcor
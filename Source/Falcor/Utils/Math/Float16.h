@@ -29,6 +29,7 @@
 
 #include "Core/Macros.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
@@ -40,6 +41,18 @@ namespace math
 FALCOR_API uint16_t float32ToFloat16(float value);
 FALCOR_API float float16ToFloat32(uint16_t value);
 
+/**
+ * Convert an array of floats to half floats.
+ * Uses SIMD instructions where available. The results are identical to float32ToFloat16().
+ */
+FALCOR_API void float32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count);
+
+/**
+ * Convert an array of half floats to floats.
+ * Uses SIMD instructions where available. The results are identical to float16ToFloat32().
+ */
+FALCOR_API void float16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+
 struct float16_t
 {
     float16_t() = default;
@@ -0,0 +1,523 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Metrics.h"
+#include "Core/Error.h"
+#include "Utils/StringFormatters.h"
+#include "Utils/Scripting/ScriptBindings.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const char* getTypeName(MetricsRegistry::Type type)
+{
+    switch (type)
+    {
+    case MetricsRegistry::Type::Counter:
+        return "counter";
+    case MetricsRegistry::Type::Gauge:
+        return "gauge";
+    case MetricsRegistry::Type::Histogram:
+        return "histogram";
+    }
+    return "";
+}
+
+void atomicAdd(std::atomic<double>& value, double delta)
+{
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed))
+        ;
+}
+
+const double kPercentiles[] = {0.5, 0.95, 0.99};
+const char* kHistogramColumns[] = {"count", "mean", "p50", "p95", "p99"};
+} // namespace
+
+std::atomic<bool> MetricsRegistry::sEnabled{true};
+
+size_t detail::getMetricShardIndex()
+{
+    static std::atomic<size_t> sNextShard{0};
+    thread_local size_t shard = sNextShard.fetch_add(1, std::memory_order_relaxed) % kMetricShardCount;
+    return shard;
+}
+
+//
+// MetricCounter
+//
+
+uint64_t MetricCounter::get() const
+{
+    uint64_t value = 0;
+    for (const auto& shard : mShards)
+        value += shard.value.load(std::memory_order_relaxed);
+    return value;
+}
+
+void MetricCounter::reset()
+{
+    for (auto& shard : mShards)
+        shard.value.store(0, std::memory_order_relaxed);
+}
+
+//
+// MetricGauge
+//
+
+void MetricGauge::add(double delta)
+{
+    atomicAdd(mValue, delta);
+}
+
+//
+// MetricHistogram
+//
+
+double MetricHistogram::Snapshot::getPercentile(double percentile) const
+{
+    if (count == 0 || bounds.empty())
+        return 0.0;
+
+    const double rank = std::clamp(percentile, 0.0, 1.0) * count;
+    double accumulated = 0.0;
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        if (counts[i] > 0 && accumulated + counts[i] >= rank)
+        {
+            const double lower = i > 0 ? bounds[i - 1] : std::min(0.0, bounds[0]);
+            return lower + (bounds[i] - lower) * (rank - accumulated) / counts[i];
+        }
+        accumulated += counts[i];
+    }
+    return bounds.back();
+}
+
+MetricHistogram::Snapshot MetricHistogram::Snapshot::getDelta(const Snapshot& previous) const
+{
+    Snapshot delta = *this;
+    if (previous.counts.size() != counts.size())
+        return delta;
+    for (size_t i = 0; i < counts.size(); i++)
+        delta.counts[i] -= std::min(counts[i], previous.counts[i]);
+    delta.count -= std::min(count, previous.count);
+    delta.sum -= previous.sum;
+    return delta;
+}
+
+MetricHistogram::MetricHistogram(std::vector<double> bounds) : mBounds(std::move(bounds))
+{
+    FALCOR_CHECK(!mBounds.empty(), "Histogram needs at least one bucket bound.");
+    FALCOR_CHECK(std::is_sorted(mBounds.begin(), mBounds.end()), "Histogram bucket bounds must be increasing.");
+
+    const size_t countsPerCacheLine = 64 / sizeof(std::atomic<uint64_t>);
+    mStride = (mBounds.size() + 1 + countsPerCacheLine - 1) / countsPerCacheLine * countsPerCacheLine;
+    mCounts.reset(new std::atomic<uint64_t>[mStride * detail::kMetricShardCount]);
+    reset();
+}
+
+std::vector<double> MetricHistogram::getDefaultLatencyBounds()
+{
+    std::vector<double> bounds;
+    for (int i = 0; i <= 24; i++)
+        bounds.push_back(1e-3 * std::ldexp(1.0, i));
+    return bounds;
+}
+
+void MetricHistogram::record(double value)
+{
+    const size_t bucket = std::lower_bound(mBounds.begin(), mBounds.end(), value) - mBounds.begin();
+    const size_t shard = detail::getMetricShardIndex();
+    mCounts[shard * mStride + bucket].fetch_add(1, std::memory_order_relaxed);
+    atomicAdd(mSums[shard].sum, value);
+}
+
+MetricHistogram::Snapshot MetricHistogram::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.bounds = mBounds;
+    snapshot.counts.resize(mBounds.size() + 1, 0);
+    for (size_t shard = 0; shard < detail::kMetricShardCount; shard++)
+    {
+        for (size_t i = 0; i < snapshot.counts.size(); i++)
+            snapshot.counts[i] += mCounts[shard * mStride + i].load(std::memory_order_relaxed);
+        snapshot.sum += mSums[shard].sum.load(std::memory_order_relaxed);
+    }
+    for (uint64_t count : snapshot.counts)
+        snapshot.count += count;
+    return snapshot;
+}
+
+void MetricHistogram::reset()
+{
+    for (size_t i = 0; i < mStride * detail::kMetricShardCount; i++)
+        mCounts[i].store(0, std::memory_order_relaxed);
+    for (auto& shard : mSums)
+        shard.sum.store(0.0, std::memory_order_relaxed);
+}
+
+//
+// MetricsRegistry
+//
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricCounter& MetricsRegistry::getCounter(std::string_view name, std::string_view description)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Metric& metric = getOrCreate(name, description, Type::Counter);
+    if (!metric.pCounter)
+        metric.pCounter = std::make_unique<MetricCounter>();
+    return *metric.pCounter;
+}
+
+MetricGauge& MetricsRegistry::getGauge(std::string_view name, std::string_view description)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Metric& metric = getOrCreate(name, description, Type::Gauge);
+    if (!metric.pGauge)
+        metric.pGauge = std::make_unique<MetricGauge>();
+    return *metric.pGauge;
+}
+
+MetricHistogram& MetricsRegistry::getHistogram(std::string_view name, std::string_view description, std::vector<double> bounds)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Metric& metric = getOrCreate(name, description, Type::Histogram);
+    if (!metric.pHistogram)
+    {
+        metric.pHistogram =
+            std::make_unique<MetricHistogram>(bounds.empty() ? MetricHistogram::getDefaultLatencyBounds() : std::move(bounds));
+    }
+    return *metric.pHistogram;
+}
+
+std::vector<MetricsRegistry::MetricInfo> MetricsRegistry::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<MetricInfo> metrics;
+    for (const auto& pMetric : mMetrics)
+        metrics.push_back(pMetric->info);
+    return metrics;
+}
+
+std::vector<std::string> MetricsRegistry::getColumnNames() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<std::string> columns;
+    for (const auto& pMetric : mMetrics)
+    {
+        if (pMetric->info.type == Type::Histogram)
+        {
+            for (const char* column : kHistogramColumns)
+                columns.push_back(pMetric->info.name + "." + column);
+        }
+        else
+        {
+            columns.push_back(pMetric->info.name);
+        }
+    }
+    return columns;
+}
+
+void MetricsRegistry::sampleFrame(uint64_t frame)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    FrameSample sample;
+    sample.frame = frame;
+    for (const auto& pMetric : mMetrics)
+    {
+        Metric& metric = *pMetric;
+        switch (metric.info.type)
+        {
+        case Type::Counter:
+        {
+            const uint64_t count = metric.pCounter->get();
+            sample.values.push_back(double(count - std::min(count, metric.lastCount)));
+            metric.lastCount = count;
+            break;
+        }
+        case Type::Gauge:
+            sample.values.push_back(metric.pGauge->get());
+            break;
+        case Type::Histogram:
+        {
+            auto snapshot = metric.pHistogram->getSnapshot();
+            const auto delta = snapshot.getDelta(metric.lastSnapshot);
+            sample.values.push_back(double(delta.count));
+            sample.values.push_back(delta.getMean());
+            for (double percentile : kPercentiles)
+                sample.values.push_back(delta.getPercentile(percentile));
+            metric.lastSnapshot = std::move(snapshot);
+            break;
+        }
+        }
+    }
+
+    mSamples.push_back(std::move(sample));
+    while (mSamples.size() > mMaxSampleCount)
+        mSamples.pop_front();
+}
+
+std::vector<MetricsRegistry::FrameSample> MetricsRegistry::getSamples() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return std::vector<FrameSample>(mSamples.begin(), mSamples.end());
+}
+
+MetricsRegistry::FrameSample MetricsRegistry::getLastSample() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSamples.empty() ? FrameSample() : mSamples.back();
+}
+
+void MetricsRegistry::setMaxSampleCount(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxSampleCount = count;
+    while (mSamples.size() > mMaxSampleCount)
+        mSamples.pop_front();
+}
+
+size_t MetricsRegistry::getMaxSampleCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxSampleCount;
+}
+
+void MetricsRegistry::reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& pMetric : mMetrics)
+    {
+        if (pMetric->pCounter)
+            pMetric->pCounter->reset();
+        if (pMetric->pGauge)
+            pMetric->pGauge->set(0.0);
+        if (pMetric->pHistogram)
+            pMetric->pHistogram->reset();
+        pMetric->lastCount = 0;
+        pMetric->lastSnapshot = {};
+    }
+    mSamples.clear();
+}
+
+void MetricsRegistry::writeCSV(const std::filesystem::path& path, const std::vector<FrameSample>& samples) const
+{
+    const auto columns = getColumnNames();
+
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs)
+        FALCOR_THROW("Failed to open metrics file '{}' for writing.", path);
+
+    ofs << "frame";
+    for (const auto& column : columns)
+        ofs << "," << column;
+    ofs << "\n";
+
+    for (const auto& sample : samples)
+    {
+        ofs << sample.frame;
+        // Metrics created after the sample was taken have no values.
+        for (size_t i = 0; i < columns.size(); i++)
+            ofs << "," << (i < sample.values.size() ? fmt::format("{}", sample.values[i]) : "");
+        ofs << "\n";
+    }
+
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write metrics file '{}'.", path);
+}
+
+void MetricsRegistry::writeJSON(const std::filesystem::path& path, const std::vector<FrameSample>& samples) const
+{
+    nlohmann::json metrics = nlohmann::json::object();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& pMetric : mMetrics)
+        {
+            nlohmann::json j = {
+                {"type", getTypeName(pMetric->info.type)},
+                {"description", pMetric->info.description},
+            };
+            if (pMetric->pCounter)
+                j["value"] = pMetric->pCounter->get();
+            if (pMetric->pGauge)
+                j["value"] = pMetric->pGauge->get();
+            if (pMetric->pHistogram)
+            {
+                const auto snapshot = pMetric->pHistogram->getSnapshot();
+                j["count"] = snapshot.count;
+                j["sum"] = snapshot.sum;
+                j["bounds"] = snapshot.bounds;
+                j["counts"] = snapshot.counts;
+            }
+            metrics[pMetric->info.name] = std::move(j);
+        }
+    }
+
+    const auto columns = getColumnNames();
+    nlohmann::json frames = nlohmann::json::array();
+    for (const auto& sample : samples)
+    {
+        nlohmann::json values = nlohmann::json::object();
+        for (size_t i = 0; i < std::min(columns.size(), sample.values.size()); i++)
+            values[columns[i]] = sample.values[i];
+        frames.push_back({{"frame", sample.frame}, {"values", std::move(values)}});
+    }
+
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs)
+        FALCOR_THROW("Failed to open metrics file '{}' for writing.", path);
+    ofs << nlohmann::json({{"metrics", metrics}, {"frames", frames}}).dump(4) << std::endl;
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write metrics file '{}'.", path);
+}
+
+MetricsRegistry::Metric& MetricsRegistry::getOrCreate(std::string_view name, std::string_view description, Type type)
+{
+    if (auto it = mMetricsByName.find(name); it != mMetricsByName.end())
+    {
+        Metric& metric = *it->second;
+        if (metric.info.type != type)
+            FALCOR_THROW("Metric '{}' is a {}, not a {}.", name, getTypeName(metric.info.type), getTypeName(type));
+        if (metric.info.description.empty())
+            metric.info.description = description;
+        return metric;
+    }
+
+    auto pMetric = std::make_unique<Metric>();
+    pMetric->info = {std::string(name), std::string(description), type};
+    Metric& metric = *pMetric;
+    mMetricsByName.emplace(metric.info.name, &metric);
+    mMetrics.push_back(std::move(pMetric));
+    return metric;
+}
+
+FALCOR_SCRIPT_BINDING(Metrics)
+{
+    using namespace pybind11::literals;
+
+    pybind11::class_<MetricsRegistry> metrics(m, "Metrics");
+    metrics.def_property_readonly_static(
+        "instance", [](pybind11::object) { return &MetricsRegistry::instance(); }, pybind11::return_value_policy::reference
+    );
+    metrics.def_property_static(
+        "enabled",
+        [](pybind11::object) { return MetricsRegistry::isEnabled(); },
+        [](pybind11::object, bool enabled) { MetricsRegistry::setEnabled(enabled); }
+    );
+    metrics.def_property("max_sample_count", &MetricsRegistry::getMaxSampleCount, &MetricsRegistry::setMaxSampleCount);
+    metrics.def_property_readonly("column_names", &MetricsRegistry::getColumnNames);
+
+    metrics.def(
+        "add",
+        [](MetricsRegistry& self, const std::string& name, uint64_t value) { self.getCounter(name).add(value); },
+        "name"_a,
+        "value"_a = 1
+    );
+    metrics.def(
+        "set", [](MetricsRegistry& self, const std::string& name, double value) { self.getGauge(name).set(value); }, "name"_a, "value"_a
+    );
+    metrics.def(
+        "record",
+        [](MetricsRegistry& self, const std::string& name, double value) { self.getHistogram(name).record(value); },
+        "name"_a,
+        "value"_a
+    );
+
+    // Current values as a dict. Counters and gauges map to their value, histograms to a dict of statistics.
+    metrics.def(
+        "get_values",
+        [](MetricsRegistry& self)
+        {
+            pybind11::dict d;
+            for (const auto& info : self.getMetrics())
+            {
+                switch (info.type)
+                {
+                case MetricsRegistry::Type::Counter:
+                    d[info.name.c_str()] = self.getCounter(info.name).get();
+                    break;
+                case MetricsRegistry::Type::Gauge:
+                    d[info.name.c_str()] = self.getGauge(info.name).get();
+                    break;
+                case MetricsRegistry::Type::Histogram:
+                {
+                    const auto snapshot = self.getHistogram(info.name).getSnapshot();
+                    pybind11::dict h;
+                    h["count"] = snapshot.count;
+                    h["mean"] = snapshot.getMean();
+                    h["p50"] = snapshot.getPercentile(0.5);
+                    h["p95"] = snapshot.getPercentile(0.95);
+                    h["p99"] = snapshot.getPercentile(0.99);
+                    d[info.name.c_str()] = h;
+                    break;
+                }
+                }
+            }
+            return d;
+        }
+    );
+
+    // Frame samples as a list of dicts mapping column names to values.
+    metrics.def(
+        "get_samples",
+        [](MetricsRegistry& self)
+        {
+            const auto columns = self.getColumnNames();
+            pybind11::list samples;
+            for (const auto& sample : self.getSamples())
+            {
+                pybind11::dict d;
+                d["frame"] = sample.frame;
+                for (size_t i = 0; i < std::min(columns.size(), sample.values.size()); i++)
+                    d[columns[i].c_str()] = sample.values[i];
+                samples.append(d);
+            }
+            return samples;
+        }
+    );
+
+    metrics.def("reset", &MetricsRegistry::reset);
+    metrics.def(
+        "write_csv", [](MetricsRegistry& self, const std::filesystem::path& path) { self.writeCSV(path, self.getSamples()); }, "path"_a
+    );
+    metrics.def(
+        "write_json", [](MetricsRegistry& self, const std::filesystem::path& path) { self.writeJSON(path, self.getSamples()); }, "path"_a
+    );
+}
+} // namespace Falcor
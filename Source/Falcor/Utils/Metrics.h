@@ -0,0 +1,332 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+namespace detail
+{
+/// Number of shards of the metric values. Threads are assigned to shards round-robin.
+static constexpr size_t kMetricShardCount = 16;
+/// Get the shard index of the calling thread.
+FALCOR_API size_t getMetricShardIndex();
+} // namespace detail
+
+/**
+ * Monotonically increasing counter.
+ * Increments are relaxed atomic adds to a per-thread shard, so the counter can be used on hot paths from many threads.
+ * Reading the value sums all shards.
+ */
+class FALCOR_API MetricCounter
+{
+public:
+    void add(uint64_t value = 1) { mShards[detail::getMetricShardIndex()].value.fetch_add(value, std::memory_order_relaxed); }
+
+    uint64_t get() const;
+
+    /// Reset the counter to zero. Not synchronized with concurrent add() calls.
+    void reset();
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, detail::kMetricShardCount> mShards;
+};
+
+/**
+ * Value that is set to the current state of something, e.g. the number of resident textures.
+ */
+class FALCOR_API MetricGauge
+{
+public:
+    void set(double value) { mValue.store(value, std::memory_order_relaxed); }
+    void add(double delta);
+    double get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> mValue{0.0};
+};
+
+/**
+ * Histogram with fixed buckets.
+ * Each bucket counts the values less than or equal to its upper bound and greater than the previous bound.
+ * An additional overflow bucket counts the values above the last bound. Like counters, the counts are sharded per thread.
+ */
+class FALCOR_API MetricHistogram
+{
+public:
+    struct Snapshot
+    {
+        std::vector<double> bounds;   ///< Bucket upper bounds.
+        std::vector<uint64_t> counts; ///< Count per bucket, including the overflow bucket.
+        uint64_t count = 0;           ///< Total number of recorded values.
+        double sum = 0.0;             ///< Sum of recorded values.
+
+        double getMean() const { return count > 0 ? sum / count : 0.0; }
+
+        /**
+         * Estimate a percentile by linear interpolation within the bucket containing it.
+         * Values in the overflow bucket are reported as the last bound.
+         * @param[in] percentile Percentile in [0, 1].
+         */
+        double getPercentile(double percentile) const;
+
+        /// Get the values recorded since a previous snapshot of the same histogram.
+        Snapshot getDelta(const Snapshot& previous) const;
+    };
+
+    /**
+     * Constructor.
+     * @param[in] bounds Bucket upper bounds in increasing order.
+     */
+    explicit MetricHistogram(std::vector<double> bounds);
+
+    /**
+     * Get the default bounds for latencies in milliseconds, from 1 us to about 16 s in powers of two.
+     */
+    static std::vector<double> getDefaultLatencyBounds();
+
+    void record(double value);
+
+    Snapshot getSnapshot() const;
+
+    /// Reset all counts to zero. Not synchronized with concurrent record() calls.
+    void reset();
+
+    const std::vector<double>& getBounds() const { return mBounds; }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<double> sum{0.0};
+    };
+
+    std::vector<double> mBounds;
+    size_t mStride; ///< Number of counts per shard, padded to full cache lines.
+    std::unique_ptr<std::atomic<uint64_t>[]> mCounts;
+    std::array<Shard, detail::kMetricShardCount> mSums;
+};
+
+/**
+ * Global registry of named metrics.
+ *
+ * Metrics are created on first use and live until the end of the process, so references returned by the getters can
+ * be cached, which is what the FALCOR_METRIC_* macros do. Metric names use dot-separated lower case words, e.g.
+ * "buffer.upload_bytes".
+ *
+ * The registry is sampled once per frame by the application. Each sample holds the counter increments and histogram
+ * statistics of that frame and the current gauge values. The most recent samples are kept in memory and can be written
+ * to CSV or JSON files.
+ */
+class FALCOR_API MetricsRegistry
+{
+public:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram,
+    };
+
+    struct MetricInfo
+    {
+        std::string name;
+        std::string description;
+        Type type;
+    };
+
+    struct FrameSample
+    {
+        uint64_t frame = 0;
+        std::vector<double> values; ///< Values in column order, see getColumnNames(). May be shorter than the column list.
+    };
+
+    static MetricsRegistry& instance();
+
+    /// Check if the instrumentation macros record values. Enabled by default.
+    static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled) { sEnabled.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * Get a counter, creating it if it does not exist.
+     * Throws if a metric of a different type exists with the same name.
+     */
+    MetricCounter& getCounter(std::string_view name, std::string_view description = {});
+
+    /**
+     * Get a gauge, creating it if it does not exist.
+     * Throws if a metric of a different type exists with the same name.
+     */
+    MetricGauge& getGauge(std::string_view name, std::string_view description = {});
+
+    /**
+     * Get a histogram, creating it if it does not exist.
+     * Throws if a metric of a different type exists with the same name.
+     * @param[in] bounds Bucket upper bounds, used when the histogram is created. Empty to use the default latency bounds.
+     */
+    MetricHistogram& getHistogram(std::string_view name, std::string_view description = {}, std::vector<double> bounds = {});
+
+    /// Get all metrics in creation order.
+    std::vector<MetricInfo> getMetrics() const;
+
+    /**
+     * Get the column names of the frame samples.
+     * Counters and gauges have one column named after the metric. Histograms have the columns "<name>.count",
+     * "<name>.mean", "<name>.p50", "<name>.p95" and "<name>.p99".
+     */
+    std::vector<std::string> getColumnNames() const;
+
+    /**
+     * Take a sample of all metrics. Called once per frame.
+     * @param[in] frame Frame index.
+     */
+    void sampleFrame(uint64_t frame);
+
+    /// Get the most recent frame samples, oldest first.
+    std::vector<FrameSample> getSamples() const;
+
+    /// Get the most recent frame sample, or an empty sample if none was taken.
+    FrameSample getLastSample() const;
+
+    /// Set the max number of frame samples kept in memory.
+    void setMaxSampleCount(size_t count);
+    size_t getMaxSampleCount() const;
+
+    /// Reset all metrics to zero and clear the frame samples.
+    void reset();
+
+    /// Write frame samples to a CSV file with a header row. Throws on error.
+    void writeCSV(const std::filesystem::path& path, const std::vector<FrameSample>& samples) const;
+
+    /// Write the metric totals and frame samples to a JSON file. Throws on error.
+    void writeJSON(const std::filesystem::path& path, const std::vector<FrameSample>& samples) const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct Metric
+    {
+        MetricInfo info;
+        std::unique_ptr<MetricCounter> pCounter;
+        std::unique_ptr<MetricGauge> pGauge;
+        std::unique_ptr<MetricHistogram> pHistogram;
+        uint64_t lastCount = 0;                 ///< Counter value at the last sample.
+        MetricHistogram::Snapshot lastSnapshot; ///< Histogram snapshot at the last sample.
+    };
+
+    Metric& getOrCreate(std::string_view name, std::string_view description, Type type);
+
+    static std::atomic<bool> sEnabled;
+
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<Metric>> mMetrics;
+    std::map<std::string, Metric*, std::less<>> mMetricsByName;
+    std::deque<FrameSample> mSamples;
+    size_t mMaxSampleCount = 1000;
+};
+
+/**
+ * Records the lifetime of the object in milliseconds into a histogram.
+ * Use the FALCOR_METRIC_SCOPED_TIMER macro instead of creating this object directly.
+ */
+class ScopedMetricTimer
+{
+public:
+    ScopedMetricTimer(MetricHistogram& histogram) : mHistogram(histogram), mStartTime(CpuTimer::getCurrentTimePoint()) {}
+    ~ScopedMetricTimer()
+    {
+        if (MetricsRegistry::isEnabled())
+            mHistogram.record(CpuTimer::calcDuration(mStartTime, CpuTimer::getCurrentTimePoint()));
+    }
+
+private:
+    MetricHistogram& mHistogram;
+    CpuTimer::TimePoint mStartTime;
+};
+} // namespace Falcor
+
+/**
+ * Instrumentation macros. The metric is looked up once per call site, afterwards the cost is a relaxed atomic add.
+ * The macros compile to nothing if FALCOR_ENABLE_METRICS is not set.
+ */
+#if FALCOR_ENABLE_METRICS
+#define FALCOR_METRIC_COUNT(_name, _value)                                                                        \
+    do                                                                                                            \
+    {                                                                                                             \
+        static ::Falcor::MetricCounter& _metricCounter = ::Falcor::MetricsRegistry::instance().getCounter(_name); \
+        if (::Falcor::MetricsRegistry::isEnabled())                                                               \
+            _metricCounter.add(_value);                                                                           \
+    } while (0)
+#define FALCOR_METRIC_GAUGE(_name, _value)                                                                  \
+    do                                                                                                      \
+    {                                                                                                       \
+        static ::Falcor::MetricGauge& _metricGauge = ::Falcor::MetricsRegistry::instance().getGauge(_name); \
+        if (::Falcor::MetricsRegistry::isEnabled())                                                         \
+            _metricGauge.set(_value);                                                                       \
+    } while (0)
+#define FALCOR_METRIC_RECORD(_name, _value)                                                                             \
+    do                                                                                                                  \
+    {                                                                                                                   \
+        static ::Falcor::MetricHistogram& _metricHistogram = ::Falcor::MetricsRegistry::instance().getHistogram(_name); \
+        if (::Falcor::MetricsRegistry::isEnabled())                                                                     \
+            _metricHistogram.record(_value);                                                                            \
+    } while (0)
+#define FALCOR_METRIC_SCOPED_TIMER(_name)                                                 \
+    static ::Falcor::MetricHistogram& FALCOR_CONCAT_STRINGS(_metricHistogram, __LINE__) = \
+        ::Falcor::MetricsRegistry::instance().getHistogram(_name);                        \
+    ::Falcor::ScopedMetricTimer FALCOR_CONCAT_STRINGS(_metricTimer, __LINE__)(FALCOR_CONCAT_STRINGS(_metricHistogram, __LINE__))
+#else
+#define FALCOR_METRIC_COUNT(_name, _value) \
+    do                                     \
+    {                                      \
+    } while (0)
+#define FALCOR_METRIC_GAUGE(_name, _value) \
+    do                                     \
+    {                                      \
+    } while (0)
+#define FALCOR_METRIC_RECORD(_name, _value) \
+    do                                      \
+    {                                       \
+    } while (0)
+#define FALCOR_METRIC_SCOPED_TIMER(_name)
+#endif
@@ -26,34 +26,67 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TaskManager.h"
+#include "Threading.h"
 
 namespace Falcor
 {
 
-TaskManager::TaskManager(bool startPaused)
+bool TaskManager::CpuTaskQueue::pop(CpuTask& task)
 {
-    if (startPaused)
-        mThreadPool.pause();
+    std::lock_guard<std::mutex> l(mutex);
+    if (tasks.empty())
+        return false;
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
 }
 
+TaskManager::TaskManager(bool startPaused) : mPaused(startPaused), mpCpuTasks(std::make_shared<CpuTaskQueue>()) {}
+
 void TaskManager::addTask(CpuTask&& task)
 {
-    std::lock_guard<std::mutex> l(mTaskMutex);
-    ++mCurrentlyScheduled;
-    mThreadPool.push_task(
-        [task = std::move(task), this]() mutable
+    {
+        std::lock_guard<std::mutex> l(mTaskMutex);
+        ++mCurrentlyScheduled;
+        if (mPaused)
         {
-            ++mCurrentlyRunning;
-            --mCurrentlyScheduled;
-            executeCpuTask(std::move(task));
-            size_t running = --mCurrentlyRunning;
-            // If nothing is running, lets wake up and try to exit.
-            if (running == 0)
-                mGpuTaskCond.notify_all();
+            mPausedCpuTasks.push_back(std::move(task));
+            return;
+        }
+    }
+    // Dispatch outside the lock, the scheduler runs tasks inline when it is not started.
+    dispatchCpuTask(std::move(task));
+}
+
+void TaskManager::dispatchCpuTask(CpuTask&& task)
+{
+    {
+        std::lock_guard<std::mutex> l(mpCpuTasks->mutex);
+        mpCpuTasks->tasks.push_back(std::move(task));
+    }
+    // Each scheduler task runs the next queued task, if finish() hasn't run it already.
+    // The queue is shared, as the manager may be gone by the time the scheduler task runs and finds the queue empty.
+    Threading::dispatchTask(
+        [pCpuTasks = mpCpuTasks, this]()
+        {
+            CpuTask task;
+            if (pCpuTasks->pop(task))
+                runCpuTask(std::move(task));
         }
     );
 }
 
+void TaskManager::runCpuTask(CpuTask&& task)
+{
+    ++mCurrentlyRunning;
+    --mCurrentlyScheduled;
+    executeCpuTask(std::move(task));
+    std::lock_guard<std::mutex> l(mTaskMutex);
+    // If nothing is running, lets wake up and try to exit.
+    if (--mCurrentlyRunning == 0)
+        mGpuTaskCond.notify_all();
+}
+
 void TaskManager::addTask(GpuTask&& task)
 {
     std::lock_guard<std::mutex> l(mTaskMutex);
@@ -64,7 +97,15 @@ void TaskManager::addTask(GpuTask&& task)
 
 void TaskManager::finish(RenderContext* renderContext)
 {
-    mThreadPool.unpause();
+    std::vector<CpuTask> pausedTasks;
+    {
+        std::lock_guard<std::mutex> l(mTaskMutex);
+        mPaused = false;
+        pausedTasks.swap(mPausedCpuTasks);
+    }
+    for (auto& task : pausedTasks)
+        dispatchCpuTask(std::move(task));
+
     while (true)
     {
         while (true)
@@ -81,6 +122,14 @@ void TaskManager::finish(RenderContext* renderContext)
             --mCurrentlyRunning;
         }
 
+        // Help executing pending CPU tasks instead of blocking.
+        // Only tasks of this manager are run here, unrelated tasks on the scheduler may take arbitrarily long.
+        if (CpuTask task; mpCpuTasks->pop(task))
+        {
+            runCpuTask(std::move(task));
+            continue;
+        }
+
         std::unique_lock<std::mutex> l(mTaskMutex);
         while (true)
         {
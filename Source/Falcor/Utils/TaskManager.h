@@ -29,11 +29,11 @@
 
 #include "Core/Macros.h"
 
-#include <BS_thread_pool.hpp>
-
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <atomic>
 #include <exception>
@@ -41,6 +41,11 @@
 namespace Falcor
 {
 class RenderContext;
+
+/**
+ * Runs a set of CPU and GPU tasks to completion.
+ * CPU tasks are executed on the global scheduler (see Threading), GPU tasks are executed sequentially on the thread calling finish().
+ */
 class FALCOR_API TaskManager
 {
 public:
@@ -67,9 +72,24 @@ private:
     void rethrowException();
     /// CPU task execution wrapped so it stores exception if the task throws
     void executeCpuTask(CpuTask&& task);
+    /// Dispatch a CPU task to the scheduler.
+    void dispatchCpuTask(CpuTask&& task);
+    /// Run a CPU task taken from the queue on the calling thread.
+    void runCpuTask(CpuTask&& task);
+
+    /// Queue of dispatched CPU tasks that haven't started yet.
+    struct CpuTaskQueue
+    {
+        std::mutex mutex;
+        std::deque<CpuTask> tasks;
+
+        bool pop(CpuTask& task);
+    };
 
 private:
-    BS::thread_pool mThreadPool;
+    bool mPaused = false;
+    std::vector<CpuTask> mPausedCpuTasks; ///< CPU tasks added while paused, dispatched in finish().
+    std::shared_ptr<CpuTaskQueue> mpCpuTasks; ///< CPU tasks dispatched to the scheduler. Shared with the scheduler tasks.
     std::atomic_size_t mCurrentlyRunning{0};
     std::atomic_size_t mCurrentlyScheduled{0};
 
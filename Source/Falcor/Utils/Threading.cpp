@@ -27,17 +27,257 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Error.h"
+#include <atomic>
+#include <deque>
+#include <exception>
 
 namespace Falcor
 {
+struct Threading::TaskState
+{
+    std::function<void(void)> func;
+    Priority priority = Priority::Normal;
+    std::atomic<uint32_t> pendingDependencies{0};
+    std::atomic<bool> done{false};
+    std::exception_ptr exception;
+
+    std::mutex mutex; ///< Protects the continuation list and the transition to done.
+    std::vector<std::shared_ptr<TaskState>> continuations;
+};
+
 namespace
 {
+using TaskStatePtr = std::shared_ptr<Threading::TaskState>;
+
+/// Task queues owned by a single worker, one per priority.
+struct WorkerQueues
+{
+    std::mutex mutex;
+    std::deque<TaskStatePtr> queues[Threading::kPriorityCount];
+};
+
 struct ThreadingData
 {
-    bool initialized = false;
+    std::atomic<bool> initialized{false};
     std::vector<std::thread> threads;
-    uint32_t current;
+    std::vector<std::unique_ptr<WorkerQueues>> workerQueues;
+    WorkerQueues injectionQueues; ///< Queues for tasks dispatched from non-worker threads.
+
+    std::atomic<bool> terminate{false};
+    std::atomic<uint64_t> queuedCount{0};   ///< Number of tasks sitting in queues.
+    std::atomic<uint64_t> pendingCount{0};  ///< Number of tasks dispatched but not finished.
+    std::atomic<uint32_t> sleepingWorkerCount{0};
+    std::atomic<uint32_t> sleepingWaiterCount{0};
+    std::atomic<uint64_t> executedCount{0};
+    std::atomic<uint64_t> stolenCount{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable workerCondition; ///< Idle workers wait for new tasks.
+    std::condition_variable waiterCondition; ///< Threads in Task::finish() or Threading::finish() wait for new tasks or completion.
 } gData; // TODO: REMOVEGLOBAL
+
+/// Index of the worker owning the current thread, or -1 for non-worker threads.
+thread_local int32_t tWorkerIndex = -1;
+
+// Sleeping threads register before checking their wake-up condition under the sleep mutex.
+// Notifiers update the state before checking the registration, so either side always sees the other.
+
+void wakeWorker()
+{
+    if (gData.sleepingWorkerCount.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(gData.sleepMutex);
+        gData.workerCondition.notify_one();
+    }
+    else if (gData.sleepingWaiterCount.load() > 0)
+    {
+        // All workers are busy, let a waiting thread help out.
+        std::lock_guard<std::mutex> lock(gData.sleepMutex);
+        gData.waiterCondition.notify_all();
+    }
+}
+
+void wakeWaiters()
+{
+    if (gData.sleepingWaiterCount.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(gData.sleepMutex);
+        gData.waiterCondition.notify_all();
+    }
+}
+
+void enqueue(TaskStatePtr pState)
+{
+    WorkerQueues& queues = tWorkerIndex >= 0 ? *gData.workerQueues[tWorkerIndex] : gData.injectionQueues;
+    {
+        std::lock_guard<std::mutex> lock(queues.mutex);
+        queues.queues[(uint32_t)pState->priority].push_back(std::move(pState));
+    }
+    gData.queuedCount++;
+    wakeWorker();
+}
+
+TaskStatePtr popBack(WorkerQueues& queues, uint32_t priority)
+{
+    std::lock_guard<std::mutex> lock(queues.mutex);
+    auto& queue = queues.queues[priority];
+    if (queue.empty())
+        return nullptr;
+    TaskStatePtr pState = std::move(queue.back());
+    queue.pop_back();
+    return pState;
+}
+
+TaskStatePtr popFront(WorkerQueues& queues, uint32_t priority)
+{
+    std::lock_guard<std::mutex> lock(queues.mutex);
+    auto& queue = queues.queues[priority];
+    if (queue.empty())
+        return nullptr;
+    TaskStatePtr pState = std::move(queue.front());
+    queue.pop_front();
+    return pState;
+}
+
+/// Find the next task to execute on the current thread, in priority order.
+TaskStatePtr findTask()
+{
+    if (gData.queuedCount.load() == 0)
+        return nullptr;
+
+    const int32_t workerIndex = tWorkerIndex;
+    const uint32_t workerCount = (uint32_t)gData.workerQueues.size();
+    for (uint32_t priority = 0; priority < Threading::kPriorityCount; priority++)
+    {
+        TaskStatePtr pState;
+        if (workerIndex >= 0)
+            pState = popBack(*gData.workerQueues[workerIndex], priority);
+        if (!pState)
+            pState = popFront(gData.injectionQueues, priority);
+        // Steal from the other workers, starting with the next one to spread the contention.
+        for (uint32_t i = 1; !pState && i <= workerCount; i++)
+        {
+            const uint32_t victim = (uint32_t)(workerIndex + i) % workerCount;
+            if ((int32_t)victim == workerIndex)
+                continue;
+            pState = popFront(*gData.workerQueues[victim], priority);
+            if (pState)
+                gData.stolenCount++;
+        }
+        if (pState)
+        {
+            gData.queuedCount--;
+            return pState;
+        }
+    }
+    return nullptr;
+}
+
+void submit(TaskStatePtr pState);
+
+void complete(const TaskStatePtr& pState)
+{
+    std::vector<TaskStatePtr> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pState->mutex);
+        pState->done = true;
+        continuations.swap(pState->continuations);
+    }
+    for (auto& pContinuation : continuations)
+    {
+        if (--pContinuation->pendingDependencies == 0)
+            submit(std::move(pContinuation));
+    }
+    gData.pendingCount--;
+    wakeWaiters();
+}
+
+void execute(const TaskStatePtr& pState)
+{
+    try
+    {
+        pState->func();
+    }
+    catch (...)
+    {
+        pState->exception = std::current_exception();
+    }
+    pState->func = nullptr; // Release captured resources early.
+    gData.executedCount++;
+    complete(pState);
+}
+
+/// Block until the predicate holds, executing pending tasks in the meantime.
+template<typename Pred>
+void waitWhileHelping(const Pred& isDone)
+{
+    while (!isDone())
+    {
+        if (TaskStatePtr pState = findTask())
+        {
+            execute(pState);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.sleepMutex);
+        gData.sleepingWaiterCount++;
+        gData.waiterCondition.wait(lock, [&]() { return isDone() || gData.queuedCount.load() > 0; });
+        gData.sleepingWaiterCount--;
+    }
+}
+
+void runWorker(int32_t workerIndex)
+{
+    tWorkerIndex = workerIndex;
+    while (true)
+    {
+        if (TaskStatePtr pState = findTask())
+        {
+            execute(pState);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.sleepMutex);
+        gData.sleepingWorkerCount++;
+        gData.workerCondition.wait(lock, []() { return gData.terminate.load() || gData.queuedCount.load() > 0; });
+        gData.sleepingWorkerCount--;
+        if (gData.terminate && gData.queuedCount.load() == 0)
+            break;
+    }
+    tWorkerIndex = -1;
+}
+
+/// Create a task with the given number of outstanding dependencies.
+TaskStatePtr createTask(std::function<void(void)>&& func, Threading::Priority priority, uint32_t dependencyCount)
+{
+    FALCOR_CHECK((uint32_t)priority < Threading::kPriorityCount, "Invalid task priority.");
+    auto pState = std::make_shared<Threading::TaskState>();
+    pState->func = std::move(func);
+    pState->priority = priority;
+    pState->pendingDependencies = dependencyCount;
+    gData.pendingCount++;
+    return pState;
+}
+
+/// Start a task whose dependencies are all satisfied.
+void submit(TaskStatePtr pState)
+{
+    // Without workers, run the task right away.
+    if (!gData.initialized)
+        execute(pState);
+    else
+        enqueue(std::move(pState));
+}
+
+/// Register pState as a continuation of pDependency. Returns false if the dependency has already finished.
+bool addContinuation(const TaskStatePtr& pDependency, const TaskStatePtr& pState)
+{
+    std::lock_guard<std::mutex> lock(pDependency->mutex);
+    if (pDependency->done)
+        return false;
+    pDependency->continuations.push_back(pState);
+    return true;
+}
 } // namespace
 
 static std::mutex sThreadingInitMutex;
@@ -48,8 +288,14 @@ void Threading::start(uint32_t threadCount)
     std::lock_guard<std::mutex> lock(sThreadingInitMutex);
     if (sThreadingInitCount++ == 0)
     {
-        gData.threads.resize(threadCount);
+        threadCount = std::max(1u, threadCount);
+        gData.terminate = false;
+        gData.workerQueues.clear();
+        for (uint32_t i = 0; i < threadCount; i++)
+            gData.workerQueues.push_back(std::make_unique<WorkerQueues>());
         gData.initialized = true;
+        for (uint32_t i = 0; i < threadCount; i++)
+            gData.threads.emplace_back(runWorker, (int32_t)i);
     }
 }
 
@@ -59,46 +305,134 @@ void Threading::shutdown()
     uint32_t count = sThreadingInitCount--;
     if (count == 1)
     {
+        finish();
+        gData.terminate = true;
+        {
+            std::lock_guard<std::mutex> sleepLock(gData.sleepMutex);
+            gData.workerCondition.notify_all();
+        }
         for (auto& t : gData.threads)
             if (t.joinable())
                 t.join();
+        gData.threads.clear();
         gData.initialized = false;
     }
     else if (count == 0)
         FALCOR_THROW("Threading::stop() called more times than Threading::start().");
 }
 
-Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+uint32_t Threading::getWorkerCount()
 {
-    FALCOR_ASSERT(gData.initialized);
+    return gData.initialized ? (uint32_t)gData.threads.size() : 0;
+}
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+Threading::Task Threading::dispatchTask(std::function<void(void)> func, Priority priority)
+{
+    TaskStatePtr pState = createTask(std::move(func), priority, 0);
+    submit(pState);
+    return Task(std::move(pState));
+}
 
-    return Task();
+Threading::Task Threading::dispatchTask(std::function<void(void)> func, const std::vector<Task>& dependencies, Priority priority)
+{
+    // Hold one extra reference while registering, so the task can't start before all dependencies are registered.
+    TaskStatePtr pState = createTask(std::move(func), priority, 1);
+    for (const Task& dependency : dependencies)
+    {
+        if (!dependency.mpState)
+            continue;
+        pState->pendingDependencies++;
+        if (!addContinuation(dependency.mpState, pState))
+            pState->pendingDependencies--;
+    }
+    if (--pState->pendingDependencies == 0)
+        submit(pState);
+    return Task(std::move(pState));
 }
 
-void Threading::finish()
+void Threading::parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t)>& func, uint32_t grainSize)
 {
-    for (auto& t : gData.threads)
+    if (begin >= end)
+        return;
+
+    // Split into a few chunks per thread to balance uneven work, but not below the grain size.
+    const uint32_t count = end - begin;
+    const uint32_t threadCount = getWorkerCount() + 1;
+    const uint32_t chunkSize = std::max(std::max(1u, grainSize), (count + 4 * threadCount - 1) / (4 * threadCount));
+    const uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    auto runChunk = [&](uint32_t chunk)
+    {
+        const uint32_t chunkBegin = begin + chunk * chunkSize;
+        const uint32_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+        for (uint32_t i = chunkBegin; i < chunkEnd; i++)
+            func(i);
+    };
+
+    std::vector<Task> tasks;
+    tasks.reserve(chunkCount - 1);
+    for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+        tasks.push_back(dispatchTask([&runChunk, chunk]() { runChunk(chunk); }));
+
+    std::exception_ptr exception;
+    try
+    {
+        runChunk(0);
+    }
+    catch (...)
     {
-        if (t.joinable())
-            t.join();
+        exception = std::current_exception();
     }
+
+    // Wait for all chunks before leaving, the tasks reference the local state.
+    for (Task& task : tasks)
+    {
+        try
+        {
+            task.finish();
+        }
+        catch (...)
+        {
+            if (!exception)
+                exception = std::current_exception();
+        }
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void Threading::finish()
+{
+    waitWhileHelping([]() { return gData.pendingCount.load() == 0; });
 }
 
-Threading::Task::Task() {}
+Threading::Stats Threading::getStats()
+{
+    Stats stats;
+    stats.workerCount = getWorkerCount();
+    stats.executedCount = gData.executedCount;
+    stats.stolenCount = gData.stolenCount;
+    stats.pendingCount = gData.pendingCount;
+    return stats;
+}
 
-bool Threading::Task::isRunning()
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    return mpState && !mpState->done;
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+    TaskState* pState = mpState.get();
+    waitWhileHelping([pState]() { return pState->done.load(); });
+    if (mpState->exception)
+        std::rethrow_exception(mpState->exception);
+}
+
+Threading::Task Threading::Task::then(std::function<void(void)> func, Priority priority) const
+{
+    return dispatchTask(std::move(func), {*this}, priority);
 }
 } // namespace Falcor
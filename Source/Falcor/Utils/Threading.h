@@ -29,36 +29,89 @@
 #include "Core/Macros.h"
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <cstdint>
 
 namespace Falcor
 {
+/**
+ * Engine-wide task scheduler.
+ *
+ * Tasks are executed by a pool of worker threads. Each worker owns a double-ended queue per priority:
+ * tasks dispatched from a worker are pushed to and popped from the back of its own queue (LIFO, for cache
+ * locality in fork-join workloads), while idle workers steal from the front of other workers' queues.
+ * Tasks dispatched from other threads go to a shared injection queue. Higher priority tasks are always
+ * picked before lower priority ones.
+ *
+ * Waiting on a task with Task::finish() executes pending tasks on the waiting thread until the task is done,
+ * so it is safe to wait on tasks from within tasks (fork-join).
+ *
+ * If the scheduler is not started, tasks are executed immediately on the dispatching thread.
+ */
 class FALCOR_API Threading
 {
 public:
     const static uint32_t kDefaultThreadCount = 16;
 
+    enum class Priority : uint32_t
+    {
+        High,   ///< Latency-sensitive work, e.g. work the current frame is waiting on.
+        Normal, ///< Default priority.
+        Low,    ///< Background work such as asset streaming or file writes.
+    };
+    static constexpr uint32_t kPriorityCount = 3;
+
+    struct TaskState;
+
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
+     * Handles are cheap to copy. A default constructed handle refers to no task and is never running.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        Task() = default;
+
+        /// Check if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
 
-        /// Wait for task to finish executing
+        ///  Check if task is still executing (or waiting to be executed).
+        bool isRunning() const;
+
+        /**
+         * Wait for task to finish executing.
+         * The calling thread executes other pending tasks while waiting.
+         * If the task threw an exception, it is rethrown here.
+         */
         void finish();
 
+        /**
+         * Schedule a continuation that is dispatched once this task has finished.
+         * The continuation runs even if this task threw an exception.
+         * @param[in] func Function to execute.
+         * @param[in] priority Priority of the continuation.
+         * @return Handle to the continuation.
+         */
+        Task then(std::function<void(void)> func, Priority priority = Priority::Normal) const;
+
     private:
-        Task();
+        Task(std::shared_ptr<TaskState> pState) : mpState(std::move(pState)) {}
+
+        std::shared_ptr<TaskState> mpState;
         friend class Threading;
     };
 
+    struct Stats
+    {
+        uint32_t workerCount = 0;    ///< Number of worker threads.
+        uint64_t executedCount = 0;  ///< Number of tasks executed (by workers and helping threads).
+        uint64_t stolenCount = 0;    ///< Number of tasks stolen from another worker's queue.
+        uint64_t pendingCount = 0;   ///< Number of tasks dispatched but not finished.
+    };
+
     /**
      * Initializes the global thread pool
      * @param[in] threadCount Number of threads in the pool
@@ -66,12 +119,13 @@ public:
     static void start(uint32_t threadCount = kDefaultThreadCount);
 
     /**
-     * Waits for all currently executing threads to finish
+     * Waits for all dispatched tasks to finish.
+     * The calling thread executes pending tasks while waiting.
      */
     static void finish();
 
     /**
-     * Waits for all currently executing threads to finish and shuts down the thread pool
+     * Waits for all dispatched tasks to finish and shuts down the thread pool
      */
     static void shutdown();
 
@@ -80,11 +134,39 @@ public:
      */
     static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
+    /**
+     * Returns the number of worker threads, or 0 if the scheduler is not started.
+     */
+    static uint32_t getWorkerCount();
+
     /**
      * Starts a task on an available thread.
+     * @param[in] func Function to execute.
+     * @param[in] priority Task priority.
+     * @return Handle to the task
+     */
+    static Task dispatchTask(std::function<void(void)> func, Priority priority = Priority::Normal);
+
+    /**
+     * Starts a task once all its dependencies have finished.
+     * @param[in] func Function to execute.
+     * @param[in] dependencies Tasks that need to finish before the task is started. Invalid handles are ignored.
+     * @param[in] priority Task priority.
      * @return Handle to the task
      */
-    static Task dispatchTask(const std::function<void(void)>& func);
+    static Task dispatchTask(std::function<void(void)> func, const std::vector<Task>& dependencies, Priority priority = Priority::Normal);
+
+    /**
+     * Executes func(i) for all i in [begin, end) in parallel and waits for completion (fork-join).
+     * The range is split into chunks of at least grainSize elements. The calling thread participates.
+     * If func throws, the first exception is rethrown after all chunks have finished.
+     */
+    static void parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t)>& func, uint32_t grainSize = 1);
+
+    /**
+     * Returns scheduler statistics.
+     */
+    static Stats getStats();
 };
 
 /**
@@ -0,0 +1,268 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FrameTimingAnalyzer.h"
+#include "Core/Error.h"
+#include "Utils/StringFormatters.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+const double kLogBase = std::log1p(FrameTimingAnalyzer::Histogram::kPrecision);
+
+size_t getBucketIndex(double value)
+{
+    value = std::clamp(value, FrameTimingAnalyzer::Histogram::kMinValue, FrameTimingAnalyzer::Histogram::kMaxValue);
+    return size_t(std::log(value / FrameTimingAnalyzer::Histogram::kMinValue) / kLogBase);
+}
+
+double getBucketValue(size_t index)
+{
+    // Geometric center of the bucket.
+    return FrameTimingAnalyzer::Histogram::kMinValue * std::exp((index + 0.5) * kLogBase);
+}
+
+nlohmann::json toJson(const FrameTimingAnalyzer::Histogram& h)
+{
+    return {
+        {"count", h.getCount()},
+        {"min", h.getMin()},
+        {"max", h.getMax()},
+        {"mean", h.getMean()},
+        {"p50", h.getPercentile(0.5)},
+        {"p95", h.getPercentile(0.95)},
+        {"p99", h.getPercentile(0.99)},
+    };
+}
+} // namespace
+
+void FrameTimingAnalyzer::Histogram::record(double value)
+{
+    if (!std::isfinite(value))
+        return;
+
+    size_t index = getBucketIndex(value);
+    if (index >= mBuckets.size())
+        mBuckets.resize(index + 1, 0);
+    mBuckets[index]++;
+
+    mMin = mCount > 0 ? std::min(mMin, value) : value;
+    mMax = mCount > 0 ? std::max(mMax, value) : value;
+    mSum += value;
+    mCount++;
+}
+
+double FrameTimingAnalyzer::Histogram::getPercentile(double p) const
+{
+    if (mCount == 0)
+        return 0.0;
+    if (p <= 0.0)
+        return mMin;
+    if (p >= 1.0)
+        return mMax;
+
+    uint64_t rank = std::clamp<uint64_t>(uint64_t(std::ceil(p * mCount)), 1, mCount);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < mBuckets.size(); i++)
+    {
+        sum += mBuckets[i];
+        if (sum >= rank)
+            return std::clamp(getBucketValue(i), mMin, mMax);
+    }
+    return mMax;
+}
+
+void FrameTimingAnalyzer::openStream(const std::filesystem::path& path)
+{
+    closeStream();
+    mStream.open(path, std::ios::trunc);
+    if (!mStream)
+        FALCOR_THROW("Failed to open frame timing file '{}' for writing.", path);
+}
+
+void FrameTimingAnalyzer::closeStream()
+{
+    if (mStream.is_open())
+        mStream.close();
+    mUnflushedFrames = 0;
+}
+
+void FrameTimingAnalyzer::addEvent(std::string_view name)
+{
+    if (std::find(mPendingEvents.begin(), mPendingEvents.end(), name) == mPendingEvents.end())
+        mPendingEvents.emplace_back(name);
+}
+
+bool FrameTimingAnalyzer::recordFrame(uint64_t frame, double frameTimeMs, const std::vector<PassTime>& passes)
+{
+    // Compare against the median of the previous frames, so that the stutter itself doesn't affect the median.
+    // Detection starts once half of the window is filled.
+    bool isStutter = false;
+    double median = 0.0;
+    if (mWindow.size() >= std::max<size_t>(1, mOptions.medianWindow / 2))
+    {
+        median = computeMedian();
+        isStutter = median > 0.0 && frameTimeMs > mOptions.stutterThreshold * median;
+    }
+
+    mFrameTime.record(frameTimeMs);
+    for (const auto& pass : passes)
+    {
+        auto& h = mPasses[pass.name];
+        h.cpu.record(pass.cpuTimeMs);
+        h.gpu.record(pass.gpuTimeMs);
+    }
+
+    if (mOptions.medianWindow > 0)
+    {
+        if (mWindow.size() < mOptions.medianWindow)
+            mWindow.push_back(frameTimeMs);
+        else
+            mWindow[mWindowIndex] = frameTimeMs;
+        mWindowIndex = (mWindowIndex + 1) % mOptions.medianWindow;
+    }
+
+    for (const auto& event : mPendingEvents)
+    {
+        auto& stats = mEventStats[event];
+        stats.frameCount++;
+        if (isStutter)
+            stats.stutterCount++;
+    }
+
+    if (isStutter)
+    {
+        mStutterCount++;
+        if (mStutters.size() < mOptions.maxStutterRecords)
+            mStutters.push_back({frame, frameTimeMs, median, mPendingEvents});
+    }
+
+    if (mStream.is_open())
+    {
+        nlohmann::json j = {
+            {"frame", frame},
+            {"frameTime", frameTimeMs},
+            {"stutter", isStutter},
+            {"events", mPendingEvents},
+        };
+        if (!passes.empty())
+        {
+            nlohmann::json jPasses = nlohmann::json::object();
+            for (const auto& pass : passes)
+                jPasses[pass.name] = {{"cpu", pass.cpuTimeMs}, {"gpu", pass.gpuTimeMs}};
+            j["passes"] = std::move(jPasses);
+        }
+        mStream << j.dump() << '\n';
+
+        // Flush periodically so that the file is usable while the session is running.
+        if (++mUnflushedFrames >= mOptions.flushInterval)
+        {
+            mStream.flush();
+            mUnflushedFrames = 0;
+        }
+    }
+
+    mPendingEvents.clear();
+    return isStutter;
+}
+
+const FrameTimingAnalyzer::Histogram* FrameTimingAnalyzer::getPassCpuTimeHistogram(const std::string& name) const
+{
+    auto it = mPasses.find(name);
+    return it != mPasses.end() ? &it->second.cpu : nullptr;
+}
+
+const FrameTimingAnalyzer::Histogram* FrameTimingAnalyzer::getPassGpuTimeHistogram(const std::string& name) const
+{
+    auto it = mPasses.find(name);
+    return it != mPasses.end() ? &it->second.gpu : nullptr;
+}
+
+std::string FrameTimingAnalyzer::getSummaryJson() const
+{
+    nlohmann::json passes = nlohmann::json::object();
+    for (const auto& [name, h] : mPasses)
+        passes[name] = {{"cpu", toJson(h.cpu)}, {"gpu", toJson(h.gpu)}};
+
+    nlohmann::json stutters = nlohmann::json::array();
+    for (const auto& stutter : mStutters)
+    {
+        stutters.push_back({
+            {"frame", stutter.frame},
+            {"frameTime", stutter.frameTimeMs},
+            {"median", stutter.medianMs},
+            {"events", stutter.events},
+        });
+    }
+
+    // Compare the stutter rate of frames with an event to the overall stutter rate to see which events cause stutters.
+    const uint64_t frameCount = getFrameCount();
+    nlohmann::json events = nlohmann::json::object();
+    for (const auto& [name, stats] : mEventStats)
+    {
+        events[name] = {
+            {"frameCount", stats.frameCount},
+            {"stutterCount", stats.stutterCount},
+            {"stutterRate", stats.frameCount > 0 ? double(stats.stutterCount) / stats.frameCount : 0.0},
+        };
+    }
+
+    nlohmann::json j = {
+        {"frameCount", frameCount},
+        {"stutterThreshold", mOptions.stutterThreshold},
+        {"frameTime", toJson(mFrameTime)},
+        {"passes", std::move(passes)},
+        {"stutterCount", mStutterCount},
+        {"stutterRate", frameCount > 0 ? double(mStutterCount) / frameCount : 0.0},
+        {"stutters", std::move(stutters)},
+        {"events", std::move(events)},
+    };
+    return j.dump(4);
+}
+
+void FrameTimingAnalyzer::writeSummary(const std::filesystem::path& path) const
+{
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs)
+        FALCOR_THROW("Failed to open frame timing summary file '{}' for writing.", path);
+    ofs << getSummaryJson() << std::endl;
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write frame timing summary file '{}'.", path);
+}
+
+double FrameTimingAnalyzer::computeMedian() const
+{
+    std::vector<double> window = mWindow;
+    auto mid = window.begin() + window.size() / 2;
+    std::nth_element(window.begin(), mid, window.end());
+    return *mid;
+}
+} // namespace Falcor
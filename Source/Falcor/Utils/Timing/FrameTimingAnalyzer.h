@@ -0,0 +1,186 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Frame timing analysis for long running sessions.
+ *
+ * Records frame times and per-pass CPU/GPU times, computes percentiles, detects stutters (frames that take longer than a
+ * multiple of the median frame time over a sliding window) and correlates stutters with events such as animation updates,
+ * acceleration structure rebuilds or texture loads.
+ *
+ * Memory use is bounded: percentiles are computed from log-scale histograms, only a limited number of stutters are kept,
+ * and the per-frame records are streamed to disk as JSON lines.
+ */
+class FALCOR_API FrameTimingAnalyzer
+{
+public:
+    struct Options
+    {
+        double stutterThreshold = 2.0;     ///< A frame is a stutter if it takes longer than this multiple of the median frame time.
+        uint32_t medianWindow = 120;       ///< Number of previous frames used to compute the median frame time.
+        uint32_t maxStutterRecords = 1000; ///< Max number of stutters kept in memory. Further stutters are only counted.
+        uint32_t flushInterval = 64;       ///< Number of frames between flushes of the frame stream.
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    /**
+     * Histogram with logarithmically spaced buckets, for computing percentiles in bounded memory.
+     * Values are recorded with a relative precision of 1% in the range [kMinValue, kMaxValue], values outside are clamped.
+     */
+    class FALCOR_API Histogram
+    {
+    public:
+        static constexpr double kMinValue = 1e-3;
+        static constexpr double kMaxValue = 1e5;
+        static constexpr double kPrecision = 0.01;
+
+        void record(double value);
+
+        uint64_t getCount() const { return mCount; }
+        double getMin() const { return mCount > 0 ? mMin : 0.0; }
+        double getMax() const { return mCount > 0 ? mMax : 0.0; }
+        double getMean() const { return mCount > 0 ? mSum / mCount : 0.0; }
+
+        /**
+         * Get the value at a given percentile.
+         * @param[in] p Percentile in [0,1].
+         * @return Value within the precision of the histogram, clamped to the min/max recorded value. Zero if empty.
+         * The 0th and 100th percentiles are the exact min and max values.
+         */
+        double getPercentile(double p) const;
+
+    private:
+        std::vector<uint64_t> mBuckets; ///< Bucket counts, grown on demand.
+        uint64_t mCount = 0;
+        double mSum = 0.0;
+        double mMin = 0.0;
+        double mMax = 0.0;
+    };
+
+    struct PassTime
+    {
+        std::string name;
+        double cpuTimeMs = 0.0;
+        double gpuTimeMs = 0.0;
+    };
+
+    struct Stutter
+    {
+        uint64_t frame = 0;
+        double frameTimeMs = 0.0;
+        double medianMs = 0.0; ///< Median frame time over the preceding window.
+        std::vector<std::string> events;
+    };
+
+    struct EventStats
+    {
+        uint64_t frameCount = 0;   ///< Number of frames with the event.
+        uint64_t stutterCount = 0; ///< Number of stutters in frames with the event.
+    };
+
+    FrameTimingAnalyzer(const Options& options = Options()) : mOptions(options) {}
+    ~FrameTimingAnalyzer() { closeStream(); }
+
+    /**
+     * Stream the per-frame records to a file, one JSON object per line.
+     * Throws if the file cannot be opened.
+     */
+    void openStream(const std::filesystem::path& path);
+    void closeStream();
+
+    /**
+     * Add an event to the next recorded frame. Adding the same event multiple times has no effect.
+     */
+    void addEvent(std::string_view name);
+
+    /**
+     * Record a frame. Events added since the last call are associated with this frame.
+     * @param[in] frame Frame index.
+     * @param[in] frameTimeMs Frame time in ms.
+     * @param[in] passes Per-pass times in ms.
+     * @return True if the frame is a stutter.
+     */
+    bool recordFrame(uint64_t frame, double frameTimeMs, const std::vector<PassTime>& passes = {});
+
+    uint64_t getFrameCount() const { return mFrameTime.getCount(); }
+    const Histogram& getFrameTimeHistogram() const { return mFrameTime; }
+    const Histogram* getPassCpuTimeHistogram(const std::string& name) const;
+    const Histogram* getPassGpuTimeHistogram(const std::string& name) const;
+
+    /// Get the recorded stutters, up to the max number of stutter records.
+    const std::vector<Stutter>& getStutters() const { return mStutters; }
+    uint64_t getStutterCount() const { return mStutterCount; }
+    const std::map<std::string, EventStats>& getEventStats() const { return mEventStats; }
+
+    /**
+     * Write a summary of the recorded frames to a JSON file: frame and per-pass percentiles, stutters and event correlation.
+     * Throws on error.
+     */
+    void writeSummary(const std::filesystem::path& path) const;
+
+    /// Get the summary as a JSON string, see writeSummary().
+    std::string getSummaryJson() const;
+
+    const Options& getOptions() const { return mOptions; }
+
+private:
+    struct PassHistograms
+    {
+        Histogram cpu;
+        Histogram gpu;
+    };
+
+    double computeMedian() const;
+
+    Options mOptions;
+    Histogram mFrameTime;
+    std::map<std::string, PassHistograms> mPasses;
+    std::vector<double> mWindow; ///< Frame times of the previous frames (round-robin).
+    size_t mWindowIndex = 0;
+    std::vector<std::string> mPendingEvents;
+    std::map<std::string, EventStats> mEventStats;
+    std::vector<Stutter> mStutters;
+    uint64_t mStutterCount = 0;
+
+    std::ofstream mStream;
+    uint32_t mUnflushedFrames = 0;
+};
+} // namespace Falcor
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TimeReport.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include <numeric>
@@ -40,6 +41,7 @@ TimeReport::TimeReport()
 void TimeReport::reset()
 {
     mLastMeasureTime = CpuTimer::getCurrentTimePoint();
+    mLastCpuTime = getProcessCpuTime();
     mMeasurements.clear();
     mTotal = 0.0;
 }
@@ -47,16 +49,18 @@ void TimeReport::reset()
 void TimeReport::resetTimer()
 {
     mLastMeasureTime = CpuTimer::getCurrentTimePoint();
+    mLastCpuTime = getProcessCpuTime();
     mTotal = 0.0;
 }
 
 void TimeReport::printToLog()
 {
-    for (const auto& [task, duration] : mMeasurements)
+    for (const auto& [task, duration, cpuTime] : mMeasurements)
     {
         logInfo(
             padStringToLength(task + ":", 25) + " " + std::to_string(duration) + " s" +
-            (mTotal > 0.0 && !mMeasurements.empty() ? ", " + std::to_string(100.0 * duration / mTotal) + "% of total" : "")
+            (mTotal > 0.0 && !mMeasurements.empty() ? ", " + std::to_string(100.0 * duration / mTotal) + "% of total" : "") + " (CPU " +
+            std::to_string(cpuTime) + " s)"
         );
     }
 }
@@ -64,14 +68,22 @@ void TimeReport::printToLog()
 void TimeReport::measure(const std::string& name)
 {
     auto currentTime = CpuTimer::getCurrentTimePoint();
+    double currentCpuTime = getProcessCpuTime();
     std::chrono::duration<double> duration = currentTime - mLastMeasureTime;
+    mMeasurements.push_back({name, duration.count(), currentCpuTime - mLastCpuTime});
     mLastMeasureTime = currentTime;
-    mMeasurements.push_back({name, duration.count()});
+    mLastCpuTime = currentCpuTime;
+}
+
+void TimeReport::addMeasurement(const std::string& name, double wallTime, double cpuTime)
+{
+    mMeasurements.push_back({name, wallTime, cpuTime});
 }
 
 void TimeReport::addTotal(const std::string name)
 {
-    mTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [](double t, auto&& m) { return t + m.second; });
-    mMeasurements.push_back({"Total", mTotal});
+    mTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [](double t, auto&& m) { return t + m.wallTime; });
+    double cpuTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [](double t, auto&& m) { return t + m.cpuTime; });
+    mMeasurements.push_back({"Total", mTotal, cpuTotal});
 }
 } // namespace Falcor
@@ -29,7 +29,6 @@
 #include "CpuTimer.h"
 #include "Core/Macros.h"
 #include <string>
-#include <utility>
 #include <vector>
 
 namespace Falcor
@@ -37,6 +36,8 @@ namespace Falcor
 /**
  * Utility class to record a number of timing measurements and print them afterwards.
  * This is mainly intended for measuring longer running tasks on the CPU.
+ * Each measurement records both the elapsed wall time and the CPU time consumed by the process,
+ * which shows how well a task makes use of multiple threads.
  */
 class FALCOR_API TimeReport
 {
@@ -65,6 +66,16 @@ public:
      */
     void measure(const std::string& name);
 
+    /**
+     * Records an externally measured time.
+     * This is useful for tasks that run concurrently, where the time between calls to measure() is not meaningful.
+     * The internal timer is not affected.
+     * @param[in] name Name of the record.
+     * @param[in] wallTime Elapsed wall time in seconds.
+     * @param[in] cpuTime Consumed CPU time in seconds, summed over all threads.
+     */
+    void addMeasurement(const std::string& name, double wallTime, double cpuTime);
+
     /**
      * Add a record containing the total of all measurements.
      * @param[in] name Name of the record.
@@ -72,8 +83,16 @@ public:
     void addTotal(const std::string name = "Total");
 
 private:
+    struct Measurement
+    {
+        std::string name;
+        double wallTime;
+        double cpuTime;
+    };
+
     CpuTimer::TimePoint mLastMeasureTime;
-    std::vector<std::pair<std::string, double>> mMeasurements;
+    double mLastCpuTime = 0.0;
+    std::vector<Measurement> mMeasurements;
     double mTotal = 0.0;
 };
 } // namespace Falcor
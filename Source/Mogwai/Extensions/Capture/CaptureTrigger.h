@@ -50,6 +50,9 @@ namespace Mogwai
         virtual void beginRange(RenderGraph* pGraph, const Range& r) {};
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) {};
         virtual void endRange(RenderGraph* pGraph, const Range& r) {};
+        /** Called at the end of every frame, whether or not a range is active.
+        */
+        virtual void onFrameEnd(RenderContext* pCtx) {};
 
         void addRange(const RenderGraph* pGraph, uint64_t startFrame, uint64_t count);
         void reset(const RenderGraph* pGraph = nullptr);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Falcor.h"
 #include "FrameCapture.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Scripting/ScriptWriter.h"
 #include <filesystem>
 
@@ -41,6 +42,8 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kStats = "stats";
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -63,6 +66,7 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
+        mpWriter = std::make_unique<AsyncTextureWriter>(pRenderer->getDevice());
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -77,6 +81,23 @@ namespace Mogwai
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
             if (w.button("Capture Current Frame")) capture();
+
+            if (auto g = w.group("Statistics"))
+            {
+                const auto stats = mpWriter->getStats();
+                double avgLatencyMs = 0.0;
+                for (const auto& frame : stats.recentFrames) avgLatencyMs += frame.totalLatencyMs;
+                if (!stats.recentFrames.empty()) avgLatencyMs /= stats.recentFrames.size();
+
+                std::string text;
+                text += fmt::format("Frames written: {} ({} images, {} failed)\n", stats.frameCount, stats.imageCount, stats.failedCount);
+                text += fmt::format("Data written: {}\n", formatByteSize(stats.byteCount));
+                text += fmt::format("Pending: {} images ({})\n", stats.pendingImageCount, formatByteSize(stats.pendingBytes));
+                text += fmt::format("Latency: {:.1f} ms avg, {:.1f} ms max\n", avgLatencyMs, stats.maxTotalLatencyMs);
+                text += fmt::format("Stall time: {:.1f} ms\n", stats.stallTimeMs);
+                text += fmt::format("Staging buffers: {} ({})\n", stats.stagingBufferCount, formatByteSize(stats.stagingMemoryInBytes));
+                g.text(text);
+            }
         }
     }
 
@@ -95,6 +116,8 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
+        frameCapture.def_property_readonly(kStats.c_str(), &FrameCapture::getStats);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -146,7 +169,7 @@ namespace Mogwai
 
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
-            captureOutput(pRenderContext, pGraph, i);
+            captureOutput(pRenderContext, pGraph, i, frameID);
         }
 
         if (mCaptureAllOutputs && !unmarkedOutputs.empty())
@@ -156,10 +179,16 @@ namespace Mogwai
         }
     }
 
-    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex)
+    void FrameCapture::onFrameEnd(RenderContext* pRenderContext)
+    {
+        // Hand finished readbacks to the encoders.
+        mpWriter->poll();
+    }
+
+    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, uint64_t frameID)
     {
         const std::string outputName = pGraph->getOutputName(outputIndex);
-        const std::string basename = getOutputNamePrefix(outputName) + std::to_string(mpRenderer->getGlobalClock().getFrame());
+        const std::string basename = getOutputNamePrefix(outputName) + std::to_string(frameID);
 
         const ref<Texture> pOutput = pGraph->getOutput(outputIndex)->asTexture();
         if (!pOutput) FALCOR_THROW("Graph output {} is not a texture", outputName);
@@ -248,7 +277,7 @@ namespace Mogwai
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            mpWriter->write(pRenderContext, pTex, 0, 0, filename, fileformat, flags, frameID);
         }
     }
 
@@ -279,4 +308,39 @@ namespace Mogwai
         uint64_t frameID = mpRenderer->getGlobalClock().getFrame();
         triggerFrame(mpRenderer->getRenderContext(), pGraph, frameID);
     }
+
+    void FrameCapture::flush()
+    {
+        mpWriter->flush();
+    }
+
+    pybind11::dict FrameCapture::getStats() const
+    {
+        const auto stats = mpWriter->getStats();
+
+        pybind11::dict d;
+        d["frameCount"] = stats.frameCount;
+        d["imageCount"] = stats.imageCount;
+        d["failedCount"] = stats.failedCount;
+        d["byteCount"] = stats.byteCount;
+        d["stallTimeMs"] = stats.stallTimeMs;
+        d["maxLatencyMs"] = stats.maxTotalLatencyMs;
+        d["pendingImageCount"] = stats.pendingImageCount;
+        d["pendingBytes"] = stats.pendingBytes;
+
+        pybind11::list frames;
+        for (const auto& frame : stats.recentFrames)
+        {
+            pybind11::dict f;
+            f["frameID"] = frame.frameID;
+            f["imageCount"] = frame.imageCount;
+            f["byteCount"] = frame.byteCount;
+            f["stallTimeMs"] = frame.stallTimeMs;
+            f["readbackLatencyMs"] = frame.readbackLatencyMs;
+            f["latencyMs"] = frame.totalLatencyMs;
+            frames.append(f);
+        }
+        d["frames"] = frames;
+        return d;
+    }
 }
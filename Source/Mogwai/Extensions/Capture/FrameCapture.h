@@ -28,6 +28,7 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "Utils/Image/AsyncTextureWriter.h"
 #include "Utils/Image/ImageProcessing.h"
 
 namespace Mogwai
@@ -41,8 +42,16 @@ namespace Mogwai
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void onFrameEnd(RenderContext* pRenderContext) override;
         void capture();
 
+        /** Block until all captured images have been written to disk.
+        */
+        void flush();
+
+        using CaptureTrigger::setOutputDirectory;
+        using CaptureTrigger::setBaseFilename;
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -50,9 +59,11 @@ namespace Mogwai
         void addFrames(const RenderGraph* pGraph, const uint64_vec& frames);
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
-        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, uint64_t frameID);
+        pybind11::dict getStats() const;
 
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+        std::unique_ptr<AsyncTextureWriter> mpWriter; ///< Reads back and writes the captured images without stalling the renderer.
     };
 }
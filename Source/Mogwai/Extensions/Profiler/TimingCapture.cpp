@@ -34,6 +34,31 @@ namespace Mogwai
     {
         const std::string kScriptVar = "timingCapture";
         const std::string kCaptureFrameTime = "captureFrameTime";
+        const std::string kCaptureMetrics = "captureMetrics";
+        const std::string kCaptureFrameStats = "captureFrameStats";
+        const std::string kGetFrameStats = "getFrameStats";
+
+        // Scene updates reported as events for stutter correlation.
+        const std::pair<Scene::UpdateFlags, const char*> kSceneEvents[] =
+        {
+            { Scene::UpdateFlags::GeometryMoved | Scene::UpdateFlags::SceneGraphChanged | Scene::UpdateFlags::MeshesChanged |
+              Scene::UpdateFlags::CurvesMoved | Scene::UpdateFlags::CustomPrimitivesMoved | Scene::UpdateFlags::GridVolumesMoved, "animation" },
+            { Scene::UpdateFlags::CameraMoved | Scene::UpdateFlags::CameraSwitched | Scene::UpdateFlags::CameraPropertiesChanged, "camera" },
+            { Scene::UpdateFlags::LightsMoved | Scene::UpdateFlags::LightIntensityChanged | Scene::UpdateFlags::LightPropertiesChanged |
+              Scene::UpdateFlags::LightCollectionChanged | Scene::UpdateFlags::LightCountChanged, "lights" },
+            { Scene::UpdateFlags::MaterialsChanged | Scene::UpdateFlags::EmissiveMaterialsChanged, "materials" },
+            { Scene::UpdateFlags::RecompileNeeded, "recompile" },
+        };
+
+        // Metrics counters reported as events for stutter correlation.
+        const std::pair<const char*, const char*> kMetricEvents[] =
+        {
+            { "scene.blas_builds", "blas_build" },
+            { "scene.blas_refits", "blas_refit" },
+            { "scene.tlas_builds", "tlas_build" },
+            { "texture.loads", "texture_load" },
+            { "texture_cache.misses", "texture_cache_miss" },
+        };
     }
 
     MOGWAI_EXTENSION(TimingCapture);
@@ -43,6 +68,12 @@ namespace Mogwai
         return UniquePtr(new TimingCapture(pRenderer));
     }
 
+    TimingCapture::~TimingCapture()
+    {
+        writeMetrics();
+        writeFrameStats();
+    }
+
     void TimingCapture::registerScriptBindings(pybind11::module& m)
     {
         using namespace pybind11::literals;
@@ -51,6 +82,10 @@ namespace Mogwai
 
         // Members
         timingCapture.def(kCaptureFrameTime.c_str(), &TimingCapture::captureFrameTime, "path"_a);
+        timingCapture.def(kCaptureMetrics.c_str(), &TimingCapture::captureMetrics, "path"_a);
+        timingCapture.def(kCaptureFrameStats.c_str(), &TimingCapture::captureFrameStats,
+            "path"_a, "framesPath"_a = std::filesystem::path(), "stutterThreshold"_a = 2.0);
+        timingCapture.def(kGetFrameStats.c_str(), &TimingCapture::getFrameStats);
     }
 
     std::string TimingCapture::getScriptVar() const
@@ -61,6 +96,8 @@ namespace Mogwai
     void TimingCapture::beginFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
     {
         recordPreviousFrameTime();
+        recordPreviousMetricsSample();
+        recordPreviousFrameStats();
     }
 
     void TimingCapture::captureFrameTime(std::filesystem::path path)
@@ -92,4 +129,153 @@ namespace Mogwai
         if (frameRate.getFrameCount() > 1)
             mFrameTimeFile << frameRate.getLastFrameTime() << std::endl;
     }
+
+    void TimingCapture::captureMetrics(std::filesystem::path path)
+    {
+        writeMetrics();
+
+        if (!path.empty())
+        {
+            if (std::filesystem::exists(path))
+            {
+                logWarning("Metrics in file '{}' will be overwritten.", path);
+            }
+            if (!MetricsRegistry::isEnabled())
+            {
+                logWarning("Metrics are disabled, no samples will be captured.");
+            }
+
+            mMetricsPath = path;
+        }
+    }
+
+    void TimingCapture::recordPreviousMetricsSample()
+    {
+        if (mMetricsPath.empty()) return;
+
+        // Metrics are sampled at the end of each frame, skip the sample if no frame was rendered since the last call.
+        auto sample = MetricsRegistry::instance().getLastSample();
+        if (sample.values.empty()) return;
+        if (!mMetricsSamples.empty() && mMetricsSamples.back().frame == sample.frame) return;
+        mMetricsSamples.push_back(std::move(sample));
+    }
+
+    void TimingCapture::writeMetrics()
+    {
+        if (mMetricsPath.empty()) return;
+
+        try
+        {
+            if (hasExtension(mMetricsPath, "json"))
+                MetricsRegistry::instance().writeJSON(mMetricsPath, mMetricsSamples);
+            else
+                MetricsRegistry::instance().writeCSV(mMetricsPath, mMetricsSamples);
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to write metrics to file '{}': {}", mMetricsPath, e.what());
+        }
+
+        mMetricsPath.clear();
+        mMetricsSamples.clear();
+    }
+
+    void TimingCapture::captureFrameStats(std::filesystem::path path, std::filesystem::path framesPath, double stutterThreshold)
+    {
+        writeFrameStats();
+
+        if (!path.empty())
+        {
+            FrameTimingAnalyzer::Options options;
+            options.stutterThreshold = stutterThreshold;
+            auto pFrameStats = std::make_unique<FrameTimingAnalyzer>(options);
+            if (!framesPath.empty())
+            {
+                try
+                {
+                    pFrameStats->openStream(framesPath);
+                }
+                catch (const std::exception& e)
+                {
+                    logError("{} Ignoring call.", e.what());
+                    return;
+                }
+            }
+
+            mpFrameStats = std::move(pFrameStats);
+            mFrameStatsPath = path;
+
+            // Per-pass times are taken from the profiler.
+            Profiler* pProfiler = mpRenderer->getDevice()->getProfiler();
+            mProfilerWasEnabled = pProfiler->isEnabled();
+            pProfiler->setEnabled(true);
+        }
+    }
+
+    void TimingCapture::recordPreviousFrameStats()
+    {
+        if (!mpFrameStats) return;
+
+        // The FrameRate object is updated at the start of each frame, the first valid time is available on the second frame.
+        // The scene updates, profiler events and metrics sample are all from the previous frame at this point.
+        auto& frameRate = mpRenderer->getFrameRate();
+        if (frameRate.getFrameCount() <= 1) return;
+        const uint64_t frame = frameRate.getFrameCount() - 1;
+
+        if (auto pScene = mpRenderer->getScene())
+        {
+            const auto updates = pScene->getUpdates();
+            for (const auto& [flags, name] : kSceneEvents)
+            {
+                if ((updates & flags) != Scene::UpdateFlags::None) mpFrameStats->addEvent(name);
+            }
+        }
+
+        const auto sample = MetricsRegistry::instance().getLastSample();
+        if (sample.frame == frame && !sample.values.empty())
+        {
+            const auto columns = MetricsRegistry::instance().getColumnNames();
+            for (const auto& [metric, name] : kMetricEvents)
+            {
+                auto it = std::find(columns.begin(), columns.end(), metric);
+                size_t index = it - columns.begin();
+                if (index < sample.values.size() && sample.values[index] > 0.0) mpFrameStats->addEvent(name);
+            }
+        }
+
+        std::vector<FrameTimingAnalyzer::PassTime> passes;
+        Profiler* pProfiler = mpRenderer->getDevice()->getProfiler();
+        if (pProfiler->isEnabled())
+        {
+            for (const Profiler::Event* pEvent : pProfiler->getEvents())
+            {
+                passes.push_back({ pEvent->getName(), pEvent->getCpuTime(), pEvent->getGpuTime() });
+            }
+        }
+
+        mpFrameStats->recordFrame(frame, frameRate.getLastFrameTime() * 1000.0, passes);
+    }
+
+    void TimingCapture::writeFrameStats()
+    {
+        if (!mpFrameStats) return;
+
+        try
+        {
+            mpFrameStats->writeSummary(mFrameStatsPath);
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to write frame statistics: {}", e.what());
+        }
+
+        if (const auto& pDevice = mpRenderer->getDevice()) pDevice->getProfiler()->setEnabled(mProfilerWasEnabled);
+        mpFrameStats.reset();
+        mFrameStatsPath.clear();
+    }
+
+    std::string TimingCapture::getFrameStats() const
+    {
+        return mpFrameStats ? mpFrameStats->getSummaryJson() : std::string();
+    }
 }
@@ -27,14 +27,17 @@
  **************************************************************************/
 #pragma once
 #include "../../Mogwai.h"
+#include "Utils/Metrics.h"
+#include "Utils/Timing/FrameTimingAnalyzer.h"
 #include <fstream>
+#include <vector>
 
 namespace Mogwai
 {
     class TimingCapture : public Extension
     {
     public:
-        virtual ~TimingCapture() = default;
+        virtual ~TimingCapture();
         static UniquePtr create(Renderer* pRenderer);
 
         virtual void beginFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
@@ -49,6 +52,31 @@ namespace Mogwai
         void captureFrameTime(std::filesystem::path path);
         void recordPreviousFrameTime();
 
+        /** Start capture of the per-frame metrics samples, or end capture and write the file if path is empty.
+            The file is written as JSON if the extension is .json, and as CSV otherwise.
+        */
+        void captureMetrics(std::filesystem::path path);
+        void recordPreviousMetricsSample();
+        void writeMetrics();
+
+        /** Start capture of frame statistics, or end capture and write the summary if path is empty.
+            The summary contains frame time and per-pass CPU/GPU time percentiles, stutters and their correlation with scene events.
+            \param[in] path Summary JSON file, written when the capture ends.
+            \param[in] framesPath Optional file the per-frame records are streamed to as JSON lines.
+            \param[in] stutterThreshold A frame is a stutter if it takes longer than this multiple of the median frame time.
+        */
+        void captureFrameStats(std::filesystem::path path, std::filesystem::path framesPath, double stutterThreshold);
+        void recordPreviousFrameStats();
+        void writeFrameStats();
+        std::string getFrameStats() const;
+
         std::ofstream   mFrameTimeFile;     ///< Frame times are appended to this file when it's open.
+
+        std::filesystem::path mMetricsPath; ///< Metrics samples are written to this file when the capture ends. Empty if not capturing.
+        std::vector<MetricsRegistry::FrameSample> mMetricsSamples;
+
+        std::unique_ptr<FrameTimingAnalyzer> mpFrameStats; ///< Frame statistics. Null if not capturing.
+        std::filesystem::path mFrameStatsPath;              ///< Frame statistics summary is written to this file when the capture ends.
+        bool mProfilerWasEnabled = false;                   ///< Profiler state before the capture, the profiler is enabled for per-pass times.
     };
 }
@@ -28,6 +28,7 @@
 #include "Falcor.h"
 #include "Mogwai.h"
 #include "MogwaiSettings.h"
+#include "MogwaiBatchRenderer.h"
 #include "GlobalState.h"
 #include "Core/AssetResolver.h"
 #include "Scene/Importer.h"
@@ -135,6 +136,21 @@ namespace Mogwai
             // Add scene to recent files only if not in silent mode (which is used during image tests).
             if (!mOptions.silentMode) mAppData.addRecentScene(mOptions.sceneFile);
         }
+
+        // Run batch jobs provided via command line and exit.
+        if (!mOptions.batchFile.empty())
+        {
+            bool success = false;
+            try
+            {
+                success = MogwaiBatchRenderer::runJobFile(this, mOptions.batchFile, mOptions.batchReportFile);
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to run batch jobs: {}", e.what());
+            }
+            shutdown(success ? 0 : 1);
+        }
     }
 
     void Renderer::onOptionsChange()
@@ -535,17 +551,11 @@ namespace Mogwai
 
     void Renderer::loadScene(std::filesystem::path path, SceneBuilder::Flags buildFlags)
     {
-        if (mOptions.useSceneCache) buildFlags |= SceneBuilder::Flags::UseCache;
-        if (mOptions.rebuildSceneCache) buildFlags |= SceneBuilder::Flags::RebuildCache;
-
         while (true)
         {
             try
             {
-                TimeReport timeReport;
-                setScene(SceneBuilder(getDevice(), path, getSettings(), buildFlags).getScene());
-                timeReport.measure("Loading scene (total)");
-                timeReport.printToLog();
+                setScene(createScene(path, buildFlags));
                 return;
             }
             catch (const ImporterError &e)
@@ -564,6 +574,18 @@ namespace Mogwai
         }
     }
 
+    ref<Scene> Renderer::createScene(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
+    {
+        if (mOptions.useSceneCache) buildFlags |= SceneBuilder::Flags::UseCache;
+        if (mOptions.rebuildSceneCache) buildFlags |= SceneBuilder::Flags::RebuildCache;
+
+        TimeReport timeReport;
+        auto pScene = SceneBuilder(getDevice(), path, getSettings(), buildFlags).getScene();
+        timeReport.measure("Loading scene (total)");
+        timeReport.printToLog();
+        return pScene;
+    }
+
     void Renderer::unloadScene()
     {
         setScene(nullptr);
@@ -835,6 +857,8 @@ int runMain(int argc, char** argv)
     args::ValueFlag<std::string> scriptFlag(parser, "path", "Python script file to run.", {'s', "script"});
     args::Flag deferredFlag(parser, "deferred", "The script is loaded deferred.", {"deferred"});
     args::ValueFlag<std::string> sceneFlag(parser, "path", "Scene file (for example, a .pyscene file) to open.", { 'S', "scene" });
+    args::ValueFlag<std::string> batchFlag(parser, "path", "Batch job file (.json) to run. Exits when all jobs are done.", { "batch" });
+    args::ValueFlag<std::string> batchReportFlag(parser, "path", "File to write the batch job report (.json) to.", { "batch-report" });
     args::ValueFlag<std::string> shaderCacheFlag(parser, "shadercache", "Path to the GFX shader cache.", { "shadercache" });
     args::ValueFlag<std::string> logfileFlag(parser, "path", "File to write log into.", {'l', "logfile"});
     args::ValueFlag<int32_t> verbosityFlag(parser, "verbosity", "Logging verbosity (0=disabled, 1=fatal errors, 2=errors, 3=warnings, 4=infos, 5=debugging)", { 'v', "verbosity" }, 4);
@@ -946,6 +970,8 @@ int runMain(int argc, char** argv)
     if (silentFlag) options.silentMode = true;
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
+    if (batchFlag) options.batchFile = args::get(batchFlag);
+    if (batchReportFlag) options.batchReportFile = args::get(batchReportFlag);
 
     Mogwai::Renderer renderer(config, options);
     return renderer.run();
@@ -87,6 +87,8 @@ namespace Mogwai
             bool silentMode = false;
             bool useSceneCache = false;
             bool rebuildSceneCache = false;
+            std::string batchFile;          ///< Batch job file to run. Mogwai exits when all jobs are done.
+            std::string batchReportFile;    ///< File to write the batch job report to.
         };
 
         using KeyCallback = std::function<bool(bool pressed, uint32_t key)>;
@@ -165,6 +167,7 @@ namespace Mogwai
         void removeActiveGraph();
         void loadSceneDialog();
         void loadScene(std::filesystem::path path, SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default);
+        ref<Scene> createScene(const std::filesystem::path& path, SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default);
         void unloadScene();
         void setScene(const ref<Scene>& pScene);
         ref<Scene> getScene() const;
@@ -0,0 +1,237 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MogwaiBatchRenderer.h"
+#include "Extensions/Capture/FrameCapture.h"
+#include "Core/AssetResolver.h"
+#include "RenderGraph/RenderGraphImportExport.h"
+
+namespace Mogwai
+{
+    MogwaiBatchRenderer::MogwaiBatchRenderer(Renderer* pRenderer)
+        : mpRenderer(pRenderer)
+    {
+        for (const auto& pExtension : mpRenderer->getExtensions())
+        {
+            if (auto pFrameCapture = dynamic_cast<FrameCapture*>(pExtension.get())) mpFrameCapture = pFrameCapture;
+        }
+    }
+
+    void MogwaiBatchRenderer::loadScene(const std::filesystem::path& path)
+    {
+        mScenes[path.lexically_normal()] = mpRenderer->createScene(path);
+    }
+
+    void MogwaiBatchRenderer::unloadScene(const std::filesystem::path& path)
+    {
+        auto it = mScenes.find(path.lexically_normal());
+        if (it == mScenes.end()) return;
+        if (mpRenderer->getScene() == it->second) mpRenderer->setScene(nullptr);
+        mScenes.erase(it);
+    }
+
+    void MogwaiBatchRenderer::setActiveScene(const std::filesystem::path& path)
+    {
+        ref<Scene> pScene;
+        if (!path.empty())
+        {
+            auto it = mScenes.find(path.lexically_normal());
+            FALCOR_CHECK(it != mScenes.end(), "Scene '{}' is not loaded.", path);
+            pScene = it->second;
+        }
+        // Switching scenes resets the scene of all graphs, only do it when needed.
+        if (mpRenderer->getScene() != pScene) mpRenderer->setScene(pScene);
+    }
+
+    void MogwaiBatchRenderer::loadGraph(const std::filesystem::path& path, const std::string& name)
+    {
+        ref<RenderGraph> pGraph;
+        for (const auto& pImported : RenderGraphImporter::importAllGraphs(path))
+        {
+            if (name.empty() || pImported->getName() == name)
+            {
+                pGraph = pImported;
+                break;
+            }
+        }
+        if (!pGraph)
+        {
+            if (name.empty()) FALCOR_THROW("Render graph file '{}' does not contain any graph.", path);
+            else FALCOR_THROW("Render graph file '{}' does not contain a graph named '{}'.", path, name);
+        }
+        mGraphs[{path.lexically_normal(), name}] = pGraph;
+    }
+
+    void MogwaiBatchRenderer::unloadGraph(const std::filesystem::path& path, const std::string& name)
+    {
+        auto it = mGraphs.find({path.lexically_normal(), name});
+        if (it == mGraphs.end()) return;
+        if (mpRenderer->getGraph(it->second->getName()) == it->second) mpRenderer->removeGraph(it->second);
+        mGraphs.erase(it);
+    }
+
+    void MogwaiBatchRenderer::setActiveGraph(const std::filesystem::path& path, const std::string& name)
+    {
+        const ref<RenderGraph>& pGraph = getGraph(path, name);
+
+        // The renderer identifies graphs by name, remove a different graph with the same name first.
+        auto pExisting = mpRenderer->getGraph(pGraph->getName());
+        if (pExisting && pExisting != pGraph) mpRenderer->removeGraph(pExisting);
+
+        mpRenderer->setActiveGraph(pGraph);
+    }
+
+    void MogwaiBatchRenderer::beginJob(const BatchJob& job)
+    {
+        FALCOR_CHECK(mpFrameCapture, "Batch rendering requires the frame capture extension.");
+
+        const auto& pFbo = mpRenderer->getTargetFbo();
+        if (job.width != 0 && (pFbo->getWidth() != job.width || pFbo->getHeight() != job.height))
+        {
+            mpRenderer->resizeFrameBuffer(job.width, job.height);
+        }
+        mpRenderer->toggleUI(false);
+
+        mpRenderer->getGlobalClock().setFramerate(job.framerate);
+        mpRenderer->getGlobalClock().setTime(0);
+        mpRenderer->getGlobalClock().pause();
+
+        if (!job.camera.empty())
+        {
+            auto pScene = mpRenderer->getScene();
+            FALCOR_CHECK(pScene, "Job '{}' selects a camera but has no scene.", job.name);
+            const auto& cameras = pScene->getCameras();
+            auto it = std::find_if(cameras.begin(), cameras.end(), [&](const ref<Camera>& pCamera) { return pCamera->getName() == job.camera; });
+            FALCOR_CHECK(it != cameras.end(), "Scene has no camera named '{}'.", job.camera);
+            pScene->selectCamera((uint32_t)(it - cameras.begin()));
+        }
+
+        std::filesystem::create_directories(job.outputDirectory);
+        mpFrameCapture->setOutputDirectory(job.outputDirectory);
+        mpFrameCapture->setBaseFilename(job.baseFilename.empty() ? job.name : job.baseFilename);
+
+        // Capture only the requested outputs, the original outputs are restored when the job ends.
+        mpJobGraph = mpRenderer->mGraphs[mpRenderer->getActiveGraphIndex()].pGraph;
+        if (!job.outputs.empty())
+        {
+            mSavedOutputs.clear();
+            for (size_t i = 0; i < mpJobGraph->getOutputCount(); i++)
+            {
+                mSavedOutputs.push_back({mpJobGraph->getOutputName(i), mpJobGraph->getOutputMasks(i)});
+            }
+            mOutputsChanged = true;
+            try
+            {
+                for (const auto& output : mSavedOutputs) mpJobGraph->unmarkOutput(output.name);
+                for (const auto& output : job.outputs) mpJobGraph->markOutput(output);
+            }
+            catch (...)
+            {
+                restoreOutputs();
+                throw;
+            }
+        }
+    }
+
+    void MogwaiBatchRenderer::renderFrame(const BatchJob& job, uint64_t frame)
+    {
+        mpRenderer->getGlobalClock().setFrame(frame);
+        mpRenderer->renderFrame();
+    }
+
+    void MogwaiBatchRenderer::captureFrame(const BatchJob& job, uint64_t frame)
+    {
+        mpFrameCapture->capture();
+    }
+
+    void MogwaiBatchRenderer::endJob(const BatchJob& job)
+    {
+        // Restore the outputs even if writing the images failed.
+        try
+        {
+            mpFrameCapture->flush();
+        }
+        catch (...)
+        {
+            restoreOutputs();
+            throw;
+        }
+        restoreOutputs();
+    }
+
+    bool MogwaiBatchRenderer::runJobFile(Renderer* pRenderer, const std::filesystem::path& path, const std::filesystem::path& reportPath)
+    {
+        BatchScheduler::Options options;
+        auto jobs = BatchScheduler::loadJobs(path, options);
+
+        // Add job file directory to search paths (add it to the front to make it highest priority).
+        AssetResolver oldResolver = AssetResolver::getDefaultResolver();
+        AssetResolver::getDefaultResolver().addSearchPath(std::filesystem::absolute(path).parent_path(), SearchPathPriority::First);
+
+        MogwaiBatchRenderer renderer(pRenderer);
+        BatchScheduler scheduler(options);
+        std::vector<BatchScheduler::JobResult> results;
+
+        // Restore asset resolver even if running the jobs failed.
+        try
+        {
+            results = scheduler.run(renderer, jobs);
+            scheduler.releaseAll(renderer);
+        }
+        catch (...)
+        {
+            AssetResolver::getDefaultResolver() = oldResolver;
+            throw;
+        }
+        AssetResolver::getDefaultResolver() = oldResolver;
+
+        if (!reportPath.empty()) scheduler.writeReport(reportPath, results);
+        return scheduler.getStats().failedCount == 0;
+    }
+
+    const ref<RenderGraph>& MogwaiBatchRenderer::getGraph(const std::filesystem::path& path, const std::string& name) const
+    {
+        auto it = mGraphs.find({path.lexically_normal(), name});
+        FALCOR_CHECK(it != mGraphs.end(), "Render graph '{}' is not loaded.", path);
+        return it->second;
+    }
+
+    void MogwaiBatchRenderer::restoreOutputs()
+    {
+        if (mOutputsChanged)
+        {
+            while (mpJobGraph->getOutputCount() > 0) mpJobGraph->unmarkOutput(mpJobGraph->getOutputName(0));
+            for (const auto& output : mSavedOutputs)
+            {
+                for (auto mask : output.masks) mpJobGraph->markOutput(output.name, mask);
+            }
+            mSavedOutputs.clear();
+            mOutputsChanged = false;
+        }
+        mpJobGraph = nullptr;
+    }
+}
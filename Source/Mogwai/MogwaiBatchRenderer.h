@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Mogwai.h"
+#include "Utils/BatchScheduler.h"
+#include <map>
+
+namespace Mogwai
+{
+    class FrameCapture;
+
+    /** Executes batch jobs with the Mogwai renderer.
+        Scenes and render graphs stay loaded in the renderer for as long as the scheduler keeps them resident,
+        the device, shader programs and pipeline states are shared by all jobs.
+        Images are captured with the frame capture extension.
+    */
+    class MogwaiBatchRenderer : public BatchRenderer
+    {
+    public:
+        MogwaiBatchRenderer(Renderer* pRenderer);
+
+        void loadScene(const std::filesystem::path& path) override;
+        void unloadScene(const std::filesystem::path& path) override;
+        void setActiveScene(const std::filesystem::path& path) override;
+
+        void loadGraph(const std::filesystem::path& path, const std::string& name) override;
+        void unloadGraph(const std::filesystem::path& path, const std::string& name) override;
+        void setActiveGraph(const std::filesystem::path& path, const std::string& name) override;
+
+        void beginJob(const BatchJob& job) override;
+        void renderFrame(const BatchJob& job, uint64_t frame) override;
+        void captureFrame(const BatchJob& job, uint64_t frame) override;
+        void endJob(const BatchJob& job) override;
+
+        /** Run the jobs of a job file, write the report and release all scenes and graphs.
+            \param[in] path Job file.
+            \param[in] reportPath Report file. Empty to not write a report.
+            \return True if all jobs succeeded.
+        */
+        static bool runJobFile(Renderer* pRenderer, const std::filesystem::path& path, const std::filesystem::path& reportPath);
+
+    private:
+        struct OutputState
+        {
+            std::string name;
+            std::unordered_set<TextureChannelFlags> masks;
+        };
+
+        const ref<RenderGraph>& getGraph(const std::filesystem::path& path, const std::string& name) const;
+        void restoreOutputs();
+
+        Renderer* mpRenderer;
+        FrameCapture* mpFrameCapture = nullptr;
+        std::map<std::filesystem::path, ref<Scene>> mScenes;
+        std::map<std::pair<std::filesystem::path, std::string>, ref<RenderGraph>> mGraphs;
+
+        ref<RenderGraph> mpJobGraph;            ///< Graph of the current job.
+        std::vector<OutputState> mSavedOutputs; ///< Outputs of the graph before the job changed them.
+        bool mOutputsChanged = false;
+    };
+}
@@ -56,6 +56,18 @@ int runMain(int argc, char** argv)
     args::ValueFlag<std::string> tagFilterFlag(parser, "tags", "Filter test cases by tags.", {'t', "tags"});
     args::ValueFlag<std::string> xmlReportFlag(parser, "path", "XML report output file.", {'x', "xml-report"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
+    args::Flag benchmarkFlag(parser, "", "Run benchmarks instead of tests.", {'b', "benchmark"});
+    args::ValueFlag<uint32_t> benchmarkWarmupFlag(parser, "N", "Number of warmup iterations of each benchmark.", {"benchmark-warmup"});
+    args::ValueFlag<uint32_t> benchmarkIterationsFlag(
+        parser, "N", "Number of timed iterations of each benchmark.", {"benchmark-iterations"}
+    );
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "JSON benchmark report output file.", {"benchmark-report"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(
+        parser, "path", "JSON benchmark report to compare against, regressions are reported as failures.", {"benchmark-baseline"}
+    );
+    args::ValueFlag<double> benchmarkThresholdFlag(
+        parser, "fraction", "Relative slowdown over the baseline that is reported as a failure (default: 0.1).", {"benchmark-threshold"}
+    );
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
 
@@ -129,6 +141,18 @@ int runMain(int argc, char** argv)
         options.parallel = args::get(parallelFlag);
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
+    if (benchmarkFlag)
+        options.benchmark = true;
+    if (benchmarkWarmupFlag)
+        options.benchmarkWarmup = args::get(benchmarkWarmupFlag);
+    if (benchmarkIterationsFlag)
+        options.benchmarkIterations = args::get(benchmarkIterationsFlag);
+    if (benchmarkReportFlag)
+        options.benchmarkReportPath = args::get(benchmarkReportFlag);
+    if (benchmarkBaselineFlag)
+        options.benchmarkBaselinePath = args::get(benchmarkBaselineFlag);
+    if (benchmarkThresholdFlag)
+        options.benchmarkRegressionThreshold = args::get(benchmarkThresholdFlag);
 
     if (listTestSuites || listTestCases || listTags)
     {
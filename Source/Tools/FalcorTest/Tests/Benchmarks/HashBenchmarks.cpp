@@ -0,0 +1,118 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/CryptoUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const size_t kDataSize = 64 * 1024 * 1024;
+
+std::vector<uint8_t> createData(size_t size)
+{
+    std::mt19937_64 rng(1);
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i + 8 <= size; i += 8)
+    {
+        uint64_t value = rng();
+        std::memcpy(&data[i], &value, sizeof(value));
+    }
+    return data;
+}
+} // namespace
+
+CPU_BENCHMARK(HashSHA1, BENCHMARK_ITERATIONS(5))
+{
+    const std::vector<uint8_t> data = createData(kDataSize);
+    const bool wasEnabled = SHA1::isHardwareAccelerationEnabled();
+    auto hash = [&]() { doNotOptimize(SHA1::compute(data.data(), data.size())); };
+
+    SHA1::setHardwareAccelerationEnabled(false);
+    ctx.measure("portable", hash, data.size());
+    if (SHA1::isHardwareAccelerationSupported())
+    {
+        SHA1::setHardwareAccelerationEnabled(true);
+        ctx.measure("hardware", hash, data.size());
+    }
+    SHA1::setHardwareAccelerationEnabled(wasEnabled);
+}
+
+CPU_BENCHMARK(HashXXH3, BENCHMARK_ITERATIONS(5))
+{
+    const std::vector<uint8_t> data = createData(kDataSize);
+
+    ctx.measure("hash64", [&]() { doNotOptimize(XXH3::hash64(data.data(), data.size())); }, data.size());
+    ctx.measure("hash128", [&]() { doNotOptimize(XXH3::hash128(data.data(), data.size())); }, data.size());
+    ctx.measure(
+        "streaming",
+        [&]()
+        {
+            // Feed the data in 64 kB blocks, like reading a file.
+            XXH3 xxh3;
+            for (size_t offset = 0; offset < data.size(); offset += 65536)
+                xxh3.update(data.data() + offset, std::min<size_t>(65536, data.size() - offset));
+            doNotOptimize(xxh3.digest128());
+        },
+        data.size()
+    );
+    ctx.measure("tree", [&]() { doNotOptimize(XXH3::hashTree128(data.data(), data.size())); }, data.size());
+}
+
+CPU_BENCHMARK(HashSmallKeys)
+{
+    // Typical keys of deduplication tables.
+    const std::vector<uint8_t> data = createData(64 * 1024);
+    const size_t kKeySize = 32;
+    const size_t keyCount = data.size() / kKeySize;
+
+    ctx.measure(
+        "sha1",
+        [&]()
+        {
+            for (size_t i = 0; i < keyCount; i++)
+                doNotOptimize(SHA1::compute(data.data() + i * kKeySize, kKeySize));
+        },
+        keyCount
+    );
+    ctx.measure(
+        "xxh3",
+        [&]()
+        {
+            for (size_t i = 0; i < keyCount; i++)
+                doNotOptimize(XXH3::hash64(data.data() + i * kKeySize, kKeySize));
+        },
+        keyCount
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,173 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageDecoder.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 2048;
+const uint32_t kHeight = 2048;
+
+/// Smooth gradient with some noise, which compresses roughly like a natural image.
+template<typename T>
+std::vector<T> createImageData(float scale)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    std::vector<T> data(size_t(kWidth) * kHeight * 4);
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++)
+        {
+            T* pPixel = &data[(size_t(y) * kWidth + x) * 4];
+            float u = float(x) / kWidth;
+            float v = float(y) / kHeight;
+            pPixel[0] = T(std::clamp(u + noise(rng), 0.f, 1.f) * scale);
+            pPixel[1] = T(std::clamp(v + noise(rng), 0.f, 1.f) * scale);
+            pPixel[2] = T(std::clamp(0.5f * (u + v) + noise(rng), 0.f, 1.f) * scale);
+            pPixel[3] = T(scale);
+        }
+    }
+    return data;
+}
+
+bool isEqual(const Bitmap& a, const Bitmap& b)
+{
+    return a.getFormat() == b.getFormat() && a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() &&
+           std::equal(a.getData(), a.getData() + a.getSize(), b.getData());
+}
+
+/**
+ * Measure decoding an image file with the fast decoder and with FreeImage.
+ * Files without a fast decoder are only measured once. Fails if the fast decoder doesn't produce the same bitmap as FreeImage.
+ */
+void measureDecode(
+    UnitTestContext& ctx,
+    const std::string& name,
+    const std::filesystem::path& path,
+    Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+)
+{
+    const bool wasEnabled = ImageDecoder::isEnabled();
+    auto decode = [&]()
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true, importFlags);
+        FALCOR_CHECK(pBitmap != nullptr, "Failed to decode '{}'.", path);
+        doNotOptimize(pBitmap);
+    };
+
+    ImageDecoder::setEnabled(true);
+    const bool hasFastPath = ImageDecoder::decode(path, true, importFlags) != nullptr;
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true, importFlags);
+    ImageDecoder::setEnabled(false);
+    Bitmap::UniqueConstPtr pReference = Bitmap::createFromFile(path, true, importFlags);
+    FALCOR_CHECK(pBitmap && pReference && isEqual(*pBitmap, *pReference), "Decoded '{}' doesn't match FreeImage.", path);
+
+    if (hasFastPath)
+    {
+        ImageDecoder::setEnabled(true);
+        ctx.measure(name + "/fast", decode, uint64_t(kWidth) * kHeight);
+        ImageDecoder::setEnabled(false);
+        ctx.measure(name + "/freeimage", decode, uint64_t(kWidth) * kHeight);
+    }
+    else
+    {
+        ctx.measure(name, decode, uint64_t(kWidth) * kHeight);
+    }
+    ImageDecoder::setEnabled(wasEnabled);
+}
+} // namespace
+
+CPU_BENCHMARK(BitmapDecodePNG, BENCHMARK_ITERATIONS(5))
+{
+    const auto path = getRuntimeDirectory() / "benchmark_decode.png";
+    std::vector<uint8_t> data = createImageData<uint8_t>(255.f);
+    Bitmap::saveImage(
+        path, kWidth, kHeight, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, data.data()
+    );
+
+    measureDecode(ctx, "rgba8", path);
+
+    Bitmap::saveImage(
+        path, kWidth, kHeight, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data()
+    );
+    measureDecode(ctx, "rgb8", path);
+
+    std::filesystem::remove(path);
+}
+
+CPU_BENCHMARK(BitmapDecodeJPEG, BENCHMARK_ITERATIONS(5))
+{
+    // JPEG files are decoded by FreeImage, this measures the expansion of the 24-bit data into the bitmap.
+    const auto path = getRuntimeDirectory() / "benchmark_decode.jpg";
+    std::vector<uint8_t> data = createImageData<uint8_t>(255.f);
+    Bitmap::saveImage(
+        path, kWidth, kHeight, Bitmap::FileFormat::JpegFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data()
+    );
+
+    measureDecode(ctx, "rgb8", path);
+
+    std::filesystem::remove(path);
+}
+
+CPU_BENCHMARK(BitmapDecodeEXR, BENCHMARK_ITERATIONS(5))
+{
+    const auto path = getRuntimeDirectory() / "benchmark_decode.exr";
+    std::vector<float> data = createImageData<float>(4.f);
+
+    // Half channels with the default compression.
+    Bitmap::saveImage(
+        path, kWidth, kHeight, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA32Float, true, data.data()
+    );
+    measureDecode(ctx, "rgba16f", path);
+    measureDecode(ctx, "rgba16f-to-float16", path, Bitmap::ImportFlags::ConvertToFloat16);
+
+    // Uncompressed float channels.
+    Bitmap::saveImage(
+        path,
+        kWidth,
+        kHeight,
+        Bitmap::FileFormat::ExrFile,
+        Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::Uncompressed,
+        ResourceFormat::RGBA32Float,
+        true,
+        data.data()
+    );
+    measureDecode(ctx, "rgba32f", path);
+    measureDecode(ctx, "rgba32f-to-float16", path, Bitmap::ImportFlags::ConvertToFloat16);
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Quaternion.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kCount = 1 << 20;
+
+std::vector<float4x4> createRandomTransforms(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<float4x4> transforms(count);
+    for (auto& m : transforms)
+    {
+        float3 axis = normalize(float3(dist(rng), dist(rng), dist(rng)) + float3(0.f, 0.f, 2.f));
+        m = mul(matrixFromTranslation(float3(dist(rng), dist(rng), dist(rng)) * 100.f), matrixFromRotation(dist(rng) * 3.14f, axis));
+        m = mul(m, matrixFromScaling(float3(1.f + 0.5f * dist(rng))));
+    }
+    return transforms;
+}
+} // namespace
+
+CPU_BENCHMARK(MatrixMath)
+{
+    std::vector<float4x4> transforms = createRandomTransforms(kCount, 1);
+    std::vector<float4x4> result(kCount);
+    std::vector<float3> points(kCount);
+
+    ctx.measure(
+        "mul",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                result[i] = mul(transforms[i], transforms[kCount - 1 - i]);
+            doNotOptimize(result[kCount / 2]);
+        },
+        kCount
+    );
+
+    ctx.measure(
+        "transformPoint",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                points[i] = transformPoint(transforms[i], float3(float(i)));
+            doNotOptimize(points[kCount / 2]);
+        },
+        kCount
+    );
+
+    ctx.measure(
+        "inverse",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                result[i] = inverse(transforms[i]);
+            doNotOptimize(result[kCount / 2]);
+        },
+        kCount
+    );
+}
+
+CPU_BENCHMARK(QuaternionMath)
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<quatf> quats(kCount);
+    for (auto& q : quats)
+        q = normalize(quatf(dist(rng), dist(rng), dist(rng), dist(rng)));
+    std::vector<quatf> result(kCount);
+    std::vector<float3> vectors(kCount);
+
+    ctx.measure(
+        "mul",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                result[i] = mul(quats[i], quats[kCount - 1 - i]);
+            doNotOptimize(result[kCount / 2]);
+        },
+        kCount
+    );
+
+    ctx.measure(
+        "transformVector",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                vectors[i] = transformVector(quats[i], float3(1.f, 0.f, 0.f));
+            doNotOptimize(vectors[kCount / 2]);
+        },
+        kCount
+    );
+
+    ctx.measure(
+        "slerp",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                result[i] = slerp(quats[i], quats[kCount - 1 - i], 0.25f);
+            doNotOptimize(result[kCount / 2]);
+        },
+        kCount
+    );
+}
+
+CPU_BENCHMARK(AABBTransform)
+{
+    std::vector<float4x4> transforms = createRandomTransforms(kCount, 3);
+    std::vector<AABB> result(kCount);
+    const AABB aabb(float3(-1.f, -2.f, -3.f), float3(3.f, 2.f, 1.f));
+
+    ctx.measure(
+        "transform",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                result[i] = aabb.transform(transforms[i]);
+            doNotOptimize(result[kCount / 2]);
+        },
+        kCount
+    );
+}
+
+CPU_BENCHMARK(Float16Conversion)
+{
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::vector<float> values(kCount);
+    for (auto& v : values)
+        v = dist(rng);
+    std::vector<float16_t> halfs(kCount);
+
+    ctx.measure(
+        "toFloat16",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                halfs[i] = float16_t(values[i]);
+            doNotOptimize(halfs[kCount / 2]);
+        },
+        kCount
+    );
+
+    ctx.measure(
+        "toFloat32",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kCount; i++)
+                values[i] = float(halfs[i]);
+            doNotOptimize(values[kCount / 2]);
+        },
+        kCount
+    );
+}
+} // namespace Falcor
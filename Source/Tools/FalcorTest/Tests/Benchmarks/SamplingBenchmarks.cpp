@@ -0,0 +1,52 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Sampling/AliasTable.h"
+
+#include <random>
+
+namespace Falcor
+{
+GPU_BENCHMARK(AliasTable, BENCHMARK_ITERATIONS(5))
+{
+    for (uint32_t count : {1u << 16, 1u << 20, 1u << 24})
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+        std::vector<float> weights(count);
+        for (auto& w : weights)
+            w = dist(rng);
+
+        // Copy the weights in the setup to exclude the copy from the measurement.
+        std::vector<float> weightsCopy;
+        auto setup = [&]() { weightsCopy = weights; };
+        auto create = [&]() { doNotOptimize(AliasTable(ctx.getDevice(), std::move(weightsCopy), rng)); };
+        ctx.measure(fmt::format("create{}", count), setup, create, count);
+    }
+}
+} // namespace Falcor
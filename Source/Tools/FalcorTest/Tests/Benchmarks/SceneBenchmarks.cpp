@@ -0,0 +1,245 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Scene/InstanceBVH.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/TriangleMesh.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <memory>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInstanceCount = 1 << 21;
+const uint32_t kQueryCount = 1000;
+
+/// Random instance bounds with roughly constant density, i.e. the extent of the scene grows with the instance count.
+std::vector<AABB> createInstanceBounds(uint32_t count, uint32_t seed)
+{
+    const float extent = 2.f * std::cbrt(float(count));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> posDist(-extent, extent);
+    std::uniform_real_distribution<float> sizeDist(0.1f, 1.f);
+
+    std::vector<AABB> bounds(count);
+    for (auto& aabb : bounds)
+    {
+        float3 center(posDist(rng), posDist(rng), posDist(rng));
+        float3 halfExtent(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+        aabb = AABB(center - halfExtent, center + halfExtent);
+    }
+    return bounds;
+}
+
+/// Frustum made up of the six planes of an axis-aligned box.
+InstanceBVH::Frustum boxFrustum(const AABB& box)
+{
+    return {
+        float4(1.f, 0.f, 0.f, -box.minPoint.x), float4(-1.f, 0.f, 0.f, box.maxPoint.x),
+        float4(0.f, 1.f, 0.f, -box.minPoint.y), float4(0.f, -1.f, 0.f, box.maxPoint.y),
+        float4(0.f, 0.f, 1.f, -box.minPoint.z), float4(0.f, 0.f, -1.f, box.maxPoint.z),
+    };
+}
+
+/**
+ * Add a procedural scene of spheres and cubes to a scene builder.
+ * @param[in] builder Scene builder.
+ * @param[in] meshCount Number of unique meshes.
+ * @param[in] instanceCount Number of mesh instances.
+ * @param[in] emissive If true, all materials are emissive.
+ */
+void addProceduralScene(SceneBuilder& builder, uint32_t meshCount, uint32_t instanceCount, bool emissive)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> posDist(-100.f, 100.f);
+
+    std::vector<MeshID> meshIDs;
+    for (uint32_t i = 0; i < meshCount; i++)
+    {
+        auto pMaterial = StandardMaterial::create(builder.getDevice(), fmt::format("Material{}", i));
+        if (emissive)
+        {
+            pMaterial->setEmissiveColor(float3(1.f));
+            pMaterial->setEmissiveFactor(1.f + i);
+        }
+        auto pMesh = i % 2 == 0 ? TriangleMesh::createSphere(0.5f, 32, 16) : TriangleMesh::createCube();
+        meshIDs.push_back(builder.addTriangleMesh(pMesh, pMaterial));
+    }
+
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        float4x4 transform = matrixFromTranslation(float3(posDist(rng), posDist(rng), posDist(rng)));
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i), transform});
+        builder.addMeshInstance(nodeID, meshIDs[i % meshCount]);
+    }
+}
+
+/// Write an OBJ file with a number of separate cubes.
+void writeCubesObj(const std::filesystem::path& path, uint32_t cubeCount)
+{
+    std::ofstream ofs(path, std::ios::trunc);
+    for (uint32_t i = 0; i < cubeCount; i++)
+    {
+        float3 p(float(i % 32) * 2.f, float((i / 32) % 32) * 2.f, float(i / 1024) * 2.f);
+        ofs << fmt::format("o Cube{}\n", i);
+        for (uint32_t v = 0; v < 8; v++)
+            ofs << fmt::format("v {} {} {}\n", p.x + (v & 1), p.y + ((v >> 1) & 1), p.z + ((v >> 2) & 1));
+        const uint32_t base = i * 8 + 1;
+        const uint32_t faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        for (const auto& f : faces)
+            ofs << fmt::format("f {} {} {} {}\n", base + f[0], base + f[1], base + f[2], base + f[3]);
+    }
+}
+} // namespace
+
+CPU_BENCHMARK(InstanceBVH, BENCHMARK_ITERATIONS(5))
+{
+    std::vector<AABB> bounds = createInstanceBounds(kInstanceCount, 1);
+
+    InstanceBVH bvh;
+    ctx.measure("build", [&]() { bvh.build(bounds); }, kInstanceCount);
+
+    // Move all instances by a small offset and refit.
+    std::vector<AABB> moved = bounds;
+    for (auto& aabb : moved)
+        aabb = AABB(aabb.minPoint + float3(0.1f), aabb.maxPoint + float3(0.1f));
+    ctx.measure("refit", [&]() { bvh.refit(moved); }, kInstanceCount);
+
+    std::mt19937 rng(2);
+    const AABB sceneBounds = bvh.getBounds();
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    auto randomPoint = [&]() { return sceneBounds.minPoint + float3(u(rng), u(rng), u(rng)) * sceneBounds.extent(); };
+
+    std::vector<AABB> queryBoxes(kQueryCount);
+    std::vector<Ray> queryRays(kQueryCount);
+    for (uint32_t i = 0; i < kQueryCount; i++)
+    {
+        float3 center = randomPoint();
+        queryBoxes[i] = AABB(center - float3(5.f), center + float3(5.f));
+        queryRays[i] = Ray(center, normalize(float3(u(rng), u(rng), u(rng)) - float3(0.5f)));
+    }
+
+    std::vector<uint32_t> result;
+    ctx.measure(
+        "queryAABB",
+        [&]()
+        {
+            for (const auto& box : queryBoxes)
+                bvh.queryAABB(box, result);
+            doNotOptimize(result);
+        },
+        kQueryCount
+    );
+
+    ctx.measure(
+        "queryFrustum",
+        [&]()
+        {
+            for (const auto& box : queryBoxes)
+                bvh.queryFrustum(boxFrustum(box), result);
+            doNotOptimize(result);
+        },
+        kQueryCount
+    );
+
+    InstanceBVH::RayHit hit;
+    ctx.measure(
+        "queryClosest",
+        [&]()
+        {
+            uint32_t hitCount = 0;
+            for (const auto& ray : queryRays)
+                hitCount += bvh.queryClosest(ray, hit) ? 1 : 0;
+            doNotOptimize(hitCount);
+        },
+        kQueryCount
+    );
+}
+
+GPU_BENCHMARK(SceneBuilder, BENCHMARK_ITERATIONS(5))
+{
+    const uint32_t kMeshCount = 64;
+    const uint32_t kMeshInstanceCount = 10000;
+
+    std::unique_ptr<SceneBuilder> pBuilder;
+    ref<Scene> pScene;
+    auto setup = [&]()
+    {
+        pScene = nullptr;
+        pBuilder = std::make_unique<SceneBuilder>(ctx.getDevice(), Settings(), SceneBuilder::Flags::Default);
+        addProceduralScene(*pBuilder, kMeshCount, kMeshInstanceCount, false);
+    };
+    ctx.measure("getScene", setup, [&]() { pScene = pBuilder->getScene(); }, kMeshInstanceCount);
+}
+
+GPU_BENCHMARK(SceneCache, BENCHMARK_ITERATIONS(5))
+{
+    if (!PluginManager::instance().loadPluginByName("AssimpImporter"))
+        ctx.skip("AssimpImporter plugin not available");
+
+    const uint32_t kCubeCount = 4096;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_scene_cache_benchmark.obj";
+    writeCubesObj(path, kCubeCount);
+
+    auto load = [&](SceneBuilder::Flags flags) { doNotOptimize(SceneBuilder(ctx.getDevice(), path, Settings(), flags).getScene()); };
+
+    ctx.measure("import", [&]() { load(SceneBuilder::Flags::Default); }, kCubeCount);
+    ctx.measure("importAndWrite", [&]() { load(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache); }, kCubeCount);
+    ctx.measure("read", [&]() { load(SceneBuilder::Flags::UseCache); }, kCubeCount);
+
+    std::filesystem::remove(path);
+}
+
+GPU_BENCHMARK(LightBVHBuilder, BENCHMARK_ITERATIONS(5))
+{
+    const uint32_t kMeshCount = 16;
+    const uint32_t kMeshInstanceCount = 1000;
+
+    SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::Default);
+    addProceduralScene(builder, kMeshCount, kMeshInstanceCount, true);
+    ref<Scene> pScene = builder.getScene();
+
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    const auto& pLightCollection = pScene->getLightCollection(pRenderContext);
+    const uint64_t triangleCount = pLightCollection->getTotalLightCount();
+
+    LightBVH bvh(ctx.getDevice(), pLightCollection);
+    LightBVHBuilder bvhBuilder(LightBVHBuilder::Options{});
+    ctx.measure("build", [&]() { bvhBuilder.build(pRenderContext, bvh); }, triangleCount);
+    ctx.measureGPU("refit", [&](RenderContext* pContext) { bvh.refit(pContext); }, triangleCount);
+}
+} // namespace Falcor
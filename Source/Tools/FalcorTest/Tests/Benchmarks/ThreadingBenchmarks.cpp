@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <thread>
+
+namespace Falcor
+{
+CPU_BENCHMARK(ThreadingThroughput)
+{
+    const uint32_t kTaskCount = 100000;
+    std::atomic<uint32_t> counter = 0;
+
+    // Dispatch from a single external thread.
+    ctx.measure(
+        "external",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kTaskCount; i++)
+                Threading::dispatchTask([&counter]() { counter++; });
+            Threading::finish();
+        },
+        kTaskCount
+    );
+
+    // Dispatch from within tasks, which pushes to the worker's own queue and relies on stealing to spread the work.
+    ctx.measure(
+        "from_tasks",
+        [&]()
+        {
+            Threading::parallelFor(
+                0,
+                100,
+                [&](uint32_t)
+                {
+                    for (uint32_t i = 0; i < kTaskCount / 100; i++)
+                        Threading::dispatchTask([&counter]() { counter++; });
+                }
+            );
+            Threading::finish();
+        },
+        kTaskCount
+    );
+
+    doNotOptimize(counter.load());
+}
+
+CPU_BENCHMARK(ThreadingLatency)
+{
+    // Time from dispatching a task on an idle scheduler until it starts executing.
+    const uint32_t kDispatchCount = 100;
+    ctx.measure(
+        "dispatch",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kDispatchCount; i++)
+            {
+                std::atomic<bool> started = false;
+                Threading::Task task = Threading::dispatchTask([&started]() { started = true; });
+                // Wait without helping, otherwise the task would usually run on this thread.
+                while (!started)
+                    std::this_thread::yield();
+                while (task.isRunning())
+                    std::this_thread::yield();
+            }
+        },
+        kDispatchCount
+    );
+}
+} // namespace Falcor
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Core/AssetResolver.h"
+#include <algorithm>
 #include <fstream>
 
 namespace Falcor
@@ -191,4 +192,192 @@ CPU_TEST(AssetResolver)
     removeTestFiles(ctx);
 }
 
+CPU_TEST(AssetResolverCache)
+{
+    createTestFiles(ctx);
+
+    const std::filesystem::path unresolved;
+
+    AssetResolver resolver;
+    resolver.addSearchPath(kTestRoot / "media1");
+    resolver.addSearchPath(kTestRoot / "media2");
+    EXPECT(!resolver.isCacheEnabled());
+    resolver.setCacheEnabled(true);
+    EXPECT(resolver.isCacheEnabled());
+
+    // Repeated lookups are answered from the cache.
+    EXPECT_EQ(resolver.resolvePath("asset2"), kTestRoot / "media2/asset2");
+    auto stats = resolver.getCacheStats();
+    EXPECT_EQ(stats.lookups, 1);
+    EXPECT_EQ(stats.hits, 0);
+    EXPECT_GT(stats.probes, 0);
+    const uint64_t probes = stats.probes;
+
+    EXPECT_EQ(resolver.resolvePath("asset2"), kTestRoot / "media2/asset2");
+    stats = resolver.getCacheStats();
+    EXPECT_EQ(stats.lookups, 2);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.probes, probes);
+    EXPECT_EQ(stats.probesAvoided, probes);
+
+    // Unresolved paths are cached until invalidated.
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+    EXPECT_EQ(resolver.getCacheStats().negativeHits, 1);
+    std::ofstream(kTestRoot / "media1/asset3").close();
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+    resolver.invalidateCache(kTestRoot / "media1/asset3");
+    EXPECT_EQ(resolver.resolvePath("asset3"), kTestRoot / "media1/asset3");
+
+    // Copies get their own cache.
+    AssetResolver copy = resolver;
+    EXPECT(copy.isCacheEnabled());
+    EXPECT_EQ(copy.resolvePath("asset2"), kTestRoot / "media2/asset2");
+    EXPECT_EQ(copy.getCacheStats().hits, resolver.getCacheStats().hits + 1);
+
+    // Adding a search path clears the cache.
+    resolver.addSearchPath(kTestRoot / "media3", SearchPathPriority::First);
+    EXPECT_EQ(resolver.resolvePath("asset2"), kTestRoot / "media3/asset2");
+
+    // Without negative caching only resolved paths are cached.
+    resolver.setCacheEnabled(true, false);
+    stats = resolver.getCacheStats();
+    resolver.resolvePath("asset4");
+    resolver.resolvePath("asset4");
+    EXPECT_EQ(resolver.getCacheStats().negativeHits, stats.negativeHits);
+
+    removeTestFiles(ctx);
+}
+
+CPU_TEST(AssetResolverIndex)
+{
+    createTestFiles(ctx);
+
+    const std::filesystem::path unresolved;
+
+    AssetResolver resolver;
+    resolver.addSearchPath(kTestRoot / "media1");
+    resolver.addSearchPath(kTestRoot / "media2");
+    resolver.addSearchPath(kTestRoot / "media4");
+    resolver.addSearchPath(kTestRoot / "media3", SearchPathPriority::Last, AssetCategory::Texture);
+    resolver.indexSearchPaths();
+
+    // Indexed search paths are not probed.
+    auto stats = resolver.getCacheStats();
+    EXPECT_EQ(resolver.resolvePath("asset3", AssetCategory::Texture), kTestRoot / "media3/asset3");
+    EXPECT_EQ(resolver.getCacheStats().probesAvoided - stats.probesAvoided, 1);
+    EXPECT_EQ(resolver.resolvePath("asset2"), kTestRoot / "media2/asset2");
+    EXPECT_EQ(resolver.resolvePath("textures/mip1.png"), kTestRoot / "media4/textures/mip1.png");
+    EXPECT_EQ(resolver.resolvePath("textures/./../textures/mip2.png"), kTestRoot / "media4/textures/mip2.png");
+    EXPECT_EQ(resolver.resolvePath("textures"), kTestRoot / "media4/textures");
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+
+    // Paths leaving the search path are probed.
+    EXPECT_EQ(resolver.resolvePath("../media3/asset3"), kTestRoot / "media3/asset3");
+
+    // New files are found after invalidating them.
+    std::ofstream(kTestRoot / "media2/asset3").close();
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+    resolver.invalidateCache(kTestRoot / "media2/asset3");
+    EXPECT_EQ(resolver.resolvePath("asset3"), kTestRoot / "media2/asset3");
+
+    // Removed files are skipped.
+    resolver.indexSearchPaths();
+    std::filesystem::remove(kTestRoot / "media2/asset3");
+    EXPECT_EQ(resolver.resolvePath("asset3"), unresolved);
+
+    // Search paths with too many files are not indexed, only media1 with a single file is.
+    resolver.indexSearchPaths(1);
+    stats = resolver.getCacheStats();
+    EXPECT_EQ(resolver.resolvePath("textures/mip1.png"), kTestRoot / "media4/textures/mip1.png");
+    EXPECT_EQ(resolver.getCacheStats().probesAvoided - stats.probesAvoided, 1);
+
+    removeTestFiles(ctx);
+}
+
+CPU_TEST(AssetResolverCallback)
+{
+    createTestFiles(ctx);
+
+    struct Lookup
+    {
+        std::filesystem::path resolved;
+        std::vector<std::filesystem::path> missing;
+    };
+    std::vector<Lookup> lookups;
+    AssetResolver resolver;
+    resolver.addSearchPath(kTestRoot / "media1");
+    resolver.addSearchPath(kTestRoot / "media2");
+    resolver.setCacheEnabled(true);
+    resolver.setResolveCallback([&](const std::filesystem::path& resolvedPath, const std::vector<std::filesystem::path>& missingPaths)
+                                { lookups.push_back({resolvedPath, missingPaths}); });
+
+    const std::filesystem::path cwdAsset2 = std::filesystem::absolute("asset2").lexically_normal();
+    const std::filesystem::path cwdAsset4 = std::filesystem::absolute("asset4").lexically_normal();
+
+    // Candidates tried before the resolved path are reported as missing, for cache hits and copies of the resolver too.
+    for (int i = 0; i < 2; i++)
+    {
+        lookups.clear();
+        AssetResolver(resolver).resolvePath("asset2");
+        resolver.resolvePath("asset2");
+        ASSERT_EQ(lookups.size(), 2);
+        for (const auto& lookup : lookups)
+        {
+            EXPECT_EQ(lookup.resolved, kTestRoot / "media2/asset2");
+            ASSERT_EQ(lookup.missing.size(), 2);
+            EXPECT_EQ(lookup.missing[0], cwdAsset2);
+            EXPECT_EQ(lookup.missing[1], kTestRoot / "media1/asset2");
+        }
+    }
+
+    // Failed lookups report all candidates, with and without the cache.
+    for (bool cacheEnabled : {true, false})
+    {
+        resolver.setCacheEnabled(cacheEnabled);
+        for (int i = 0; i < 2; i++)
+        {
+            lookups.clear();
+            resolver.resolvePath("asset4");
+            ASSERT_EQ(lookups.size(), 1);
+            EXPECT(lookups[0].resolved.empty());
+            ASSERT_EQ(lookups[0].missing.size(), 3);
+            EXPECT_EQ(lookups[0].missing[0], cwdAsset4);
+            EXPECT_EQ(lookups[0].missing[1], kTestRoot / "media1/asset4");
+            EXPECT_EQ(lookups[0].missing[2], kTestRoot / "media2/asset4");
+        }
+    }
+
+    // Indexed search paths report the same candidates.
+    resolver.setCacheEnabled(true);
+    resolver.indexSearchPaths();
+    lookups.clear();
+    resolver.resolvePath("asset4");
+    ASSERT_EQ(lookups.size(), 1);
+    EXPECT_EQ(lookups[0].missing.size(), 3);
+
+    // Absolute paths that exist have no missing candidates.
+    lookups.clear();
+    resolver.resolvePath(kTestRoot / "media1/asset1");
+    ASSERT_EQ(lookups.size(), 1);
+    EXPECT_EQ(lookups[0].resolved, kTestRoot / "media1/asset1");
+    EXPECT(lookups[0].missing.empty());
+
+    // Pattern lookups report the matched paths only.
+    lookups.clear();
+    resolver.addSearchPath(kTestRoot / "media4");
+    resolver.resolvePathPattern("textures", "mip[0-1].png");
+    ASSERT_EQ(lookups.size(), 2);
+    std::sort(lookups.begin(), lookups.end(), [](const Lookup& a, const Lookup& b) { return a.resolved < b.resolved; });
+    EXPECT_EQ(lookups[0].resolved, kTestRoot / "media4/textures/mip0.png");
+    EXPECT_EQ(lookups[1].resolved, kTestRoot / "media4/textures/mip1.png");
+    EXPECT(lookups[0].missing.empty() && lookups[1].missing.empty());
+
+    resolver.setResolveCallback(nullptr);
+    resolver.resolvePath("asset1");
+    EXPECT_EQ(lookups.size(), 2);
+
+    removeTestFiles(ctx);
+}
+
 } // namespace Falcor
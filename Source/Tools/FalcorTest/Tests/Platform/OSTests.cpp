@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Core/Platform/OS.h"
+#include <fstream>
+#include <thread>
 
 namespace Falcor
 {
@@ -92,4 +94,38 @@ CPU_TEST(GetEnvironmentVariable)
     EXPECT_NE(getEnvironmentVariable("PATH"), std::optional<std::string>{});
 #endif
 }
+
+CPU_TEST(WriteFileAtomic)
+{
+    std::filesystem::path directory = std::filesystem::current_path() / "write_file_atomic";
+    std::filesystem::remove_all(directory);
+    std::filesystem::path path = directory / "sub" / "file.bin";
+
+    // Concurrent writes of the same file all succeed and leave no temporary files behind.
+    const std::string data(100000, 'x');
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++)
+        threads.emplace_back([&]() { writeFileAtomic(path, data.data(), data.size()); });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT(readFile(path) == data);
+
+    // A failed write keeps the previous content and removes the temporary file.
+    EXPECT_THROW(writeFileAtomic(
+        path,
+        [](const std::filesystem::path& tempPath)
+        {
+            std::ofstream(tempPath) << "partial";
+            FALCOR_THROW("Write failed.");
+        }
+    ));
+    EXPECT(readFile(path) == data);
+
+    size_t fileCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path()))
+        fileCount++;
+    EXPECT_EQ(fileCount, 1);
+
+    std::filesystem::remove_all(directory);
+}
 } // namespace Falcor
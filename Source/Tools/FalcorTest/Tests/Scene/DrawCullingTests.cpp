@@ -0,0 +1,220 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/DrawCulling.h"
+#include "Scene/InstanceBVH.h"
+#include "Utils/Math/MathHelpers.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInstanceCount = 2000;
+const uint32_t kDrawCount = 3000;
+const uint32_t kTriangleCountIndex = 1;
+
+std::vector<AABB> createRandomBounds(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> posDist(-100.f, 100.f);
+    std::uniform_real_distribution<float> sizeDist(0.1f, 5.f);
+
+    std::vector<AABB> bounds(kInstanceCount);
+    for (auto& aabb : bounds)
+    {
+        float3 center(posDist(rng), posDist(rng), posDist(rng));
+        float3 halfExtent(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+        aabb = AABB(center - halfExtent, center + halfExtent);
+    }
+    return bounds;
+}
+
+/// Draw arguments referencing random instances. The first word is the vertex count, the last word the instance ID.
+std::vector<uint32_t> createRandomDrawArgs(std::mt19937& rng, uint32_t argStride)
+{
+    std::vector<uint32_t> args(kDrawCount * argStride);
+    for (uint32_t i = 0; i < kDrawCount; i++)
+    {
+        uint32_t* pArgs = args.data() + i * argStride;
+        pArgs[0] = 3 * (1 + rng() % 1000);
+        for (uint32_t j = 1; j < argStride - 1; j++)
+            pArgs[j] = rng();
+        pArgs[argStride - 1] = rng() % kInstanceCount;
+    }
+    return args;
+}
+
+/// Frustum planes extracted from a perspective view-projection matrix (depth mapped to [0, 1]).
+InstanceBVH::Frustum createFrustum(const float3& eye, const float3& target)
+{
+    float4x4 proj = math::perspective(math::radians(60.f), 16.f / 9.f, 0.1f, 120.f);
+    float4x4 viewProj = mul(proj, math::matrixFromLookAt(eye, target, float3(0.f, 1.f, 0.f)));
+    float4 r0 = viewProj.getRow(0), r1 = viewProj.getRow(1), r2 = viewProj.getRow(2), r3 = viewProj.getRow(3);
+    return {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2};
+}
+
+/// Brute-force p-vertex test matching CullDrawArgs.cs.slang.
+bool isOutsideFrustum(const InstanceBVH::Frustum& frustum, const AABB& bounds)
+{
+    for (const float4& plane : frustum)
+    {
+        float3 n = plane.xyz();
+        float3 p;
+        for (int i = 0; i < 3; i++)
+            p[i] = n[i] >= 0.f ? bounds.maxPoint[i] : bounds.minPoint[i];
+        if (!(dot(n, p) + plane.w > 0.f))
+            return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> cullDrawArgsRef(
+    const InstanceBVH::Frustum& frustum,
+    const std::vector<AABB>& bounds,
+    const std::vector<uint32_t>& args,
+    uint32_t argStride,
+    uint64_t& triangleCount
+)
+{
+    std::vector<uint32_t> result;
+    triangleCount = 0;
+    for (size_t i = 0; i < args.size(); i += argStride)
+    {
+        if (isOutsideFrustum(frustum, bounds[args[i + argStride - 1]]))
+            continue;
+        result.insert(result.end(), args.begin() + i, args.begin() + i + argStride);
+        triangleCount += args[i] / 3;
+    }
+    return result;
+}
+
+/// Returns the draws sorted by their arguments, for comparing draw lists whose order is not defined.
+std::vector<std::vector<uint32_t>> sortedDraws(const std::vector<uint32_t>& args, uint32_t argStride)
+{
+    std::vector<std::vector<uint32_t>> draws;
+    for (size_t i = 0; i < args.size(); i += argStride)
+        draws.emplace_back(args.begin() + i, args.begin() + i + argStride);
+    std::sort(draws.begin(), draws.end());
+    return draws;
+}
+} // namespace
+
+CPU_TEST(DrawCulling_CPU)
+{
+    std::mt19937 rng(1);
+    std::vector<AABB> bounds = createRandomBounds(rng);
+    InstanceBVH bvh;
+    bvh.build(bounds);
+
+    std::uniform_real_distribution<float> posDist(-150.f, 150.f);
+    std::vector<uint32_t> visibleInstanceIDs;
+    std::vector<uint32_t> culledArgs;
+
+    for (uint32_t argStride : {4u, 5u})
+    {
+        std::vector<uint32_t> args = createRandomDrawArgs(rng, argStride);
+        for (uint32_t i = 0; i < 20; i++)
+        {
+            InstanceBVH::Frustum frustum = createFrustum(float3(posDist(rng), posDist(rng), posDist(rng)), float3(0.f));
+
+            // Same path as Scene::cullDrawListCPU().
+            bvh.queryFrustum(frustum, visibleInstanceIDs);
+            std::vector<uint8_t> isVisible(bounds.size(), 0);
+            for (uint32_t instanceID : visibleInstanceIDs)
+                isVisible[instanceID] = 1;
+            uint64_t triangleCount = compactDrawArgs(args, argStride, isVisible, culledArgs);
+
+            uint64_t refTriangleCount = 0;
+            std::vector<uint32_t> refArgs = cullDrawArgsRef(frustum, bounds, args, argStride, refTriangleCount);
+            EXPECT(culledArgs == refArgs) << "argStride = " << argStride << ", i = " << i;
+            EXPECT_EQ(triangleCount, refTriangleCount) << "argStride = " << argStride << ", i = " << i;
+            EXPECT_GT(refArgs.size(), 0) << "argStride = " << argStride << ", i = " << i;
+            EXPECT_LT(refArgs.size(), args.size()) << "argStride = " << argStride << ", i = " << i;
+        }
+    }
+}
+
+GPU_TEST(DrawCulling_GPU)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::mt19937 rng(2);
+    std::vector<AABB> bounds = createRandomBounds(rng);
+    static_assert(sizeof(AABB) == 24, "AABB size should be 24 bytes to match the GPU layout");
+    ref<Buffer> pBoundsBuffer = pDevice->createStructuredBuffer(
+        sizeof(AABB), kInstanceCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, bounds.data(), false
+    );
+
+    std::uniform_real_distribution<float> posDist(-150.f, 150.f);
+
+    for (uint32_t argStride : {4u, 5u})
+    {
+        std::vector<uint32_t> args = createRandomDrawArgs(rng, argStride);
+        const size_t argsSize = args.size() * sizeof(uint32_t);
+        ref<Buffer> pArgsBuffer = pDevice->createBuffer(argsSize, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, args.data());
+        ref<Buffer> pCulledArgsBuffer =
+            pDevice->createBuffer(argsSize, ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr);
+        ref<Buffer> pCounterBuffer = pDevice->createBuffer(
+            (kTriangleCountIndex + 1) * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr
+        );
+
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            InstanceBVH::Frustum frustum = createFrustum(float3(posDist(rng), posDist(rng), posDist(rng)), float3(0.f));
+
+            ctx.createProgram("Scene/CullDrawArgs.cs.slang", "main");
+            ctx["CB"]["gDrawCount"] = kDrawCount;
+            ctx["CB"]["gArgStride"] = argStride;
+            ctx["CB"]["gCountIndex"] = 0u;
+            ctx["CB"]["gTriangleCountIndex"] = kTriangleCountIndex;
+            for (uint32_t j = 0; j < frustum.size(); j++)
+                ctx["CB"]["gFrustumPlanes"][j] = frustum[j];
+            ctx["gDrawArgs"] = pArgsBuffer;
+            ctx["gInstanceBounds"] = pBoundsBuffer;
+            ctx["gCulledDrawArgs"] = pCulledArgsBuffer;
+            ctx["gCounters"] = pCounterBuffer;
+            ctx.getRenderContext()->clearUAV(pCounterBuffer->getUAV().get(), uint4(0));
+            ctx.runProgram(kDrawCount);
+
+            uint64_t refTriangleCount = 0;
+            std::vector<uint32_t> refArgs = cullDrawArgsRef(frustum, bounds, args, argStride, refTriangleCount);
+
+            // The compacted draws are appended with atomics, so only the set of draws is defined.
+            std::vector<uint32_t> counters = pCounterBuffer->getElements<uint32_t>(0, kTriangleCountIndex + 1);
+            EXPECT_EQ(counters[0], refArgs.size() / argStride) << "argStride = " << argStride << ", i = " << i;
+            EXPECT_EQ(counters[kTriangleCountIndex], refTriangleCount) << "argStride = " << argStride << ", i = " << i;
+
+            std::vector<uint32_t> culledArgs;
+            if (counters[0] > 0)
+                culledArgs = pCulledArgsBuffer->getElements<uint32_t>(0, counters[0] * argStride);
+            EXPECT(sortedDraws(culledArgs, argStride) == sortedDraws(refArgs, argStride)) << "argStride = " << argStride << ", i = " << i;
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/InstanceBVH.h"
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<AABB> createRandomBounds(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> posDist(-100.f, 100.f);
+    std::uniform_real_distribution<float> sizeDist(0.1f, 5.f);
+
+    std::vector<AABB> bounds(count);
+    for (auto& aabb : bounds)
+    {
+        float3 center(posDist(rng), posDist(rng), posDist(rng));
+        float3 halfExtent(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+        aabb = AABB(center - halfExtent, center + halfExtent);
+    }
+    return bounds;
+}
+
+std::set<uint32_t> bruteForceAABB(const std::vector<AABB>& bounds, const AABB& query)
+{
+    std::set<uint32_t> result;
+    for (uint32_t i = 0; i < bounds.size(); i++)
+    {
+        const AABB& aabb = bounds[i];
+        if (aabb.valid() && all(aabb.minPoint <= query.maxPoint) && all(aabb.maxPoint >= query.minPoint))
+            result.insert(i);
+    }
+    return result;
+}
+
+/// Frustum made up of the six planes of an axis-aligned box.
+InstanceBVH::Frustum boxFrustum(const AABB& box)
+{
+    return {
+        float4(1.f, 0.f, 0.f, -box.minPoint.x), float4(-1.f, 0.f, 0.f, box.maxPoint.x),
+        float4(0.f, 1.f, 0.f, -box.minPoint.y), float4(0.f, -1.f, 0.f, box.maxPoint.y),
+        float4(0.f, 0.f, 1.f, -box.minPoint.z), float4(0.f, 0.f, -1.f, box.maxPoint.z),
+    };
+}
+
+void testQueries(CPUUnitTestContext& ctx, const InstanceBVH& bvh, const std::vector<AABB>& bounds, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> posDist(-100.f, 100.f);
+    std::vector<uint32_t> result;
+
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        float3 center(posDist(rng), posDist(rng), posDist(rng));
+        AABB query(center - float3(20.f), center + float3(20.f));
+
+        bvh.queryAABB(query, result);
+        EXPECT(std::set<uint32_t>(result.begin(), result.end()) == bruteForceAABB(bounds, query));
+        EXPECT_EQ(result.size(), std::set<uint32_t>(result.begin(), result.end()).size());
+
+        // The box frustum treats touching boxes as outside; the test data never touches exactly.
+        bvh.queryFrustum(boxFrustum(query), result);
+        EXPECT(std::set<uint32_t>(result.begin(), result.end()) == bruteForceAABB(bounds, query));
+
+        Ray ray(float3(-200.f, center.y, center.z), normalize(float3(1.f, 0.05f * posDist(rng) / 100.f, 0.f)));
+        std::vector<InstanceBVH::RayHit> hits;
+        bvh.queryRay(ray, hits);
+
+        std::set<uint32_t> refHits;
+        for (uint32_t j = 0; j < bounds.size(); j++)
+        {
+            if (!bounds[j].valid())
+                continue;
+            float tEntry = -std::numeric_limits<float>::infinity();
+            float tExit = std::numeric_limits<float>::infinity();
+            for (int k = 0; k < 3; k++)
+            {
+                float t0 = (bounds[j].minPoint[k] - ray.origin[k]) / ray.dir[k];
+                float t1 = (bounds[j].maxPoint[k] - ray.origin[k]) / ray.dir[k];
+                tEntry = std::max(tEntry, std::min(t0, t1));
+                tExit = std::min(tExit, std::max(t0, t1));
+            }
+            if (std::max(tEntry, ray.tMin) <= std::min(tExit, ray.tMax))
+                refHits.insert(j);
+        }
+
+        std::set<uint32_t> hitSet;
+        for (const auto& hit : hits)
+            hitSet.insert(hit.itemIndex);
+        EXPECT(hitSet == refHits);
+        for (size_t j = 1; j < hits.size(); j++)
+            EXPECT_LE(hits[j - 1].t, hits[j].t);
+
+        InstanceBVH::RayHit closest;
+        bool found = bvh.queryClosest(ray, closest);
+        EXPECT_EQ(found, !hits.empty());
+        if (found && !hits.empty())
+        {
+            EXPECT_EQ(closest.t, hits[0].t);
+            EXPECT_EQ(closest.itemIndex, hits[0].itemIndex);
+        }
+    }
+}
+} // namespace
+
+CPU_TEST(InstanceBVH_Empty)
+{
+    InstanceBVH bvh;
+    bvh.build({});
+    EXPECT_EQ(bvh.getStats().nodeCount, 0);
+    EXPECT_FALSE(bvh.getBounds().valid());
+
+    std::vector<uint32_t> result;
+    bvh.queryAABB(AABB(float3(-1.f), float3(1.f)), result);
+    EXPECT(result.empty());
+
+    InstanceBVH::RayHit hit;
+    EXPECT_FALSE(bvh.queryClosest(Ray(float3(0.f), float3(1.f, 0.f, 0.f)), hit));
+
+    // Only invalid bounds.
+    bvh.build({ AABB(), AABB() });
+    EXPECT_EQ(bvh.getItemCount(), 2);
+    EXPECT_EQ(bvh.getStats().itemCount, 0);
+    bvh.queryAABB(AABB(float3(-1.f), float3(1.f)), result);
+    EXPECT(result.empty());
+}
+
+CPU_TEST(InstanceBVH_Build)
+{
+    for (uint32_t count : { 1u, 3u, 17u, 1000u })
+    {
+        std::vector<AABB> bounds = createRandomBounds(count, count);
+        if (count > 2)
+            bounds[1] = AABB();
+
+        InstanceBVH bvh;
+        bvh.build(bounds);
+
+        AABB sceneBounds;
+        for (const auto& aabb : bounds)
+            sceneBounds |= aabb;
+        EXPECT(bvh.getBounds() == sceneBounds);
+        EXPECT_EQ(bvh.getStats().itemCount, count > 2 ? count - 1 : count);
+        EXPECT_LE(bvh.getStats().nodeCount, 2 * count);
+
+        testQueries(ctx, bvh, bounds, count);
+    }
+}
+
+CPU_TEST(InstanceBVH_Degenerate)
+{
+    // All items share the same centroid, which must not prevent the leaf size limit from being respected.
+    std::vector<AABB> bounds(100, AABB(float3(-1.f), float3(1.f)));
+    InstanceBVH bvh;
+    bvh.build(bounds);
+    EXPECT_GT(bvh.getStats().leafCount, 1);
+
+    std::vector<uint32_t> result;
+    bvh.queryAABB(AABB(float3(0.5f), float3(2.f)), result);
+    EXPECT_EQ(result.size(), 100);
+    bvh.queryAABB(AABB(float3(1.5f), float3(2.f)), result);
+    EXPECT(result.empty());
+}
+
+CPU_TEST(InstanceBVH_Refit)
+{
+    std::vector<AABB> bounds = createRandomBounds(500, 1);
+    InstanceBVH bvh;
+    bvh.build(bounds);
+
+    // Move all items and refit.
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> offsetDist(-50.f, 50.f);
+    for (auto& aabb : bounds)
+    {
+        float3 offset(offsetDist(rng), offsetDist(rng), offsetDist(rng));
+        aabb = AABB(aabb.minPoint + offset, aabb.maxPoint + offset);
+    }
+    bvh.refit(bounds);
+
+    AABB sceneBounds;
+    for (const auto& aabb : bounds)
+        sceneBounds |= aabb;
+    EXPECT(bvh.getBounds() == sceneBounds);
+
+    testQueries(ctx, bvh, bounds, 3);
+
+    // Items that become valid or invalid are picked up by the refit.
+    AABB savedBounds = bounds[0];
+    bounds[0] = AABB();
+    bvh.refit(bounds);
+    EXPECT_EQ(bvh.getStats().itemCount, (uint32_t)bounds.size() - 1);
+    testQueries(ctx, bvh, bounds, 4);
+    bounds[0] = savedBounds;
+    bvh.refit(bounds);
+    EXPECT_EQ(bvh.getStats().itemCount, (uint32_t)bounds.size());
+    testQueries(ctx, bvh, bounds, 5);
+
+    bounds.pop_back();
+    EXPECT_THROW(bvh.refit(bounds));
+}
+} // namespace Falcor
@@ -29,6 +29,9 @@
 #include "Core/AssetResolver.h"
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MERLMaterialData.slang"
+#include <chrono>
+#include <cstring>
+#include <fstream>
 
 namespace Falcor
 {
@@ -56,5 +59,89 @@ GPU_TEST(MERLFile)
         EXPECT_EQ(v.y, expected.y);
         EXPECT_EQ(v.z, expected.z);
     }
+
+    // The CPU integrator should produce the same table up to integration error.
+    auto cpuLut = merlFile.computeAlbedoLUTCPU(MERLMaterialData::kAlbedoLUTSize);
+    EXPECT_EQ(cpuLut.size(), lut.size());
+    for (size_t i = 0; i < std::min(cpuLut.size(), lut.size()); i++)
+    {
+        EXPECT_LE(std::abs(cpuLut[i].x - lut[i].x), 1e-3f);
+        EXPECT_LE(std::abs(cpuLut[i].y - lut[i].y), 1e-3f);
+        EXPECT_LE(std::abs(cpuLut[i].z - lut[i].z), 1e-3f);
+    }
+}
+
+CPU_TEST(MERLFile_AlbedoLUTCPU)
+{
+    // Write a lambertian BRDF with albedo (0.25, 0.5, 0.75) in MERL format.
+    const int dims[3] = {90, 90, 180};
+    const size_t n = (size_t)dims[0] * dims[1] * dims[2];
+    const float3 albedo = float3(0.25f, 0.5f, 0.75f);
+    const double scales[3] = {1.0 / 1500.0, 1.15 / 1500.0, 1.66 / 1500.0};
+
+    std::vector<double> data(3 * n);
+    for (size_t c = 0; c < 3; c++)
+        std::fill(data.begin() + c * n, data.begin() + (c + 1) * n, albedo[c] * M_1_PI / scales[c]);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_merl_lambert.binary";
+    {
+        std::ofstream fs(path, std::ios_base::binary);
+        fs.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        fs.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(double));
+    }
+
+    MERLFile merlFile;
+    bool result = merlFile.loadBRDF(path);
+    std::filesystem::remove(path);
+    ASSERT(result);
+
+    auto lut = merlFile.computeAlbedoLUTCPU(MERLMaterialData::kAlbedoLUTSize);
+    EXPECT_EQ(lut.size(), MERLMaterialData::kAlbedoLUTSize);
+    for (auto v : lut)
+    {
+        EXPECT_LE(std::abs(v.x - albedo.x), 1e-4f);
+        EXPECT_LE(std::abs(v.y - albedo.y), 1e-4f);
+        EXPECT_LE(std::abs(v.z - albedo.z), 1e-4f);
+        EXPECT_EQ(v.w, 1.f);
+    }
+}
+
+CPU_TEST(MERLFile_DataCache)
+{
+    const int dims[3] = {90, 90, 180};
+    const size_t n = (size_t)dims[0] * dims[1] * dims[2];
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_merl_cache.binary";
+    auto writeBRDF = [&](double value)
+    {
+        std::vector<double> data(3 * n, value);
+        std::ofstream fs(path, std::ios_base::binary);
+        fs.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        fs.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(double));
+    };
+
+    // Loading a BRDF stores the converted data in the cache.
+    writeBRDF(1500.0);
+    MERLFile merlFile;
+    ASSERT(merlFile.loadBRDF(path));
+    auto key = AlbedoLUTCache::computeKey(path);
+    ASSERT(key);
+    auto cached = AlbedoLUTCache::loadData(*key, n);
+    ASSERT_EQ(cached.size(), n);
+    EXPECT(std::memcmp(cached.data(), merlFile.getData().data(), n * sizeof(float3)) == 0);
+
+    // Loading it again gives the same data.
+    MERLFile merlFile2;
+    ASSERT(merlFile2.loadBRDF(path));
+    ASSERT_EQ(merlFile2.getData().size(), n);
+    EXPECT(std::memcmp(merlFile2.getData().data(), merlFile.getData().data(), n * sizeof(float3)) == 0);
+
+    // Editing the file changes the key, so stale data is not used.
+    writeBRDF(3000.0);
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(1));
+    ASSERT(merlFile2.loadBRDF(path));
+    EXPECT_EQ(merlFile2.getData()[0].x, 2.f);
+    EXPECT(AlbedoLUTCache::computeKey(path) != key);
+
+    std::filesystem::remove(path);
 }
 } // namespace Falcor
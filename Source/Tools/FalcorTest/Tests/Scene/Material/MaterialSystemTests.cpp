@@ -0,0 +1,178 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/Material/ClothMaterial.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<ref<Material>> createMaterials(ref<Device> pDevice, uint32_t count)
+{
+    // Create materials with a small set of parameter values so that many of them are duplicates.
+    std::mt19937 rng(1);
+    std::vector<ref<Material>> materials;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const std::string name = "Material" + std::to_string(i);
+        if (rng() % 4 == 0)
+        {
+            auto pMaterial = ClothMaterial::create(pDevice, name);
+            pMaterial->setBaseColor(float4(float(rng() % 3) / 2.f, 0.5f, 0.5f, 1.f));
+            materials.push_back(pMaterial);
+        }
+        else
+        {
+            auto pMaterial = StandardMaterial::create(pDevice, name);
+            pMaterial->setBaseColor(float4(float(rng() % 3) / 2.f, 0.5f, 0.5f, 1.f));
+            pMaterial->setRoughness(float(rng() % 2));
+            pMaterial->setDoubleSided(rng() % 2 == 0);
+            materials.push_back(pMaterial);
+        }
+    }
+    return materials;
+}
+} // namespace
+
+GPU_TEST(Material_Hash)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    auto pA = StandardMaterial::create(pDevice, "A");
+    auto pB = StandardMaterial::create(pDevice, "B");
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+
+    // Signed zeros compare equal and must hash the same.
+    pA->setBaseColor(float4(0.f, 0.5f, 0.5f, 1.f));
+    pB->setBaseColor(float4(-0.f, 0.5f, 0.5f, 1.f));
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+
+    pB->setBaseColor(float4(1.f, 0.5f, 0.5f, 1.f));
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_NE(pA->getHash(), pB->getHash());
+
+    auto pC = ClothMaterial::create(pDevice, "C");
+    EXPECT(!pA->isEqual(pC));
+    EXPECT_NE(pA->getHash(), pC->getHash());
+}
+
+GPU_TEST(MaterialSystem_RemoveDuplicateMaterials)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kCount = 1000;
+    auto materials = createMaterials(pDevice, kCount);
+
+    // Compute the expected result by comparing against all unique materials.
+    std::vector<ref<Material>> expectedUnique;
+    std::vector<MaterialID> expectedIdMap(kCount);
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        auto it = std::find_if(
+            expectedUnique.begin(), expectedUnique.end(), [&](const auto& m) { return m->isEqual(materials[i]); }
+        );
+        expectedIdMap[i] = MaterialID{(size_t)std::distance(expectedUnique.begin(), it)};
+        if (it == expectedUnique.end())
+            expectedUnique.push_back(materials[i]);
+    }
+
+    MaterialSystem materialSystem(pDevice);
+    for (const auto& pMaterial : materials)
+        materialSystem.addMaterial(pMaterial);
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+
+    EXPECT_EQ(removed, kCount - expectedUnique.size());
+    EXPECT_EQ(materialSystem.getMaterialCount(), expectedUnique.size());
+    ASSERT_EQ(idMap.size(), kCount);
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        EXPECT_EQ(idMap[i].get(), expectedIdMap[i].get()) << "i = " << i;
+        EXPECT(materialSystem.getMaterial(idMap[i]) == expectedUnique[idMap[i].get()]) << "i = " << i;
+    }
+}
+
+GPU_TEST(MaterialSystem_IncrementalUpload)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kCount = 100;
+    MaterialSystem materialSystem(pDevice);
+    std::vector<ref<StandardMaterial>> materials;
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, "Material" + std::to_string(i));
+        pMaterial->setBaseColor(float4(float(i) / kCount, 0.5f, 0.5f, 1.f));
+        materials.push_back(pMaterial);
+        materialSystem.addMaterial(pMaterial);
+    }
+
+    // Initial update uploads everything.
+    materialSystem.update(true);
+    EXPECT(materialSystem.getUploadStats().fullUpload);
+    EXPECT_EQ(materialSystem.getUploadStats().bytesUploaded, kCount * sizeof(MaterialDataBlob));
+
+    // No changes.
+    materialSystem.update(false);
+    EXPECT_EQ(materialSystem.getUploadStats().bytesUploaded, 0);
+
+    // A forced update compares all materials, but only uploads changed ones.
+    materials[50]->setBaseColor(float4(1.f));
+    materialSystem.update(true);
+    EXPECT(!materialSystem.getUploadStats().fullUpload);
+    EXPECT_EQ(materialSystem.getUploadStats().materialCount, 1);
+
+    // Nearby changes are merged into one range, distant ones are not.
+    materials[10]->setBaseColor(float4(1.f));
+    materials[12]->setBaseColor(float4(1.f));
+    materials[90]->setBaseColor(float4(1.f));
+    materialSystem.update(false);
+    EXPECT(!materialSystem.getUploadStats().fullUpload);
+    EXPECT_EQ(materialSystem.getUploadStats().rangeCount, 2);
+    EXPECT_EQ(materialSystem.getUploadStats().materialCount, 4);
+    EXPECT_EQ(materialSystem.getUploadStats().bytesUploaded, 4 * sizeof(MaterialDataBlob));
+
+    // Setting an unchanged value doesn't upload anything.
+    materials[10]->setBaseColor(float4(1.f));
+    materialSystem.update(false);
+    EXPECT_EQ(materialSystem.getUploadStats().bytesUploaded, 0);
+
+    // Adding a material only uploads the new material.
+    materialSystem.addMaterial(StandardMaterial::create(pDevice, "New"));
+    materialSystem.update(false);
+    EXPECT(!materialSystem.getUploadStats().fullUpload);
+    EXPECT_EQ(materialSystem.getUploadStats().materialCount, 1);
+    EXPECT_EQ(materialSystem.getUploadStats().bytesUploaded, sizeof(MaterialDataBlob));
+}
+} // namespace Falcor
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MeasuredBRDFRegistry.h"
+
+namespace Falcor
+{
+namespace
+{
+struct TestData : MeasuredBRDFRegistry::Data
+{
+    uint64_t getMemoryInBytes() const override { return 1000; }
+};
+
+// Fake device pointer to keep the test data separate from data of the real devices.
+Device* const kDevice = reinterpret_cast<Device*>(uintptr_t(0x1234));
+} // namespace
+
+CPU_TEST(MeasuredBRDFRegistry)
+{
+    uint32_t initCount = 0;
+    auto init = [&]()
+    {
+        initCount++;
+        return std::make_shared<TestData>();
+    };
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_measured_brdf.binary";
+    const std::filesystem::path otherPath = std::filesystem::temp_directory_path() / "falcor_measured_brdf_other.binary";
+
+    // Equivalent paths share the data, different types and paths don't.
+    auto pA = MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {path}, init);
+    auto pB = MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {path.parent_path() / "." / path.filename()}, init);
+    auto pC = MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Other", {path}, init);
+    auto pD = MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {path, otherPath}, init);
+    EXPECT(pA != nullptr);
+    EXPECT(pA == pB);
+    EXPECT(pA != pC);
+    EXPECT(pA != pD);
+    EXPECT_EQ(initCount, 3);
+
+    auto stats = MeasuredBRDFRegistry::getStats(kDevice);
+    EXPECT_EQ(stats.brdfCount, 3);
+    EXPECT_EQ(stats.referenceCount, 4);
+    EXPECT_EQ(stats.memoryInBytes, 3000);
+    EXPECT_EQ(stats.memorySavedInBytes, 1000);
+
+    // Data is released with the last reference.
+    pA.reset();
+    pB.reset();
+    stats = MeasuredBRDFRegistry::getStats(kDevice);
+    EXPECT_EQ(stats.brdfCount, 2);
+    EXPECT_EQ(stats.memorySavedInBytes, 0);
+
+    pA = MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {path}, init);
+    EXPECT_EQ(initCount, 4);
+
+    // Failed loads are not cached.
+    auto fail = []() { return std::shared_ptr<TestData>(); };
+    EXPECT(MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {otherPath}, fail) == nullptr);
+    EXPECT(MeasuredBRDFRegistry::acquire<TestData>(kDevice, "Test", {otherPath}, init) != nullptr);
+    EXPECT_EQ(initCount, 5);
+}
+} // namespace Falcor
@@ -0,0 +1,239 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshOptimizer.h"
+#include "Utils/Math/AABB.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Creates a regular grid of quads with the triangles in random order.
+void createShuffledGrid(uint32_t size, std::vector<uint32_t>& indices, std::vector<float3>& positions)
+{
+    positions.clear();
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+            positions.push_back(float3(float(x), float(y), 0.f));
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i = y * (size + 1) + x;
+            triangles.push_back({i, i + 1, i + size + 1});
+            triangles.push_back({i + 1, i + size + 2, i + size + 1});
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    indices.clear();
+    for (const auto& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+/// Returns the sorted list of triangles, each rotated so that the smallest index comes first.
+/// Rotating keeps the winding, so two meshes with the same result contain the same triangles with the same winding.
+std::vector<std::array<uint32_t, 3>> getCanonicalTriangles(const std::vector<uint32_t>& indices, const std::vector<uint32_t>* pRemap = nullptr)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> t = {indices[i], indices[i + 1], indices[i + 2]};
+        if (pRemap)
+        {
+            for (auto& v : t)
+                v = (*pRemap)[v];
+        }
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(MeshOptimizer_VertexCache)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(64, indices, positions);
+    const uint32_t vertexCount = (uint32_t)positions.size();
+
+    std::vector<uint32_t> optimized = indices;
+    MeshOptimizer::optimizeVertexCache(optimized, vertexCount);
+    EXPECT(getCanonicalTriangles(optimized) == getCanonicalTriangles(indices));
+
+    // A regular grid reaches an ACMR well below 1.0, while the shuffled input is close to 3.0.
+    const size_t triangleCount = indices.size() / 3;
+    float acmrBefore = float(MeshOptimizer::countVertexCacheMisses(indices, vertexCount)) / triangleCount;
+    float acmrAfter = float(MeshOptimizer::countVertexCacheMisses(optimized, vertexCount)) / triangleCount;
+    EXPECT_GT(acmrBefore, 2.f);
+    EXPECT_LT(acmrAfter, 0.9f);
+
+    // The result only depends on the input.
+    std::vector<uint32_t> optimized2 = indices;
+    MeshOptimizer::optimizeVertexCache(optimized2, vertexCount);
+    EXPECT(optimized == optimized2);
+
+    std::vector<uint32_t> invalid = {0, 1, vertexCount};
+    EXPECT_THROW(MeshOptimizer::optimizeVertexCache(invalid, vertexCount));
+}
+
+CPU_TEST(MeshOptimizer_VertexFetch)
+{
+    // Vertex 2 is unreferenced.
+    std::vector<uint32_t> indices = {4, 3, 1, 1, 3, 0};
+    std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices, 5);
+
+    EXPECT(indices == std::vector<uint32_t>({0, 1, 2, 2, 1, 3}));
+    EXPECT(remap == std::vector<uint32_t>({3, 2, 4, 1, 0}));
+}
+
+CPU_TEST(MeshOptimizer_Locality)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(64, indices, positions);
+    const uint32_t vertexCount = (uint32_t)positions.size();
+
+    std::vector<uint32_t> optimized = indices;
+    std::vector<uint32_t> remap = MeshOptimizer::optimizeLocality(optimized, positions, 64);
+    EXPECT_EQ(remap.size(), vertexCount);
+
+    // Applying the inverse vertex remapping must give back the original triangles.
+    std::vector<uint32_t> inverseRemap(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        inverseRemap[remap[i]] = i;
+    EXPECT(getCanonicalTriangles(optimized, &inverseRemap) == getCanonicalTriangles(indices));
+
+    const size_t triangleCount = indices.size() / 3;
+    float acmr = float(MeshOptimizer::countVertexCacheMisses(optimized, vertexCount)) / triangleCount;
+    EXPECT_LT(acmr, 1.f);
+
+    // Each cluster of 64 triangles covers a compact region of the grid.
+    for (size_t first = 0; first < triangleCount; first += 64)
+    {
+        AABB bounds;
+        for (size_t i = first * 3; i < (first + 64) * 3; i++)
+            bounds.include(positions[inverseRemap[optimized[i]]]);
+        EXPECT_LE(bounds.extent().x * bounds.extent().y, 64.f);
+    }
+}
+
+CPU_TEST(MeshOptimizer_MortonNonFinite)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(8, indices, positions);
+
+    // Degenerate input with NaN and infinite positions must still give a permutation of the triangles.
+    const float inf = std::numeric_limits<float>::infinity();
+    positions[0] = float3(std::numeric_limits<float>::quiet_NaN(), 0.f, 0.f);
+    positions[1] = float3(inf, -inf, inf);
+    positions[2] = float3(1e38f, -1e38f, 1e38f);
+
+    std::vector<uint32_t> sorted = indices;
+    MeshOptimizer::sortTrianglesMorton(sorted, positions);
+    EXPECT(getCanonicalTriangles(sorted) == getCanonicalTriangles(indices));
+}
+
+CPU_TEST(MeshOptimizer_Meshlets)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(64, indices, positions);
+    std::vector<uint32_t> remap = MeshOptimizer::optimizeLocality(indices, positions);
+    std::vector<float3> remappedPositions(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        remappedPositions[remap[i]] = positions[i];
+    positions = std::move(remappedPositions);
+    const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+
+    MeshOptimizer::Meshlets result = MeshOptimizer::buildMeshlets(indices, positions);
+    EXPECT_GE(result.meshlets.size(), triangleCount / MeshOptimizer::kDefaultMeshletMaxTriangleCount);
+
+    // The meshlets must cover all triangles in order and reproduce the index buffer.
+    uint32_t nextTriangle = 0;
+    for (const MeshletDesc& meshlet : result.meshlets)
+    {
+        EXPECT_EQ(meshlet.firstTriangle, nextTriangle);
+        EXPECT_LE(meshlet.getVertexCount(), MeshOptimizer::kDefaultMeshletMaxVertexCount);
+        EXPECT_LE(meshlet.getTriangleCount(), MeshOptimizer::kDefaultMeshletMaxTriangleCount);
+        EXPECT_GT(meshlet.getTriangleCount(), 0);
+
+        for (uint32_t t = 0; t < meshlet.getTriangleCount(); t++)
+        {
+            const uint32_t packed = result.triangles[meshlet.triangleOffset + t];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const uint32_t localID = (packed >> (i * 8)) & 0xff;
+                EXPECT_LT(localID, meshlet.getVertexCount());
+                const uint32_t vertex = result.vertices[meshlet.vertexOffset + localID];
+                EXPECT_EQ(vertex, indices[(meshlet.firstTriangle + t) * 3 + i]);
+                EXPECT_LE(length(positions[vertex] - meshlet.boundsCenter), meshlet.boundsRadius * 1.0001f);
+            }
+        }
+        nextTriangle += meshlet.getTriangleCount();
+
+        // The grid lies in the z = 0 plane with normals along +z.
+        EXPECT_LE(meshlet.coneCutoff, 1.f);
+        EXPECT(meshlet.isBackFacing(meshlet.boundsCenter - float3(0.f, 0.f, 10.f)));
+        EXPECT_FALSE(meshlet.isBackFacing(meshlet.boundsCenter + float3(0.f, 0.f, 10.f)));
+    }
+    EXPECT_EQ(nextTriangle, triangleCount);
+
+    // The result only depends on the input.
+    MeshOptimizer::Meshlets result2 = MeshOptimizer::buildMeshlets(indices, positions);
+    EXPECT(result2.vertices == result.vertices);
+    EXPECT(result2.triangles == result.triangles);
+
+    // Small limits and a folded mesh, which has no usable normal cone.
+    std::vector<uint32_t> foldedIndices = {0, 1, 2, 0, 2, 1, 0, 1, 3};
+    std::vector<float3> foldedPositions = {float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), float3(0.f, 0.f, 1.f)};
+    result = MeshOptimizer::buildMeshlets(foldedIndices, foldedPositions, 4, 3);
+    EXPECT_EQ(result.meshlets.size(), 1);
+    EXPECT_GT(result.meshlets[0].coneCutoff, 1.f);
+    EXPECT_FALSE(result.meshlets[0].isBackFacing(float3(0.2f, 0.2f, -5.f)));
+
+    result = MeshOptimizer::buildMeshlets(foldedIndices, foldedPositions, 3, 3);
+    EXPECT_EQ(result.meshlets.size(), 2);
+    EXPECT_EQ(result.meshlets[1].firstTriangle, 2);
+
+    EXPECT_THROW(MeshOptimizer::buildMeshlets(foldedIndices, foldedPositions, 257, 3));
+}
+} // namespace Falcor
@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include <chrono>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kTestRoot = getRuntimeDirectory() / "scene_cache_test_root";
+
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+} // namespace
+
+CPU_TEST(SceneCacheDependencies)
+{
+    std::filesystem::create_directories(kTestRoot);
+    const auto pathA = kTestRoot / "a.txt";
+    const auto pathB = kTestRoot / "b.txt";
+    writeFile(pathA, "scene");
+    writeFile(pathB, "texture");
+
+    // Missing files and directories are ignored, duplicates are removed.
+    auto manifest = SceneCache::createDependencyManifest({pathB, pathA, kTestRoot / "missing.txt", kTestRoot, pathB});
+    ASSERT_EQ(manifest.size(), 2);
+    EXPECT_EQ(manifest[0].path, pathA);
+    EXPECT_EQ(manifest[0].size, 5);
+    EXPECT_EQ(manifest[1].path, pathB);
+
+    // Validating unchanged files doesn't hash them.
+    bool updated = false;
+    EXPECT(SceneCache::validateDependencies(manifest, nullptr, &updated));
+    EXPECT(!updated);
+    EXPECT(!manifest[0].hashed && !manifest[1].hashed);
+
+    // Files are hashed once.
+    EXPECT(SceneCache::hashDependencies(manifest));
+    EXPECT(manifest[0].hashed && manifest[1].hashed);
+    EXPECT(manifest[0].hash == XXH3::hash128("scene", 5));
+    EXPECT(!SceneCache::hashDependencies(manifest));
+    EXPECT(SceneCache::validateDependencies(manifest, nullptr, &updated));
+    EXPECT(!updated);
+
+    // Touching a file without changing its content doesn't invalidate the manifest, and the new last write time is recorded.
+    std::filesystem::last_write_time(pathA, std::filesystem::last_write_time(pathA) + std::chrono::hours(1));
+    EXPECT(SceneCache::validateDependencies(manifest, nullptr, &updated));
+    EXPECT(updated);
+    EXPECT_EQ(manifest[0].lastWriteTime, std::filesystem::last_write_time(pathA).time_since_epoch().count());
+    EXPECT(SceneCache::validateDependencies(manifest, nullptr, &updated));
+    EXPECT(!updated);
+
+    // Changing the content does, even if the size stays the same.
+    std::filesystem::path changedPath;
+    writeFile(pathB, "texturf");
+    std::filesystem::last_write_time(pathB, std::filesystem::last_write_time(pathB) + std::chrono::hours(1));
+    EXPECT(!SceneCache::validateDependencies(manifest, &changedPath));
+    EXPECT_EQ(changedPath, pathB);
+
+    // Touching a file before it is hashed does too, as there is no hash to compare with. Touched files are not hashed.
+    manifest = SceneCache::createDependencyManifest({pathA, pathB});
+    std::filesystem::last_write_time(pathA, std::filesystem::last_write_time(pathA) + std::chrono::hours(1));
+    EXPECT(SceneCache::hashDependencies(manifest));
+    EXPECT(!manifest[0].hashed && manifest[1].hashed);
+    EXPECT(!SceneCache::validateDependencies(manifest, &changedPath));
+    EXPECT_EQ(changedPath, pathA);
+
+    manifest = SceneCache::createDependencyManifest({pathA, pathB});
+    EXPECT(SceneCache::validateDependencies(manifest));
+    writeFile(pathA, "scene2");
+    EXPECT(!SceneCache::validateDependencies(manifest, &changedPath));
+    EXPECT_EQ(changedPath, pathA);
+
+    manifest = SceneCache::createDependencyManifest({pathA, pathB});
+    std::filesystem::remove(pathB);
+    EXPECT(!SceneCache::validateDependencies(manifest, &changedPath));
+    EXPECT_EQ(changedPath, pathB);
+
+    std::filesystem::remove_all(kTestRoot);
+}
+
+CPU_TEST(SceneCacheMissingDependencies)
+{
+    std::filesystem::create_directories(kTestRoot);
+    const auto pathA = kTestRoot / "a.txt";
+    const auto pathB = kTestRoot / "b.txt";
+    writeFile(pathA, "scene");
+
+    // Paths that must not exist but do are ignored.
+    auto manifest = SceneCache::createDependencyManifest({pathA}, {pathB, pathA});
+    ASSERT_EQ(manifest.size(), 2);
+    EXPECT_EQ(manifest[0].path, pathA);
+    EXPECT(manifest[0].exists);
+    EXPECT_EQ(manifest[1].path, pathB);
+    EXPECT(!manifest[1].exists);
+    EXPECT(SceneCache::validateDependencies(manifest));
+
+    // Creating a file that was missing at build time invalidates the manifest.
+    std::filesystem::path changedPath;
+    writeFile(pathB, "texture");
+    EXPECT(!SceneCache::validateDependencies(manifest, &changedPath));
+    EXPECT_EQ(changedPath, pathB);
+
+    std::filesystem::remove(pathB);
+    EXPECT(SceneCache::validateDependencies(manifest));
+
+    std::filesystem::remove_all(kTestRoot);
+}
+} // namespace Falcor
@@ -0,0 +1,330 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/BatchScheduler.h"
+
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Renderer recording all calls, used to test the scheduling without a device.
+class StubRenderer : public BatchRenderer
+{
+public:
+    void loadScene(const std::filesystem::path& path) override
+    {
+        log.push_back("loadScene " + path.generic_string());
+        if (!scenes.insert(path.generic_string()).second)
+            throw std::runtime_error("Scene loaded twice.");
+        maxResidentScenes = std::max(maxResidentScenes, scenes.size());
+    }
+
+    void unloadScene(const std::filesystem::path& path) override
+    {
+        log.push_back("unloadScene " + path.generic_string());
+        if (scenes.erase(path.generic_string()) == 0)
+            throw std::runtime_error("Scene not loaded.");
+    }
+
+    void setActiveScene(const std::filesystem::path& path) override
+    {
+        if (!path.empty() && scenes.count(path.generic_string()) == 0)
+            throw std::runtime_error("Scene not loaded.");
+        activeScene = path.generic_string();
+    }
+
+    void loadGraph(const std::filesystem::path& path, const std::string& name) override
+    {
+        log.push_back("loadGraph " + path.generic_string());
+        if (!graphs.insert(path.generic_string() + name).second)
+            throw std::runtime_error("Graph loaded twice.");
+    }
+
+    void unloadGraph(const std::filesystem::path& path, const std::string& name) override
+    {
+        log.push_back("unloadGraph " + path.generic_string());
+        if (graphs.erase(path.generic_string() + name) == 0)
+            throw std::runtime_error("Graph not loaded.");
+    }
+
+    void setActiveGraph(const std::filesystem::path& path, const std::string& name) override
+    {
+        if (graphs.count(path.generic_string() + name) == 0)
+            throw std::runtime_error("Graph not loaded.");
+        activeGraph = path.generic_string() + name;
+    }
+
+    void beginJob(const BatchJob& job) override { log.push_back("begin " + job.name); }
+
+    void renderFrame(const BatchJob& job, uint64_t frame) override
+    {
+        log.push_back("render " + std::to_string(frame));
+        if (job.name == failJob)
+            throw std::runtime_error("Job failed.");
+    }
+
+    void captureFrame(const BatchJob& job, uint64_t frame) override { log.push_back("capture " + std::to_string(frame)); }
+    void endJob(const BatchJob& job) override { log.push_back("end " + job.name); }
+
+    std::vector<std::string> log;
+    std::set<std::string> scenes;
+    std::set<std::string> graphs;
+    std::string activeScene;
+    std::string activeGraph;
+    size_t maxResidentScenes = 0;
+    std::string failJob;
+};
+
+BatchJob makeJob(const std::string& name, const std::string& scene, const std::string& graph, uint32_t width = 0, uint32_t height = 0)
+{
+    BatchJob job;
+    job.name = name;
+    job.scene = scene;
+    job.graph = graph;
+    job.width = width;
+    job.height = height;
+    return job;
+}
+
+std::vector<BatchJob> makeJobs()
+{
+    return {
+        makeJob("A", "X.pyscene", "g1.py"),
+        makeJob("B", "Y.pyscene", "g1.py"),
+        makeJob("C", "X.pyscene", "g2.py"),
+        makeJob("D", "X.pyscene", "g1.py", 512, 512),
+        makeJob("E", "Y.pyscene", "g2.py"),
+    };
+}
+
+std::vector<std::string> getNames(const std::vector<BatchScheduler::JobResult>& results)
+{
+    std::vector<std::string> names;
+    for (const auto& result : results)
+        names.push_back(result.name);
+    return names;
+}
+} // namespace
+
+CPU_TEST(BatchScheduler_Schedule)
+{
+    auto jobs = makeJobs();
+
+    // Jobs are grouped by scene, then graph, then size. The second scene starts with the graph used last.
+    BatchScheduler scheduler;
+    EXPECT(scheduler.schedule(jobs) == std::vector<size_t>({0, 3, 2, 4, 1}));
+
+    BatchScheduler::Options options;
+    options.reorder = false;
+    BatchScheduler unordered(options);
+    EXPECT(unordered.schedule(jobs) == std::vector<size_t>({0, 1, 2, 3, 4}));
+}
+
+CPU_TEST(BatchScheduler_Run)
+{
+    auto jobs = makeJobs();
+    jobs[0].captureFrames = {2, 3};
+
+    StubRenderer renderer;
+    BatchScheduler scheduler;
+    auto results = scheduler.run(renderer, jobs);
+    EXPECT(getNames(results) == std::vector<std::string>({"A", "D", "C", "E", "B"}));
+    for (const auto& result : results)
+    {
+        EXPECT(result.success);
+        EXPECT(result.error.empty());
+    }
+
+    // Frames are rendered up to each capture frame.
+    EXPECT_EQ(results[0].frameCount, 3);
+    EXPECT_EQ(results[0].captureCount, 2);
+    const std::vector<std::string> expectedLog = {
+        "loadScene X.pyscene", "loadGraph g1.py", "begin A", "render 1", "render 2", "capture 2", "render 3", "capture 3", "end A",
+    };
+    EXPECT(std::vector<std::string>(renderer.log.begin(), renderer.log.begin() + expectedLog.size()) == expectedLog);
+
+    // Only one scene is resident by default, the first scene is unloaded before loading the second.
+    const auto& stats = scheduler.getStats();
+    EXPECT_EQ(stats.jobCount, 5);
+    EXPECT_EQ(stats.failedCount, 0);
+    EXPECT_EQ(stats.sceneLoadCount, 2);
+    EXPECT_EQ(stats.sceneReuseCount, 3);
+    EXPECT_EQ(stats.graphLoadCount, 2);
+    EXPECT_EQ(stats.graphReuseCount, 3);
+    EXPECT_EQ(renderer.maxResidentScenes, 1);
+    EXPECT(!results[0].sceneReused);
+    EXPECT(results[1].sceneReused);
+    EXPECT(results[3].graphReused);
+
+    // The resident set is kept across runs, a second run starts with the resident scene and graph.
+    auto results2 = scheduler.run(renderer, jobs);
+    EXPECT(getNames(results2) == std::vector<std::string>({"B", "E", "C", "A", "D"}));
+    EXPECT(results2[0].sceneReused);
+    EXPECT(results2[0].graphReused);
+    EXPECT_EQ(scheduler.getStats().sceneLoadCount, 3);
+    EXPECT_EQ(scheduler.getStats().graphLoadCount, 2);
+
+    scheduler.releaseAll(renderer);
+    EXPECT(renderer.scenes.empty());
+    EXPECT(renderer.graphs.empty());
+}
+
+CPU_TEST(BatchScheduler_ResidentLimits)
+{
+    auto jobs = makeJobs();
+
+    BatchScheduler::Options options;
+    options.reorder = false;
+    options.maxResidentScenes = 2;
+    options.maxResidentGraphs = 1;
+    StubRenderer renderer;
+    BatchScheduler scheduler(options);
+    scheduler.run(renderer, jobs);
+
+    EXPECT_EQ(renderer.maxResidentScenes, 2);
+    EXPECT_EQ(scheduler.getStats().sceneLoadCount, 2);
+    EXPECT_EQ(scheduler.getStats().graphLoadCount, 4);
+    EXPECT_EQ(renderer.graphs.size(), 1);
+    scheduler.releaseAll(renderer);
+}
+
+CPU_TEST(BatchScheduler_Errors)
+{
+    auto jobs = makeJobs();
+
+    {
+        StubRenderer renderer;
+        renderer.failJob = "D";
+        BatchScheduler scheduler;
+        auto results = scheduler.run(renderer, jobs);
+        EXPECT_EQ(results.size(), 5);
+        EXPECT(!results[1].success);
+        EXPECT(!results[1].skipped);
+        EXPECT_EQ(results[1].error, "Job failed.");
+        EXPECT(results[2].success);
+        EXPECT_EQ(scheduler.getStats().failedCount, 1);
+        // A job failing after it began is still ended.
+        EXPECT(std::find(renderer.log.begin(), renderer.log.end(), "end D") != renderer.log.end());
+        scheduler.releaseAll(renderer);
+    }
+
+    {
+        StubRenderer renderer;
+        renderer.failJob = "D";
+        BatchScheduler::Options options;
+        options.stopOnError = true;
+        BatchScheduler scheduler(options);
+        auto results = scheduler.run(renderer, jobs);
+        EXPECT(results[0].success);
+        EXPECT(!results[1].success);
+        for (size_t i = 2; i < results.size(); i++)
+        {
+            EXPECT(results[i].skipped);
+            EXPECT(!results[i].success);
+        }
+        EXPECT_EQ(scheduler.getStats().failedCount, 4);
+        EXPECT(std::find(renderer.log.begin(), renderer.log.end(), "begin C") == renderer.log.end());
+        scheduler.releaseAll(renderer);
+    }
+}
+
+CPU_TEST(BatchScheduler_LoadJobs)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "falcor_batch_scheduler";
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path path = directory / "jobs.json";
+    {
+        std::ofstream ofs(path);
+        ofs << R"({
+            // Scheduler options.
+            "stopOnError": true,
+            "maxResidentScenes": 2,
+            "jobs": [
+                { "name": "first", "scene": "Arcade/Arcade.pyscene", "graph": "graphs/PathTracer.py", "resolution": [640, 360],
+                  "frames": [16, 32], "outputs": ["AccumulatePass.output"], "outputDirectory": "out" },
+                { "graph": "graphs/PathTracer.py", "graphName": "PT", "camera": "Top" }
+            ]
+        })";
+    }
+
+    BatchScheduler::Options options;
+    auto jobs = BatchScheduler::loadJobs(path, options);
+    EXPECT(options.stopOnError);
+    EXPECT_EQ(options.maxResidentScenes, 2);
+    EXPECT(options.reorder);
+    ASSERT_EQ(jobs.size(), 2);
+
+    EXPECT_EQ(jobs[0].name, "first");
+    EXPECT(jobs[0].scene == "Arcade/Arcade.pyscene");
+    EXPECT(jobs[0].graph == std::filesystem::absolute(directory) / "graphs/PathTracer.py");
+    EXPECT_EQ(jobs[0].width, 640);
+    EXPECT_EQ(jobs[0].height, 360);
+    EXPECT(jobs[0].captureFrames == std::vector<uint64_t>({16, 32}));
+    EXPECT(jobs[0].outputs == std::vector<std::string>({"AccumulatePass.output"}));
+    EXPECT(jobs[0].outputDirectory == std::filesystem::absolute(directory) / "out");
+
+    EXPECT_EQ(jobs[1].name, "job1");
+    EXPECT(jobs[1].scene.empty());
+    EXPECT_EQ(jobs[1].graphName, "PT");
+    EXPECT_EQ(jobs[1].camera, "Top");
+    EXPECT_EQ(jobs[1].width, 0);
+    EXPECT(jobs[1].captureFrames == std::vector<uint64_t>({1}));
+
+    // Unknown keys and invalid frame lists are errors.
+    for (const char* content : {
+             R"([{ "graph": "g.py", "frame": [1] }])",
+             R"([{ "graph": "g.py", "frames": [2, 1] }])",
+             R"([{ "scene": "s.pyscene" }])",
+             R"({ "reorderJobs": false, "jobs": [] })",
+         })
+    {
+        {
+            std::ofstream ofs(path);
+            ofs << content;
+        }
+        bool thrown = false;
+        try
+        {
+            BatchScheduler::loadJobs(path, options);
+        }
+        catch (const std::exception&)
+        {
+            thrown = true;
+        }
+        EXPECT_MSG(thrown, content);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -27,7 +27,10 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <fstream>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -59,4 +62,172 @@ CPU_TEST(SHA1)
         EXPECT(SHA1::compute(str.data(), str.size()) == md);
     }
 }
+
+CPU_TEST(SHA1ToString)
+{
+    // Digests with bytes below 0x10 must keep their leading zeros.
+    EXPECT_EQ(SHA1::toString(SHA1::compute(nullptr, 0)), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+
+    std::string str{"Hello World!"};
+    EXPECT_EQ(SHA1::toString(SHA1::compute(str.data(), str.size())), "2ef7bde608ce5404e97d5f042f95f89f1c232871");
+}
+
+CPU_TEST(SHA1HardwareAcceleration)
+{
+    if (!SHA1::isHardwareAccelerationSupported())
+        ctx.skip("SHA instructions not supported");
+
+    std::mt19937 rng(1);
+    std::vector<uint8_t> data(4096);
+    for (auto& b : data)
+        b = (uint8_t)rng();
+
+    // Compare against the portable implementation for various sizes, with the data split over two updates.
+    auto compute = [&](size_t len, size_t split)
+    {
+        SHA1 sha1;
+        sha1.update(data.data(), split);
+        sha1.update(data.data() + split, len - split);
+        return sha1.finalize();
+    };
+
+    for (size_t len : {0, 1, 55, 56, 63, 64, 65, 127, 128, 1000, 4096})
+    {
+        size_t split = len > 0 ? rng() % len : 0;
+        SHA1::setHardwareAccelerationEnabled(false);
+        EXPECT(!SHA1::isHardwareAccelerationEnabled());
+        SHA1::MD expected = compute(len, split);
+        SHA1::setHardwareAccelerationEnabled(true);
+        EXPECT(SHA1::isHardwareAccelerationEnabled());
+        EXPECT(compute(len, split) == expected) << "len=" << len << " split=" << split;
+    }
+}
+
+namespace
+{
+std::vector<uint8_t> createXXH3TestData(size_t len)
+{
+    std::vector<uint8_t> data(len);
+    for (size_t i = 0; i < len; i++)
+        data[i] = uint8_t(i * 7 + (i >> 8));
+    return data;
+}
+} // namespace
+
+CPU_TEST(XXH3)
+{
+    // Reference values computed with xxHash 0.8.
+    struct TestCase
+    {
+        size_t len;
+        uint64_t hash64;
+        XXH3::Hash128 hash128;
+        uint64_t seededHash64;
+        XXH3::Hash128 seededHash128;
+    };
+    const uint64_t kSeed = 0x1234567890abcdefull;
+    // clang-format off
+    const TestCase kTestCases[] = {
+        {0, 0x2d06800538d394c2ull, {0x6001c324468d497full, 0x99aa06d3014798d8ull},
+            0xb5991a1202758c1dull, {0xac58ea339c643281ull, 0xb67ab81a27f3a0beull}},
+        {1, 0xc44bdff4074eecdbull, {0xc44bdff4074eecdbull, 0xa6cd5e9392000f6aull},
+            0x446f0cb058c57375ull, {0x446f0cb058c57375ull, 0x62b21a420b4bbc9bull}},
+        {3, 0xc3489259e968ad9eull, {0xc3489259e968ad9eull, 0x656e81c56e41fe02ull},
+            0xd50ea84693870896ull, {0xd50ea84693870896ull, 0x9f72af372ba3f9c2ull}},
+        {4, 0xd3d60c1519014e89ull, {0x81a65295de8e7ddeull, 0xab5c3e7474d809dbull},
+            0xe774031422f0dec3ull, {0x8cfb8874a9a6bfc2ull, 0x85e2f48f38c2f5bfull}},
+        {8, 0xb88dee77f6bf6980ull, {0xebabbd0695002ff6ull, 0xe4b9dd0b66ff3c50ull},
+            0x7c5fe40ad458fd72ull, {0xdf94d1a5e25503efull, 0x514858e0e2837a02ull}},
+        {9, 0x03688dcad730d826ull, {0x1c69c3f04aaed08cull, 0x82ddc95bc7600767ull},
+            0xfe5377a221124e1cull, {0xdb363821d2cfc9fdull, 0x7c1e48f7545bb6fcull}},
+        {16, 0x9da23836adf2be1eull, {0x94eaa17b20756f46ull, 0xddf6c1254d70f767ull},
+            0x254b9bfb1f0a7e65ull, {0x3371658729004b28ull, 0x3f5dc4f867c806b9ull}},
+        {17, 0xf34c3c9cf5a112d1ull, {0x735fe434ded90c3cull, 0x263f67af63088041ull},
+            0x87c7d7bd9e14a695ull, {0xa782f2fab71ef95bull, 0x69020a9df2496278ull}},
+        {128, 0x65f3c2c00fa93185ull, {0xc6bd21ecc865f29full, 0xdd9e5aa9bd51cc9cull},
+            0xb8f5446ff6880718ull, {0xf2f19c95d00fa483ull, 0xebdd09e4439d05aaull}},
+        {129, 0x28065c6ec25f5b25ull, {0x7f4accb76587485bull, 0x00433635cf8d872eull},
+            0xf9955a200de72af7ull, {0x7a30b538871d3ca7ull, 0x7598c4c6fc63d7f6ull}},
+        {240, 0x4917a75c0ef8eed7ull, {0xd10beb4e0599e4b3ull, 0x89e3a0a2ee355d25ull},
+            0x74376bc8d848060dull, {0x2b87608fc6979d1eull, 0xb5313096635276fcull}},
+        {241, 0x541b19226f0052e8ull, {0x541b19226f0052e8ull, 0x75f4da43f23cce5aull},
+            0x86586093f89b1b6full, {0x86586093f89b1b6full, 0x5e368c76faa6621dull}},
+        {1024, 0x71bee625238addb4ull, {0x71bee625238addb4ull, 0xa3da96fbd6887361ull},
+            0x7cee9b94b2e4167cull, {0x7cee9b94b2e4167cull, 0xff7328e243987f2aull}},
+        {100000, 0xb25cea78018497ffull, {0xb25cea78018497ffull, 0x4e53faeda1b5812bull},
+            0x834c897cece0f8a6ull, {0x834c897cece0f8a6ull, 0x0a6866c6558c9525ull}},
+    };
+    // clang-format on
+
+    const std::vector<uint8_t> data = createXXH3TestData(100000);
+    for (const auto& t : kTestCases)
+    {
+        EXPECT_EQ(XXH3::hash64(data.data(), t.len), t.hash64) << "len=" << t.len;
+        EXPECT(XXH3::hash128(data.data(), t.len) == t.hash128) << "len=" << t.len;
+        EXPECT_EQ(XXH3::hash64(data.data(), t.len, kSeed), t.seededHash64) << "len=" << t.len;
+        EXPECT(XXH3::hash128(data.data(), t.len, kSeed) == t.seededHash128) << "len=" << t.len;
+    }
+
+    EXPECT_EQ(XXH3::toString(XXH3::hash128("Hello World!", 12)), "bbce2257f0cec895f56f7a348bed5898");
+}
+
+CPU_TEST(XXH3Streaming)
+{
+    const std::vector<uint8_t> data = createXXH3TestData(100000);
+    std::mt19937 rng(1);
+
+    // Streaming with random update sizes gives the same result as hashing in one go.
+    for (size_t len : {0, 5, 100, 240, 241, 256, 257, 1024, 1025, 100000})
+    {
+        for (uint64_t seed : {0ull, 0x1234567890abcdefull})
+        {
+            XXH3 xxh3(seed);
+            size_t offset = 0;
+            while (offset < len)
+            {
+                size_t size = std::min<size_t>(len - offset, rng() % 600);
+                xxh3.update(data.data() + offset, size);
+                offset += size;
+            }
+            EXPECT_EQ(xxh3.digest64(), XXH3::hash64(data.data(), len, seed)) << "len=" << len << " seed=" << seed;
+            EXPECT(xxh3.digest128() == XXH3::hash128(data.data(), len, seed)) << "len=" << len << " seed=" << seed;
+        }
+    }
+
+    // Computing the digest doesn't change the state.
+    XXH3 xxh3;
+    xxh3.update(data.data(), 1000);
+    EXPECT_EQ(xxh3.digest64(), XXH3::hash64(data.data(), 1000));
+    xxh3.update(data.data() + 1000, 1000);
+    EXPECT_EQ(xxh3.digest64(), XXH3::hash64(data.data(), 2000));
+}
+
+CPU_TEST(XXH3Tree)
+{
+    const std::vector<uint8_t> data = createXXH3TestData(100000);
+
+    // Data that fits into a single chunk is hashed as usual.
+    EXPECT(XXH3::hashTree128(data.data(), data.size(), data.size()) == XXH3::hash128(data.data(), data.size()));
+
+    // Tree hash depends on the data and the chunk size.
+    XXH3::Hash128 tree = XXH3::hashTree128(data.data(), data.size(), 4096);
+    EXPECT(tree == XXH3::hashTree128(data.data(), data.size(), 4096));
+    EXPECT(tree != XXH3::hash128(data.data(), data.size()));
+    EXPECT(tree != XXH3::hashTree128(data.data(), data.size(), 8192));
+    EXPECT(tree != XXH3::hashTree128(data.data(), data.size() - 1, 4096));
+
+    // Hash file.
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_xxh3_test.bin";
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    EXPECT(XXH3::hashFile(path, 4096) == tree);
+    EXPECT(XXH3::hashFile(path) == XXH3::hash128(data.data(), data.size()));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).close();
+    EXPECT(XXH3::hashFile(path) == XXH3::hash128(nullptr, 0));
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(XXH3::hashFile(path));
+}
 } // namespace Falcor
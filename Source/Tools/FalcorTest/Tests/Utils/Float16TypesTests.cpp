@@ -29,6 +29,7 @@
 #include "Utils/Math/ScalarMath.h"
 #include <fstd/bit.h> // TODO C++20: Replace with <bit>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -162,4 +163,42 @@ CPU_TEST(Float16Scalar)
         EXPECT_EQ(fstd::bit_cast<uint16_t>(result), fstd::bit_cast<uint16_t>(expected));
     }
 }
+
+CPU_TEST(Float16BatchConversion)
+{
+    // Converting all bit patterns in a batch matches the scalar conversion.
+    std::vector<uint16_t> halfs(0x10000);
+    for (uint32_t bits = 0; bits < 0x10000; bits++)
+        halfs[bits] = (uint16_t)bits;
+
+    std::vector<float> floats(halfs.size());
+    math::float16ToFloat32(halfs.data(), floats.data(), halfs.size());
+    for (size_t i = 0; i < halfs.size(); i++)
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(floats[i]), fstd::bit_cast<uint32_t>(math::float16ToFloat32(halfs[i])));
+
+    // Round trip through the batch conversion, excluding NaNs which have multiple encodings.
+    std::vector<uint16_t> roundTrip(halfs.size());
+    math::float32ToFloat16(floats.data(), roundTrip.data(), floats.size());
+    for (size_t i = 0; i < halfs.size(); i++)
+    {
+        if (!std::isnan(floats[i]))
+            EXPECT_EQ(roundTrip[i], halfs[i]);
+    }
+
+    // Random floats including values outside the float16 range, denormals and an odd count to exercise the tail.
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::uniform_int_distribution<int> exponent(-30, 20);
+    floats.resize(100003);
+    for (auto& f : floats)
+        f = std::ldexp(dist(rng), exponent(rng));
+    floats[0] = std::numeric_limits<float>::infinity();
+    floats[1] = -std::numeric_limits<float>::infinity();
+    floats[2] = std::numeric_limits<float>::quiet_NaN();
+    floats[3] = 65520.f; // Rounds to infinity.
+
+    halfs.resize(floats.size());
+    math::float32ToFloat16(floats.data(), halfs.data(), floats.size());
+    for (size_t i = 0; i < floats.size(); i++)
+        EXPECT_EQ(halfs[i], math::float32ToFloat16(floats[i]));
+}
 } // namespace Falcor
@@ -0,0 +1,195 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/FrameTimingAnalyzer.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace Falcor
+{
+CPU_TEST(FrameTimingAnalyzer_Histogram)
+{
+    FrameTimingAnalyzer::Histogram h;
+    EXPECT_EQ(h.getCount(), 0);
+    EXPECT_EQ(h.getPercentile(0.5), 0.0);
+
+    // Uniform values in [1,100].
+    for (uint32_t i = 1; i <= 100; i++)
+        h.record(double(i));
+    EXPECT_EQ(h.getCount(), 100);
+    EXPECT_EQ(h.getMin(), 1.0);
+    EXPECT_EQ(h.getMax(), 100.0);
+    EXPECT_EQ(h.getMean(), 50.5);
+
+    // Percentiles are within the relative precision of the histogram.
+    const double kTolerance = FrameTimingAnalyzer::Histogram::kPrecision;
+    EXPECT_LE(std::abs(h.getPercentile(0.5) / 50.0 - 1.0), kTolerance);
+    EXPECT_LE(std::abs(h.getPercentile(0.95) / 95.0 - 1.0), kTolerance);
+    EXPECT_LE(std::abs(h.getPercentile(0.99) / 99.0 - 1.0), kTolerance);
+    EXPECT_EQ(h.getPercentile(0.0), 1.0);
+    EXPECT_EQ(h.getPercentile(1.0), 100.0);
+
+    // Compare against exact percentiles of a skewed distribution.
+    FrameTimingAnalyzer::Histogram h2;
+    std::vector<double> values;
+    std::mt19937 rng(1);
+    std::lognormal_distribution<double> dist(2.5, 0.5);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        values.push_back(dist(rng));
+        h2.record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+    for (double p : {0.5, 0.95, 0.99})
+    {
+        double exact = values[size_t(std::ceil(p * values.size())) - 1];
+        EXPECT_LE(std::abs(h2.getPercentile(p) / exact - 1.0), kTolerance) << "p=" << p;
+    }
+}
+
+CPU_TEST(FrameTimingAnalyzer_Stutters)
+{
+    FrameTimingAnalyzer::Options options;
+    options.stutterThreshold = 2.0;
+    options.medianWindow = 10;
+    FrameTimingAnalyzer analyzer(options);
+
+    // No stutter detection until half of the window is filled.
+    EXPECT(!analyzer.recordFrame(0, 100.0));
+    for (uint64_t i = 1; i < 20; i++)
+        EXPECT(!analyzer.recordFrame(i, 10.0 + (i % 3)));
+
+    analyzer.addEvent("blas_build");
+    analyzer.addEvent("blas_build");
+    analyzer.addEvent("animation");
+    EXPECT(analyzer.recordFrame(20, 30.0));
+
+    // A single stutter doesn't move the median.
+    analyzer.addEvent("animation");
+    EXPECT(!analyzer.recordFrame(21, 15.0));
+    EXPECT(analyzer.recordFrame(22, 25.0));
+
+    EXPECT_EQ(analyzer.getFrameCount(), 23);
+    EXPECT_EQ(analyzer.getStutterCount(), 2);
+    const auto& stutters = analyzer.getStutters();
+    ASSERT_EQ(stutters.size(), 2);
+    EXPECT_EQ(stutters[0].frame, 20);
+    EXPECT_EQ(stutters[0].frameTimeMs, 30.0);
+    EXPECT_EQ(stutters[0].medianMs, 11.0);
+    ASSERT_EQ(stutters[0].events.size(), 2);
+    EXPECT_EQ(stutters[0].events[0], "blas_build");
+    EXPECT_EQ(stutters[1].frame, 22);
+    EXPECT(stutters[1].events.empty());
+
+    const auto& events = analyzer.getEventStats();
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events.at("animation").frameCount, 2);
+    EXPECT_EQ(events.at("animation").stutterCount, 1);
+    EXPECT_EQ(events.at("blas_build").frameCount, 1);
+    EXPECT_EQ(events.at("blas_build").stutterCount, 1);
+
+    // Only a limited number of stutters are kept.
+    options.maxStutterRecords = 1;
+    options.medianWindow = 1;
+    FrameTimingAnalyzer analyzer2(options);
+    for (uint64_t i = 0; i < 10; i++)
+        analyzer2.recordFrame(i, double(1 << (2 * i)));
+    EXPECT_EQ(analyzer2.getStutterCount(), 9);
+    EXPECT_EQ(analyzer2.getStutters().size(), 1);
+}
+
+CPU_TEST(FrameTimingAnalyzer_Passes)
+{
+    FrameTimingAnalyzer analyzer;
+    for (uint64_t i = 0; i < 100; i++)
+        analyzer.recordFrame(i, 16.0, {{"GBuffer", 1.0, 2.0}, {"PathTracer", 5.0, double(i)}});
+
+    EXPECT(analyzer.getPassCpuTimeHistogram("Missing") == nullptr);
+    const auto* pCpu = analyzer.getPassCpuTimeHistogram("GBuffer");
+    const auto* pGpu = analyzer.getPassGpuTimeHistogram("PathTracer");
+    ASSERT(pCpu != nullptr);
+    ASSERT(pGpu != nullptr);
+    EXPECT_EQ(pCpu->getCount(), 100);
+    EXPECT_EQ(pCpu->getPercentile(0.99), 1.0);
+    EXPECT_EQ(pGpu->getMax(), 99.0);
+    EXPECT_LE(std::abs(pGpu->getPercentile(0.95) / 94.0 - 1.0), FrameTimingAnalyzer::Histogram::kPrecision);
+}
+
+CPU_TEST(FrameTimingAnalyzer_Output)
+{
+    const std::filesystem::path streamPath = std::filesystem::temp_directory_path() / "falcor_frame_timing_test.jsonl";
+    const std::filesystem::path summaryPath = std::filesystem::temp_directory_path() / "falcor_frame_timing_test.json";
+
+    FrameTimingAnalyzer::Options options;
+    options.medianWindow = 4;
+    FrameTimingAnalyzer analyzer(options);
+    analyzer.openStream(streamPath);
+    for (uint64_t i = 0; i < 8; i++)
+        analyzer.recordFrame(i, 10.0, {{"Pass", 1.0, 2.0}});
+    analyzer.addEvent("texture_load");
+    analyzer.recordFrame(8, 50.0);
+    analyzer.closeStream();
+
+    // One JSON object per frame.
+    std::ifstream ifs(streamPath);
+    std::string line;
+    uint32_t lineCount = 0;
+    nlohmann::json last;
+    while (std::getline(ifs, line))
+    {
+        last = nlohmann::json::parse(line);
+        if (lineCount < 8)
+            EXPECT_EQ(last["passes"]["Pass"]["gpu"].get<double>(), 2.0);
+        lineCount++;
+    }
+    EXPECT_EQ(lineCount, 9);
+    EXPECT_EQ(last["frame"].get<uint64_t>(), 8);
+    EXPECT_EQ(last["stutter"].get<bool>(), true);
+    EXPECT_EQ(last["events"][0].get<std::string>(), "texture_load");
+
+    analyzer.writeSummary(summaryPath);
+    nlohmann::json summary = nlohmann::json::parse(std::ifstream(summaryPath));
+    EXPECT_EQ(summary["frameCount"].get<uint64_t>(), 9);
+    EXPECT_EQ(summary["stutterCount"].get<uint64_t>(), 1);
+    EXPECT_LE(std::abs(summary["frameTime"]["p50"].get<double>() / 10.0 - 1.0), FrameTimingAnalyzer::Histogram::kPrecision);
+    EXPECT_EQ(summary["frameTime"]["max"].get<double>(), 50.0);
+    EXPECT_EQ(summary["passes"]["Pass"]["cpu"]["count"].get<uint64_t>(), 8);
+    EXPECT_EQ(summary["events"]["texture_load"]["stutterRate"].get<double>(), 1.0);
+    EXPECT_EQ(summary["stutters"][0]["frame"].get<uint64_t>(), 8);
+
+    ifs.close();
+    std::filesystem::remove(streamPath);
+    std::filesystem::remove(summaryPath);
+}
+} // namespace Falcor
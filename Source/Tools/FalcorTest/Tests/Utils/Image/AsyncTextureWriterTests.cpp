@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureWriter.h"
+#include "Utils/Image/Bitmap.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 16;
+const uint32_t kHeight = 8;
+
+std::vector<uint8_t> generatePattern(uint32_t seed)
+{
+    std::vector<uint8_t> data(kWidth * kHeight * 4);
+    for (uint32_t i = 0; i < kWidth * kHeight; i++)
+    {
+        data[4 * i + 0] = uint8_t(i + seed * 31);
+        data[4 * i + 1] = uint8_t(i * 3 + seed);
+        data[4 * i + 2] = uint8_t(seed * 17);
+        data[4 * i + 3] = 255;
+    }
+    return data;
+}
+} // namespace
+
+GPU_TEST(AsyncTextureWriter_Write)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    const uint32_t kFrameCount = 6;
+    std::vector<std::filesystem::path> paths;
+    for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        paths.push_back(std::filesystem::temp_directory_path() / fmt::format("falcor_async_texture_writer_{}.png", frame));
+
+    ref<Texture> pTexture = pDevice->createTexture2D(kWidth, kHeight, ResourceFormat::RGBA8Unorm, 1, 1, nullptr);
+
+    {
+        // Limit the pending data to a single image to exercise the back-pressure path.
+        AsyncTextureWriter::Options options;
+        options.maxFramesInFlight = 2;
+        options.maxConcurrentEncodes = 2;
+        options.maxPendingBytes = 1;
+        AsyncTextureWriter writer(pDevice, options);
+
+        // The texture is overwritten right after each write, the files must contain the data at the time of the write.
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            pRenderContext->updateTextureData(pTexture.get(), generatePattern(frame).data());
+            writer.write(
+                pRenderContext, pTexture, 0, 0, paths[frame], Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, frame
+            );
+            writer.poll();
+        }
+        writer.flush();
+
+        auto stats = writer.getStats();
+        EXPECT_EQ(stats.frameCount, kFrameCount);
+        EXPECT_EQ(stats.imageCount, kFrameCount);
+        EXPECT_EQ(stats.failedCount, 0);
+        EXPECT_EQ(stats.pendingImageCount, 0);
+        EXPECT_EQ(stats.pendingBytes, 0);
+        EXPECT_GE(stats.stagingBufferCount, 1);
+        EXPECT_LE(stats.stagingBufferCount, 2);
+        ASSERT_EQ(stats.recentFrames.size(), kFrameCount);
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            EXPECT_EQ(stats.recentFrames[frame].frameID, frame);
+            EXPECT_EQ(stats.recentFrames[frame].imageCount, 1);
+            EXPECT_LE(stats.recentFrames[frame].readbackLatencyMs, stats.recentFrames[frame].totalLatencyMs);
+        }
+    }
+
+    for (uint32_t frame = 0; frame < kFrameCount; frame++)
+    {
+        auto pBitmap = Bitmap::createFromFile(paths[frame], true);
+        ASSERT(pBitmap != nullptr);
+        ASSERT_EQ(pBitmap->getWidth(), kWidth);
+        ASSERT_EQ(pBitmap->getHeight(), kHeight);
+        ASSERT_EQ((uint32_t)pBitmap->getFormat(), (uint32_t)ResourceFormat::BGRA8Unorm);
+
+        const auto expected = generatePattern(frame);
+        const uint8_t* pData = pBitmap->getData();
+        for (uint32_t i = 0; i < kWidth * kHeight; i++)
+        {
+            EXPECT_EQ(pData[4 * i + 2], expected[4 * i + 0]) << "frame=" << frame << " i=" << i;
+            EXPECT_EQ(pData[4 * i + 1], expected[4 * i + 1]) << "frame=" << frame << " i=" << i;
+            EXPECT_EQ(pData[4 * i + 0], expected[4 * i + 2]) << "frame=" << frame << " i=" << i;
+        }
+
+        std::filesystem::remove(paths[frame]);
+    }
+}
+} // namespace Falcor
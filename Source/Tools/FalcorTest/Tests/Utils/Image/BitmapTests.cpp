@@ -27,9 +27,456 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageDecoder.h"
+#include "Utils/Math/Float16.h"
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace Falcor
 {
+namespace
+{
+void appendBE32(std::vector<uint8_t>& data, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        data.push_back(uint8_t(value >> shift));
+}
+
+uint32_t crc32(const uint8_t* pData, size_t size)
+{
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= pData[i];
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+void appendChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data)
+{
+    appendBE32(png, (uint32_t)data.size());
+    const size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    appendBE32(png, crc32(png.data() + start, png.size() - start));
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    int p = int(a) + int(b) - int(c);
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+/**
+ * Encode a PNG image. Row y uses filter type y % 5. The image data is stored in uncompressed deflate blocks
+ * and split into the given number of IDAT chunks.
+ */
+std::vector<uint8_t> encodePNG(
+    uint32_t width,
+    uint32_t height,
+    uint8_t bitDepth,
+    uint8_t colorType,
+    const std::vector<uint8_t>& pixels,
+    uint32_t dataChunkCount = 1,
+    const std::vector<std::pair<const char*, std::vector<uint8_t>>>& extraChunks = {}
+)
+{
+    const uint32_t channelCount = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 4 ? 2 : colorType == 6 ? 4 : 1;
+    const size_t bpp = std::max(1u, channelCount * bitDepth / 8);
+    const size_t rowBytes = pixels.size() / height;
+
+    // Filter the rows.
+    std::vector<uint8_t> filtered;
+    std::vector<uint8_t> zeroRow(rowBytes, 0);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t* pRow = pixels.data() + y * rowBytes;
+        const uint8_t* pPrev = y > 0 ? pRow - rowBytes : zeroRow.data();
+        const uint8_t filter = uint8_t(y % 5);
+        filtered.push_back(filter);
+        for (size_t i = 0; i < rowBytes; i++)
+        {
+            const uint8_t a = i >= bpp ? pRow[i - bpp] : 0;
+            const uint8_t b = pPrev[i];
+            const uint8_t c = i >= bpp ? pPrev[i - bpp] : 0;
+            const uint8_t predictor = filter == 0 ? 0 : filter == 1 ? a : filter == 2 ? b : filter == 3 ? uint8_t((a + b) / 2) : paeth(a, b, c);
+            filtered.push_back(uint8_t(pRow[i] - predictor));
+        }
+    }
+
+    // Wrap in a zlib stream with stored blocks.
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    for (size_t offset = 0; offset < filtered.size() || offset == 0;)
+    {
+        const size_t length = std::min<size_t>(filtered.size() - offset, 65535);
+        const bool isFinal = offset + length == filtered.size();
+        zlib.push_back(isFinal ? 1 : 0);
+        zlib.push_back(uint8_t(length));
+        zlib.push_back(uint8_t(length >> 8));
+        zlib.push_back(uint8_t(~length));
+        zlib.push_back(uint8_t(~length >> 8));
+        zlib.insert(zlib.end(), filtered.begin() + offset, filtered.begin() + offset + length);
+        offset += length;
+        if (isFinal)
+            break;
+    }
+    uint32_t s1 = 1, s2 = 0;
+    for (uint8_t v : filtered)
+    {
+        s1 = (s1 + v) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    appendBE32(zlib, (s2 << 16) | s1);
+
+    std::vector<uint8_t> png = {137, 80, 78, 71, 13, 10, 26, 10};
+    std::vector<uint8_t> header;
+    appendBE32(header, width);
+    appendBE32(header, height);
+    header.insert(header.end(), {bitDepth, colorType, 0, 0, 0});
+    appendChunk(png, "IHDR", header);
+    for (const auto& [type, data] : extraChunks)
+        appendChunk(png, type, data);
+
+    const size_t chunkSize = (zlib.size() + dataChunkCount - 1) / dataChunkCount;
+    for (size_t offset = 0; offset < zlib.size(); offset += chunkSize)
+        appendChunk(png, "IDAT", std::vector<uint8_t>(zlib.begin() + offset, zlib.begin() + std::min(offset + chunkSize, zlib.size())));
+    appendChunk(png, "IEND", {});
+    return png;
+}
+
+template<typename T>
+void appendLE(std::vector<uint8_t>& data, T value)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t>& data, const char* str)
+{
+    data.insert(data.end(), str, str + std::strlen(str) + 1);
+}
+
+void appendAttribute(std::vector<uint8_t>& exr, const char* name, const char* type, const std::vector<uint8_t>& value)
+{
+    appendString(exr, name);
+    appendString(exr, type);
+    appendLE(exr, (int32_t)value.size());
+    exr.insert(exr.end(), value.begin(), value.end());
+}
+
+/**
+ * Encode an uncompressed scanline OpenEXR image with R, G, B and optionally A channels.
+ * The texels are stored as RGBA floats in scanline order and are converted to half if isHalf is set.
+ * The data window starts at (originX, originY).
+ */
+std::vector<uint8_t> encodeEXR(
+    uint32_t width,
+    uint32_t height,
+    bool isHalf,
+    bool hasAlpha,
+    const std::vector<float>& texels,
+    int32_t originX = 0,
+    int32_t originY = 0
+)
+{
+    const int32_t pixelType = isHalf ? 1 : 2; // HALF or FLOAT
+    const std::vector<std::pair<const char*, uint32_t>> channels = hasAlpha
+        ? std::vector<std::pair<const char*, uint32_t>>{{"A", 3}, {"B", 2}, {"G", 1}, {"R", 0}}
+        : std::vector<std::pair<const char*, uint32_t>>{{"B", 2}, {"G", 1}, {"R", 0}}; // Sorted by name.
+
+    std::vector<uint8_t> exr = {0x76, 0x2f, 0x31, 0x01};
+    appendLE(exr, (int32_t)2); // Version 2, single part scanline file.
+
+    std::vector<uint8_t> chlist;
+    for (const auto& [name, index] : channels)
+    {
+        appendString(chlist, name);
+        appendLE(chlist, pixelType);
+        chlist.insert(chlist.end(), {0, 0, 0, 0}); // pLinear and reserved.
+        appendLE(chlist, (int32_t)1);
+        appendLE(chlist, (int32_t)1);
+    }
+    chlist.push_back(0);
+    appendAttribute(exr, "channels", "chlist", chlist);
+    appendAttribute(exr, "compression", "compression", {0});
+
+    std::vector<uint8_t> dataWindow;
+    for (int32_t v : {originX, originY, originX + int32_t(width) - 1, originY + int32_t(height) - 1})
+        appendLE(dataWindow, v);
+    appendAttribute(exr, "dataWindow", "box2i", dataWindow);
+    appendAttribute(exr, "displayWindow", "box2i", dataWindow);
+    appendAttribute(exr, "lineOrder", "lineOrder", {0});
+    std::vector<uint8_t> one, zero2;
+    appendLE(one, 1.f);
+    appendLE(zero2, 0.f);
+    appendLE(zero2, 0.f);
+    appendAttribute(exr, "pixelAspectRatio", "float", one);
+    appendAttribute(exr, "screenWindowCenter", "v2f", zero2);
+    appendAttribute(exr, "screenWindowWidth", "float", one);
+    exr.push_back(0);
+
+    // One scanline per chunk, with the channels stored one after the other.
+    const uint32_t lineSize = width * (uint32_t)channels.size() * (isHalf ? 2 : 4);
+    const size_t tableOffset = exr.size();
+    for (uint32_t y = 0; y < height; y++)
+        appendLE(exr, uint64_t(tableOffset + height * sizeof(uint64_t) + y * (8 + lineSize)));
+    for (uint32_t y = 0; y < height; y++)
+    {
+        appendLE(exr, originY + int32_t(y));
+        appendLE(exr, lineSize);
+        for (const auto& [name, index] : channels)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float value = texels[(y * width + x) * 4 + index];
+                if (isHalf)
+                    appendLE(exr, math::float32ToFloat16(value));
+                else
+                    appendLE(exr, value);
+            }
+        }
+    }
+    return exr;
+}
+
+std::vector<uint8_t> createRandomData(size_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (auto& v : data)
+        v = uint8_t(rng());
+    return data;
+}
+} // namespace
+
+CPU_TEST(Bitmap_DecodePNG)
+{
+    const uint32_t width = 37;
+    const uint32_t height = 11;
+
+    struct TestCase
+    {
+        uint8_t colorType;
+        uint8_t bitDepth;
+        uint32_t channelCount;
+        ResourceFormat format;
+    };
+    const TestCase testCases[] = {
+        {0, 8, 1, ResourceFormat::R8Unorm},
+        {0, 16, 1, ResourceFormat::R16Unorm},
+        {2, 8, 3, ResourceFormat::BGRX8Unorm},
+        {4, 8, 2, ResourceFormat::BGRA8Unorm},
+        {6, 8, 4, ResourceFormat::BGRA8Unorm},
+    };
+
+    for (const auto& tc : testCases)
+    {
+        const uint32_t bytesPerPixel = tc.channelCount * tc.bitDepth / 8;
+        const std::vector<uint8_t> pixels = createRandomData(size_t(width) * height * bytesPerPixel, tc.colorType);
+
+        for (bool isTopDown : {true, false})
+        {
+            const std::vector<uint8_t> png = encodePNG(width, height, tc.bitDepth, tc.colorType, pixels, 3);
+            Bitmap::UniqueConstPtr pBitmap = ImageDecoder::decodePNG(png.data(), png.size(), isTopDown);
+            ASSERT(pBitmap != nullptr);
+            EXPECT_EQ(pBitmap->getWidth(), width);
+            EXPECT_EQ(pBitmap->getHeight(), height);
+            EXPECT(pBitmap->getFormat() == tc.format);
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const uint8_t* pSrc = pixels.data() + y * width * bytesPerPixel;
+                const uint8_t* pDst = pBitmap->getData() + (isTopDown ? y : height - 1 - y) * pBitmap->getRowPitch();
+                for (uint32_t x = 0; x < width; x++, pSrc += bytesPerPixel)
+                {
+                    switch (tc.colorType)
+                    {
+                    case 0:
+                        if (tc.bitDepth == 8)
+                        {
+                            EXPECT_EQ(pDst[x], pSrc[0]);
+                        }
+                        else
+                        {
+                            EXPECT_EQ(reinterpret_cast<const uint16_t*>(pDst)[x], (pSrc[0] << 8) | pSrc[1]);
+                        }
+                        break;
+                    case 2:
+                        EXPECT(pDst[4 * x + 0] == pSrc[2] && pDst[4 * x + 1] == pSrc[1] && pDst[4 * x + 2] == pSrc[0] && pDst[4 * x + 3] == 255);
+                        break;
+                    case 4:
+                        EXPECT(pDst[4 * x + 0] == pSrc[0] && pDst[4 * x + 1] == pSrc[0] && pDst[4 * x + 2] == pSrc[0] && pDst[4 * x + 3] == pSrc[1]);
+                        break;
+                    case 6:
+                        EXPECT(pDst[4 * x + 0] == pSrc[2] && pDst[4 * x + 1] == pSrc[1] && pDst[4 * x + 2] == pSrc[0] && pDst[4 * x + 3] == pSrc[3]);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Features that are left to FreeImage.
+    const std::vector<uint8_t> rgb = createRandomData(size_t(width) * height * 3, 0);
+    const std::vector<uint8_t> gamma = {0, 0, 0xaf, 0xc8}; // 0.45
+    const std::vector<uint8_t> linearGamma = {0, 1, 0x86, 0xa0}; // 1.0
+    auto decode = [](const std::vector<uint8_t>& png) { return ImageDecoder::decodePNG(png.data(), png.size(), true); };
+    EXPECT(decode(encodePNG(width, height, 8, 2, rgb, 1, {{"gAMA", gamma}})) != nullptr);
+    EXPECT(decode(encodePNG(width, height, 8, 2, rgb, 1, {{"gAMA", linearGamma}})) == nullptr);
+    EXPECT(decode(encodePNG(width, height, 8, 2, rgb, 1, {{"tRNS", {0, 0, 0, 0, 0, 0}}})) == nullptr);
+    EXPECT(decode(encodePNG(width, height * 3, 8, 0, rgb)) != nullptr);
+    EXPECT(decode(encodePNG(width * 3, height, 8, 3, rgb, 1, {{"PLTE", std::vector<uint8_t>(768)}})) == nullptr);
+
+    // Invalid data.
+    std::vector<uint8_t> png = encodePNG(width, height, 8, 2, rgb);
+    EXPECT(decode(std::vector<uint8_t>(png.begin(), png.begin() + png.size() / 2)) == nullptr);
+    png[8 + 8 + 12] = 1; // Interlaced.
+    EXPECT(decode(png) == nullptr);
+}
+
+CPU_TEST(Bitmap_DecodePNG_MatchesFreeImage)
+{
+    const auto path = getRuntimeDirectory() / "test_decode.png";
+    const uint32_t width = 19;
+    const uint32_t height = 7;
+
+    struct TestCase
+    {
+        uint8_t colorType;
+        uint8_t bitDepth;
+        uint32_t bytesPerPixel;
+    };
+    for (const auto& tc : {TestCase{0, 8, 1}, TestCase{0, 16, 2}, TestCase{2, 8, 3}, TestCase{4, 8, 2}, TestCase{6, 8, 4}})
+    {
+        const std::vector<uint8_t> png =
+            encodePNG(width, height, tc.bitDepth, tc.colorType, createRandomData(size_t(width) * height * tc.bytesPerPixel, 1));
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(png.data()), png.size());
+
+        for (bool isTopDown : {true, false})
+        {
+            ImageDecoder::setEnabled(false);
+            Bitmap::UniqueConstPtr pReference = Bitmap::createFromFile(path, isTopDown);
+            ImageDecoder::setEnabled(true);
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, isTopDown);
+
+            ASSERT(pReference != nullptr && pBitmap != nullptr);
+            EXPECT(pBitmap->getFormat() == pReference->getFormat()) << "color type " << (int)tc.colorType;
+            ASSERT_EQ(pBitmap->getSize(), pReference->getSize());
+            EXPECT(std::equal(pBitmap->getData(), pBitmap->getData() + pBitmap->getSize(), pReference->getData()))
+                << "color type " << (int)tc.colorType;
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Bitmap_DecodeEXR)
+{
+    const auto path = getRuntimeDirectory() / "test_decode.exr";
+    const uint32_t width = 13;
+    const uint32_t height = 5;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-2.f, 100.f);
+    std::vector<float> texels(size_t(width) * height * 4);
+    for (auto& v : texels)
+        v = dist(rng);
+
+    for (bool isHalf : {false, true})
+    {
+        for (bool hasAlpha : {false, true})
+        {
+            const std::vector<uint8_t> exr = encodeEXR(width, height, isHalf, hasAlpha, texels);
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(exr.data()), exr.size());
+
+            Bitmap::UniqueConstPtr pBitmap = ImageDecoder::decodeEXR(path, false, Bitmap::ImportFlags::None);
+            ASSERT(pBitmap != nullptr);
+            EXPECT_EQ(pBitmap->getWidth(), width);
+            EXPECT_EQ(pBitmap->getHeight(), height);
+            EXPECT(pBitmap->getFormat() == ResourceFormat::RGBA32Float);
+
+            // Bottom-up rows, half channels are converted to float, missing alpha is one.
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const float* pDst = reinterpret_cast<const float*>(pBitmap->getData() + (height - 1 - y) * pBitmap->getRowPitch());
+                for (uint32_t i = 0; i < width * 4; i++)
+                {
+                    float expected = texels[y * width * 4 + i];
+                    if (!hasAlpha && i % 4 == 3)
+                        expected = 1.f;
+                    else if (isHalf)
+                        expected = math::float16ToFloat32(math::float32ToFloat16(expected));
+                    EXPECT_EQ(pDst[i], expected) << "half " << isHalf << " alpha " << hasAlpha;
+                }
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Bitmap_DecodeEXR_MatchesFreeImage)
+{
+    const auto path = getRuntimeDirectory() / "test_decode.exr";
+    const uint32_t width = 17;
+    const uint32_t height = 6;
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> dist(-2.f, 100.f);
+    std::vector<float> texels(size_t(width) * height * 4);
+    for (auto& v : texels)
+        v = dist(rng);
+
+    struct TestCase
+    {
+        bool isHalf;
+        bool hasAlpha;
+        int32_t originX;
+        int32_t originY;
+    };
+    const TestCase testCases[] = {
+        {false, false, 0, 0},
+        {false, true, 0, 0},
+        {true, false, 0, 0},
+        {true, true, 0, 0},
+        {true, true, -3, 5},
+        {false, false, 7, -2},
+    };
+
+    for (const auto& tc : testCases)
+    {
+        const std::vector<uint8_t> exr = encodeEXR(width, height, tc.isHalf, tc.hasAlpha, texels, tc.originX, tc.originY);
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(exr.data()), exr.size());
+
+        for (Bitmap::ImportFlags importFlags : {Bitmap::ImportFlags::None, Bitmap::ImportFlags::ConvertToFloat16})
+        {
+            for (bool isTopDown : {true, false})
+            {
+                ImageDecoder::setEnabled(false);
+                Bitmap::UniqueConstPtr pReference = Bitmap::createFromFile(path, isTopDown, importFlags);
+                ImageDecoder::setEnabled(true);
+                Bitmap::UniqueConstPtr pBitmap = ImageDecoder::decodeEXR(path, isTopDown, importFlags);
+
+                ASSERT(pReference != nullptr && pBitmap != nullptr);
+                EXPECT(pBitmap->getFormat() == pReference->getFormat());
+                EXPECT_EQ(pBitmap->getWidth(), pReference->getWidth());
+                ASSERT_EQ(pBitmap->getSize(), pReference->getSize());
+                EXPECT(std::equal(pBitmap->getData(), pBitmap->getData() + pBitmap->getSize(), pReference->getData()))
+                    << "half " << tc.isHalf << " alpha " << tc.hasAlpha << " origin " << tc.originX << "," << tc.originY << " flags "
+                    << (uint32_t)importFlags;
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
 GPU_TEST(Bitmap_LinearRamp_PNG)
 {
     const auto path = getRuntimeDirectory() / "test_linear_ramp.png";
@@ -0,0 +1,293 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/MipGenerator.h"
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+float srgbToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+}
+
+MipGenerator::Image createImage(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist;
+    MipGenerator::Image image;
+    image.width = width;
+    image.height = height;
+    image.texels.resize(size_t(width) * height);
+    for (auto& texel : image.texels)
+        texel = float4(dist(rng), dist(rng), dist(rng), dist(rng));
+    return image;
+}
+} // namespace
+
+CPU_TEST(MipGenerator_MipCount)
+{
+    EXPECT_EQ(MipGenerator::getMipCount(1, 1), 1);
+    EXPECT_EQ(MipGenerator::getMipCount(2, 1), 2);
+    EXPECT_EQ(MipGenerator::getMipCount(256, 256), 9);
+    EXPECT_EQ(MipGenerator::getMipCount(255, 17), 8);
+    EXPECT_EQ(MipGenerator::getMipCount(1, 1024), 11);
+}
+
+CPU_TEST(MipGenerator_Srgb)
+{
+    // Decoding matches the reference conversion.
+    std::vector<uint8_t> codes(256);
+    for (uint32_t i = 0; i < 256; i++)
+        codes[i] = (uint8_t)i;
+    std::vector<float> linear(256);
+    MipGenerator::srgbToLinear(codes.data(), linear.data(), codes.size());
+    for (uint32_t i = 0; i < 256; i++)
+        EXPECT_LE(std::abs(linear[i] - srgbToLinear(i / 255.f)), 1e-6f);
+
+    // Encoding round trips all values.
+    std::vector<uint8_t> encoded(256);
+    MipGenerator::linearToSrgb(linear.data(), encoded.data(), linear.size());
+    for (uint32_t i = 0; i < 256; i++)
+        EXPECT_EQ(encoded[i], i);
+
+    // Encoding rounds to nearest and clamps out of range values, including NaN.
+    std::vector<float> values(10007);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = (float)i / (values.size() - 1);
+    values[0] = -1.f;
+    values[1] = std::numeric_limits<float>::quiet_NaN();
+    values[2] = 2.f;
+    values[3] = std::numeric_limits<float>::infinity();
+    encoded.resize(values.size());
+    MipGenerator::linearToSrgb(values.data(), encoded.data(), values.size());
+    EXPECT_EQ(encoded[0], 0);
+    EXPECT_EQ(encoded[1], 0);
+    EXPECT_EQ(encoded[2], 255);
+    EXPECT_EQ(encoded[3], 255);
+    for (size_t i = 4; i < values.size(); i++)
+    {
+        const float expected = linearToSrgb(values[i]) * 255.f;
+        EXPECT_LE(std::abs(encoded[i] - expected), 0.5f + 1e-3f);
+    }
+}
+
+CPU_TEST(MipGenerator_FormatRoundTrip)
+{
+    const uint32_t width = 37;
+    const uint32_t height = 21;
+    std::mt19937 rng(1);
+
+    for (ResourceFormat format :
+         {ResourceFormat::R8Unorm,
+          ResourceFormat::RG8Unorm,
+          ResourceFormat::RGBA8Unorm,
+          ResourceFormat::RGBA8UnormSrgb,
+          ResourceFormat::BGRA8Unorm,
+          ResourceFormat::BGRA8UnormSrgb,
+          ResourceFormat::R16Float,
+          ResourceFormat::RG16Float,
+          ResourceFormat::RGBA16Float,
+          ResourceFormat::R32Float,
+          ResourceFormat::RG32Float,
+          ResourceFormat::RGB32Float,
+          ResourceFormat::RGBA32Float})
+    {
+        ASSERT(MipGenerator::isSupported(format));
+        const size_t size = size_t(width) * height * getFormatBytesPerBlock(format);
+
+        // Use bit patterns that are valid in all formats, i.e. no NaNs in the float formats.
+        std::vector<uint8_t> data(size);
+        std::uniform_int_distribution<uint32_t> dist(0, 255);
+        for (size_t i = 0; i < size; i++)
+            data[i] = (uint8_t)(getFormatType(format) == FormatType::Float && i % 2 == 1 ? dist(rng) & 0x3f : dist(rng));
+
+        MipGenerator::Image image = MipGenerator::decode(format, width, height, data.data());
+        std::vector<uint8_t> encoded(size);
+        MipGenerator::encode(image, format, encoded.data());
+        EXPECT(encoded == data) << to_string(format);
+    }
+
+    // Missing channels are zero, missing alpha is one.
+    const uint8_t rg[2] = {255, 0};
+    MipGenerator::Image image = MipGenerator::decode(ResourceFormat::RG8Unorm, 1, 1, rg);
+    EXPECT(all(image.at(0, 0) == float4(1.f, 0.f, 0.f, 1.f)));
+
+    // BGR channels are swapped, padding is set to one.
+    const uint8_t bgrx[4] = {0, 0, 255, 7};
+    image = MipGenerator::decode(ResourceFormat::BGRX8Unorm, 1, 1, bgrx);
+    EXPECT(all(image.at(0, 0) == float4(1.f, 0.f, 0.f, 1.f)));
+    uint8_t encoded[4];
+    MipGenerator::encode(image, ResourceFormat::BGRX8Unorm, encoded);
+    EXPECT(encoded[0] == 0 && encoded[1] == 0 && encoded[2] == 255 && encoded[3] == 255);
+
+    EXPECT(!MipGenerator::isSupported(ResourceFormat::BC1Unorm));
+}
+
+CPU_TEST(MipGenerator_BoxFilter)
+{
+    // Even dimensions average 2x2 blocks.
+    MipGenerator::Image src = createImage(8, 6, 1);
+    MipGenerator::Image dst = MipGenerator::downsample(src);
+    ASSERT_EQ(dst.width, 4);
+    ASSERT_EQ(dst.height, 3);
+    for (uint32_t y = 0; y < dst.height; y++)
+    {
+        for (uint32_t x = 0; x < dst.width; x++)
+        {
+            float4 expected = 0.25f * (src.at(2 * x, 2 * y) + src.at(2 * x + 1, 2 * y) + src.at(2 * x, 2 * y + 1) + src.at(2 * x + 1, 2 * y + 1));
+            for (int c = 0; c < 4; c++)
+                EXPECT_LE(std::abs(dst.at(x, y)[c] - expected[c]), 1e-5f);
+        }
+    }
+
+    // Odd dimensions preserve the average.
+    src = createImage(7, 1, 2);
+    dst = MipGenerator::downsample(src);
+    ASSERT_EQ(dst.width, 3);
+    ASSERT_EQ(dst.height, 1);
+    float4 srcSum(0.f), dstSum(0.f);
+    for (const auto& texel : src.texels)
+        srcSum += texel;
+    for (const auto& texel : dst.texels)
+        dstSum += texel;
+    for (int c = 0; c < 4; c++)
+        EXPECT_LE(std::abs(srcSum[c] / 7.f - dstSum[c] / 3.f), 1e-5f);
+}
+
+CPU_TEST(MipGenerator_KaiserFilter)
+{
+    MipGenerator::Options options;
+    options.filter = MipGenerator::Filter::Kaiser;
+
+    // A constant image stays constant.
+    MipGenerator::Image src;
+    src.width = 16;
+    src.height = 9;
+    src.texels.assign(size_t(src.width) * src.height, float4(0.25f, 0.5f, 0.75f, 1.f));
+    MipGenerator::Image dst = MipGenerator::downsample(src, options);
+    ASSERT_EQ(dst.width, 8);
+    ASSERT_EQ(dst.height, 4);
+    for (const auto& texel : dst.texels)
+    {
+        for (int c = 0; c < 4; c++)
+            EXPECT_LE(std::abs(texel[c] - src.texels[0][c]), 1e-5f);
+    }
+
+    // The highest frequency is removed, which the box filter only does for even dimensions.
+    src.width = 64;
+    src.height = 1;
+    src.texels.resize(src.width);
+    for (uint32_t x = 0; x < src.width; x++)
+        src.texels[x] = float4(x % 2 == 0 ? 1.f : 0.f);
+    dst = MipGenerator::downsample(src, options);
+    for (uint32_t x = 4; x < dst.width - 4; x++)
+        EXPECT_LE(std::abs(dst.texels[x].x - 0.5f), 0.02f);
+}
+
+CPU_TEST(MipGenerator_MipChain)
+{
+    const uint32_t width = 13;
+    const uint32_t height = 6;
+    const ResourceFormat format = ResourceFormat::RGBA8UnormSrgb;
+
+    std::vector<uint8_t> data(size_t(width) * height * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)(i * 37);
+
+    const uint32_t mipCount = MipGenerator::getMipCount(width, height);
+    ASSERT_EQ(mipCount, 4);
+    std::vector<uint8_t> chain = MipGenerator::generateMipChain(format, width, height, data.data(), mipCount);
+    EXPECT_EQ(chain.size(), (13 * 6 + 6 * 3 + 3 * 1 + 1 * 1) * 4);
+
+    // The base level is copied as is.
+    EXPECT(std::equal(data.begin(), data.end(), chain.begin()));
+
+    // The second level matches a manual downsample in linear space.
+    MipGenerator::Image mip1 = MipGenerator::downsample(MipGenerator::decode(format, width, height, data.data()));
+    std::vector<uint8_t> expected(size_t(mip1.width) * mip1.height * 4);
+    MipGenerator::encode(mip1, format, expected.data());
+    EXPECT(std::equal(expected.begin(), expected.end(), chain.begin() + data.size()));
+
+    // Invalid mip counts are rejected.
+    EXPECT_THROW(MipGenerator::generateMipChain(format, width, height, data.data(), mipCount + 1));
+}
+
+CPU_TEST(MipGenerator_AlphaCoverage)
+{
+    // Noisy alpha with a high cutoff. Filtering averages the alpha values towards the mean, so the coverage drops in the lower mips.
+    const uint32_t size = 64;
+    std::vector<uint8_t> data(size * size * 4);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (auto& value : data)
+        value = (uint8_t)dist(rng);
+
+    MipGenerator::Options options;
+    options.alphaCutoff = 0.8f;
+    const float baseCoverage =
+        MipGenerator::computeAlphaCoverage(MipGenerator::decode(ResourceFormat::RGBA8Unorm, size, size, data.data()), options.alphaCutoff);
+
+    auto getCoverage = [&](const std::vector<uint8_t>& chain, uint32_t mip)
+    {
+        size_t offset = 0;
+        for (uint32_t i = 0; i < mip; i++)
+            offset += size_t(size >> i) * (size >> i) * 4;
+        return MipGenerator::computeAlphaCoverage(
+            MipGenerator::decode(ResourceFormat::RGBA8Unorm, size >> mip, size >> mip, chain.data() + offset), options.alphaCutoff
+        );
+    };
+
+    // Without coverage preservation, the alpha tested surface fades out.
+    std::vector<uint8_t> chain = MipGenerator::generateMipChain(ResourceFormat::RGBA8Unorm, size, size, data.data(), 4, options);
+    EXPECT_LT(getCoverage(chain, 2), 0.5f * baseCoverage);
+
+    options.preserveAlphaCoverage = true;
+    chain = MipGenerator::generateMipChain(ResourceFormat::RGBA8Unorm, size, size, data.data(), 4, options);
+    for (uint32_t mip = 1; mip < 4; mip++)
+    {
+        EXPECT_LE(std::abs(getCoverage(chain, mip) - baseCoverage), 0.02f) << "mip " << mip;
+    }
+
+    // Images without texels failing the alpha test are not alpha tested, and their mips are not changed.
+    for (size_t i = 3; i < data.size(); i += 4)
+        data[i] = std::max(data[i], (uint8_t)220);
+    options.preserveAlphaCoverage = false;
+    std::vector<uint8_t> reference = MipGenerator::generateMipChain(ResourceFormat::RGBA8Unorm, size, size, data.data(), 4, options);
+    options.preserveAlphaCoverage = true;
+    EXPECT(MipGenerator::generateMipChain(ResourceFormat::RGBA8Unorm, size, size, data.data(), 4, options) == reference);
+}
+} // namespace Falcor
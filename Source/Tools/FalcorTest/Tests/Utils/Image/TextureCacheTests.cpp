@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+#include "Utils/Image/ImageIO.h"
+#include "Core/Platform/OS.h"
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+size_t countFiles(const std::filesystem::path& directory, const std::string& extension)
+{
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+        count += entry.path().extension() == extension ? 1 : 0;
+    return count;
+}
+} // namespace
+
+CPU_TEST(TextureCache_ComputeKey)
+{
+    std::filesystem::path directory = std::filesystem::current_path() / "texture_cache_compute_key";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "texture.bin";
+    std::ofstream(path, std::ios_base::binary) << "texture data";
+
+    // The key doesn't depend on whether the content hash is looked up in a reference file.
+    auto key = TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.5f, directory);
+    ASSERT(key.has_value());
+    EXPECT(key == TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.5f));
+    EXPECT_EQ(countFiles(directory, ".ref"), 1);
+    EXPECT(key == TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.5f, directory));
+    EXPECT_EQ(countFiles(directory, ".ref"), 1);
+
+    // The options are part of the key.
+    EXPECT(key != TextureCache::computeKey(path, false, false, false, Bitmap::ImportFlags::None, 0.5f, directory));
+    EXPECT(key != TextureCache::computeKey(path, true, true, false, Bitmap::ImportFlags::None, 0.5f, directory));
+
+    // The alpha cutoff is only part of the key if the alpha coverage is preserved.
+    const auto coverageFlags = Bitmap::ImportFlags::PreserveAlphaCoverage;
+    EXPECT(key == TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.25f, directory));
+    EXPECT(key != TextureCache::computeKey(path, true, false, false, coverageFlags, 0.5f, directory));
+    EXPECT(
+        TextureCache::computeKey(path, true, false, false, coverageFlags, 0.5f, directory) !=
+        TextureCache::computeKey(path, true, false, false, coverageFlags, 0.25f, directory)
+    );
+
+    // Touching the file creates a new reference file but keeps the key.
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(10));
+    EXPECT(key == TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.5f, directory));
+    EXPECT_EQ(countFiles(directory, ".ref"), 2);
+
+    // Changing the content changes the key.
+    std::ofstream(path, std::ios_base::binary) << "other texture data";
+    EXPECT(key != TextureCache::computeKey(path, true, false, false, Bitmap::ImportFlags::None, 0.5f, directory));
+
+    EXPECT(!TextureCache::computeKey(directory / "missing.bin", true, false, false, Bitmap::ImportFlags::None, 0.5f, directory));
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(TextureCache_SaveMipChainToDDS)
+{
+    // Gray texels, so that the test doesn't depend on the channel order in the file.
+    const uint32_t width = 8;
+    const uint32_t height = 4;
+    const uint32_t mipCount = 4; // 8x4, 4x2, 2x1, 1x1
+    std::vector<uint8_t> data;
+    for (uint32_t mip = 0; mip < mipCount; mip++)
+    {
+        const uint32_t texelCount = std::max(1u, width >> mip) * std::max(1u, height >> mip);
+        for (uint32_t i = 0; i < texelCount; i++)
+        {
+            const uint8_t value = uint8_t(mip * 50 + i);
+            data.insert(data.end(), {value, value, value, 255});
+        }
+    }
+
+    std::filesystem::path path = std::filesystem::current_path() / "texture_cache_mip_chain.dds";
+    ImageIO::saveToDDS(path, ResourceFormat::RGBA8Unorm, width, height, mipCount, data.data());
+
+    // The precomputed mips are stored as is, after the header.
+    std::ifstream fs(path, std::ios_base::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    fs.close();
+    ASSERT_GT(file.size(), data.size());
+    EXPECT(std::equal(data.begin(), data.end(), file.end() - data.size()));
+
+    EXPECT_THROW(ImageIO::saveToDDS(path, ResourceFormat::RGBA8Unorm, width, height, 5, data.data()));
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -51,4 +51,63 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_Residency)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_<MIP>.png";
+
+    auto handle = textureManager.loadTexture(path, false, false, ResourceBindFlags::ShaderResource, false);
+    ASSERT(handle.isValid());
+    auto pOriginal = textureManager.getTexture(handle);
+    ASSERT(pOriginal != nullptr);
+    ASSERT_EQ(pOriginal->getMipCount(), 3);
+
+    // Within budget, nothing changes.
+    textureManager.setResidencyOptions({1ull << 30, 1, 4});
+    EXPECT(textureManager.updateResidency().empty());
+
+    // Over budget, all mips but the coarsest are evicted.
+    textureManager.setResidencyOptions({1, 1, 4});
+    auto replacements = textureManager.updateResidency();
+    ASSERT_EQ(replacements.size(), 1);
+    EXPECT(replacements[0].pOldTexture == pOriginal);
+
+    auto pEvicted = textureManager.getTexture(handle);
+    ASSERT(pEvicted != nullptr);
+    EXPECT(pEvicted == replacements[0].pNewTexture);
+    EXPECT_EQ(pEvicted->getWidth(), 1);
+    EXPECT_EQ(pEvicted->getHeight(), 1);
+    EXPECT_EQ(pEvicted->getMipCount(), 1);
+
+    // The handle is unchanged for the new texture.
+    EXPECT(textureManager.addTexture(pEvicted) == handle);
+
+    auto stats = textureManager.getStats();
+    EXPECT_EQ(stats.texturePartiallyResidentCount, 1);
+    EXPECT_EQ(stats.textureEvictionCount, 1);
+    EXPECT_EQ(stats.textureEvictedMipCount, 2);
+    EXPECT_EQ(stats.textureReloadCount, 0);
+
+    // Without a budget, the texture is re-streamed asynchronously and swapped in once loaded.
+    textureManager.setResidencyOptions({});
+    EXPECT(textureManager.updateResidency().empty());
+    EXPECT(textureManager.getTexture(handle) == pEvicted);
+    textureManager.waitForAllTexturesLoading();
+    replacements = textureManager.updateResidency();
+    ASSERT_EQ(replacements.size(), 1);
+    EXPECT(replacements[0].pOldTexture == pEvicted);
+
+    auto pReloaded = textureManager.getTexture(handle);
+    ASSERT(pReloaded != nullptr);
+    EXPECT_EQ(pReloaded->getWidth(), 4);
+    EXPECT_EQ(pReloaded->getMipCount(), 3);
+
+    stats = textureManager.getStats();
+    EXPECT_EQ(stats.texturePartiallyResidentCount, 0);
+    EXPECT_EQ(stats.textureReloadCount, 1);
+}
 } // namespace Falcor
@@ -0,0 +1,245 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/TiledImageFile.h"
+#include "Utils/Image/VirtualTextureManager.h"
+#include "Utils/Image/VirtualTextureTileCache.h"
+#include <random>
+
+namespace Falcor
+{
+CPU_TEST(VirtualTexture_TileKey)
+{
+    VirtualTileKey key = {123456, 13, 65535, 4321};
+    EXPECT(VirtualTileKey::unpack(key.pack()) == key);
+    EXPECT(key != VirtualTileKey({123456, 13, 4321, 65535}));
+}
+
+CPU_TEST(VirtualTexture_TileCache)
+{
+    VirtualTextureTileCache cache(3);
+    EXPECT_EQ(cache.getSlotCount(), 3);
+
+    // Fill all slots in frame 1. Tile 0 is pinned.
+    auto a = cache.allocate({0, 0, 0, 0}, 1, true);
+    auto b = cache.allocate({0, 0, 1, 0}, 1);
+    auto c = cache.allocate({0, 0, 2, 0}, 1);
+    ASSERT(a && b && c);
+    EXPECT_EQ(a->slot, 0);
+    EXPECT_EQ(b->slot, 1);
+    EXPECT_EQ(c->slot, 2);
+    EXPECT(!a->evicted && !b->evicted && !c->evicted);
+    EXPECT_EQ(cache.getUsedSlotCount(), 3);
+
+    // Allocating a resident tile returns its slot.
+    auto b2 = cache.allocate({0, 0, 1, 0}, 1);
+    ASSERT(b2);
+    EXPECT_EQ(b2->slot, 1);
+
+    // All tiles are in use in frame 1, so nothing can be evicted.
+    EXPECT(!cache.allocate({0, 1, 0, 0}, 1));
+    EXPECT_EQ(cache.getStats().failedCount, 1);
+
+    // In frame 2, tile (1,0) is touched, so the least recently used unpinned tile is (2,0).
+    EXPECT(cache.touch({0, 0, 1, 0}, 2));
+    auto d = cache.allocate({0, 1, 0, 0}, 2);
+    ASSERT(d);
+    EXPECT_EQ(d->slot, 2);
+    ASSERT(d->evicted.has_value());
+    EXPECT(*d->evicted == VirtualTileKey({0, 0, 2, 0}));
+    EXPECT_EQ(cache.find({0, 0, 2, 0}), VirtualTextureTileCache::kInvalidSlot);
+    EXPECT_EQ(cache.find({0, 1, 0, 0}), 2);
+
+    // In frame 3, the pinned tile is never evicted, (1,0) is now the least recently used.
+    auto e = cache.allocate({1, 0, 0, 0}, 3);
+    ASSERT(e);
+    EXPECT_EQ(e->slot, 1);
+    EXPECT_EQ(cache.find({0, 0, 0, 0}), 0);
+    EXPECT_EQ(cache.getStats().evictionCount, 2);
+
+    // Removing a texture frees its slots, including pinned ones.
+    EXPECT_EQ(cache.removeTexture(0), 2);
+    EXPECT_EQ(cache.getUsedSlotCount(), 1);
+    EXPECT(cache.remove({1, 0, 0, 0}));
+    EXPECT(!cache.remove({1, 0, 0, 0}));
+    EXPECT_EQ(cache.getUsedSlotCount(), 0);
+}
+
+CPU_TEST(VirtualTexture_TileCacheRandom)
+{
+    // Random workload checked against the cache invariants.
+    const uint32_t slotCount = 64;
+    VirtualTextureTileCache cache(slotCount);
+    std::mt19937 rng(1);
+    for (uint64_t frame = 1; frame < 200; frame++)
+    {
+        for (uint32_t i = 0; i < 32; i++)
+        {
+            VirtualTileKey key = {rng() % 4, rng() % 3, rng() % 8, rng() % 8};
+            if (cache.touch(key, frame))
+                continue;
+            if (auto alloc = cache.allocate(key, frame))
+            {
+                EXPECT_LT(alloc->slot, slotCount);
+                EXPECT_EQ(cache.find(key), alloc->slot);
+                if (alloc->evicted)
+                    EXPECT_EQ(cache.find(*alloc->evicted), VirtualTextureTileCache::kInvalidSlot);
+            }
+        }
+        EXPECT_LE(cache.getUsedSlotCount(), slotCount);
+    }
+}
+
+CPU_TEST(VirtualTexture_TileScheduler)
+{
+    VirtualTextureTileScheduler scheduler(2);
+
+    // Duplicate requests are merged and keep the highest priority.
+    scheduler.request({0, 0, 0, 0}, 1, 0.f);
+    scheduler.request({0, 2, 0, 0}, 1, 2.f);
+    scheduler.request({0, 1, 0, 0}, 1, 1.f);
+    scheduler.request({0, 0, 0, 0}, 1, 3.f);
+    scheduler.request({1, 1, 0, 0}, 1, 1.f);
+    EXPECT_EQ(scheduler.getPendingCount(), 4);
+
+    auto keys = scheduler.pop(2, 1);
+    ASSERT_EQ(keys.size(), 2);
+    EXPECT(keys[0] == VirtualTileKey({0, 0, 0, 0}));
+    EXPECT(keys[1] == VirtualTileKey({0, 2, 0, 0}));
+    EXPECT_EQ(scheduler.getPendingCount(), 2);
+
+    // Cancelling a texture removes its requests.
+    scheduler.cancelTexture(1);
+    EXPECT_EQ(scheduler.getPendingCount(), 1);
+
+    // Among equal priorities, recent requests come first.
+    scheduler.request({2, 1, 0, 0}, 2, 1.f);
+    keys = scheduler.pop(1, 2);
+    ASSERT_EQ(keys.size(), 1);
+    EXPECT(keys[0] == VirtualTileKey({2, 1, 0, 0}));
+
+    // Requests that are not renewed expire.
+    keys = scheduler.pop(10, 4);
+    EXPECT_EQ(keys.size(), 0);
+    EXPECT_EQ(scheduler.getPendingCount(), 0);
+}
+
+CPU_TEST(VirtualTexture_TiledImageFile)
+{
+    const uint32_t width = 40;
+    const uint32_t height = 24;
+    std::vector<uint8_t> texels(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* p = &texels[(y * width + x) * 4];
+            p[0] = uint8_t(x);
+            p[1] = uint8_t(y);
+            p[2] = 7;
+            p[3] = 255;
+        }
+    }
+    auto pBitmap = Bitmap::create(width, height, ResourceFormat::RGBA8Unorm, texels.data());
+
+    const uint32_t tileSize = 16;
+    const uint32_t border = 2;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "falcor_tiled_image_test.tiles";
+    TiledImageFile::writeFromBitmap(path, *pBitmap, tileSize, border, false);
+
+    auto pFile = TiledImageFile::open(path);
+    ASSERT(pFile != nullptr);
+    const auto& desc = pFile->getDesc();
+    EXPECT_EQ(desc.width, width);
+    EXPECT_EQ(desc.height, height);
+    EXPECT_EQ(desc.mipCount, 3); // 40x24, 20x12, 10x6
+    EXPECT_EQ(desc.getTileCountX(0), 3);
+    EXPECT_EQ(desc.getTileCountY(0), 2);
+    EXPECT_EQ(desc.getTileCount(), 6 + 2 + 1);
+
+    // Check the tile interior and the wrapped border of tile (2,1) in mip 0.
+    const uint32_t padded = desc.getPaddedTileSize();
+    std::vector<uint8_t> tile(desc.getTileSizeInBytes());
+    ASSERT(pFile->readTile(0, 2, 1, tile.data()));
+    auto texel = [&](uint32_t x, uint32_t y) { return &tile[(y * padded + x) * 4]; };
+    EXPECT_EQ(texel(border, border)[0], 32);
+    EXPECT_EQ(texel(border, border)[1], 16);
+    EXPECT_EQ(texel(border, border)[2], 7);
+    EXPECT_EQ(texel(0, 0)[0], 30);
+    EXPECT_EQ(texel(0, 0)[1], 14);
+    // The tile extends past the right and bottom edges, which wrap around to zero.
+    EXPECT_EQ(texel(border + 8, border)[0], 0);
+    EXPECT_EQ(texel(border, border + 8)[1], 0);
+
+    // The box filter averages 2x2 texels.
+    ASSERT(pFile->readTile(1, 0, 0, tile.data()));
+    EXPECT_EQ(texel(border + 1, border + 1)[0], 3);  // (2+3+2+3)/4 = 2.5 -> 3
+    EXPECT_EQ(texel(border + 1, border + 1)[1], 3);
+
+    EXPECT(!pFile->readTile(3, 0, 0, tile.data()));
+    EXPECT(!pFile->readTile(0, 3, 0, tile.data()));
+
+    pFile.reset();
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(VirtualTexture_AtlasFull)
+{
+    const uint32_t size = 32;
+    std::vector<uint8_t> texels(size * size * 4, 255);
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "falcor_virtual_texture_test";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path paths[2] = {directory / "a.png", directory / "b.png"};
+    for (const auto& path : paths)
+    {
+        Bitmap::saveImage(
+            path, size, size, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, texels.data()
+        );
+    }
+
+    // The atlas only holds the resident tail tile of one texture.
+    VirtualTextureManager::Options options;
+    options.tileSize = 16;
+    options.atlasSlotCount = 1;
+    options.cacheDirectory = directory;
+    VirtualTextureManager manager(ctx.getDevice(), options);
+
+    EXPECT_EQ(manager.addTexture(paths[0], false), 0u);
+    EXPECT(manager.update(ctx.getRenderContext()));
+    EXPECT_THROW(manager.addTexture(paths[1], false));
+
+    // The failed texture is not registered and doesn't re-create the resources.
+    EXPECT_EQ(manager.getTextureCount(), 1u);
+    const uint64_t pageTableMemory = manager.getStats().pageTableMemoryInBytes;
+    EXPECT(!manager.update(ctx.getRenderContext()));
+    EXPECT_EQ(manager.getStats().pageTableMemoryInBytes, pageTableMemory);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
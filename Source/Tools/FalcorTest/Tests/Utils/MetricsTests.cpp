@@ -0,0 +1,219 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Metrics.h"
+#include "Utils/Threading.h"
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+size_t findColumn(const std::vector<std::string>& columns, const std::string& name)
+{
+    auto it = std::find(columns.begin(), columns.end(), name);
+    return it != columns.end() ? size_t(it - columns.begin()) : size_t(-1);
+}
+} // namespace
+
+CPU_TEST(Metrics_Counter)
+{
+    MetricCounter counter;
+    EXPECT_EQ(counter.get(), 0);
+    counter.add();
+    counter.add(41);
+    EXPECT_EQ(counter.get(), 42);
+
+    // Increments from many threads land in different shards and are all counted.
+    const uint64_t kCount = 100000;
+    Threading::parallelFor(0, kCount, [&](size_t i) { counter.add(i); });
+    EXPECT_EQ(counter.get(), 42 + kCount * (kCount - 1) / 2);
+
+    counter.reset();
+    EXPECT_EQ(counter.get(), 0);
+}
+
+CPU_TEST(Metrics_Gauge)
+{
+    MetricGauge gauge;
+    gauge.set(2.5);
+    EXPECT_EQ(gauge.get(), 2.5);
+    gauge.add(-1.0);
+    EXPECT_EQ(gauge.get(), 1.5);
+}
+
+CPU_TEST(Metrics_Histogram)
+{
+    MetricHistogram histogram({1.0, 2.0, 4.0, 8.0});
+    for (uint32_t i = 0; i < 100; i++)
+        histogram.record(0.5);
+    for (uint32_t i = 0; i < 100; i++)
+        histogram.record(3.0);
+    histogram.record(100.0);
+
+    auto snapshot = histogram.getSnapshot();
+    EXPECT_EQ(snapshot.count, 201);
+    ASSERT_EQ(snapshot.counts.size(), 5);
+    EXPECT_EQ(snapshot.counts[0], 100);
+    EXPECT_EQ(snapshot.counts[1], 0);
+    EXPECT_EQ(snapshot.counts[2], 100);
+    EXPECT_EQ(snapshot.counts[4], 1);
+    EXPECT_EQ(snapshot.sum, 450.0);
+
+    // Percentiles are interpolated within the bucket, values in the overflow bucket are clamped to the last bound.
+    EXPECT_LE(snapshot.getPercentile(0.25), 1.0);
+    EXPECT_GT(snapshot.getPercentile(0.75), 2.0);
+    EXPECT_LE(snapshot.getPercentile(0.75), 4.0);
+    EXPECT_EQ(snapshot.getPercentile(1.0), 8.0);
+
+    // Bucket bounds are inclusive.
+    MetricHistogram bounds({1.0, 2.0});
+    bounds.record(1.0);
+    bounds.record(2.0);
+    EXPECT_EQ(bounds.getSnapshot().counts[0], 1);
+    EXPECT_EQ(bounds.getSnapshot().counts[1], 1);
+
+    histogram.record(0.5);
+    auto delta = histogram.getSnapshot().getDelta(snapshot);
+    EXPECT_EQ(delta.count, 1);
+    EXPECT_EQ(delta.counts[0], 1);
+    EXPECT_EQ(delta.getMean(), 0.5);
+
+    // Concurrent recording.
+    MetricHistogram latencies(MetricHistogram::getDefaultLatencyBounds());
+    Threading::parallelFor(0, 10000, [&](size_t i) { latencies.record(1.0); });
+    EXPECT_EQ(latencies.getSnapshot().count, 10000);
+    EXPECT_EQ(latencies.getSnapshot().sum, 10000.0);
+}
+
+CPU_TEST(Metrics_Registry)
+{
+    auto& registry = MetricsRegistry::instance();
+    auto& counter = registry.getCounter("test.metrics.counter", "Test counter.");
+    auto& gauge = registry.getGauge("test.metrics.gauge");
+    auto& histogram = registry.getHistogram("test.metrics.histogram", "", {1.0, 10.0});
+
+    // Metrics are looked up by name, using a name with a different type is an error.
+    EXPECT_EQ(&registry.getCounter("test.metrics.counter"), &counter);
+    bool thrown = false;
+    try
+    {
+        registry.getGauge("test.metrics.counter");
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+
+    const auto columns = registry.getColumnNames();
+    const size_t counterColumn = findColumn(columns, "test.metrics.counter");
+    const size_t gaugeColumn = findColumn(columns, "test.metrics.gauge");
+    const size_t countColumn = findColumn(columns, "test.metrics.histogram.count");
+    const size_t meanColumn = findColumn(columns, "test.metrics.histogram.mean");
+    ASSERT_NE(counterColumn, size_t(-1));
+    ASSERT_NE(gaugeColumn, size_t(-1));
+    ASSERT_NE(countColumn, size_t(-1));
+    EXPECT_NE(findColumn(columns, "test.metrics.histogram.p99"), size_t(-1));
+
+    // Samples hold the per-frame increments of counters and histograms, and the current gauge values.
+    registry.sampleFrame(0);
+    counter.add(5);
+    gauge.set(3.0);
+    histogram.record(0.5);
+    histogram.record(1.5);
+    registry.sampleFrame(1);
+    counter.add(2);
+    registry.sampleFrame(2);
+
+    const auto samples = registry.getSamples();
+    ASSERT_GE(samples.size(), 2);
+    const auto& frame1 = samples[samples.size() - 2];
+    const auto& frame2 = samples[samples.size() - 1];
+    EXPECT_EQ(frame1.frame, 1);
+    EXPECT_EQ(frame1.values[counterColumn], 5.0);
+    EXPECT_EQ(frame1.values[gaugeColumn], 3.0);
+    EXPECT_EQ(frame1.values[countColumn], 2.0);
+    EXPECT_EQ(frame1.values[meanColumn], 1.0);
+    EXPECT_EQ(frame2.frame, 2);
+    EXPECT_EQ(frame2.values[counterColumn], 2.0);
+    EXPECT_EQ(frame2.values[gaugeColumn], 3.0);
+    EXPECT_EQ(frame2.values[countColumn], 0.0);
+
+    // The number of samples kept is bounded.
+    const size_t maxSampleCount = registry.getMaxSampleCount();
+    registry.setMaxSampleCount(2);
+    registry.sampleFrame(3);
+    EXPECT_EQ(registry.getSamples().size(), 2);
+    EXPECT_EQ(registry.getLastSample().frame, 3);
+    registry.setMaxSampleCount(maxSampleCount);
+}
+
+CPU_TEST(Metrics_Export)
+{
+    auto& registry = MetricsRegistry::instance();
+    registry.getCounter("test.metrics.export").add(7);
+    registry.sampleFrame(10);
+    const auto samples = registry.getSamples();
+    const auto columns = registry.getColumnNames();
+
+    const std::filesystem::path csvPath = std::filesystem::temp_directory_path() / "falcor_metrics_test.csv";
+    registry.writeCSV(csvPath, {samples.back()});
+    {
+        std::ifstream ifs(csvPath);
+        std::string header, row;
+        std::getline(ifs, header);
+        std::getline(ifs, row);
+        EXPECT(header.rfind("frame,", 0) == 0);
+        EXPECT(header.find("test.metrics.export") != std::string::npos);
+        EXPECT(row.rfind("10,", 0) == 0);
+        EXPECT_EQ(std::count(header.begin(), header.end(), ','), columns.size());
+        EXPECT_EQ(std::count(row.begin(), row.end(), ','), columns.size());
+    }
+    std::filesystem::remove(csvPath);
+
+    const std::filesystem::path jsonPath = std::filesystem::temp_directory_path() / "falcor_metrics_test.json";
+    registry.writeJSON(jsonPath, {samples.back()});
+    {
+        std::ifstream ifs(jsonPath);
+        auto j = nlohmann::json::parse(ifs);
+        EXPECT_EQ(j["metrics"]["test.metrics.export"]["type"], "counter");
+        EXPECT_GE(j["metrics"]["test.metrics.export"]["value"].get<uint64_t>(), 7);
+        ASSERT_EQ(j["frames"].size(), 1);
+        EXPECT_EQ(j["frames"][0]["frame"], 10);
+        EXPECT_EQ(j["frames"][0]["values"]["test.metrics.export"], 7.0);
+    }
+    std::filesystem::remove(jsonPath);
+}
+} // namespace Falcor
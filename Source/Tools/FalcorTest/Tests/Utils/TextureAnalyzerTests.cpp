@@ -27,6 +27,10 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Math/Float16.h"
+#include <cfloat>
+#include <random>
 
 namespace Falcor
 {
@@ -118,8 +122,157 @@ const TextureAnalyzer::Result kExpectedResult[] = {
         float4(0.f, 0.f, 0.f, 1 / 256.f),
     },
 };
+
+/// Straightforward reference implementation of the analysis for float data.
+TextureAnalyzer::Result analyzeReference(const std::vector<float4>& texels)
+{
+    TextureAnalyzer::Result result = {};
+    result.value = texels[0];
+    result.minValue = float4(FLT_MAX);
+    result.maxValue = float4(0.f);
+    for (const float4& v : texels)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            uint32_t range = 0;
+            range |= v[c] > 0.f ? 1 : 0;
+            range |= v[c] < 0.f ? 2 : 0;
+            range |= std::isinf(v[c]) ? 4 : 0;
+            range |= std::isnan(v[c]) ? 8 : 0;
+            result.mask |= (v[c] != texels[0][c] ? 1u : 0u) << c;
+            result.mask |= range << (4 + 4 * c);
+            if (v[c] < result.minValue[c])
+                result.minValue[c] = v[c];
+            if (v[c] > result.maxValue[c])
+                result.maxValue[c] = v[c];
+        }
+    }
+    result.minValue = max(result.minValue, float4(0.f));
+    return result;
+}
+
+void compareResults(CPUUnitTestContext& ctx, const TextureAnalyzer::Result& result, const TextureAnalyzer::Result& expected, const std::string& name)
+{
+    EXPECT_EQ(result.mask, expected.mask) << name;
+    for (int c = 0; c < 4; c++)
+    {
+        EXPECT_EQ(result.minValue[c], expected.minValue[c]) << name << " c = " << c;
+        EXPECT_EQ(result.maxValue[c], expected.maxValue[c]) << name << " c = " << c;
+        if (result.isConstant(1u << c))
+        {
+            EXPECT_EQ(result.value[c], expected.value[c]) << name << " c = " << c;
+        }
+    }
+}
 } // namespace
 
+CPU_TEST(TextureAnalyzer_CPU)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-2.f, 2.f);
+
+    // Odd sizes to exercise the scalar tails.
+    const uint32_t width = 37;
+    const uint32_t height = 41;
+    const size_t texelCount = width * height;
+
+    struct Case
+    {
+        std::string name;
+        float constantValue; ///< Value of the constant channels.
+        bool nanAndInf;      ///< Insert NaN and inf values in the varying channels.
+    };
+    const Case cases[] = {
+        {"constant", 0.25f, false},
+        {"negative", -1.5f, false},
+        {"special", 0.5f, true},
+    };
+
+    for (uint32_t channelCount : {1, 2, 3, 4})
+    {
+        for (uint32_t varyingMask : {0x0, 0x1, 0x2, 0x5})
+        {
+            for (const auto& testCase : cases)
+            {
+                std::vector<float> data(texelCount * channelCount);
+                for (size_t i = 0; i < texelCount; i++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        float value = testCase.constantValue;
+                        if (varyingMask & (1u << c))
+                        {
+                            value = dist(rng);
+                            if (testCase.nanAndInf && i % 97 == 13)
+                                value = NAN;
+                            if (testCase.nanAndInf && i % 89 == 7)
+                                value = -INFINITY;
+                        }
+                        data[i * channelCount + c] = value;
+                    }
+                }
+
+                // Expand to RGBA like texture reads.
+                std::vector<float4> texels(texelCount, float4(0.f, 0.f, 0.f, 1.f));
+                for (size_t i = 0; i < texelCount; i++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                        texels[i][c] = data[i * channelCount + c];
+                }
+
+                const ResourceFormat formats32[] = {
+                    ResourceFormat::R32Float, ResourceFormat::RG32Float, ResourceFormat::RGB32Float, ResourceFormat::RGBA32Float};
+                const std::string name = fmt::format("{} channels={} mask={}", testCase.name, channelCount, varyingMask);
+                auto result = TextureAnalyzer::analyzeCPU(formats32[channelCount - 1], width, height, data.data());
+                compareResults(ctx, result, analyzeReference(texels), name);
+
+                // Test the same data as halfs.
+                if (channelCount == 3)
+                    continue;
+                std::vector<uint16_t> halfs(data.size());
+                math::float32ToFloat16(data.data(), halfs.data(), data.size());
+                math::float16ToFloat32(halfs.data(), data.data(), data.size());
+                for (size_t i = 0; i < texelCount; i++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                        texels[i][c] = data[i * channelCount + c];
+                }
+                const ResourceFormat formats16[] = {
+                    ResourceFormat::R16Float, ResourceFormat::RG16Float, ResourceFormat::Unknown, ResourceFormat::RGBA16Float};
+                result = TextureAnalyzer::analyzeCPU(formats16[channelCount - 1], width, height, halfs.data());
+                compareResults(ctx, result, analyzeReference(texels), name + " (half)");
+            }
+        }
+    }
+
+    // 8-bit formats, with and without alpha.
+    for (ResourceFormat format : {ResourceFormat::RGBA8Unorm, ResourceFormat::BGRA8Unorm, ResourceFormat::BGRX8Unorm})
+    {
+        std::vector<uint8_t> data(texelCount * 4);
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            data[i * 4 + 0] = 10;
+            data[i * 4 + 1] = (uint8_t)(rng() % 256);
+            data[i * 4 + 2] = 0;
+            data[i * 4 + 3] = (uint8_t)(rng() % 256);
+        }
+
+        const bool isBGR = format != ResourceFormat::RGBA8Unorm;
+        const bool hasAlpha = format != ResourceFormat::BGRX8Unorm;
+        std::vector<float4> texels(texelCount);
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            texels[i].r = data[i * 4 + (isBGR ? 2 : 0)] / 255.f;
+            texels[i].g = data[i * 4 + 1] / 255.f;
+            texels[i].b = data[i * 4 + (isBGR ? 0 : 2)] / 255.f;
+            texels[i].a = hasAlpha ? data[i * 4 + 3] / 255.f : 1.f;
+        }
+
+        auto result = TextureAnalyzer::analyzeCPU(format, width, height, data.data());
+        compareResults(ctx, result, analyzeReference(texels), to_string(format));
+    }
+}
+
 GPU_TEST(TextureAnalyzer)
 {
     ref<Device> pDevice = ctx.getDevice();
@@ -189,4 +342,28 @@ GPU_TEST(TextureAnalyzer)
 
     verify(pResult);
 }
+
+GPU_TEST(TextureAnalyzer_CPUMatchesGPU)
+{
+    // The test textures are analyzed on the CPU and compared to the GPU results.
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        std::filesystem::path path = getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+        auto pBitmap = Bitmap::createFromFile(path, true);
+        ASSERT(pBitmap != nullptr);
+        ASSERT(TextureAnalyzer::isCPUSupported(pBitmap->getFormat()));
+
+        auto result = TextureAnalyzer::analyzeCPU(pBitmap->getFormat(), pBitmap->getWidth(), pBitmap->getHeight(), pBitmap->getData());
+        EXPECT_EQ(result.mask, kExpectedResult[i].mask) << "i = " << i;
+        for (int c = 0; c < 4; c++)
+        {
+            EXPECT_EQ(result.minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
+            EXPECT_EQ(result.maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+            if (result.isConstant(1u << c))
+            {
+                EXPECT_EQ(result.value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
+            }
+        }
+    }
+}
 } // namespace Falcor
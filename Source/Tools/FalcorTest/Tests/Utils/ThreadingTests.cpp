@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/TaskManager.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+uint64_t fibonacci(uint32_t n)
+{
+    if (n < 2)
+        return n;
+    // Fork one branch and compute the other on the current thread, then join.
+    uint64_t a = 0;
+    Threading::Task task = Threading::dispatchTask([&a, n]() { a = fibonacci(n - 1); });
+    uint64_t b = fibonacci(n - 2);
+    task.finish();
+    return a + b;
+}
+} // namespace
+
+CPU_TEST(Threading_DispatchTask)
+{
+    const uint32_t kTaskCount = 1000;
+    std::atomic<uint32_t> counter = 0;
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < kTaskCount; i++)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+    for (auto& task : tasks)
+        task.finish();
+    EXPECT_EQ(counter, kTaskCount);
+    for (auto& task : tasks)
+    {
+        EXPECT(task.isValid());
+        EXPECT(!task.isRunning());
+    }
+
+    // Default constructed handles are never running.
+    Threading::Task task;
+    EXPECT(!task.isValid());
+    EXPECT(!task.isRunning());
+    task.finish();
+
+    // Threading::finish() waits for fire-and-forget tasks.
+    counter = 0;
+    for (uint32_t i = 0; i < kTaskCount; i++)
+        Threading::dispatchTask([&counter]() { counter++; }, Threading::Priority::Low);
+    Threading::finish();
+    EXPECT_EQ(counter, kTaskCount);
+}
+
+CPU_TEST(Threading_Continuations)
+{
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+    };
+
+    Threading::Task a = Threading::dispatchTask([&]() { record(0); });
+    Threading::Task b = a.then([&]() { record(1); });
+    Threading::Task c = b.then([&]() { record(2); }, Threading::Priority::High);
+    c.finish();
+    EXPECT(order == std::vector<int>({0, 1, 2}));
+
+    // A continuation of a finished task is dispatched right away.
+    Threading::Task d = a.then([&]() { record(3); });
+    d.finish();
+    EXPECT_EQ(order.size(), 4);
+
+    // A task with multiple dependencies starts after all of them.
+    std::atomic<uint32_t> counter = 0;
+    std::vector<Threading::Task> dependencies;
+    for (uint32_t i = 0; i < 64; i++)
+        dependencies.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+    dependencies.push_back(Threading::Task());
+    uint32_t observed = 0;
+    Threading::dispatchTask([&]() { observed = counter; }, dependencies).finish();
+    EXPECT_EQ(observed, 64);
+}
+
+CPU_TEST(Threading_Exceptions)
+{
+    Threading::Task task = Threading::dispatchTask([]() { throw std::runtime_error("error"); });
+    bool continuationRan = false;
+    Threading::Task continuation = task.then([&]() { continuationRan = true; });
+    EXPECT_THROW(task.finish());
+    continuation.finish();
+    EXPECT(continuationRan);
+
+    EXPECT_THROW(Threading::parallelFor(0, 100, [](uint32_t i) {
+        if (i == 50)
+            throw std::runtime_error("error");
+    }));
+}
+
+CPU_TEST(Threading_ForkJoin)
+{
+    // Parallel loop with uneven work.
+    const uint32_t kCount = 10000;
+    std::vector<uint32_t> values(kCount, 0);
+    Threading::parallelFor(0, kCount, [&](uint32_t i) { values[i] = i * i % 7; });
+    for (uint32_t i = 0; i < kCount; i++)
+        EXPECT_EQ(values[i], i * i % 7);
+
+    // Nested parallel loops.
+    std::atomic<uint64_t> sum = 0;
+    Threading::parallelFor(0, 64, [&](uint32_t i) { Threading::parallelFor(0, 64, [&](uint32_t j) { sum += i * 64 + j; }); });
+    EXPECT_EQ(sum, 4096ull * 4095 / 2);
+
+    // Recursive fork-join. The recursion is much deeper than the number of workers, so this only finishes if waiting threads help.
+    EXPECT_EQ(fibonacci(20), 6765);
+
+    // Empty range.
+    Threading::parallelFor(10, 10, [&](uint32_t) { sum = 0; });
+    EXPECT_NE(sum, 0);
+}
+
+CPU_TEST(Threading_TaskManager)
+{
+    // Occupy the scheduler with unrelated tasks. Waiting in TaskManager::finish() must not run them on this thread.
+    const std::thread::id threadId = std::this_thread::get_id();
+    std::atomic<bool> ranOnThisThread = false;
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        tasks.push_back(Threading::dispatchTask(
+            [&]()
+            {
+                if (std::this_thread::get_id() == threadId)
+                    ranOnThisThread = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        ));
+    }
+
+    TaskManager manager(true);
+    std::atomic<uint32_t> counter = 0;
+    for (uint32_t i = 0; i < 16; i++)
+        manager.addTask([&]() { counter++; });
+    manager.addTask([&]() { throw std::runtime_error("Task failed."); });
+    EXPECT_THROW(manager.finish(nullptr));
+    EXPECT_EQ(counter, 16);
+    EXPECT(!ranOnThisThread);
+
+    for (auto& task : tasks)
+        task.finish();
+}
+} // namespace Falcor
@@ -25,11 +25,25 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageDecoder.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
 #include <FreeImage.h>
 #include <args.hxx>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -40,6 +54,24 @@
 #include <cmath>
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define IMAGE_COMPARE_SSE2 1
+#include <emmintrin.h>
+#else
+#define IMAGE_COMPARE_SSE2 0
+#endif
+
+using Falcor::CpuTimer;
+using Falcor::Threading;
+
+/// Number of image rows processed per task.
+static const uint32_t kTileHeight = 32;
+
+/// Suffix of heat map files written in batch mode. Files with this suffix are ignored when searching for images.
+static const std::string kHeatMapSuffix = ".error.png";
+
+static const std::vector<std::string> kImageExtensions = {".png", ".jpg", ".jpeg", ".exr", ".hdr", ".tga", ".bmp", ".pfm"};
+
 template<typename T>
 T sqr(T x)
 {
@@ -61,17 +93,23 @@ T clamp(T x, T lo, T hi)
 class Image
 {
 public:
-    Image(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(width * height * 4)) {}
+    Image(uint32_t width, uint32_t height)
+        : mWidth(width), mHeight(height), mStorage(std::make_unique<float[]>(size_t(width) * height * 4)), mpData(mStorage.get())
+    {}
 
     uint32_t getWidth() const { return mWidth; }
     uint32_t getHeight() const { return mHeight; }
-    const float* getData() const { return mData.get(); }
-    float* getData() { return mData.get(); }
+    const float* getData() const { return mpData; }
+    float* getData() { return mpData; }
 
     static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
 
     static std::shared_ptr<Image> loadFromFile(const std::filesystem::path& path)
     {
+        // Use the fast OpenEXR decoder if possible. It decodes in parallel and produces RGBA32F data directly.
+        if (auto pImage = loadWithImageDecoder(path))
+            return pImage;
+
         FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
 
         auto pathStr = path.string();
@@ -183,89 +221,256 @@ public:
     }
 
 private:
+    /// Wrap a RGBA32F bitmap without copying the data.
+    Image(Falcor::Bitmap::UniqueConstPtr pBitmap)
+        : mWidth(pBitmap->getWidth())
+        , mHeight(pBitmap->getHeight())
+        , mpBitmap(std::move(pBitmap))
+        , mpData(reinterpret_cast<float*>(mpBitmap->getData()))
+    {}
+
+    static std::shared_ptr<Image> loadWithImageDecoder(const std::filesystem::path& path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext != ".exr")
+            return nullptr;
+
+        auto pBitmap = Falcor::ImageDecoder::decodeEXR(path, true, Falcor::Bitmap::ImportFlags::None);
+        if (!pBitmap || pBitmap->getFormat() != Falcor::ResourceFormat::RGBA32Float)
+            return nullptr;
+        return std::shared_ptr<Image>(new Image(std::move(pBitmap)));
+    }
+
     uint32_t mWidth;
     uint32_t mHeight;
-    std::unique_ptr<float[]> mData;
+    std::unique_ptr<float[]> mStorage;
+    Falcor::Bitmap::UniqueConstPtr mpBitmap;
+    float* mpData;
 };
 
+// Error metrics. The per channel errors are averaged over the channels of each pixel, and the per pixel errors are
+// averaged over the image. Each metric provides a scalar and, if available, a SSE2 version of the per channel error.
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return sqr(a - b); }
+#if IMAGE_COMPARE_SSE2
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
+#endif
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return sqr(a - b) / (sqr(a) + 1e-3f); }
+#if IMAGE_COMPARE_SSE2
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
+#endif
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float eval(float a, float b) { return std::fabs(sqr(a - b)); }
+#if IMAGE_COMPARE_SSE2
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_mul_ps(d, d));
     }
+#endif
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 100.f;
+    static float eval(float a, float b) { return std::fabs((a - b) / (a + 1e-3f)); }
+#if IMAGE_COMPARE_SSE2
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f))));
     }
+#endif
 };
 
+/**
+ * Compute the errors of a row of pixels with the scalar implementation.
+ * @param[in] a First image row (RGBA).
+ * @param[in] b Second image row (RGBA).
+ * @param[in] width Number of pixels.
+ * @param[in] alpha Include the alpha channel.
+ * @param[out] errorMap Optional per pixel errors.
+ * @return Sum of the per pixel errors.
+ */
 template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+double evalRowScalar(const float* a, const float* b, uint32_t width, bool alpha, float* errorMap)
 {
-    Metric metric;
+    const uint32_t channelCount = alpha ? 4 : 3;
+    const float scale = Metric::kScale / channelCount;
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    for (uint32_t x = 0; x < width; ++x)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
+        float error = 0.f;
+        for (uint32_t c = 0; c < channelCount; ++c)
+            error += Metric::eval(a[c], b[c]);
+        error *= scale;
         if (errorMap)
-            *errorMap++ = float(error);
+            errorMap[x] = error;
         sum += error;
         a += 4;
         b += 4;
     }
-    return sum / count;
+    return sum;
+}
+
+/**
+ * Compute the errors of a row of pixels. Same as evalRowScalar() but processes four pixels at a time using SSE2.
+ */
+template<typename Metric>
+double evalRow(const float* a, const float* b, uint32_t width, bool alpha, float* errorMap)
+{
+    uint32_t x = 0;
+    double sum = 0.0;
+#if IMAGE_COMPARE_SSE2
+    const __m128 mask = alpha ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 scale = _mm_set1_ps(Metric::kScale / (alpha ? 4.f : 3.f));
+    __m128d acc = _mm_setzero_pd();
+    for (; x + 4 <= width; x += 4, a += 16, b += 16)
+    {
+        // Masking out alpha also drops NaNs in the alpha channel, same as the scalar version.
+        __m128 e0 = _mm_and_ps(Metric::eval(_mm_loadu_ps(a), _mm_loadu_ps(b)), mask);
+        __m128 e1 = _mm_and_ps(Metric::eval(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4)), mask);
+        __m128 e2 = _mm_and_ps(Metric::eval(_mm_loadu_ps(a + 8), _mm_loadu_ps(b + 8)), mask);
+        __m128 e3 = _mm_and_ps(Metric::eval(_mm_loadu_ps(a + 12), _mm_loadu_ps(b + 12)), mask);
+
+        // Transpose to get the per channel errors of four pixels in each register and sum over the channels.
+        _MM_TRANSPOSE4_PS(e0, e1, e2, e3);
+        __m128 error = _mm_mul_ps(_mm_add_ps(_mm_add_ps(e0, e1), _mm_add_ps(e2, e3)), scale);
+        if (errorMap)
+            _mm_storeu_ps(errorMap + x, error);
+
+        // Accumulate in double precision to avoid losing precision on large images.
+        acc = _mm_add_pd(acc, _mm_add_pd(_mm_cvtps_pd(error), _mm_cvtps_pd(_mm_movehl_ps(error, error))));
+    }
+    double partial[2];
+    _mm_storeu_pd(partial, acc);
+    sum = partial[0] + partial[1];
+#endif
+    return sum + evalRowScalar<Metric>(a, b, width - x, alpha, errorMap ? errorMap + x : nullptr);
 }
 
+using EvalRowFunc = double (*)(const float* a, const float* b, uint32_t width, bool alpha, float* errorMap);
+
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    EvalRowFunc evalRow;
+    EvalRowFunc evalRowScalar;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
-    {"mse", "Mean Squared Error", compare<MSE>},
-    {"rmse", "Relative Mean Squared Error", compare<RMSE>},
-    {"mae", "Mean Absolute Error", compare<MAE>},
-    {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"mse", "Mean Squared Error", evalRow<MSE>, evalRowScalar<MSE>},
+    {"rmse", "Relative Mean Squared Error", evalRow<RMSE>, evalRowScalar<RMSE>},
+    {"mae", "Mean Absolute Error", evalRow<MAE>, evalRowScalar<MAE>},
+    {"mape", "Mean Absolute Percentage Error", evalRow<MAPE>, evalRowScalar<MAPE>},
 };
 
+struct CompareResult
+{
+    double error = 0.0;
+    bool earlyExit = false; ///< True if the comparison was stopped early, error is then a lower bound.
+};
+
+/**
+ * Compare two images of the same size.
+ * The image is split into tiles of rows which are processed in parallel. The tile sums are combined in a fixed
+ * order, so the result does not depend on the number of threads.
+ * @param[in] evalRow Row kernel of the error metric.
+ * @param[in] imageA First image.
+ * @param[in] imageB Second image.
+ * @param[in] alpha Include the alpha channel.
+ * @param[out] errorMap Optional per pixel errors. Disables the early exit.
+ * @param[in] earlyExitError Stop as soon as the error is known to exceed this value. All error metrics are
+ *            non-negative, so the error of the processed tiles is a lower bound of the final error.
+ */
+static CompareResult compare(
+    EvalRowFunc evalRow,
+    const Image& imageA,
+    const Image& imageB,
+    bool alpha,
+    float* errorMap,
+    double earlyExitError = std::numeric_limits<double>::infinity()
+)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const double pixelCount = double(width) * height;
+    const uint32_t tileCount = (height + kTileHeight - 1) / kTileHeight;
+    const bool allowEarlyExit = !errorMap && earlyExitError < std::numeric_limits<double>::infinity();
+    const double earlyExitSum = earlyExitError * pixelCount;
+
+    std::vector<double> tileSums(tileCount, 0.0);
+    std::atomic<bool> stop = false;
+    std::mutex mutex;
+    double processedSum = 0.0;
+
+    Threading::parallelFor(
+        0,
+        tileCount,
+        [&](uint32_t tile)
+        {
+            if (stop.load(std::memory_order_relaxed))
+                return;
+
+            const uint32_t rowBegin = tile * kTileHeight;
+            const uint32_t rowEnd = std::min(height, rowBegin + kTileHeight);
+            double sum = 0.0;
+            for (uint32_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const size_t offset = size_t(y) * width;
+                float* rowErrorMap = errorMap ? errorMap + offset : nullptr;
+                sum += evalRow(imageA.getData() + 4 * offset, imageB.getData() + 4 * offset, width, alpha, rowErrorMap);
+            }
+            tileSums[tile] = sum;
+
+            if (allowEarlyExit)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                processedSum += sum;
+                if (processedSum > earlyExitSum || std::isnan(processedSum))
+                    stop = true;
+            }
+        }
+    );
+
+    CompareResult result;
+    if (stop)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.error = processedSum / pixelCount;
+        result.earlyExit = true;
+    }
+    else
+    {
+        double sum = 0.0;
+        for (double tileSum : tileSums)
+            sum += tileSum;
+        result.error = sum / pixelCount;
+    }
+    return result;
+}
+
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
 {
     auto writeColor = [](float t, float* dst)
@@ -284,30 +489,69 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
         *dst++ = 1.f;
     };
 
-    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + width * height);
+    const size_t pixelCount = size_t(width) * height;
+    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + pixelCount);
     const float range = std::max(1e-5f, *maxValue - *minValue);
     auto image = Image::create(width, height);
-    float* dst = image->getData();
-    for (size_t i = 0; i < width * height; ++i)
-    {
-        float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
-        writeColor(t, dst);
-        dst += 4;
-    }
+    const uint32_t tileCount = (height + kTileHeight - 1) / kTileHeight;
+    Threading::parallelFor(
+        0,
+        tileCount,
+        [&](uint32_t tile)
+        {
+            const size_t begin = size_t(tile) * kTileHeight * width;
+            const size_t end = std::min(pixelCount, begin + size_t(kTileHeight) * width);
+            float* dst = image->getData() + 4 * begin;
+            for (size_t i = begin; i < end; ++i)
+            {
+                float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
+                writeColor(t, dst);
+                dst += 4;
+            }
+        }
+    );
 
     return image;
 }
 
-static bool compareImages(
+struct CompareOptions
+{
+    ErrorMetric metric;
+    float threshold = 0.f;
+    bool alpha = false;
+    bool earlyExit = false;
+};
+
+/// Result of comparing a pair of images.
+struct PairResult
+{
+    std::string name;
+    std::filesystem::path pathA;
+    std::filesystem::path pathB;
+    std::filesystem::path heatMapPath;
+    bool success = false;
+    bool compared = false; ///< True if the images were loaded and compared.
+    CompareResult compare;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    double loadTimeMs = 0.0;
+    double compareTimeMs = 0.0;
+    std::string message;
+};
+
+static PairResult compareImages(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
-    float threshold,
-    bool alpha,
+    const CompareOptions& options,
     const std::filesystem::path& heatMapPath
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
+    PairResult result;
+    result.pathA = pathA;
+    result.pathB = pathB;
+    result.heatMapPath = heatMapPath;
+
+    auto loadImage = [&result](const std::filesystem::path& path)
     {
         try
         {
@@ -315,12 +559,12 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").";
             return std::shared_ptr<Image>{};
         }
     };
 
-    auto saveImage = [](const Image& image, const std::filesystem::path& path)
+    auto saveImage = [&result](const Image& image, const std::filesystem::path& path)
     {
         try
         {
@@ -328,46 +572,369 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot save image to '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot save image to '" + path.string() + "' (Error: " + e.what() + ").";
         }
     };
 
-    // Load images.
-    auto imageA = loadImage(pathA);
+    // Load images. The second image is loaded on another thread.
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    std::shared_ptr<Image> imageA, imageB;
+    std::string messageB;
+    Threading::Task loadTask = Threading::dispatchTask(
+        [&]()
+        {
+            try
+            {
+                imageB = Image::loadFromFile(pathB);
+            }
+            catch (const std::runtime_error& e)
+            {
+                messageB = "Cannot load image from '" + pathB.string() + "' (Error: " + e.what() + ").";
+            }
+        }
+    );
+    imageA = loadImage(pathA);
+    loadTask.finish();
+    result.loadTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
     if (!imageA)
-        return false;
-    auto imageB = loadImage(pathB);
+        return result;
     if (!imageB)
-        return false;
+    {
+        result.message = messageB;
+        return result;
+    }
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
+    result.width = width;
+    result.height = height;
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    startTime = CpuTimer::getCurrentTimePoint();
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    double earlyExitError = options.earlyExit ? options.threshold : std::numeric_limits<double>::infinity();
+    result.compare = compare(options.metric.evalRow, *imageA, *imageB, options.alpha, errorMap.get(), earlyExitError);
+    result.compared = true;
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
+        std::error_code ec;
+        std::filesystem::create_directories(heatMapPath.parent_path(), ec);
         saveImage(*heatMap, heatMapPath);
     }
-
-    std::cout << error << std::endl;
+    result.compareTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
 
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
+    double error = result.compare.error;
+    result.success = !std::isnan(error) && !std::isinf(error) && error <= options.threshold;
+    return result;
+}
+
+static nlohmann::json toJson(const PairResult& result)
+{
+    nlohmann::json j;
+    if (!result.name.empty())
+        j["name"] = result.name;
+    j["imageA"] = result.pathA.string();
+    j["imageB"] = result.pathB.string();
+    j["success"] = result.success;
+    // JSON has no representation for nans and infs, these are written as null.
+    j["error"] = result.compared && std::isfinite(result.compare.error) ? nlohmann::json(result.compare.error) : nlohmann::json();
+    j["earlyExit"] = result.compare.earlyExit;
+    j["width"] = result.width;
+    j["height"] = result.height;
+    j["loadTimeMs"] = result.loadTimeMs;
+    j["compareTimeMs"] = result.compareTimeMs;
+    if (!result.heatMapPath.empty() && result.compared)
+        j["heatMap"] = result.heatMapPath.string();
+    if (!result.message.empty())
+        j["message"] = result.message;
+    return j;
+}
+
+static nlohmann::json toJson(const CompareOptions& options)
+{
+    return {
+        {"metric", options.metric.name},
+        {"threshold", options.threshold},
+        {"alpha", options.alpha},
+        {"earlyExit", options.earlyExit},
+    };
+}
+
+static bool writeJson(const nlohmann::json& j, const std::string& path)
+{
+    if (path == "-")
+    {
+        std::cout << j.dump(2) << std::endl;
+        return true;
+    }
+    std::ofstream stream(path);
+    stream << j.dump(2) << std::endl;
+    if (!stream.good())
+    {
+        std::cerr << "Cannot write results to '" << path << "'." << std::endl;
         return false;
+    }
+    return true;
+}
 
-    return error <= threshold;
+static bool isImageFile(const std::filesystem::path& path)
+{
+    std::string filename = path.filename().string();
+    std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
+    const size_t suffixSize = kHeatMapSuffix.size();
+    if (filename.size() >= suffixSize && filename.compare(filename.size() - suffixSize, suffixSize, kHeatMapSuffix) == 0)
+        return false;
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return std::find(kImageExtensions.begin(), kImageExtensions.end(), ext) != kImageExtensions.end();
+}
+
+/// Find all images in a directory tree. Returns paths relative to the directory.
+static std::set<std::filesystem::path> findImages(const std::filesystem::path& directory)
+{
+    std::set<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && isImageFile(entry.path()))
+            paths.insert(entry.path().lexically_relative(directory));
+    }
+    return paths;
+}
+
+/**
+ * Compare all images in two directory trees. Images are matched by their relative path.
+ * Multiple pairs are processed concurrently to hide the image decoding latency, results are reported in order.
+ * @return True if all images exist in both directories and all comparisons succeeded.
+ */
+static bool compareDirectories(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const CompareOptions& options,
+    const std::filesystem::path& heatMapDir,
+    uint32_t maxPairsInFlight,
+    const std::string& jsonPath
+)
+{
+    std::set<std::filesystem::path> imagesA, imagesB;
+    try
+    {
+        imagesA = findImages(dirA);
+        imagesB = findImages(dirB);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    std::set<std::filesystem::path> names = imagesA;
+    names.insert(imagesB.begin(), imagesB.end());
+    if (names.empty())
+    {
+        std::cerr << "No images found in '" << dirA.string() << "' or '" << dirB.string() << "'." << std::endl;
+        return false;
+    }
+
+    const bool printText = jsonPath != "-";
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    std::vector<PairResult> results(names.size());
+    std::deque<std::pair<size_t, Threading::Task>> inFlight;
+    size_t passedCount = 0;
+    uint64_t comparedPixelCount = 0;
+
+    auto report = [&](size_t index)
+    {
+        const PairResult& result = results[index];
+        passedCount += result.success ? 1 : 0;
+        comparedPixelCount += result.compared ? uint64_t(result.width) * result.height : 0;
+        if (printText)
+        {
+            std::string error = result.compared ? fmt::format("{:.9g}", result.compare.error) : "-";
+            std::cout << fmt::format(
+                             "{} {:>16}{} {}", result.success ? "PASS" : "FAIL", error, result.compare.earlyExit ? "+" : " ", result.name
+                         );
+            if (!result.message.empty())
+                std::cout << " (" << result.message << ")";
+            std::cout << std::endl;
+        }
+    };
+
+    // Report the results in order as soon as the preceding pairs are done.
+    auto reportFinished = [&](size_t maxInFlight)
+    {
+        while (!inFlight.empty() && (inFlight.size() > maxInFlight || !inFlight.front().second.isRunning()))
+        {
+            inFlight.front().second.finish();
+            report(inFlight.front().first);
+            inFlight.pop_front();
+        }
+    };
+
+    size_t index = 0;
+    for (const auto& name : names)
+    {
+        PairResult& result = results[index];
+        result.name = name.generic_string();
+        result.pathA = dirA / name;
+        result.pathB = dirB / name;
+
+        // The task stays invalid for pairs with missing images.
+        Threading::Task task;
+        if (!imagesA.count(name) || !imagesB.count(name))
+        {
+            result.message = fmt::format("Image is missing in '{}'.", (imagesA.count(name) ? dirB : dirA).string());
+        }
+        else
+        {
+            // Wait for the oldest pairs before starting another one to bound the memory use.
+            reportFinished(maxPairsInFlight - 1);
+
+            std::filesystem::path heatMapPath = heatMapDir.empty() ? "" : heatMapDir / (name.string() + kHeatMapSuffix);
+            task = Threading::dispatchTask(
+                [&result, &options, heatMapPath]()
+                {
+                    std::string name = result.name;
+                    result = compareImages(result.pathA, result.pathB, options, heatMapPath);
+                    result.name = name;
+                }
+            );
+        }
+        inFlight.emplace_back(index++, std::move(task));
+        reportFinished(maxPairsInFlight);
+    }
+    reportFinished(0);
+
+    const double elapsedMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    const size_t failedCount = results.size() - passedCount;
+    const double megapixelsPerSecond = comparedPixelCount * 1e-6 / std::max(1e-9, elapsedMs * 1e-3);
+    if (printText)
+    {
+        std::cout << fmt::format(
+                         "{} image pairs, {} passed, {} failed, {:.2f} s, {:.1f} MP/s",
+                         results.size(),
+                         passedCount,
+                         failedCount,
+                         elapsedMs * 1e-3,
+                         megapixelsPerSecond
+                     )
+                  << std::endl;
+    }
+
+    if (!jsonPath.empty())
+    {
+        nlohmann::json j = toJson(options);
+        j["results"] = nlohmann::json::array();
+        for (const auto& result : results)
+            j["results"].push_back(toJson(result));
+        j["summary"] = {
+            {"count", results.size()},
+            {"passed", passedCount},
+            {"failed", failedCount},
+            {"elapsedMs", elapsedMs},
+            {"megapixelsPerSecond", megapixelsPerSecond},
+        };
+        if (!writeJson(j, jsonPath))
+            return false;
+    }
+
+    return failedCount == 0;
+}
+
+/**
+ * Measure the throughput of the error metrics on synthetic images.
+ * Compares the scalar kernel on a single thread, the SIMD kernel on a single thread and the tiled SIMD kernel on all
+ * threads. Also verifies that all variants produce the same error.
+ * @return True if all variants agree.
+ */
+static bool runBenchmark(uint32_t width, uint32_t height, uint32_t iterations, bool alpha)
+{
+    auto imageA = Image::create(width, height);
+    auto imageB = Image::create(width, height);
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    const size_t valueCount = size_t(width) * height * 4;
+    for (size_t i = 0; i < valueCount; ++i)
+    {
+        imageA->getData()[i] = dist(rng);
+        imageB->getData()[i] = imageA->getData()[i] + 0.05f * (dist(rng) - 0.5f);
+    }
+
+    // Run a row kernel over the full image on the calling thread.
+    auto compareSingleThreaded = [&](EvalRowFunc evalRow)
+    {
+        double sum = 0.0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const size_t offset = 4 * size_t(y) * width;
+            sum += evalRow(imageA->getData() + offset, imageB->getData() + offset, width, alpha, nullptr);
+        }
+        return sum / (double(width) * height);
+    };
+
+    // Run a variant a number of times and return the best throughput in megapixels per second.
+    double error = 0.0;
+    auto measure = [&](const std::function<double()>& func)
+    {
+        double bestMs = std::numeric_limits<double>::infinity();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            error = func();
+            bestMs = std::min(bestMs, CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+        }
+        return double(width) * height * 1e-6 / (bestMs * 1e-3);
+    };
+
+    std::cout << fmt::format(
+                     "{}x{} pixels, {} iterations, {} threads, SSE2 {}",
+                     width,
+                     height,
+                     iterations,
+                     Threading::getWorkerCount() + 1,
+                     IMAGE_COMPARE_SSE2 ? "enabled" : "disabled"
+                 )
+              << std::endl;
+    std::cout << fmt::format("{:<8} {:>14} {:>14} {:>14} {:>8}", "Metric", "Scalar MP/s", "SIMD MP/s", "Tiled MP/s", "Speedup")
+              << std::endl;
+
+    bool success = true;
+    for (const auto& metric : errorMetrics)
+    {
+        const double scalarRate = measure([&]() { return compareSingleThreaded(metric.evalRowScalar); });
+        const double reference = error;
+        const double simdRate = measure([&]() { return compareSingleThreaded(metric.evalRow); });
+        const double simdError = error;
+        const double tiledRate = measure([&]() { return compare(metric.evalRow, *imageA, *imageB, alpha, nullptr).error; });
+        const double tiledError = error;
+
+        // The variants sum in different orders, allow for rounding differences.
+        auto isClose = [reference](double value) { return std::fabs(value - reference) <= 1e-5 * std::fabs(reference); };
+        const bool match = isClose(simdError) && isClose(tiledError);
+        success = success && match;
+
+        std::cout << fmt::format(
+                         "{:<8} {:>14.1f} {:>14.1f} {:>14.1f} {:>7.2f}x{}",
+                         metric.name,
+                         scalarRate,
+                         simdRate,
+                         tiledRate,
+                         tiledRate / scalarRate,
+                         match ? "" : "  MISMATCH"
+                     )
+                  << std::endl;
+    }
+    return success;
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -381,7 +948,12 @@ static void printMetrics(std::ostream& stream = std::cout)
 
 int main(int argc, char** argv)
 {
-    args::ArgumentParser parser("Utility to compare images.");
+    args::ArgumentParser parser(
+        "Utility to compare images.",
+        "In batch mode, image1 and image2 are directories and all images with the same relative path are compared. "
+        "The heat maps are then written to the given directory as '<relative path>" +
+            kHeatMapSuffix + "'."
+    );
     parser.helpParams.programName = "ImageCompare";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::Flag listMetricsFlag(parser, "", "List available error metrics.", {'l'});
@@ -389,8 +961,19 @@ int main(int argc, char** argv)
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
     args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::Flag earlyExitFlag(
+        parser, "", "Stop comparing as soon as the threshold is exceeded. The reported error is then a lower bound.", {"early-exit"}
+    );
+    args::Flag batchFlag(parser, "", "Compare all images in two directories.", {'b', "batch"});
+    args::ValueFlag<std::string> jsonFlag(parser, "filename", "Write the results as JSON. Use '-' to write to stdout.", {"json"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "count", "Number of threads (default: number of logical cores).", {'j'});
+    args::ValueFlag<uint32_t> pairsFlag(parser, "count", "Number of image pairs processed concurrently in batch mode (default 4).", {'p'});
+    args::Flag benchmarkFlag(parser, "", "Measure the throughput of the error metrics on synthetic images.", {"benchmark"});
+    args::ValueFlag<uint32_t> benchmarkSizeFlag(
+        parser, "size", "Image width for the benchmark (default 3840, 16:9 aspect).", {"benchmark-size"}
+    );
+    args::Positional<std::string> image1(parser, "image1", "The first image.");
+    args::Positional<std::string> image2(parser, "image2", "The second image.");
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -426,7 +1009,15 @@ int main(int argc, char** argv)
         return 0;
     }
 
-    ErrorMetric metric = errorMetrics.front();
+    if (!benchmarkFlag && (!image1 || !image2))
+    {
+        std::cerr << "Two images or directories are required." << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    CompareOptions options;
+    options.metric = errorMetrics.front();
     if (metricFlag)
     {
         auto name = args::get(metricFlag);
@@ -438,16 +1029,54 @@ int main(int argc, char** argv)
             printMetrics(std::cerr);
             return 1;
         }
-        metric = *it;
+        options.metric = *it;
     }
+    options.threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    options.alpha = alphaFlag ? args::get(alphaFlag) : false;
+    options.earlyExit = earlyExitFlag;
+
+    // The calling thread takes part in the work, so start one worker less than requested.
+    const uint32_t threadCount = threadsFlag ? args::get(threadsFlag) : Threading::getLogicalThreadCount();
+    if (threadCount > 1)
+        Threading::start(threadCount - 1);
+
+    bool success = false;
+    if (benchmarkFlag)
+    {
+        const uint32_t width = std::max(16u, benchmarkSizeFlag ? args::get(benchmarkSizeFlag) : 3840u);
+        success = runBenchmark(width, width * 9 / 16, 5, options.alpha);
+    }
+    else if (batchFlag)
+    {
+        success = compareDirectories(
+            args::get(image1),
+            args::get(image2),
+            options,
+            heatMapFlag ? args::get(heatMapFlag) : "",
+            std::max(1u, pairsFlag ? args::get(pairsFlag) : 4u),
+            jsonFlag ? args::get(jsonFlag) : ""
+        );
+    }
+    else
+    {
+        PairResult result = compareImages(args::get(image1), args::get(image2), options, heatMapFlag ? args::get(heatMapFlag) : "");
+        if (!result.message.empty())
+            std::cerr << result.message << std::endl;
+        if (result.compared && (!jsonFlag || args::get(jsonFlag) != "-"))
+            std::cout << result.compare.error << std::endl;
+        success = result.success;
+
+        if (jsonFlag)
+        {
+            nlohmann::json j = toJson(options);
+            j["results"] = nlohmann::json::array({toJson(result)});
+            if (!writeJson(j, args::get(jsonFlag)))
+                success = false;
+        }
+    }
+
+    if (threadCount > 1)
+        Threading::shutdown();
 
-    bool success = compareImages(
-        args::get(image1),
-        args::get(image2),
-        metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
-    );
     return success ? 0 : 1;
 }
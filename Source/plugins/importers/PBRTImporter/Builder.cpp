@@ -100,6 +100,11 @@ void BasicScene::addSpectrumTexture(std::string name, TextureSceneEntity texture
     mSpectrumTextures.emplace(name, texture);
 }
 
+void BasicScene::addIncludedFile(std::filesystem::path path)
+{
+    mIncludedFiles.push_back(std::move(path));
+}
+
 void BasicScene::addLight(LightSceneEntity light)
 {
     mLights.push_back(light);
@@ -462,6 +467,11 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onInclude(const std::filesystem::path& path, FileLoc loc)
+{
+    mScene.addIncludedFile(path);
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
@@ -259,7 +259,12 @@ struct BuilderContext
         return pMaterial;
     }
 
-    Resolver resolver = [this](const std::filesystem::path& path) { return scene.resolvePath(path); };
+    Resolver resolver = [this](const std::filesystem::path& path)
+    {
+        auto resolvedPath = scene.resolvePath(path);
+        builder.addDependency(resolvedPath);
+        return resolvedPath;
+    };
 };
 
 inline void warnUnsupportedType(const FileLoc& loc, const std::string_view category, const std::string_view name)
@@ -1926,6 +1931,8 @@ void PBRTImporter::importScene(
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
         pbrt::parseFile(pbrtBuilder, path);
+        for (const auto& includedPath : pbrtScene.getIncludedFiles())
+            builder.addDependency(includedPath);
         timeReport.measure("Parsing pbrt scene");
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
@@ -97,6 +97,7 @@ public:
     virtual void onObjectBegin(const std::string& name, FileLoc loc) = 0;
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
+    virtual void onInclude(const std::filesystem::path& path, FileLoc loc) = 0;
 
     virtual void onEndOfFiles() = 0;
 };